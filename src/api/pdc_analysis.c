@@ -413,6 +413,18 @@ done:
 
 perr_t
 PDCobj_analysis_register(char *func, pdcid_t iterIn, pdcid_t iterOut)
+{
+    perr_t ret_value = SUCCEED;
+
+    FUNC_ENTER(NULL);
+
+    ret_value = PDCobj_analysis_register_flags(func, iterIn, iterOut, 0);
+
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDCobj_analysis_register_flags(char *func, pdcid_t iterIn, pdcid_t iterOut, int flags)
 {
     perr_t ret_value                              = SUCCEED; /* Return value */
     void * ftnHandle                              = NULL;
@@ -458,6 +470,7 @@ PDCobj_analysis_register(char *func, pdcid_t iterIn, pdcid_t iterOut)
 
     thisFtn->ftnPtr = (int (*)())ftnPtr;
     thisFtn->n_args = 2;
+    thisFtn->flags  = flags;
     /* Allocate for iterator ids and region ids */
     if ((thisFtn->object_id = (pdcid_t *)calloc(4, sizeof(pdcid_t))) != NULL) {
         thisFtn->object_id[0] = iterIn;
@@ -27,6 +27,9 @@
 
 #include "pdc_public.h"
 
+// Flags of PDCobj_analysis_register_flags
+#define PDC_ANALYSIS_PARALLEL 0x1 /* may run on disjoint parts of its iterators at once, e.g. a map */
+
 /*********************/
 /* Public Prototypes */
 /*********************/
@@ -90,9 +93,23 @@ size_t PDCobj_data_getNextBlock(pdcid_t iter, void **nextBlock, size_t *dims);
  * such as the reading of data from files (HDF5, etc.) or to start monitoring or timing
  * functions. One could for example provide an API to start or stop profilers, take data
  * snapshots, etc.
+ * The function is run on one thread, see PDCobj_analysis_register_flags.
  */
 perr_t PDCobj_analysis_register(char *func, pdcid_t iterIn, pdcid_t iterOut);
 
+/**
+ * Register an analysis function like PDCobj_analysis_register, with flags on how the server runs it
+ *
+ * \param func [IN]             String containing the [libraryname:]function to be registered
+ * \param iterIn [IN]           PDC iterator id containing the input data
+ * \param iterOut [IN]          PDC iterator id containing the output data
+ * \param flags [IN]            PDC_ANALYSIS_PARALLEL if the function only depends on the blocks it is given,
+ *                              so that the server can split its iterators across threads, 0 otherwise
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDCobj_analysis_register_flags(char *func, pdcid_t iterIn, pdcid_t iterOut, int flags);
+
 /**
  * ****
  *
@@ -100,4 +117,11 @@ perr_t PDCobj_analysis_register(char *func, pdcid_t iterIn, pdcid_t iterOut);
  */
 int PDCiter_get_nextId(void);
 
+/**
+ * Release an iterator id so that PDCiter_get_nextId() can return it again
+ *
+ * \param id [IN]               Iterator id returned by PDCiter_get_nextId()
+ */
+void PDCiter_release_id(int id);
+
 #endif /* PDC_ANALYSIS_SUPPORT_H */
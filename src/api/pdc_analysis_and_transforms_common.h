@@ -45,6 +45,7 @@ struct _pdc_region_analysis_ftn_info {
     int                      readyCount;
     int                      client_id;
     int                      ftn_lastResult;
+    int                      flags; // PDC_ANALYSIS_PARALLEL if the server may split the iterators
     _pdc_analysis_language_t lang;
     void *                   data;
 };
@@ -109,8 +110,21 @@ struct _pdc_iterator_info {
     pdcid_t           reg_id;        /* Reference region ID                         */
     pdcid_t           local_id;      /* Our local reference id                      */
     pdcid_t           meta_id;       /* The server registration id                  */
+    pdcid_t           partOf;        /* Split iterator this one is a part of, or 0  */
+    size_t            partBlocks;    /* Blocks of the split iterator in this part   */
+    size_t            partNext;      /* Blocks of this part returned so far         */
 };
 
+/*
+ *  Parallel analysis: a data server runs an analysis function registered with
+ *  PDC_ANALYSIS_PARALLEL on several threads when its input iterator holds
+ *  enough blocks. The blocks are split into contiguous ranges, and each thread
+ *  gets part iterators with their own state that return only the blocks of its
+ *  range, so the function must be reentrant and only depend on its blocks. The
+ *  output iterator is split in lockstep with the input, which needs both to
+ *  hold the same number of blocks; other functions run on one thread.
+ */
+
 /* struct used to carry state of overall RPC operation across callbacks
  * Modified from Mercury: examples
  */
@@ -138,6 +152,7 @@ typedef struct analysis_ftn_in_t {
     pdcid_t           local_obj_id;
     pdcid_t           iter_in;
     pdcid_t           iter_out;
+    int32_t           flags;
 } analysis_ftn_in_t;
 
 typedef struct analysis_ftn_out_t {
@@ -228,6 +243,11 @@ hg_proc_analysis_ftn_in_t(hg_proc_t proc, void *data)
         // HG_LOG_ERROR("Proc error");
         return ret;
     }
+    ret = hg_proc_int32_t(proc, &struct_data->flags);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
     return ret;
 }
 
@@ -435,12 +455,13 @@ perr_t PDC_Client_register_obj_analysis(struct _pdc_region_analysis_ftn_info *th
  * \param op_type [IN]          Operation type
  * \param when [IN]             When to start transformation
  * \param client_index [IN]     Client index
+ * \param pipeline [IN]         1 if func holds the stages of a pipeline
  *
  * \return Non-negative on success/Negative on failure
  */
 perr_t PDC_Client_register_region_transform(const char *func, const char *loadpath,
                                             pdcid_t src_region_id ATTRIBUTE(unused), pdcid_t dest_region_id,
                                             pdcid_t obj_id, int start_state, int next_state, int op_type,
-                                            int when, int client_index);
+                                            int when, int client_index, int pipeline);
 
 #endif /* PDC_OBJ_ANALYSIS_H */
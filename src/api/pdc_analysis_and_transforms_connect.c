@@ -223,6 +223,7 @@ PDC_Client_register_obj_analysis(struct _pdc_region_analysis_ftn_info *thisFtn,
     in.loadpath = loadpath;
     in.iter_in  = in_meta;
     in.iter_out = out_meta;
+    in.flags    = thisFtn->flags;
 
     // We have already filled in the pdc_server_info_g[server_id].addr in previous
     // client_test_connect_lookup_cb
@@ -281,7 +282,7 @@ perr_t
 PDC_Client_register_region_transform(const char *func, const char *loadpath,
                                      pdcid_t src_region_id ATTRIBUTE(unused), pdcid_t dest_region_id,
                                      pdcid_t obj_id, int start_state, int next_state, int op_type, int when,
-                                     int client_index)
+                                     int client_index, int pipeline)
 {
     perr_t                    ret_value = SUCCEED;
     uint32_t                  server_id = 0;
@@ -314,6 +315,7 @@ PDC_Client_register_region_transform(const char *func, const char *loadpath,
     in.op_type        = op_type & 0xFF;
     in.when           = when & 0xFF;
     in.client_index   = client_index;
+    in.pipeline       = pipeline ? 1 : 0;
 
     // We have already filled in the pdc_server_info_g[server_id].addr in previous
     // client_test_connect_lookup_cb
@@ -346,17 +348,21 @@ done:
 static hg_return_t
 client_register_transform_rpc_cb(const struct hg_cb_info *info)
 {
-    hg_return_t         ret_value = HG_SUCCESS;
-    transform_ftn_out_t output;
+    hg_return_t               ret_value      = HG_SUCCESS;
+    struct _pdc_my_rpc_state *my_rpc_state_p = info->arg;
+    transform_ftn_out_t       output;
 
     FUNC_ENTER(NULL);
 
+    // A transform the server cannot resolve fails its registration
+    my_rpc_state_p->value = -1;
     if (info->ret == HG_SUCCESS) {
         ret_value = HG_Get_output(info->info.forward.handle, &output);
         if (ret_value != HG_SUCCESS)
             PGOTO_ERROR(ret_value, "PDC_CLIENT: Unable to read the server return values");
 
         PDC_update_transform_server_meta_index(output.client_index, output.ret);
+        my_rpc_state_p->value = output.ret;
     }
 
 done:
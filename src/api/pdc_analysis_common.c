@@ -59,6 +59,46 @@ compare_gt(int *a, int b)
 struct _pdc_region_analysis_ftn_info ** pdc_region_analysis_registry  = NULL;
 struct _pdc_region_transform_ftn_info **pdc_region_transform_registry = NULL;
 
+/*
+ * Index of a registry by function and object, so a registration finds an earlier one of the same function
+ * without a scan. Open addressing with at least twice the slots of the entries, a slot holds the registry
+ * index plus one.
+ */
+typedef struct pdc_registry_slot_t {
+    void *  ftnPtr;
+    pdcid_t object_id;
+    int     index;
+} pdc_registry_slot_t;
+
+typedef struct pdc_registry_index_t {
+    pdc_registry_slot_t *slot;
+    size_t               nslot;
+    size_t               nused;
+} pdc_registry_index_t;
+
+static pdc_registry_index_t analysis_index_g  = {NULL, 0, 0};
+static pdc_registry_index_t transform_index_g = {NULL, 0, 0};
+
+/*
+ * Functions resolved by PDC_get_ftnPtr_, indexed by library and function name. The entry of a library
+ * without a function name holds its dlopen handle. Libraries stay open for the life of the process, the
+ * registries keep pointers to their functions.
+ */
+typedef struct pdc_ftn_cache_entry_t {
+    struct pdc_ftn_cache_entry_t *next;
+    uint32_t                      hash;
+    void *                        ptr; /* dlopen handle of a library or address of a function */
+    char *                        ftn; /* NULL for a library */
+    char                          loadpath[];
+} pdc_ftn_cache_entry_t;
+
+static pdc_ftn_cache_entry_t **pdc_ftn_cache_bucket_g  = NULL;
+static uint32_t                pdc_ftn_cache_nbucket_g = 0;
+static uint32_t                pdc_ftn_cache_nentry_g  = 0;
+#ifdef ENABLE_MULTITHREAD
+static hg_thread_mutex_t pdc_ftn_cache_mutex_g = HG_THREAD_MUTEX_INITIALIZER;
+#endif
+
 #ifndef IS_PDC_SERVER
 // Dummy function for client to compile, real function is used only by server and code is in pdc_server.c
 perr_t
@@ -77,9 +117,121 @@ PDC_get_analysis_registry(struct _pdc_region_analysis_ftn_info ***registry ATTRI
 {
     return 0;
 };
+int
+PDC_Server_run_analysis(int (*ftn)() ATTRIBUTE(unused), pdcid_t iter_in ATTRIBUTE(unused),
+                        pdcid_t iter_out ATTRIBUTE(unused), struct _pdc_iterator_cbs_t *cbs ATTRIBUTE(unused),
+                        int flags ATTRIBUTE(unused))
+{
+    return 0;
+}
 #endif
 
 /* Internal support functions */
+
+/*
+ * Hash of a registry key
+ *
+ * \param  ftnPtr[IN]           Function of the entry
+ * \param  object_id[IN]        Object of the entry, 0 if the registry is not indexed by object
+ *
+ * \return Hash value
+ */
+static inline uint64_t
+pdc_registry_hash_(void *ftnPtr, pdcid_t object_id)
+{
+    uint64_t key = (uint64_t)(uintptr_t)ftnPtr ^ ((uint64_t)object_id * 0x9e3779b97f4a7c15ULL);
+
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return key;
+}
+
+/*
+ * Look up a function and object in a registry index
+ *
+ * \param  index[IN]            Registry index
+ * \param  ftnPtr[IN]           Function of the entry
+ * \param  object_id[IN]        Object of the entry
+ *
+ * \return Registry index of the entry/-1 if it is not found
+ */
+static int
+pdc_registry_index_find_(pdc_registry_index_t *index, void *ftnPtr, pdcid_t object_id)
+{
+    size_t i;
+
+    if (index->nslot == 0)
+        return -1;
+    for (i = pdc_registry_hash_(ftnPtr, object_id) & (index->nslot - 1); index->slot[i].index != 0;
+         i = (i + 1) & (index->nslot - 1)) {
+        if (index->slot[i].ftnPtr == ftnPtr && index->slot[i].object_id == object_id)
+            return index->slot[i].index - 1;
+    }
+    return -1;
+}
+
+/*
+ * Add an entry to a registry index, the slots double when they are half used
+ *
+ * \param  index[IN/OUT]        Registry index
+ * \param  ftnPtr[IN]           Function of the entry
+ * \param  object_id[IN]        Object of the entry
+ * \param  registry_index[IN]   Index of the entry in the registry
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static int
+pdc_registry_index_add_(pdc_registry_index_t *index, void *ftnPtr, pdcid_t object_id, int registry_index)
+{
+    pdc_registry_slot_t *old_slot = index->slot, *slot;
+    size_t               old_nslot = index->nslot, i, j;
+
+    if (2 * (index->nused + 1) > index->nslot) {
+        index->nslot = old_nslot ? 2 * old_nslot : 128;
+        index->slot  = (pdc_registry_slot_t *)calloc(index->nslot, sizeof(pdc_registry_slot_t));
+        if (index->slot == NULL) {
+            index->slot  = old_slot;
+            index->nslot = old_nslot;
+            return -1;
+        }
+        for (i = 0; i < old_nslot; i++) {
+            if (old_slot[i].index == 0)
+                continue;
+            j = pdc_registry_hash_(old_slot[i].ftnPtr, old_slot[i].object_id) & (index->nslot - 1);
+            while (index->slot[j].index != 0)
+                j = (j + 1) & (index->nslot - 1);
+            index->slot[j] = old_slot[i];
+        }
+        free(old_slot);
+    }
+
+    i = pdc_registry_hash_(ftnPtr, object_id) & (index->nslot - 1);
+    while (index->slot[i].index != 0)
+        i = (i + 1) & (index->nslot - 1);
+    slot            = &index->slot[i];
+    slot->ftnPtr    = ftnPtr;
+    slot->object_id = object_id;
+    slot->index     = registry_index + 1;
+    index->nused++;
+
+    return 0;
+}
+
+/*
+ * Free the slots of a registry index
+ *
+ * \param  index[IN/OUT]        Registry index
+ */
+static void
+pdc_registry_index_free_(pdc_registry_index_t *index)
+{
+    free(index->slot);
+    index->slot  = NULL;
+    index->nslot = 0;
+    index->nused = 0;
+}
+
 static int
 pdc_analysis_registry_init_(size_t newSize)
 {
@@ -200,7 +352,7 @@ PDC_add_analysis_ptr_to_registry_(struct _pdc_region_analysis_ftn_info *ftn_info
 {
     int    ret_value             = 0;
     size_t initial_registry_size = 64;
-    size_t i, currentCount;
+    size_t currentCount;
     int    registry_index;
 
     FUNC_ENTER(NULL);
@@ -219,14 +371,17 @@ PDC_add_analysis_ptr_to_registry_(struct _pdc_region_analysis_ftn_info *ftn_info
         }
     }
     /* If the new function is already registered
-     * simply return the OLD index.
+     * simply return the OLD index. A function registered with
+     * other flags gets its own entry.
      */
-    for (i = 0; i < currentCount; i++) {
-        if (ftn_infoPtr->ftnPtr == pdc_region_analysis_registry[i]->ftnPtr) {
-            PGOTO_DONE((int)i); /* Found match */
-        }
-    }
+    if ((registry_index = pdc_registry_index_find_(&analysis_index_g, (void *)ftn_infoPtr->ftnPtr,
+                                                   (pdcid_t)ftn_infoPtr->flags)) >= 0)
+        PGOTO_DONE(registry_index); /* Found match */
+
     registry_index = hg_atomic_get32(&registered_analysis_ftn_count_g);
+    if (pdc_registry_index_add_(&analysis_index_g, (void *)ftn_infoPtr->ftnPtr, (pdcid_t)ftn_infoPtr->flags,
+                                registry_index) < 0)
+        PGOTO_ERROR(-1, "memory allocation failed");
     hg_atomic_incr32(&registered_analysis_ftn_count_g);
     pdc_region_analysis_registry[registry_index] = ftn_infoPtr;
 
@@ -291,6 +446,22 @@ done:
     FUNC_LEAVE(ret_value);
 }
 
+void
+PDCiter_release_id(int id)
+{
+    int next_free;
+
+    FUNC_ENTER(NULL);
+
+    if (PDC_Block_iterator_cache != NULL && id > 0 && (size_t)id < iterator_cache_entries) {
+        memset(&PDC_Block_iterator_cache[id], 0, sizeof(struct _pdc_iterator_info));
+        next_free                = hg_atomic_incr32(&i_free_index) - 1;
+        i_cache_freed[next_free] = id;
+    }
+
+    FUNC_LEAVE_VOID;
+}
+
 /*
  * Analysis and Transform
  */
@@ -340,7 +511,7 @@ PDC_add_transform_ptr_to_registry_(struct _pdc_region_transform_ftn_info *ftn_in
 {
     int    ret_value             = 0;
     size_t initial_registry_size = 64;
-    size_t i, currentCount;
+    size_t currentCount;
     int    registry_index;
 
     FUNC_ENTER(NULL);
@@ -355,16 +526,19 @@ PDC_add_transform_ptr_to_registry_(struct _pdc_region_transform_ftn_info *ftn_in
             PGOTO_ERROR(-1, "memory allocation failed");
     }
     /* If the new function is already registered
-     * simply return the OLD index.
+     * simply return the OLD index. Pipelines are
+     * always registered as new entries.
      */
-    for (i = 0; i < currentCount; i++) {
-        if ((ftn_infoPtr->ftnPtr == pdc_region_transform_registry[i]->ftnPtr) &&
-            (ftn_infoPtr->object_id == pdc_region_transform_registry[i]->object_id)) {
-            PGOTO_DONE((int)i); /* Found match */
-        }
-    }
+    if (ftn_infoPtr->ftnPtr != NULL &&
+        (registry_index = pdc_registry_index_find_(&transform_index_g, (void *)ftn_infoPtr->ftnPtr,
+                                                   ftn_infoPtr->object_id)) >= 0)
+        PGOTO_DONE(registry_index); /* Found match */
 
     registry_index = hg_atomic_get32(&registered_transform_ftn_count_g);
+    if (ftn_infoPtr->ftnPtr != NULL &&
+        pdc_registry_index_add_(&transform_index_g, (void *)ftn_infoPtr->ftnPtr, ftn_infoPtr->object_id,
+                                registry_index) < 0)
+        PGOTO_ERROR(-1, "memory allocation failed");
     hg_atomic_incr32(&registered_transform_ftn_count_g);
     pdc_region_transform_registry[registry_index] = ftn_infoPtr;
 
@@ -417,31 +591,128 @@ PDC_get_execution_locus()
     FUNC_LEAVE(ret_value);
 }
 
+/*
+ * Look up a library or a function in the cache of PDC_get_ftnPtr_
+ *
+ * \param  loadpath[IN]         Path of the library
+ * \param  ftn[IN]              Name of the function, NULL for the library
+ * \param  hash[IN]             Hash of the key
+ *
+ * \return Pointer to the entry/NULL if it is not cached
+ */
+static pdc_ftn_cache_entry_t *
+PDC_ftn_cache_find(const char *loadpath, const char *ftn, uint32_t hash)
+{
+    pdc_ftn_cache_entry_t *entry;
+
+    if (pdc_ftn_cache_nbucket_g == 0)
+        return NULL;
+    for (entry = pdc_ftn_cache_bucket_g[hash & (pdc_ftn_cache_nbucket_g - 1)]; entry != NULL;
+         entry = entry->next) {
+        if (entry->hash != hash || strcmp(entry->loadpath, loadpath) != 0)
+            continue;
+        if (ftn == NULL ? entry->ftn == NULL : entry->ftn != NULL && strcmp(entry->ftn, ftn) == 0)
+            break;
+    }
+    return entry;
+}
+
+/*
+ * Add a library or a function to the cache of PDC_get_ftnPtr_, the buckets double when there are more
+ * entries than buckets
+ *
+ * \param  loadpath[IN]         Path of the library
+ * \param  ftn[IN]              Name of the function, NULL for the library
+ * \param  hash[IN]             Hash of the key
+ * \param  ptr[IN]              dlopen handle of the library or address of the function
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static int
+PDC_ftn_cache_add(const char *loadpath, const char *ftn, uint32_t hash, void *ptr)
+{
+    pdc_ftn_cache_entry_t **bucket, *entry, *next;
+    size_t                  path_len = strlen(loadpath) + 1;
+    uint32_t                nbucket, i;
+
+    if (pdc_ftn_cache_nentry_g >= pdc_ftn_cache_nbucket_g) {
+        nbucket = pdc_ftn_cache_nbucket_g ? 2 * pdc_ftn_cache_nbucket_g : 64;
+        if ((bucket = (pdc_ftn_cache_entry_t **)calloc(nbucket, sizeof(pdc_ftn_cache_entry_t *))) == NULL)
+            return -1;
+        for (i = 0; i < pdc_ftn_cache_nbucket_g; i++) {
+            for (entry = pdc_ftn_cache_bucket_g[i]; entry != NULL; entry = next) {
+                next                                = entry->next;
+                entry->next                         = bucket[entry->hash & (nbucket - 1)];
+                bucket[entry->hash & (nbucket - 1)] = entry;
+            }
+        }
+        free(pdc_ftn_cache_bucket_g);
+        pdc_ftn_cache_bucket_g  = bucket;
+        pdc_ftn_cache_nbucket_g = nbucket;
+    }
+
+    entry = (pdc_ftn_cache_entry_t *)malloc(sizeof(pdc_ftn_cache_entry_t) + path_len +
+                                            (ftn == NULL ? 0 : strlen(ftn) + 1));
+    if (entry == NULL)
+        return -1;
+    memcpy(entry->loadpath, loadpath, path_len);
+    entry->ftn = ftn == NULL ? NULL : strcpy(entry->loadpath + path_len, ftn);
+    entry->hash = hash;
+    entry->ptr  = ptr;
+    entry->next = pdc_ftn_cache_bucket_g[hash & (pdc_ftn_cache_nbucket_g - 1)];
+    pdc_ftn_cache_bucket_g[hash & (pdc_ftn_cache_nbucket_g - 1)] = entry;
+    pdc_ftn_cache_nentry_g++;
+
+    return 0;
+}
+
 int
 PDC_get_ftnPtr_(const char *ftn, const char *loadpath, void **ftnPtr)
 {
-    int          ret_value  = 0;
-    static void *appHandle  = NULL;
-    void *       ftnHandle  = NULL;
-    char *       this_error = NULL;
+    int                    ret_value = 0;
+    pdc_ftn_cache_entry_t *entry;
+    const char *           path      = loadpath == NULL ? "" : loadpath;
+    void *                 appHandle = NULL;
+    void *                 ftnHandle = NULL;
+    uint32_t               lib_hash, ftn_hash;
 
     FUNC_ENTER(NULL);
 
-    if (appHandle == NULL) {
-        if ((appHandle = dlopen(loadpath, RTLD_NOW)) == NULL) {
-            this_error = dlerror();
-            PGOTO_ERROR(-1, "dlopen failed: %s", this_error);
-        }
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&pdc_ftn_cache_mutex_g);
+#endif
+
+    // A function that was resolved before costs a hash lookup, a new one of a known library a dlsym
+    lib_hash = PDC_get_hash_by_name(path);
+    ftn_hash = lib_hash * 31 + PDC_get_hash_by_name(ftn);
+    if ((entry = PDC_ftn_cache_find(path, ftn, ftn_hash)) != NULL) {
+        *ftnPtr = entry->ptr;
+        PGOTO_DONE(0);
+    }
+
+    if ((entry = PDC_ftn_cache_find(path, NULL, lib_hash)) != NULL)
+        appHandle = entry->ptr;
+    else {
+        // A NULL path opens the program itself
+        if ((appHandle = dlopen(loadpath, RTLD_NOW)) == NULL)
+            PGOTO_ERROR(-1, "dlopen failed: %s", dlerror());
+        if (PDC_ftn_cache_add(path, NULL, lib_hash, appHandle) < 0)
+            PGOTO_ERROR(-1, "Unable to cache the handle of %s", path);
     }
     ftnHandle = dlsym(appHandle, ftn);
     if (ftnHandle == NULL)
         PGOTO_ERROR(-1, "dlsym failed: %s", dlerror());
+    if (PDC_ftn_cache_add(path, ftn, ftn_hash, ftnHandle) < 0)
+        PGOTO_ERROR(-1, "Unable to cache the address of %s", ftn);
 
     *ftnPtr = ftnHandle;
 
     ret_value = 0;
 
 done:
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&pdc_ftn_cache_mutex_g);
+#endif
     fflush(stdout);
     FUNC_LEAVE(ret_value);
 }
@@ -495,6 +766,7 @@ HG_TEST_RPC_CB(analysis_ftn, handle)
                      sizeof(struct _pdc_region_analysis_ftn_info), 1)) != NULL) {
                 thisFtn->ftnPtr    = (int (*)())ftnPtr;
                 thisFtn->n_args    = 2;
+                thisFtn->flags     = in.flags;
                 thisFtn->object_id = (pdcid_t *)calloc(2, sizeof(pdcid_t));
                 registrationId     = PDC_add_analysis_ptr_to_registry_(thisFtn);
                 out.remote_ftn_id  = registrationId;
@@ -605,6 +877,7 @@ PDC_free_analysis_registry()
         free(pdc_region_analysis_registry);
         pdc_region_analysis_registry = NULL;
     }
+    pdc_registry_index_free_(&analysis_index_g);
 
     FUNC_LEAVE_VOID;
 }
@@ -618,11 +891,13 @@ PDC_free_transform_registry()
 
     if (pdc_region_transform_registry && (registered_transform_ftn_count_g > 0)) {
         for (index = 0; index < registered_transform_ftn_count_g; index++) {
+            PDC_transform_pipeline_free(pdc_region_transform_registry[index]->pipeline);
             free(pdc_region_transform_registry[index]);
         }
         free(pdc_region_transform_registry);
         pdc_region_transform_registry = NULL;
     }
+    pdc_registry_index_free_(&transform_index_g);
 
     FUNC_LEAVE_VOID;
 }
@@ -116,13 +116,14 @@ void PDC_set_execution_locus(_pdc_loci_t locus_identifier);
 int PDC_add_analysis_ptr_to_registry_(struct _pdc_region_analysis_ftn_info *ftn_infoPtr);
 
 /**
- * *****
+ * Resolve a function of a library. The libraries and the functions are cached by path and name, so only
+ * the first lookup of a function calls dlopen and dlsym
  *
- * \param ftn [IN]              *******
- * \param loadpath [IN]         *******
- * \param ftnPtr [IN]           *******
+ * \param ftn [IN]              Name of the function
+ * \param loadpath [IN]         Path of the library, NULL for the program itself
+ * \param ftnPtr [OUT]          Address of the function
  *
- * \return *****
+ * \return Non-negative on success/Negative on failure
  */
 int PDC_get_ftnPtr_(const char *ftn, const char *loadpath, void **ftnPtr);
 
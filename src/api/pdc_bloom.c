@@ -0,0 +1,185 @@
+/*
+ * Copyright Notice for
+ * Proactive Data Containers (PDC) Software Library and Utilities
+ * -----------------------------------------------------------------------------
+
+ *** Copyright Notice ***
+
+ * Proactive Data Containers (PDC) Copyright (c) 2017, The Regents of the
+ * University of California, through Lawrence Berkeley National Laboratory,
+ * UChicago Argonne, LLC, operator of Argonne National Laboratory, and The HDF
+ * Group (subject to receipt of any required approvals from the U.S. Dept. of
+ * Energy).  All rights reserved.
+
+ * If you have questions about your rights to use or distribute this software,
+ * please contact Berkeley Lab's Innovation & Partnerships Office at  IPO@lbl.gov.
+
+ * NOTICE.  This Software was developed under funding from the U.S. Department of
+ * Energy and the U.S. Government consequently retains certain rights. As such, the
+ * U.S. Government has been granted for itself and others acting on its behalf a
+ * paid-up, nonexclusive, irrevocable, worldwide license in the Software to
+ * reproduce, distribute copies to the public, prepare derivative works, and
+ * perform publicly and display publicly, and to permit other to do so.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#include "pdc_bloom.h"
+#include "pdc_private.h"
+
+// Odd multipliers that pick the bit of each word of a block from the same 32-bit key hash
+static const uint32_t pdc_bloom_salt_g[PDC_BLOOM_BLOCK_WORDS] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU,
+                                                                 0xa2b7289dU, 0x705495c7U, 0x2df1424bU,
+                                                                 0x9efc4947U, 0x5c6bfb31U};
+
+// FNV-1a followed by the MurmurHash3 64-bit finalizer, the block and the bits use different halves
+static inline uint64_t
+pdc_bloom_hash(const void *key, size_t len)
+{
+    const unsigned char *p = (const unsigned char *)key;
+    uint64_t             h = 14695981039346656037ULL;
+    size_t               i;
+
+    for (i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static inline uint32_t *
+pdc_bloom_block(const pdc_bloom_t *bloom, uint64_t hash)
+{
+    // Multiply-shift maps the upper half of the hash to a block without a division
+    return bloom->blocks + (((hash >> 32) * bloom->n_block) >> 32) * PDC_BLOOM_BLOCK_WORDS;
+}
+
+#ifdef __AVX2__
+static inline __m256i
+pdc_bloom_mask(uint32_t key)
+{
+    __m256i salt = _mm256_loadu_si256((const __m256i *)pdc_bloom_salt_g);
+    __m256i bit  = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(key), salt), 27);
+
+    return _mm256_sllv_epi32(_mm256_set1_epi32(1), bit);
+}
+#endif
+
+pdc_bloom_t *
+PDC_bloom_new(uint64_t capacity)
+{
+    pdc_bloom_t *ret_value = NULL;
+    pdc_bloom_t *bloom     = NULL;
+    void *       blocks    = NULL;
+    uint64_t     n_block;
+
+    FUNC_ENTER(NULL);
+
+    if (capacity == 0)
+        capacity = 1;
+    n_block = (capacity * PDC_BLOOM_BITS_PER_ITEM + PDC_BLOOM_BLOCK_WORDS * 32 - 1) /
+              (PDC_BLOOM_BLOCK_WORDS * 32);
+    if (n_block > 0xffffffffULL)
+        PGOTO_ERROR(NULL, "==PDC: bloom filter capacity %" PRIu64 " is too large", capacity);
+
+    bloom = (pdc_bloom_t *)calloc(1, sizeof(pdc_bloom_t));
+    if (bloom == NULL)
+        PGOTO_ERROR(NULL, "==PDC: ERROR allocating bloom filter");
+    if (posix_memalign(&blocks, 64, n_block * PDC_BLOOM_BLOCK_WORDS * sizeof(uint32_t)) != 0) {
+        free(bloom);
+        PGOTO_ERROR(NULL, "==PDC: ERROR allocating %" PRIu64 " bloom filter blocks", n_block);
+    }
+
+    bloom->blocks   = (uint32_t *)blocks;
+    bloom->n_block  = n_block;
+    bloom->capacity = capacity;
+    PDC_bloom_clear(bloom);
+
+    ret_value = bloom;
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+void
+PDC_bloom_free(pdc_bloom_t *bloom)
+{
+    FUNC_ENTER(NULL);
+
+    if (bloom != NULL) {
+        free(bloom->blocks);
+        free(bloom);
+    }
+
+    FUNC_LEAVE_VOID;
+}
+
+void
+PDC_bloom_clear(pdc_bloom_t *bloom)
+{
+    FUNC_ENTER(NULL);
+
+    memset(bloom->blocks, 0, bloom->n_block * PDC_BLOOM_BLOCK_WORDS * sizeof(uint32_t));
+    bloom->n_item = 0;
+
+    FUNC_LEAVE_VOID;
+}
+
+void
+PDC_bloom_add(pdc_bloom_t *bloom, const void *key, size_t len)
+{
+    uint64_t  hash  = pdc_bloom_hash(key, len);
+    uint32_t *block = pdc_bloom_block(bloom, hash);
+#ifndef __AVX2__
+    int i;
+#endif
+
+    FUNC_ENTER(NULL);
+
+#ifdef __AVX2__
+    _mm256_store_si256((__m256i *)block, _mm256_or_si256(_mm256_load_si256((const __m256i *)block),
+                                                         pdc_bloom_mask((uint32_t)hash)));
+#else
+    for (i = 0; i < PDC_BLOOM_BLOCK_WORDS; i++)
+        block[i] |= 1U << (((uint32_t)hash * pdc_bloom_salt_g[i]) >> 27);
+#endif
+    bloom->n_item++;
+
+    FUNC_LEAVE_VOID;
+}
+
+int
+PDC_bloom_check(const pdc_bloom_t *bloom, const void *key, size_t len)
+{
+    uint64_t  hash  = pdc_bloom_hash(key, len);
+    uint32_t *block = pdc_bloom_block(bloom, hash);
+#ifndef __AVX2__
+    uint32_t miss = 0;
+    int      i;
+#endif
+    int ret_value;
+
+    FUNC_ENTER(NULL);
+
+#ifdef __AVX2__
+    // All the bits of the mask must be set in the block
+    ret_value = _mm256_testc_si256(_mm256_load_si256((const __m256i *)block), pdc_bloom_mask((uint32_t)hash));
+#else
+    // Branch-free over the eight words so the compiler can vectorize the probe
+    for (i = 0; i < PDC_BLOOM_BLOCK_WORDS; i++)
+        miss |= ~block[i] & (1U << (((uint32_t)hash * pdc_bloom_salt_g[i]) >> 27));
+    ret_value = (miss == 0);
+#endif
+
+    FUNC_LEAVE(ret_value);
+}
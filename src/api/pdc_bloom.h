@@ -0,0 +1,88 @@
+/*
+ * Copyright Notice for
+ * Proactive Data Containers (PDC) Software Library and Utilities
+ * -----------------------------------------------------------------------------
+
+ *** Copyright Notice ***
+
+ * Proactive Data Containers (PDC) Copyright (c) 2017, The Regents of the
+ * University of California, through Lawrence Berkeley National Laboratory,
+ * UChicago Argonne, LLC, operator of Argonne National Laboratory, and The HDF
+ * Group (subject to receipt of any required approvals from the U.S. Dept. of
+ * Energy).  All rights reserved.
+
+ * If you have questions about your rights to use or distribute this software,
+ * please contact Berkeley Lab's Innovation & Partnerships Office at  IPO@lbl.gov.
+
+ * NOTICE.  This Software was developed under funding from the U.S. Department of
+ * Energy and the U.S. Government consequently retains certain rights. As such, the
+ * U.S. Government has been granted for itself and others acting on its behalf a
+ * paid-up, nonexclusive, irrevocable, worldwide license in the Software to
+ * reproduce, distribute copies to the public, prepare derivative works, and
+ * perform publicly and display publicly, and to permit other to do so.
+ */
+
+#ifndef PDC_BLOOM_H
+#define PDC_BLOOM_H
+
+#include "pdc_public.h"
+
+/*
+ * Cache-blocked bloom filter. All the bits of a key are in one 256-bit block, one bit in each of the
+ * eight 32-bit words, so a check touches a single cache line and the eight words are probed at once.
+ * Keys cannot be removed, the owner rebuilds the filter once it is too full or too stale.
+ */
+#define PDC_BLOOM_BLOCK_WORDS   8
+#define PDC_BLOOM_BITS_PER_ITEM 16
+
+typedef struct pdc_bloom_t {
+    uint32_t *blocks;   /* n_block * PDC_BLOOM_BLOCK_WORDS words, aligned to a cache line */
+    uint64_t  n_block;
+    uint64_t  capacity; /* number of keys for the designed false positive rate */
+    uint64_t  n_item;
+} pdc_bloom_t;
+
+/**
+ * Create an empty bloom filter
+ *
+ * \param capacity [IN]         Number of keys the filter is sized for
+ *
+ * \return Pointer to the filter on success/NULL on failure
+ */
+pdc_bloom_t *PDC_bloom_new(uint64_t capacity);
+
+/**
+ * Free a bloom filter
+ *
+ * \param bloom [IN]            Pointer to the filter
+ */
+void PDC_bloom_free(pdc_bloom_t *bloom);
+
+/**
+ * Clear all the keys of a bloom filter
+ *
+ * \param bloom [IN]            Pointer to the filter
+ */
+void PDC_bloom_clear(pdc_bloom_t *bloom);
+
+/**
+ * Add a key to a bloom filter
+ *
+ * \param bloom [IN]            Pointer to the filter
+ * \param key [IN]              Key
+ * \param len [IN]              Length of the key in bytes
+ */
+void PDC_bloom_add(pdc_bloom_t *bloom, const void *key, size_t len);
+
+/**
+ * Check if a key may be in a bloom filter
+ *
+ * \param bloom [IN]            Pointer to the filter
+ * \param key [IN]              Key
+ * \param len [IN]              Length of the key in bytes
+ *
+ * \return 1 if the key may have been added/0 if it has not been added
+ */
+int PDC_bloom_check(const pdc_bloom_t *bloom, const void *key, size_t len);
+
+#endif /* PDC_BLOOM_H */
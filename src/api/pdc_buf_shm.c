@@ -0,0 +1,248 @@
+/*
+ * Copyright Notice for
+ * Proactive Data Containers (PDC) Software Library and Utilities
+ * -----------------------------------------------------------------------------
+
+ *** Copyright Notice ***
+
+ * Proactive Data Containers (PDC) Copyright (c) 2017, The Regents of the
+ * University of California, through Lawrence Berkeley National Laboratory,
+ * UChicago Argonne, LLC, operator of Argonne National Laboratory, and The HDF
+ * Group (subject to receipt of any required approvals from the U.S. Dept. of
+ * Energy).  All rights reserved.
+
+ * If you have questions about your rights to use or distribute this software,
+ * please contact Berkeley Lab's Innovation & Partnerships Office at  IPO@lbl.gov.
+
+ * NOTICE.  This Software was developed under funding from the U.S. Department of
+ * Energy and the U.S. Government consequently retains certain rights. As such, the
+ * U.S. Government has been granted for itself and others acting on its behalf a
+ * paid-up, nonexclusive, irrevocable, worldwide license in the Software to
+ * reproduce, distribute copies to the public, prepare derivative works, and
+ * perform publicly and display publicly, and to permit other to do so.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "pdc_buf_shm.h"
+#include "pdc_private.h"
+
+// Longest name of a shared memory segment
+#define PDC_BUF_SHM_NAME_MAX 256
+
+// Extents start on a page, so the memory of a freed extent can be given back without touching others
+#define PDC_BUF_SHM_ALIGN 4096
+#define PDC_BUF_SHM_ROUND(x) (((x) + PDC_BUF_SHM_ALIGN - 1) & ~(uint64_t)(PDC_BUF_SHM_ALIGN - 1))
+
+typedef struct pdc_buf_shm_extent_t {
+    uint64_t                     offset;
+    uint64_t                     size;
+    struct pdc_buf_shm_extent_t *next;
+} pdc_buf_shm_extent_t;
+
+struct pdc_buf_shm_t {
+    char                  name[PDC_BUF_SHM_NAME_MAX];
+    int                   fd;
+    void *                base;
+    uint64_t              size;
+    pdc_buf_shm_extent_t *extents; // Allocated extents, sorted by offset
+};
+
+pdc_buf_shm_t *
+PDC_buf_shm_create(const char *name, uint64_t size)
+{
+    pdc_buf_shm_t *ret_value = NULL;
+
+    FUNC_ENTER(NULL);
+
+    if (name == NULL || size == 0 || strlen(name) >= PDC_BUF_SHM_NAME_MAX)
+        PGOTO_DONE(NULL);
+
+    ret_value = (pdc_buf_shm_t *)calloc(1, sizeof(pdc_buf_shm_t));
+    if (ret_value == NULL)
+        PGOTO_ERROR(NULL, "cannot allocate buf shm arena");
+    strcpy(ret_value->name, name);
+    ret_value->size = size;
+
+    ret_value->fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (ret_value->fd < 0) {
+        free(ret_value);
+        PGOTO_ERROR(NULL, "cannot create shared memory %s", name);
+    }
+    if (ftruncate(ret_value->fd, size) != 0) {
+        close(ret_value->fd);
+        shm_unlink(name);
+        free(ret_value);
+        PGOTO_ERROR(NULL, "cannot resize shared memory %s", name);
+    }
+    ret_value->base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, ret_value->fd, 0);
+    if (ret_value->base == MAP_FAILED) {
+        close(ret_value->fd);
+        shm_unlink(name);
+        free(ret_value);
+        PGOTO_ERROR(NULL, "cannot map shared memory %s", name);
+    }
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+void
+PDC_buf_shm_destroy(pdc_buf_shm_t *arena)
+{
+    pdc_buf_shm_extent_t *extent, *next;
+
+    FUNC_ENTER(NULL);
+
+    if (arena == NULL)
+        PGOTO_DONE_VOID;
+
+    for (extent = arena->extents; extent != NULL; extent = next) {
+        next = extent->next;
+        free(extent);
+    }
+    munmap(arena->base, arena->size);
+    close(arena->fd);
+    shm_unlink(arena->name);
+    free(arena);
+
+done:
+    FUNC_LEAVE_VOID;
+}
+
+const char *
+PDC_buf_shm_name(pdc_buf_shm_t *arena)
+{
+    return arena->name;
+}
+
+void *
+PDC_buf_shm_alloc(pdc_buf_shm_t *arena, uint64_t size, uint64_t *offset)
+{
+    void *                 ret_value = NULL;
+    pdc_buf_shm_extent_t **pp, *extent;
+    uint64_t               start = 0;
+
+    FUNC_ENTER(NULL);
+
+    if (arena == NULL || size == 0)
+        PGOTO_DONE(NULL);
+
+    // First gap between the sorted extents that fits
+    for (pp = &arena->extents; *pp != NULL; pp = &(*pp)->next) {
+        if ((*pp)->offset - start >= size)
+            break;
+        start = PDC_BUF_SHM_ROUND((*pp)->offset + (*pp)->size);
+    }
+    if (start > arena->size || arena->size - start < size)
+        PGOTO_DONE(NULL);
+
+    // Reserve the memory of the extent now, so a full node fails here instead of with SIGBUS on access
+    if (posix_fallocate(arena->fd, start, size) != 0)
+        PGOTO_DONE(NULL);
+
+    extent = (pdc_buf_shm_extent_t *)malloc(sizeof(pdc_buf_shm_extent_t));
+    if (extent == NULL)
+        PGOTO_ERROR(NULL, "cannot allocate buf shm extent");
+    extent->offset = start;
+    extent->size   = size;
+    extent->next   = *pp;
+    *pp            = extent;
+
+    *offset   = start;
+    ret_value = (char *)arena->base + start;
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+void
+PDC_buf_shm_free(pdc_buf_shm_t *arena, uint64_t offset)
+{
+    pdc_buf_shm_extent_t **pp, *extent;
+
+    FUNC_ENTER(NULL);
+
+    if (arena == NULL)
+        PGOTO_DONE_VOID;
+
+    for (pp = &arena->extents; *pp != NULL; pp = &(*pp)->next) {
+        if ((*pp)->offset == offset) {
+            extent = *pp;
+            *pp    = extent->next;
+            // Give the memory back to the node, the segment itself stays mapped
+            madvise((char *)arena->base + extent->offset, PDC_BUF_SHM_ROUND(extent->size), MADV_REMOVE);
+            free(extent);
+            break;
+        }
+    }
+
+done:
+    FUNC_LEAVE_VOID;
+}
+
+void *
+PDC_buf_shm_attach(const char *name, uint64_t *size)
+{
+    void *      ret_value = NULL;
+    struct stat st;
+    int         fd;
+
+    FUNC_ENTER(NULL);
+
+    if (name == NULL || name[0] == 0)
+        PGOTO_DONE(NULL);
+
+    // A client on another node has its segment there, the open fails and the server keeps using bulk
+    fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0)
+        PGOTO_DONE(NULL);
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        PGOTO_DONE(NULL);
+    }
+    ret_value = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ret_value == MAP_FAILED)
+        PGOTO_DONE(NULL);
+
+    *size = st.st_size;
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+int
+PDC_buf_shm_exists(const char *name)
+{
+    int ret_value = 1;
+    int fd;
+
+    FUNC_ENTER(NULL);
+
+    // Only a missing name tells that the client is gone, other errors such as too many open files do not
+    fd = shm_open(name, O_RDONLY, 0);
+    if (fd >= 0)
+        close(fd);
+    else if (errno == ENOENT)
+        ret_value = 0;
+
+    FUNC_LEAVE(ret_value);
+}
+
+void
+PDC_buf_shm_detach(void *base, uint64_t size)
+{
+    FUNC_ENTER(NULL);
+
+    if (base != NULL)
+        munmap(base, size);
+
+    FUNC_LEAVE_VOID;
+}
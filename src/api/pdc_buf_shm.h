@@ -0,0 +1,129 @@
+/*
+ * Copyright Notice for
+ * Proactive Data Containers (PDC) Software Library and Utilities
+ * -----------------------------------------------------------------------------
+
+ *** Copyright Notice ***
+
+ * Proactive Data Containers (PDC) Copyright (c) 2017, The Regents of the
+ * University of California, through Lawrence Berkeley National Laboratory,
+ * UChicago Argonne, LLC, operator of Argonne National Laboratory, and The HDF
+ * Group (subject to receipt of any required approvals from the U.S. Dept. of
+ * Energy).  All rights reserved.
+
+ * If you have questions about your rights to use or distribute this software,
+ * please contact Berkeley Lab's Innovation & Partnerships Office at  IPO@lbl.gov.
+
+ * NOTICE.  This Software was developed under funding from the U.S. Department of
+ * Energy and the U.S. Government consequently retains certain rights. As such, the
+ * U.S. Government has been granted for itself and others acting on its behalf a
+ * paid-up, nonexclusive, irrevocable, worldwide license in the Software to
+ * reproduce, distribute copies to the public, prepare derivative works, and
+ * perform publicly and display publicly, and to permit other to do so.
+ */
+
+#ifndef PDC_BUF_SHM_H
+#define PDC_BUF_SHM_H
+
+#include <stdint.h>
+#include "pdc_public.h"
+
+/*
+ * Shared memory arena of a client for the buf-map data of co-located data servers. The client creates
+ * one POSIX shared memory segment and places the data of each mapped region in an extent of it; a data
+ * server on the same node maps the segment once and copies the data in and out of the extents instead
+ * of doing a Mercury bulk transfer. A server on another node cannot open the segment and keeps using
+ * bulk transfers.
+ */
+#define PDC_BUF_SHM_SIZE_MB 1024
+
+/*
+ * Each extent given to a server starts with a header, the data of the region follows it. The server sets
+ * filled once it copied the data of a read release into the extent, a read release that has no new data
+ * leaves it unset and the client keeps its buffer as is.
+ */
+#define PDC_BUF_SHM_HDR_SIZE 64
+
+typedef struct pdc_buf_shm_hdr_t {
+    volatile int32_t filled;
+} pdc_buf_shm_hdr_t;
+
+// Header of the extent holding the region data at data
+#define PDC_BUF_SHM_HDR(data) ((pdc_buf_shm_hdr_t *)((char *)(data)-PDC_BUF_SHM_HDR_SIZE))
+
+typedef struct pdc_buf_shm_t pdc_buf_shm_t;
+
+/**
+ * Create the shared memory arena of a client. The segment is sparse, its memory is reserved as
+ * extents are allocated.
+ *
+ * \param name [IN]             Name of the shared memory segment
+ * \param size [IN]             Size of the segment in bytes
+ *
+ * \return Pointer to the arena on success/NULL on failure
+ */
+pdc_buf_shm_t *PDC_buf_shm_create(const char *name, uint64_t size);
+
+/**
+ * Unmap and remove the shared memory arena of a client
+ *
+ * \param arena [IN]            Pointer to the arena
+ */
+void PDC_buf_shm_destroy(pdc_buf_shm_t *arena);
+
+/**
+ * Get the name of the shared memory segment of an arena
+ *
+ * \param arena [IN]            Pointer to the arena
+ *
+ * \return Name of the segment
+ */
+const char *PDC_buf_shm_name(pdc_buf_shm_t *arena);
+
+/**
+ * Allocate an extent of an arena
+ *
+ * \param arena [IN]            Pointer to the arena
+ * \param size [IN]             Size of the extent in bytes
+ * \param offset [OUT]          Offset of the extent in the segment
+ *
+ * \return Pointer to the extent on success/NULL if the arena has no room for it
+ */
+void *PDC_buf_shm_alloc(pdc_buf_shm_t *arena, uint64_t size, uint64_t *offset);
+
+/**
+ * Free an extent of an arena
+ *
+ * \param arena [IN]            Pointer to the arena
+ * \param offset [IN]           Offset of the extent in the segment
+ */
+void PDC_buf_shm_free(pdc_buf_shm_t *arena, uint64_t offset);
+
+/**
+ * Map the shared memory arena of a client into the server
+ *
+ * \param name [IN]             Name of the shared memory segment
+ * \param size [OUT]            Size of the segment in bytes
+ *
+ * \return Base address of the segment on success/NULL if it is not on this node
+ */
+void *PDC_buf_shm_attach(const char *name, uint64_t *size);
+
+/**
+ * Check if the shared memory arena of a client still exists, the client removes it when it finalizes
+ *
+ * \param name [IN]             Name of the shared memory segment
+ *
+ * \return 0 if the segment has been removed/1 otherwise
+ */
+int PDC_buf_shm_exists(const char *name);
+
+/**
+ * Unmap a shared memory arena mapped with PDC_buf_shm_attach
+ *
+ * \param base [IN]             Base address of the segment
+ * \param size [IN]             Size of the segment in bytes
+ */
+void PDC_buf_shm_detach(void *base, uint64_t size);
+
+#endif /* PDC_BUF_SHM_H */
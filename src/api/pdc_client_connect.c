@@ -40,6 +40,10 @@
 #include "pdc_interface.h"
 #include "pdc_analysis_pkg.h"
 #include "pdc_transforms_common.h"
+#include "pdc_placement.h"
+#include "pdc_meta_cache.h"
+#include "pdc_buf_shm.h"
+#include "pdc_dt_conv.h"
 #include "pdc_client_connect.h"
 
 #include "mercury.h"
@@ -56,6 +60,7 @@
 #include <sys/stat.h>
 #include <sys/mman.h>
 #include <inttypes.h>
+#include <limits.h>
 #include <math.h>
 #include <sys/time.h>
 
@@ -100,8 +105,37 @@ static hg_context_t *send_context_g     = NULL;
 static int           work_todo_g        = 0;
 int                  query_id_g         = 0;
 
+// Metadata of queried objects, used while the server lease is valid
+static pdc_meta_cache_t *metadata_cache_g = NULL;
+
+// Buf-map region whose data goes through the shared memory of the client to a server on the same node, or
+// through a staging buffer in the type of the object when it differs from the type of the user buffer
+typedef struct pdc_buf_shm_map_t {
+    pdcid_t                obj_id;
+    uint32_t               server_id;
+    region_info_transfer_t remote_region;
+    uint64_t               offset;
+    void *                 shm_buf;  // Shared memory, or the staging buffer
+    void *                 conv_buf; // Staging buffer allocated outside of the shared memory, NULL if none
+    int                    shm;      // 1 if the server copies the data to and from the shared memory
+    pdc_var_type_t         local_type;
+    pdc_var_type_t         remote_type;
+    hg_uint32_t            count;     // Number of contiguous segments of the user buffer
+    void **                data_ptrs; // Segments of the user buffer
+    size_t *               data_size;
+
+    struct pdc_buf_shm_map_t *prev;
+    struct pdc_buf_shm_map_t *next;
+} pdc_buf_shm_map_t;
+
+// Shared memory of the client for buf-map data, created on the first map
+static pdc_buf_shm_t *    buf_shm_g          = NULL;
+static uint64_t           buf_shm_size_g     = (uint64_t)PDC_BUF_SHM_SIZE_MB * 1048576;
+static pdc_buf_shm_map_t *buf_shm_map_head_g = NULL;
+
 static hg_id_t client_test_connect_register_id_g;
 static hg_id_t gen_obj_register_id_g;
+static hg_id_t metadata_bulk_create_register_id_g;
 static hg_id_t gen_cont_register_id_g;
 static hg_id_t close_server_register_id_g;
 static hg_id_t metadata_query_register_id_g;
@@ -113,6 +147,7 @@ static hg_id_t metadata_add_tag_register_id_g;
 static hg_id_t metadata_add_kvtag_register_id_g;
 static hg_id_t metadata_del_kvtag_register_id_g;
 static hg_id_t metadata_get_kvtag_register_id_g;
+static hg_id_t obj_get_stats_register_id_g;
 static hg_id_t region_lock_register_id_g;
 static hg_id_t region_release_register_id_g;
 static hg_id_t transform_region_release_register_id_g;
@@ -143,6 +178,7 @@ static hg_id_t send_region_storage_meta_shm_bulk_rpc_register_id_g;
 // data query
 static hg_id_t send_data_query_register_id_g;
 static hg_id_t get_sel_data_register_id_g;
+static hg_id_t query_cursor_register_id_g;
 
 int                        cache_percentage_g       = 0;
 int                        cache_count_g            = 0;
@@ -157,7 +193,7 @@ pdc_data_server_io_list_t *client_cache_list_head_g = NULL;
 static inline uint32_t
 get_server_id_by_hash_name(const char *name)
 {
-    return (uint32_t)(PDC_get_hash_by_name(name) % pdc_server_num_g);
+    return PDC_placement_get_server(PDC_get_hash_by_name(name), pdc_server_num_g);
 }
 
 static inline uint32_t
@@ -367,10 +403,11 @@ client_send_buf_map_rpc_cb(const struct hg_cb_info *callback_info)
     }
 
     buf_map_args->ret = output.ret;
+    buf_map_args->shm = output.shm;
 
 done:
     fflush(stdout);
-    work_todo_g = 0;
+    work_todo_g--;
     HG_Free_output(handle, &output);
 
     FUNC_LEAVE(ret_value);
@@ -658,6 +695,7 @@ hg_test_bulk_transfer_cb(const struct hg_cb_info *hg_cb_info)
     uint64_t            buf_sizes[2] = {0, 0};
     uint32_t            actual_cnt;
     pdc_metadata_t *    meta_ptr;
+    size_t              offset;
 
     FUNC_ENTER(NULL);
 
@@ -675,10 +713,21 @@ hg_test_bulk_transfer_cb(const struct hg_cb_info *hg_cb_info)
         HG_Bulk_access(local_bulk_handle, 0, bulk_args->nbytes, HG_BULK_READWRITE, 1, &buf, buf_sizes,
                        &actual_cnt);
 
-        meta_ptr            = (pdc_metadata_t *)(buf);
+        meta_ptr            = (pdc_metadata_t *)calloc(sizeof(pdc_metadata_t), n_meta);
         bulk_args->meta_arr = (pdc_metadata_t **)calloc(sizeof(pdc_metadata_t *), n_meta);
+        offset              = 0;
         for (i = 0; i < n_meta; i++) {
-            bulk_args->meta_arr[i] = meta_ptr;
+            offset += PDC_metadata_deserialize((char *)buf + offset, meta_ptr);
+            meta_ptr->storage_region_list_head = NULL;
+            meta_ptr->region_lock_head         = NULL;
+            meta_ptr->region_map_head          = NULL;
+            meta_ptr->region_buf_map_head      = NULL;
+            meta_ptr->kvtag_list_head          = NULL;
+            meta_ptr->obj_hist                 = NULL;
+            meta_ptr->prev                     = NULL;
+            meta_ptr->next                     = NULL;
+            meta_ptr->bloom                    = NULL;
+            bulk_args->meta_arr[i]             = meta_ptr;
             meta_ptr++;
         }
     }
@@ -693,6 +742,7 @@ hg_test_bulk_transfer_cb(const struct hg_cb_info *hg_cb_info)
 
 done:
     fflush(stdout);
+    free(buf);
     free(bulk_args);
 
     FUNC_LEAVE(ret_value);
@@ -851,10 +901,11 @@ drc_access_again:
     *hg_context = HG_Context_create(*hg_class);
 
     // Register RPC
-    client_test_connect_register_id_g = PDC_client_test_connect_register(*hg_class);
-    gen_obj_register_id_g             = PDC_gen_obj_id_register(*hg_class);
-    gen_cont_register_id_g            = PDC_gen_cont_id_register(*hg_class);
-    close_server_register_id_g        = PDC_close_server_register(*hg_class);
+    client_test_connect_register_id_g  = PDC_client_test_connect_register(*hg_class);
+    gen_obj_register_id_g              = PDC_gen_obj_id_register(*hg_class);
+    metadata_bulk_create_register_id_g = PDC_metadata_bulk_create_register(*hg_class);
+    gen_cont_register_id_g             = PDC_gen_cont_id_register(*hg_class);
+    close_server_register_id_g         = PDC_close_server_register(*hg_class);
     HG_Registered_disable_response(*hg_class, close_server_register_id_g, HG_TRUE);
 
     metadata_query_register_id_g           = PDC_metadata_query_register(*hg_class);
@@ -866,6 +917,7 @@ drc_access_again:
     metadata_add_kvtag_register_id_g       = PDC_metadata_add_kvtag_register(*hg_class);
     metadata_del_kvtag_register_id_g       = PDC_metadata_del_kvtag_register(*hg_class);
     metadata_get_kvtag_register_id_g       = PDC_metadata_get_kvtag_register(*hg_class);
+    obj_get_stats_register_id_g            = PDC_obj_get_stats_register(*hg_class);
     region_lock_register_id_g              = PDC_region_lock_register(*hg_class);
     region_release_register_id_g           = PDC_region_release_register(*hg_class);
     transform_region_release_register_id_g = PDC_transform_region_release_register(*hg_class);
@@ -912,6 +964,7 @@ drc_access_again:
     // Data query
     send_data_query_register_id_g = PDC_send_data_query_rpc_register(*hg_class);
     get_sel_data_register_id_g    = PDC_get_sel_data_rpc_register(*hg_class);
+    query_cursor_register_id_g    = PDC_query_cursor_rpc_register(*hg_class);
 
 #ifdef ENABLE_MULTITHREAD
     /* Mutex initialization for the client versions of these... */
@@ -1026,8 +1079,25 @@ PDC_Client_init()
         pdc_nclient_per_server_g = 1;
 #endif
 
+    // Names must be routed to the same servers as the servers route them
+    if (PDC_placement_init_env(pdc_server_num_g) != SUCCEED)
+        printf("==PDC_CLIENT[%d]: Error setting up server placement, using modulo placement\n",
+               pdc_client_mpi_rank_g);
+
     PDC_set_execution_locus(CLIENT_MEMORY);
 
+    // 0 disables the metadata cache
+    tmp_dir = getenv("PDC_META_CACHE_CAPACITY");
+    if (tmp_dir == NULL)
+        metadata_cache_g = PDC_meta_cache_new(PDC_META_CACHE_CAPACITY);
+    else if (atoi(tmp_dir) > 0)
+        metadata_cache_g = PDC_meta_cache_new(atoi(tmp_dir));
+
+    // Size in MB of the shared memory for buf-map data, 0 always uses bulk transfers
+    tmp_dir = getenv("PDC_BUF_SHM_SIZE");
+    if (tmp_dir != NULL)
+        buf_shm_size_g = (uint64_t)atoll(tmp_dir) * 1048576;
+
     if (pdc_client_mpi_rank_g == 0) {
         printf("==PDC_CLIENT[0]: Found %d PDC Metadata servers, running with %d PDC clients\n",
                pdc_server_num_g, pdc_client_mpi_size_g);
@@ -1088,9 +1158,11 @@ PDC_Client_destroy_all_handles()
 perr_t
 PDC_Client_finalize()
 {
-    hg_return_t hg_ret;
-    perr_t      ret_value = SUCCEED;
-    int         i;
+    hg_return_t        hg_ret;
+    perr_t             ret_value = SUCCEED;
+    int                i;
+    uint64_t           n_cache_hit, n_cache_miss;
+    pdc_buf_shm_map_t *shm_map, *shm_map_tmp;
 
     FUNC_ENTER(NULL);
 
@@ -1105,6 +1177,28 @@ PDC_Client_finalize()
     if (pdc_server_info_g != NULL)
         free(pdc_server_info_g);
 
+    PDC_placement_finalize();
+
+    if (is_client_debug_g == 1 && metadata_cache_g != NULL) {
+        PDC_meta_cache_stats(metadata_cache_g, &n_cache_hit, &n_cache_miss);
+        printf("==PDC_CLIENT[%d]: metadata cache %" PRIu64 " hits, %" PRIu64 " misses\n",
+               pdc_client_mpi_rank_g, n_cache_hit, n_cache_miss);
+    }
+    PDC_meta_cache_free(metadata_cache_g);
+    metadata_cache_g = NULL;
+
+    // Regions still mapped, their extents go away with the shared memory
+    DL_FOREACH_SAFE(buf_shm_map_head_g, shm_map, shm_map_tmp)
+    {
+        DL_DELETE(buf_shm_map_head_g, shm_map);
+        free(shm_map->conv_buf);
+        free(shm_map->data_ptrs);
+        free(shm_map->data_size);
+        free(shm_map);
+    }
+    PDC_buf_shm_destroy(buf_shm_g);
+    buf_shm_g = NULL;
+
 #ifndef ENABLE_MPI
     for (i = 0; i < pdc_server_num_g; i++) {
         printf("  Server%3d, %d\n", i, debug_server_id_count[i]);
@@ -1178,7 +1272,8 @@ metadata_query_bulk_cb(const struct hg_cb_info *callback_info)
     bulk_args->nbytes = HG_Bulk_get_size(origin_bulk_handle);
     bulk_args->n_meta = client_lookup_args->n_meta;
 
-    recv_meta = (void *)calloc(sizeof(pdc_metadata_t), n_meta);
+    // Serialized metadata, converted and freed in hg_test_bulk_transfer_cb
+    recv_meta = (void *)calloc(1, bulk_args->nbytes);
 
     /* Create a new bulk handle to read the data */
     HG_Bulk_create(hg_info->hg_class, 1, (void **)&recv_meta, (hg_size_t *)&bulk_args->nbytes,
@@ -1433,6 +1528,7 @@ metadata_query_rpc_cb(const struct hg_cb_info *callback_info)
         PGOTO_ERROR(ret_value, "==PDC_CLIENT[%d]: metadata_query_rpc_cb error with HG_Get_output",
                     pdc_client_mpi_rank_g);
 
+    client_lookup_args->lease_ms = output.lease_ms;
     if (output.ret.user_id == -1 && output.ret.obj_id == 0 && output.ret.time_step == -1) {
         client_lookup_args->data = NULL;
     }
@@ -1569,6 +1665,8 @@ PDC_Client_add_tag(pdcid_t obj_id, const char *tag)
     meta_id   = obj_prop->obj_info_pub->meta_id;
     server_id = PDC_get_server_by_obj_id(meta_id, pdc_server_num_g);
 
+    PDC_meta_cache_invalidate_id(metadata_cache_g, meta_id);
+
     // Debug statistics for counting number of messages sent to each server.
     debug_server_id_count[server_id]++;
 
@@ -1650,9 +1748,12 @@ PDC_Client_update_metadata(pdc_metadata_t *old, pdc_metadata_t *new)
     if (old == NULL || new == NULL)
         PGOTO_ERROR(FAIL, "==PDC_CLIENT: PDC_Client_update_metadata() - NULL inputs!");
 
+    // The cached copy is stale whether or not the update succeeds
+    PDC_meta_cache_invalidate_name(metadata_cache_g, old->obj_name, old->time_step);
+    PDC_meta_cache_invalidate_id(metadata_cache_g, old->obj_id);
+
     hash_name_value = PDC_get_hash_by_name(old->obj_name);
-    server_id       = (hash_name_value + old->time_step);
-    server_id %= pdc_server_num_g;
+    server_id       = PDC_placement_get_server(hash_name_value + old->time_step, pdc_server_num_g);
 
     // Debug statistics for counting number of messages sent to each server.
     debug_server_id_count[server_id]++;
@@ -1672,27 +1773,33 @@ PDC_Client_update_metadata(pdc_metadata_t *old, pdc_metadata_t *new)
     in.new_metadata.obj_id    = new->obj_id;
     in.new_metadata.obj_name  = old->obj_name;
 
-    if (strcmp(new->data_location, "") == 0 || new->data_location[0] == 0)
+    if (new->data_location == NULL || new->data_location[0] == 0)
         in.new_metadata.data_location = " ";
     else
         in.new_metadata.data_location = new->data_location;
 
-    if (strcmp(new->app_name, "") == 0 || new->app_name[0] == 0)
+    if (new->app_name == NULL || new->app_name[0] == 0)
         in.new_metadata.app_name = " ";
     else
         in.new_metadata.app_name = new->app_name;
 
-    if (strcmp(new->tags, "") == 0 || new->tags[0] == 0 || old->tags == new->tags)
+    if (new->tags == NULL || new->tags[0] == 0 || old->tags == new->tags)
         in.new_metadata.tags = " ";
     else
         in.new_metadata.tags = new->tags;
 
-    in.new_metadata.data_type = new->data_type;
-    in.new_metadata.ndim      = new->ndim;
-    in.new_metadata.dims0     = new->dims[0];
-    in.new_metadata.dims1     = new->dims[1];
-    in.new_metadata.dims2     = new->dims[2];
-    in.new_metadata.dims3     = new->dims[3];
+    in.new_metadata.data_type        = new->data_type;
+    in.new_metadata.ndim             = new->ndim;
+    in.new_metadata.dims0            = new->dims[0];
+    in.new_metadata.dims1            = new->dims[1];
+    in.new_metadata.dims2            = new->dims[2];
+    in.new_metadata.dims3            = new->dims[3];
+    in.new_metadata.stripe_size      = new->stripe_size;
+    in.new_metadata.stripe_count     = new->stripe_count;
+    in.new_metadata.compress         = new->compress;
+    in.new_metadata.compress_level   = new->compress_level;
+    in.new_metadata.error_bound_mode = new->error_bound_mode;
+    in.new_metadata.error_bound      = new->error_bound;
 
     // New fields to support transform state changes
     // and possibly provenance info.
@@ -1736,6 +1843,8 @@ PDC_Client_delete_metadata_by_id(uint64_t obj_id)
 
     FUNC_ENTER(NULL);
 
+    PDC_meta_cache_invalidate_id(metadata_cache_g, obj_id);
+
     // Fill input structure
     in.obj_id = obj_id;
     server_id = PDC_get_server_by_obj_id(obj_id, pdc_server_num_g);
@@ -1791,9 +1900,10 @@ PDC_Client_delete_metadata(char *delete_name, pdcid_t obj_delete_prop)
     in.obj_name  = delete_name;
     in.time_step = delete_prop->time_step;
 
+    PDC_meta_cache_invalidate_name(metadata_cache_g, delete_name, in.time_step);
+
     hash_name_value = PDC_get_hash_by_name(delete_name);
-    server_id       = (hash_name_value + in.time_step);
-    server_id %= pdc_server_num_g;
+    server_id       = PDC_placement_get_server(hash_name_value + in.time_step, pdc_server_num_g);
 
     in.hash_value = hash_name_value;
 
@@ -1900,14 +2010,23 @@ PDC_Client_query_metadata_name_timestep(const char *obj_name, int time_step, pdc
     uint32_t                        server_id;
     metadata_query_in_t             in;
     struct _pdc_metadata_query_args lookup_args;
-    hg_handle_t                     metadata_query_handle;
+    hg_handle_t                     metadata_query_handle = HG_HANDLE_NULL;
+    pdc_metadata_t                  cached;
 
     FUNC_ENTER(NULL);
 
+    // Reopening an object within its lease needs no RPC
+    if (PDC_meta_cache_get_by_name(metadata_cache_g, obj_name, time_step, &cached) == 1) {
+        *out = (pdc_metadata_t *)malloc(sizeof(pdc_metadata_t));
+        if (*out == NULL)
+            PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: cannot allocate metadata", pdc_client_mpi_rank_g);
+        **out = cached;
+        PGOTO_DONE(SUCCEED);
+    }
+
     // Compute server id
     hash_name_value = PDC_get_hash_by_name(obj_name);
-    server_id       = (hash_name_value + time_step);
-    server_id %= pdc_server_num_g;
+    server_id       = PDC_placement_get_server(hash_name_value + time_step, pdc_server_num_g);
 
     // Debug statistics for counting number of messages sent to each server.
     debug_server_id_count[server_id]++;
@@ -1939,13 +2058,43 @@ PDC_Client_query_metadata_name_timestep(const char *obj_name, int time_step, pdc
     PDC_Client_check_response(&send_context_g);
     *out = lookup_args.data;
 
+    if (lookup_args.data != NULL)
+        PDC_meta_cache_put(metadata_cache_g, lookup_args.data, lookup_args.lease_ms);
+
 done:
     fflush(stdout);
-    HG_Destroy(metadata_query_handle);
+    if (metadata_query_handle != HG_HANDLE_NULL)
+        HG_Destroy(metadata_query_handle);
 
     FUNC_LEAVE(ret_value);
 }
 
+#ifdef ENABLE_MPI
+// The metadata name strings are pointers, so broadcast the serialized metadata
+static void
+PDC_Client_bcast_metadata(pdc_metadata_t *meta, int is_root, MPI_Comm comm)
+{
+    int   size = 0;
+    char *buf;
+
+    FUNC_ENTER(NULL);
+
+    if (is_root)
+        size = (int)PDC_metadata_serialize_size(meta);
+    MPI_Bcast(&size, 1, MPI_INT, 0, comm);
+
+    buf = (char *)malloc(size);
+    if (is_root)
+        PDC_metadata_serialize(meta, buf);
+    MPI_Bcast(buf, size, MPI_CHAR, 0, comm);
+    if (!is_root)
+        PDC_metadata_deserialize(buf, meta);
+    free(buf);
+
+    FUNC_LEAVE_VOID;
+}
+#endif
+
 // Only let one process per node to do the actual query, then broadcast to all others
 perr_t
 PDC_Client_query_metadata_name_timestep_agg_same_node(const char *obj_name, int time_step,
@@ -1966,7 +2115,7 @@ PDC_Client_query_metadata_name_timestep_agg_same_node(const char *obj_name, int
     else
         *out = (pdc_metadata_t *)calloc(1, sizeof(pdc_metadata_t));
 
-    MPI_Bcast(*out, sizeof(pdc_metadata_t), MPI_CHAR, 0, PDC_SAME_NODE_COMM_g);
+    PDC_Client_bcast_metadata(*out, pdc_client_same_node_rank_g == 0, PDC_SAME_NODE_COMM_g);
 
 #else
     ret_value = PDC_Client_query_metadata_name_timestep(obj_name, time_step, out);
@@ -1995,7 +2144,7 @@ PDC_Client_query_metadata_name_timestep_agg(const char *obj_name, int time_step,
     else
         *out = (pdc_metadata_t *)calloc(1, sizeof(pdc_metadata_t));
 
-    MPI_Bcast(*out, sizeof(pdc_metadata_t), MPI_CHAR, 0, PDC_CLIENT_COMM_WORLD_g);
+    PDC_Client_bcast_metadata(*out, pdc_client_mpi_rank_g == 0, PDC_CLIENT_COMM_WORLD_g);
 
 #else
     ret_value = PDC_Client_query_metadata_name_timestep(obj_name, time_step, out);
@@ -2043,8 +2192,7 @@ PDC_Client_create_cont_id(const char *cont_name, pdcid_t cont_create_prop ATTRIB
     in.cont_name    = cont_name;
 
     // Calculate server id
-    server_id = hash_name_value;
-    server_id %= pdc_server_num_g;
+    server_id = PDC_placement_get_server(hash_name_value, pdc_server_num_g);
 
     // Debug statistics for counting number of messages sent to each server.
     debug_server_id_count[server_id]++;
@@ -2097,6 +2245,58 @@ PDC_Client_create_cont_id_mpi(const char *cont_name, pdcid_t cont_create_prop, p
     FUNC_LEAVE(ret_value);
 }
 
+/*
+ * Fill the object create request with the properties of an object property
+ *
+ * \param  data[OUT]            Pointer to the transfer structure, obj_name is not set
+ * \param  cont_id[IN]          Container ID (obtained from metadata server)
+ * \param  create_prop[IN]      Pointer to the object property
+ *
+ * \return Data type of the object
+ */
+static int8_t
+PDC_Client_fill_obj_create_transfer(pdc_metadata_transfer_t *data, uint64_t cont_id,
+                                    struct _pdc_obj_prop *create_prop)
+{
+    data->cont_id   = cont_id;
+    data->time_step = create_prop->time_step;
+    data->user_id   = create_prop->user_id;
+
+    if ((data->ndim = create_prop->obj_prop_pub->ndim) > 0) {
+        if (data->ndim >= 1)
+            data->dims0 = create_prop->obj_prop_pub->dims[0];
+        if (data->ndim >= 2)
+            data->dims1 = create_prop->obj_prop_pub->dims[1];
+        if (data->ndim >= 3)
+            data->dims2 = create_prop->obj_prop_pub->dims[2];
+        if (data->ndim >= 4)
+            data->dims3 = create_prop->obj_prop_pub->dims[3];
+    }
+    data->stripe_size      = create_prop->stripe_size;
+    data->stripe_count     = create_prop->stripe_count;
+    data->compress         = create_prop->compress;
+    data->compress_level   = create_prop->compress_level;
+    data->error_bound_mode = create_prop->error_bound_mode;
+    data->error_bound      = create_prop->error_bound;
+
+    if (create_prop->tags == NULL)
+        data->tags = " ";
+    else
+        data->tags = create_prop->tags;
+
+    if (create_prop->app_name == NULL)
+        data->app_name = "Noname";
+    else
+        data->app_name = create_prop->app_name;
+
+    if (create_prop->data_loc == NULL)
+        data->data_location = " ";
+    else
+        data->data_location = create_prop->data_loc;
+
+    return create_prop->obj_prop_pub->type;
+}
+
 // Send a name to server and receive an obj id
 perr_t
 PDC_Client_send_name_recv_id(const char *obj_name, uint64_t cont_id, pdcid_t obj_create_prop,
@@ -2120,44 +2320,14 @@ PDC_Client_send_name_recv_id(const char *obj_name, uint64_t cont_id, pdcid_t obj
 
     // Fill input structure
     memset(&in, 0, sizeof(in));
-    in.data.obj_name  = obj_name;
-    in.data.cont_id   = cont_id;
-    in.data.time_step = create_prop->time_step;
-    in.data.user_id   = create_prop->user_id;
-    in.data_type      = create_prop->obj_prop_pub->type;
-
-    if ((in.data.ndim = create_prop->obj_prop_pub->ndim) > 0) {
-        if (in.data.ndim >= 1)
-            in.data.dims0 = create_prop->obj_prop_pub->dims[0];
-        if (in.data.ndim >= 2)
-            in.data.dims1 = create_prop->obj_prop_pub->dims[1];
-        if (in.data.ndim >= 3)
-            in.data.dims2 = create_prop->obj_prop_pub->dims[2];
-        if (in.data.ndim >= 4)
-            in.data.dims3 = create_prop->obj_prop_pub->dims[3];
-    }
-
-    if (create_prop->tags == NULL)
-        in.data.tags = " ";
-    else
-        in.data.tags = create_prop->tags;
-
-    if (create_prop->app_name == NULL)
-        in.data.app_name = "Noname";
-    else
-        in.data.app_name = create_prop->app_name;
-
-    if (create_prop->data_loc == NULL)
-        in.data.data_location = " ";
-    else
-        in.data.data_location = create_prop->data_loc;
+    in.data.obj_name = obj_name;
+    in.data_type     = PDC_Client_fill_obj_create_transfer(&in.data, cont_id, create_prop);
 
     hash_name_value = PDC_get_hash_by_name(obj_name);
     in.hash_value   = hash_name_value;
 
     // Compute server id
-    server_id = (hash_name_value + in.data.time_step);
-    server_id %= pdc_server_num_g;
+    server_id = PDC_placement_get_server(hash_name_value + in.data.time_step, pdc_server_num_g);
 
     // Debug statistics for counting number of messages sent to each server.
     debug_server_id_count[server_id]++;
@@ -2200,6 +2370,197 @@ done:
     FUNC_LEAVE(ret_value);
 }
 
+struct _pdc_metadata_bulk_create_args {
+    hg_handle_t                rpc_handle;
+    hg_bulk_t                  bulk_handle;
+    metadata_bulk_create_out_t out;
+};
+
+static hg_return_t
+PDC_Client_send_names_recv_ids_cb(const struct hg_cb_info *callback_info)
+{
+    hg_return_t                            ret_value = HG_SUCCESS;
+    hg_handle_t                            handle    = callback_info->info.forward.handle;
+    struct _pdc_metadata_bulk_create_args *cb_args;
+    metadata_bulk_create_out_t             output;
+
+    FUNC_ENTER(NULL);
+
+    cb_args = (struct _pdc_metadata_bulk_create_args *)callback_info->arg;
+
+    ret_value = HG_Get_output(handle, &output);
+    if (ret_value != HG_SUCCESS) {
+        cb_args->out.n_created = 0;
+        PGOTO_ERROR(ret_value, "==PDC_CLIENT[%d]: error with HG_Get_output", pdc_client_mpi_rank_g);
+    }
+    cb_args->out = output;
+    HG_Free_output(handle, &output);
+
+done:
+    fflush(stdout);
+    work_todo_g--;
+
+    FUNC_LEAVE(ret_value);
+}
+
+// Send the names of a batch of objects, one request to each metadata server, and receive their obj ids
+perr_t
+PDC_Client_send_names_recv_ids(int n_obj, const char **obj_names, uint64_t cont_id, pdcid_t obj_create_prop,
+                               pdcid_t *meta_ids)
+{
+    perr_t                                 ret_value = SUCCEED;
+    hg_return_t                            hg_ret;
+    struct _pdc_obj_prop *                 create_prop = NULL;
+    metadata_bulk_create_in_t              in;
+    struct _pdc_metadata_bulk_create_args *cb_args         = NULL;
+    uint32_t *                             hash_values     = NULL, *server_ids = NULL, *hash_buf;
+    int *                                  n_obj_by_server = NULL, **obj_idx_by_server = NULL;
+    char **                                bufs            = NULL, *name_buf;
+    hg_size_t *                            buf_sizes       = NULL;
+    int                                    n_send          = 0, i, j, iter, server_id;
+
+    FUNC_ENTER(NULL);
+
+    if (n_obj <= 0)
+        PGOTO_DONE(SUCCEED);
+    if (obj_names == NULL || meta_ids == NULL)
+        PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: invalid input", pdc_client_mpi_rank_g);
+
+    create_prop = PDC_obj_prop_get_info(obj_create_prop);
+
+    // All objects share the property, the name of each object decides its metadata server
+    memset(&in, 0, sizeof(in));
+    in.data.obj_name = " ";
+    in.data_type     = PDC_Client_fill_obj_create_transfer(&in.data, cont_id, create_prop);
+
+    hash_values       = (uint32_t *)malloc(sizeof(uint32_t) * n_obj);
+    server_ids        = (uint32_t *)malloc(sizeof(uint32_t) * n_obj);
+    n_obj_by_server   = (int *)calloc(pdc_server_num_g, sizeof(int));
+    obj_idx_by_server = (int **)calloc(pdc_server_num_g, sizeof(int *));
+    bufs              = (char **)calloc(pdc_server_num_g, sizeof(char *));
+    buf_sizes         = (hg_size_t *)calloc(pdc_server_num_g, sizeof(hg_size_t));
+    cb_args           = (struct _pdc_metadata_bulk_create_args *)calloc(pdc_server_num_g, sizeof(*cb_args));
+    if (hash_values == NULL || server_ids == NULL || n_obj_by_server == NULL || obj_idx_by_server == NULL ||
+        bufs == NULL || buf_sizes == NULL || cb_args == NULL)
+        PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: cannot allocate batch buffers", pdc_client_mpi_rank_g);
+
+    for (i = 0; i < n_obj; i++)
+        meta_ids[i] = 0;
+    for (i = 0; i < n_obj; i++) {
+        if (obj_names[i] == NULL || obj_names[i][0] == '\0')
+            PGOTO_ERROR(FAIL, "Cannot create object with empty object name");
+        hash_values[i] = PDC_get_hash_by_name(obj_names[i]);
+        server_ids[i]  = PDC_placement_get_server(hash_values[i] + in.data.time_step, pdc_server_num_g);
+        n_obj_by_server[server_ids[i]]++;
+        buf_sizes[server_ids[i]] += sizeof(uint32_t) + strlen(obj_names[i]) + 1;
+    }
+
+    // Pack the name hash values followed by the names, in the order of the names
+    for (server_id = 0; server_id < pdc_server_num_g; server_id++) {
+        if (n_obj_by_server[server_id] == 0)
+            continue;
+        bufs[server_id]              = (char *)malloc(buf_sizes[server_id]);
+        obj_idx_by_server[server_id] = (int *)malloc(sizeof(int) * n_obj_by_server[server_id]);
+        if (bufs[server_id] == NULL || obj_idx_by_server[server_id] == NULL)
+            PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: cannot allocate batch buffers", pdc_client_mpi_rank_g);
+        n_obj_by_server[server_id] = 0;
+    }
+    for (i = 0; i < n_obj; i++) {
+        server_id                                                = server_ids[i];
+        obj_idx_by_server[server_id][n_obj_by_server[server_id]] = i;
+        n_obj_by_server[server_id]++;
+    }
+    for (server_id = 0; server_id < pdc_server_num_g; server_id++) {
+        if (n_obj_by_server[server_id] == 0)
+            continue;
+        hash_buf = (uint32_t *)bufs[server_id];
+        name_buf = bufs[server_id] + sizeof(uint32_t) * n_obj_by_server[server_id];
+        for (j = 0; j < n_obj_by_server[server_id]; j++) {
+            i           = obj_idx_by_server[server_id][j];
+            hash_buf[j] = hash_values[i];
+            strcpy(name_buf, obj_names[i]);
+            name_buf += strlen(obj_names[i]) + 1;
+        }
+    }
+
+    for (iter = 0; iter < pdc_server_num_g; iter++) {
+        // Avoid everyone sends request to the same metadata server at the same time
+        server_id = (iter + pdc_client_mpi_rank_g) % pdc_server_num_g;
+        if (n_obj_by_server[server_id] == 0)
+            continue;
+
+        debug_server_id_count[server_id]++;
+
+        if (PDC_Client_try_lookup_server(server_id) != SUCCEED)
+            PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: ERROR with PDC_Client_try_lookup_server",
+                        pdc_client_mpi_rank_g);
+
+        hg_ret = HG_Create(send_context_g, pdc_server_info_g[server_id].addr,
+                           metadata_bulk_create_register_id_g, &cb_args[server_id].rpc_handle);
+        if (hg_ret != HG_SUCCESS)
+            PGOTO_ERROR(FAIL, "Could not create handle");
+
+        hg_ret = HG_Bulk_create(send_class_g, 1, (void **)&bufs[server_id], &buf_sizes[server_id],
+                                HG_BULK_READ_ONLY, &cb_args[server_id].bulk_handle);
+        if (hg_ret != HG_SUCCESS) {
+            HG_Destroy(cb_args[server_id].rpc_handle);
+            cb_args[server_id].rpc_handle = HG_HANDLE_NULL;
+            PGOTO_ERROR(FAIL, "Could not create bulk data handle");
+        }
+
+        in.n_obj       = n_obj_by_server[server_id];
+        in.bulk_handle = cb_args[server_id].bulk_handle;
+
+        hg_ret = HG_Forward(cb_args[server_id].rpc_handle, PDC_Client_send_names_recv_ids_cb,
+                            &cb_args[server_id], &in);
+        if (hg_ret != HG_SUCCESS) {
+            HG_Bulk_free(cb_args[server_id].bulk_handle);
+            HG_Destroy(cb_args[server_id].rpc_handle);
+            cb_args[server_id].rpc_handle = HG_HANDLE_NULL;
+            PGOTO_ERROR(FAIL, "Could not forward call");
+        }
+        n_send++;
+    }
+
+done:
+    // Wait for the responses of all requests sent, also when a later one could not be sent
+    if (n_send > 0) {
+        work_todo_g = n_send;
+        PDC_Client_check_response(&send_context_g);
+    }
+    if (cb_args != NULL) {
+        for (server_id = 0; server_id < pdc_server_num_g; server_id++) {
+            if (cb_args[server_id].rpc_handle == HG_HANDLE_NULL)
+                continue;
+            // Objects are created in the order of the names sent, each with the next obj id
+            for (j = 0; j < (int)cb_args[server_id].out.n_created; j++)
+                meta_ids[obj_idx_by_server[server_id][j]] = cb_args[server_id].out.obj_id_start + j;
+            if (cb_args[server_id].out.n_created < (uint32_t)n_obj_by_server[server_id])
+                ret_value = FAIL;
+            HG_Bulk_free(cb_args[server_id].bulk_handle);
+            HG_Destroy(cb_args[server_id].rpc_handle);
+        }
+        free(cb_args);
+    }
+    fflush(stdout);
+    if (bufs != NULL) {
+        for (server_id = 0; server_id < pdc_server_num_g; server_id++) {
+            free(bufs[server_id]);
+            free(obj_idx_by_server[server_id]);
+        }
+    }
+    free(bufs);
+    free(obj_idx_by_server);
+    free(n_obj_by_server);
+    free(buf_sizes);
+    free(server_ids);
+    free(hash_values);
+    if (create_prop)
+        PDC_obj_prop_free(create_prop);
+
+    FUNC_LEAVE(ret_value);
+}
+
 perr_t
 PDC_Client_close_all_server()
 {
@@ -2241,33 +2602,272 @@ done:
     FUNC_LEAVE(ret_value);
 }
 
-perr_t
-PDC_Client_buf_unmap(pdcid_t remote_obj_id, pdcid_t remote_reg_id, struct pdc_region_info *reginfo,
-                     pdc_var_type_t data_type)
+// A piece of a region transfer that is stored by a single data server
+typedef struct pdc_region_piece_t {
+    uint32_t               server_id;
+    struct pdc_region_info region;
+    uint64_t               offset[DIM_MAX];
+    uint64_t               size[DIM_MAX];
+} pdc_region_piece_t;
+
+/*
+ * Split a region of an object at the stripe boundaries along its first dimension, the stripes are placed
+ * round-robin on stripe_count data servers starting from the metadata server of the object
+ *
+ * \param  object_info[IN]      Object the region belongs to
+ * \param  region[IN]           Region to split, in elements
+ * \param  server_id[IN]        Data server of the whole region if the object is not striped
+ * \param  pieces[OUT]          Pieces of the region in order, to be freed by the caller
+ *
+ * \return Number of pieces on success/-1 on failure
+ */
+static int
+PDC_Client_split_region(struct _pdc_obj_info *object_info, struct pdc_region_info *region, uint32_t server_id,
+                        pdc_region_piece_t **pieces)
 {
-    perr_t                   ret_value = SUCCEED;
-    hg_return_t              hg_ret    = HG_SUCCESS;
-    buf_unmap_in_t           in;
-    size_t                   unit;
-    uint32_t                 data_server_id, meta_server_id;
-    struct _pdc_buf_map_args unmap_args;
-    hg_handle_t              client_send_buf_unmap_handle;
+    struct _pdc_obj_prop *prop = object_info->obj_pt;
+    uint64_t              slice_size, rows_per_stripe, start, end, first_stripe, stripe, n_piece, i;
+    uint32_t              first_server, stripe_count;
+    size_t                j;
+
+    if (prop->stripe_count == 0 || region->ndim == 0 || region->size[0] == 0) {
+        first_stripe    = 0;
+        n_piece         = 1;
+        rows_per_stripe = 0;
+    }
+    else {
+        // A stripe is stripe_size bytes rounded down to whole slices of the first dimension
+        slice_size = PDC_get_var_type_size(prop->obj_prop_pub->type);
+        for (j = 1; j < prop->obj_prop_pub->ndim; j++)
+            slice_size *= prop->obj_prop_pub->dims[j];
+        rows_per_stripe = slice_size == 0 ? 0 : prop->stripe_size / slice_size;
+        if (rows_per_stripe == 0)
+            rows_per_stripe = 1;
+
+        first_stripe = region->offset[0] / rows_per_stripe;
+        n_piece      = (region->offset[0] + region->size[0] - 1) / rows_per_stripe - first_stripe + 1;
+    }
+    if (n_piece > INT_MAX)
+        return -1;
+
+    *pieces = (pdc_region_piece_t *)malloc(n_piece * sizeof(pdc_region_piece_t));
+    if (*pieces == NULL)
+        return -1;
+
+    stripe_count =
+        prop->stripe_count < (uint32_t)pdc_server_num_g ? prop->stripe_count : (uint32_t)pdc_server_num_g;
+    first_server = PDC_get_server_by_obj_id(object_info->obj_info_pub->meta_id, pdc_server_num_g);
+    for (i = 0; i < n_piece; i++) {
+        (*pieces)[i].region        = *region;
+        (*pieces)[i].region.offset = (*pieces)[i].offset;
+        (*pieces)[i].region.size   = (*pieces)[i].size;
+        for (j = 0; j < region->ndim; j++) {
+            (*pieces)[i].offset[j] = region->offset[j];
+            (*pieces)[i].size[j]   = region->size[j];
+        }
+        if (rows_per_stripe == 0) {
+            (*pieces)[i].server_id = server_id;
+            continue;
+        }
+
+        stripe = first_stripe + i;
+        start  = stripe * rows_per_stripe;
+        end    = start + rows_per_stripe;
+        if (start < region->offset[0])
+            start = region->offset[0];
+        if (end > region->offset[0] + region->size[0])
+            end = region->offset[0] + region->size[0];
+        (*pieces)[i].offset[0] = start;
+        (*pieces)[i].size[0]   = end - start;
+        (*pieces)[i].server_id = (first_server + stripe % stripe_count) % pdc_server_num_g;
+    }
+
+    return (int)n_piece;
+}
+
+/*
+ * Allocate an extent of the buf-map shared memory of the client, creating the shared memory first if needed
+ *
+ * \param  size[IN]             Size of the region data in bytes
+ * \param  offset[OUT]          Offset of the extent in the shared memory
+ *
+ * \return Pointer to the region data in the extent on success/NULL if bulk transfers must be used
+ */
+static void *
+PDC_Client_buf_shm_alloc(uint64_t size, uint64_t *offset)
+{
+    void *         ret_value = NULL;
+    char           hostname[ADDR_MAX], name[ADDR_MAX];
+    struct timeval now;
 
     FUNC_ENTER(NULL);
 
-    // Fill input structure
-    in.remote_obj_id = remote_obj_id;
-    in.remote_reg_id = remote_reg_id;
+    if (buf_shm_g == NULL && buf_shm_size_g > 0) {
+        // Clients on other nodes may have the same pid and rank, servers there must not find this one.
+        // A later client may get the same pid too, the creation time keeps it from reusing the name of
+        // a segment a server still has mapped.
+        memset(hostname, 0, sizeof(hostname));
+        gethostname(hostname, sizeof(hostname) - 1);
+        gettimeofday(&now, NULL);
+        snprintf(name, ADDR_MAX, "/pdc_buf_%.64s_%d_%d_%lx%06lx", hostname, (int)getpid(),
+                 pdc_client_mpi_rank_g, (unsigned long)now.tv_sec, (unsigned long)now.tv_usec);
+        buf_shm_g = PDC_buf_shm_create(name, buf_shm_size_g);
+        if (buf_shm_g == NULL)
+            buf_shm_size_g = 0;
+    }
+    if (buf_shm_g == NULL)
+        PGOTO_DONE(NULL);
 
-    unit = PDC_get_var_type_size(data_type);
-    PDC_region_info_t_to_transfer_unit(reginfo, &(in.remote_region), unit);
+    ret_value = PDC_buf_shm_alloc(buf_shm_g, PDC_BUF_SHM_HDR_SIZE + size, offset);
+    if (ret_value != NULL)
+        ret_value = (char *)ret_value + PDC_BUF_SHM_HDR_SIZE;
 
-    // Compute metadata server id
-    meta_server_id    = PDC_get_server_by_obj_id(remote_obj_id, pdc_server_num_g);
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Free a buf-map region of the shared memory of the client
+ *
+ * \param  shm_map[IN]          Region to free
+ * \param  linked[IN]           1 if the region is in the list of mapped regions
+ */
+static void
+PDC_Client_buf_shm_map_free(pdc_buf_shm_map_t *shm_map, int linked)
+{
+    FUNC_ENTER(NULL);
+
+    if (linked)
+        DL_DELETE(buf_shm_map_head_g, shm_map);
+    if (shm_map->conv_buf != NULL)
+        free(shm_map->conv_buf);
+    else
+        PDC_buf_shm_free(buf_shm_g, shm_map->offset);
+    free(shm_map->data_ptrs);
+    free(shm_map->data_size);
+    free(shm_map);
+
+    FUNC_LEAVE_VOID;
+}
+
+/*
+ * Check if two regions in transfer format are the same, only the dimensions in use are compared
+ *
+ * \param  a[IN]                First region
+ * \param  b[IN]                Second region
+ *
+ * \return 1 if they are the same/0 otherwise
+ */
+static int
+PDC_Client_same_transfer_region(region_info_transfer_t *a, region_info_transfer_t *b)
+{
+    if (a->ndim != b->ndim || a->start_0 != b->start_0 || a->count_0 != b->count_0)
+        return 0;
+    if (a->ndim >= 2 && (a->start_1 != b->start_1 || a->count_1 != b->count_1))
+        return 0;
+    if (a->ndim >= 3 && (a->start_2 != b->start_2 || a->count_2 != b->count_2))
+        return 0;
+    if (a->ndim >= 4 && (a->start_3 != b->start_3 || a->count_3 != b->count_3))
+        return 0;
+    return 1;
+}
+
+/*
+ * Find the buf-map region of the shared memory of the client mapped to a region of an object
+ *
+ * \param  obj_id[IN]           Object ID on the servers
+ * \param  server_id[IN]        Data server of the region
+ * \param  remote_region[IN]    Region of the object, as sent to the server
+ *
+ * \return Pointer to the region if found/NULL otherwise
+ */
+static pdc_buf_shm_map_t *
+PDC_Client_buf_shm_find(pdcid_t obj_id, uint32_t server_id, region_info_transfer_t *remote_region)
+{
+    pdc_buf_shm_map_t *shm_map;
+
+    DL_FOREACH(buf_shm_map_head_g, shm_map)
+    {
+        if (shm_map->obj_id == obj_id && shm_map->server_id == server_id &&
+            PDC_Client_same_transfer_region(&shm_map->remote_region, remote_region) == 1)
+            return shm_map;
+    }
+    return NULL;
+}
+
+/*
+ * Copy the user buffer of a buf-map region to the shared memory of the client, or back. The data is
+ * converted between the type of the user buffer and the type of the object if they differ.
+ *
+ * \param  shm_map[IN]          Mapped region
+ * \param  to_shm[IN]           1 to copy the user buffer to the shared memory, 0 to copy it back
+ */
+static void
+PDC_Client_buf_shm_copy(pdc_buf_shm_map_t *shm_map, int to_shm)
+{
+    char *      shm_buf = (char *)shm_map->shm_buf;
+    size_t      unit, unit_to, nelem;
+    hg_uint32_t i;
+
+    if (shm_map->local_type == shm_map->remote_type) {
+        for (i = 0; i < shm_map->count; i++) {
+            if (to_shm)
+                memcpy(shm_buf, shm_map->data_ptrs[i], shm_map->data_size[i]);
+            else
+                memcpy(shm_map->data_ptrs[i], shm_buf, shm_map->data_size[i]);
+            shm_buf += shm_map->data_size[i];
+        }
+        return;
+    }
+
+    unit    = PDC_get_var_type_size(shm_map->local_type);
+    unit_to = PDC_get_var_type_size(shm_map->remote_type);
+    for (i = 0; i < shm_map->count; i++) {
+        nelem = shm_map->data_size[i] / unit;
+        if (to_shm)
+            pdc_type_conv(shm_map->local_type, shm_map->remote_type, shm_map->data_ptrs[i], shm_buf,
+                          nelem, 1, 1, PDC_CONV_CLAMP | PDC_CONV_ROUND);
+        else
+            pdc_type_conv(shm_map->remote_type, shm_map->local_type, shm_buf, shm_map->data_ptrs[i],
+                          nelem, 1, 1, PDC_CONV_CLAMP | PDC_CONV_ROUND);
+        shm_buf += nelem * unit_to;
+    }
+}
+
+/*
+ * Send an unmap request of a region to a data server, the response is handled by
+ * client_send_buf_unmap_rpc_cb
+ *
+ * \param  data_server_id[IN]   Data server of the region
+ * \param  meta_server_id[IN]   Metadata server of the object
+ * \param  remote_obj_id[IN]    Object ID on the servers
+ * \param  remote_reg_id[IN]    Region ID
+ * \param  reginfo[IN]          Region, in elements
+ * \param  data_type[IN]        Data type of the object
+ * \param  unmap_args[OUT]      Result of the request, filled in by the callback
+ * \param  handle[OUT]          Handle of the request, to be destroyed by the caller
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Client_send_buf_unmap(uint32_t data_server_id, uint32_t meta_server_id, pdcid_t remote_obj_id,
+                          pdcid_t remote_reg_id, struct pdc_region_info *reginfo, pdc_var_type_t data_type,
+                          struct _pdc_buf_map_args *unmap_args, hg_handle_t *handle)
+{
+    perr_t         ret_value = SUCCEED;
+    hg_return_t    hg_ret    = HG_SUCCESS;
+    buf_unmap_in_t in;
+    size_t         unit;
+
+    FUNC_ENTER(NULL);
+
+    // Fill input structure
+    in.remote_obj_id  = remote_obj_id;
+    in.remote_reg_id  = remote_reg_id;
     in.meta_server_id = meta_server_id;
 
-    // Compute local data server id
-    data_server_id = (pdc_client_mpi_rank_g / pdc_nclient_per_server_g) % pdc_server_num_g;
+    unit = PDC_get_var_type_size(data_type);
+    PDC_region_info_t_to_transfer_unit(reginfo, &(in.remote_region), unit);
 
     // Debug statistics for counting number of messages sent to each server.
     debug_server_id_count[data_server_id]++;
@@ -2275,71 +2875,158 @@ PDC_Client_buf_unmap(pdcid_t remote_obj_id, pdcid_t remote_reg_id, struct pdc_re
     if (PDC_Client_try_lookup_server(data_server_id) != SUCCEED)
         PGOTO_ERROR(FAIL, "==CLIENT[%d]: ERROR with PDC_Client_try_lookup_server", pdc_client_mpi_rank_g);
 
-    HG_Create(send_context_g, pdc_server_info_g[data_server_id].addr, buf_unmap_register_id_g,
-              &client_send_buf_unmap_handle);
+    HG_Create(send_context_g, pdc_server_info_g[data_server_id].addr, buf_unmap_register_id_g, handle);
+    hg_ret = HG_Forward(*handle, client_send_buf_unmap_rpc_cb, unmap_args, &in);
+    if (hg_ret != HG_SUCCESS)
+        PGOTO_ERROR(FAIL, "PDC_Client_send_buf_unmap(): Could not start HG_Forward()");
+
+done:
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDC_Client_buf_unmap(struct _pdc_obj_info *object_info, pdcid_t remote_reg_id,
+                     struct pdc_region_info *reginfo, pdc_var_type_t data_type)
+{
+    perr_t                    ret_value = SUCCEED;
+    uint32_t                  meta_server_id;
+    pdc_region_piece_t *      pieces     = NULL;
+    struct _pdc_buf_map_args *unmap_args = NULL;
+    hg_handle_t *             handles    = NULL;
+    pdc_buf_shm_map_t *       shm_map;
+    region_info_transfer_t    remote_region;
+    size_t                    unit;
+    int                       i, n_piece = 0, n_sent = 0;
+
+    FUNC_ENTER(NULL);
+
+    // Compute metadata server id
+    meta_server_id = PDC_get_server_by_obj_id(object_info->obj_info_pub->meta_id, pdc_server_num_g);
+
+    // Unmap each stripe of the region from its data server
+    n_piece = PDC_Client_split_region(object_info, reginfo, PDC_CLIENT_DATA_SERVER(), &pieces);
+    if (n_piece < 0)
+        PGOTO_ERROR(FAIL, "==CLIENT[%d]: ERROR splitting region to stripes", pdc_client_mpi_rank_g);
+    unmap_args = (struct _pdc_buf_map_args *)calloc(n_piece, sizeof(struct _pdc_buf_map_args));
+    handles    = (hg_handle_t *)calloc(n_piece, sizeof(hg_handle_t));
+    if (unmap_args == NULL || handles == NULL)
+        PGOTO_ERROR(FAIL, "==CLIENT[%d]: ERROR allocating unmap requests", pdc_client_mpi_rank_g);
+
 #if PDC_TIMING == 1
     double start = MPI_Wtime(), end;
 #endif
-    hg_ret = HG_Forward(client_send_buf_unmap_handle, client_send_buf_unmap_rpc_cb, &unmap_args, &in);
-    if (hg_ret != HG_SUCCESS)
-        PGOTO_ERROR(FAIL, "PDC_Client_send_buf_unmap(): Could not start HG_Forward()");
+    for (i = 0; i < n_piece; i++) {
+        handles[i] = HG_HANDLE_NULL;
+        ret_value  = PDC_Client_send_buf_unmap(pieces[i].server_id, meta_server_id,
+                                              object_info->obj_info_pub->meta_id, remote_reg_id,
+                                              &pieces[i].region, data_type, &unmap_args[i], &handles[i]);
+        if (ret_value != SUCCEED)
+            break;
+        n_sent++;
+    }
 #if PDC_TIMING == 1
     timings.PDCbuf_obj_unmap_rpc += MPI_Wtime() - start;
 #endif
-    // Wait for response from server
-    work_todo_g = 1;
+    // Wait for response from all servers
+    work_todo_g = n_sent;
 #if PDC_TIMING == 1
     start = MPI_Wtime();
 #endif
-    PDC_Client_check_response(&send_context_g);
+    if (n_sent > 0)
+        PDC_Client_check_response(&send_context_g);
 #if PDC_TIMING == 1
     end = MPI_Wtime();
     timings.PDCbuf_obj_unmap_rpc_wait += end - start;
     pdc_timestamp_register(client_buf_obj_unmap_timestamps, start, end);
 #endif
-    if (unmap_args.ret != 1)
-        PGOTO_ERROR(FAIL, "PDC_CLIENT: buf unmap failed...");
+    if (ret_value != SUCCEED)
+        PGOTO_DONE(ret_value);
+    for (i = 0; i < n_piece; i++) {
+        if (unmap_args[i].ret != 1)
+            PGOTO_ERROR(FAIL, "PDC_CLIENT: buf unmap failed...");
+    }
+
+    // The servers no longer use the shared memory of the unmapped regions
+    unit = PDC_get_var_type_size(data_type);
+    for (i = 0; i < n_piece; i++) {
+        PDC_region_info_t_to_transfer_unit(&pieces[i].region, &remote_region, unit);
+        shm_map = PDC_Client_buf_shm_find(object_info->obj_info_pub->meta_id, pieces[i].server_id,
+                                          &remote_region);
+        if (shm_map != NULL)
+            PDC_Client_buf_shm_map_free(shm_map, 1);
+    }
 
 done:
     fflush(stdout);
-    HG_Destroy(client_send_buf_unmap_handle);
+    for (i = 0; i < n_piece; i++) {
+        if (handles != NULL && handles[i] != HG_HANDLE_NULL)
+            HG_Destroy(handles[i]);
+    }
+    free(handles);
+    free(unmap_args);
+    free(pieces);
 
     FUNC_LEAVE(ret_value);
 }
 
-perr_t
-PDC_Client_buf_map(pdcid_t local_region_id, pdcid_t remote_obj_id, size_t ndim, uint64_t *local_dims,
-                   uint64_t *local_offset, pdc_var_type_t local_type, void *local_data,
-                   pdc_var_type_t remote_type, struct pdc_region_info *local_region,
-                   struct pdc_region_info *remote_region)
+/*
+ * Send a map request of a local buffer region to a data server, the response is handled by
+ * client_send_buf_map_rpc_cb
+ *
+ * \param  data_server_id[IN]   Data server of the remote region
+ * \param  meta_server_id[IN]   Metadata server of the object
+ * \param  local_region_id[IN]  ID of the local region
+ * \param  object_info[IN]      Remote object
+ * \param  ndim[IN]             Number of dimensions of the local region
+ * \param  local_dims[IN]       Size of the local region
+ * \param  local_offset[IN]     Offset of the local region
+ * \param  local_type[IN]       Data type of the local buffer
+ * \param  local_data[IN]       Local buffer
+ * \param  remote_type[IN]      Data type of the object
+ * \param  local_region[IN]     Local region
+ * \param  remote_region[IN]    Remote region
+ * \param  map_args[OUT]        Result of the request, filled in by the callback
+ * \param  handle[OUT]          Handle of the request, to be destroyed by the caller
+ * \param  shm_map[OUT]         Shared memory region offered to the server, NULL if none
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Client_send_buf_map(uint32_t data_server_id, uint32_t meta_server_id, pdcid_t local_region_id,
+                        struct _pdc_obj_info *object_info, size_t ndim, uint64_t *local_dims,
+                        uint64_t *local_offset, pdc_var_type_t local_type, void *local_data,
+                        pdc_var_type_t remote_type, struct pdc_region_info *local_region,
+                        struct pdc_region_info *remote_region, struct _pdc_buf_map_args *map_args,
+                        hg_handle_t *handle, pdc_buf_shm_map_t **shm_map)
 {
-    perr_t                   ret_value = SUCCEED;
-    hg_return_t              hg_ret    = HG_SUCCESS;
-    buf_map_in_t             in;
-    uint32_t                 data_server_id, meta_server_id;
-    hg_class_t *             hg_class;
-    hg_uint32_t              i, j;
-    hg_uint32_t              local_count;
-    void **                  data_ptrs = NULL;
-    size_t *                 data_size = NULL;
-    size_t                   unit, unit_to;
-    struct _pdc_buf_map_args map_args;
-    hg_handle_t              client_send_buf_map_handle;
-
-    FUNC_ENTER(NULL);
-
-    in.local_reg_id  = local_region_id;
-    in.remote_obj_id = remote_obj_id;
-    in.local_type    = local_type;
-    in.remote_type   = remote_type;
-    in.ndim          = ndim;
-
-    // Compute metadata server id
-    meta_server_id    = PDC_get_server_by_obj_id(remote_obj_id, pdc_server_num_g);
-    in.meta_server_id = meta_server_id;
-
-    // Compute data server id
-    data_server_id = (pdc_client_mpi_rank_g / pdc_nclient_per_server_g) % pdc_server_num_g;
+    perr_t       ret_value = SUCCEED;
+    hg_return_t  hg_ret    = HG_SUCCESS;
+    buf_map_in_t in;
+    hg_class_t * hg_class;
+    hg_uint32_t  i, j;
+    hg_uint32_t  local_count;
+    void **      data_ptrs = NULL;
+    size_t *     data_size = NULL;
+    size_t       unit, unit_to;
+    hg_size_t    staged_size;
+    void *       shm_buf = NULL;
+    int          conv;
+
+    FUNC_ENTER(NULL);
+
+    *shm_map = NULL;
+
+    in.local_reg_id     = local_region_id;
+    in.remote_obj_id    = object_info->obj_info_pub->meta_id;
+    in.local_type       = local_type;
+    in.remote_type      = remote_type;
+    in.ndim             = ndim;
+    in.meta_server_id   = meta_server_id;
+    in.compress         = object_info->obj_pt->compress;
+    in.compress_level   = object_info->obj_pt->compress_level;
+    in.error_bound_mode = object_info->obj_pt->error_bound_mode;
+    in.error_bound      = object_info->obj_pt->error_bound;
 
     // Debug statistics for counting number of messages sent to each server.
     debug_server_id_count[data_server_id]++;
@@ -2354,6 +3041,9 @@ PDC_Client_buf_map(pdcid_t local_region_id, pdcid_t remote_obj_id, size_t ndim,
     PDC_region_info_t_to_transfer(remote_region, &(in.remote_region_nounit));
     in.remote_unit = unit_to;
 
+    // The data is converted to the type of the object on the client, an untyped object gets it as is
+    conv = local_type != remote_type && pdc_find_conv_func(local_type, remote_type) != NULL;
+
     if (ndim == 1 && local_offset[0] == 0) {
         local_count = 1;
         data_ptrs   = (void **)malloc(sizeof(void *));
@@ -2431,46 +3121,218 @@ PDC_Client_buf_map(pdcid_t local_region_id, pdcid_t remote_obj_id, size_t ndim,
     else
         PGOTO_ERROR(FAIL, "mapping for array of dimension greater than 4 is not supproted");
 
+    staged_size = 0;
+    for (i = 0; i < local_count; i++)
+        staged_size += data_size[i];
+    if (conv)
+        staged_size = staged_size / unit * unit_to;
+
+    // A server on this node can move the data through the shared memory of the client instead of bulk
+    in.shm_addr   = "";
+    in.shm_offset = 0;
+    in.shm_size   = 0;
+    if (pdc_server_info_g[data_server_id].buf_shm_remote == 0) {
+        shm_buf = PDC_Client_buf_shm_alloc(staged_size, &in.shm_offset);
+        if (shm_buf != NULL) {
+            in.shm_size = staged_size;
+            in.shm_addr = PDC_buf_shm_name(buf_shm_g);
+        }
+    }
+    // Data converted for a server on another node is staged in a buffer of the client
+    if (shm_buf != NULL || conv) {
+        *shm_map = (pdc_buf_shm_map_t *)calloc(1, sizeof(pdc_buf_shm_map_t));
+        if (*shm_map == NULL) {
+            if (shm_buf != NULL)
+                PDC_buf_shm_free(buf_shm_g, in.shm_offset);
+            PGOTO_ERROR(FAIL, "==CLIENT[%d]: ERROR allocating buf map shared memory record",
+                        pdc_client_mpi_rank_g);
+        }
+        if (shm_buf == NULL) {
+            (*shm_map)->conv_buf = malloc(staged_size);
+            shm_buf              = (*shm_map)->conv_buf;
+            if (shm_buf == NULL) {
+                free(*shm_map);
+                *shm_map = NULL;
+                PGOTO_ERROR(FAIL, "==CLIENT[%d]: ERROR allocating buf map staging buffer",
+                            pdc_client_mpi_rank_g);
+            }
+        }
+        (*shm_map)->obj_id        = in.remote_obj_id;
+        (*shm_map)->server_id     = data_server_id;
+        (*shm_map)->remote_region = in.remote_region_unit;
+        (*shm_map)->offset        = in.shm_offset;
+        (*shm_map)->shm_buf       = shm_buf;
+        (*shm_map)->local_type    = conv ? local_type : remote_type; // Same types copy the data as is
+        (*shm_map)->remote_type   = remote_type;
+        (*shm_map)->count         = local_count;
+        (*shm_map)->data_ptrs     = data_ptrs;
+        (*shm_map)->data_size     = data_size;
+    }
+
     if (PDC_Client_try_lookup_server(data_server_id) != SUCCEED)
         PGOTO_ERROR(FAIL, "==CLIENT[%d]: ERROR with PDC_Client_try_lookup_server", pdc_client_mpi_rank_g);
 
-    HG_Create(send_context_g, pdc_server_info_g[data_server_id].addr, buf_map_register_id_g,
-              &client_send_buf_map_handle);
+    HG_Create(send_context_g, pdc_server_info_g[data_server_id].addr, buf_map_register_id_g, handle);
 
-    // Create bulk handle and release in PDC_Data_Server_buf_unmap()
-    hg_ret = HG_Bulk_create(hg_class, local_count, (void **)data_ptrs, (hg_size_t *)data_size,
-                            HG_BULK_READWRITE, &(in.local_bulk_handle));
+    // Create bulk handle and release in PDC_Data_Server_buf_unmap(), converted data moves from the staging
+    if (conv)
+        hg_ret =
+            HG_Bulk_create(hg_class, 1, &shm_buf, &staged_size, HG_BULK_READWRITE, &(in.local_bulk_handle));
+    else
+        hg_ret = HG_Bulk_create(hg_class, local_count, (void **)data_ptrs, (hg_size_t *)data_size,
+                                HG_BULK_READWRITE, &(in.local_bulk_handle));
     if (hg_ret != HG_SUCCESS)
         PGOTO_ERROR(FAIL, "PDC_Client_buf_map(): Could not create local bulk data handle");
+
+    hg_ret = HG_Forward(*handle, client_send_buf_map_rpc_cb, map_args, &in);
+    if (hg_ret != HG_SUCCESS)
+        PGOTO_ERROR(FAIL, "PDC_Client_send_buf_map(): Could not start HG_Forward()");
+
+done:
+    fflush(stdout);
+    // The segments of the user buffer stay with the shared memory record, to copy the data at release
+    if (*shm_map == NULL) {
+        free(data_ptrs);
+        free(data_size);
+    }
+
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDC_Client_buf_map(pdcid_t local_region_id, struct _pdc_obj_info *object_info, size_t ndim,
+                   uint64_t *local_dims, uint64_t *local_offset, pdc_var_type_t local_type, void *local_data,
+                   pdc_var_type_t remote_type, struct pdc_region_info *local_region,
+                   struct pdc_region_info *remote_region)
+{
+    perr_t                    ret_value = SUCCEED;
+    uint32_t                  meta_server_id;
+    pdc_region_piece_t *      pieces   = NULL;
+    struct _pdc_buf_map_args *map_args = NULL;
+    hg_handle_t *             handles  = NULL;
+    pdc_buf_shm_map_t **      shm_maps = NULL;
+    struct pdc_region_info    piece_region;
+    uint64_t                  piece_dims[DIM_MAX], piece_offset[DIM_MAX], slice, row;
+    void *                    piece_data;
+    size_t                    unit, j;
+    int                       i, n_piece = 0, n_sent = 0;
+
+    FUNC_ENTER(NULL);
+
+    // Compute metadata server id
+    meta_server_id = PDC_get_server_by_obj_id(object_info->obj_info_pub->meta_id, pdc_server_num_g);
+
+    // Map each stripe of the remote region to its data server
+    n_piece = PDC_Client_split_region(object_info, remote_region, PDC_CLIENT_DATA_SERVER(), &pieces);
+    if (n_piece < 0)
+        PGOTO_ERROR(FAIL, "==CLIENT[%d]: ERROR splitting region to stripes", pdc_client_mpi_rank_g);
+    if (n_piece > 1 && ndim != 1 && ndim != remote_region->ndim)
+        PGOTO_ERROR(FAIL, "==CLIENT[%d]: striped object needs a 1D local region or one of the same dimension",
+                    pdc_client_mpi_rank_g);
+    for (j = 1; n_piece > 1 && ndim == remote_region->ndim && j < ndim; j++) {
+        if (local_dims[j] != remote_region->size[j])
+            PGOTO_ERROR(FAIL, "==CLIENT[%d]: striped object needs local and remote regions of the same shape",
+                        pdc_client_mpi_rank_g);
+    }
+    map_args = (struct _pdc_buf_map_args *)calloc(n_piece, sizeof(struct _pdc_buf_map_args));
+    handles  = (hg_handle_t *)calloc(n_piece, sizeof(hg_handle_t));
+    shm_maps = (pdc_buf_shm_map_t **)calloc(n_piece, sizeof(pdc_buf_shm_map_t *));
+    if (map_args == NULL || handles == NULL || shm_maps == NULL)
+        PGOTO_ERROR(FAIL, "==CLIENT[%d]: ERROR allocating map requests", pdc_client_mpi_rank_g);
+
+    unit  = PDC_get_var_type_size(local_type);
+    slice = 1;
+    for (j = 1; j < remote_region->ndim; j++)
+        slice *= remote_region->size[j];
+
 #if PDC_TIMING == 1
     double start = MPI_Wtime(), end;
 #endif
-    hg_ret = HG_Forward(client_send_buf_map_handle, client_send_buf_map_rpc_cb, &map_args, &in);
+    for (i = 0; i < n_piece; i++) {
+        handles[i] = HG_HANDLE_NULL;
+        if (n_piece == 1) {
+            ret_value = PDC_Client_send_buf_map(pieces[i].server_id, meta_server_id, local_region_id,
+                                                object_info, ndim, local_dims, local_offset, local_type,
+                                                local_data, remote_type, local_region, &pieces[i].region,
+                                                &map_args[i], &handles[i], &shm_maps[i]);
+        }
+        else {
+            // The rows of the local region that go to this stripe
+            row                 = pieces[i].offset[0] - remote_region->offset[0];
+            piece_region        = *local_region;
+            piece_region.offset = piece_offset;
+            piece_region.size   = piece_dims;
+            for (j = 0; j < ndim; j++) {
+                piece_offset[j] = local_offset[j];
+                piece_dims[j]   = local_dims[j];
+            }
+            if (ndim == remote_region->ndim) {
+                piece_dims[0] = pieces[i].size[0];
+                piece_data    = (char *)local_data + unit * row * slice;
+            }
+            else {
+                piece_offset[0] = local_offset[0] + row * slice;
+                piece_dims[0]   = pieces[i].size[0] * slice;
+                piece_data      = local_data;
+            }
+            ret_value = PDC_Client_send_buf_map(pieces[i].server_id, meta_server_id, local_region_id,
+                                                object_info, ndim, piece_dims, piece_offset, local_type,
+                                                piece_data, remote_type, &piece_region, &pieces[i].region,
+                                                &map_args[i], &handles[i], &shm_maps[i]);
+        }
+        if (ret_value != SUCCEED)
+            break;
+        n_sent++;
+    }
 #if PDC_TIMING == 1
     timings.PDCbuf_obj_map_rpc += MPI_Wtime() - start;
 #endif
-    if (hg_ret != HG_SUCCESS)
-        PGOTO_ERROR(FAIL, "PDC_Client_send_buf_map(): Could not start HG_Forward()");
 
-    // Wait for response from server
-    work_todo_g = 1;
+    // Wait for response from all servers
+    work_todo_g = n_sent;
 #if PDC_TIMING == 1
     start = MPI_Wtime();
 #endif
-    PDC_Client_check_response(&send_context_g);
+    if (n_sent > 0)
+        PDC_Client_check_response(&send_context_g);
 #if PDC_TIMING == 1
     end = MPI_Wtime();
     timings.PDCbuf_obj_map_rpc_wait += end - start;
     pdc_timestamp_register(client_buf_obj_map_timestamps, start, end);
 #endif
-    if (map_args.ret != 1)
-        PGOTO_ERROR(FAIL, "PDC_CLIENT: buf map failed...");
+
+    // Keep the shared memory of the regions the servers mapped, a server that did not is on another node.
+    // Converted regions keep their staging buffer either way.
+    for (i = 0; i < n_sent; i++) {
+        if (shm_maps[i] == NULL || map_args[i].ret != 1)
+            continue;
+        if (map_args[i].shm == 0 && shm_maps[i]->conv_buf == NULL)
+            pdc_server_info_g[pieces[i].server_id].buf_shm_remote = 1;
+        if (map_args[i].shm == 1 || shm_maps[i]->local_type != shm_maps[i]->remote_type) {
+            shm_maps[i]->shm = map_args[i].shm;
+            DL_APPEND(buf_shm_map_head_g, shm_maps[i]);
+            shm_maps[i] = NULL;
+        }
+    }
+    if (ret_value != SUCCEED)
+        PGOTO_DONE(ret_value);
+    for (i = 0; i < n_piece; i++) {
+        if (map_args[i].ret != 1)
+            PGOTO_ERROR(FAIL, "PDC_CLIENT: buf map failed...");
+    }
 
 done:
     fflush(stdout);
-    free(data_ptrs);
-    free(data_size);
-    HG_Destroy(client_send_buf_map_handle);
+    for (i = 0; i < n_piece; i++) {
+        if (handles != NULL && handles[i] != HG_HANDLE_NULL)
+            HG_Destroy(handles[i]);
+        if (shm_maps != NULL && shm_maps[i] != NULL)
+            PDC_Client_buf_shm_map_free(shm_maps[i], 0);
+    }
+    free(handles);
+    free(shm_maps);
+    free(map_args);
+    free(pieces);
 
     FUNC_LEAVE(ret_value);
 }
@@ -2480,15 +3342,19 @@ PDC_Client_region_lock(struct _pdc_obj_info *object_info, struct pdc_region_info
                        pdc_access_t access_type, pdc_lock_mode_t lock_mode, pdc_var_type_t data_type,
                        pbool_t *status)
 {
-    perr_t                       ret_value = SUCCEED;
-    hg_return_t                  hg_ret;
-    uint32_t                     server_id, meta_server_id;
-    region_lock_in_t             in;
-    struct _pdc_region_lock_args lookup_args;
-    hg_handle_t                  region_lock_handle;
+    perr_t                        ret_value = SUCCEED;
+    hg_return_t                   hg_ret;
+    uint32_t                      server_id, meta_server_id;
+    region_lock_in_t              in;
+    struct _pdc_region_lock_args *lookup_args = NULL;
+    hg_handle_t *                 handles     = NULL;
+    pdc_region_piece_t *          pieces      = NULL;
+    int                           i, n_piece = 0, n_sent = 0;
 
     FUNC_ENTER(NULL);
 
+    *status = FALSE;
+
     // Compute local data server id
     if (pdc_server_selection_g != PDC_SERVER_DEFAULT) {
         server_id      = object_info->obj_info_pub->server_id;
@@ -2504,9 +3370,6 @@ PDC_Client_region_lock(struct _pdc_obj_info *object_info, struct pdc_region_info
     in.meta_server_id = meta_server_id;
     in.lock_mode      = lock_mode;
 
-    // Debug statistics for counting number of messages sent to each server.
-    debug_server_id_count[server_id]++;
-
     // Fill input structure
     in.obj_id       = object_info->obj_info_pub->meta_id;
     in.access_type  = access_type;
@@ -2519,47 +3382,80 @@ PDC_Client_region_lock(struct _pdc_obj_info *object_info, struct pdc_region_info
         PGOTO_ERROR(FAIL, "Dimension %lu is not supported", ndim);
 
     in.data_unit = PDC_get_var_type_size(data_type);
-    PDC_region_info_t_to_transfer_unit(region_info, &(in.region), in.data_unit);
 
-    if (PDC_Client_try_lookup_server(server_id) != SUCCEED)
-        PGOTO_ERROR(FAIL, "==CLIENT[%d]: ERROR with PDC_Client_try_lookup_server", pdc_client_mpi_rank_g);
+    // Lock each stripe of the region on its data server
+    n_piece = PDC_Client_split_region(object_info, region_info, server_id, &pieces);
+    if (n_piece < 0)
+        PGOTO_ERROR(FAIL, "==CLIENT[%d]: ERROR splitting region to stripes", pdc_client_mpi_rank_g);
+    lookup_args = (struct _pdc_region_lock_args *)calloc(n_piece, sizeof(struct _pdc_region_lock_args));
+    handles     = (hg_handle_t *)calloc(n_piece, sizeof(hg_handle_t));
+    if (lookup_args == NULL || handles == NULL)
+        PGOTO_ERROR(FAIL, "==CLIENT[%d]: ERROR allocating lock requests", pdc_client_mpi_rank_g);
 
-    HG_Create(send_context_g, pdc_server_info_g[server_id].addr, region_lock_register_id_g,
-              &region_lock_handle);
 #if PDC_TIMING == 1
     double start = MPI_Wtime(), end;
 #endif
-    hg_ret = HG_Forward(region_lock_handle, client_region_lock_rpc_cb, &lookup_args, &in);
+    for (i = 0; i < n_piece; i++) {
+        handles[i] = HG_HANDLE_NULL;
+        server_id  = pieces[i].server_id;
+
+        // Debug statistics for counting number of messages sent to each server.
+        debug_server_id_count[server_id]++;
+
+        PDC_region_info_t_to_transfer_unit(&pieces[i].region, &(in.region), in.data_unit);
+
+        if (PDC_Client_try_lookup_server(server_id) != SUCCEED) {
+            printf("==CLIENT[%d]: ERROR with PDC_Client_try_lookup_server\n", pdc_client_mpi_rank_g);
+            ret_value = FAIL;
+            break;
+        }
+
+        HG_Create(send_context_g, pdc_server_info_g[server_id].addr, region_lock_register_id_g, &handles[i]);
+        hg_ret = HG_Forward(handles[i], client_region_lock_rpc_cb, &lookup_args[i], &in);
+        if (hg_ret != HG_SUCCESS) {
+            printf("PDC_Client_send_name_to_server(): Could not start HG_Forward()\n");
+            ret_value = FAIL;
+            break;
+        }
+        n_sent++;
+    }
 #if PDC_TIMING == 1
     timings.PDCreg_obtain_lock_rpc += MPI_Wtime() - start;
 #endif
-    if (hg_ret != HG_SUCCESS)
-        PGOTO_ERROR(FAIL, "PDC_Client_send_name_to_server(): Could not start HG_Forward()");
 
-    // Wait for response from server
-    work_todo_g = 1;
+    // Wait for response from all servers
+    work_todo_g = n_sent;
 #if PDC_TIMING == 1
     start = MPI_Wtime();
 #endif
-    PDC_Client_check_response(&send_context_g);
+    if (n_sent > 0)
+        PDC_Client_check_response(&send_context_g);
 #if PDC_TIMING == 1
     end = MPI_Wtime();
     timings.PDCreg_obtain_lock_rpc_wait += end - start;
     pdc_timestamp_register(client_obtain_lock_timestamps, start, end);
 #endif
-    // Now the return value is stored in lookup_args.ret
-    if (lookup_args.ret == 1) {
-        *status   = TRUE;
-        ret_value = SUCCEED;
-    }
-    else {
-        *status   = FALSE;
-        ret_value = FAIL;
+    if (ret_value != SUCCEED)
+        PGOTO_DONE(ret_value);
+
+    // Now the return values are stored in lookup_args[i].ret
+    *status = TRUE;
+    for (i = 0; i < n_piece; i++) {
+        if (lookup_args[i].ret != 1) {
+            *status   = FALSE;
+            ret_value = FAIL;
+        }
     }
 
 done:
     fflush(stdout);
-    HG_Destroy(region_lock_handle);
+    for (i = 0; i < n_piece; i++) {
+        if (handles != NULL && handles[i] != HG_HANDLE_NULL)
+            HG_Destroy(handles[i]);
+    }
+    free(handles);
+    free(lookup_args);
+    free(pieces);
 
     FUNC_LEAVE(ret_value);
 }
@@ -2907,7 +3803,7 @@ update_metadata(struct _pdc_obj_info *object_info, pdc_var_type_t data_type, siz
 
     if (pdc_client_mpi_rank_g == 0) {
         PDC_metadata_init(&meta);
-        strcpy(meta.obj_name, object_info->obj_info_pub->name);
+        meta.obj_name  = object_info->obj_info_pub->name;
         meta.time_step = object_info->obj_pt->time_step;
         meta.obj_id    = object_info->obj_info_pub->meta_id;
         meta.cont_id   = object_info->cont->cont_info_pub->meta_id;
@@ -3084,6 +3980,61 @@ maybe_run_transform(struct _pdc_obj_info *object_info, struct pdc_region_info *r
 }
 */
 
+/*
+ * Run the transform pipelines that run on the client for a mapped region, the data of the mapping source
+ * goes through the stages to the buffer of the destination object
+ *
+ * \param  object_info[IN]      Destination object of the mapping
+ * \param  region_info[IN]      Destination region of the mapping
+ * \param  when[IN]             DATA_OUT before the region is written, DATA_IN after it is read
+ */
+static void
+PDC_Client_run_transform_pipelines(struct _pdc_obj_info *object_info, struct pdc_region_info *region_info,
+                                   pdc_data_movement_t when)
+{
+    struct _pdc_region_transform_ftn_info **registry = NULL;
+    struct _pdc_region_transform_ftn_info * thisFtn;
+    int                                     k, registered_count = PDC_get_transforms(&registry);
+    size_t                                  i, nelem, type_extent, dest_extent, out_size;
+    void *                                  out;
+
+    FUNC_ENTER(NULL);
+
+    // A pipeline that moves the object to its next state enables the ones registered for that state
+    for (k = 0; k < registered_count; k++) {
+        thisFtn = registry[k];
+        if (thisFtn->pipeline == NULL || thisFtn->dest_region != region_info || thisFtn->when != when ||
+            thisFtn->readyState != (int)object_info->obj_pt->data_state)
+            continue;
+        if (thisFtn->data == NULL || thisFtn->result == NULL) {
+            printf("==PDC_CLIENT[%d]: transform pipeline needs the buffers of both mapped objects\n",
+                   pdc_client_mpi_rank_g);
+            continue;
+        }
+
+        nelem = region_info->size[0];
+        for (i = 1; i < region_info->ndim; i++)
+            nelem *= region_info->size[i];
+        type_extent = thisFtn->type_extent ? (size_t)thisFtn->type_extent
+                                           : (size_t)PDC_get_var_type_size(thisFtn->type);
+        dest_extent = thisFtn->dest_extent ? (size_t)thisFtn->dest_extent
+                                           : (size_t)PDC_get_var_type_size(thisFtn->dest_type);
+        out      = thisFtn->result;
+        out_size = nelem * dest_extent;
+        if (PDC_transform_pipeline_run(thisFtn->pipeline, thisFtn->data, nelem * type_extent, thisFtn->type,
+                                       &out, &out_size, NULL) != SUCCEED) {
+            printf("==PDC_CLIENT[%d]: transform pipeline %s failed\n", pdc_client_mpi_rank_g,
+                   thisFtn->pipeline->spec);
+            continue;
+        }
+        thisFtn->ftn_lastResult         = (int)out_size;
+        object_info->obj_pt->data_state = thisFtn->nextState;
+    }
+
+    fflush(stdout);
+    FUNC_LEAVE_VOID;
+}
+
 perr_t
 PDC_Client_region_release(struct _pdc_obj_info *object_info, struct pdc_region_info *region_info,
                           pdc_access_t access_type, pdc_var_type_t data_type, pbool_t *status)
@@ -3094,8 +4045,11 @@ PDC_Client_region_release(struct _pdc_obj_info *object_info, struct pdc_region_i
     uint32_t         server_id, meta_server_id;
     region_lock_in_t in;
     // size_t                         type_extent;
-    struct _pdc_client_lookup_args lookup_args;
-    hg_handle_t                    region_release_handle = HG_HANDLE_NULL;
+    struct _pdc_client_lookup_args *lookup_args = NULL;
+    hg_handle_t *                   handles     = NULL;
+    pdc_region_piece_t *            pieces      = NULL;
+    pdc_buf_shm_map_t **            shm_maps    = NULL;
+    int                             i, n_piece = 0, n_sent = 0;
     // void *transform_result = NULL;
     // size_t transform_size = 0;
     // struct _pdc_region_transform_ftn_info **registry = NULL;
@@ -3133,6 +4087,10 @@ PDC_Client_region_release(struct _pdc_obj_info *object_info, struct pdc_region_i
             }
         }
     */
+    // Pipelines of the client fill the destination object before it is written
+    if ((region_info->registered_op & PDC_TRANSFORM) && access_type == PDC_WRITE)
+        PDC_Client_run_transform_pipelines(object_info, region_info, DATA_OUT);
+
     // Compute data server and metadata server ids.
     if (pdc_server_selection_g != PDC_SERVER_DEFAULT) {
         server_id      = object_info->obj_info_pub->server_id;
@@ -3145,9 +4103,7 @@ PDC_Client_region_release(struct _pdc_obj_info *object_info, struct pdc_region_i
         server_id = PDC_CLIENT_DATA_SERVER();
     }
     in.meta_server_id = meta_server_id;
-
-    // Debug statistics for counting number of messages sent to each server.
-    debug_server_id_count[server_id]++;
+    *status           = FALSE;
 
     // Fill input structure
     in.obj_id       = object_info->obj_info_pub->meta_id;
@@ -3161,47 +4117,96 @@ PDC_Client_region_release(struct _pdc_obj_info *object_info, struct pdc_region_i
         PGOTO_ERROR(FAIL, "Dimension %lu is not supported", ndim);
 
     in.data_unit = PDC_get_var_type_size(data_type);
-    PDC_region_info_t_to_transfer_unit(region_info, &(in.region), in.data_unit);
-    if (PDC_Client_try_lookup_server(server_id) != SUCCEED)
-        PGOTO_ERROR(FAIL, "==CLIENT[%d]: ERROR with PDC_Client_try_lookup_server", pdc_client_mpi_rank_g);
 
-    HG_Create(send_context_g, pdc_server_info_g[server_id].addr, region_release_register_id_g,
-              &region_release_handle);
+    // Release each stripe of the region on its data server, which transfers the stripes in parallel
+    n_piece = PDC_Client_split_region(object_info, region_info, server_id, &pieces);
+    if (n_piece < 0)
+        PGOTO_ERROR(FAIL, "==CLIENT[%d]: ERROR splitting region to stripes", pdc_client_mpi_rank_g);
+    lookup_args = (struct _pdc_client_lookup_args *)calloc(n_piece, sizeof(struct _pdc_client_lookup_args));
+    handles     = (hg_handle_t *)calloc(n_piece, sizeof(hg_handle_t));
+    shm_maps    = (pdc_buf_shm_map_t **)calloc(n_piece, sizeof(pdc_buf_shm_map_t *));
+    if (lookup_args == NULL || handles == NULL || shm_maps == NULL)
+        PGOTO_ERROR(FAIL, "==CLIENT[%d]: ERROR allocating release requests", pdc_client_mpi_rank_g);
+
 #if PDC_TIMING == 1
     double start = MPI_Wtime(), end;
 #endif
-    hg_ret = HG_Forward(region_release_handle, client_region_release_rpc_cb, &lookup_args, &in);
+    for (i = 0; i < n_piece; i++) {
+        handles[i] = HG_HANDLE_NULL;
+        server_id  = pieces[i].server_id;
+
+        // Debug statistics for counting number of messages sent to each server.
+        debug_server_id_count[server_id]++;
+
+        PDC_region_info_t_to_transfer_unit(&pieces[i].region, &(in.region), in.data_unit);
+        if (PDC_Client_try_lookup_server(server_id) != SUCCEED) {
+            printf("==CLIENT[%d]: ERROR with PDC_Client_try_lookup_server\n", pdc_client_mpi_rank_g);
+            ret_value = FAIL;
+            break;
+        }
+
+        // A server on this node reads a written region from the shared memory of the client. A staged region
+        // the server does not fill is refreshed from the user buffer, as it is copied back after a read.
+        shm_maps[i] = PDC_Client_buf_shm_find(in.obj_id, server_id, &in.region);
+        if (shm_maps[i] != NULL && (access_type == PDC_WRITE || shm_maps[i]->shm == 0))
+            PDC_Client_buf_shm_copy(shm_maps[i], 1);
+        else if (shm_maps[i] != NULL)
+            PDC_BUF_SHM_HDR(shm_maps[i]->shm_buf)->filled = 0;
+
+        HG_Create(send_context_g, pdc_server_info_g[server_id].addr, region_release_register_id_g,
+                  &handles[i]);
+        hg_ret = HG_Forward(handles[i], client_region_release_rpc_cb, &lookup_args[i], &in);
+        if (hg_ret != HG_SUCCESS) {
+            printf("PDC_Client_send_name_to_server(): Could not start HG_Forward()\n");
+            ret_value = FAIL;
+            break;
+        }
+        n_sent++;
+    }
 #if PDC_TIMING == 1
     timings.PDCreg_release_lock_rpc += MPI_Wtime() - start;
 #endif
-    if (hg_ret != HG_SUCCESS)
-        PGOTO_ERROR(FAIL, "PDC_Client_send_name_to_server(): Could not start HG_Forward()");
 
-    // Wait for response from server
-    work_todo_g = 1;
+    // Wait for response from all servers
+    work_todo_g = n_sent;
 #if PDC_TIMING == 1
     start = MPI_Wtime();
 #endif
-    PDC_Client_check_response(&send_context_g);
+    if (n_sent > 0)
+        PDC_Client_check_response(&send_context_g);
 #if PDC_TIMING == 1
     end = MPI_Wtime();
     timings.PDCreg_release_lock_rpc_wait += end - start;
     pdc_timestamp_register(client_release_lock_timestamps, start, end);
 #endif
-    // Now the return value is stored in lookup_args.ret
-    if (lookup_args.ret == 1) {
-        *status   = TRUE;
-        ret_value = SUCCEED;
-    }
-    else {
-        *status   = FALSE;
-        ret_value = FAIL;
+    if (ret_value != SUCCEED)
+        PGOTO_DONE(ret_value);
+
+    // Now the return values are stored in lookup_args[i].ret
+    *status = TRUE;
+    for (i = 0; i < n_piece; i++) {
+        if (lookup_args[i].ret != 1) {
+            *status   = FALSE;
+            ret_value = FAIL;
+        }
+        // Data of a read release is in the shared memory only if the server had new data for the region
+        else if (shm_maps[i] != NULL && access_type == PDC_READ &&
+                 (shm_maps[i]->shm == 0 || PDC_BUF_SHM_HDR(shm_maps[i]->shm_buf)->filled == 1))
+            PDC_Client_buf_shm_copy(shm_maps[i], 0);
     }
+    if (*status == TRUE && (region_info->registered_op & PDC_TRANSFORM) && access_type == PDC_READ)
+        PDC_Client_run_transform_pipelines(object_info, region_info, DATA_IN);
 
 done:
     fflush(stdout);
-    if (region_release_handle != HG_HANDLE_NULL)
-        HG_Destroy(region_release_handle);
+    for (i = 0; i < n_piece; i++) {
+        if (handles != NULL && handles[i] != HG_HANDLE_NULL)
+            HG_Destroy(handles[i]);
+    }
+    free(handles);
+    free(shm_maps);
+    free(lookup_args);
+    free(pieces);
 
     FUNC_LEAVE(ret_value);
 }
@@ -3791,8 +4796,7 @@ PDC_Client_data_server_write(struct pdc_request *request)
     // First check the obj ID are the same among the node local ranks
 
     // Normal send to server by each process
-    meta->data_location[0] = ' ';
-    meta->data_location[1] = 0;
+    meta->data_location = PDC_metadata_intern_str(" ");
 
     in.client_id = pdc_client_mpi_rank_g;
     in.nclient   = n_client;
@@ -3918,7 +4922,7 @@ PDC_Client_iwrite(pdc_metadata_t *meta, struct pdc_region_info *region, struct p
 
     FUNC_ENTER(NULL);
 
-    request->server_id = (pdc_client_mpi_rank_g / pdc_nclient_per_server_g) % pdc_server_num_g;
+    request->server_id = PDC_CLIENT_DATA_SERVER();
     if (request->n_client == 0)
         request->n_client = pdc_nclient_per_server_g; // Set by env var PDC_NCLIENT_PER_SERVER, default 1
     if (request->n_update == 0)
@@ -4023,7 +5027,7 @@ PDC_Client_iread(pdc_metadata_t *meta, struct pdc_region_info *region, struct pd
 
     FUNC_ENTER(NULL);
 
-    request->server_id = (pdc_client_mpi_rank_g / pdc_nclient_per_server_g) % pdc_server_num_g;
+    request->server_id = PDC_CLIENT_DATA_SERVER();
     if (request->n_client == 0)
         request->n_client = pdc_nclient_per_server_g; // Set by env var PDC_NCLIENT_PER_SERVER, default 1
     if (request->n_update == 0)
@@ -4360,7 +5364,7 @@ PDC_Client_query_container_name(const char *cont_name, uint64_t *cont_meta_id)
 
     // Compute server id
     hash_name_value = PDC_get_hash_by_name(cont_name);
-    server_id       = hash_name_value % pdc_server_num_g;
+    server_id       = PDC_placement_get_server(hash_name_value, pdc_server_num_g);
 
     // Debug statistics for counting number of messages sent to each server.
     debug_server_id_count[server_id]++;
@@ -4770,26 +5774,24 @@ perr_t
 PDC_Client_attach_metadata_to_local_obj(const char *obj_name, uint64_t obj_id, uint64_t cont_id,
                                         struct _pdc_obj_info *obj_info)
 {
-    perr_t ret_value = SUCCEED;
+    perr_t          ret_value = SUCCEED;
+    pdc_metadata_t *meta;
 
     FUNC_ENTER(NULL);
 
-    obj_info->metadata                              = (pdc_metadata_t *)calloc(1, sizeof(pdc_metadata_t));
-    ((pdc_metadata_t *)obj_info->metadata)->user_id = obj_info->obj_pt->user_id;
-    if (NULL != obj_info->obj_pt->app_name)
-        strcpy(((pdc_metadata_t *)obj_info->metadata)->app_name, obj_info->obj_pt->app_name);
-    if (NULL != obj_name)
-        strcpy(((pdc_metadata_t *)obj_info->metadata)->obj_name, obj_name);
-    ((pdc_metadata_t *)obj_info->metadata)->time_step = obj_info->obj_pt->time_step;
-    ((pdc_metadata_t *)obj_info->metadata)->obj_id    = obj_id;
-    ((pdc_metadata_t *)obj_info->metadata)->cont_id   = cont_id;
-    if (NULL != obj_info->obj_pt->tags)
-        strcpy(((pdc_metadata_t *)obj_info->metadata)->tags, obj_info->obj_pt->tags);
-    if (NULL != obj_info->obj_pt->data_loc)
-        strcpy(((pdc_metadata_t *)obj_info->metadata)->data_location, obj_info->obj_pt->data_loc);
-    ((pdc_metadata_t *)obj_info->metadata)->ndim = obj_info->obj_pt->obj_prop_pub->ndim;
+    meta                = (pdc_metadata_t *)calloc(1, sizeof(pdc_metadata_t));
+    obj_info->metadata  = meta;
+    meta->user_id       = obj_info->obj_pt->user_id;
+    meta->app_name      = PDC_metadata_intern_str(obj_info->obj_pt->app_name);
+    meta->obj_name      = PDC_metadata_intern_str(obj_name);
+    meta->time_step     = obj_info->obj_pt->time_step;
+    meta->obj_id        = obj_id;
+    meta->cont_id       = cont_id;
+    meta->tags          = PDC_metadata_intern_str(obj_info->obj_pt->tags);
+    meta->data_location = PDC_metadata_intern_str(obj_info->obj_pt->data_loc);
+    meta->ndim          = obj_info->obj_pt->obj_prop_pub->ndim;
     if (NULL != obj_info->obj_pt->obj_prop_pub->dims)
-        memcpy(((pdc_metadata_t *)obj_info->metadata)->dims, obj_info->obj_pt->obj_prop_pub->dims,
+        memcpy(meta->dims, obj_info->obj_pt->obj_prop_pub->dims,
                sizeof(uint64_t) * obj_info->obj_pt->obj_prop_pub->ndim);
 
     FUNC_LEAVE(ret_value);
@@ -6604,6 +7606,91 @@ done:
     FUNC_LEAVE(ret_value);
 }
 
+static hg_return_t
+obj_get_stats_rpc_cb(const struct hg_cb_info *callback_info)
+{
+    hg_return_t                     ret_value = HG_SUCCESS;
+    struct _pdc_get_obj_stats_args *args      = (struct _pdc_get_obj_stats_args *)callback_info->arg;
+    hg_handle_t                     handle    = callback_info->info.forward.handle;
+    obj_get_stats_out_t             output;
+
+    FUNC_ENTER(NULL);
+
+    ret_value = HG_Get_output(handle, &output);
+    if (ret_value != HG_SUCCESS) {
+        args->ret = -1;
+        PGOTO_ERROR(ret_value, "==PDC_CLIENT[%d]: error with HG_Get_output", pdc_client_mpi_rank_g);
+    }
+    args->ret = output.ret;
+    if (output.ret == 1 && output.sketch_size > 0)
+        args->stats = PDC_sketch_deserialize(output.sketch, output.sketch_size);
+
+done:
+    fflush(stdout);
+    work_todo_g--;
+    HG_Free_output(handle, &output);
+
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDCobj_get_stats(pdcid_t obj_id, pdc_sketch_t **stats)
+{
+    perr_t                         ret_value = SUCCEED;
+    hg_return_t                    hg_ret;
+    uint32_t                       server_id;
+    hg_handle_t                    obj_get_stats_handle;
+    obj_get_stats_in_t             in;
+    struct _pdc_get_obj_stats_args args;
+    struct _pdc_obj_info *         obj_prop;
+
+    FUNC_ENTER(NULL);
+
+    if (stats == NULL)
+        PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: NULL output pointer", pdc_client_mpi_rank_g);
+    *stats = NULL;
+
+    obj_prop = PDC_obj_get_info(obj_id);
+    if (obj_prop == NULL)
+        PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: cannot locate object", pdc_client_mpi_rank_g);
+
+    // The storage regions and their sketches are kept by the metadata server of the object
+    in.obj_id = obj_prop->obj_info_pub->meta_id;
+    server_id = PDC_get_server_by_obj_id(in.obj_id, pdc_server_num_g);
+    debug_server_id_count[server_id]++;
+
+    if (PDC_Client_try_lookup_server(server_id) != SUCCEED)
+        PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: ERROR with PDC_Client_try_lookup_server", pdc_client_mpi_rank_g);
+
+    HG_Create(send_context_g, pdc_server_info_g[server_id].addr, obj_get_stats_register_id_g,
+              &obj_get_stats_handle);
+
+    args.ret   = -1;
+    args.stats = NULL;
+    hg_ret     = HG_Forward(obj_get_stats_handle, obj_get_stats_rpc_cb, &args, &in);
+    if (hg_ret != HG_SUCCESS) {
+        HG_Destroy(obj_get_stats_handle);
+        PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: Could not start HG_Forward()", pdc_client_mpi_rank_g);
+    }
+
+    // Wait for response from server
+    work_todo_g = 1;
+    PDC_Client_check_response(&send_context_g);
+    HG_Destroy(obj_get_stats_handle);
+
+    if (args.ret != 1)
+        PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: server cannot get the object statistics", pdc_client_mpi_rank_g);
+    if (args.stats == NULL)
+        PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: object has no sketch, PDC_GEN_SKETCH is not set on the servers",
+                    pdc_client_mpi_rank_g);
+
+    *stats = args.stats;
+
+done:
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
+
 perr_t
 PDCobj_del_tag(pdcid_t obj_id, char *tag_name)
 {
@@ -6680,7 +7767,10 @@ PDC_recv_nhits(const struct hg_cb_info *callback_info)
     DL_FOREACH(pdcquery_result_list_head_g, result_elt)
     {
         if (result_elt->query_id == in->query_id) {
-            result_elt->nhits = in->nhits;
+            result_elt->nhits   = in->nhits;
+            result_elt->agg_sum = in->sum;
+            result_elt->agg_min = in->min;
+            result_elt->agg_max = in->max;
             break;
         }
     }
@@ -6694,7 +7784,7 @@ PDC_recv_nhits(const struct hg_cb_info *callback_info)
 
 perr_t
 PDC_send_data_query(pdc_query_t *query, pdc_query_get_op_t get_op, uint64_t *nhits, pdc_selection_t *sel,
-                    void *data ATTRIBUTE(unused))
+                    void *data)
 {
     perr_t                         ret_value      = SUCCEED;
     hg_return_t                    hg_ret         = 0;
@@ -6704,6 +7794,7 @@ PDC_send_data_query(pdc_query_t *query, pdc_query_get_op_t get_op, uint64_t *nhi
     pdc_query_xfer_t *             query_xfer;
     struct _pdc_client_lookup_args lookup_args;
     struct _pdc_query_result_list *result;
+    pdc_query_agg_t *              agg = NULL;
 
     FUNC_ENTER(NULL);
 
@@ -6720,6 +7811,13 @@ PDC_send_data_query(pdc_query_t *query, pdc_query_get_op_t get_op, uint64_t *nhi
     query_xfer->manager      = target_servers[0];
     query_xfer->get_op       = (int)get_op;
 
+    if (get_op == PDC_QUERY_GET_AGG) {
+        agg = (pdc_query_agg_t *)data;
+        if (agg == NULL)
+            PGOTO_ERROR(FAIL, "==CLIENT[%d]: NULL aggregate output", pdc_client_mpi_rank_g);
+        query_xfer->agg_obj_id = agg->obj_id;
+    }
+
     result           = (struct _pdc_query_result_list *)calloc(1, sizeof(struct _pdc_query_result_list));
     result->query_id = query_xfer->query_id;
     DL_APPEND(pdcquery_result_list_head_g, result);
@@ -6775,6 +7873,17 @@ PDC_send_data_query(pdc_query_t *query, pdc_query_get_op_t get_op, uint64_t *nhi
         sel->ndim         = result->ndim;
         sel->coords_alloc = result->nhits * result->ndim;
     }
+    if (agg) {
+        agg->count = result->nhits;
+        if (result->nhits > 0) {
+            agg->sum  = result->agg_sum;
+            agg->min  = result->agg_min;
+            agg->max  = result->agg_max;
+            agg->mean = result->agg_sum / result->nhits;
+        }
+        else
+            agg->sum = agg->min = agg->max = agg->mean = 0;
+    }
 
 done:
     fflush(stdout);
@@ -7018,3 +8127,261 @@ done:
 
     FUNC_LEAVE(ret_value);
 }
+
+perr_t
+PDC_Client_query_cursor_open(pdc_query_t *query, pdc_query_cursor_t *cursor)
+{
+    perr_t          ret_value = SUCCEED;
+    pdc_selection_t sel;
+
+    FUNC_ENTER(NULL);
+
+    if (query == NULL || cursor == NULL)
+        PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: NULL input!", pdc_client_mpi_rank_g);
+
+    // Servers only report the number of hits, and keep their selection until the cursor pulls it
+    memset(&sel, 0, sizeof(pdc_selection_t));
+    ret_value = PDC_send_data_query(query, PDC_QUERY_GET_CURSOR, &cursor->nhits, &sel, NULL);
+    if (ret_value != SUCCEED)
+        PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: ERROR with PDC_send_data_query", pdc_client_mpi_rank_g);
+
+    cursor->query_id   = sel.query_id;
+    cursor->nhits_read = 0;
+    cursor->server_id  = 0;
+    cursor->server_off = 0;
+    cursor->is_done    = cursor->nhits == 0 ? 1 : 0;
+
+done:
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
+
+static perr_t
+PDC_Client_send_query_cursor_rpc(int server_id, query_cursor_rpc_in_t *in)
+{
+    perr_t                         ret_value = SUCCEED;
+    hg_return_t                    hg_ret;
+    hg_handle_t                    handle;
+    struct _pdc_client_lookup_args lookup_args;
+
+    FUNC_ENTER(NULL);
+
+    debug_server_id_count[server_id]++;
+
+    if (PDC_Client_try_lookup_server(server_id) != SUCCEED)
+        PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: ERROR with PDC_Client_try_lookup_server", pdc_client_mpi_rank_g);
+
+    HG_Create(send_context_g, pdc_server_info_g[server_id].addr, query_cursor_register_id_g, &handle);
+
+    hg_ret = HG_Forward(handle, pdc_client_check_int_ret_cb, &lookup_args, in);
+    if (hg_ret != HG_SUCCESS) {
+        HG_Destroy(handle);
+        PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: ERROR with HG_Forward", pdc_client_mpi_rank_g);
+    }
+
+    // Wait for the response, and for the batch when pulling the next one
+    work_todo_g = in->op == PDC_QUERY_CURSOR_NEXT ? 2 : 1;
+    PDC_Client_check_response(&send_context_g);
+
+    HG_Destroy(handle);
+
+    if (lookup_args.ret != 1)
+        PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: query cursor op to server %d failed ... ret_value = %d",
+                    pdc_client_mpi_rank_g, server_id, lookup_args.ret);
+
+done:
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDC_Client_query_cursor_next(pdc_query_cursor_t *cursor, pdc_selection_t *sel, void *data)
+{
+    perr_t                         ret_value = SUCCEED;
+    uint64_t                       n;
+    query_cursor_rpc_in_t          in;
+    struct _pdc_query_result_list *result_elt = NULL;
+
+    FUNC_ENTER(NULL);
+
+    if (cursor == NULL || sel == NULL)
+        PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: NULL input!", pdc_client_mpi_rank_g);
+
+    memset(sel, 0, sizeof(pdc_selection_t));
+    sel->query_id = cursor->query_id;
+
+    DL_FOREACH(pdcquery_result_list_head_g, result_elt)
+    {
+        if (result_elt->query_id == (int)cursor->query_id)
+            break;
+    }
+    if (result_elt == NULL)
+        PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: invalid query cursor!", pdc_client_mpi_rank_g);
+
+    in.query_id = cursor->query_id;
+    in.origin   = pdc_client_mpi_rank_g;
+    in.op       = PDC_QUERY_CURSOR_NEXT;
+    in.obj_id   = cursor->data_obj_id;
+    in.count    = cursor->batch_nhits;
+
+    // Drain the servers one after another, skipping the ones that have no more hits
+    while (cursor->is_done == 0) {
+        in.offset                   = cursor->server_off;
+        result_elt->batch_nhits     = 0;
+        result_elt->batch_data_size = 0;
+
+        if (PDC_Client_send_query_cursor_rpc(cursor->server_id, &in) != SUCCEED)
+            PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: ERROR pulling query cursor batch from server %d",
+                        pdc_client_mpi_rank_g, cursor->server_id);
+
+        n = result_elt->batch_nhits;
+        cursor->server_off += n;
+        cursor->nhits_read += n;
+
+        // A short batch means the server has no more hits
+        if (n < cursor->batch_nhits) {
+            cursor->server_id++;
+            cursor->server_off = 0;
+        }
+        if (cursor->server_id >= pdc_server_num_g || cursor->nhits_read >= cursor->nhits)
+            cursor->is_done = 1;
+
+        if (n == 0)
+            continue;
+
+        sel->ndim          = result_elt->ndim;
+        sel->nhits         = n;
+        sel->coords        = result_elt->coords;
+        sel->coords_alloc  = n * result_elt->ndim;
+        result_elt->coords = NULL;
+
+        if (data != NULL && cursor->data_obj_id != 0) {
+            if (result_elt->batch_data_size == 0)
+                PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: server %d did not return data for the batch",
+                            pdc_client_mpi_rank_g, cursor->server_id);
+            memcpy(data, result_elt->data, result_elt->batch_data_size);
+        }
+        break;
+    }
+
+done:
+    if (result_elt && result_elt->data) {
+        free(result_elt->data);
+        result_elt->data = NULL;
+    }
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDC_Client_query_cursor_close(pdc_query_cursor_t *cursor)
+{
+    perr_t                         ret_value = SUCCEED;
+    int                            server_id;
+    query_cursor_rpc_in_t          in;
+    struct _pdc_query_result_list *result_elt;
+
+    FUNC_ENTER(NULL);
+
+    if (cursor == NULL)
+        PGOTO_ERROR(FAIL, "==PDC_CLIENT[%d]: NULL input!", pdc_client_mpi_rank_g);
+
+    in.query_id = cursor->query_id;
+    in.origin   = pdc_client_mpi_rank_g;
+    in.op       = PDC_QUERY_CURSOR_CLOSE;
+    in.obj_id   = 0;
+    in.offset   = 0;
+    in.count    = 0;
+
+    for (server_id = 0; server_id < pdc_server_num_g; server_id++) {
+        if (PDC_Client_send_query_cursor_rpc(server_id, &in) != SUCCEED)
+            ret_value = FAIL;
+    }
+
+    DL_FOREACH(pdcquery_result_list_head_g, result_elt)
+    {
+        if (result_elt->query_id == (int)cursor->query_id) {
+            DL_DELETE(pdcquery_result_list_head_g, result_elt);
+            if (result_elt->coords)
+                free(result_elt->coords);
+            free(result_elt);
+            break;
+        }
+    }
+
+done:
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
+
+hg_return_t
+PDC_recv_query_cursor_batch(const struct hg_cb_info *callback_info)
+{
+    hg_return_t                    ret_value         = HG_SUCCESS;
+    hg_bulk_t                      local_bulk_handle = callback_info->info.bulk.local_handle;
+    struct bulk_args_t *           bulk_args         = (struct bulk_args_t *)callback_info->arg;
+    struct _pdc_query_result_list *result_elt;
+    uint64_t                       nhits = 0, coords_size;
+    void *                         buf;
+    pdc_int_ret_t                  out;
+
+    FUNC_ENTER(NULL);
+
+    out.ret = 1;
+
+    if (callback_info->ret != HG_SUCCESS) {
+        out.ret = -1;
+        PGOTO_ERROR(HG_PROTOCOL_ERROR, "Error in callback");
+    }
+    else {
+        nhits = bulk_args->cnt;
+
+        DL_FOREACH(pdcquery_result_list_head_g, result_elt)
+        {
+            if (result_elt->query_id == bulk_args->query_id)
+                break;
+        }
+        if (result_elt == NULL)
+            PGOTO_ERROR(HG_OTHER_ERROR, "==PDC_CLIENT[%d]: Invalid task ID!", pdc_client_mpi_rank_g);
+
+        result_elt->batch_nhits = nhits;
+        if (nhits > 0) {
+            ret_value = HG_Bulk_access(local_bulk_handle, 0, bulk_args->nbytes, HG_BULK_READWRITE, 1,
+                                       (void **)&buf, NULL, NULL);
+
+            // Coords come first, followed by the data when the cursor reads an object
+            coords_size = nhits * bulk_args->ndim * sizeof(uint64_t);
+            if (coords_size > bulk_args->nbytes)
+                PGOTO_ERROR(HG_OTHER_ERROR, "==PDC_CLIENT[%d]: cursor batch is smaller than expected!",
+                            pdc_client_mpi_rank_g);
+
+            result_elt->ndim   = bulk_args->ndim;
+            result_elt->coords = (uint64_t *)malloc(coords_size);
+            memcpy(result_elt->coords, buf, coords_size);
+
+            result_elt->batch_data_size = bulk_args->nbytes - coords_size;
+            if (result_elt->batch_data_size > 0) {
+                result_elt->data = malloc(result_elt->batch_data_size);
+                memcpy(result_elt->data, buf + coords_size, result_elt->batch_data_size);
+            }
+        }
+    } // End else
+
+done:
+    work_todo_g--;
+    if (nhits > 0) {
+        ret_value = HG_Bulk_free(local_bulk_handle);
+        if (ret_value != HG_SUCCESS)
+            fprintf(stderr, "==PDC_CLIENT[%d]: Could not free HG bulk handle\n", pdc_client_mpi_rank_g);
+    }
+
+    ret_value = HG_Respond(bulk_args->handle, NULL, NULL, &out);
+    if (ret_value != HG_SUCCESS)
+        fprintf(stderr, "==PDC_CLIENT[%d]: Could not respond\n", pdc_client_mpi_rank_g);
+
+    fflush(stdout);
+    HG_Destroy(bulk_args->handle);
+    free(bulk_args);
+
+    FUNC_LEAVE(ret_value);
+}
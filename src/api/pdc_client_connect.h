@@ -45,6 +45,7 @@ struct _pdc_server_info {
     char      addr_string[ADDR_MAX];
     int       addr_valid;
     hg_addr_t addr;
+    int       buf_shm_remote; // Set once the server could not map the buf-map shared memory of this client
 };
 
 struct _pdc_client_lookup_args {
@@ -78,6 +79,7 @@ struct _pdc_client_transform_args {
 
 struct _pdc_metadata_query_args {
     pdc_metadata_t *data;
+    uint32_t        lease_ms;
 };
 
 struct _pdc_container_query_args {
@@ -86,6 +88,7 @@ struct _pdc_container_query_args {
 
 struct _pdc_buf_map_args {
     int32_t ret;
+    int32_t shm;
 };
 
 struct _pdc_region_lock_args {
@@ -98,6 +101,11 @@ struct _pdc_get_kvtag_args {
     pdc_kvtag_t *kvtag;
 };
 
+struct _pdc_get_obj_stats_args {
+    int           ret;
+    pdc_sketch_t *stats;
+};
+
 struct _pdc_query_result_list {
     uint32_t  ndim;
     int       query_id;
@@ -108,11 +116,21 @@ struct _pdc_query_result_list {
     uint64_t *data_arr_size;
     uint64_t  recv_data_nhits;
 
+    // Latest batch received by a query cursor, its coords and data use the fields above
+    uint64_t batch_nhits;
+    uint64_t batch_data_size;
+
+    // Aggregates received for PDC_QUERY_GET_AGG
+    double agg_sum;
+    double agg_min;
+    double agg_max;
+
     struct _pdc_query_result_list *prev;
     struct _pdc_query_result_list *next;
 };
 
-#define PDC_CLIENT_DATA_SERVER() ((pdc_client_mpi_rank_g / pdc_nclient_per_server_g) % pdc_server_num_g)
+#define PDC_CLIENT_DATA_SERVER()                                                                             \
+    PDC_get_local_server_id(pdc_client_mpi_rank_g, pdc_nclient_per_server_g, pdc_server_num_g)
 
 /***************************************/
 /* Library-private Function Prototypes */
@@ -137,11 +155,26 @@ perr_t PDC_Client_read_server_addr_from_file();
 perr_t PDC_Client_send_name_recv_id(const char *obj_name, uint64_t cont_id, pdcid_t obj_create_prop,
                                     pdcid_t *meta_id);
 
+/**
+ * Client request of the obj ids of a batch of objects, with one request to each metadata server
+ *
+ * \param n_obj [IN]            Number of objects
+ * \param obj_names [IN]        Names of the objects
+ * \param cont_id[IN]           Container ID (obtained from metadata server)
+ * \param obj_create_prop [IN]  ID of the object property shared by all objects
+ * \param meta_ids [OUT]        Medadata ids in the order of the names, 0 for an object not created
+ *
+ * \return Non-negative on success/Negative if any object is not created
+ */
+perr_t PDC_Client_send_names_recv_ids(int n_obj, const char **obj_names, uint64_t cont_id,
+                                      pdcid_t obj_create_prop, pdcid_t *meta_ids);
+
 /**
  * Apply a map from buffer to an object
  *
  * \param local_region_id [IN]  ID of local region
- * \param remote_obj_id [IN]    ID of remote object
+ * \param object_info [IN]      Pointer to the remote object, its region is split across the stripe servers
+ *                              if the object is striped
  * \param ndim [IN]             The offset of local region
  * \param local_dims [IN]       The dimension of local region
  * \param local_offset [IN]     The offset of local region
@@ -153,23 +186,23 @@ perr_t PDC_Client_send_name_recv_id(const char *obj_name, uint64_t cont_id, pdci
  *
  * \return Non-negative on success/Negative on failure
  */
-perr_t PDC_Client_buf_map(pdcid_t local_region_id, pdcid_t remote_obj_id, size_t ndim, uint64_t *local_dims,
-                          uint64_t *local_offset, pdc_var_type_t local_type, void *local_data,
-                          pdc_var_type_t remote_type, struct pdc_region_info *local_region,
+perr_t PDC_Client_buf_map(pdcid_t local_region_id, struct _pdc_obj_info *object_info, size_t ndim,
+                          uint64_t *local_dims, uint64_t *local_offset, pdc_var_type_t local_type,
+                          void *local_data, pdc_var_type_t remote_type, struct pdc_region_info *local_region,
                           struct pdc_region_info *remote_region);
 
 /**
  * Client request for buffer to object unmap
  *
- * \param remote_obj_id [IN]     ID of remote object
+ * \param object_info [IN]       Pointer to the remote object
  * \param remote_reg_id [IN]     ID of remote region
  * \param reginfo [IN]           Remote region information
  * \param data_type [IN]         The data type of remote region
  *
  * \return Non-negative on success/Negative on failure
  */
-perr_t PDC_Client_buf_unmap(pdcid_t remote_obj_id, pdcid_t remote_reg_id, struct pdc_region_info *reginfo,
-                            pdc_var_type_t data_type);
+perr_t PDC_Client_buf_unmap(struct _pdc_obj_info *object_info, pdcid_t remote_reg_id,
+                            struct pdc_region_info *reginfo, pdc_var_type_t data_type);
 
 /**
  * Request of PDC client to get region lock
@@ -555,7 +588,8 @@ perr_t PDC_Client_query_name_read_entire_obj_client_agg_cache_iter(int my_nobj,
  * \param get_op [IN]           *********
  * \param nhits [IN]            *********
  * \param sel [IN]              *********
- * \param data [IN]             *********
+ * \param data [IN/OUT]         pdc_query_agg_t to fill for PDC_QUERY_GET_AGG, its obj_id is the object to
+ *                              aggregate
  *
  * \return Non-negative on success/Negative on failure
  */
@@ -591,6 +625,45 @@ perr_t PDC_Client_get_sel_data(pdcid_t obj_id, pdc_selection_t *sel, void *data)
  */
 hg_return_t PDC_recv_read_coords_data(const struct hg_cb_info *callback_info);
 
+/**
+ * Send a data query to all servers and keep its result on the servers for a cursor
+ *
+ * \param query [IN]            Query to evaluate
+ * \param cursor [IN/OUT]       Cursor to initialize, query_id and nhits are set on return
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_Client_query_cursor_open(pdc_query_t *query, pdc_query_cursor_t *cursor);
+
+/**
+ * Pull the next batch of a query cursor from the servers
+ *
+ * \param cursor [IN/OUT]       Query cursor
+ * \param sel [OUT]             Coordinates of the batch, nhits is 0 when there is no more hit
+ * \param data [OUT]            Data of the batch, ignored if NULL
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_Client_query_cursor_next(pdc_query_cursor_t *cursor, pdc_selection_t *sel, void *data);
+
+/**
+ * Tell all servers to release the result of a query cursor
+ *
+ * \param cursor [IN]           Query cursor
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_Client_query_cursor_close(pdc_query_cursor_t *cursor);
+
+/**
+ * Receive a batch of coordinates, followed by their data if requested, from a server
+ *
+ * \param callback_info [IN]    Mercury callback info
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+hg_return_t PDC_recv_query_cursor_batch(const struct hg_cb_info *callback_info);
+
 /**
  * ********
  *
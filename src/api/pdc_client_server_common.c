@@ -31,9 +31,12 @@
 #include "pdc_analysis_pkg.h"
 #include "pdc_analysis.h"
 #include "pdc_hist_pkg.h"
+#include "pdc_buf_shm.h"
+#include "pdc_placement.h"
 #include "../server/pdc_utlist.h"
 #include "../server/pdc_server.h"
 #include "../server/pdc_server_data.h"
+#include "../server/pdc_server_analysis.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -46,6 +49,7 @@
 #include <ctype.h>
 #include <fcntl.h>
 #include <inttypes.h>
+#include <stddef.h>
 #include <math.h>
 #include <sys/shm.h>
 #include <sys/mman.h>
@@ -305,6 +309,11 @@ hg_proc_pdc_query_xfer_t(hg_proc_t proc, void *data)
         // HG_LOG_ERROR("Proc error");
         return ret;
     }
+    ret = hg_proc_uint64_t(proc, &struct_data->agg_obj_id);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
     if (struct_data->n_constraints > 0) {
         switch (hg_proc_get_op(proc)) {
             case HG_DECODE:
@@ -391,7 +400,7 @@ PDC_get_local_server_id(int my_rank, int n_client_per_server, int n_server)
 
     FUNC_ENTER(NULL);
 
-    ret_value = (my_rank / n_client_per_server) % n_server;
+    ret_value = PDC_placement_get_local_server(my_rank, n_client_per_server, n_server);
 
     FUNC_LEAVE(ret_value);
 }
@@ -510,15 +519,45 @@ PDC_get_hash_by_name(const char *name)
     FUNC_LEAVE(ret_value);
 }
 
+// Table of the reflected CRC-32 polynomial, filled by the first call of PDC_checksum_crc32()
+static uint32_t pdc_crc32_table_g[256];
+static int      pdc_crc32_table_init_g = 0;
+
+uint32_t
+PDC_checksum_crc32(uint32_t crc, const void *buf, size_t size)
+{
+    const unsigned char *ptr = (const unsigned char *)buf;
+    uint32_t             c;
+    size_t               i;
+    int                  j;
+
+    FUNC_ENTER(NULL);
+
+    if (pdc_crc32_table_init_g == 0) {
+        for (i = 0; i < 256; i++) {
+            c = (uint32_t)i;
+            for (j = 0; j < 8; j++)
+                c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+            pdc_crc32_table_g[i] = c;
+        }
+        pdc_crc32_table_init_g = 1;
+    }
+
+    crc = ~crc;
+    for (i = 0; i < size; i++)
+        crc = pdc_crc32_table_g[(crc ^ ptr[i]) & 0xFF] ^ (crc >> 8);
+
+    FUNC_LEAVE(~crc);
+}
+
 uint32_t
 PDC_get_server_by_name(char *name, int n_server)
 {
-    // TODO: need a smart way to deal with server number change
     uint32_t ret_value;
 
     FUNC_ENTER(NULL);
 
-    ret_value = PDC_get_hash_by_name(name) % n_server;
+    ret_value = PDC_placement_get_server(PDC_get_hash_by_name(name), n_server);
 
     FUNC_LEAVE(ret_value);
 }
@@ -538,7 +577,7 @@ PDC_metadata_cmp(pdc_metadata_t *a, pdc_metadata_t *b)
         PGOTO_DONE(ret_value);
 
     // Object name
-    if (a->obj_name[0] != '\0' && b->obj_name[0] != '\0') {
+    if (a->obj_name != NULL && b->obj_name != NULL && a->obj_name[0] != '\0' && b->obj_name[0] != '\0') {
         ret_value = strcmp(a->obj_name, b->obj_name);
     }
     if (ret_value != 0)
@@ -552,7 +591,7 @@ PDC_metadata_cmp(pdc_metadata_t *a, pdc_metadata_t *b)
         PGOTO_DONE(ret_value);
 
     // Application name
-    if (a->app_name[0] != '\0' && b->app_name[0] != '\0') {
+    if (a->app_name != NULL && b->app_name != NULL && a->app_name[0] != '\0' && b->app_name[0] != '\0') {
         ret_value = strcmp(a->app_name, b->app_name);
     }
 
@@ -637,10 +676,10 @@ PDC_metadata_init(pdc_metadata_t *a)
     a->last_modified_time = 0;
     a->ndim               = 0;
 
-    memset(a->app_name, 0, sizeof(char) * ADDR_MAX);
-    memset(a->obj_name, 0, sizeof(char) * ADDR_MAX);
-    memset(a->tags, 0, sizeof(char) * TAG_LEN_MAX);
-    memset(a->data_location, 0, sizeof(char) * ADDR_MAX);
+    a->app_name      = PDC_metadata_intern_str("");
+    a->obj_name      = PDC_metadata_intern_str("");
+    a->tags          = PDC_metadata_intern_str("");
+    a->data_location = PDC_metadata_intern_str("");
     memset(a->dims, 0, sizeof(uint64_t) * DIM_MAX);
 
     a->storage_region_list_head = NULL;
@@ -656,6 +695,273 @@ done:
     FUNC_LEAVE(ret_value);
 }
 
+// Interned metadata strings, each distinct value is stored once per process and counts its owners
+typedef struct pdc_intern_str_t {
+    struct pdc_intern_str_t *next;
+    uint64_t                 refcount;
+    uint32_t                 hash;
+    char                     str[];
+} pdc_intern_str_t;
+
+// The empty string is not counted, a record can drop or overwrite it without releasing it
+static char pdc_intern_empty_g[1] = "";
+
+static pdc_intern_str_t **pdc_intern_bucket_g  = NULL;
+static uint64_t           pdc_intern_nbucket_g = 0;
+static uint64_t           pdc_intern_nstr_g    = 0;
+static uint64_t           pdc_intern_nbytes_g  = 0;
+#ifdef ENABLE_MULTITHREAD
+static hg_thread_mutex_t pdc_intern_mutex_g = HG_THREAD_MUTEX_INITIALIZER;
+#endif
+
+static perr_t
+PDC_intern_resize(uint64_t nbucket)
+{
+    perr_t             ret_value = SUCCEED;
+    pdc_intern_str_t **bucket, *elt, *tmp;
+    uint64_t           i;
+
+    FUNC_ENTER(NULL);
+
+    bucket = (pdc_intern_str_t **)calloc(nbucket, sizeof(pdc_intern_str_t *));
+    if (bucket == NULL)
+        PGOTO_ERROR(FAIL, "==PDC: %s - unable to allocate %" PRIu64 " buckets", __func__, nbucket);
+
+    for (i = 0; i < pdc_intern_nbucket_g; i++) {
+        elt = pdc_intern_bucket_g[i];
+        while (elt != NULL) {
+            tmp                               = elt->next;
+            elt->next                         = bucket[elt->hash & (nbucket - 1)];
+            bucket[elt->hash & (nbucket - 1)] = elt;
+            elt                               = tmp;
+        }
+    }
+
+    free(pdc_intern_bucket_g);
+    pdc_intern_nbytes_g += (nbucket - pdc_intern_nbucket_g) * sizeof(pdc_intern_str_t *);
+    pdc_intern_bucket_g  = bucket;
+    pdc_intern_nbucket_g = nbucket;
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+char *
+PDC_metadata_intern_str(const char *str)
+{
+    char *            ret_value = NULL;
+    pdc_intern_str_t *elt;
+    uint32_t          hash;
+    uint64_t          idx;
+    size_t            len;
+
+    FUNC_ENTER(NULL);
+
+    if (str == NULL || str[0] == '\0') {
+        ret_value = pdc_intern_empty_g;
+        goto done;
+    }
+    hash = PDC_get_hash_by_name(str);
+
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&pdc_intern_mutex_g);
+#endif
+
+    if (pdc_intern_bucket_g == NULL && PDC_intern_resize(PDC_INTERN_NBUCKET_INIT) != SUCCEED)
+        goto unlock;
+
+    idx = hash & (pdc_intern_nbucket_g - 1);
+    for (elt = pdc_intern_bucket_g[idx]; elt != NULL; elt = elt->next) {
+        if (elt->hash == hash && strcmp(elt->str, str) == 0) {
+            elt->refcount++;
+            ret_value = elt->str;
+            goto unlock;
+        }
+    }
+
+    // Keep the chains short, one string per bucket on average
+    if (pdc_intern_nstr_g >= pdc_intern_nbucket_g && PDC_intern_resize(pdc_intern_nbucket_g * 2) != SUCCEED)
+        goto unlock;
+
+    len = strlen(str) + 1;
+    elt = (pdc_intern_str_t *)malloc(sizeof(pdc_intern_str_t) + len);
+    if (elt == NULL)
+        goto unlock;
+    memcpy(elt->str, str, len);
+    idx                      = hash & (pdc_intern_nbucket_g - 1);
+    elt->hash                = hash;
+    elt->refcount            = 1;
+    elt->next                = pdc_intern_bucket_g[idx];
+    pdc_intern_bucket_g[idx] = elt;
+    pdc_intern_nstr_g++;
+    pdc_intern_nbytes_g += sizeof(pdc_intern_str_t) + len;
+    ret_value = elt->str;
+
+unlock:
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&pdc_intern_mutex_g);
+#endif
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+char *
+PDC_metadata_intern_ref(char *str)
+{
+    char *            ret_value = str;
+    pdc_intern_str_t *elt;
+
+    FUNC_ENTER(NULL);
+
+    if (str != NULL && str != pdc_intern_empty_g) {
+        elt = (pdc_intern_str_t *)(str - offsetof(pdc_intern_str_t, str));
+#ifdef ENABLE_MULTITHREAD
+        hg_thread_mutex_lock(&pdc_intern_mutex_g);
+#endif
+        elt->refcount++;
+#ifdef ENABLE_MULTITHREAD
+        hg_thread_mutex_unlock(&pdc_intern_mutex_g);
+#endif
+    }
+
+    FUNC_LEAVE(ret_value);
+}
+
+void
+PDC_metadata_intern_release(char *str)
+{
+    pdc_intern_str_t *elt, **prev;
+
+    FUNC_ENTER(NULL);
+
+    if (str == NULL || str == pdc_intern_empty_g)
+        goto done;
+    elt = (pdc_intern_str_t *)(str - offsetof(pdc_intern_str_t, str));
+
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&pdc_intern_mutex_g);
+#endif
+    if (--elt->refcount == 0) {
+        prev = &pdc_intern_bucket_g[elt->hash & (pdc_intern_nbucket_g - 1)];
+        while (*prev != elt)
+            prev = &(*prev)->next;
+        *prev = elt->next;
+        pdc_intern_nstr_g--;
+        pdc_intern_nbytes_g -= sizeof(pdc_intern_str_t) + strlen(elt->str) + 1;
+        free(elt);
+    }
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&pdc_intern_mutex_g);
+#endif
+
+done:
+    FUNC_LEAVE_VOID;
+}
+
+void
+PDC_metadata_release_strs(pdc_metadata_t *a)
+{
+    FUNC_ENTER(NULL);
+
+    PDC_metadata_intern_release(a->obj_name);
+    PDC_metadata_intern_release(a->app_name);
+    PDC_metadata_intern_release(a->tags);
+    PDC_metadata_intern_release(a->data_location);
+    a->obj_name      = NULL;
+    a->app_name      = NULL;
+    a->tags          = NULL;
+    a->data_location = NULL;
+
+    FUNC_LEAVE_VOID;
+}
+
+void
+PDC_metadata_intern_stats(uint64_t *nstr, uint64_t *nbytes)
+{
+    FUNC_ENTER(NULL);
+
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&pdc_intern_mutex_g);
+#endif
+    if (nstr != NULL)
+        *nstr = pdc_intern_nstr_g;
+    if (nbytes != NULL)
+        *nbytes = pdc_intern_nbytes_g;
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&pdc_intern_mutex_g);
+#endif
+
+    FUNC_LEAVE_VOID;
+}
+
+// Serialized layout: the struct itself, then obj_name, app_name, tags and data_location, each with its '\0'
+size_t
+PDC_metadata_serialize_size(pdc_metadata_t *a)
+{
+    size_t ret_value = sizeof(pdc_metadata_t);
+
+    FUNC_ENTER(NULL);
+
+    ret_value += (a->obj_name == NULL ? 0 : strlen(a->obj_name)) + 1;
+    ret_value += (a->app_name == NULL ? 0 : strlen(a->app_name)) + 1;
+    ret_value += (a->tags == NULL ? 0 : strlen(a->tags)) + 1;
+    ret_value += (a->data_location == NULL ? 0 : strlen(a->data_location)) + 1;
+
+    FUNC_LEAVE(ret_value);
+}
+
+static size_t
+PDC_metadata_serialize_str(const char *str, char *buf)
+{
+    size_t len;
+
+    if (str == NULL)
+        str = "";
+    len = strlen(str) + 1;
+    memcpy(buf, str, len);
+
+    return len;
+}
+
+size_t
+PDC_metadata_serialize(pdc_metadata_t *a, void *buf)
+{
+    size_t ret_value = sizeof(pdc_metadata_t);
+    char * ptr       = (char *)buf;
+
+    FUNC_ENTER(NULL);
+
+    memcpy(ptr, a, sizeof(pdc_metadata_t));
+    ret_value += PDC_metadata_serialize_str(a->obj_name, ptr + ret_value);
+    ret_value += PDC_metadata_serialize_str(a->app_name, ptr + ret_value);
+    ret_value += PDC_metadata_serialize_str(a->tags, ptr + ret_value);
+    ret_value += PDC_metadata_serialize_str(a->data_location, ptr + ret_value);
+
+    FUNC_LEAVE(ret_value);
+}
+
+size_t
+PDC_metadata_deserialize(void *buf, pdc_metadata_t *a)
+{
+    size_t ret_value = sizeof(pdc_metadata_t);
+    char * ptr       = (char *)buf;
+
+    FUNC_ENTER(NULL);
+
+    memcpy(a, ptr, sizeof(pdc_metadata_t));
+    a->obj_name = PDC_metadata_intern_str(ptr + ret_value);
+    ret_value += strlen(ptr + ret_value) + 1;
+    a->app_name = PDC_metadata_intern_str(ptr + ret_value);
+    ret_value += strlen(ptr + ret_value) + 1;
+    a->tags = PDC_metadata_intern_str(ptr + ret_value);
+    ret_value += strlen(ptr + ret_value) + 1;
+    a->data_location = PDC_metadata_intern_str(ptr + ret_value);
+    ret_value += strlen(ptr + ret_value) + 1;
+
+    FUNC_LEAVE(ret_value);
+}
+
 perr_t
 PDC_init_region_list(region_list_t *a)
 {
@@ -1149,29 +1455,35 @@ PDC_metadata_t_to_transfer_t(pdc_metadata_t *meta, pdc_metadata_transfer_t *tran
     if (NULL == meta || NULL == transfer)
         PGOTO_ERROR(FAIL, "PDC_metadata_t_to_transfer_t(): NULL input!");
 
-    transfer->user_id         = meta->user_id;
-    transfer->app_name        = meta->app_name;
-    transfer->obj_name        = meta->obj_name;
-    transfer->time_step       = meta->time_step;
-    transfer->data_type       = meta->data_type;
-    transfer->obj_id          = meta->obj_id;
-    transfer->cont_id         = meta->cont_id;
-    transfer->ndim            = meta->ndim;
-    transfer->dims0           = meta->dims[0];
-    transfer->dims1           = meta->dims[1];
-    transfer->dims2           = meta->dims[2];
-    transfer->dims3           = meta->dims[3];
-    transfer->tags            = meta->tags;
-    transfer->data_location   = meta->data_location;
-    transfer->current_state   = meta->transform_state;
-    transfer->t_storage_order = meta->current_state.storage_order;
-    transfer->t_dtype         = meta->current_state.dtype;
-    transfer->t_ndim          = meta->current_state.ndim;
-    transfer->t_dims0         = meta->current_state.dims[0];
-    transfer->t_dims1         = meta->current_state.dims[1];
-    transfer->t_dims2         = meta->current_state.dims[2];
-    transfer->t_dims3         = meta->current_state.dims[3];
-    transfer->t_meta_index    = meta->current_state.meta_index;
+    transfer->user_id          = meta->user_id;
+    transfer->app_name         = meta->app_name;
+    transfer->obj_name         = meta->obj_name;
+    transfer->time_step        = meta->time_step;
+    transfer->data_type        = meta->data_type;
+    transfer->obj_id           = meta->obj_id;
+    transfer->cont_id          = meta->cont_id;
+    transfer->ndim             = meta->ndim;
+    transfer->dims0            = meta->dims[0];
+    transfer->dims1            = meta->dims[1];
+    transfer->dims2            = meta->dims[2];
+    transfer->dims3            = meta->dims[3];
+    transfer->stripe_size      = meta->stripe_size;
+    transfer->stripe_count     = meta->stripe_count;
+    transfer->compress         = meta->compress;
+    transfer->compress_level   = meta->compress_level;
+    transfer->error_bound_mode = meta->error_bound_mode;
+    transfer->error_bound      = meta->error_bound;
+    transfer->tags             = meta->tags;
+    transfer->data_location    = meta->data_location;
+    transfer->current_state    = meta->transform_state;
+    transfer->t_storage_order  = meta->current_state.storage_order;
+    transfer->t_dtype          = meta->current_state.dtype;
+    transfer->t_ndim           = meta->current_state.ndim;
+    transfer->t_dims0          = meta->current_state.dims[0];
+    transfer->t_dims1          = meta->current_state.dims[1];
+    transfer->t_dims2          = meta->current_state.dims[2];
+    transfer->t_dims3          = meta->current_state.dims[3];
+    transfer->t_meta_index     = meta->current_state.meta_index;
 
 done:
     fflush(stdout);
@@ -1199,10 +1511,21 @@ PDC_transfer_t_to_metadata_t(pdc_metadata_transfer_t *transfer, pdc_metadata_t *
     meta->dims[2]   = transfer->dims2;
     meta->dims[3]   = transfer->dims3;
 
-    strcpy(meta->app_name, transfer->app_name);
-    strcpy(meta->obj_name, transfer->obj_name);
-    strcpy(meta->tags, transfer->tags);
-    strcpy(meta->data_location, transfer->data_location);
+    meta->stripe_size      = transfer->stripe_size;
+    meta->stripe_count     = transfer->stripe_count;
+    meta->compress         = transfer->compress;
+    meta->compress_level   = transfer->compress_level;
+    meta->error_bound_mode = transfer->error_bound_mode;
+    meta->error_bound      = transfer->error_bound;
+
+    // The strings of meta are replaced, it has to be initialized with PDC_metadata_init()
+    PDC_metadata_release_strs(meta);
+    meta->app_name      = PDC_metadata_intern_str(transfer->app_name);
+    meta->obj_name      = PDC_metadata_intern_str(transfer->obj_name);
+    meta->tags          = PDC_metadata_intern_str(transfer->tags);
+    meta->data_location = PDC_metadata_intern_str(transfer->data_location);
+    if (meta->app_name == NULL || meta->obj_name == NULL || meta->tags == NULL || meta->data_location == NULL)
+        PGOTO_ERROR(FAIL, "PDC_transfer_t_to_metadata_t(): unable to intern metadata strings!");
 
     if ((meta->transform_state = transfer->current_state) == 0) {
         memset(&meta->current_state, 0, sizeof(struct _pdc_transform_state));
@@ -1243,11 +1566,23 @@ PDC_insert_metadata_to_hash_table(gen_obj_id_in_t *in   ATTRIBUTE(unused),
     return SUCCEED;
 }
 perr_t
+PDC_Server_create_metadata_batch(metadata_bulk_create_in_t *in ATTRIBUTE(unused), void *buf ATTRIBUTE(unused),
+                                 uint64_t buf_size ATTRIBUTE(unused),
+                                 metadata_bulk_create_out_t *out ATTRIBUTE(unused))
+{
+    return SUCCEED;
+}
+perr_t
 PDC_Server_search_with_name_hash(const char *obj_name ATTRIBUTE(unused), uint32_t hash_key ATTRIBUTE(unused),
                                  pdc_metadata_t **out ATTRIBUTE(unused))
 {
     return SUCCEED;
 }
+uint32_t
+PDC_Server_get_metadata_lease(pdc_metadata_t *meta ATTRIBUTE(unused))
+{
+    return 0;
+}
 perr_t
 PDC_Server_search_with_name_timestep(const char *obj_name ATTRIBUTE(unused),
                                      uint32_t hash_key ATTRIBUTE(unused), uint32_t ts ATTRIBUTE(unused),
@@ -1298,6 +1633,11 @@ PDC_Server_get_kvtag(metadata_get_kvtag_in_t *in   ATTRIBUTE(unused),
     return SUCCEED;
 }
 perr_t
+PDC_Server_get_obj_stats(obj_get_stats_in_t *in ATTRIBUTE(unused), obj_get_stats_out_t *out ATTRIBUTE(unused))
+{
+    return SUCCEED;
+}
+perr_t
 PDC_Meta_Server_buf_unmap(buf_unmap_in_t *in ATTRIBUTE(unused), hg_handle_t *handle ATTRIBUTE(unused))
 {
     return SUCCEED;
@@ -1519,6 +1859,16 @@ PDC_Server_recv_read_sel_obj_data(const struct hg_cb_info *callback_info ATTRIBU
 {
     return HG_SUCCESS;
 }
+perr_t
+PDC_Server_query_cache_invalidate(uint64_t obj_id ATTRIBUTE(unused))
+{
+    return SUCCEED;
+}
+perr_t
+PDC_Server_metadata_log_respond(hg_handle_t handle, void *out, size_t out_size ATTRIBUTE(unused))
+{
+    return HG_Respond(handle, NULL, NULL, out) == HG_SUCCESS ? SUCCEED : FAIL;
+}
 hg_return_t
 PDC_recv_query_metadata_bulk(const struct hg_cb_info *callback_info ATTRIBUTE(unused))
 {
@@ -1613,6 +1963,11 @@ PDC_Server_recv_get_sel_data(const struct hg_cb_info *callback_info ATTRIBUTE(un
 {
     return HG_SUCCESS;
 }
+hg_return_t
+PDC_Server_recv_query_cursor(const struct hg_cb_info *callback_info ATTRIBUTE(unused))
+{
+    return HG_SUCCESS;
+}
 #else
 hg_return_t
 PDC_Client_work_done_cb(const struct hg_cb_info *callback_info ATTRIBUTE(unused))
@@ -1645,6 +2000,11 @@ PDC_recv_read_coords_data(const struct hg_cb_info *callback_info ATTRIBUTE(unuse
 {
     return HG_SUCCESS;
 }
+hg_return_t
+PDC_recv_query_cursor_batch(const struct hg_cb_info *callback_info ATTRIBUTE(unused))
+{
+    return HG_SUCCESS;
+}
 
 #endif
 
@@ -1673,7 +2033,7 @@ HG_TEST_RPC_CB(gen_obj_id, handle)
     // Insert to hash table
     ret_value = PDC_insert_metadata_to_hash_table(&in, &out);
 
-    HG_Respond(handle, NULL, NULL, &out);
+    PDC_Server_metadata_log_respond(handle, &out, sizeof(out));
 
     HG_Free_input(handle, &in);
     HG_Destroy(handle);
@@ -1681,6 +2041,91 @@ HG_TEST_RPC_CB(gen_obj_id, handle)
     FUNC_LEAVE(ret_value);
 }
 
+// Arguments of the bulk pull of a metadata_bulk_create request
+struct metadata_bulk_create_args_t {
+    hg_handle_t               handle;
+    metadata_bulk_create_in_t in;
+    hg_size_t                 nbytes;
+};
+
+static hg_return_t
+metadata_bulk_create_bulk_cb(const struct hg_cb_info *hg_cb_info)
+{
+    hg_return_t                         ret_value         = HG_SUCCESS;
+    hg_bulk_t                           local_bulk_handle = hg_cb_info->info.bulk.local_handle;
+    struct metadata_bulk_create_args_t *bulk_args;
+    metadata_bulk_create_out_t          out;
+    void *                              buf = NULL;
+
+    FUNC_ENTER(NULL);
+
+    bulk_args        = (struct metadata_bulk_create_args_t *)hg_cb_info->arg;
+    out.obj_id_start = 0;
+    out.n_created    = 0;
+    if (hg_cb_info->ret != HG_SUCCESS) {
+        printf("==PDC_SERVER: %s - error with bulk pull of %u names\n", __func__, bulk_args->in.n_obj);
+        ret_value = hg_cb_info->ret;
+    }
+    else {
+        HG_Bulk_access(local_bulk_handle, 0, bulk_args->nbytes, HG_BULK_READWRITE, 1, &buf, NULL, NULL);
+        PDC_Server_create_metadata_batch(&bulk_args->in, buf, bulk_args->nbytes, &out);
+    }
+
+    PDC_Server_metadata_log_respond(bulk_args->handle, &out, sizeof(out));
+
+    HG_Bulk_free(local_bulk_handle);
+    HG_Free_input(bulk_args->handle, &bulk_args->in);
+    HG_Destroy(bulk_args->handle);
+    free(bulk_args);
+
+    FUNC_LEAVE(ret_value);
+}
+
+/* static hg_return_t */
+/* metadata_bulk_create_cb(hg_handle_t handle) */
+HG_TEST_RPC_CB(metadata_bulk_create, handle)
+{
+    hg_return_t                         ret_value         = HG_SUCCESS;
+    const struct hg_info *              hg_info           = NULL;
+    struct metadata_bulk_create_args_t *bulk_args         = NULL;
+    hg_bulk_t                           local_bulk_handle = HG_BULK_NULL;
+    metadata_bulk_create_out_t          out;
+
+    FUNC_ENTER(NULL);
+
+    bulk_args = (struct metadata_bulk_create_args_t *)malloc(sizeof(struct metadata_bulk_create_args_t));
+    bulk_args->handle = handle;
+
+    ret_value = HG_Get_input(handle, &bulk_args->in);
+    if (ret_value != HG_SUCCESS) {
+        free(bulk_args);
+        PGOTO_ERROR(ret_value, "Could not get input");
+    }
+    bulk_args->nbytes = HG_Bulk_get_size(bulk_args->in.bulk_handle);
+
+    hg_info = HG_Get_info(handle);
+    HG_Bulk_create(hg_info->hg_class, 1, NULL, &bulk_args->nbytes, HG_BULK_READWRITE, &local_bulk_handle);
+
+    // Pull the names, the objects are created and the client is answered in the bulk callback
+    ret_value = HG_Bulk_transfer(hg_info->context, metadata_bulk_create_bulk_cb, bulk_args, HG_BULK_PULL,
+                                 hg_info->addr, bulk_args->in.bulk_handle, 0, local_bulk_handle, 0,
+                                 bulk_args->nbytes, HG_OP_ID_IGNORE);
+    if (ret_value != HG_SUCCESS) {
+        out.obj_id_start = 0;
+        out.n_created    = 0;
+        HG_Respond(handle, NULL, NULL, &out);
+        HG_Bulk_free(local_bulk_handle);
+        HG_Free_input(handle, &bulk_args->in);
+        HG_Destroy(handle);
+        free(bulk_args);
+        PGOTO_ERROR(ret_value, "Could not read bulk data");
+    }
+
+done:
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
+
 /* static hg_return_t */
 /* gen_cont_id_cb(hg_handle_t handle) */
 HG_TEST_RPC_CB(gen_cont_id, handle)
@@ -1700,7 +2145,7 @@ HG_TEST_RPC_CB(gen_cont_id, handle)
     if (ret_value != SUCCEED)
         PGOTO_ERROR(ret_value, "==PDC_SERVER: error with container object creation");
 
-    HG_Respond(handle, NULL, NULL, &out);
+    PDC_Server_metadata_log_respond(handle, &out, sizeof(out));
     HG_Free_input(handle, &in);
     HG_Destroy(handle);
 
@@ -1833,8 +2278,10 @@ HG_TEST_RPC_CB(metadata_query, handle)
     // Convert for transfer
     if (query_result != NULL) {
         PDC_metadata_t_to_transfer_t(query_result, &out.ret);
+        out.lease_ms = PDC_Server_get_metadata_lease(query_result);
     }
     else {
+        out.lease_ms          = 0;
         out.ret.user_id       = -1;
         out.ret.data_type     = -1;
         out.ret.obj_id        = 0;
@@ -1869,7 +2316,7 @@ HG_TEST_RPC_CB(metadata_delete_by_id, handle)
 
     PDC_Server_delete_metadata_by_id(&in, &out);
 
-    HG_Respond(handle, NULL, NULL, &out);
+    PDC_Server_metadata_log_respond(handle, &out, sizeof(out));
 
     HG_Free_input(handle, &in);
     HG_Destroy(handle);
@@ -1892,7 +2339,7 @@ HG_TEST_RPC_CB(metadata_delete, handle)
 
     PDC_delete_metadata_from_hash_table(&in, &out);
 
-    HG_Respond(handle, NULL, NULL, &out);
+    PDC_Server_metadata_log_respond(handle, &out, sizeof(out));
 
     HG_Free_input(handle, &in);
     HG_Destroy(handle);
@@ -1916,7 +2363,7 @@ HG_TEST_RPC_CB(metadata_add_tag, handle)
 
     PDC_Server_add_tag_metadata(&in, &out);
 
-    HG_Respond(handle, NULL, NULL, &out);
+    PDC_Server_metadata_log_respond(handle, &out, sizeof(out));
 
     HG_Free_input(handle, &in);
     HG_Destroy(handle);
@@ -1946,6 +2393,28 @@ HG_TEST_RPC_CB(metadata_get_kvtag, handle)
     FUNC_LEAVE(ret_value);
 }
 
+/* obj_get_stats_cb(hg_handle_t handle) */
+HG_TEST_RPC_CB(obj_get_stats, handle)
+{
+    hg_return_t         ret_value = HG_SUCCESS;
+    obj_get_stats_in_t  in;
+    obj_get_stats_out_t out;
+
+    FUNC_ENTER(NULL);
+
+    memset(&out, 0, sizeof(obj_get_stats_out_t));
+    HG_Get_input(handle, &in);
+    PDC_Server_get_obj_stats(&in, &out);
+    ret_value = HG_Respond(handle, NULL, NULL, &out);
+    // The output is encoded by HG_Respond, the serialized sketch is not needed anymore
+    free(out.sketch);
+
+    HG_Free_input(handle, &in);
+    HG_Destroy(handle);
+
+    FUNC_LEAVE(ret_value);
+}
+
 /* static hg_return_t */
 // metadata_del_kvtag_cb(hg_handle_t handle)
 HG_TEST_RPC_CB(metadata_del_kvtag, handle)
@@ -1958,7 +2427,8 @@ HG_TEST_RPC_CB(metadata_del_kvtag, handle)
 
     HG_Get_input(handle, &in);
     PDC_Server_del_kvtag(&in, &out);
-    ret_value = HG_Respond(handle, NULL, NULL, &out);
+    if (PDC_Server_metadata_log_respond(handle, &out, sizeof(out)) != SUCCEED)
+        ret_value = HG_OTHER_ERROR;
 
     HG_Free_input(handle, &in);
     HG_Destroy(handle);
@@ -1978,7 +2448,8 @@ HG_TEST_RPC_CB(metadata_add_kvtag, handle)
 
     HG_Get_input(handle, &in);
     PDC_Server_add_kvtag(&in, &out);
-    ret_value = HG_Respond(handle, NULL, NULL, &out);
+    if (PDC_Server_metadata_log_respond(handle, &out, sizeof(out)) != SUCCEED)
+        ret_value = HG_OTHER_ERROR;
 
     HG_Free_input(handle, &in);
     HG_Destroy(handle);
@@ -2061,7 +2532,7 @@ HG_TEST_RPC_CB(metadata_update, handle)
 
     PDC_Server_update_metadata(&in, &out);
 
-    HG_Respond(handle, NULL, NULL, &out);
+    PDC_Server_metadata_log_respond(handle, &out, sizeof(out));
 
     HG_Free_input(handle, &in);
     HG_Destroy(handle);
@@ -2261,6 +2732,8 @@ transform_and_region_release_bulk_transfer_cb(const struct hg_cb_info *hg_cb_inf
     int                                             use_transform_size = 0;
     size_t                                          unit               = 1;
     int64_t                                         transform_size, expected_size;
+    size_t                                          pipeline_size;
+    pdc_var_type_t                                  pipeline_type;
     uint64_t *                                      dims = NULL;
     pdc_var_type_t                                  destType;
     struct _pdc_region_transform_ftn_info **        registry = NULL;
@@ -2298,7 +2771,6 @@ transform_and_region_release_bulk_transfer_cb(const struct hg_cb_info *hg_cb_inf
         type_extent = 1;
 
     out.ret = 1;
-    HG_Respond(bulk_args->handle, NULL, NULL, &out);
 
     ndim          = bulk_args->remote_region.ndim;
     expected_size = bulk_args->remote_region.count_0;
@@ -2346,7 +2818,29 @@ transform_and_region_release_bulk_transfer_cb(const struct hg_cb_info *hg_cb_inf
          */
         if ((data_buf = PDC_Server_get_region_buf_ptr(bulk_args->in.obj_id, bulk_args->in.region)) != NULL) {
             registered_count = PDC_get_transforms(&registry);
-            if (use_transform_size) {
+            if ((registered_count > transform_id) && (registry[transform_id]->pipeline != NULL)) {
+                // The stages run as one pass over the received data, straight into the region buffer.
+                // The buffer keeps the shape and type of the region, so the output has to fill it exactly,
+                // as bytes or as values of the destination type
+                pipeline_size = (size_t)expected_size;
+                if (PDC_transform_pipeline_run(registry[transform_id]->pipeline, buf,
+                                               use_transform_size ? transform_size : expected_size,
+                                               use_transform_size ? PDC_INT8 : bulk_args->in.data_type,
+                                               &data_buf, &pipeline_size, &pipeline_type) != SUCCEED) {
+                    printf("==PDC_SERVER: transform pipeline %s failed\n",
+                           registry[transform_id]->pipeline->spec);
+                    out.ret = 0;
+                }
+                else if (pipeline_size != (size_t)expected_size ||
+                         (pipeline_type != PDC_INT8 && pipeline_type != destType)) {
+                    printf("==PDC_SERVER: transform pipeline %s returned %zu bytes of type %d, the region "
+                           "holds %" PRId64 " bytes of type %d\n",
+                           registry[transform_id]->pipeline->spec, pipeline_size, pipeline_type,
+                           expected_size, destType);
+                    out.ret = 0;
+                }
+            }
+            else if (use_transform_size) {
                 bulk_args->in.data_type = PDC_INT8;
                 dims                    = (uint64_t *)&transform_size;
                 ndim                    = 1;
@@ -2354,8 +2848,11 @@ transform_and_region_release_bulk_transfer_cb(const struct hg_cb_info *hg_cb_inf
             else {
                 /* Prepare for the transform */
                 dims = (uint64_t *)calloc(ndim, sizeof(uint64_t));
-                if (dims == NULL)
+                if (dims == NULL) {
+                    out.ret = 0;
+                    HG_Respond(bulk_args->handle, NULL, NULL, &out);
                     PGOTO_ERROR(HG_OTHER_ERROR, "TRANSFORM memory allocation failed");
+                }
                 dims[0] = bulk_args->remote_region.count_0 / type_extent;
                 if (ndim > 1)
                     dims[1] = bulk_args->remote_region.count_1 / type_extent;
@@ -2364,7 +2861,8 @@ transform_and_region_release_bulk_transfer_cb(const struct hg_cb_info *hg_cb_inf
                 if (ndim > 3)
                     dims[3] = bulk_args->remote_region.count_3 / type_extent;
             }
-            if ((registered_count >= transform_id) && (registry != NULL)) {
+            if ((registered_count > transform_id) && (registry != NULL) &&
+                (registry[transform_id]->pipeline == NULL)) {
                 size_t (*this_transform)(void *, pdc_var_type_t, int, uint64_t *, void **, pdc_var_type_t) =
                     registry[transform_id]->ftnPtr;
                 size_t result = this_transform(buf, bulk_args->in.data_type, ndim, dims, &data_buf,
@@ -2377,7 +2875,11 @@ transform_and_region_release_bulk_transfer_cb(const struct hg_cb_info *hg_cb_inf
                 use_transform_size = 0;
             }
         }
+        else
+            out.ret = 0;
     }
+    // The client learns whether the transform of its data succeeded
+    HG_Respond(bulk_args->handle, NULL, NULL, &out);
 
 #ifdef ENABLE_MULTITHREAD
     bulk_args->work.func = pdc_region_write_out_progress;
@@ -2499,10 +3001,11 @@ analysis_and_region_release_bulk_transfer_cb(const struct hg_cb_info *hg_cb_info
         struct _pdc_iterator_cbs_t iter_cbs = {PDCobj_data_getSliceCount, PDCobj_data_getNextBlock};
         int                        analysis_meta_index = bulk_args->in.analysis_meta_index;
         int                        registered_count    = PDC_get_analysis_registry(&registry);
-        if ((registered_count >= analysis_meta_index) && (registry != NULL)) {
-            int (*analysis_ftn)(pdcid_t iterIn, pdcid_t iterOut, struct _pdc_iterator_cbs_t * _cbs) =
-                registry[analysis_meta_index]->ftnPtr;
-            int result = analysis_ftn(bulk_args->in.input_iter, bulk_args->in.output_iter, &iter_cbs);
+        if ((registered_count > analysis_meta_index) && (registry != NULL)) {
+            // Split across threads if the function allows it and the input iterator holds enough blocks
+            int result = PDC_Server_run_analysis(registry[analysis_meta_index]->ftnPtr,
+                                                 bulk_args->in.input_iter, bulk_args->in.output_iter,
+                                                 &iter_cbs, registry[analysis_meta_index]->flags);
             printf("==PDC_SERVER: Analysis returned %d\n", result);
             puts("----------------\n");
         }
@@ -2798,6 +3301,28 @@ region_release_update_bulk_transfer_cb(const struct hg_cb_info *hg_cb_info)
     FUNC_LEAVE(hg_ret);
 }
 
+/*
+ * Finish a buf map release whose data was copied through the shared memory of a client on this node, the
+ * same way as when the bulk transfer of the data completes
+ *
+ * \param  callback[IN]         Completion callback of the bulk transfer
+ * \param  bulk_args[IN]        Arguments of the callback
+ *
+ * \return HG_SUCCESS on success/Error code of the callback on failure
+ */
+static hg_return_t
+buf_map_release_shm_done(hg_cb_t callback, struct buf_map_release_bulk_args *bulk_args)
+{
+    struct hg_cb_info cb_info;
+
+    memset(&cb_info, 0, sizeof(struct hg_cb_info));
+    cb_info.arg  = bulk_args;
+    cb_info.ret  = HG_SUCCESS;
+    cb_info.type = HG_CB_BULK;
+
+    return callback(&cb_info);
+}
+
 // region_release_cb()
 HG_TEST_RPC_CB(region_release, handle)
 {
@@ -2822,6 +3347,7 @@ HG_TEST_RPC_CB(region_release, handle)
     hg_uint32_t /*k, m, */               remote_count;
     void **                              data_ptrs_to = NULL;
     size_t *                             data_size_to = NULL;
+    hg_size_t                            shm_size     = 0;
     // size_t                               type_size    = 0;
     // size_t                               dims[4]      = {0, 0, 0, 0};
 #if PDC_TIMING == 1
@@ -3058,6 +3584,15 @@ HG_TEST_RPC_CB(region_release, handle)
                                                         "handle) local and remote bulk size does not match");
                         }
 
+                        if (eltt2->local_shm_buf != NULL && size <= eltt2->local_shm_size) {
+                            // The client is on this node, it copies the data out of its shared memory
+                            memcpy(eltt2->local_shm_buf, data_buf, size);
+                            PDC_BUF_SHM_HDR(eltt2->local_shm_buf)->filled = 1;
+                            HG_Bulk_free(remote_bulk_handle);
+                            buf_map_release_shm_done(obj_map_region_release_bulk_transfer_cb,
+                                                     obj_map_bulk_args);
+                            break;
+                        }
                         hg_ret = HG_Bulk_transfer(hg_info->context, obj_map_region_release_bulk_transfer_cb,
                                                   obj_map_bulk_args, HG_BULK_PUSH, eltt2->local_addr,
                                                   eltt2->local_bulk_handle, 0, remote_bulk_handle, 0, size,
@@ -3186,13 +3721,17 @@ HG_TEST_RPC_CB(region_release, handle)
                         /*     } */
                         /* } */
                         /* Create a new block handle to read the data */
-                        hg_ret =
-                            HG_Bulk_create(hg_info->hg_class, remote_count, data_ptrs_to,
-                                           (hg_size_t *)data_size_to, HG_BULK_READWRITE, &remote_bulk_handle);
-                        if (hg_ret != HG_SUCCESS) {
-                            error = 1;
-                            PGOTO_ERROR(hg_ret, "==PDC SERVER ERROR: Could not create bulk data handle");
+                        // The data of a client on this node is already in its shared memory, nothing to pull
+                        if (eltt->local_shm_buf == NULL) {
+                            hg_ret = HG_Bulk_create(hg_info->hg_class, remote_count, data_ptrs_to,
+                                                    (hg_size_t *)data_size_to, HG_BULK_READWRITE,
+                                                    &remote_bulk_handle);
+                            if (hg_ret != HG_SUCCESS) {
+                                error = 1;
+                                PGOTO_ERROR(hg_ret, "==PDC SERVER ERROR: Could not create bulk data handle");
+                            }
                         }
+                        shm_size = *data_size_to;
                         free(data_ptrs_to);
                         free(data_size_to);
 
@@ -3217,6 +3756,19 @@ HG_TEST_RPC_CB(region_release, handle)
                         hg_thread_mutex_init(&(buf_map_bulk_args->work_mutex));
                         hg_thread_cond_init(&(buf_map_bulk_args->work_cond));
 #endif
+                        if (eltt->local_shm_buf != NULL) {
+                            size = HG_Bulk_get_size(eltt->local_bulk_handle);
+                            if (size != shm_size || size > eltt->local_shm_size) {
+                                error = 1;
+                                free(buf_map_bulk_args);
+                                PGOTO_ERROR(HG_OTHER_ERROR, "==PDC SERVER: buf map size %" PRIu64 " != %" PRIu64,
+                                            (uint64_t)size, (uint64_t)shm_size);
+                            }
+                            memcpy(data_buf, eltt->local_shm_buf, size);
+                            buf_map_release_shm_done(buf_map_region_release_bulk_transfer_cb,
+                                                     buf_map_bulk_args);
+                            break;
+                        }
                         /* Pull bulk data */
                         size  = HG_Bulk_get_size(eltt->local_bulk_handle);
                         size2 = HG_Bulk_get_size(remote_bulk_handle);
@@ -4377,6 +4929,7 @@ HG_TEST_RPC_CB(buf_map, handle)
 #endif
     // Decode input
     HG_Get_input(handle, &in);
+    out.shm = 0;
 
     // Use region dimension to allocate memory, rather than object dimension (different from client side)
     ndim = in.remote_region_unit.ndim;
@@ -4417,6 +4970,7 @@ HG_TEST_RPC_CB(buf_map, handle)
     }
     else {
         out.ret = 1;
+        out.shm = new_buf_map_ptr->local_shm_buf != NULL;
         HG_Respond(handle, NULL, NULL, &out);
         ret = PDC_Meta_Server_buf_map(&in, new_buf_map_ptr, &handle);
         if (ret != SUCCEED)
@@ -4445,6 +4999,8 @@ HG_TEST_RPC_CB(query_partial, handle)
     void **                       buf_ptrs;
     size_t *                      buf_sizes;
     uint32_t *                    n_meta_ptr, n_buf;
+    char *                        serial_meta_buf;
+    size_t                        serial_size;
     metadata_query_transfer_in_t  in;
     metadata_query_transfer_out_t out;
 
@@ -4467,12 +5023,13 @@ HG_TEST_RPC_CB(query_partial, handle)
         PGOTO_DONE(ret_value);
     }
 
-    n_buf = *n_meta_ptr;
+    n_buf = 1;
 
-    buf_sizes = (size_t *)malloc((n_buf + 1) * sizeof(size_t));
-    for (i = 0; i < *n_meta_ptr; i++) {
-        buf_sizes[i] = sizeof(pdc_metadata_t);
-    }
+    // The name strings are pointers, serialize all metadata into one buffer
+    buf_sizes    = (size_t *)malloc((n_buf + 1) * sizeof(size_t));
+    buf_sizes[0] = 0;
+    for (i = 0; i < *n_meta_ptr; i++)
+        buf_sizes[0] += PDC_metadata_serialize_size((pdc_metadata_t *)buf_ptrs[i]);
     // TODO: free buf_sizes
 
     // Note: it seems Mercury bulk transfer has issues if the total transfer size is less
@@ -4491,16 +5048,11 @@ HG_TEST_RPC_CB(query_partial, handle)
 
     // Fix when Mercury output in HG_Respond gets too large and cannot be transfered
     // hg_set_output(): Output size exceeds NA expected message size
-    pdc_metadata_t *large_serial_meta_buf;
-    if (*n_meta_ptr > 80) {
-        large_serial_meta_buf = (pdc_metadata_t *)malloc(sizeof(pdc_metadata_t) * (*n_meta_ptr));
-        for (i = 0; i < *n_meta_ptr; i++) {
-            memcpy(&large_serial_meta_buf[i], buf_ptrs[i], sizeof(pdc_metadata_t));
-        }
-        buf_ptrs[0]  = large_serial_meta_buf;
-        buf_sizes[0] = sizeof(pdc_metadata_t) * (*n_meta_ptr);
-        n_buf        = 1;
-    }
+    serial_meta_buf = (char *)malloc(buf_sizes[0]);
+    serial_size     = 0;
+    for (i = 0; i < *n_meta_ptr; i++)
+        serial_size += PDC_metadata_serialize((pdc_metadata_t *)buf_ptrs[i], serial_meta_buf + serial_size);
+    buf_ptrs[0] = serial_meta_buf;
 
     // Create bulk handle
     hg_ret =
@@ -4625,7 +5177,7 @@ update_storage_meta_bulk_cb(const struct hg_cb_info *hg_cb_info)
 done:
     fflush(stdout);
     HG_Bulk_free(local_bulk_handle);
-    HG_Respond(bulk_args->handle, NULL, NULL, &out_struct);
+    PDC_Server_metadata_log_respond(bulk_args->handle, &out_struct, sizeof(out_struct));
     HG_Destroy(bulk_args->handle);
     free(bulk_args);
 
@@ -4850,17 +5402,25 @@ HG_TEST_RPC_CB(update_region_loc, handle)
     HG_Get_input(handle, &in);
 
     region_list_t *input_region = (region_list_t *)malloc(sizeof(region_list_t));
+    PDC_init_region_list(input_region);
     PDC_region_transfer_t_to_list_t(&in.region, input_region);
     strcpy(input_region->storage_location, in.storage_location);
-    input_region->offset = in.offset;
+    input_region->offset       = in.offset;
+    input_region->compress     = in.compress;
+    input_region->storage_size = in.storage_size;
 
     if (in.has_hist == 1) {
         input_region->region_hist = (pdc_histogram_t *)calloc(1, sizeof(pdc_histogram_t));
         PDC_copy_hist(input_region->region_hist, &in.hist);
     }
+    if (in.sketch_size > 0)
+        input_region->region_sketch = PDC_sketch_deserialize(in.sketch, in.sketch_size);
 
     out.ret   = 20171031;
     ret_value = PDC_Server_update_local_region_storage_loc(input_region, in.obj_id, in.type);
+    // The metadata copies the sketch
+    PDC_sketch_free(input_region->region_sketch);
+    input_region->region_sketch = NULL;
     if (ret_value != SUCCEED) {
         out.ret = -1;
         PGOTO_ERROR(HG_OTHER_ERROR, "==PDC_SERVER: FAILED to update region location: obj_id=%" PRIu64 "",
@@ -4868,7 +5428,7 @@ HG_TEST_RPC_CB(update_region_loc, handle)
     }
 
     /* HG_Respond(handle, NULL, NULL, &out); */
-    HG_Respond(handle, NULL, NULL, &out);
+    PDC_Server_metadata_log_respond(handle, &out, sizeof(out));
 
     HG_Free_input(handle, &in);
     HG_Destroy(handle);
@@ -5088,7 +5648,7 @@ cont_add_del_objs_bulk_cb(const struct hg_cb_info *hg_cb_info)
 done:
     /* Free block handle */
     HG_Bulk_free(local_bulk_handle);
-    HG_Respond(bulk_args->handle, NULL, NULL, &out_struct);
+    PDC_Server_metadata_log_respond(bulk_args->handle, &out_struct, sizeof(out_struct));
     HG_Destroy(bulk_args->handle);
     free(bulk_args);
     fflush(stdout);
@@ -5166,7 +5726,7 @@ HG_TEST_RPC_CB(cont_add_tags_rpc, handle)
     else
         out.ret = 1;
 
-    HG_Respond(handle, NULL, NULL, &out);
+    PDC_Server_metadata_log_respond(handle, &out, sizeof(out));
 
     HG_Free_input(handle, &in);
     HG_Destroy(handle);
@@ -6146,6 +6706,9 @@ HG_TEST_RPC_CB(send_nhits, handle)
 
     in_cp->nhits    = in.nhits;
     in_cp->query_id = in.query_id;
+    in_cp->sum      = in.sum;
+    in_cp->min      = in.min;
+    in_cp->max      = in.max;
 
     out.ret   = 1;
     ret_value = HG_Respond(handle, PDC_recv_nhits, in_cp, &out);
@@ -6179,6 +6742,29 @@ HG_TEST_RPC_CB(send_read_sel_obj_id_rpc, handle)
     FUNC_LEAVE(ret_value);
 }
 
+/* query_cache_invalidate_rpc_cb(hg_handle_t handle) */
+HG_TEST_RPC_CB(query_cache_invalidate_rpc, handle)
+{
+    hg_return_t                 ret_value = HG_SUCCESS;
+    query_cache_invalidate_in_t in;
+    pdc_int_ret_t               out;
+
+    FUNC_ENTER(NULL);
+
+    HG_Get_input(handle, &in);
+
+    // Another server has written the object, the results of this server on it are stale
+    PDC_Server_query_cache_invalidate(in.obj_id);
+
+    out.ret   = 1;
+    ret_value = HG_Respond(handle, NULL, NULL, &out);
+
+    ret_value = HG_Free_input(handle, &in);
+    ret_value = HG_Destroy(handle);
+
+    FUNC_LEAVE(ret_value);
+}
+
 /* get_sel_data_rpc_cb(hg_handle_t handle) */
 HG_TEST_RPC_CB(get_sel_data_rpc, handle)
 {
@@ -6202,6 +6788,29 @@ HG_TEST_RPC_CB(get_sel_data_rpc, handle)
     FUNC_LEAVE(ret_value);
 }
 
+/* query_cursor_rpc_cb(hg_handle_t handle) */
+HG_TEST_RPC_CB(query_cursor_rpc, handle)
+{
+    hg_return_t           ret_value = HG_SUCCESS;
+    query_cursor_rpc_in_t in, *in_cp;
+    pdc_int_ret_t         out;
+
+    FUNC_ENTER(NULL);
+
+    HG_Get_input(handle, &in);
+
+    in_cp = (query_cursor_rpc_in_t *)malloc(sizeof(query_cursor_rpc_in_t));
+    memcpy(in_cp, &in, sizeof(query_cursor_rpc_in_t));
+
+    out.ret   = 1;
+    ret_value = HG_Respond(handle, PDC_Server_recv_query_cursor, in_cp, &out);
+
+    ret_value = HG_Free_input(handle, &in);
+    ret_value = HG_Destroy(handle);
+
+    FUNC_LEAVE(ret_value);
+}
+
 // Generic bulk transfer
 /* send_bulk_rpc_cb(hg_handle_t handle) */
 HG_TEST_RPC_CB(send_bulk_rpc, handle)
@@ -6247,6 +6856,9 @@ HG_TEST_RPC_CB(send_bulk_rpc, handle)
     else if (in_struct.op_id == PDC_BULK_QUERY_METADATA) {
         func_ptr = &PDC_recv_query_metadata_bulk;
     }
+    else if (in_struct.op_id == PDC_BULK_QUERY_CURSOR) {
+        func_ptr = &PDC_recv_query_cursor_batch;
+    }
     else
         PGOTO_ERROR(HG_OTHER_ERROR, "== Invalid bulk op ID!");
 
@@ -6277,6 +6889,7 @@ done:
 
 HG_TEST_THREAD_CB(server_lookup_client)
 HG_TEST_THREAD_CB(gen_obj_id)
+HG_TEST_THREAD_CB(metadata_bulk_create)
 HG_TEST_THREAD_CB(gen_cont_id)
 HG_TEST_THREAD_CB(cont_add_del_objs_rpc)
 HG_TEST_THREAD_CB(cont_add_tags_rpc)
@@ -6313,6 +6926,7 @@ HG_TEST_THREAD_CB(metadata_add_tag)
 HG_TEST_THREAD_CB(metadata_add_kvtag)
 HG_TEST_THREAD_CB(metadata_get_kvtag)
 HG_TEST_THREAD_CB(metadata_del_kvtag)
+HG_TEST_THREAD_CB(obj_get_stats)
 HG_TEST_THREAD_CB(server_lookup_remote_server)
 HG_TEST_THREAD_CB(bulk_rpc)
 HG_TEST_THREAD_CB(buf_map)
@@ -6328,6 +6942,8 @@ HG_TEST_THREAD_CB(send_nhits)
 HG_TEST_THREAD_CB(send_bulk_rpc)
 HG_TEST_THREAD_CB(get_sel_data_rpc)
 HG_TEST_THREAD_CB(send_read_sel_obj_id_rpc)
+HG_TEST_THREAD_CB(query_cache_invalidate_rpc)
+HG_TEST_THREAD_CB(query_cursor_rpc)
 
 #define PDC_FUNC_DECLARE_REGISTER(x)                                                                         \
     hg_id_t PDC_##x##_register(hg_class_t *hg_class)                                                         \
@@ -6350,6 +6966,7 @@ HG_TEST_THREAD_CB(send_read_sel_obj_id_rpc)
     }
 
 PDC_FUNC_DECLARE_REGISTER(gen_obj_id)
+PDC_FUNC_DECLARE_REGISTER(metadata_bulk_create)
 PDC_FUNC_DECLARE_REGISTER(gen_cont_id)
 PDC_FUNC_DECLARE_REGISTER(server_lookup_client)
 PDC_FUNC_DECLARE_REGISTER(server_lookup_remote_server)
@@ -6365,6 +6982,7 @@ PDC_FUNC_DECLARE_REGISTER(metadata_add_tag)
 PDC_FUNC_DECLARE_REGISTER_IN_OUT(metadata_del_kvtag, metadata_get_kvtag_in_t, metadata_add_tag_out_t)
 PDC_FUNC_DECLARE_REGISTER_IN_OUT(metadata_add_kvtag, metadata_add_kvtag_in_t, metadata_add_tag_out_t)
 PDC_FUNC_DECLARE_REGISTER(metadata_get_kvtag)
+PDC_FUNC_DECLARE_REGISTER(obj_get_stats)
 PDC_FUNC_DECLARE_REGISTER(metadata_update)
 PDC_FUNC_DECLARE_REGISTER(metadata_delete_by_id)
 PDC_FUNC_DECLARE_REGISTER(metadata_delete)
@@ -6403,6 +7021,8 @@ PDC_FUNC_DECLARE_REGISTER_IN_OUT(send_nhits, send_nhits_t, pdc_int_ret_t)
 PDC_FUNC_DECLARE_REGISTER_IN_OUT(send_bulk_rpc, bulk_rpc_in_t, pdc_int_ret_t)
 PDC_FUNC_DECLARE_REGISTER_IN_OUT(get_sel_data_rpc, get_sel_data_rpc_in_t, pdc_int_ret_t)
 PDC_FUNC_DECLARE_REGISTER_IN_OUT(send_read_sel_obj_id_rpc, get_sel_data_rpc_in_t, pdc_int_ret_t)
+PDC_FUNC_DECLARE_REGISTER_IN_OUT(query_cache_invalidate_rpc, query_cache_invalidate_in_t, pdc_int_ret_t)
+PDC_FUNC_DECLARE_REGISTER_IN_OUT(query_cursor_rpc, query_cursor_rpc_in_t, pdc_int_ret_t)
 
 /*
  * Check if two 1D segments overlaps
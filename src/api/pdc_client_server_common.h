@@ -30,6 +30,7 @@
 #include "pdc_prop_pkg.h"
 #include "pdc_analysis_and_transforms_common.h"
 #include "pdc_query.h"
+#include "pdc_sketch.h"
 
 #include "mercury_macros.h"
 #include "mercury_proc_string.h"
@@ -67,6 +68,7 @@ hg_thread_mutex_t meta_obj_map_mutex_g;
 #define PDC_SEQ_ID_INIT_VALUE        1000
 #define PDC_UPDATE_CACHE             111
 #define PDC_UPDATE_STORAGE           101
+#define PDC_INTERN_NBUCKET_INIT      1024
 
 #define pdc_server_cfg_name_g "server.cfg"
 
@@ -79,6 +81,7 @@ hg_thread_mutex_t meta_obj_map_mutex_g;
 extern uint64_t          pdc_id_seq_g;
 extern int               pdc_server_rank_g;
 extern hg_atomic_int32_t close_server_g;
+extern char              pdcquery_op_char_g[6][5];
 
 #define PDC_LOCK_OP_OBTAIN  0
 #define PDC_LOCK_OP_RELEASE 1
@@ -142,9 +145,16 @@ typedef enum {
     PDC_BULK_QUERY_COORDS    = 1,
     PDC_BULK_READ_COORDS     = 2,
     PDC_BULK_SEND_QUERY_DATA = 3,
-    PDC_BULK_QUERY_METADATA  = 4
+    PDC_BULK_QUERY_METADATA  = 4,
+    PDC_BULK_QUERY_CURSOR    = 5
 } _pdc_bulk_op_t;
 
+typedef enum {
+    PDC_QUERY_CURSOR_OP_NONE = 0,
+    PDC_QUERY_CURSOR_NEXT    = 1,
+    PDC_QUERY_CURSOR_CLOSE   = 2
+} _pdc_query_cursor_op_t;
+
 typedef struct pdc_metadata_t pdc_metadata_t;
 typedef struct region_list_t  region_list_t;
 
@@ -191,10 +201,14 @@ typedef struct region_list_t {
     char                  shm_addr[ADDR_MAX];
     int                   shm_fd;
     pdc_histogram_t *     region_hist;
+    pdc_sketch_t *        region_sketch;
     char *                buf;
     _pdc_data_loc_t       data_loc_type;
     char                  storage_location[ADDR_MAX];
     uint64_t              offset;
+    int32_t               compress;     // pdc_compress_t of the stored data, PDC_COMPRESS_NONE if raw
+    uint64_t              storage_size; // bytes the compressed data occupies in storage
+    double                quant_step;   // quantization step of a PDC_COMPRESS_LOSSY region
     struct region_list_t *io_cache_region;
     struct region_list_t *overlap_storage_regions;
     uint32_t              n_overlap_storage_region;
@@ -243,6 +257,12 @@ typedef struct pdc_metadata_transfer_t {
 
     size_t   ndim;
     uint64_t dims0, dims1, dims2, dims3;
+    uint64_t stripe_size;
+    int32_t  stripe_count;
+    int32_t  compress;
+    int32_t  compress_level;
+    int32_t  error_bound_mode;
+    double   error_bound;
 
     const char *tags;
     const char *data_location;
@@ -316,6 +336,9 @@ typedef struct region_buf_map_t {
     hg_addr_t              local_addr;
     hg_bulk_t              local_bulk_handle;
     pdc_var_type_t         local_data_type;
+    void *                 local_shm_buf; /* data in the shared memory of a client on this node */
+    uint64_t               local_shm_size;
+    void *                 local_shm_arena; /* server mapping of the shared memory holding local_shm_buf */
 
     struct region_buf_map_t *prev;
     struct region_buf_map_t *next;
@@ -351,6 +374,11 @@ typedef struct data_server_region_t {
     region_map_t *region_map_head;
     // For region storage
     region_list_t *region_storage_head;
+    // Compression of new storage regions, from the latest buf map of the object
+    int32_t compress;
+    int32_t compress_level;
+    int32_t error_bound_mode;
+    double  error_bound;
     // For non-mapped object analysis
     // Used primarily as a local_temp
     void *                       obj_data_ptr;
@@ -370,26 +398,45 @@ typedef struct data_server_region_unmap_t {
 } data_server_region_unmap_t;
 
 // For storing metadata
+// The name strings are interned with PDC_metadata_intern_str(), shared by all records with the same value.
+// A record owns a reference to each of its strings and drops them with PDC_metadata_release_strs(), a copy
+// by value only borrows them, and a record must be serialized to leave the process.
 typedef struct pdc_metadata_t {
-    int  user_id; // Both server and client gets it and do security check
-    char app_name[ADDR_MAX];
-    char obj_name[ADDR_MAX];
-    int  time_step;
+    // Hot fields, compared by every hash table lookup
+    uint64_t obj_id;
+    int      user_id; // Both server and client gets it and do security check
+    int      time_step;
+    char *   obj_name;
+    char *   app_name;
     // Above four are the unique identifier for objects
 
+    // For hash table list
+    struct pdc_metadata_t *prev;
+    struct pdc_metadata_t *next;
+    void *                 bloom;
+
     pdc_var_type_t data_type;
-    uint64_t       obj_id;
     uint64_t       cont_id;
     time_t         create_time;
     time_t         last_modified_time;
 
-    char              tags[TAG_LEN_MAX];
+    char *            tags;
     pdc_kvtag_list_t *kvtag_list_head;
-    char              data_location[ADDR_MAX];
+    char *            data_location;
 
     size_t   ndim;
     uint64_t dims[DIM_MAX];
 
+    // For data striping across data servers, stripe_count is 0 if the object is not striped
+    uint64_t stripe_size;
+    int32_t  stripe_count;
+    // Compression of the data in the server storage, a pdc_compress_t, and the error bound with its
+    // pdc_error_bound_t for PDC_COMPRESS_LOSSY
+    int32_t compress;
+    int32_t compress_level;
+    int32_t error_bound_mode;
+    double  error_bound;
+
     // For region storage list
     region_list_t *storage_region_list_head;
     int            all_storage_region_distributed;
@@ -408,13 +455,93 @@ typedef struct pdc_metadata_t {
     struct _pdc_transform_state current_state;
 
     pdc_histogram_t *obj_hist;
+} pdc_metadata_t;
 
-    // For hash table list
-    struct pdc_metadata_t *prev;
-    struct pdc_metadata_t *next;
-    void *                 bloom;
+// Metadata checkpoint file of a server, all sections are 8-byte aligned:
+//   header
+//   containers: pdc_checkpoint_cont_t, name and tags strings, kvtags, n_obj object ids
+//   objects: pdc_checkpoint_obj_t, obj_name, app_name, tags and data_location strings, kvtags, regions,
+//            then the storage location string and regions of the data server if n_data_region >= 0
+//   index: one pdc_checkpoint_index_t per object, to locate and verify the object records
+// A string is its uint32_t length including the '\0' and the characters, a kvtag is its name string, the
+// uint32_t value size and the value, a region is a pdc_checkpoint_region_t, its storage location string,
+// nbin * 2 double ranges and nbin uint64_t bins of its histogram and sketch_size bytes of its sketch.
+#define PDC_CHECKPOINT_MAGIC   "PDCCKPT"
+#define PDC_CHECKPOINT_VERSION 6
+
+typedef struct pdc_checkpoint_header_t {
+    char     magic[8];
+    uint32_t version;
+    uint32_t cont_crc;  // crc32 of the container section
+    uint64_t n_cont;
+    uint64_t n_obj;
+    uint64_t cont_offset;
+    uint64_t obj_offset;
+    uint64_t index_offset;
+    uint32_t index_crc; // crc32 of the index section
+    uint32_t crc;       // crc32 of the header up to this field
+} pdc_checkpoint_header_t;
+
+typedef struct pdc_checkpoint_index_t {
+    uint64_t obj_id;
+    uint64_t offset;
+    uint32_t size;
+    uint32_t crc;      // crc32 of the object record
+    uint32_t hash_key; // hash table bucket of the object
+    uint32_t reserved;
+} pdc_checkpoint_index_t;
+
+typedef struct pdc_checkpoint_cont_t {
+    uint64_t cont_id;
+    int32_t  n_obj;
+    int32_t  n_deleted;
+    uint32_t n_kvtag;
+    uint32_t reserved;
+} pdc_checkpoint_cont_t;
 
-} pdc_metadata_t;
+typedef struct pdc_checkpoint_obj_t {
+    uint64_t obj_id;
+    uint64_t cont_id;
+    int64_t  create_time;
+    int64_t  last_modified_time;
+    uint64_t dims[DIM_MAX];
+    uint64_t t_dims[DIM_MAX];
+    uint64_t stripe_size;
+    double   error_bound;
+    int32_t  user_id;
+    int32_t  time_step;
+    int32_t  data_type;
+    int32_t  ndim;
+    int32_t  transform_state;
+    int32_t  t_storage_order;
+    int32_t  t_dtype;
+    int32_t  t_ndim;
+    int32_t  t_meta_index;
+    int32_t  stripe_count;
+    int32_t  compress;
+    int32_t  compress_level;
+    int32_t  error_bound_mode;
+    uint32_t n_kvtag;
+    uint32_t n_region;
+    int32_t  n_data_region; // -1 if the object has no data server regions
+} pdc_checkpoint_obj_t;
+
+typedef struct pdc_checkpoint_region_t {
+    uint64_t start[DIM_MAX];
+    uint64_t count[DIM_MAX];
+    uint64_t offset;
+    uint64_t data_size;
+    uint64_t storage_size;
+    uint64_t unit_size;
+    double   quant_step;
+    double   hist_incr;
+    int32_t  ndim;
+    int32_t  data_loc_type;
+    int32_t  compress;
+    int32_t  hist_dtype;
+    int32_t  hist_nbin;   // 0 if the region has no histogram
+    uint32_t sketch_size; // 0 if the region has no sketch
+} pdc_checkpoint_region_t;
 
 typedef struct {
     pdc_access_t   io_type;
@@ -465,6 +592,7 @@ typedef struct {
 /* Define metadata_query_out_t */
 typedef struct {
     pdc_metadata_transfer_t ret;
+    uint32_t                lease_ms; /* the client may cache the result for this long */
 } metadata_query_out_t;
 
 /* Define metadata_add_tag_in_t */
@@ -641,6 +769,20 @@ typedef struct {
     uint64_t obj_id;
 } gen_obj_id_out_t;
 
+/* Define metadata_bulk_create_in_t */
+typedef struct {
+    pdc_metadata_transfer_t data; /* properties shared by all objects, obj_name is not used */
+    int8_t                  data_type;
+    uint32_t                n_obj;
+    hg_bulk_t               bulk_handle; /* n_obj name hash values followed by the n_obj names */
+} metadata_bulk_create_in_t;
+
+/* Define metadata_bulk_create_out_t */
+typedef struct {
+    uint64_t obj_id_start; /* objects created get consecutive IDs in the order of the names */
+    uint32_t n_created;
+} metadata_bulk_create_out_t;
+
 /* Define server_lookup_client_in_t */
 typedef struct {
     int32_t     server_id;
@@ -731,11 +873,19 @@ typedef struct {
     region_info_transfer_t remote_region_unit;
     region_info_transfer_t remote_region_nounit;
     region_info_transfer_t local_region;
+    hg_const_string_t      shm_addr; /* shared memory of the client, empty to use bulk transfers */
+    uint64_t               shm_offset;
+    uint64_t               shm_size;
+    int32_t                compress; /* pdc_compress_t of the object */
+    int32_t                compress_level;
+    int32_t                error_bound_mode; /* pdc_error_bound_t of error_bound */
+    double                 error_bound;
 } buf_map_in_t;
 
 /* Define buf_map_out_t */
 typedef struct {
     int32_t ret;
+    int32_t shm; /* 1 if the server transfers the data through the client shared memory */
 } buf_map_out_t;
 
 /* Define buf_unmap_in_t */
@@ -857,10 +1007,14 @@ typedef struct {
     uint64_t               obj_id;
     hg_string_t            storage_location;
     uint64_t               offset;
+    int32_t                compress;     // pdc_compress_t of the stored data
+    uint64_t               storage_size; // bytes the compressed data occupies in storage
     region_info_transfer_t region;
     int                    type;
     int                    has_hist;
     pdc_histogram_t        hist;
+    uint32_t               sketch_size; // 0 if the region has no sketch
+    void *                 sketch;      // serialized pdc_sketch_t
 } update_region_loc_in_t;
 
 /* Define update_region_loc_out_t */
@@ -984,6 +1138,7 @@ typedef struct pdc_query_xfer_t {
     int                     prev_server_id;
     pdc_query_constraint_t *constraints;
     region_info_transfer_t  region;
+    uint64_t                agg_obj_id;
 } pdc_query_xfer_t;
 
 /* Define get_sel_data_rpc_in_t */
@@ -993,10 +1148,42 @@ typedef struct get_sel_data_rpc_in_t {
     int      origin;
 } get_sel_data_rpc_in_t;
 
+/* Define query_cache_invalidate_in_t */
+typedef struct query_cache_invalidate_in_t {
+    uint64_t obj_id;
+    int32_t  origin;
+} query_cache_invalidate_in_t;
+
+/* Define query_cursor_rpc_in_t */
+typedef struct query_cursor_rpc_in_t {
+    int      query_id;
+    int      origin;
+    int      op;
+    uint64_t obj_id;
+    uint64_t offset;
+    uint64_t count;
+} query_cursor_rpc_in_t;
+
+/* Define obj_get_stats_in_t */
+typedef struct obj_get_stats_in_t {
+    uint64_t obj_id;
+} obj_get_stats_in_t;
+
+/* Define obj_get_stats_out_t */
+typedef struct obj_get_stats_out_t {
+    int32_t  ret;
+    uint32_t sketch_size; // 0 if no region of the object has a sketch
+    void *   sketch;      // serialized pdc_sketch_t merged from the regions
+} obj_get_stats_out_t;
+
 /* Define send_nhits_t */
 typedef struct send_nhits_t {
     int      query_id;
     uint64_t nhits;
+    // Partial aggregates for PDC_QUERY_GET_AGG
+    double sum;
+    double min;
+    double max;
 } send_nhits_t;
 
 /* Define query_storage_region_transfer_t */
@@ -1482,6 +1669,36 @@ hg_proc_pdc_metadata_transfer_t(hg_proc_t proc, void *data)
         // HG_LOG_ERROR("Proc error");
         return ret;
     }
+    ret = hg_proc_uint64_t(proc, &struct_data->stripe_size);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_int32_t(proc, &struct_data->stripe_count);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_int32_t(proc, &struct_data->compress);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_int32_t(proc, &struct_data->compress_level);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_int32_t(proc, &struct_data->error_bound_mode);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_raw(proc, &struct_data->error_bound, sizeof(double));
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
     ret = hg_proc_hg_string_t(proc, &struct_data->data_location);
     if (ret != HG_SUCCESS) {
         // HG_LOG_ERROR("Proc data_location error");
@@ -1798,6 +2015,11 @@ hg_proc_metadata_query_out_t(hg_proc_t proc, void *data)
         // HG_LOG_ERROR("Proc error");
         return ret;
     }
+    ret = hg_proc_uint32_t(proc, &struct_data->lease_ms);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
     return ret;
 }
 
@@ -1877,6 +2099,56 @@ hg_proc_gen_obj_id_out_t(hg_proc_t proc, void *data)
     return ret;
 }
 
+/* Define hg_proc_metadata_bulk_create_in_t */
+static HG_INLINE hg_return_t
+hg_proc_metadata_bulk_create_in_t(hg_proc_t proc, void *data)
+{
+    hg_return_t                ret;
+    metadata_bulk_create_in_t *struct_data = (metadata_bulk_create_in_t *)data;
+
+    ret = hg_proc_pdc_metadata_transfer_t(proc, &struct_data->data);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_int8_t(proc, &struct_data->data_type);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_uint32_t(proc, &struct_data->n_obj);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_hg_bulk_t(proc, &struct_data->bulk_handle);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    return ret;
+}
+
+/* Define hg_proc_metadata_bulk_create_out_t */
+static HG_INLINE hg_return_t
+hg_proc_metadata_bulk_create_out_t(hg_proc_t proc, void *data)
+{
+    hg_return_t                 ret;
+    metadata_bulk_create_out_t *struct_data = (metadata_bulk_create_out_t *)data;
+
+    ret = hg_proc_uint64_t(proc, &struct_data->obj_id_start);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_uint32_t(proc, &struct_data->n_created);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    return ret;
+}
+
 /* Define hg_proc_server_lookup_remote_server_in_t */
 static HG_INLINE hg_return_t
 hg_proc_server_lookup_remote_server_in_t(hg_proc_t proc, void *data)
@@ -2266,6 +2538,41 @@ hg_proc_buf_map_in_t(hg_proc_t proc, void *data)
         // HG_LOG_ERROR("Proc error");
         return ret;
     }
+    ret = hg_proc_hg_const_string_t(proc, &struct_data->shm_addr);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_uint64_t(proc, &struct_data->shm_offset);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_uint64_t(proc, &struct_data->shm_size);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_int32_t(proc, &struct_data->compress);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_int32_t(proc, &struct_data->compress_level);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_int32_t(proc, &struct_data->error_bound_mode);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_raw(proc, &struct_data->error_bound, sizeof(double));
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
     return ret;
 }
 
@@ -2281,6 +2588,11 @@ hg_proc_buf_map_out_t(hg_proc_t proc, void *data)
         // HG_LOG_ERROR("Proc error");
         return ret;
     }
+    ret = hg_proc_int32_t(proc, &struct_data->shm);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
     return ret;
 }
 
@@ -2628,6 +2940,16 @@ hg_proc_update_region_loc_in_t(hg_proc_t proc, void *data)
         // HG_LOG_ERROR("Proc error");
         return ret;
     }
+    ret = hg_proc_int32_t(proc, &struct_data->compress);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_uint64_t(proc, &struct_data->storage_size);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
     ret = hg_proc_uint32_t(proc, &struct_data->type);
     if (ret != HG_SUCCESS) {
         // HG_LOG_ERROR("Proc error");
@@ -2650,6 +2972,26 @@ hg_proc_update_region_loc_in_t(hg_proc_t proc, void *data)
             return ret;
         }
     }
+    ret = hg_proc_uint32_t(proc, &struct_data->sketch_size);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    if (struct_data->sketch_size) {
+        switch (hg_proc_get_op(proc)) {
+            case HG_DECODE:
+                struct_data->sketch = malloc(struct_data->sketch_size);
+                /* HG_FALLTHROUGH(); */
+                /* FALLTHRU */
+            case HG_ENCODE:
+                ret = hg_proc_raw(proc, struct_data->sketch, struct_data->sketch_size);
+                break;
+            case HG_FREE:
+                free(struct_data->sketch);
+            default:
+                break;
+        }
+    }
     return ret;
 }
 
@@ -3016,6 +3358,116 @@ hg_proc_get_sel_data_rpc_in_t(hg_proc_t proc, void *data)
     return ret;
 }
 
+/* Define hg_proc_query_cache_invalidate_in_t */
+static HG_INLINE hg_return_t
+hg_proc_query_cache_invalidate_in_t(hg_proc_t proc, void *data)
+{
+    hg_return_t                  ret;
+    query_cache_invalidate_in_t *struct_data = (query_cache_invalidate_in_t *)data;
+
+    ret = hg_proc_uint64_t(proc, &struct_data->obj_id);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_int32_t(proc, &struct_data->origin);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    return ret;
+}
+
+/* Define hg_proc_query_cursor_rpc_in_t */
+static HG_INLINE hg_return_t
+hg_proc_query_cursor_rpc_in_t(hg_proc_t proc, void *data)
+{
+    hg_return_t            ret;
+    query_cursor_rpc_in_t *struct_data = (query_cursor_rpc_in_t *)data;
+
+    ret = hg_proc_int32_t(proc, &struct_data->query_id);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_int32_t(proc, &struct_data->origin);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_int32_t(proc, &struct_data->op);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_uint64_t(proc, &struct_data->obj_id);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_uint64_t(proc, &struct_data->offset);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_uint64_t(proc, &struct_data->count);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    return ret;
+}
+
+/* Define hg_proc_obj_get_stats_in_t */
+static HG_INLINE hg_return_t
+hg_proc_obj_get_stats_in_t(hg_proc_t proc, void *data)
+{
+    hg_return_t         ret;
+    obj_get_stats_in_t *struct_data = (obj_get_stats_in_t *)data;
+
+    ret = hg_proc_uint64_t(proc, &struct_data->obj_id);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    return ret;
+}
+
+/* Define hg_proc_obj_get_stats_out_t */
+static HG_INLINE hg_return_t
+hg_proc_obj_get_stats_out_t(hg_proc_t proc, void *data)
+{
+    hg_return_t          ret;
+    obj_get_stats_out_t *struct_data = (obj_get_stats_out_t *)data;
+
+    ret = hg_proc_int32_t(proc, &struct_data->ret);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_uint32_t(proc, &struct_data->sketch_size);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    if (struct_data->sketch_size) {
+        switch (hg_proc_get_op(proc)) {
+            case HG_DECODE:
+                struct_data->sketch = malloc(struct_data->sketch_size);
+                /* HG_FALLTHROUGH(); */
+                /* FALLTHRU */
+            case HG_ENCODE:
+                ret = hg_proc_raw(proc, struct_data->sketch, struct_data->sketch_size);
+                break;
+            case HG_FREE:
+                free(struct_data->sketch);
+            default:
+                break;
+        }
+    }
+    return ret;
+}
+
 /* Define hg_proc_send_nhits_t */
 static HG_INLINE hg_return_t
 hg_proc_send_nhits_t(hg_proc_t proc, void *data)
@@ -3034,6 +3486,21 @@ hg_proc_send_nhits_t(hg_proc_t proc, void *data)
         // HG_LOG_ERROR("Proc error");
         return ret;
     }
+    ret = hg_proc_raw(proc, &struct_data->sum, sizeof(double));
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_raw(proc, &struct_data->min, sizeof(double));
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
+    ret = hg_proc_raw(proc, &struct_data->max, sizeof(double));
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
     return ret;
 }
 
@@ -3304,6 +3771,7 @@ typedef struct storage_regions_args_t {
 /* Library-private Function Prototypes */
 /***************************************/
 hg_id_t PDC_gen_obj_id_register(hg_class_t *hg_class);
+hg_id_t PDC_metadata_bulk_create_register(hg_class_t *hg_class);
 hg_id_t PDC_client_test_connect_register(hg_class_t *hg_class);
 hg_id_t PDC_get_remote_metadata_register(hg_class_t *hg_class_g);
 hg_id_t PDC_server_lookup_client_register(hg_class_t *hg_class);
@@ -3359,6 +3827,7 @@ hg_id_t PDC_notify_client_multi_io_complete_rpc_register(hg_class_t *hg_class);
 
 hg_id_t PDC_send_client_storage_meta_rpc_register(hg_class_t *hg_class);
 hg_id_t PDC_send_read_sel_obj_id_rpc_register(hg_class_t *hg_class);
+hg_id_t PDC_query_cache_invalidate_rpc_register(hg_class_t *hg_class);
 
 hg_id_t PDC_data_server_write_check_register(hg_class_t *hg_class);
 hg_id_t PDC_data_server_read_register(hg_class_t *hg_class);
@@ -3368,6 +3837,8 @@ hg_id_t PDC_data_server_read_register(hg_class_t *hg_class);
 hg_id_t PDC_send_nhits_register(hg_class_t *hg_class);
 hg_id_t PDC_send_bulk_rpc_register(hg_class_t *hg_class);
 hg_id_t PDC_get_sel_data_rpc_register(hg_class_t *hg_class);
+hg_id_t PDC_query_cursor_rpc_register(hg_class_t *hg_class);
+hg_id_t PDC_obj_get_stats_register(hg_class_t *hg_class);
 
 // Data query
 hg_id_t PDC_send_data_query_rpc_register(hg_class_t *hg_class);
@@ -3442,6 +3913,17 @@ uint32_t PDC_get_server_by_obj_id(uint64_t obj_id, int n_server);
  */
 uint32_t PDC_get_hash_by_name(const char *name);
 
+/**
+ * Update a CRC-32 checksum with a buffer
+ *
+ * \param crc [IN]              Checksum of the preceding data, 0 to start
+ * \param buf [IN]              Buffer
+ * \param size [IN]             Buffer size in bytes
+ *
+ * \return Updated checksum
+ */
+uint32_t PDC_checksum_crc32(uint32_t crc, const void *buf, size_t size);
+
 /**
  * Get the server ID
  *
@@ -3489,6 +3971,76 @@ perr_t PDC_metadata_init(pdc_metadata_t *a);
  */
 void PDC_print_metadata(pdc_metadata_t *a);
 
+/**
+ * Get a reference to the interned copy of a metadata string, the copy is shared by all callers and is
+ * freed when its last reference is released. The empty string is a static string that is not counted.
+ *
+ * \param str [IN]              String to intern, NULL is taken as an empty string
+ *
+ * \return Pointer to the interned string on success/NULL on failure
+ */
+char *PDC_metadata_intern_str(const char *str);
+
+/**
+ * Take one more reference to an interned string
+ *
+ * \param str [IN]              Interned string, or NULL
+ *
+ * \return The interned string
+ */
+char *PDC_metadata_intern_ref(char *str);
+
+/**
+ * Release a reference to an interned string
+ *
+ * \param str [IN]              Interned string, or NULL
+ */
+void PDC_metadata_intern_release(char *str);
+
+/**
+ * Release the references of a metadata record to its strings, and clear them
+ *
+ * \param a [IN]                Metadata struct owning its strings
+ */
+void PDC_metadata_release_strs(pdc_metadata_t *a);
+
+/**
+ * Get the memory used by the interned metadata strings of this process
+ *
+ * \param nstr [OUT]            Number of distinct strings
+ * \param nbytes [OUT]          Bytes allocated for the strings and their lookup table
+ */
+void PDC_metadata_intern_stats(uint64_t *nstr, uint64_t *nbytes);
+
+/**
+ * Get the number of bytes PDC_metadata_serialize() writes for a metadata struct
+ *
+ * \param a [IN]                Metadata struct
+ *
+ * \return Serialized size in bytes
+ */
+size_t PDC_metadata_serialize_size(pdc_metadata_t *a);
+
+/**
+ * Serialize a metadata struct and its name strings into a contiguous buffer
+ *
+ * \param a [IN]                Metadata struct
+ * \param buf [OUT]             Buffer of at least PDC_metadata_serialize_size() bytes
+ *
+ * \return Number of bytes written
+ */
+size_t PDC_metadata_serialize(pdc_metadata_t *a, void *buf);
+
+/**
+ * Deserialize a metadata struct written by PDC_metadata_serialize(), the name strings are interned
+ *
+ * \param buf [IN]              Serialized buffer
+ * \param a [OUT]               Metadata struct
+ *
+ * \return Number of bytes read
+ */
+size_t PDC_metadata_deserialize(void *buf, pdc_metadata_t *a);
+
 /**
  * Print region list
  *
@@ -3552,10 +4104,11 @@ int PDC_is_same_region_transfer(region_info_transfer_t *a, region_info_transfer_
 perr_t PDC_metadata_t_to_transfer_t(pdc_metadata_t *meta, pdc_metadata_transfer_t *transfer);
 
 /**
- * Metadata type conversion
+ * Metadata type conversion, the strings of meta are released and replaced by interned copies, which the
+ * caller releases with PDC_metadata_release_strs()
  *
- * \param meta [IN]             Metadata to convert
- * \param transfer [OUT]        Converted metadata
+ * \param transfer [IN]         Metadata to convert
+ * \param meta [IN/OUT]         Converted metadata, initialized with PDC_metadata_init()
  *
  * \return Non-negative on success/Negative on failure
  */
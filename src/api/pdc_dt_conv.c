@@ -22,93 +22,166 @@
  * perform publicly and display publicly, and to permit other to do so.
  */
 
-#include <stdlib.h>
-#include <assert.h>
+#include <stdint.h>
+#include <limits.h>
 #include "pdc_dt_conv.h"
 #include "pdc_private.h"
-#include "pdc_error.h"
-#include <limits.h>
 
 /*
-PDC_UNKNOWN      = -1,
-PDC_INT          = 0,
-PDC_FLOAT        = 1,
-PDC_DOUBLE       = 2,
-PDC_STRING       = 3,
-PDC_COMPOUND     = 4,
-PDC_ENUM         = 5,
-PDC_ARRAY        = 6,
-*/
-
-/* Called if overflow is possible */
-#define PDC_CONV_NOEX_CORE(S, D, ST, DT, D_MIN, D_MAX)                                                       \
-    if (*(S) > (DT)(D_MAX))                                                                                  \
-        *(D) = (D_MAX);                                                                                      \
-    else                                                                                                     \
-        *(D) = (DT)(*(S));
-
-pdc_conv_t
-pdc_find_conv_func(PDC_var_type_t src_id, PDC_var_type_t des_id, size_t nelemt, size_t stride)
-{
-    pdc_conv_t ret_value; /* Return value */
+ * Integer to integer, the range checks fold away for the pairs that cannot overflow. lo and hi are the
+ * target range in the source type, they are variables so that the dead checks do not warn.
+ */
+#define PDC_CONV_SAT_II(v, SMIN, SMAX, DT, DMIN, DMAX)                                                       \
+    ((DT)((SMIN) < 0 && (intmax_t)(SMIN) < (intmax_t)(DMIN) && (v) < lo                                      \
+              ? lo                                                                                           \
+              : (uintmax_t)(SMAX) > (uintmax_t)(DMAX) && (v) > hi ? hi : (v)))
 
-    FUNC_ENTER(NULL);
+/* Floating-point to integer, the cast is only done in range. (ST)(DMAX) rounds up to a power of 2 */
+#define PDC_CONV_SAT_FI(v, ST, DT, DMIN, DMAX)                                                               \
+    ((v) >= (ST)(DMAX) ? (DT)(DMAX) : (v) <= (ST)(DMIN) ? (DT)(DMIN) : (v) == (v) ? (DT)(v) : (DT)0)
 
-    if (src_id == PDC_FLOAT && des_id == PDC_INT)
-        ret_value = pdc__conv_f_i;
-    if (src_id == PDC_DOUBLE && des_id == PDC_INT)
-        ret_value = pdc__conv_db_i;
-    else
-        PGOTO_ERROR(NULL, "no matching type convert function");
+/*
+ * Round half to even without libm, P is 2^52 for double and 2^23 for float, above which all values are
+ * integers. Adding and subtracting P rounds in the current rounding mode.
+ */
+#define PDC_CONV_RINT(v, ST, P)                                                                              \
+    ((v) < (ST)(P) && (v) > -(ST)(P) ? ((v) + PDC_CONV_SHIFT(v, ST, P)) - PDC_CONV_SHIFT(v, ST, P) : (v))
+#define PDC_CONV_SHIFT(v, ST, P) ((v) < 0 ? -(ST)(P) : (ST)(P))
+
+/* Contiguous loop kept apart from the strided one so that it vectorizes */
+#define PDC_CONV_LOOP(ST, PREP, EXPR)                                                                        \
+    if (src_stride == 1 && des_stride == 1) {                                                                \
+        for (i = 0; i < nelemt; i++) {                                                                       \
+            ST v = s[i];                                                                                     \
+            PREP;                                                                                            \
+            d[i] = EXPR;                                                                                     \
+        }                                                                                                    \
+    }                                                                                                        \
+    else {                                                                                                   \
+        for (i = 0; i < nelemt; i++) {                                                                       \
+            ST v = s[i * src_stride];                                                                        \
+            PREP;                                                                                            \
+            d[i * des_stride] = EXPR;                                                                        \
+        }                                                                                                    \
+    }
 
-done:
-    FUNC_LEAVE(ret_value);
-}
+#define PDC_CONV_FUNC_BEGIN(SN, ST, DN, DT)                                                                  \
+    static perr_t pdc__conv_##SN##_##DN(const void *src_data, void *des_data, size_t nelemt,                 \
+                                        size_t src_stride, size_t des_stride, int mode)                      \
+    {                                                                                                        \
+        const ST *restrict s = (const ST *)src_data;                                                         \
+        DT *restrict d       = (DT *)des_data;                                                               \
+        size_t               i;
 
-perr_t
-pdc_type_conv(PDC_var_type_t src_id, PDC_var_type_t des_id, void *src_data, void *des_data, size_t nelemt,
-              size_t stride)
-{
-    perr_t ret_value = SUCCEED; /* Return value */
-
-    FUNC_ENTER(NULL);
+#define PDC_CONV_FUNC_END                                                                                    \
+    return SUCCEED;                                                                                          \
+    }
 
-    pdc_conv_t func = pdc_find_conv_func(src_id, des_id, nelemt, stride);
-    (*func)(src_data, des_data, nelemt, stride);
+#define PDC_CONV_II(SN, ST, SMIN, SMAX, DN, DT, DMIN, DMAX)                                                  \
+    PDC_CONV_FUNC_BEGIN(SN, ST, DN, DT)                                                                      \
+    const ST lo = (ST)(DMIN), hi = (ST)(DMAX);                                                               \
+    if (mode & PDC_CONV_CLAMP) {                                                                             \
+        PDC_CONV_LOOP(ST, (void)0, (PDC_CONV_SAT_II(v, SMIN, SMAX, DT, DMIN, DMAX)))                         \
+    }                                                                                                        \
+    else {                                                                                                   \
+        PDC_CONV_LOOP(ST, (void)0, (DT)v)                                                                    \
+    }                                                                                                        \
+    PDC_CONV_FUNC_END
+
+#define PDC_CONV_FI(SN, ST, P, DN, DT, DMIN, DMAX)                                                           \
+    PDC_CONV_FUNC_BEGIN(SN, ST, DN, DT)                                                                      \
+    if (mode & PDC_CONV_ROUND) {                                                                             \
+        PDC_CONV_LOOP(ST, v = PDC_CONV_RINT(v, ST, P), (PDC_CONV_SAT_FI(v, ST, DT, DMIN, DMAX)))             \
+    }                                                                                                        \
+    else {                                                                                                   \
+        PDC_CONV_LOOP(ST, (void)0, (PDC_CONV_SAT_FI(v, ST, DT, DMIN, DMAX)))                                 \
+    }                                                                                                        \
+    PDC_CONV_FUNC_END
+
+/* To floating-point, a C cast rounds to the nearest and a double out of the float range becomes infinity */
+#define PDC_CONV_XF(SN, ST, DN, DT)                                                                          \
+    PDC_CONV_FUNC_BEGIN(SN, ST, DN, DT)                                                                      \
+    (void)mode;                                                                                              \
+    PDC_CONV_LOOP(ST, (void)0, (DT)v)                                                                        \
+    PDC_CONV_FUNC_END
+
+#define PDC_CONV_INT_ROW(SN, ST, SMIN, SMAX)                                                                 \
+    PDC_CONV_II(SN, ST, SMIN, SMAX, i8, int8_t, INT8_MIN, INT8_MAX)                                          \
+    PDC_CONV_II(SN, ST, SMIN, SMAX, c, char, CHAR_MIN, CHAR_MAX)                                             \
+    PDC_CONV_II(SN, ST, SMIN, SMAX, i16, int16_t, INT16_MIN, INT16_MAX)                                      \
+    PDC_CONV_II(SN, ST, SMIN, SMAX, i32, int, INT_MIN, INT_MAX)                                              \
+    PDC_CONV_II(SN, ST, SMIN, SMAX, u32, unsigned int, 0, UINT_MAX)                                          \
+    PDC_CONV_II(SN, ST, SMIN, SMAX, i64, int64_t, INT64_MIN, INT64_MAX)                                      \
+    PDC_CONV_II(SN, ST, SMIN, SMAX, u64, uint64_t, 0, UINT64_MAX)                                            \
+    PDC_CONV_XF(SN, ST, f, float)                                                                            \
+    PDC_CONV_XF(SN, ST, d, double)
+
+#define PDC_CONV_FLOAT_ROW(SN, ST, P)                                                                        \
+    PDC_CONV_FI(SN, ST, P, i8, int8_t, INT8_MIN, INT8_MAX)                                                   \
+    PDC_CONV_FI(SN, ST, P, c, char, CHAR_MIN, CHAR_MAX)                                                      \
+    PDC_CONV_FI(SN, ST, P, i16, int16_t, INT16_MIN, INT16_MAX)                                               \
+    PDC_CONV_FI(SN, ST, P, i32, int, INT_MIN, INT_MAX)                                                       \
+    PDC_CONV_FI(SN, ST, P, u32, unsigned int, 0, UINT_MAX)                                                   \
+    PDC_CONV_FI(SN, ST, P, i64, int64_t, INT64_MIN, INT64_MAX)                                               \
+    PDC_CONV_FI(SN, ST, P, u64, uint64_t, 0, UINT64_MAX)                                                     \
+    PDC_CONV_XF(SN, ST, f, float)                                                                            \
+    PDC_CONV_XF(SN, ST, d, double)
+
+PDC_CONV_INT_ROW(i8, int8_t, INT8_MIN, INT8_MAX)
+PDC_CONV_INT_ROW(c, char, CHAR_MIN, CHAR_MAX)
+PDC_CONV_INT_ROW(i16, int16_t, INT16_MIN, INT16_MAX)
+PDC_CONV_INT_ROW(i32, int, INT_MIN, INT_MAX)
+PDC_CONV_INT_ROW(u32, unsigned int, 0, UINT_MAX)
+PDC_CONV_INT_ROW(i64, int64_t, INT64_MIN, INT64_MAX)
+PDC_CONV_INT_ROW(u64, uint64_t, 0, UINT64_MAX)
+PDC_CONV_FLOAT_ROW(f, float, 8388608.0)
+PDC_CONV_FLOAT_ROW(d, double, 4503599627370496.0)
+
+#define PDC_CONV_TABLE_ROW(SN)                                                                               \
+    {                                                                                                        \
+        [PDC_INT8] = pdc__conv_##SN##_i8, [PDC_CHAR] = pdc__conv_##SN##_c,                                   \
+        [PDC_INT16] = pdc__conv_##SN##_i16, [PDC_INT] = pdc__conv_##SN##_i32,                                \
+        [PDC_UINT] = pdc__conv_##SN##_u32, [PDC_INT64] = pdc__conv_##SN##_i64,                               \
+        [PDC_UINT64] = pdc__conv_##SN##_u64, [PDC_FLOAT] = pdc__conv_##SN##_f,                               \
+        [PDC_DOUBLE] = pdc__conv_##SN##_d                                                                    \
+    }
 
-    FUNC_LEAVE(ret_value);
-}
+/* Conversion of every pair of numeric types, indexed by source then target type */
+static const pdc_conv_t pdc_conv_table_g[NCLASSES][NCLASSES] = {
+    [PDC_INT8] = PDC_CONV_TABLE_ROW(i8),     [PDC_CHAR] = PDC_CONV_TABLE_ROW(c),
+    [PDC_INT16] = PDC_CONV_TABLE_ROW(i16),   [PDC_INT] = PDC_CONV_TABLE_ROW(i32),
+    [PDC_UINT] = PDC_CONV_TABLE_ROW(u32),    [PDC_INT64] = PDC_CONV_TABLE_ROW(i64),
+    [PDC_UINT64] = PDC_CONV_TABLE_ROW(u64),  [PDC_FLOAT] = PDC_CONV_TABLE_ROW(f),
+    [PDC_DOUBLE] = PDC_CONV_TABLE_ROW(d)};
 
-perr_t
-pdc__conv_f_i(float *src_data, int *des_data, size_t nelemt, size_t stride)
+pdc_conv_t
+pdc_find_conv_func(pdc_var_type_t src_id, pdc_var_type_t des_id)
 {
-    perr_t ret_value = SUCCEED; /* Return value */
-    size_t i;
+    pdc_conv_t ret_value = NULL; /* Return value */
 
     FUNC_ENTER(NULL);
 
-    for (i = 0; i < nelemt; i++) {
-        PDC_CONV_NOEX_CORE(src_data, des_data, float, int, INT_MIN, INT_MAX);
-        src_data += stride;
-        des_data++;
-    }
+    if (src_id >= 0 && src_id < NCLASSES && des_id >= 0 && des_id < NCLASSES)
+        ret_value = pdc_conv_table_g[src_id][des_id];
 
     FUNC_LEAVE(ret_value);
 }
 
 perr_t
-pdc__conv_db_i(double *src_data, int *des_data, size_t nelemt, size_t stride)
+pdc_type_conv(pdc_var_type_t src_id, pdc_var_type_t des_id, const void *src_data, void *des_data,
+              size_t nelemt, size_t src_stride, size_t des_stride, int mode)
 {
-    perr_t ret_value = SUCCEED; /* Return value */
-    int    i;
+    perr_t     ret_value = SUCCEED; /* Return value */
+    pdc_conv_t func;
 
     FUNC_ENTER(NULL);
 
-    for (i = 0; i < nelemt; i++) {
-        PDC_CONV_NOEX_CORE(src_data, des_data, double, int, INT_MIN, INT_MAX);
-        src_data += stride;
-        des_data++;
-    }
+    func = pdc_find_conv_func(src_id, des_id);
+    if (func == NULL)
+        PGOTO_ERROR(FAIL, "no matching type convert function from %d to %d", src_id, des_id);
+
+    ret_value = (*func)(src_data, des_data, nelemt, src_stride, des_stride, mode);
 
+done:
     FUNC_LEAVE(ret_value);
 }
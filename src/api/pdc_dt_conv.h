@@ -22,24 +22,32 @@
  * perform publicly and display publicly, and to permit other to do so.
  */
 
+#ifndef PDC_DT_CONV_H
+#define PDC_DT_CONV_H
+
 #include <stdlib.h>
-#include <assert.h>
 #include "pdc_public.h"
-#include "pdc_private.h"
 
-typedef perr_t (*pdc_conv_t)(void *src_data, void *des_data, size_t nelemt, size_t stride);
+/* Conversion mode flags, combined with | */
+#define PDC_CONV_CLAMP 0x1 /* saturate integers out of the target range, otherwise wrap as a C cast */
+#define PDC_CONV_ROUND 0x2 /* round floating-point to the nearest integer, otherwise round toward 0 */
+
+/*
+ * Convert nelemt elements, src_stride and des_stride are in elements. Floating-point to integer always
+ * saturates, NaN converts to 0. The source and target storage must not overlap.
+ */
+typedef perr_t (*pdc_conv_t)(const void *src_data, void *des_data, size_t nelemt, size_t src_stride,
+                             size_t des_stride, int mode);
 
 /**
  * To find type conversion function
  *
  * \param src_id [IN]           ID of source variable type
  * \param des_id [IN]           ID of target variable type
- * \param nelemt [IN]           Number of elements to convert
- * \param stride [IN]           Stride between each element to convert
  *
- * \return convert function on success/NULL on failure
+ * \return convert function on success/NULL if one of the types is not a numeric type
  */
-pdc_conv_t pdc_find_conv_func(PDC_var_type_t src_id, PDC_var_type_t des_id, size_t nelemt, size_t stride);
+pdc_conv_t pdc_find_conv_func(pdc_var_type_t src_id, pdc_var_type_t des_id);
 
 /**
  * Type conversion function
@@ -49,33 +57,13 @@ pdc_conv_t pdc_find_conv_func(PDC_var_type_t src_id, PDC_var_type_t des_id, size
  * \param src_data [IN]         Pointer to source variable storage
  * \param des_data [IN]         Pointer to target variable storage
  * \param nelemt [IN]           Number of elements to convert
- * \param stride [IN]           Stride between each element to convert
- *
- * \return Non-negative on success/Negative on failure
- */
-perr_t pdc_type_conv(PDC_var_type_t src_id, PDC_var_type_t des_id, void *src_data, void *des_data,
-                     size_t nelemt, size_t stride);
-
-/**
- * Convert from float to int
- *
- * \param src_data [IN]         Pointer to source data
- * \param des_data [IN]         Pointer to target data
- * \param nelemt [IN]           Number of elements to convert
- * \param stride [IN]           Stride between each element to convert
+ * \param src_stride [IN]       Stride between each source element, in elements
+ * \param des_stride [IN]       Stride between each target element, in elements
+ * \param mode [IN]             PDC_CONV_CLAMP and/or PDC_CONV_ROUND, or 0
  *
  * \return Non-negative on success/Negative on failure
  */
-perr_t pdc__conv_f_i(float *src_data, int *des_data, size_t nelemt, size_t stride);
+perr_t pdc_type_conv(pdc_var_type_t src_id, pdc_var_type_t des_id, const void *src_data, void *des_data,
+                     size_t nelemt, size_t src_stride, size_t des_stride, int mode);
 
-/**
- * Type conversion function from double to int
- *
- * \param src_data [IN]         A pointer to source data
- * \param des_data [IN]         A pointer to target data
- * \param nelemt [IN]           Number of elements to convert
- * \param stride [IN]           Stride between element
- *
- * \return Non-negative on success/Negative on failure
- */
-perr_t pdc__conv_db_i(double *src_data, int *des_data, size_t nelemt, size_t stride);
+#endif /* PDC_DT_CONV_H */
@@ -1,21 +1,42 @@
 #include "pdc_hist_pkg.h"
 #include "pdc_private.h"
+#include "mercury_thread.h"
 #include <stdio.h>
 #include <stdlib.h>
-
+#include <unistd.h>
+
+#define PDC_HIST_CHUNK               1024    // Elements binned at a time, their bin indices stay in L1
+#define PDC_HIST_NLANE               4       // Copies of the bins, consecutive elements use different copies
+#define PDC_HIST_MIN_ELEM_PER_THREAD 1048576 // Smaller regions are binned by the calling thread
+#define PDC_HIST_MAX_NTHREAD         8
+
+// Part of the data binned by one thread into its own bins
+typedef struct pdc_hist_part_t {
+    const pdc_histogram_t *hist;
+    const void *           data;
+    uint64_t               start;
+    uint64_t               end;
+    uint64_t *             bin; // PDC_HIST_NLANE copies of the nbin bins
+    double                 min;
+    double                 max;
+    hg_thread_t            thread;
+    int                    is_thread;
+} pdc_hist_part_t;
+
+// Strided sample, the sampled elements are read in order and the result does not depend on rand()
 #define MACRO_SAMPLE_MIN_MAX(TYPE, n, data, sample_pct, min, max)                                            \
     ({                                                                                                       \
-        uint64_t i, sample_n, iter = 0;                                                                      \
+        uint64_t i, sample_n, step;                                                                          \
         TYPE *   ldata = (TYPE *)data;                                                                       \
         (min)          = ldata[0];                                                                           \
         (max)          = ldata[0];                                                                           \
         sample_n       = (n) * (sample_pct);                                                                 \
-        for (i = 1; i < sample_n; i++) {                                                                     \
-            iter = (iter + rand()) % (n);                                                                    \
-            if (ldata[iter] > (max))                                                                         \
-                (max) = ldata[iter];                                                                         \
-            else if (ldata[iter] < (min))                                                                    \
-                (min) = ldata[iter];                                                                         \
+        step           = sample_n > 1 ? (n) / sample_n : (n);                                                \
+        for (i = step; i < (n); i += step) {                                                                 \
+            if (ldata[i] > (max))                                                                            \
+                (max) = ldata[i];                                                                            \
+            else if (ldata[i] < (min))                                                                       \
+                (min) = ldata[i];                                                                            \
         }                                                                                                    \
     })
 
@@ -211,36 +232,210 @@ done:
         }                                                                                                    \
     })
 
+// Whether bin k is the first or the last bin, the open ended ones
+#define PDC_HIST_OPEN(k, last) ((uint32_t)(k)-1 >= (last)-1)
+
+/*
+ * The bin indices of a chunk are computed first, without branches so the loop is vectorized: values below
+ * the first or above the last bin edge are selected into the open ended bins and the index is clamped so
+ * it never runs past the last bin. incr is a power of 2, multiplying by its inverse is exact. The bins are
+ * then incremented, consecutive elements in different copies of the bins, and the few elements that fall
+ * in the open ended bins extend the min and max.
+ */
+#define MACRO_HIST_PART(TYPE, part)                                                                          \
+    ({                                                                                                       \
+        const TYPE *ldata = (const TYPE *)(part)->data;                                                      \
+        uint32_t    idx[PDC_HIST_CHUNK], last = (part)->hist->nbin - 1;                                      \
+        uint64_t *  b0 = (part)->bin, *b1 = b0 + last + 1, *b2 = b1 + last + 1, *b3 = b2 + last + 1;         \
+        double      lo = (part)->hist->range[1], hi = (part)->hist->range[last * 2];                         \
+        double      inv = 1.0 / (part)->hist->incr, dlast = last, vmin = lo, vmax = hi, x, t;                \
+        uint64_t    i, j, k, nchunk;                                                                         \
+        for (i = (part)->start; i < (part)->end; i += nchunk) {                                              \
+            nchunk = (part)->end - i < PDC_HIST_CHUNK ? (part)->end - i : PDC_HIST_CHUNK;                    \
+            for (j = 0; j < nchunk; j++) {                                                                   \
+                x      = (double)ldata[i + j];                                                               \
+                t      = (x - lo) * inv + 1.0;                                                               \
+                t      = t < dlast ? t : dlast;                                                              \
+                t      = x >= hi ? dlast : t;                                                                \
+                t      = x < lo ? 0.0 : t;                                                                   \
+                idx[j] = (int32_t)t;                                                                         \
+            }                                                                                                \
+            for (j = 0; j < nchunk; j += PDC_HIST_NLANE) {                                                   \
+                if (j + PDC_HIST_NLANE <= nchunk) {                                                          \
+                    b0[idx[j]]++;                                                                            \
+                    b1[idx[j + 1]]++;                                                                        \
+                    b2[idx[j + 2]]++;                                                                        \
+                    b3[idx[j + 3]]++;                                                                        \
+                    if (!(PDC_HIST_OPEN(idx[j], last) | PDC_HIST_OPEN(idx[j + 1], last) |                    \
+                          PDC_HIST_OPEN(idx[j + 2], last) | PDC_HIST_OPEN(idx[j + 3], last)))                \
+                        continue;                                                                            \
+                }                                                                                            \
+                else {                                                                                       \
+                    for (k = j; k < nchunk; k++)                                                             \
+                        b0[idx[k]]++;                                                                        \
+                }                                                                                            \
+                for (k = j; k < j + PDC_HIST_NLANE && k < nchunk; k++) {                                     \
+                    x    = (double)ldata[i + k];                                                             \
+                    vmin = x < vmin ? x : vmin;                                                              \
+                    vmax = x > vmax ? x : vmax;                                                              \
+                }                                                                                            \
+            }                                                                                                \
+        }                                                                                                    \
+        (part)->min = vmin;                                                                                  \
+        (part)->max = vmax;                                                                                  \
+    })
+
+/*
+ * Bin one part of the data, run by each histogram thread
+ *
+ * \param  arg[IN/OUT]      Part to bin, a pdc_hist_part_t
+ */
+static HG_THREAD_RETURN_TYPE
+PDC_hist_part_thread(void *arg)
+{
+    pdc_hist_part_t *     part = (pdc_hist_part_t *)arg;
+    HG_THREAD_RETURN_TYPE tret = (HG_THREAD_RETURN_TYPE)0;
+
+    if (PDC_INT == part->hist->dtype)
+        MACRO_HIST_PART(int, part);
+    else if (PDC_FLOAT == part->hist->dtype)
+        MACRO_HIST_PART(float, part);
+    else if (PDC_DOUBLE == part->hist->dtype)
+        MACRO_HIST_PART(double, part);
+    else if (PDC_INT64 == part->hist->dtype)
+        MACRO_HIST_PART(int64_t, part);
+    else if (PDC_UINT64 == part->hist->dtype)
+        MACRO_HIST_PART(uint64_t, part);
+    else if (PDC_UINT == part->hist->dtype)
+        MACRO_HIST_PART(uint32_t, part);
+
+    return tret;
+}
+
+/*
+ * Number of threads to bin n elements with, PDC_HIST_NTHREAD or the online cores up to PDC_HIST_MAX_NTHREAD
+ *
+ * \param  n[IN]            Number of elements
+ *
+ * \return Number of threads, at least 1
+ */
+static int
+PDC_hist_nthread(uint64_t n)
+{
+    int   nthread;
+    char *env_str;
+
+    env_str = getenv("PDC_HIST_NTHREAD");
+    if (env_str != NULL)
+        nthread = atoi(env_str);
+    else {
+        nthread = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        if (nthread > PDC_HIST_MAX_NTHREAD)
+            nthread = PDC_HIST_MAX_NTHREAD;
+    }
+    if ((uint64_t)nthread > n / PDC_HIST_MIN_ELEM_PER_THREAD)
+        nthread = (int)(n / PDC_HIST_MIN_ELEM_PER_THREAD);
+
+    return nthread < 1 ? 1 : nthread;
+}
+
 perr_t
-PDC_hist_incr_all(pdc_histogram_t *hist, pdc_var_type_t dtype, uint64_t n, void *data)
+PDC_hist_incr_all_nthread(pdc_histogram_t *hist, pdc_var_type_t dtype, uint64_t n, void *data, int nthread)
 {
-    perr_t ret_value = SUCCEED;
+    perr_t           ret_value = SUCCEED;
+    pdc_hist_part_t *parts     = NULL;
+    uint64_t *       bins      = NULL, per_thread;
+    int              t, b, k, nbin;
 
     FUNC_ENTER(NULL);
 
     if (dtype != hist->dtype || 0 == n || NULL == data)
         return FAIL;
 
-    if (PDC_INT == dtype)
-        MACRO_HIST_INCR_ALL(int, hist, n, data);
-    else if (PDC_FLOAT == dtype)
-        MACRO_HIST_INCR_ALL(float, hist, n, data);
-    else if (PDC_DOUBLE == dtype)
-        MACRO_HIST_INCR_ALL(double, hist, n, data);
-    else if (PDC_INT64 == dtype)
-        MACRO_HIST_INCR_ALL(int64_t, hist, n, data);
-    else if (PDC_UINT64 == dtype)
-        MACRO_HIST_INCR_ALL(uint64_t, hist, n, data);
-    else if (PDC_UINT == dtype)
-        MACRO_HIST_INCR_ALL(uint32_t, hist, n, data);
-    else
+    if (PDC_INT != dtype && PDC_FLOAT != dtype && PDC_DOUBLE != dtype && PDC_INT64 != dtype &&
+        PDC_UINT64 != dtype && PDC_UINT != dtype)
         PGOTO_ERROR(FAIL, "== datatype %d not supported!", dtype);
 
+    // Bins that are not evenly spaced are searched, one element at a time
+    if (hist->incr <= 0) {
+        if (PDC_INT == dtype)
+            MACRO_HIST_INCR_ALL(int, hist, n, data);
+        else if (PDC_FLOAT == dtype)
+            MACRO_HIST_INCR_ALL(float, hist, n, data);
+        else if (PDC_DOUBLE == dtype)
+            MACRO_HIST_INCR_ALL(double, hist, n, data);
+        else if (PDC_INT64 == dtype)
+            MACRO_HIST_INCR_ALL(int64_t, hist, n, data);
+        else if (PDC_UINT64 == dtype)
+            MACRO_HIST_INCR_ALL(uint64_t, hist, n, data);
+        else
+            MACRO_HIST_INCR_ALL(uint32_t, hist, n, data);
+        PGOTO_DONE(SUCCEED);
+    }
+
+    if (nthread <= 0)
+        nthread = PDC_hist_nthread(n);
+    if ((uint64_t)nthread > n)
+        nthread = (int)n;
+
+    nbin  = hist->nbin;
+    parts = (pdc_hist_part_t *)calloc(nthread, sizeof(pdc_hist_part_t));
+    bins  = (uint64_t *)calloc((size_t)nthread * PDC_HIST_NLANE * nbin, sizeof(uint64_t));
+    if (NULL == parts || NULL == bins)
+        PGOTO_ERROR(FAIL, "== error allocating bins of %d threads!", nthread);
+
+    per_thread = n / nthread;
+    for (t = 0; t < nthread; t++) {
+        parts[t].hist  = hist;
+        parts[t].data  = data;
+        parts[t].start = t * per_thread;
+        parts[t].end   = t == nthread - 1 ? n : (t + 1) * per_thread;
+        parts[t].bin   = bins + (size_t)t * PDC_HIST_NLANE * nbin;
+    }
+
+    // The last part, and any part a thread cannot be created for, is binned by the calling thread
+    for (t = 0; t < nthread - 1; t++)
+        parts[t].is_thread =
+            hg_thread_create(&parts[t].thread, PDC_hist_part_thread, &parts[t]) == HG_UTIL_SUCCESS;
+    for (t = 0; t < nthread; t++) {
+        if (!parts[t].is_thread)
+            PDC_hist_part_thread(&parts[t]);
+    }
+    for (t = 0; t < nthread - 1; t++) {
+        if (parts[t].is_thread)
+            hg_thread_join(parts[t].thread);
+    }
+
+    for (t = 0; t < nthread; t++) {
+        for (k = 0; k < PDC_HIST_NLANE; k++) {
+            for (b = 0; b < nbin; b++)
+                hist->bin[b] += parts[t].bin[k * nbin + b];
+        }
+        if (parts[t].min < hist->range[0])
+            hist->range[0] = parts[t].min;
+        if (parts[t].max > hist->range[nbin * 2 - 1])
+            hist->range[nbin * 2 - 1] = parts[t].max;
+    }
+
 done:
+    free(parts);
+    free(bins);
     fflush(stdout);
     FUNC_LEAVE(ret_value);
 }
 
+perr_t
+PDC_hist_incr_all(pdc_histogram_t *hist, pdc_var_type_t dtype, uint64_t n, void *data)
+{
+    perr_t ret_value;
+
+    FUNC_ENTER(NULL);
+
+    ret_value = PDC_hist_incr_all_nthread(hist, dtype, n, data, 0);
+
+    FUNC_LEAVE(ret_value);
+}
+
 pdc_histogram_t *
 PDC_gen_hist(pdc_var_type_t dtype, uint64_t n, void *data)
 {
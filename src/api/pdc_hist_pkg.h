@@ -41,6 +41,21 @@
  */
 pdc_histogram_t *PDC_gen_hist(pdc_var_type_t dtype, uint64_t n, void *data);
 
+/**
+ * Add n elements to the bins of a histogram, and extend its first and last bin to their min and max. The
+ * elements are binned in parts by up to nthread threads, each into its own copy of the bins.
+ *
+ * \param hist [IN]             Histogram to add to
+ * \param dtype [IN]            Data type, same as the histogram
+ * \param n [IN]                Number of elements
+ * \param data [IN]             Elements to add
+ * \param nthread [IN]          Number of threads, 0 or less to use PDC_HIST_NTHREAD or the online cores
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_hist_incr_all_nthread(pdc_histogram_t *hist, pdc_var_type_t dtype, uint64_t n, void *data,
+                                 int nthread);
+
 /**
  * ********
  *
@@ -0,0 +1,358 @@
+/*
+ * Copyright Notice for
+ * Proactive Data Containers (PDC) Software Library and Utilities
+ * -----------------------------------------------------------------------------
+
+ *** Copyright Notice ***
+
+ * Proactive Data Containers (PDC) Copyright (c) 2017, The Regents of the
+ * University of California, through Lawrence Berkeley National Laboratory,
+ * UChicago Argonne, LLC, operator of Argonne National Laboratory, and The HDF
+ * Group (subject to receipt of any required approvals from the U.S. Dept. of
+ * Energy).  All rights reserved.
+
+ * If you have questions about your rights to use or distribute this software,
+ * please contact Berkeley Lab's Innovation & Partnerships Office at  IPO@lbl.gov.
+
+ * NOTICE.  This Software was developed under funding from the U.S. Department of
+ * Energy and the U.S. Government consequently retains certain rights. As such, the
+ * U.S. Government has been granted for itself and others acting on its behalf a
+ * paid-up, nonexclusive, irrevocable, worldwide license in the Software to
+ * reproduce, distribute copies to the public, prepare derivative works, and
+ * perform publicly and display publicly, and to permit other to do so.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "pdc_meta_cache.h"
+#include "pdc_private.h"
+
+typedef struct pdc_meta_cache_entry_t {
+    pdc_metadata_t meta;
+    uint32_t       name_hash;
+    uint64_t       expire_ms;
+
+    // Bucket chains of the two indexes
+    struct pdc_meta_cache_entry_t *name_next;
+    struct pdc_meta_cache_entry_t *id_next;
+
+    // Recently used list, the head is the most recently used
+    struct pdc_meta_cache_entry_t *prev;
+    struct pdc_meta_cache_entry_t *next;
+} pdc_meta_cache_entry_t;
+
+struct pdc_meta_cache_t {
+    pdc_meta_cache_entry_t **name_buckets;
+    pdc_meta_cache_entry_t **id_buckets;
+    uint32_t                 bucket_mask;
+    uint32_t                 capacity;
+    uint32_t                 n_entry;
+    pdc_meta_cache_entry_t * head;
+    pdc_meta_cache_entry_t * tail;
+    uint64_t                 n_hit;
+    uint64_t                 n_miss;
+};
+
+static uint64_t
+pdc_meta_cache_now_ms()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static inline uint32_t
+pdc_meta_cache_name_hash(const char *obj_name, int time_step)
+{
+    // Same key as the server placement of the name
+    return PDC_get_hash_by_name(obj_name) + time_step;
+}
+
+static inline uint32_t
+pdc_meta_cache_id_hash(uint64_t obj_id)
+{
+    obj_id ^= obj_id >> 33;
+    obj_id *= 0xff51afd7ed558ccdULL;
+    obj_id ^= obj_id >> 33;
+    return (uint32_t)obj_id;
+}
+
+static void
+pdc_meta_cache_unlink(pdc_meta_cache_t *cache, pdc_meta_cache_entry_t *entry)
+{
+    pdc_meta_cache_entry_t **pp;
+
+    pp = &cache->name_buckets[entry->name_hash & cache->bucket_mask];
+    while (*pp != entry)
+        pp = &(*pp)->name_next;
+    *pp = entry->name_next;
+
+    pp = &cache->id_buckets[pdc_meta_cache_id_hash(entry->meta.obj_id) & cache->bucket_mask];
+    while (*pp != entry)
+        pp = &(*pp)->id_next;
+    *pp = entry->id_next;
+
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        cache->head = entry->next;
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    else
+        cache->tail = entry->prev;
+
+    cache->n_entry--;
+    free(entry);
+}
+
+static void
+pdc_meta_cache_touch(pdc_meta_cache_t *cache, pdc_meta_cache_entry_t *entry)
+{
+    if (cache->head == entry)
+        return;
+
+    entry->prev->next = entry->next;
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    else
+        cache->tail = entry->prev;
+
+    entry->prev       = NULL;
+    entry->next       = cache->head;
+    cache->head->prev = entry;
+    cache->head       = entry;
+}
+
+static pdc_meta_cache_entry_t *
+pdc_meta_cache_find_name(pdc_meta_cache_t *cache, const char *obj_name, int time_step)
+{
+    pdc_meta_cache_entry_t *entry;
+    uint32_t                hash = pdc_meta_cache_name_hash(obj_name, time_step);
+
+    for (entry = cache->name_buckets[hash & cache->bucket_mask]; entry != NULL; entry = entry->name_next) {
+        if (entry->name_hash == hash && entry->meta.time_step == time_step &&
+            strcmp(entry->meta.obj_name, obj_name) == 0)
+            break;
+    }
+    return entry;
+}
+
+static pdc_meta_cache_entry_t *
+pdc_meta_cache_find_id(pdc_meta_cache_t *cache, uint64_t obj_id)
+{
+    pdc_meta_cache_entry_t *entry;
+
+    for (entry = cache->id_buckets[pdc_meta_cache_id_hash(obj_id) & cache->bucket_mask]; entry != NULL;
+         entry = entry->id_next) {
+        if (entry->meta.obj_id == obj_id)
+            break;
+    }
+    return entry;
+}
+
+// Copy out an entry with a valid lease, expired entries are dropped
+static int
+pdc_meta_cache_hit(pdc_meta_cache_t *cache, pdc_meta_cache_entry_t *entry, pdc_metadata_t *out)
+{
+    if (entry != NULL && entry->expire_ms <= pdc_meta_cache_now_ms()) {
+        pdc_meta_cache_unlink(cache, entry);
+        entry = NULL;
+    }
+    if (entry == NULL) {
+        cache->n_miss++;
+        return 0;
+    }
+
+    pdc_meta_cache_touch(cache, entry);
+    *out = entry->meta;
+    cache->n_hit++;
+    return 1;
+}
+
+pdc_meta_cache_t *
+PDC_meta_cache_new(uint32_t capacity)
+{
+    pdc_meta_cache_t *ret_value = NULL;
+    uint32_t          n_bucket  = 1;
+
+    FUNC_ENTER(NULL);
+
+    if (capacity == 0)
+        PGOTO_DONE(NULL);
+
+    // At most one entry per bucket on average
+    while (n_bucket < capacity)
+        n_bucket <<= 1;
+
+    ret_value = (pdc_meta_cache_t *)calloc(1, sizeof(pdc_meta_cache_t));
+    if (ret_value == NULL)
+        PGOTO_ERROR(NULL, "cannot allocate metadata cache");
+    ret_value->name_buckets = (pdc_meta_cache_entry_t **)calloc(n_bucket, sizeof(pdc_meta_cache_entry_t *));
+    ret_value->id_buckets   = (pdc_meta_cache_entry_t **)calloc(n_bucket, sizeof(pdc_meta_cache_entry_t *));
+    if (ret_value->name_buckets == NULL || ret_value->id_buckets == NULL) {
+        PDC_meta_cache_free(ret_value);
+        PGOTO_ERROR(NULL, "cannot allocate metadata cache buckets");
+    }
+    ret_value->bucket_mask = n_bucket - 1;
+    ret_value->capacity    = capacity;
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+void
+PDC_meta_cache_free(pdc_meta_cache_t *cache)
+{
+    pdc_meta_cache_entry_t *entry, *next;
+
+    FUNC_ENTER(NULL);
+
+    if (cache == NULL)
+        PGOTO_DONE_VOID;
+
+    for (entry = cache->head; entry != NULL; entry = next) {
+        next = entry->next;
+        free(entry);
+    }
+    free(cache->name_buckets);
+    free(cache->id_buckets);
+    free(cache);
+
+done:
+    FUNC_LEAVE_VOID;
+}
+
+void
+PDC_meta_cache_put(pdc_meta_cache_t *cache, const pdc_metadata_t *meta, uint32_t lease_ms)
+{
+    pdc_meta_cache_entry_t *entry;
+    uint32_t                bucket;
+
+    FUNC_ENTER(NULL);
+
+    if (cache == NULL || meta == NULL || meta->obj_name == NULL)
+        PGOTO_DONE_VOID;
+
+    // An object is in the cache at most once under each key
+    PDC_meta_cache_invalidate_name(cache, meta->obj_name, meta->time_step);
+    PDC_meta_cache_invalidate_id(cache, meta->obj_id);
+    if (lease_ms == 0)
+        PGOTO_DONE_VOID;
+
+    if (cache->n_entry >= cache->capacity)
+        pdc_meta_cache_unlink(cache, cache->tail);
+
+    entry = (pdc_meta_cache_entry_t *)malloc(sizeof(pdc_meta_cache_entry_t));
+    if (entry == NULL)
+        PGOTO_DONE_VOID;
+
+    // Strings of the record are interned, only the record itself is copied
+    entry->meta      = *meta;
+    entry->meta.prev = NULL;
+    entry->meta.next = NULL;
+    entry->name_hash = pdc_meta_cache_name_hash(meta->obj_name, meta->time_step);
+    entry->expire_ms = pdc_meta_cache_now_ms() + lease_ms;
+
+    bucket                      = entry->name_hash & cache->bucket_mask;
+    entry->name_next            = cache->name_buckets[bucket];
+    cache->name_buckets[bucket] = entry;
+
+    bucket                    = pdc_meta_cache_id_hash(meta->obj_id) & cache->bucket_mask;
+    entry->id_next            = cache->id_buckets[bucket];
+    cache->id_buckets[bucket] = entry;
+
+    entry->prev = NULL;
+    entry->next = cache->head;
+    if (cache->head)
+        cache->head->prev = entry;
+    else
+        cache->tail = entry;
+    cache->head = entry;
+    cache->n_entry++;
+
+done:
+    FUNC_LEAVE_VOID;
+}
+
+int
+PDC_meta_cache_get_by_name(pdc_meta_cache_t *cache, const char *obj_name, int time_step,
+                           pdc_metadata_t *out)
+{
+    int ret_value = 0;
+
+    FUNC_ENTER(NULL);
+
+    if (cache == NULL || obj_name == NULL)
+        PGOTO_DONE(0);
+
+    ret_value = pdc_meta_cache_hit(cache, pdc_meta_cache_find_name(cache, obj_name, time_step), out);
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+int
+PDC_meta_cache_get_by_id(pdc_meta_cache_t *cache, uint64_t obj_id, pdc_metadata_t *out)
+{
+    int ret_value = 0;
+
+    FUNC_ENTER(NULL);
+
+    if (cache == NULL)
+        PGOTO_DONE(0);
+
+    ret_value = pdc_meta_cache_hit(cache, pdc_meta_cache_find_id(cache, obj_id), out);
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+void
+PDC_meta_cache_invalidate_name(pdc_meta_cache_t *cache, const char *obj_name, int time_step)
+{
+    pdc_meta_cache_entry_t *entry;
+
+    FUNC_ENTER(NULL);
+
+    if (cache == NULL || obj_name == NULL)
+        PGOTO_DONE_VOID;
+
+    entry = pdc_meta_cache_find_name(cache, obj_name, time_step);
+    if (entry != NULL)
+        pdc_meta_cache_unlink(cache, entry);
+
+done:
+    FUNC_LEAVE_VOID;
+}
+
+void
+PDC_meta_cache_invalidate_id(pdc_meta_cache_t *cache, uint64_t obj_id)
+{
+    pdc_meta_cache_entry_t *entry;
+
+    FUNC_ENTER(NULL);
+
+    if (cache == NULL)
+        PGOTO_DONE_VOID;
+
+    entry = pdc_meta_cache_find_id(cache, obj_id);
+    if (entry != NULL)
+        pdc_meta_cache_unlink(cache, entry);
+
+done:
+    FUNC_LEAVE_VOID;
+}
+
+void
+PDC_meta_cache_stats(pdc_meta_cache_t *cache, uint64_t *n_hit, uint64_t *n_miss)
+{
+    FUNC_ENTER(NULL);
+
+    *n_hit  = cache == NULL ? 0 : cache->n_hit;
+    *n_miss = cache == NULL ? 0 : cache->n_miss;
+
+    FUNC_LEAVE_VOID;
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright Notice for
+ * Proactive Data Containers (PDC) Software Library and Utilities
+ * -----------------------------------------------------------------------------
+
+ *** Copyright Notice ***
+
+ * Proactive Data Containers (PDC) Copyright (c) 2017, The Regents of the
+ * University of California, through Lawrence Berkeley National Laboratory,
+ * UChicago Argonne, LLC, operator of Argonne National Laboratory, and The HDF
+ * Group (subject to receipt of any required approvals from the U.S. Dept. of
+ * Energy).  All rights reserved.
+
+ * If you have questions about your rights to use or distribute this software,
+ * please contact Berkeley Lab's Innovation & Partnerships Office at  IPO@lbl.gov.
+
+ * NOTICE.  This Software was developed under funding from the U.S. Department of
+ * Energy and the U.S. Government consequently retains certain rights. As such, the
+ * U.S. Government has been granted for itself and others acting on its behalf a
+ * paid-up, nonexclusive, irrevocable, worldwide license in the Software to
+ * reproduce, distribute copies to the public, prepare derivative works, and
+ * perform publicly and display publicly, and to permit other to do so.
+ */
+
+#ifndef PDC_META_CACHE_H
+#define PDC_META_CACHE_H
+
+#include "pdc_client_server_common.h"
+
+/*
+ * Client cache of object metadata, indexed by name and time step and by object ID. Each entry holds a
+ * lease granted by the metadata server with the query result, and is not used after the lease
+ * expires. The least recently used entry is evicted once the cache is full.
+ */
+#define PDC_META_CACHE_CAPACITY 4096
+
+typedef struct pdc_meta_cache_t pdc_meta_cache_t;
+
+/**
+ * Create an empty metadata cache
+ *
+ * \param capacity [IN]         Maximum number of cached objects
+ *
+ * \return Pointer to the cache on success/NULL on failure
+ */
+pdc_meta_cache_t *PDC_meta_cache_new(uint32_t capacity);
+
+/**
+ * Free a metadata cache
+ *
+ * \param cache [IN]            Pointer to the cache
+ */
+void PDC_meta_cache_free(pdc_meta_cache_t *cache);
+
+/**
+ * Add the metadata of an object to a cache, replacing its previous entry
+ *
+ * \param cache [IN]            Pointer to the cache
+ * \param meta [IN]             Pointer to the metadata, the record is copied
+ * \param lease_ms [IN]         Lease granted by the server in milliseconds, 0 to not cache the object
+ */
+void PDC_meta_cache_put(pdc_meta_cache_t *cache, const pdc_metadata_t *meta, uint32_t lease_ms);
+
+/**
+ * Look up the metadata of an object by its name and time step
+ *
+ * \param cache [IN]            Pointer to the cache
+ * \param obj_name [IN]         Name of the object
+ * \param time_step [IN]        Time step of the object
+ * \param out [OUT]             Copy of the cached metadata
+ *
+ * \return 1 if the object is cached with a valid lease/0 otherwise
+ */
+int PDC_meta_cache_get_by_name(pdc_meta_cache_t *cache, const char *obj_name, int time_step,
+                               pdc_metadata_t *out);
+
+/**
+ * Look up the metadata of an object by its ID
+ *
+ * \param cache [IN]            Pointer to the cache
+ * \param obj_id [IN]           Metadata ID of the object
+ * \param out [OUT]             Copy of the cached metadata
+ *
+ * \return 1 if the object is cached with a valid lease/0 otherwise
+ */
+int PDC_meta_cache_get_by_id(pdc_meta_cache_t *cache, uint64_t obj_id, pdc_metadata_t *out);
+
+/**
+ * Drop the entry of an object by its name and time step
+ *
+ * \param cache [IN]            Pointer to the cache
+ * \param obj_name [IN]         Name of the object
+ * \param time_step [IN]        Time step of the object
+ */
+void PDC_meta_cache_invalidate_name(pdc_meta_cache_t *cache, const char *obj_name, int time_step);
+
+/**
+ * Drop the entry of an object by its ID
+ *
+ * \param cache [IN]            Pointer to the cache
+ * \param obj_id [IN]           Metadata ID of the object
+ */
+void PDC_meta_cache_invalidate_id(pdc_meta_cache_t *cache, uint64_t obj_id);
+
+/**
+ * Get the lookup statistics of a cache
+ *
+ * \param cache [IN]            Pointer to the cache
+ * \param n_hit [OUT]           Number of lookups served by the cache
+ * \param n_miss [OUT]          Number of lookups not cached or with an expired lease
+ */
+void PDC_meta_cache_stats(pdc_meta_cache_t *cache, uint64_t *n_hit, uint64_t *n_miss);
+
+#endif /* PDC_META_CACHE_H */
@@ -39,6 +39,8 @@
 #include <unistd.h>
 
 static perr_t PDC_obj_close(struct _pdc_obj_info *op);
+static pdcid_t PDC_obj_create_global(pdcid_t cont_id, const char *obj_name, pdcid_t obj_prop_id,
+                                     uint64_t obj_meta_id);
 
 perr_t
 PDC_obj_init()
@@ -58,6 +60,76 @@ done:
 
 pdcid_t
 PDCobj_create(pdcid_t cont_id, const char *obj_name, pdcid_t obj_prop_id)
+{
+    pdcid_t ret_value;
+
+    FUNC_ENTER(NULL);
+
+    ret_value = PDC_obj_create_global(cont_id, obj_name, obj_prop_id, 0);
+
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDCobj_create_batch(pdcid_t cont_id, int n_obj, const char **obj_names, pdcid_t obj_prop_id,
+                    pdcid_t *obj_ids)
+{
+    perr_t                 ret_value    = SUCCEED;
+    uint64_t               cont_meta_id = 0;
+    pdcid_t *              meta_ids     = NULL;
+    struct _pdc_id_info *  id_info      = NULL;
+    struct _pdc_cont_info *cont_info;
+    int                    i;
+
+    FUNC_ENTER(NULL);
+
+    if (n_obj <= 0)
+        PGOTO_DONE(SUCCEED);
+    if (obj_names == NULL || obj_ids == NULL)
+        PGOTO_ERROR(FAIL, "invalid input");
+
+    if (cont_id != 0) {
+        id_info = PDC_find_id(cont_id);
+        if (id_info == NULL)
+            PGOTO_ERROR(FAIL, "cannot locate container ID");
+        cont_info    = (struct _pdc_cont_info *)(id_info->obj_ptr);
+        cont_meta_id = cont_info->cont_info_pub->meta_id;
+    }
+
+    meta_ids = (pdcid_t *)malloc(sizeof(pdcid_t) * n_obj);
+    if (meta_ids == NULL)
+        PGOTO_ERROR(FAIL, "PDC object ID memory allocation failed");
+
+    // One request to each metadata server, objects not created get a zero ID
+    ret_value = PDC_Client_send_names_recv_ids(n_obj, obj_names, cont_meta_id, obj_prop_id, meta_ids);
+    for (i = 0; i < n_obj; i++) {
+        obj_ids[i] = 0;
+        if (meta_ids[i] == 0)
+            continue;
+        obj_ids[i] = PDC_obj_create_global(cont_id, obj_names[i], obj_prop_id, meta_ids[i]);
+        if (obj_ids[i] == 0)
+            ret_value = FAIL;
+    }
+
+done:
+    fflush(stdout);
+    free(meta_ids);
+
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Create the local object of a global object
+ *
+ * \param  cont_id[IN]          ID of the container
+ * \param  obj_name[IN]         Name of the object
+ * \param  obj_prop_id[IN]      ID of the object property
+ * \param  obj_meta_id[IN]      Metadata ID of an object already created on the server, 0 to create it
+ *
+ * \return Object id on success/Zero on failure
+ */
+static pdcid_t
+PDC_obj_create_global(pdcid_t cont_id, const char *obj_name, pdcid_t obj_prop_id, uint64_t obj_meta_id)
 {
     uint64_t               meta_id;
     pdcid_t                ret_value = 0;
@@ -150,9 +222,13 @@ PDCobj_create(pdcid_t cont_id, const char *obj_name, pdcid_t obj_prop_id)
     p->obj_info_pub->name      = strdup(obj_name);
     p->obj_info_pub->server_id = 0;
     p->obj_info_pub->local_id  = PDC_id_register(PDC_OBJ, p);
-    ret = PDC_Client_send_name_recv_id(obj_name, meta_id, obj_prop_id, &(p->obj_info_pub->meta_id));
-    if (ret == FAIL)
-        PGOTO_ERROR(0, "Unable to create object on server!");
+    if (obj_meta_id != 0)
+        p->obj_info_pub->meta_id = obj_meta_id;
+    else {
+        ret = PDC_Client_send_name_recv_id(obj_name, meta_id, obj_prop_id, &(p->obj_info_pub->meta_id));
+        if (ret == FAIL)
+            PGOTO_ERROR(0, "Unable to create object on server!");
+    }
 
     p->obj_info_pub->obj_pt = PDC_CALLOC(struct pdc_obj_prop);
     if (!p->obj_info_pub->obj_pt)
@@ -462,6 +538,12 @@ PDCobj_open_common(const char *obj_name, pdcid_t pdc, int is_col)
     p->obj_pt->obj_prop_pub->type = out->data_type;
     p->obj_pt->time_step          = out->time_step;
     p->obj_pt->user_id            = out->user_id;
+    p->obj_pt->stripe_size        = out->stripe_size;
+    p->obj_pt->stripe_count       = out->stripe_count;
+    p->obj_pt->compress           = (pdc_compress_t)out->compress;
+    p->obj_pt->compress_level     = out->compress_level;
+    p->obj_pt->error_bound_mode   = (pdc_error_bound_t)out->error_bound_mode;
+    p->obj_pt->error_bound        = out->error_bound;
 
     if (out->transform_state > 0) {
         p->obj_pt->locus                        = SERVER_MEMORY;
@@ -728,6 +810,81 @@ done:
     FUNC_LEAVE(ret_value);
 }
 
+perr_t
+PDCprop_set_obj_stripe(pdcid_t obj_prop, uint64_t stripe_size, uint32_t stripe_count)
+{
+    perr_t                ret_value = SUCCEED;
+    struct _pdc_id_info * info;
+    struct _pdc_obj_prop *prop;
+
+    FUNC_ENTER(NULL);
+
+    if (stripe_count > 0 && stripe_size == 0)
+        PGOTO_ERROR(FAIL, "stripe size must be positive");
+
+    info = PDC_find_id(obj_prop);
+    if (info == NULL)
+        PGOTO_ERROR(FAIL, "cannot locate object property ID");
+    prop               = (struct _pdc_obj_prop *)(info->obj_ptr);
+    prop->stripe_size  = stripe_size;
+    prop->stripe_count = stripe_count;
+
+done:
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDCprop_set_obj_compress(pdcid_t obj_prop, pdc_compress_t compress, int level)
+{
+    perr_t                ret_value = SUCCEED;
+    struct _pdc_id_info * info;
+    struct _pdc_obj_prop *prop;
+
+    FUNC_ENTER(NULL);
+
+    if (compress < PDC_COMPRESS_NONE || compress > PDC_COMPRESS_ZSTD)
+        PGOTO_ERROR(FAIL, "unknown lossless compression codec %d", compress);
+
+    info = PDC_find_id(obj_prop);
+    if (info == NULL)
+        PGOTO_ERROR(FAIL, "cannot locate object property ID");
+    prop                 = (struct _pdc_obj_prop *)(info->obj_ptr);
+    prop->compress       = compress;
+    prop->compress_level = level;
+
+done:
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDCprop_set_obj_error_bound(pdcid_t obj_prop, pdc_error_bound_t mode, double bound)
+{
+    perr_t                ret_value = SUCCEED;
+    struct _pdc_id_info * info;
+    struct _pdc_obj_prop *prop;
+
+    FUNC_ENTER(NULL);
+
+    if (mode != PDC_ERROR_BOUND_ABS && mode != PDC_ERROR_BOUND_REL)
+        PGOTO_ERROR(FAIL, "unknown error bound mode %d", mode);
+    if (!(bound > 0))
+        PGOTO_ERROR(FAIL, "error bound has to be positive");
+
+    info = PDC_find_id(obj_prop);
+    if (info == NULL)
+        PGOTO_ERROR(FAIL, "cannot locate object property ID");
+    prop                   = (struct _pdc_obj_prop *)(info->obj_ptr);
+    prop->compress         = PDC_COMPRESS_LOSSY;
+    prop->error_bound_mode = mode;
+    prop->error_bound      = bound;
+
+done:
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
+
 perr_t
 PDCprop_set_obj_type(pdcid_t obj_prop, pdc_var_type_t type)
 {
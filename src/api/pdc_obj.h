@@ -26,6 +26,7 @@
 #define PDC_OBJ_H
 
 #include "pdc_public.h"
+#include "pdc_sketch.h"
 
 /*******************/
 /* Public Typedefs */
@@ -60,6 +61,21 @@ struct pdc_obj_info {
  */
 pdcid_t PDCobj_create(pdcid_t cont_id, const char *obj_name, pdcid_t obj_create_prop);
 
+/**
+ * Create a batch of objects that share one object property, with one request to each metadata server
+ *
+ * \param cont_id [IN]          ID of the container
+ * \param n_obj [IN]            Number of objects
+ * \param obj_names [IN]        Names of the objects
+ * \param obj_create_prop [IN]  ID of object property,
+ *                              returned by PDCprop_create(PDC_OBJ_CREATE)
+ * \param obj_ids [OUT]         Object ids in the order of the names, zero for an object not created
+ *
+ * \return Non-negative on success/Negative if any object is not created
+ */
+perr_t PDCobj_create_batch(pdcid_t cont_id, int n_obj, const char **obj_names, pdcid_t obj_create_prop,
+                           pdcid_t *obj_ids);
+
 /**
  * Open an object within a container
  *
@@ -185,6 +201,44 @@ perr_t PDCprop_set_obj_tags(pdcid_t obj_prop, char *tags);
  */
 perr_t PDCprop_set_obj_dims(pdcid_t obj_prop, PDC_int_t ndim, uint64_t *dims);
 
+/**
+ * Stripe the object data round-robin across data servers
+ *
+ * \param obj_prop [IN]         ID of object property, returned by PDCprop_create(PDC_OBJ_CREATE)
+ * \param stripe_size [IN]      Number of bytes in each stripe, rounded down to whole slices of the first
+ *                              dimension
+ * \param stripe_count [IN]     Number of data servers to stripe across, 0 to not stripe the object
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDCprop_set_obj_stripe(pdcid_t obj_prop, uint64_t stripe_size, uint32_t stripe_count);
+
+/**
+ * Compress the object data in the server storage, the servers decompress it transparently on read
+ *
+ * \param obj_prop [IN]         ID of object property, returned by PDCprop_create(PDC_OBJ_CREATE)
+ * \param compress [IN]         Codec, PDC_COMPRESS_AUTO lets the server choose the codec and shuffle per
+ *                              region, PDC_COMPRESS_NONE to not compress the object
+ * \param level [IN]            Compression level of Zstandard, 0 for the default fast level
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDCprop_set_obj_compress(pdcid_t obj_prop, pdc_compress_t compress, int level);
+
+/**
+ * Compress the object data in the server storage with the error-bounded lossy codec. Every value read
+ * back is within the bound of the value written. Only objects of PDC_FLOAT or PDC_DOUBLE are compressed
+ * lossily, the servers compress other types losslessly.
+ *
+ * \param obj_prop [IN]         ID of object property, returned by PDCprop_create(PDC_OBJ_CREATE)
+ * \param mode [IN]             PDC_ERROR_BOUND_ABS for an absolute bound, PDC_ERROR_BOUND_REL for a bound
+ *                              relative to the value range of each region
+ * \param bound [IN]            Error bound, positive
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDCprop_set_obj_error_bound(pdcid_t obj_prop, pdc_error_bound_t mode, double bound);
+
 /**
  * Set object type
  *
@@ -334,4 +388,15 @@ perr_t PDCobj_get_tag(pdcid_t obj_id, char *tag_name, void **tag_value, psize_t
  */
 perr_t PDCobj_del_tag(pdcid_t obj_id, char *tag_name);
 
+/**
+ * Get the statistics of an object, merged by its metadata server from the sketches of the regions that
+ * were written while the data servers had PDC_GEN_SKETCH set
+ *
+ * \param obj_id [IN]           Object ID
+ * \param stats [OUT]           Sketch of all the values of the object, freed with PDC_sketch_free()
+ *
+ * \return Non-negative on success/Negative on failure, also when no region of the object has a sketch
+ */
+perr_t PDCobj_get_stats(pdcid_t obj_id, pdc_sketch_t **stats);
+
 #endif /* PDC_OBJ_H */
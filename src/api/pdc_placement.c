@@ -0,0 +1,271 @@
+/*
+ * Copyright Notice for
+ * Proactive Data Containers (PDC) Software Library and Utilities
+ * -----------------------------------------------------------------------------
+
+ *** Copyright Notice ***
+
+ * Proactive Data Containers (PDC) Copyright (c) 2017, The Regents of the
+ * University of California, through Lawrence Berkeley National Laboratory,
+ * UChicago Argonne, LLC, operator of Argonne National Laboratory, and The HDF
+ * Group (subject to receipt of any required approvals from the U.S. Dept. of
+ * Energy).  All rights reserved.
+
+ * If you have questions about your rights to use or distribute this software,
+ * please contact Berkeley Lab's Innovation & Partnerships Office at  IPO@lbl.gov.
+
+ * NOTICE.  This Software was developed under funding from the U.S. Department of
+ * Energy and the U.S. Government consequently retains certain rights. As such, the
+ * U.S. Government has been granted for itself and others acting on its behalf a
+ * paid-up, nonexclusive, irrevocable, worldwide license in the Software to
+ * reproduce, distribute copies to the public, prepare derivative works, and
+ * perform publicly and display publicly, and to permit other to do so.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pdc_placement.h"
+#include "pdc_private.h"
+
+// A virtual node owns the keys from the point of the previous virtual node on the ring up to its own point
+typedef struct pdc_placement_vnode_t {
+    uint32_t point;
+    uint32_t server_id;
+} pdc_placement_vnode_t;
+
+static pdc_placement_method_t pdc_placement_method_g  = PDC_PLACEMENT_MODULO;
+static int                    pdc_placement_nserver_g = 0;
+static int                    pdc_placement_nvnode_g  = 0;
+static pdc_placement_vnode_t *pdc_placement_ring_g    = NULL;
+static double *               pdc_placement_weights_g = NULL;
+
+// Finalizer of MurmurHash3, spreads the poorly mixed name hashes and vnode numbers over the ring
+static inline uint32_t
+pdc_placement_mix(uint32_t h)
+{
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+static int
+pdc_placement_vnode_cmp(const void *a, const void *b)
+{
+    const pdc_placement_vnode_t *va = (const pdc_placement_vnode_t *)a;
+    const pdc_placement_vnode_t *vb = (const pdc_placement_vnode_t *)b;
+
+    if (va->point != vb->point)
+        return va->point < vb->point ? -1 : 1;
+    if (va->server_id != vb->server_id)
+        return va->server_id < vb->server_id ? -1 : 1;
+    return 0;
+}
+
+void
+PDC_placement_finalize()
+{
+    FUNC_ENTER(NULL);
+
+    free(pdc_placement_ring_g);
+    free(pdc_placement_weights_g);
+    pdc_placement_ring_g    = NULL;
+    pdc_placement_weights_g = NULL;
+    pdc_placement_nvnode_g  = 0;
+    pdc_placement_nserver_g = 0;
+    pdc_placement_method_g  = PDC_PLACEMENT_MODULO;
+
+    FUNC_LEAVE_VOID;
+}
+
+perr_t
+PDC_placement_init(int n_server, pdc_placement_method_t method, int n_vnode, const double *weights)
+{
+    perr_t ret_value    = SUCCEED;
+    double total_weight = 0;
+    int    i, v, n, nvnode = 0;
+
+    FUNC_ENTER(NULL);
+
+    PDC_placement_finalize();
+
+    if (n_server <= 0 || n_vnode <= 0)
+        PGOTO_ERROR(FAIL, "==PDC: invalid placement of %d servers with %d vnodes", n_server, n_vnode);
+
+    pdc_placement_weights_g = (double *)malloc(sizeof(double) * n_server);
+    if (pdc_placement_weights_g == NULL)
+        PGOTO_ERROR(FAIL, "==PDC: ERROR allocating placement weights");
+    for (i = 0; i < n_server; i++) {
+        pdc_placement_weights_g[i] = (weights == NULL || weights[i] < 0) ? 1.0 : weights[i];
+        total_weight += pdc_placement_weights_g[i];
+    }
+    if (total_weight <= 0) {
+        for (i = 0; i < n_server; i++)
+            pdc_placement_weights_g[i] = 1.0;
+        total_weight = n_server;
+    }
+
+    if (method == PDC_PLACEMENT_CHASH) {
+        // Each server gets virtual nodes in proportion to its weight, at points that only depend on the
+        // server and vnode number, so adding or removing a server only moves the keys of its own arcs
+        for (i = 0; i < n_server; i++)
+            nvnode += (int)(pdc_placement_weights_g[i] * n_vnode + 0.5);
+        if (nvnode == 0)
+            PGOTO_ERROR(FAIL, "==PDC: placement weights leave no virtual nodes");
+        pdc_placement_ring_g = (pdc_placement_vnode_t *)malloc(sizeof(pdc_placement_vnode_t) * nvnode);
+        if (pdc_placement_ring_g == NULL)
+            PGOTO_ERROR(FAIL, "==PDC: ERROR allocating placement ring");
+
+        nvnode = 0;
+        for (i = 0; i < n_server; i++) {
+            n = (int)(pdc_placement_weights_g[i] * n_vnode + 0.5);
+            for (v = 0; v < n; v++) {
+                pdc_placement_ring_g[nvnode].point =
+                    pdc_placement_mix((uint32_t)i * 2654435761U + pdc_placement_mix((uint32_t)v + 1));
+                pdc_placement_ring_g[nvnode].server_id = i;
+                nvnode++;
+            }
+        }
+        qsort(pdc_placement_ring_g, nvnode, sizeof(pdc_placement_vnode_t), pdc_placement_vnode_cmp);
+    }
+
+    pdc_placement_method_g  = method;
+    pdc_placement_nserver_g = n_server;
+    pdc_placement_nvnode_g  = nvnode;
+
+done:
+    if (ret_value != SUCCEED)
+        PDC_placement_finalize();
+
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDC_placement_init_env(int n_server)
+{
+    perr_t                 ret_value = SUCCEED;
+    pdc_placement_method_t method    = PDC_PLACEMENT_CHASH;
+    int                    n_vnode   = PDC_PLACEMENT_DEFAULT_VNODES, i;
+    double *               weights   = NULL;
+    char *                 env_str, *ptr, *end;
+
+    FUNC_ENTER(NULL);
+
+    env_str = getenv("PDC_PLACEMENT");
+    if (env_str != NULL && strcmp(env_str, "MODULO") == 0)
+        method = PDC_PLACEMENT_MODULO;
+
+    env_str = getenv("PDC_PLACEMENT_VNODES");
+    if (env_str != NULL && atoi(env_str) > 0)
+        n_vnode = atoi(env_str);
+
+    env_str = getenv("PDC_PLACEMENT_WEIGHTS");
+    if (env_str != NULL && n_server > 0) {
+        weights = (double *)malloc(sizeof(double) * n_server);
+        if (weights == NULL)
+            PGOTO_ERROR(FAIL, "==PDC: ERROR allocating placement weights");
+        // Servers missing from the list have weight 1
+        ptr = env_str;
+        for (i = 0; i < n_server; i++) {
+            weights[i] = strtod(ptr, &end);
+            if (end == ptr)
+                weights[i] = 1.0;
+            ptr = end;
+            while (*ptr == ',' || *ptr == ' ')
+                ptr++;
+        }
+    }
+
+    ret_value = PDC_placement_init(n_server, method, n_vnode, weights);
+
+done:
+    free(weights);
+
+    FUNC_LEAVE(ret_value);
+}
+
+uint32_t
+PDC_placement_get_server(uint32_t key, int n_server)
+{
+    uint32_t ret_value = 0;
+    uint32_t point;
+    int      lo, hi, mid;
+
+    FUNC_ENTER(NULL);
+
+    if (pdc_placement_method_g != PDC_PLACEMENT_CHASH || pdc_placement_nserver_g != n_server) {
+        ret_value = key % n_server;
+        goto done;
+    }
+
+    // First virtual node at or after the key point, wrapping around the ring
+    point = pdc_placement_mix(key);
+    lo    = 0;
+    hi    = pdc_placement_nvnode_g;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (pdc_placement_ring_g[mid].point < point)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == pdc_placement_nvnode_g)
+        lo = 0;
+    ret_value = pdc_placement_ring_g[lo].server_id;
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+uint32_t
+PDC_placement_get_local_server(int my_rank, int n_client_per_server, int n_server)
+{
+    uint32_t ret_value = 0;
+
+    FUNC_ENTER(NULL);
+
+    ret_value = (my_rank / n_client_per_server) % n_server;
+
+    // A server with no weight takes no new load, its clients spread over the others
+    if (pdc_placement_nserver_g == n_server && pdc_placement_weights_g[ret_value] == 0 &&
+        pdc_placement_method_g == PDC_PLACEMENT_CHASH)
+        ret_value = PDC_placement_get_server((uint32_t)my_rank, n_server);
+
+    FUNC_LEAVE(ret_value);
+}
+
+double
+PDC_placement_get_share(int server_id)
+{
+    double   ret_value = 0;
+    uint64_t arc;
+    int      i;
+
+    FUNC_ENTER(NULL);
+
+    if (server_id < 0 || pdc_placement_nserver_g == 0 || server_id >= pdc_placement_nserver_g)
+        goto done;
+
+    if (pdc_placement_method_g != PDC_PLACEMENT_CHASH) {
+        ret_value = 1.0 / pdc_placement_nserver_g;
+        goto done;
+    }
+
+    // Sum the arcs ending at the virtual nodes of the server, the first one wraps around from the last
+    for (i = 0; i < pdc_placement_nvnode_g; i++) {
+        if (pdc_placement_ring_g[i].server_id != (uint32_t)server_id)
+            continue;
+        if (i == 0)
+            arc = (uint64_t)pdc_placement_ring_g[0].point + 1 +
+                  (0xFFFFFFFFULL - pdc_placement_ring_g[pdc_placement_nvnode_g - 1].point);
+        else
+            arc = pdc_placement_ring_g[i].point - pdc_placement_ring_g[i - 1].point;
+        ret_value += (double)arc / 4294967296.0;
+    }
+
+done:
+    FUNC_LEAVE(ret_value);
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright Notice for
+ * Proactive Data Containers (PDC) Software Library and Utilities
+ * -----------------------------------------------------------------------------
+
+ *** Copyright Notice ***
+
+ * Proactive Data Containers (PDC) Copyright (c) 2017, The Regents of the
+ * University of California, through Lawrence Berkeley National Laboratory,
+ * UChicago Argonne, LLC, operator of Argonne National Laboratory, and The HDF
+ * Group (subject to receipt of any required approvals from the U.S. Dept. of
+ * Energy).  All rights reserved.
+
+ * If you have questions about your rights to use or distribute this software,
+ * please contact Berkeley Lab's Innovation & Partnerships Office at  IPO@lbl.gov.
+
+ * NOTICE.  This Software was developed under funding from the U.S. Department of
+ * Energy and the U.S. Government consequently retains certain rights. As such, the
+ * U.S. Government has been granted for itself and others acting on its behalf a
+ * paid-up, nonexclusive, irrevocable, worldwide license in the Software to
+ * reproduce, distribute copies to the public, prepare derivative works, and
+ * perform publicly and display publicly, and to permit other to do so.
+ */
+
+#ifndef PDC_PLACEMENT_H
+#define PDC_PLACEMENT_H
+
+#include "pdc_public.h"
+
+/*
+ * Placement of object metadata across servers, used by every client and server routing decision on a
+ * name hash. Clients and servers must set it up the same way, which PDC_placement_init_env() does from
+ * the environment. An object ID encodes the server that created it, so routing by ID is not affected.
+ */
+typedef enum {
+    PDC_PLACEMENT_MODULO = 0, /* key hash modulo the number of servers */
+    PDC_PLACEMENT_CHASH  = 1  /* consistent hashing with virtual nodes */
+} pdc_placement_method_t;
+
+#define PDC_PLACEMENT_DEFAULT_VNODES 128
+
+/**
+ * Set up the placement, replacing any previous one
+ *
+ * \param n_server [IN]         Number of servers
+ * \param method [IN]           Placement method
+ * \param n_vnode [IN]          Virtual nodes of a server with weight 1, for consistent hashing
+ * \param weights [IN]          Relative capacity of each server, NULL for equal capacity
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_placement_init(int n_server, pdc_placement_method_t method, int n_vnode, const double *weights);
+
+/**
+ * Set up the placement from PDC_PLACEMENT (CHASH or MODULO), PDC_PLACEMENT_VNODES and
+ * PDC_PLACEMENT_WEIGHTS, a comma separated list of the relative capacity of each server
+ *
+ * \param n_server [IN]         Number of servers
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_placement_init_env(int n_server);
+
+/**
+ * Release the placement
+ */
+void PDC_placement_finalize();
+
+/**
+ * Get the server of a key hash, by modulo if the placement is not set up for n_server
+ *
+ * \param key [IN]              Key hash
+ * \param n_server [IN]         Number of servers
+ *
+ * \return Server ID
+ */
+uint32_t PDC_placement_get_server(uint32_t key, int n_server);
+
+/**
+ * Get the data server of a client, its node local server unless that server has weight 0 in the placement
+ *
+ * \param my_rank [IN]          Client MPI rank
+ * \param n_client_per_server [IN] Number of clients per server
+ * \param n_server [IN]         Number of servers
+ *
+ * \return Server ID
+ */
+uint32_t PDC_placement_get_local_server(int my_rank, int n_client_per_server, int n_server);
+
+/**
+ * Get the share of the key space placed on a server
+ *
+ * \param server_id [IN]        Server ID
+ *
+ * \return Fraction of the key space in [0, 1]
+ */
+double PDC_placement_get_share(int server_id);
+
+#endif /* PDC_PLACEMENT_H */
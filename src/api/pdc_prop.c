@@ -99,6 +99,12 @@ PDCprop_create(pdc_prop_type_t type, pdcid_t pdcid)
         q->time_step                 = 0;
         q->tags                      = NULL;
         q->buf                       = NULL;
+        q->stripe_size               = 0;
+        q->stripe_count              = 0;
+        q->compress                  = PDC_COMPRESS_NONE;
+        q->compress_level            = 0;
+        q->error_bound_mode          = PDC_ERROR_BOUND_ABS;
+        q->error_bound               = 0;
         new_id_o                     = PDC_id_register(PDC_OBJ_PROP, q);
         q->obj_prop_pub->obj_prop_id = new_id_o;
         id_info                      = PDC_find_id(pdcid);
@@ -147,8 +153,14 @@ PDCprop_obj_dup(pdcid_t prop_id)
     q->time_step = info->time_step;
     if (info->tags)
         q->tags = strdup(info->tags);
-    q->data_loc = NULL;
-    q->buf      = NULL;
+    q->data_loc         = NULL;
+    q->buf              = NULL;
+    q->stripe_size      = info->stripe_size;
+    q->stripe_count     = info->stripe_count;
+    q->compress         = info->compress;
+    q->compress_level   = info->compress_level;
+    q->error_bound_mode = info->error_bound_mode;
+    q->error_bound      = info->error_bound;
 
     /* struct obj_prop_pub field */
     q->obj_prop_pub = PDC_MALLOC(struct pdc_obj_prop);
@@ -61,6 +61,17 @@ struct _pdc_obj_prop {
     void *               buf;
     pdc_kvtag_t *        kvtag;
 
+    /* Striping of the object data across data servers, stripe_count is 0 if not striped */
+    uint64_t stripe_size;
+    uint32_t stripe_count;
+
+    /* Compression of the object data in the server storage, PDC_COMPRESS_NONE if not compressed. For
+       PDC_COMPRESS_LOSSY, error_bound_mode tells how error_bound bounds the error */
+    pdc_compress_t    compress;
+    int32_t           compress_level;
+    pdc_error_bound_t error_bound_mode;
+    double            error_bound;
+
     /* The following have been added to support of PDC analysis and transforms */
     size_t                      type_extent;
     uint64_t                    locus;
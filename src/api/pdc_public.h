@@ -58,6 +58,19 @@ typedef enum {
     NCLASSES     = 12 /* this must be last                          */
 } pdc_var_type_t;
 
+typedef enum {
+    PDC_COMPRESS_NONE  = 0, /* store the data as is                       */
+    PDC_COMPRESS_AUTO  = 1, /* choose the codec and shuffle per region    */
+    PDC_COMPRESS_LZ4   = 2, /* LZ4, with or without byte shuffle          */
+    PDC_COMPRESS_ZSTD  = 3, /* Zstandard, with or without byte shuffle    */
+    PDC_COMPRESS_LOSSY = 4  /* error-bounded lossy, float and double only */
+} pdc_compress_t;
+
+typedef enum {
+    PDC_ERROR_BOUND_ABS = 0, /* bound on the absolute error of each value  */
+    PDC_ERROR_BOUND_REL = 1  /* bound relative to the value range          */
+} pdc_error_bound_t;
+
 typedef enum { PDC_PERSIST, PDC_TRANSIENT } pdc_lifetime_t;
 
 typedef enum { PDC_SERVER_DEFAULT = 0, PDC_SERVER_PER_CLIENT = 1 } pdc_server_selection_t;
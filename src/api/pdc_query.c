@@ -314,6 +314,118 @@ done:
     FUNC_LEAVE(ret_value);
 }
 
+static int
+PDC_query_has_obj(pdc_query_t *query, uint64_t obj_id)
+{
+    if (NULL == query)
+        return 0;
+
+    if (query->constraint && query->constraint->obj_id == obj_id)
+        return 1;
+
+    return PDC_query_has_obj(query->left, obj_id) || PDC_query_has_obj(query->right, obj_id);
+}
+
+perr_t
+PDCquery_get_aggregate(pdc_query_t *query, pdcid_t obj_id, pdc_query_agg_t *agg)
+{
+    perr_t                ret_value = SUCCEED;
+    struct _pdc_obj_info *obj_prop;
+    uint64_t              meta_id;
+
+    FUNC_ENTER(NULL);
+
+    if (query == NULL || agg == NULL)
+        PGOTO_ERROR(FAIL, "==PDC_CLIENT[] input NULL!");
+
+    if (PDC_find_id(obj_id) != NULL) {
+        obj_prop = PDC_obj_get_info(obj_id);
+        meta_id  = obj_prop->obj_info_pub->meta_id;
+    }
+    else
+        meta_id = obj_id;
+
+    // Servers aggregate the data they have scanned for the query
+    if (PDC_query_has_obj(query, meta_id) == 0)
+        PGOTO_ERROR(FAIL, "==PDC_CLIENT[] aggregate object is not part of the query!");
+
+    memset(agg, 0, sizeof(pdc_query_agg_t));
+    agg->obj_id = meta_id;
+    ret_value   = PDC_send_data_query(query, PDC_QUERY_GET_AGG, NULL, NULL, agg);
+
+done:
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
+
+pdc_query_cursor_t *
+PDCquery_cursor_open(pdc_query_t *query, pdcid_t data_obj_id, uint64_t batch_nhits)
+{
+    pdc_query_cursor_t *  ret_value = NULL;
+    pdc_query_cursor_t *  cursor    = NULL;
+    struct _pdc_obj_info *obj_prop;
+
+    FUNC_ENTER(NULL);
+
+    if (query == NULL || batch_nhits == 0)
+        PGOTO_ERROR(NULL, "==PDC_CLIENT[] invalid input!");
+
+    cursor              = (pdc_query_cursor_t *)calloc(1, sizeof(pdc_query_cursor_t));
+    cursor->batch_nhits = batch_nhits;
+    if (data_obj_id != 0 && PDC_find_id(data_obj_id) != NULL) {
+        obj_prop            = PDC_obj_get_info(data_obj_id);
+        cursor->data_obj_id = obj_prop->obj_info_pub->meta_id;
+    }
+    else
+        cursor->data_obj_id = data_obj_id;
+
+    if (PDC_Client_query_cursor_open(query, cursor) != SUCCEED) {
+        free(cursor);
+        PGOTO_ERROR(NULL, "==PDC_CLIENT[] error opening query cursor!");
+    }
+
+    ret_value = cursor;
+
+done:
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDCquery_cursor_next(pdc_query_cursor_t *cursor, pdc_selection_t *sel, void *data)
+{
+    perr_t ret_value = SUCCEED;
+
+    FUNC_ENTER(NULL);
+
+    if (cursor == NULL || sel == NULL)
+        PGOTO_ERROR(FAIL, "==PDC_CLIENT[] input NULL!");
+
+    ret_value = PDC_Client_query_cursor_next(cursor, sel, data);
+
+done:
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDCquery_cursor_close(pdc_query_cursor_t *cursor)
+{
+    perr_t ret_value = SUCCEED;
+
+    FUNC_ENTER(NULL);
+
+    if (cursor == NULL)
+        PGOTO_ERROR(FAIL, "==PDC_CLIENT[] input NULL!");
+
+    ret_value = PDC_Client_query_cursor_close(cursor);
+    free(cursor);
+
+done:
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
+
 perr_t
 PDCquery_get_histogram(pdcid_t obj_id)
 {
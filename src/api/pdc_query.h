@@ -14,10 +14,12 @@ typedef enum { PDC_OP_NONE = 0, PDC_GT = 1, PDC_LT = 2, PDC_GTE = 3, PDC_LTE = 4
 typedef enum { PDC_QUERY_NONE = 0, PDC_QUERY_AND = 1, PDC_QUERY_OR = 2 } pdc_query_combine_op_t;
 
 typedef enum {
-    PDC_QUERY_GET_NONE  = 0,
-    PDC_QUERY_GET_NHITS = 1,
-    PDC_QUERY_GET_SEL   = 2,
-    PDC_QUERY_GET_DATA  = 3
+    PDC_QUERY_GET_NONE   = 0,
+    PDC_QUERY_GET_NHITS  = 1,
+    PDC_QUERY_GET_SEL    = 2,
+    PDC_QUERY_GET_DATA   = 3,
+    PDC_QUERY_GET_CURSOR = 4,
+    PDC_QUERY_GET_AGG    = 5
 } pdc_query_get_op_t;
 
 typedef struct pdcquery_selection_t {
@@ -55,6 +57,28 @@ typedef struct pdc_query_t {
     pdc_selection_t *       sel;
 } pdc_query_t;
 
+// Aggregates of an object's values at the hits of a query, computed by the servers
+typedef struct pdc_query_agg_t {
+    pdcid_t  obj_id; // object to aggregate, must be one of the queried objects
+    uint64_t count;
+    double   sum;
+    double   min;
+    double   max;
+    double   mean;
+} pdc_query_agg_t;
+
+// Cursor over the result of a data query, hits are pulled from the servers in batches
+typedef struct pdc_query_cursor_t {
+    pdcid_t  query_id;
+    pdcid_t  data_obj_id; // object to read data from with each batch, 0 for selection only
+    uint64_t batch_nhits; // max number of hits returned by each batch
+    uint64_t nhits;       // total number of hits of the query
+    uint64_t nhits_read;  // number of hits returned so far
+    uint64_t server_off;  // offset into the local selection of the current server
+    int      server_id;   // server that is currently being drained
+    int      is_done;
+} pdc_query_cursor_t;
+
 // Request structure for async read/write
 struct pdc_request {
     int                     seq_id;
@@ -195,6 +219,50 @@ perr_t PDCquery_get_histogram(pdcid_t obj_id);
  */
 perr_t PDCquery_get_sel_data(pdc_query_t *query, pdc_selection_t *sel, void *data);
 
+/**
+ * Get the count, sum, min, max and mean of an object's values at the hits of a query, the aggregates are
+ * computed by the servers and only the result is sent back
+ *
+ * \param query [IN]             Query to evaluate
+ * \param obj_id [IN]            Object to aggregate, must be one of the queried objects
+ * \param agg [OUT]              Aggregates, min/max/mean are 0 when there is no hit
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDCquery_get_aggregate(pdc_query_t *query, pdcid_t obj_id, pdc_query_agg_t *agg);
+
+/**
+ * Evaluate a query and open a cursor over its result, no selection is transferred to the client yet
+ *
+ * \param query [IN]             Query to evaluate
+ * \param data_obj_id [IN]       Object whose data is returned with each batch, 0 for selection only
+ * \param batch_nhits [IN]       Max number of hits returned by each call to PDCquery_cursor_next
+ *
+ * \return Cursor on success/NULL on failure
+ */
+pdc_query_cursor_t *PDCquery_cursor_open(pdc_query_t *query, pdcid_t data_obj_id, uint64_t batch_nhits);
+
+/**
+ * Get the next batch of hits of a query cursor, sel->nhits is 0 when the result is exhausted
+ *
+ * \param cursor [IN]            Cursor returned by PDCquery_cursor_open
+ * \param sel [OUT]              Coordinates of the hits in this batch
+ * \param data [OUT]             Data of the hits in this batch, must hold batch_nhits elements,
+ *                               ignored if NULL or the cursor was opened without a data object
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDCquery_cursor_next(pdc_query_cursor_t *cursor, pdc_selection_t *sel, void *data);
+
+/**
+ * Close a query cursor and release the query result kept by the servers
+ *
+ * \param cursor [IN]            Cursor returned by PDCquery_cursor_open
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDCquery_cursor_close(pdc_query_cursor_t *cursor);
+
 /**
  * ********
  *
@@ -165,7 +165,6 @@ PDCbuf_obj_map(void *buf, pdc_var_type_t local_type, pdcid_t local_reg, pdcid_t
     size_t                i;
     struct _pdc_id_info * objinfo2;
     struct _pdc_obj_info *obj2;
-    pdcid_t               remote_meta_id;
 
     pdc_var_type_t          remote_type;
     struct _pdc_id_info *   reginfo1, *reginfo2;
@@ -179,9 +178,8 @@ PDCbuf_obj_map(void *buf, pdc_var_type_t local_type, pdcid_t local_reg, pdcid_t
     objinfo2 = PDC_find_id(remote_obj);
     if (objinfo2 == NULL)
         PGOTO_ERROR(FAIL, "cannot locate remote object ID");
-    obj2           = (struct _pdc_obj_info *)(objinfo2->obj_ptr);
-    remote_meta_id = obj2->obj_info_pub->meta_id;
-    remote_type    = obj2->obj_pt->obj_prop_pub->type;
+    obj2        = (struct _pdc_obj_info *)(objinfo2->obj_ptr);
+    remote_type = obj2->obj_pt->obj_prop_pub->type;
 
     reginfo2 = PDC_find_id(remote_reg);
     reg2     = (struct pdc_region_info *)(reginfo2->obj_ptr);
@@ -191,8 +189,8 @@ PDCbuf_obj_map(void *buf, pdc_var_type_t local_type, pdcid_t local_reg, pdcid_t
         if ((obj2->obj_pt->obj_prop_pub->dims)[i] < (reg2->size)[i])
             PGOTO_ERROR(FAIL, "remote object region size error");
 
-    ret_value = PDC_Client_buf_map(local_reg, remote_meta_id, reg1->ndim, reg1->size, reg1->offset,
-                                   local_type, buf, remote_type, reg1, reg2);
+    ret_value = PDC_Client_buf_map(local_reg, obj2, reg1->ndim, reg1->size, reg1->offset, local_type, buf,
+                                   remote_type, reg1, reg2);
 
     if (ret_value == SUCCEED) {
         /*
@@ -253,7 +251,7 @@ PDCbuf_obj_unmap(pdcid_t remote_obj_id, pdcid_t remote_reg_id)
         PGOTO_ERROR(FAIL, "cannot locate region ID");
     reginfo = (struct pdc_region_info *)(info1->obj_ptr);
 
-    ret_value = PDC_Client_buf_unmap(object1->obj_info_pub->meta_id, remote_reg_id, reginfo, data_type);
+    ret_value = PDC_Client_buf_unmap(object1, remote_reg_id, reginfo, data_type);
 
     if (ret_value == SUCCEED) {
         PDC_dec_ref(remote_obj_id);
@@ -0,0 +1,745 @@
+/*
+ * Copyright Notice for
+ * Proactive Data Containers (PDC) Software Library and Utilities
+ * -----------------------------------------------------------------------------
+
+ *** Copyright Notice ***
+
+ * Proactive Data Containers (PDC) Copyright (c) 2017, The Regents of the
+ * University of California, through Lawrence Berkeley National Laboratory,
+ * UChicago Argonne, LLC, operator of Argonne National Laboratory, and The HDF
+ * Group (subject to receipt of any required approvals from the U.S. Dept. of
+ * Energy).  All rights reserved.
+
+ * If you have questions about your rights to use or distribute this software,
+ * please contact Berkeley Lab's Innovation & Partnerships Office at  IPO@lbl.gov.
+
+ * NOTICE.  This Software was developed under funding from the U.S. Department of
+ * Energy and the U.S. Government consequently retains certain rights. As such, the
+ * U.S. Government has been granted for itself and others acting on its behalf a
+ * paid-up, nonexclusive, irrevocable, worldwide license in the Software to
+ * reproduce, distribute copies to the public, prepare derivative works, and
+ * perform publicly and display publicly, and to permit other to do so.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+#include "pdc_sketch.h"
+#include "pdc_private.h"
+
+#define PDC_SKETCH_VERSION 1
+#define PDC_SKETCH_CHUNK   1024
+#define PDC_SKETCH_MIN_CAP 2
+// Levels up to this capacity are replaced by the sampler, they keep little more than one item per pair
+#define PDC_SKETCH_SAMPLE_CAP 8
+
+// Serialized sketch: this header, nlevel uint32_t level sizes, the items of each level and the registers
+typedef struct pdc_sketch_header_t {
+    uint32_t version;
+    int32_t  dtype;
+    uint64_t n;
+    double   min;
+    double   max;
+    uint64_t flip;
+    uint32_t nlevel;
+    uint32_t hll_bits;
+} pdc_sketch_header_t;
+
+typedef struct pdc_sketch_item_t {
+    double   value;
+    uint64_t weight;
+} pdc_sketch_item_t;
+
+// MurmurHash3 64-bit finalizer of the bits of the value
+static inline uint64_t
+pdc_sketch_hash(double value)
+{
+    uint64_t h;
+
+    memcpy(&h, &value, sizeof(h));
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static int
+pdc_sketch_cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+static int
+pdc_sketch_cmp_item(const void *a, const void *b)
+{
+    double x = ((const pdc_sketch_item_t *)a)->value, y = ((const pdc_sketch_item_t *)b)->value;
+
+    return (x > y) - (x < y);
+}
+
+/*
+ * Capacity of each level, the top level holds PDC_SKETCH_K items and each level below 2/3 of the one
+ * above, with at least PDC_SKETCH_MIN_CAP
+ *
+ * \param  nlevel[IN]           Number of levels
+ * \param  cap[OUT]             Capacity of each level
+ *
+ * \return Total capacity
+ */
+static uint64_t
+pdc_sketch_capacity(uint32_t nlevel, uint32_t *cap)
+{
+    uint64_t total = 0;
+    double   c     = PDC_SKETCH_K;
+    int      h;
+
+    for (h = (int)nlevel - 1; h >= 0; h--) {
+        cap[h] = c < PDC_SKETCH_MIN_CAP ? PDC_SKETCH_MIN_CAP : (uint32_t)c;
+        total += cap[h];
+        c *= 2.0 / 3.0;
+    }
+    return total;
+}
+
+static uint64_t
+pdc_sketch_size(const pdc_sketch_t *sketch)
+{
+    uint64_t total = 0;
+    uint32_t h;
+
+    for (h = 0; h < sketch->nlevel; h++)
+        total += sketch->level_size[h];
+    return total;
+}
+
+/*
+ * Make room for more items in a level
+ *
+ * \param  sketch[IN/OUT]       Pointer to the sketch
+ * \param  h[IN]                Level
+ * \param  size[IN]             Number of items the level must be able to hold
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+pdc_sketch_reserve(pdc_sketch_t *sketch, uint32_t h, uint64_t size)
+{
+    uint64_t alloc;
+    double * level;
+
+    if (size <= sketch->level_alloc[h])
+        return SUCCEED;
+
+    alloc = sketch->level_alloc[h] < 8 ? 8 : sketch->level_alloc[h];
+    while (alloc < size)
+        alloc *= 2;
+    if (alloc > UINT32_MAX)
+        return FAIL;
+
+    level = (double *)realloc(sketch->level[h], alloc * sizeof(double));
+    if (level == NULL)
+        return FAIL;
+    sketch->level[h]       = level;
+    sketch->level_alloc[h] = (uint32_t)alloc;
+
+    return SUCCEED;
+}
+
+/*
+ * Compact a level, every other item of the sorted level is promoted to the next level with twice the
+ * weight, the offset alternates so the errors of successive compactions cancel out. The largest item
+ * stays in place if the level has an odd number of items so the total weight is unchanged.
+ *
+ * \param  sketch[IN/OUT]       Pointer to the sketch
+ * \param  h[IN]                Level
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+pdc_sketch_compact(pdc_sketch_t *sketch, uint32_t h)
+{
+    double * items = sketch->level[h];
+    uint32_t size  = sketch->level_size[h];
+    uint32_t npair = size / 2, off, j;
+    double * next;
+
+    if (h + 1 == sketch->nlevel)
+        sketch->nlevel++;
+    if (pdc_sketch_reserve(sketch, h + 1, (uint64_t)sketch->level_size[h + 1] + npair) != SUCCEED)
+        return FAIL;
+
+    qsort(items, size, sizeof(double), pdc_sketch_cmp_double);
+    off = (sketch->flip >> h) & 1;
+    sketch->flip ^= 1ULL << h;
+
+    next = sketch->level[h + 1] + sketch->level_size[h + 1];
+    for (j = 0; j < npair; j++)
+        next[j] = items[2 * j + off];
+    sketch->level_size[h + 1] += npair;
+
+    if (size % 2 == 1) {
+        items[0]              = items[size - 1];
+        sketch->level_size[h] = 1;
+    }
+    else
+        sketch->level_size[h] = 0;
+
+    return SUCCEED;
+}
+
+/*
+ * Compact the lowest full levels until the sketch is within its capacity
+ *
+ * \param  sketch[IN/OUT]       Pointer to the sketch
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+pdc_sketch_compress(pdc_sketch_t *sketch)
+{
+    uint32_t cap[PDC_SKETCH_MAX_LEVEL];
+    uint32_t h;
+
+    while (pdc_sketch_size(sketch) >= pdc_sketch_capacity(sketch->nlevel, cap)) {
+        for (h = 0; h < sketch->nlevel; h++) {
+            if (sketch->level_size[h] >= cap[h])
+                break;
+        }
+        // Out of levels, the top level keeps growing, this needs more than 2^47 * PDC_SKETCH_K values
+        if (h + 1 >= PDC_SKETCH_MAX_LEVEL)
+            break;
+        if (pdc_sketch_compact(sketch, h) != SUCCEED)
+            return FAIL;
+    }
+
+    return SUCCEED;
+}
+
+/*
+ * Pick the level new values enter the quantile sketch at. Once the low levels are down to a few items
+ * they mostly pass one item of each pair up, so values skip them and a sampler keeps one random value of
+ * each block of 2^sample_level values instead, without sorting them.
+ *
+ * \param  sketch[IN/OUT]       Pointer to the sketch
+ */
+static void
+pdc_sketch_set_sample_level(pdc_sketch_t *sketch)
+{
+    uint32_t cap[PDC_SKETCH_MAX_LEVEL];
+
+    // The level only changes between blocks, all values of a block have the same weight
+    if (sketch->block_cnt != 0)
+        return;
+
+    pdc_sketch_capacity(sketch->nlevel, cap);
+    while (sketch->sample_level + 1 < sketch->nlevel && cap[sketch->sample_level] <= PDC_SKETCH_SAMPLE_CAP)
+        sketch->sample_level++;
+}
+
+/*
+ * Add values to a sketch
+ *
+ * \param  sketch[IN/OUT]       Pointer to the sketch
+ * \param  n[IN]                Number of values
+ * \param  x[IN/OUT]            Values, overwritten
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+pdc_sketch_add(pdc_sketch_t *sketch, uint64_t n, double *x)
+{
+    uint64_t i, m = 0, hash, rest, block = 1ULL << sketch->sample_level;
+    uint32_t idx, h = sketch->sample_level;
+    double   v;
+    uint8_t  rho;
+
+    // Drop the NaN, update the exact statistics and the distinct counter and keep the sampled values
+    for (i = 0; i < n; i++) {
+        v = x[i];
+        if (v != v)
+            continue;
+        // -0.0 and 0.0 are the same value
+        v = v == 0 ? 0 : v;
+        if (v < sketch->min)
+            sketch->min = v;
+        if (v > sketch->max)
+            sketch->max = v;
+        hash = pdc_sketch_hash(v);
+        idx  = (uint32_t)(hash >> (64 - PDC_SKETCH_HLL_BITS));
+        // Leading zeros of the remaining bits, a guard bit bounds the count
+        rest = (hash << PDC_SKETCH_HLL_BITS) | (1ULL << (PDC_SKETCH_HLL_BITS - 1));
+        rho  = (uint8_t)(__builtin_clzll(rest) + 1);
+        if (rho > sketch->hll[idx])
+            sketch->hll[idx] = rho;
+        sketch->n++;
+
+        if (sketch->block_cnt == sketch->block_pos)
+            x[m++] = v;
+        if (++sketch->block_cnt == block) {
+            // xorshift64, the position of the sampled value in the next block
+            sketch->rng ^= sketch->rng << 13;
+            sketch->rng ^= sketch->rng >> 7;
+            sketch->rng ^= sketch->rng << 17;
+            sketch->block_cnt = 0;
+            sketch->block_pos = sketch->rng & (block - 1);
+        }
+    }
+
+    if (m > 0) {
+        if (pdc_sketch_reserve(sketch, h, (uint64_t)sketch->level_size[h] + m) != SUCCEED)
+            return FAIL;
+        memcpy(sketch->level[h] + sketch->level_size[h], x, m * sizeof(double));
+        sketch->level_size[h] += (uint32_t)m;
+        if (pdc_sketch_compress(sketch) != SUCCEED)
+            return FAIL;
+    }
+    pdc_sketch_set_sample_level(sketch);
+
+    return SUCCEED;
+}
+
+#define PDC_SKETCH_TO_DOUBLE(TYPE, data, start, n, out)                                                     \
+    ({                                                                                                       \
+        const TYPE *ldata = (const TYPE *)(data) + (start);                                                 \
+        uint64_t    e;                                                                                       \
+        for (e = 0; e < (n); e++)                                                                            \
+            (out)[e] = (double)ldata[e];                                                                     \
+    })
+
+pdc_sketch_t *
+PDC_sketch_create(pdc_var_type_t dtype)
+{
+    pdc_sketch_t *ret_value = NULL;
+    pdc_sketch_t *sketch;
+
+    FUNC_ENTER(NULL);
+
+    sketch = (pdc_sketch_t *)calloc(1, sizeof(pdc_sketch_t));
+    if (sketch == NULL)
+        PGOTO_ERROR(NULL, "==PDC: ERROR allocating sketch");
+
+    sketch->dtype  = dtype;
+    sketch->min    = HUGE_VAL;
+    sketch->max    = -HUGE_VAL;
+    sketch->nlevel = 1;
+    sketch->rng    = 0x9e3779b97f4a7c15ULL;
+
+    ret_value = sketch;
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+pdc_sketch_t *
+PDC_gen_sketch(pdc_var_type_t dtype, uint64_t n, void *data)
+{
+    pdc_sketch_t *ret_value = NULL;
+    pdc_sketch_t *sketch;
+
+    FUNC_ENTER(NULL);
+
+    if (0 == n || NULL == data)
+        PGOTO_DONE(NULL);
+
+    sketch = PDC_sketch_create(dtype);
+    if (sketch == NULL)
+        PGOTO_DONE(NULL);
+
+    if (PDC_sketch_update(sketch, dtype, n, data) != SUCCEED) {
+        PDC_sketch_free(sketch);
+        PGOTO_DONE(NULL);
+    }
+
+    ret_value = sketch;
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDC_sketch_update(pdc_sketch_t *sketch, pdc_var_type_t dtype, uint64_t n, void *data)
+{
+    perr_t   ret_value = SUCCEED;
+    double   buf[PDC_SKETCH_CHUNK];
+    uint64_t start, cnt;
+
+    FUNC_ENTER(NULL);
+
+    if (sketch == NULL || (n > 0 && data == NULL))
+        PGOTO_ERROR(FAIL, "==PDC: NULL input");
+
+    for (start = 0; start < n; start += cnt) {
+        cnt = n - start < PDC_SKETCH_CHUNK ? n - start : PDC_SKETCH_CHUNK;
+        switch (dtype) {
+            case PDC_INT:
+                PDC_SKETCH_TO_DOUBLE(int32_t, data, start, cnt, buf);
+                break;
+            case PDC_FLOAT:
+                PDC_SKETCH_TO_DOUBLE(float, data, start, cnt, buf);
+                break;
+            case PDC_DOUBLE:
+                PDC_SKETCH_TO_DOUBLE(double, data, start, cnt, buf);
+                break;
+            case PDC_CHAR:
+            case PDC_INT8:
+                PDC_SKETCH_TO_DOUBLE(int8_t, data, start, cnt, buf);
+                break;
+            case PDC_UINT:
+                PDC_SKETCH_TO_DOUBLE(uint32_t, data, start, cnt, buf);
+                break;
+            case PDC_INT64:
+                PDC_SKETCH_TO_DOUBLE(int64_t, data, start, cnt, buf);
+                break;
+            case PDC_UINT64:
+                PDC_SKETCH_TO_DOUBLE(uint64_t, data, start, cnt, buf);
+                break;
+            case PDC_INT16:
+                PDC_SKETCH_TO_DOUBLE(int16_t, data, start, cnt, buf);
+                break;
+            default:
+                PGOTO_ERROR(FAIL, "==PDC: data type %d is not supported", dtype);
+        }
+        if (pdc_sketch_add(sketch, cnt, buf) != SUCCEED)
+            PGOTO_ERROR(FAIL, "==PDC: ERROR allocating sketch levels");
+    }
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDC_sketch_merge(pdc_sketch_t *dst, const pdc_sketch_t *src)
+{
+    perr_t   ret_value = SUCCEED;
+    uint32_t h;
+    int      i;
+
+    FUNC_ENTER(NULL);
+
+    if (dst == NULL || src == NULL)
+        PGOTO_ERROR(FAIL, "==PDC: NULL input");
+    if (src->n == 0)
+        PGOTO_DONE(SUCCEED);
+
+    if (dst->n == 0)
+        dst->dtype = src->dtype;
+    dst->n += src->n;
+    if (src->min < dst->min)
+        dst->min = src->min;
+    if (src->max > dst->max)
+        dst->max = src->max;
+    for (i = 0; i < PDC_SKETCH_HLL_SIZE; i++) {
+        if (src->hll[i] > dst->hll[i])
+            dst->hll[i] = src->hll[i];
+    }
+
+    // Items keep their weight, so the levels are appended to the same levels
+    if (src->nlevel > dst->nlevel)
+        dst->nlevel = src->nlevel;
+    for (h = 0; h < src->nlevel; h++) {
+        if (src->level_size[h] == 0)
+            continue;
+        if (pdc_sketch_reserve(dst, h, (uint64_t)dst->level_size[h] + src->level_size[h]) != SUCCEED)
+            PGOTO_ERROR(FAIL, "==PDC: ERROR allocating sketch levels");
+        memcpy(dst->level[h] + dst->level_size[h], src->level[h], src->level_size[h] * sizeof(double));
+        dst->level_size[h] += src->level_size[h];
+    }
+    if (pdc_sketch_compress(dst) != SUCCEED)
+        PGOTO_ERROR(FAIL, "==PDC: ERROR allocating sketch levels");
+    pdc_sketch_set_sample_level(dst);
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+double
+PDC_sketch_quantile(const pdc_sketch_t *sketch, double q)
+{
+    double             ret_value = NAN;
+    pdc_sketch_item_t *items     = NULL;
+    uint64_t           nitem = 0, total = 0, cum = 0, i;
+    double             target;
+    uint32_t           h, j;
+
+    FUNC_ENTER(NULL);
+
+    if (sketch == NULL || sketch->n == 0)
+        PGOTO_DONE(NAN);
+    if (q <= 0)
+        PGOTO_DONE(sketch->min);
+    if (q >= 1)
+        PGOTO_DONE(sketch->max);
+
+    items = (pdc_sketch_item_t *)malloc(pdc_sketch_size(sketch) * sizeof(pdc_sketch_item_t));
+    if (items == NULL)
+        PGOTO_ERROR(NAN, "==PDC: ERROR allocating items");
+    for (h = 0; h < sketch->nlevel; h++) {
+        for (j = 0; j < sketch->level_size[h]; j++) {
+            items[nitem].value  = sketch->level[h][j];
+            items[nitem].weight = 1ULL << h;
+            total += items[nitem].weight;
+            nitem++;
+        }
+    }
+    qsort(items, nitem, sizeof(pdc_sketch_item_t), pdc_sketch_cmp_item);
+
+    // The first item whose cumulative weight reaches the target rank, the values of an incomplete sampler
+    // block are not in the items yet
+    target    = q * (double)total;
+    ret_value = sketch->max;
+    for (i = 0; i < nitem; i++) {
+        cum += items[i].weight;
+        if ((double)cum >= target) {
+            ret_value = items[i].value;
+            break;
+        }
+    }
+
+done:
+    free(items);
+    FUNC_LEAVE(ret_value);
+}
+
+uint64_t
+PDC_sketch_rank(const pdc_sketch_t *sketch, double value, int inclusive)
+{
+    uint64_t ret_value = 0;
+    uint64_t below = 0, total = 0;
+    uint32_t h, j;
+
+    FUNC_ENTER(NULL);
+
+    if (sketch == NULL || sketch->n == 0)
+        PGOTO_DONE(0);
+
+    // Exact outside of the range of the values
+    if (value < sketch->min || (value == sketch->min && !inclusive))
+        PGOTO_DONE(0);
+    if (value > sketch->max || (value == sketch->max && inclusive))
+        PGOTO_DONE(sketch->n);
+
+    for (h = 0; h < sketch->nlevel; h++) {
+        for (j = 0; j < sketch->level_size[h]; j++) {
+            if (sketch->level[h][j] < value || (inclusive && sketch->level[h][j] == value))
+                below += 1ULL << h;
+        }
+        total += (uint64_t)sketch->level_size[h] << h;
+    }
+    // Scaled to the count, the values of an incomplete sampler block are not in the items yet
+    if (total > 0)
+        ret_value = (uint64_t)((double)below / total * sketch->n + 0.5);
+    if (ret_value > sketch->n)
+        ret_value = sketch->n;
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+uint64_t
+PDC_sketch_ndistinct(const pdc_sketch_t *sketch)
+{
+    uint64_t ret_value = 0;
+    double   m = PDC_SKETCH_HLL_SIZE, alpha, sum = 0, est;
+    int      i, zeros = 0;
+
+    FUNC_ENTER(NULL);
+
+    if (sketch == NULL || sketch->n == 0)
+        PGOTO_DONE(0);
+
+    for (i = 0; i < PDC_SKETCH_HLL_SIZE; i++) {
+        sum += 1.0 / (double)(1ULL << sketch->hll[i]);
+        if (sketch->hll[i] == 0)
+            zeros++;
+    }
+    alpha = 0.7213 / (1.0 + 1.079 / m);
+    est   = alpha * m * m / sum;
+    // Linear counting is more accurate while many registers are empty
+    if (est <= 2.5 * m && zeros > 0)
+        est = m * log(m / zeros);
+
+    ret_value = (uint64_t)(est + 0.5);
+    if (ret_value < 1)
+        ret_value = 1;
+    if (ret_value > sketch->n)
+        ret_value = sketch->n;
+    // Integers cannot have more distinct values than the width of their range
+    if (sketch->dtype != PDC_FLOAT && sketch->dtype != PDC_DOUBLE &&
+        sketch->max - sketch->min + 1 < (double)ret_value)
+        ret_value = (uint64_t)(sketch->max - sketch->min + 1);
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+size_t
+PDC_sketch_serialize_size(const pdc_sketch_t *sketch)
+{
+    size_t ret_value;
+
+    FUNC_ENTER(NULL);
+
+    ret_value = sizeof(pdc_sketch_header_t) + sketch->nlevel * sizeof(uint32_t) +
+                pdc_sketch_size(sketch) * sizeof(double) + PDC_SKETCH_HLL_SIZE;
+
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDC_sketch_serialize(const pdc_sketch_t *sketch, void *buf)
+{
+    perr_t              ret_value = SUCCEED;
+    pdc_sketch_header_t header;
+    char *              ptr = (char *)buf;
+    uint32_t            h;
+
+    FUNC_ENTER(NULL);
+
+    if (sketch == NULL || buf == NULL)
+        PGOTO_ERROR(FAIL, "==PDC: NULL input");
+
+    memset(&header, 0, sizeof(header));
+    header.version  = PDC_SKETCH_VERSION;
+    header.dtype    = sketch->dtype;
+    header.n        = sketch->n;
+    header.min      = sketch->min;
+    header.max      = sketch->max;
+    header.flip     = sketch->flip;
+    header.nlevel   = sketch->nlevel;
+    header.hll_bits = PDC_SKETCH_HLL_BITS;
+    memcpy(ptr, &header, sizeof(header));
+    ptr += sizeof(header);
+
+    memcpy(ptr, sketch->level_size, sketch->nlevel * sizeof(uint32_t));
+    ptr += sketch->nlevel * sizeof(uint32_t);
+    for (h = 0; h < sketch->nlevel; h++) {
+        if (sketch->level_size[h] == 0)
+            continue;
+        memcpy(ptr, sketch->level[h], sketch->level_size[h] * sizeof(double));
+        ptr += sketch->level_size[h] * sizeof(double);
+    }
+    memcpy(ptr, sketch->hll, PDC_SKETCH_HLL_SIZE);
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+pdc_sketch_t *
+PDC_sketch_deserialize(const void *buf, size_t size)
+{
+    pdc_sketch_t *      ret_value = NULL;
+    pdc_sketch_t *      sketch    = NULL;
+    pdc_sketch_header_t header;
+    const char *        ptr = (const char *)buf;
+    uint64_t            nitem = 0;
+    uint32_t            h;
+
+    FUNC_ENTER(NULL);
+
+    if (buf == NULL || size < sizeof(header))
+        PGOTO_ERROR(NULL, "==PDC: invalid sketch of %zu bytes", size);
+
+    memcpy(&header, ptr, sizeof(header));
+    ptr += sizeof(header);
+    if (header.version != PDC_SKETCH_VERSION || header.hll_bits != PDC_SKETCH_HLL_BITS ||
+        header.nlevel == 0 || header.nlevel > PDC_SKETCH_MAX_LEVEL ||
+        size < sizeof(header) + header.nlevel * sizeof(uint32_t))
+        PGOTO_ERROR(NULL, "==PDC: invalid sketch header");
+
+    sketch = PDC_sketch_create((pdc_var_type_t)header.dtype);
+    if (sketch == NULL)
+        PGOTO_DONE(NULL);
+    sketch->n      = header.n;
+    sketch->min    = header.min;
+    sketch->max    = header.max;
+    sketch->flip   = header.flip;
+    sketch->nlevel = header.nlevel;
+    memcpy(sketch->level_size, ptr, header.nlevel * sizeof(uint32_t));
+    ptr += header.nlevel * sizeof(uint32_t);
+    for (h = 0; h < header.nlevel; h++)
+        nitem += sketch->level_size[h];
+    if (size != PDC_sketch_serialize_size(sketch)) {
+        memset(sketch->level_size, 0, sizeof(sketch->level_size));
+        PGOTO_ERROR(NULL, "==PDC: sketch of %zu bytes does not hold its %" PRIu64 " items", size, nitem);
+    }
+
+    for (h = 0; h < header.nlevel; h++) {
+        if (sketch->level_size[h] == 0)
+            continue;
+        sketch->level[h] = (double *)malloc(sketch->level_size[h] * sizeof(double));
+        if (sketch->level[h] == NULL)
+            PGOTO_ERROR(NULL, "==PDC: ERROR allocating sketch levels");
+        sketch->level_alloc[h] = sketch->level_size[h];
+        memcpy(sketch->level[h], ptr, sketch->level_size[h] * sizeof(double));
+        ptr += sketch->level_size[h] * sizeof(double);
+    }
+    memcpy(sketch->hll, ptr, PDC_SKETCH_HLL_SIZE);
+    pdc_sketch_set_sample_level(sketch);
+
+    ret_value = sketch;
+    sketch    = NULL;
+
+done:
+    PDC_sketch_free(sketch);
+    FUNC_LEAVE(ret_value);
+}
+
+pdc_sketch_t *
+PDC_sketch_copy(const pdc_sketch_t *sketch)
+{
+    pdc_sketch_t *ret_value = NULL;
+    pdc_sketch_t *copy      = NULL;
+    uint32_t      h;
+
+    FUNC_ENTER(NULL);
+
+    if (sketch == NULL)
+        PGOTO_ERROR(NULL, "==PDC: NULL input");
+
+    copy = (pdc_sketch_t *)malloc(sizeof(pdc_sketch_t));
+    if (copy == NULL)
+        PGOTO_ERROR(NULL, "==PDC: ERROR allocating sketch");
+    memcpy(copy, sketch, sizeof(pdc_sketch_t));
+    memset(copy->level, 0, sizeof(copy->level));
+    memset(copy->level_alloc, 0, sizeof(copy->level_alloc));
+
+    for (h = 0; h < sketch->nlevel; h++) {
+        if (sketch->level_size[h] == 0)
+            continue;
+        copy->level[h] = (double *)malloc(sketch->level_size[h] * sizeof(double));
+        if (copy->level[h] == NULL)
+            PGOTO_ERROR(NULL, "==PDC: ERROR allocating sketch levels");
+        copy->level_alloc[h] = sketch->level_size[h];
+        memcpy(copy->level[h], sketch->level[h], sketch->level_size[h] * sizeof(double));
+    }
+
+    ret_value = copy;
+    copy      = NULL;
+
+done:
+    PDC_sketch_free(copy);
+    FUNC_LEAVE(ret_value);
+}
+
+void
+PDC_sketch_free(pdc_sketch_t *sketch)
+{
+    uint32_t h;
+
+    FUNC_ENTER(NULL);
+
+    if (sketch != NULL) {
+        for (h = 0; h < PDC_SKETCH_MAX_LEVEL; h++)
+            free(sketch->level[h]);
+        free(sketch);
+    }
+
+    FUNC_LEAVE_VOID;
+}
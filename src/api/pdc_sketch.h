@@ -0,0 +1,178 @@
+/*
+ * Copyright Notice for
+ * Proactive Data Containers (PDC) Software Library and Utilities
+ * -----------------------------------------------------------------------------
+
+ *** Copyright Notice ***
+
+ * Proactive Data Containers (PDC) Copyright (c) 2017, The Regents of the
+ * University of California, through Lawrence Berkeley National Laboratory,
+ * UChicago Argonne, LLC, operator of Argonne National Laboratory, and The HDF
+ * Group (subject to receipt of any required approvals from the U.S. Dept. of
+ * Energy).  All rights reserved.
+
+ * If you have questions about your rights to use or distribute this software,
+ * please contact Berkeley Lab's Innovation & Partnerships Office at  IPO@lbl.gov.
+
+ * NOTICE.  This Software was developed under funding from the U.S. Department of
+ * Energy and the U.S. Government consequently retains certain rights. As such, the
+ * U.S. Government has been granted for itself and others acting on its behalf a
+ * paid-up, nonexclusive, irrevocable, worldwide license in the Software to
+ * reproduce, distribute copies to the public, prepare derivative works, and
+ * perform publicly and display publicly, and to permit other to do so.
+ */
+
+#ifndef PDC_SKETCH_H
+#define PDC_SKETCH_H
+
+#include "pdc_public.h"
+
+/*
+ * Mergeable summary of the values of a region: the exact count, min and max, a KLL quantile sketch and a
+ * HyperLogLog counter of the distinct values. The quantile sketch keeps levels of sorted samples, an item
+ * of level h stands for 2^h values, and a full level is compacted by promoting every other item to the
+ * next level. Once the low levels are small, new values skip them through a sampler that keeps one random
+ * value of each block, so large regions are summarized without sorting every value. The rank error is
+ * about 1.7 / PDC_SKETCH_K of the count and does not grow with merges, so the sketches of many regions can
+ * be merged into the sketch of an object without losing precision.
+ */
+#define PDC_SKETCH_K         200
+#define PDC_SKETCH_MAX_LEVEL 48
+#define PDC_SKETCH_HLL_BITS  10
+#define PDC_SKETCH_HLL_SIZE  (1 << PDC_SKETCH_HLL_BITS)
+
+typedef struct pdc_sketch_t {
+    pdc_var_type_t dtype;
+    uint64_t       n; /* number of values, NaN are not counted */
+    double         min;
+    double         max;
+    uint64_t       flip;         /* bit h is the offset of the next compaction of level h, it alternates */
+    uint32_t       nlevel;       /* number of levels of the quantile sketch */
+    uint32_t       sample_level; /* level new values enter at, one value of each block of 2^level is kept */
+    uint64_t       block_cnt;    /* values of the current block so far */
+    uint64_t       block_pos;    /* position of the value of the current block that is kept */
+    uint64_t       rng;
+    uint32_t       level_size[PDC_SKETCH_MAX_LEVEL];
+    uint32_t       level_alloc[PDC_SKETCH_MAX_LEVEL];
+    double *       level[PDC_SKETCH_MAX_LEVEL];
+    uint8_t        hll[PDC_SKETCH_HLL_SIZE]; /* HyperLogLog registers */
+} pdc_sketch_t;
+
+/**
+ * Create an empty sketch
+ *
+ * \param dtype [IN]            Data type of the values
+ *
+ * \return Pointer to the sketch on success/NULL on failure
+ */
+pdc_sketch_t *PDC_sketch_create(pdc_var_type_t dtype);
+
+/**
+ * Create the sketch of an array of values
+ *
+ * \param dtype [IN]            Data type of the values
+ * \param n [IN]                Number of values
+ * \param data [IN]             Pointer to the values
+ *
+ * \return Pointer to the sketch on success/NULL on failure
+ */
+pdc_sketch_t *PDC_gen_sketch(pdc_var_type_t dtype, uint64_t n, void *data);
+
+/**
+ * Add an array of values to a sketch
+ *
+ * \param sketch [IN]           Pointer to the sketch
+ * \param dtype [IN]            Data type of the values
+ * \param n [IN]                Number of values
+ * \param data [IN]             Pointer to the values
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_sketch_update(pdc_sketch_t *sketch, pdc_var_type_t dtype, uint64_t n, void *data);
+
+/**
+ * Merge a sketch into another one, the result summarizes the values of both
+ *
+ * \param dst [IN/OUT]          Pointer to the sketch that is updated
+ * \param src [IN]              Pointer to the sketch that is merged
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_sketch_merge(pdc_sketch_t *dst, const pdc_sketch_t *src);
+
+/**
+ * Estimate a quantile of the values
+ *
+ * \param sketch [IN]           Pointer to the sketch
+ * \param q [IN]                Quantile in [0, 1], 0 gives the exact min and 1 the exact max
+ *
+ * \return Estimated value of the quantile, NaN if the sketch is empty
+ */
+double PDC_sketch_quantile(const pdc_sketch_t *sketch, double q);
+
+/**
+ * Estimate the number of values that are less than a value
+ *
+ * \param sketch [IN]           Pointer to the sketch
+ * \param value [IN]            Value
+ * \param inclusive [IN]        1 to also count the values equal to value
+ *
+ * \return Estimated number of values
+ */
+uint64_t PDC_sketch_rank(const pdc_sketch_t *sketch, double value, int inclusive);
+
+/**
+ * Estimate the number of distinct values
+ *
+ * \param sketch [IN]           Pointer to the sketch
+ *
+ * \return Estimated number of distinct values
+ */
+uint64_t PDC_sketch_ndistinct(const pdc_sketch_t *sketch);
+
+/**
+ * Get the size of the serialized sketch
+ *
+ * \param sketch [IN]           Pointer to the sketch
+ *
+ * \return Size in bytes
+ */
+size_t PDC_sketch_serialize_size(const pdc_sketch_t *sketch);
+
+/**
+ * Serialize a sketch
+ *
+ * \param sketch [IN]           Pointer to the sketch
+ * \param buf [OUT]             Buffer of PDC_sketch_serialize_size() bytes
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_sketch_serialize(const pdc_sketch_t *sketch, void *buf);
+
+/**
+ * Create a sketch from its serialized form
+ *
+ * \param buf [IN]              Serialized sketch
+ * \param size [IN]             Size of the buffer
+ *
+ * \return Pointer to the sketch on success/NULL on failure
+ */
+pdc_sketch_t *PDC_sketch_deserialize(const void *buf, size_t size);
+
+/**
+ * Copy a sketch
+ *
+ * \param sketch [IN]           Pointer to the sketch
+ *
+ * \return Pointer to the copy on success/NULL on failure
+ */
+pdc_sketch_t *PDC_sketch_copy(const pdc_sketch_t *sketch);
+
+/**
+ * Free a sketch
+ *
+ * \param sketch [IN]           Pointer to the sketch
+ */
+void PDC_sketch_free(pdc_sketch_t *sketch);
+
+#endif /* PDC_SKETCH_H */
@@ -45,6 +45,136 @@ extern int pdc_client_mpi_size_g;
 
 static char *default_pdc_transforms_lib = "libpdctransforms.so";
 
+/*
+ * Fill a transform with the source and destination of the mapping of an object, and flag the destination
+ * region with the transform
+ *
+ * \param  thisFtn[IN/OUT]      Transform
+ * \param  obj_id[IN]           ID of the mapped object
+ * \param  src_region_id[OUT]   ID of the source region, unchanged if the object is not mapped
+ * \param  dest_region_id[OUT]  ID of the destination region, unchanged if the object is not mapped
+ * \param  dest_object_id[OUT]  ID of the destination object, unchanged if the object is not mapped
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_transform_set_mapping(struct _pdc_region_transform_ftn_info *thisFtn, pdcid_t obj_id,
+                          pdcid_t *src_region_id, pdcid_t *dest_region_id, pdcid_t *dest_object_id)
+{
+    perr_t                  ret_value = SUCCEED;
+    struct _pdc_obj_info *  obj1, *obj2;
+    struct _pdc_id_info *   objinfo1, *id_info;
+    struct _pdc_obj_prop *  prop;
+    struct pdc_region_info *reg1 = NULL, *reg2 = NULL;
+
+    FUNC_ENTER(NULL);
+
+    objinfo1 = PDC_find_id(obj_id);
+    if (objinfo1 == NULL)
+        PGOTO_ERROR(FAIL, "cannot locate local object ID");
+    obj1 = (struct _pdc_obj_info *)(objinfo1->obj_ptr);
+    /* See if any mapping operations are defined */
+    if (obj1 && (obj1->region_list_head != NULL)) {
+        id_info         = PDC_find_id(obj1->region_list_head->orig_reg_id);
+        *src_region_id  = obj1->region_list_head->orig_reg_id;
+        *dest_region_id = obj1->region_list_head->des_reg_id;
+        // mapping is already defined...
+        if (id_info && ((reg1 = (struct pdc_region_info *)id_info->obj_ptr) != NULL)) {
+            thisFtn->src_region = reg1;
+            obj1                = reg1->obj;
+
+            // Requires that the PDCprop_set_obj_buf function be used...
+            if (obj1 && ((prop = obj1->obj_pt) != NULL)) {
+                thisFtn->data        = prop->buf;
+                thisFtn->type        = prop->obj_prop_pub->type;
+                thisFtn->type_extent = prop->type_extent;
+            }
+        }
+        id_info = PDC_find_id(*dest_region_id);
+        if (id_info && ((reg2 = (struct pdc_region_info *)id_info->obj_ptr) != NULL)) {
+            thisFtn->dest_region = reg2;
+            obj2                 = reg2->obj;
+            *dest_object_id      = obj2->obj_info_pub->local_id;
+            if (obj2 && ((prop = obj2->obj_pt) != NULL)) {
+                thisFtn->result      = prop->buf;
+                thisFtn->dest_type   = prop->obj_prop_pub->type;
+                thisFtn->dest_extent = prop->type_extent;
+            }
+            // Flag the destination region with the transform
+            reg2->registered_op |= PDC_TRANSFORM;
+        }
+    }
+
+done:
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Copy the stages of a pipeline with the library of each user function replaced by its path, the data
+ * servers load the functions from the same paths
+ *
+ * \param  pipeline[IN]         Stages separated by '|'
+ * \param  applicationDir[IN]   Directory of the application, where libraries are looked for
+ * \param  on_server[IN]        1 if the pipeline runs on the data servers, which only have the built-in
+ *                              stages and the functions of libraries
+ *
+ * \return Stages to be freed by the caller/NULL on failure
+ */
+static char *
+PDC_transform_pipeline_resolve(const char *pipeline, char *applicationDir, int on_server)
+{
+    char * ret_value = NULL;
+    char * stages = NULL, *spec = NULL, *name, *save = NULL, *arg, *colonsep, *loadpath, *tmp;
+    size_t len = 0, size;
+
+    FUNC_ENTER(NULL);
+
+    if ((stages = strdup(pipeline)) == NULL)
+        PGOTO_ERROR(NULL, "PDC transform pipeline memory allocation failed");
+
+    for (name = strtok_r(stages, "|", &save); name != NULL; name = strtok_r(NULL, "|", &save)) {
+        if ((arg = strchr(name, '=')) != NULL)
+            *arg++ = 0;
+        // Built-in and registered stages keep their name, functions are looked for in their library
+        loadpath = NULL;
+        if ((colonsep = strrchr(name, ':')) != NULL) {
+            *colonsep++ = 0;
+            if ((loadpath = PDC_get_realpath(colonsep, applicationDir)) == NULL)
+                PGOTO_ERROR(NULL, "Unable to locate the library of transform %s", name);
+        }
+        else if (on_server && PDC_transform_stage_find_builtin(name) == NULL &&
+                 PDC_transform_stage_find(name) != NULL)
+            PGOTO_ERROR(NULL, "Transform stage %s is registered by the client, a data server cannot run it",
+                        name);
+        else if (PDC_transform_stage_find(name) == NULL) {
+            if ((loadpath = PDC_get_realpath(default_pdc_transforms_lib, applicationDir)) == NULL)
+                PGOTO_ERROR(NULL, "Unable to locate the library of transform %s", name);
+        }
+
+        size = strlen(name) + (loadpath ? strlen(loadpath) + 1 : 0) + (arg ? strlen(arg) + 1 : 0) + 2;
+        if ((tmp = (char *)realloc(spec, len + size)) == NULL) {
+            free(loadpath);
+            PGOTO_ERROR(NULL, "PDC transform pipeline memory allocation failed");
+        }
+        spec = tmp;
+        len += sprintf(spec + len, "%s%s%s%s%s%s", len > 0 ? "|" : "", name, loadpath ? ":" : "",
+                       loadpath ? loadpath : "", arg ? "=" : "", arg ? arg : "");
+        free(loadpath);
+    }
+    if (spec == NULL)
+        PGOTO_ERROR(NULL, "Transform pipeline has no stage");
+
+    ret_value = spec;
+    spec      = NULL;
+
+done:
+    fflush(stdout);
+    free(stages);
+    free(spec);
+    FUNC_LEAVE(ret_value);
+}
+
 perr_t
 PDCobj_transform_register(char *func, pdcid_t obj_id, int current_state, int next_state,
                           pdc_obj_transform_t op_type, pdc_data_movement_t when)
@@ -53,10 +183,6 @@ PDCobj_transform_register(char *func, pdcid_t obj_id, int current_state, int nex
     void * ftnHandle                               = NULL;
     size_t (*ftnPtr)()                             = NULL;
     struct _pdc_region_transform_ftn_info *thisFtn = NULL;
-    struct _pdc_obj_info *                 obj1, *obj2;
-    struct _pdc_id_info *                  objinfo1;
-    struct _pdc_obj_prop *                 prop;
-    struct pdc_region_info *               reg1 = NULL, *reg2 = NULL;
     pdcid_t                                src_region_id = 0, dest_region_id = 0;
     pdcid_t                                dest_object_id    = 0;
     char *                                 thisApp           = NULL;
@@ -66,7 +192,6 @@ PDCobj_transform_register(char *func, pdcid_t obj_id, int current_state, int nex
     char *                                 userdefinedftn    = NULL;
     char *                                 loadpath          = NULL;
     int                                    local_regIndex;
-    struct _pdc_id_info *                  id_info;
 
     FUNC_ENTER(NULL);
 
@@ -111,44 +236,11 @@ PDCobj_transform_register(char *func, pdcid_t obj_id, int current_state, int nex
 
     // Flag the transform as being active on mapping operations
     if (op_type == PDC_DATA_MAP) {
-        objinfo1 = PDC_find_id(obj_id);
-        if (objinfo1 == NULL)
+        if (PDC_transform_set_mapping(thisFtn, obj_id, &src_region_id, &dest_region_id, &dest_object_id) < 0)
             PGOTO_ERROR(FAIL, "cannot locate local object ID");
-        obj1 = (struct _pdc_obj_info *)(objinfo1->obj_ptr);
-        /* See if any mapping operations are defined */
-        if (obj1 && (obj1->region_list_head != NULL)) {
-            id_info        = PDC_find_id(obj1->region_list_head->orig_reg_id);
-            src_region_id  = obj1->region_list_head->orig_reg_id;
-            dest_region_id = obj1->region_list_head->des_reg_id;
-            // mapping is already defined...
-            if (id_info && ((reg1 = (struct pdc_region_info *)id_info->obj_ptr) != NULL)) {
-                thisFtn->src_region = reg1;
-                obj1                = reg1->obj;
-
-                // Requires that the PDCprop_set_obj_buf function be used...
-                if (obj1 && ((prop = obj1->obj_pt) != NULL)) {
-                    thisFtn->data        = prop->buf;
-                    thisFtn->type        = prop->obj_prop_pub->type;
-                    thisFtn->type_extent = prop->type_extent;
-                }
-            }
-            id_info = PDC_find_id(dest_region_id);
-            if (id_info && ((reg2 = (struct pdc_region_info *)id_info->obj_ptr) != NULL)) {
-                thisFtn->dest_region = reg2;
-                obj2                 = reg2->obj;
-                dest_object_id       = obj2->obj_info_pub->local_id;
-                if (obj2 && ((prop = obj2->obj_pt) != NULL)) {
-                    thisFtn->result      = prop->buf;
-                    thisFtn->dest_type   = prop->obj_prop_pub->type;
-                    thisFtn->dest_extent = prop->type_extent;
-                }
-            }
-            // Flag the destination region with the transform
-            reg2->registered_op |= PDC_TRANSFORM;
-        }
         PDC_Client_register_region_transform(userdefinedftn, loadpath, src_region_id, dest_region_id,
                                              dest_object_id, current_state, thisFtn->nextState,
-                                             (int)PDC_DATA_MAP, (int)when, local_regIndex);
+                                             (int)PDC_DATA_MAP, (int)when, local_regIndex, 0);
     }
 
 done:
@@ -209,6 +301,7 @@ PDCbuf_map_transform_register(char *func, void *buf, pdcid_t src_region_id, pdci
     if ((thisFtn = PDC_MALLOC(struct _pdc_region_transform_ftn_info)) == NULL)
         PGOTO_ERROR(FAIL, "PDC register_obj_transforms memory allocation failed");
 
+    memset(thisFtn, 0, sizeof(struct _pdc_region_transform_ftn_info));
     thisFtn->ftnPtr    = (size_t(*)())ftnPtr;
     thisFtn->object_id = dest_object_id;
     id_info            = PDC_find_id(src_region_id);
@@ -257,7 +350,7 @@ PDCbuf_map_transform_register(char *func, void *buf, pdcid_t src_region_id, pdci
 
     PDC_Client_register_region_transform(userdefinedftn, loadpath, src_region_id, dest_region_id,
                                          dest_object_id, current_state, thisFtn->nextState, (int)PDC_DATA_MAP,
-                                         (int)when, local_regIndex);
+                                         (int)when, local_regIndex, 0);
 
 done:
     fflush(stdout);
@@ -271,6 +364,82 @@ done:
     FUNC_LEAVE(ret_value);
 }
 
+perr_t
+PDCobj_transform_pipeline_register(const char *pipeline, pdcid_t obj_id, int current_state, int next_state,
+                                   pdc_data_movement_t when)
+{
+    perr_t                                 ret_value = SUCCEED;
+    struct _pdc_region_transform_ftn_info *thisFtn   = NULL;
+    pdcid_t                                src_region_id = 0, dest_region_id = 0;
+    pdcid_t                                dest_object_id = 0;
+    char *                                 thisApp        = NULL;
+    char *                                 applicationDir = NULL;
+    char *                                 spec           = NULL;
+    int                                    local_regIndex, next;
+
+    FUNC_ENTER(NULL);
+
+    if (pipeline == NULL)
+        PGOTO_ERROR(FAIL, "No transform pipeline");
+
+    thisApp = PDC_get_argv0_();
+    if (thisApp)
+        applicationDir = dirname(strdup(thisApp));
+    if ((spec = PDC_transform_pipeline_resolve(pipeline, applicationDir,
+                                               PDC_get_execution_locus() == SERVER_MEMORY)) == NULL)
+        PGOTO_ERROR(FAIL, "Unable to resolve transform pipeline %s", pipeline);
+
+    if ((thisFtn = PDC_MALLOC(struct _pdc_region_transform_ftn_info)) == NULL)
+        PGOTO_ERROR(FAIL, "PDC register_obj_transforms memory allocation failed");
+
+    memset(thisFtn, 0, sizeof(struct _pdc_region_transform_ftn_info));
+    thisFtn->object_id  = obj_id;
+    thisFtn->op_type    = PDC_DATA_MAP;
+    thisFtn->when       = when;
+    thisFtn->lang       = C_lang;
+    thisFtn->client_id  = pdc_client_mpi_rank_g;
+    thisFtn->readyState = current_state;
+    thisFtn->dest_type  = PDC_UNKNOWN;
+    if (next_state == INCR_STATE)
+        next = current_state + 1;
+    else if (next_state == DECR_STATE)
+        next = current_state - 1;
+    else
+        next = next_state;
+    thisFtn->nextState = next;
+
+    if (PDC_transform_set_mapping(thisFtn, obj_id, &src_region_id, &dest_region_id, &dest_object_id) < 0)
+        PGOTO_ERROR(FAIL, "cannot locate local object ID");
+
+    // A pipeline that runs on the client resolves its stages now, the data server does it on registration
+    if (PDC_get_execution_locus() != SERVER_MEMORY) {
+        if ((thisFtn->pipeline = PDC_transform_pipeline_create(spec)) == NULL)
+            PGOTO_ERROR(FAIL, "Unable to create transform pipeline %s", pipeline);
+    }
+
+    // Add to our own list of transform functions
+    if ((local_regIndex = PDC_add_transform_ptr_to_registry_(thisFtn)) < 0) {
+        PDC_transform_pipeline_free(thisFtn->pipeline);
+        PGOTO_ERROR(FAIL, "PDC unable to register transform function!");
+    }
+    thisFtn = NULL;
+
+    if (PDC_get_execution_locus() == SERVER_MEMORY)
+        ret_value =
+            PDC_Client_register_region_transform(spec, "", src_region_id, dest_region_id, dest_object_id,
+                                                 current_state, next, (int)PDC_DATA_MAP, (int)when,
+                                                 local_regIndex, 1);
+
+done:
+    fflush(stdout);
+    if (applicationDir)
+        free(applicationDir);
+    free(spec);
+    free(thisFtn);
+
+    FUNC_LEAVE(ret_value);
+}
+
 perr_t
 PDCbuf_io_transform_register(char *func ATTRIBUTE(unused), void *buf ATTRIBUTE(unused),
                              pdcid_t src_region_id ATTRIBUTE(unused), int current_state ATTRIBUTE(unused),
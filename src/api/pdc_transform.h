@@ -42,6 +42,23 @@ typedef enum { DECR_STATE = -100, INCR_STATE = 100, _STATIC_STATE = 0 } pdc_stat
 
 typedef enum { DATA_IN = 1, DATA_OUT = 2, DATA_RELOCATION = 4 } pdc_data_movement_t;
 
+/*
+ * Flags a pipeline stage returns when it is called with a NULL input, (size_t)-1 if its argument is
+ * invalid
+ */
+#define PDC_STAGE_CONCAT       0x1 /* outputs of consecutive chunks concatenate, e.g. a type conversion */
+#define PDC_STAGE_FRAMED_INPUT 0x2 /* takes the frames of a framed pipeline output, e.g. a decompressor */
+
+/*
+ * Stage of a transform pipeline, called once per chunk of the data. It writes the output of the in_size
+ * bytes at in to out and returns its size in bytes, with *out_type set to the type of the output. If the
+ * output does not fit in out_capacity bytes, it writes nothing and returns the size it needs, and it is
+ * called again with a larger buffer. It returns 0 on failure. arg is the text after '=' in the stage of
+ * the pipeline, or NULL.
+ */
+typedef size_t (*pdc_transform_stage_t)(const void *in, size_t in_size, pdc_var_type_t in_type, void *out,
+                                        size_t out_capacity, pdc_var_type_t *out_type, const char *arg);
+
 /*********************/
 /* Public Prototypes */
 /*********************/
@@ -82,4 +99,36 @@ perr_t PDCbuf_map_transform_register(char *func, void *buf, pdcid_t src_region_i
                                      pdcid_t dest_region_id, int current_state, int next_state,
                                      pdc_data_movement_t when);
 
+/**
+ * Register a pipeline of transforms to be invoked as a result of having mapped the object. The stages run
+ * as a single pass over chunks of the data, each chunk goes through all the stages while it is in cache,
+ * and the buffers between the stages are kept for the next chunks. The pipeline runs on the client or on
+ * the data server according to the execution locus.
+ *
+ * \param pipeline [IN]         Stages separated by '|', each is a built-in stage such as "convert=float",
+ *                              a stage registered with PDC_transform_stage_register if the pipeline runs
+ *                              on the client, or a function[:libraryname] (default library name =
+ *                              "libpdctransforms"), optionally followed by "=argument"
+ * \param obj_id [IN]           PDC object id containing the input data.
+ * \param current_state [IN]    State/Sequence ID to identify when the transform can take place.
+ * \param next_state [IN]       State/Sequence ID after the transform is complete (should be +1 or -1).
+ * \param when [IN]             An enumerated ID specifying when/where a transform is invoked.
+ *                              (examples for data movement: DATA_OUT, DATA_IN)
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDCobj_transform_pipeline_register(const char *pipeline, pdcid_t obj_id, int current_state,
+                                          int next_state, pdc_data_movement_t when);
+
+/**
+ * Register a function as a pipeline stage, so pipelines that run in this process can name it without
+ * loading it from a library
+ *
+ * \param name [IN]             Name of the stage in pipelines
+ * \param ftn [IN]              Stage function
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_transform_stage_register(const char *name, pdc_transform_stage_t ftn);
+
 #endif /* PDC_TRANSFORM_SUPPORT_H */
@@ -0,0 +1,374 @@
+/*
+ * Copyright Notice for
+ * Proactive Data Containers (PDC) Software Library and Utilities
+ * -----------------------------------------------------------------------------
+
+ *** Copyright Notice ***
+
+ * Proactive Data Containers (PDC) Copyright (c) 2017, The Regents of the
+ * University of California, through Lawrence Berkeley National Laboratory,
+ * UChicago Argonne, LLC, operator of Argonne National Laboratory, and The HDF
+ * Group (subject to receipt of any required approvals from the U.S. Dept. of
+ * Energy).  All rights reserved.
+
+ * If you have questions about your rights to use or distribute this software,
+ * please contact Berkeley Lab's Innovation & Partnerships Office at  IPO@lbl.gov.
+
+ * NOTICE.  This Software was developed under funding from the U.S. Department of
+ * Energy and the U.S. Government consequently retains certain rights. As such, the
+ * U.S. Government has been granted for itself and others acting on its behalf a
+ * paid-up, nonexclusive, irrevocable, worldwide license in the Software to
+ * reproduce, distribute copies to the public, prepare derivative works, and
+ * perform publicly and display publicly, and to permit other to do so.
+ */
+
+/************************************************************************
+ * This file includes the transform pipelines, shared by clients and servers
+ ************************************************************************ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pdc_transforms_pkg.h"
+#include "pdc_analysis_pkg.h"
+#include "pdc_client_server_common.h"
+#include "pdc_dt_conv.h"
+
+typedef struct pdc_transform_stage_entry_t {
+    char *                name;
+    pdc_transform_stage_t ftn;
+} pdc_transform_stage_entry_t;
+
+// Stages registered by name, after the built-in ones
+static pdc_transform_stage_entry_t *stage_table_g      = NULL;
+static int                          n_stage_table_g    = 0;
+static int                          stage_table_size_g = 0;
+
+static const char *type_names_g[NCLASSES] = {"int",   "float", "double", "char",   "compound", "enum",
+                                             "array", "uint",  "int64",  "uint64", "int16",    "int8"};
+
+/*
+ * Type of a type name, as in pdc_var_type_t without the PDC_ prefix and in lower case
+ *
+ * \param  name[IN]             Type name
+ *
+ * \return Type/PDC_UNKNOWN if the name is not a type
+ */
+static pdc_var_type_t
+PDC_transform_type_by_name(const char *name)
+{
+    int i;
+
+    if (name == NULL)
+        return PDC_UNKNOWN;
+    for (i = 0; i < NCLASSES; i++) {
+        if (strcmp(name, type_names_g[i]) == 0)
+            return (pdc_var_type_t)i;
+    }
+    return PDC_UNKNOWN;
+}
+
+/*
+ * Built-in stage "convert=type", converts the values to another numeric type like a mapping between
+ * buffers of different types, integers saturate and floating-point values are rounded
+ */
+static size_t
+PDC_transform_convert(const void *in, size_t in_size, pdc_var_type_t in_type, void *out, size_t out_capacity,
+                      pdc_var_type_t *out_type, const char *arg)
+{
+    pdc_var_type_t dest_type;
+    pdc_conv_t     conv;
+    size_t         n, size;
+
+    dest_type = PDC_transform_type_by_name(arg);
+    if (in == NULL)
+        return dest_type == PDC_UNKNOWN ? (size_t)-1 : PDC_STAGE_CONCAT;
+
+    if (dest_type == PDC_UNKNOWN || (conv = pdc_find_conv_func(in_type, dest_type)) == NULL)
+        return 0;
+    n    = in_size / PDC_get_var_type_size(in_type);
+    size = n * PDC_get_var_type_size(dest_type);
+    if (size > out_capacity)
+        return size;
+    if (conv(in, out, n, 1, 1, PDC_CONV_CLAMP | PDC_CONV_ROUND) != SUCCEED)
+        return 0;
+    *out_type = dest_type;
+
+    return size;
+}
+
+pdc_transform_stage_t
+PDC_transform_stage_find_builtin(const char *name)
+{
+    if (strcmp(name, "convert") == 0)
+        return PDC_transform_convert;
+    return NULL;
+}
+
+pdc_transform_stage_t
+PDC_transform_stage_find(const char *name)
+{
+    pdc_transform_stage_t ftn;
+    int                   i;
+
+    if ((ftn = PDC_transform_stage_find_builtin(name)) != NULL)
+        return ftn;
+    for (i = 0; i < n_stage_table_g; i++) {
+        if (strcmp(name, stage_table_g[i].name) == 0)
+            return stage_table_g[i].ftn;
+    }
+    return NULL;
+}
+
+perr_t
+PDC_transform_stage_register(const char *name, pdc_transform_stage_t ftn)
+{
+    perr_t                       ret_value = SUCCEED;
+    pdc_transform_stage_entry_t *table;
+    int                          i;
+
+    FUNC_ENTER(NULL);
+
+    if (name == NULL || ftn == NULL || strchr(name, '|') || strchr(name, '=') || strchr(name, ':'))
+        PGOTO_ERROR(FAIL, "Invalid transform stage name");
+
+    for (i = 0; i < n_stage_table_g; i++) {
+        if (strcmp(name, stage_table_g[i].name) == 0) {
+            stage_table_g[i].ftn = ftn;
+            PGOTO_DONE(SUCCEED);
+        }
+    }
+    if (n_stage_table_g == stage_table_size_g) {
+        table = (pdc_transform_stage_entry_t *)realloc(
+            stage_table_g, sizeof(pdc_transform_stage_entry_t) * (stage_table_size_g + 8));
+        if (table == NULL)
+            PGOTO_ERROR(FAIL, "Transform stage table allocation failed");
+        stage_table_g = table;
+        stage_table_size_g += 8;
+    }
+    stage_table_g[n_stage_table_g].name = strdup(name);
+    stage_table_g[n_stage_table_g].ftn  = ftn;
+    n_stage_table_g++;
+
+done:
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
+
+struct _pdc_transform_pipeline *
+PDC_transform_pipeline_create(const char *spec)
+{
+    struct _pdc_transform_pipeline *ret_value = NULL;
+    struct _pdc_transform_pipeline *pipeline  = NULL;
+    struct _pdc_transform_stage *   stage;
+    char *                          stages = NULL, *name, *save = NULL, *sep;
+    void *                          ftnHandle;
+    size_t                          flags;
+    int                             all_concat = 1;
+
+    FUNC_ENTER(NULL);
+
+    if (spec == NULL)
+        PGOTO_ERROR(NULL, "No transform pipeline");
+    pipeline = (struct _pdc_transform_pipeline *)calloc(1, sizeof(struct _pdc_transform_pipeline));
+    stages   = strdup(spec);
+    if (pipeline == NULL || stages == NULL)
+        PGOTO_ERROR(NULL, "Transform pipeline allocation failed");
+    pipeline->spec = strdup(spec);
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_init(&pipeline->mutex);
+#endif
+
+    for (name = strtok_r(stages, "|", &save); name != NULL; name = strtok_r(NULL, "|", &save)) {
+        if (pipeline->nstage == PDC_PIPELINE_MAX_STAGE)
+            PGOTO_ERROR(NULL, "Transform pipeline has more than %d stages", PDC_PIPELINE_MAX_STAGE);
+        stage = &pipeline->stage[pipeline->nstage++];
+        if ((sep = strchr(name, '=')) != NULL) {
+            *sep++     = 0;
+            stage->arg = strdup(sep);
+        }
+        // A user function is resolved in its library, the other names are built-in or registered stages
+        if ((sep = strrchr(name, ':')) != NULL) {
+            *sep++ = 0;
+            if (PDC_get_ftnPtr_(name, sep, &ftnHandle) < 0)
+                PGOTO_ERROR(NULL, "Unable to resolve transform stage %s in %s", name, sep);
+            stage->ftnPtr = (pdc_transform_stage_t)ftnHandle;
+        }
+        else if ((stage->ftnPtr = PDC_transform_stage_find(name)) == NULL)
+            PGOTO_ERROR(NULL, "Unknown transform stage %s", name);
+
+        if ((flags = stage->ftnPtr(NULL, 0, PDC_UNKNOWN, NULL, 0, NULL, stage->arg)) == (size_t)-1)
+            PGOTO_ERROR(NULL, "Invalid argument of transform stage %s", name);
+        stage->flags = (int)flags;
+        if ((stage->flags & PDC_STAGE_FRAMED_INPUT) && pipeline->nstage > 1)
+            PGOTO_ERROR(NULL, "Transform stage %s takes framed data and must come first", name);
+        if ((stage->flags & PDC_STAGE_CONCAT) == 0)
+            all_concat = 0;
+    }
+    if (pipeline->nstage == 0)
+        PGOTO_ERROR(NULL, "Transform pipeline has no stage");
+
+    pipeline->framed_in  = pipeline->stage[0].flags & PDC_STAGE_FRAMED_INPUT ? 1 : 0;
+    pipeline->framed_out = all_concat ? 0 : 1;
+
+    ret_value = pipeline;
+    pipeline  = NULL;
+
+done:
+    fflush(stdout);
+    free(stages);
+    if (pipeline != NULL)
+        PDC_transform_pipeline_free(pipeline);
+    FUNC_LEAVE(ret_value);
+}
+
+void
+PDC_transform_pipeline_free(struct _pdc_transform_pipeline *pipeline)
+{
+    int i;
+
+    FUNC_ENTER(NULL);
+
+    if (pipeline != NULL) {
+        for (i = 0; i < pipeline->nstage; i++)
+            free(pipeline->stage[i].arg);
+        free(pipeline->scratch[0]);
+        free(pipeline->scratch[1]);
+        free(pipeline->spec);
+#ifdef ENABLE_MULTITHREAD
+        hg_thread_mutex_destroy(&pipeline->mutex);
+#endif
+        free(pipeline);
+    }
+
+    FUNC_LEAVE_VOID;
+}
+
+/*
+ * Run one stage on a chunk, a buffer that is too small grows and the stage is run again
+ *
+ * \param  stage[IN]            Stage to run
+ * \param  in[IN]               Input of the stage
+ * \param  in_size[IN]          Bytes of input
+ * \param  type[IN/OUT]         Type of the input, set to the type of the output
+ * \param  buf[IN/OUT]          Output buffer, grown with realloc
+ * \param  offset[IN]           Offset of the output in the buffer
+ * \param  capacity[IN/OUT]     Bytes of the buffer
+ * \param  grow[IN]             0 if the buffer cannot grow, otherwise 1 plus the number of outputs of the
+ *                              same size that are still to come, to make room for them at once
+ *
+ * \return Bytes of output/0 on failure
+ */
+static size_t
+PDC_transform_stage_run(struct _pdc_transform_stage *stage, const void *in, size_t in_size,
+                        pdc_var_type_t *type, void **buf, size_t offset, size_t *capacity, size_t grow)
+{
+    pdc_var_type_t out_type = *type;
+    size_t         n, size, avail = *capacity > offset ? *capacity - offset : 0;
+    void *         tmp;
+
+    n = stage->ftnPtr(in, in_size, *type, *buf == NULL ? NULL : (char *)*buf + offset, avail, &out_type,
+                      stage->arg);
+    if (n > avail) {
+        if (grow == 0)
+            return 0;
+        size = offset + n * grow;
+        if (size < *capacity + *capacity / 2)
+            size = *capacity + *capacity / 2;
+        if ((tmp = realloc(*buf, size)) == NULL)
+            return 0;
+        *buf      = tmp;
+        *capacity = size;
+        n = stage->ftnPtr(in, in_size, *type, (char *)*buf + offset, size - offset, &out_type, stage->arg);
+        if (n > size - offset)
+            return 0;
+    }
+    *type = out_type;
+
+    return n;
+}
+
+perr_t
+PDC_transform_pipeline_run(struct _pdc_transform_pipeline *pipeline, const void *in, size_t in_size,
+                           pdc_var_type_t in_type, void **out, size_t *out_size, pdc_var_type_t *out_type)
+{
+    perr_t         ret_value = SUCCEED;
+    const char *   chunk;
+    pdc_var_type_t type = in_type;
+    size_t         pos = 0, chunk_size, max_chunk, unit, used = 0, capacity, hdr, n = 0, src_size, grow;
+    uint64_t       frame;
+    void *         buf;
+    int            s, owned;
+
+    FUNC_ENTER(NULL);
+
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&pipeline->mutex);
+#endif
+
+    // A given output buffer has a fixed capacity, otherwise the output grows from the size of the input
+    owned    = *out == NULL ? 1 : 0;
+    buf      = *out;
+    capacity = owned ? 0 : *out_size;
+    hdr      = pipeline->framed_out ? sizeof(uint64_t) : 0;
+    unit     = in_type == PDC_UNKNOWN ? 0 : PDC_get_var_type_size(in_type);
+    if (unit == 0)
+        unit = 1;
+    max_chunk = PDC_PIPELINE_CHUNK_SIZE - PDC_PIPELINE_CHUNK_SIZE % unit;
+
+    while (pos < in_size) {
+        // The chunks of a framed input are its frames, other inputs are cut at whole elements
+        if (pipeline->framed_in) {
+            if (in_size - pos < sizeof(uint64_t))
+                PGOTO_ERROR(FAIL, "Truncated frame in transform pipeline input");
+            memcpy(&frame, (const char *)in + pos, sizeof(uint64_t));
+            pos += sizeof(uint64_t);
+            if (frame == 0 || frame > in_size - pos)
+                PGOTO_ERROR(FAIL, "Invalid frame in transform pipeline input");
+            chunk_size = (size_t)frame;
+        }
+        else
+            chunk_size = in_size - pos < max_chunk ? in_size - pos : max_chunk;
+        chunk = (const char *)in + pos;
+        pos += chunk_size;
+        type     = in_type;
+        src_size = chunk_size;
+
+        for (s = 0; s < pipeline->nstage; s++) {
+            if (s < pipeline->nstage - 1) {
+                n = PDC_transform_stage_run(&pipeline->stage[s], chunk, src_size, &type,
+                                            &pipeline->scratch[s & 1], 0, &pipeline->scratch_size[s & 1], 1);
+                chunk = (const char *)pipeline->scratch[s & 1];
+            }
+            else {
+                // The last stage writes to the output, which grows for the rest of the input at the ratio
+                // of this chunk
+                grow = owned ? 1 + (in_size - pos + chunk_size - 1) / chunk_size : 0;
+                n    = PDC_transform_stage_run(&pipeline->stage[s], chunk, src_size, &type, &buf, used + hdr,
+                                            &capacity, grow);
+            }
+            if (n == 0)
+                PGOTO_ERROR(FAIL, "Transform pipeline stage %d failed", s);
+            src_size = n;
+        }
+        if (hdr > 0) {
+            frame = n;
+            memcpy((char *)buf + used, &frame, sizeof(uint64_t));
+        }
+        used += hdr + n;
+    }
+
+    *out      = buf;
+    *out_size = used;
+    if (out_type != NULL)
+        *out_type = pipeline->framed_out ? PDC_INT8 : type;
+
+done:
+    if (ret_value != SUCCEED && owned)
+        free(buf);
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&pipeline->mutex);
+#endif
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
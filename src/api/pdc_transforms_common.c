@@ -27,6 +27,7 @@
  ************************************************************************ */
 
 #include "pdc_analysis_pkg.h"
+#include "pdc_transforms_pkg.h"
 #include "pdc_transforms_common.h"
 #include "pdc_client_server_common.h"
 
@@ -41,16 +42,26 @@ HG_TEST_RPC_CB(transform_ftn, handle)
     transform_ftn_in_t                     in;
     transform_ftn_out_t                    out       = {0, 0, 0, -1};
     struct _pdc_region_transform_ftn_info *thisFtn   = NULL;
+    struct _pdc_transform_pipeline *       pipeline  = NULL;
     void *                                 ftnHandle = NULL;
+    int                                    resolved;
 
     FUNC_ENTER(NULL);
 
     HG_Get_input(handle, &in);
 
-    if (PDC_get_ftnPtr_(in.ftn_name, in.loadpath, &ftnHandle) >= 0) {
+    // The stages of a pipeline are all resolved when it is created
+    if (in.pipeline)
+        resolved = (pipeline = PDC_transform_pipeline_create(in.ftn_name)) != NULL;
+    else
+        resolved = PDC_get_ftnPtr_(in.ftn_name, in.loadpath, &ftnHandle) >= 0;
+
+    if (resolved) {
         thisFtn = malloc(sizeof(struct _pdc_region_transform_ftn_info));
-        if (thisFtn == NULL)
+        if (thisFtn == NULL) {
+            PDC_transform_pipeline_free(pipeline);
             PGOTO_ERROR(HG_OTHER_ERROR, "transform_ftn_cb: Memory allocation failed");
+        }
         /* This sets up the index return for the client!
          * We probably need to add more info to the
          * 'thisFtn' structure, but this should be a
@@ -74,6 +85,7 @@ HG_TEST_RPC_CB(transform_ftn, handle)
         thisFtn->object_id = in.object_id;
         thisFtn->region_id = in.region_id;
         thisFtn->op_type   = (pdc_obj_transform_t)in.op_type;
+        thisFtn->pipeline  = pipeline;
         out.ret            = PDC_add_transform_ptr_to_registry_(thisFtn);
         out.client_index   = in.client_index;
         out.object_id      = in.object_id;
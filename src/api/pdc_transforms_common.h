@@ -51,6 +51,7 @@ typedef struct transform_ftn_in_t {
     int32_t           next_state;
     int8_t            op_type;
     int8_t            when;
+    int8_t            pipeline; /* 1 if ftn_name holds the stages of a pipeline */
 } transform_ftn_in_t;
 
 /* Define transform_ftn_out_t */
@@ -117,6 +118,11 @@ hg_proc_transform_ftn_in_t(hg_proc_t proc, void *data)
         // HG_LOG_ERROR("Proc error");
         return ret;
     }
+    ret = hg_proc_int8_t(proc, &struct_data->pipeline);
+    if (ret != HG_SUCCESS) {
+        // HG_LOG_ERROR("Proc error");
+        return ret;
+    }
 
     return ret;
 }
@@ -26,9 +26,13 @@
 
 #include "pdc_private.h"
 #include "pdc_transform.h"
+#include "mercury_thread_mutex.h"
 
 #define DATA_ANY 7
 
+#define PDC_PIPELINE_MAX_STAGE  16
+#define PDC_PIPELINE_CHUNK_SIZE 262144 /* bytes of input that go through all the stages at a time */
+
 /***************************/
 /* Library Private Structs */
 /***************************/
@@ -40,19 +44,46 @@ struct _pdc_region_transform_ftn_info {
     struct pdc_region_info *src_region;
     struct pdc_region_info *dest_region;
     size_t (*ftnPtr)();
-    int                      ftn_lastResult;
-    int                      readyState;
-    int                      nextState;
-    int                      client_id;
-    size_t                   type_extent;
-    size_t                   dest_extent;
-    pdc_var_type_t           type;
-    pdc_var_type_t           dest_type;
-    pdc_obj_transform_t      op_type;
-    pdc_data_movement_t      when;
-    _pdc_analysis_language_t lang;
-    void *                   data;
-    void *                   result;
+    int                             ftn_lastResult;
+    int                             readyState;
+    int                             nextState;
+    int                             client_id;
+    size_t                          type_extent;
+    size_t                          dest_extent;
+    pdc_var_type_t                  type;
+    pdc_var_type_t                  dest_type;
+    pdc_obj_transform_t             op_type;
+    pdc_data_movement_t             when;
+    _pdc_analysis_language_t        lang;
+    void *                          data;
+    void *                          result;
+    struct _pdc_transform_pipeline *pipeline; /* stages run in place of ftnPtr, or NULL */
+};
+
+struct _pdc_transform_stage {
+    pdc_transform_stage_t ftnPtr;
+    int                   flags; /* PDC_STAGE_* flags the stage returned */
+    char *                arg;   /* text after '=' in the stage, or NULL */
+};
+
+/*
+ * A pipeline passes the data through its stages one chunk at a time, so the intermediate results stay in
+ * cache and only the output of the last stage is written to memory. Stages that do not return
+ * PDC_STAGE_CONCAT, e.g. compressors, make the output framed: the output of each chunk is preceded by its
+ * size as a uint64_t, so a pipeline that starts with a PDC_STAGE_FRAMED_INPUT stage can split it again.
+ * The scratch buffers between the stages are only allocated or grown by the first chunks.
+ */
+struct _pdc_transform_pipeline {
+    char *                      spec; /* stages as registered, with the library paths resolved */
+    int                         nstage;
+    int                         framed_in;
+    int                         framed_out;
+    struct _pdc_transform_stage stage[PDC_PIPELINE_MAX_STAGE];
+    void *                      scratch[2];
+    size_t                      scratch_size[2];
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_t mutex; /* the scratch buffers are used by one run at a time */
+#endif
 };
 
 /***************************************/
@@ -65,4 +96,55 @@ struct _pdc_region_transform_ftn_info {
  */
 perr_t PDC_transform_end();
 
+/**
+ * Find a built-in stage or a stage registered with PDC_transform_stage_register
+ *
+ * \param name [IN]             Name of the stage
+ *
+ * \return Stage function/NULL if no stage has the name
+ */
+pdc_transform_stage_t PDC_transform_stage_find(const char *name);
+
+/**
+ * Find a built-in stage, which every process has
+ *
+ * \param name [IN]             Name of the stage
+ *
+ * \return Stage function/NULL if no built-in stage has the name
+ */
+pdc_transform_stage_t PDC_transform_stage_find_builtin(const char *name);
+
+/**
+ * Create a transform pipeline, the functions of its stages are resolved once here
+ *
+ * \param spec [IN]             Stages separated by '|', user functions are function:librarypath
+ *
+ * \return Pointer to the pipeline on success/NULL on failure
+ */
+struct _pdc_transform_pipeline *PDC_transform_pipeline_create(const char *spec);
+
+/**
+ * Run the data through a transform pipeline
+ *
+ * \param pipeline [IN]         Pointer to the pipeline
+ * \param in [IN]               Input data, framed if the pipeline starts with a PDC_STAGE_FRAMED_INPUT stage
+ * \param in_size [IN]          Bytes of input data
+ * \param in_type [IN]          Type of the input data
+ * \param out [IN/OUT]          Buffer of the output, allocated if NULL and then to be freed by the caller
+ * \param out_size [IN/OUT]     Capacity of a given output buffer, set to the bytes of output
+ * \param out_type [OUT]        Type of the output, PDC_INT8 if it is framed
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_transform_pipeline_run(struct _pdc_transform_pipeline *pipeline, const void *in, size_t in_size,
+                                  pdc_var_type_t in_type, void **out, size_t *out_size,
+                                  pdc_var_type_t *out_type);
+
+/**
+ * Free a transform pipeline
+ *
+ * \param pipeline [IN]         Pointer to the pipeline
+ */
+void PDC_transform_pipeline_free(struct _pdc_transform_pipeline *pipeline);
+
 #endif /* PDC_TRANSFORMS_H */
@@ -18,8 +18,20 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 
  */
 
-/* Hash table implementation */
-
+/* Hash table implementation
+ *
+ * Open addressing in the style of Swiss tables.  Each slot has a
+ * control byte, either empty, deleted or the low 7 bits of the hash of
+ * its key.  Slots are probed in groups of 8, the 8 control bytes of a
+ * group are compared against the hash at once as one 64-bit word, so
+ * most probes touch one control word and one slot.  Slots hold the key,
+ * value and full hash inline, there is no allocation per entry.
+ *
+ * When the table grows, the entries stay in the old slots and are moved
+ * to the new slots a few at a time by later inserts.  Lookups and
+ * removes check both, and never move entries. */
+
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include "pdc_hash-table.h"
@@ -28,286 +40,456 @@ CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include "alloc-testing.h"
 #endif
 
+/* Control byte values, a full slot has the low 7 bits of its hash */
+
+#define HASH_TABLE_CTRL_EMPTY   0x80
+#define HASH_TABLE_CTRL_DELETED 0xFE
+
+/* Number of slots of a probe group and the minimum table size */
+
+#define HASH_TABLE_GROUP_SIZE 8
+#define HASH_TABLE_MIN_SIZE   64
+
+/* Number of old slots moved to the new slots by each insert while the
+ * table is being enlarged */
+
+#define HASH_TABLE_MIGRATE_STEP 16
+
+#define HASH_TABLE_LSB 0x0101010101010101ULL
+#define HASH_TABLE_MSB 0x8080808080808080ULL
+
 struct _HashTableEntry {
-    HashTablePair   pair;
-    HashTableEntry *next;
+    HashTableKey   key;
+    HashTableValue value;
+    unsigned int   hash;
+    uint32_t       int_key;
 };
 
+typedef struct HashTableSlots {
+    uint8_t *       ctrl;
+    HashTableEntry *entries;
+    unsigned int    size;
+    unsigned int    used;
+} HashTableSlots;
+
 struct _HashTable {
-    HashTableEntry **      table;
-    unsigned int           table_size;
+    HashTableSlots         slots;
+    HashTableSlots         old_slots;
+    unsigned int           migrate_pos;
     HashTableHashFunc      hash_func;
     HashTableEqualFunc     equal_func;
     HashTableKeyFreeFunc   key_free_func;
     HashTableValueFreeFunc value_free_func;
     unsigned int           entries;
-    unsigned int           prime_index;
+    int                    int_keys;
 };
 
-/* This is a set of good hash table prime numbers, from:
- *   http://planetmath.org/encyclopedia/GoodHashTablePrimes.html
- * Each prime is roughly double the previous value, and as far as
- * possible from the nearest powers of two. */
+/* Hash of an inline integer key, the finalizer of MurmurHash3 so that
+ * both the group and the control byte get well mixed bits */
 
-static const unsigned int hash_table_primes[] = {
-    193,      389,      769,      1543,      3079,      6151,      12289,     24593,
-    49157,    98317,    196613,   393241,    786433,    1572869,   3145739,   6291469,
-    12582917, 25165843, 50331653, 100663319, 201326611, 402653189, 805306457, 1610612741,
-};
+static unsigned int
+hash_table_int_hash(uint32_t key)
+{
+    key ^= key >> 16;
+    key *= 0x85ebca6b;
+    key ^= key >> 13;
+    key *= 0xc2b2ae35;
+    key ^= key >> 16;
 
-static const unsigned int hash_table_num_primes = sizeof(hash_table_primes) / sizeof(int);
+    return key;
+}
+
+static unsigned int
+hash_table_hash(HashTable *hash_table, HashTableKey key)
+{
+    if (hash_table->int_keys) {
+        return hash_table_int_hash(*(uint32_t *)key);
+    }
 
-/* Internal function used to allocate the table on hash table creation
- * and when enlarging the table */
+    return hash_table->hash_func(key);
+}
 
 static int
-hash_table_allocate_table(HashTable *hash_table)
+hash_table_key_equal(HashTable *hash_table, HashTableEntry *entry, HashTableKey key)
 {
-    unsigned int new_table_size;
+    if (hash_table->int_keys) {
+        return entry->int_key == *(uint32_t *)key;
+    }
 
-    /* Determine the table size based on the current prime index.
-     * An attempt is made here to ensure sensible behavior if the
-     * maximum prime is exceeded, but in practice other things are
-     * likely to break long before that happens. */
+    return hash_table->equal_func(entry->key, key) != 0;
+}
 
-    if (hash_table->prime_index < hash_table_num_primes) {
-        new_table_size = hash_table_primes[hash_table->prime_index];
-    }
-    else {
-        new_table_size = hash_table->entries * 10;
-    }
+/* Load the control bytes of a group, byte i of the group is byte i of
+ * the word counting from the least significant byte */
 
-    hash_table->table_size = new_table_size;
+static uint64_t
+hash_table_group_load(const uint8_t *ctrl)
+{
+    uint64_t word;
 
-    /* Allocate the table and initialise to NULL for all entries */
-    hash_table->table = calloc(hash_table->table_size, sizeof(HashTableEntry *));
+    memcpy(&word, ctrl, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
 
-    return hash_table->table != NULL;
+    return word;
 }
 
-/* Free an entry, calling the free functions if there are any registered */
-static void
-hash_table_free_entry(HashTable *hash_table, HashTableEntry *entry)
+/* Bit 7 of byte i is set if slot i of the group may hold h2.  A false
+ * match is possible in the byte after a real match, keys are compared
+ * anyway */
+
+static uint64_t
+hash_table_group_match(uint64_t word, uint8_t h2)
 {
-    HashTablePair *pair;
+    uint64_t x = word ^ (HASH_TABLE_LSB * h2);
 
-    pair = &(entry->pair);
+    return (x - HASH_TABLE_LSB) & ~x & HASH_TABLE_MSB;
+}
 
-    /* If there is a function registered for freeing keys, use it to free
-     * the key */
-    if (hash_table->key_free_func != NULL) {
-        hash_table->key_free_func(pair->key);
-    }
+/* Bit 7 of byte i is set if slot i of the group is empty */
 
-    /* Likewise with the value */
-    if (hash_table->value_free_func != NULL) {
-        hash_table->value_free_func(pair->value);
+static uint64_t
+hash_table_group_match_empty(uint64_t word)
+{
+    return word & (~word << 6) & HASH_TABLE_MSB;
+}
+
+/* Bit 7 of byte i is set if slot i of the group is empty or deleted */
+
+static uint64_t
+hash_table_group_match_free(uint64_t word)
+{
+    return word & HASH_TABLE_MSB;
+}
+
+/* Index in the group of the lowest matching slot */
+
+static unsigned int
+hash_table_group_first(uint64_t match)
+{
+    return __builtin_ctzll(match) >> 3;
+}
+
+static int
+hash_table_slots_allocate(HashTableSlots *slots, unsigned int size)
+{
+    slots->size    = size;
+    slots->used    = 0;
+    slots->ctrl    = malloc(size);
+    slots->entries = malloc(size * sizeof(HashTableEntry));
+
+    if (slots->ctrl == NULL || slots->entries == NULL) {
+        free(slots->ctrl);
+        free(slots->entries);
+        slots->ctrl    = NULL;
+        slots->entries = NULL;
+        slots->size    = 0;
+
+        return 0;
     }
 
-    /* Free the data structure */
-    free(entry);
+    memset(slots->ctrl, HASH_TABLE_CTRL_EMPTY, size);
+
+    return 1;
 }
 
-HashTable *
-hash_table_new(HashTableHashFunc hash_func, HashTableEqualFunc equal_func)
+static void
+hash_table_slots_free(HashTableSlots *slots)
 {
-    HashTable *hash_table;
+    free(slots->ctrl);
+    free(slots->entries);
+    slots->ctrl    = NULL;
+    slots->entries = NULL;
+    slots->size    = 0;
+    slots->used    = 0;
+}
 
-    /* Allocate a new hash table structure */
-    hash_table = (HashTable *)malloc(sizeof(HashTable));
+/* Find the slot of a key, -1 if the key is not in these slots.  Groups
+ * are probed in triangular order, which visits every group of a power
+ * of two number of groups */
 
-    if (hash_table == NULL) {
-        return NULL;
+static int
+hash_table_slots_find(HashTable *hash_table, HashTableSlots *slots, unsigned int hash, HashTableKey key)
+{
+    unsigned int num_groups, group, i, index;
+    uint64_t     word, match;
+    uint8_t      h2;
+
+    if (slots->size == 0) {
+        return -1;
     }
 
-    hash_table->hash_func       = hash_func;
-    hash_table->equal_func      = equal_func;
-    hash_table->key_free_func   = NULL;
-    hash_table->value_free_func = NULL;
-    hash_table->entries         = 0;
-    hash_table->prime_index     = 0;
+    num_groups = slots->size / HASH_TABLE_GROUP_SIZE;
+    group      = (hash >> 7) & (num_groups - 1);
+    h2         = hash & 0x7F;
 
-    /* Allocate the table */
-    if (!hash_table_allocate_table(hash_table)) {
-        free(hash_table);
+    for (i = 0; i < num_groups; ++i) {
+        word  = hash_table_group_load(slots->ctrl + group * HASH_TABLE_GROUP_SIZE);
+        match = hash_table_group_match(word, h2);
 
-        return NULL;
+        while (match != 0) {
+            index = group * HASH_TABLE_GROUP_SIZE + hash_table_group_first(match);
+            if (slots->ctrl[index] == h2 && slots->entries[index].hash == hash &&
+                hash_table_key_equal(hash_table, &slots->entries[index], key)) {
+                return index;
+            }
+            match &= match - 1;
+        }
+
+        /* An empty slot ends the probe, the key would have been put there */
+        if (hash_table_group_match_empty(word) != 0) {
+            return -1;
+        }
+
+        group = (group + i + 1) & (num_groups - 1);
     }
 
-    return hash_table;
+    return -1;
 }
 
-void
-hash_table_free(HashTable *hash_table)
+/* Find an empty or deleted slot for a new key with this hash */
+
+static unsigned int
+hash_table_slots_find_free(HashTableSlots *slots, unsigned int hash)
 {
-    HashTableEntry *rover;
-    HashTableEntry *next;
-    unsigned int    i;
+    unsigned int num_groups, group, i;
+    uint64_t     word, match;
 
-    /* Free all entries in all chains */
-    for (i = 0; i < hash_table->table_size; ++i) {
-        rover = hash_table->table[i];
-        while (rover != NULL) {
-            next = rover->next;
-            hash_table_free_entry(hash_table, rover);
-            rover = next;
+    num_groups = slots->size / HASH_TABLE_GROUP_SIZE;
+    group      = (hash >> 7) & (num_groups - 1);
+
+    for (i = 0; i < num_groups; ++i) {
+        word  = hash_table_group_load(slots->ctrl + group * HASH_TABLE_GROUP_SIZE);
+        match = hash_table_group_match_free(word);
+        if (match != 0) {
+            return group * HASH_TABLE_GROUP_SIZE + hash_table_group_first(match);
         }
-    }
 
-    /* Free the table */
-    free(hash_table->table);
+        group = (group + i + 1) & (num_groups - 1);
+    }
 
-    /* Free the hash table structure */
-    free(hash_table);
+    /* The table is never full, the load is kept under 7/8 */
+    return 0;
 }
 
-void
-hash_table_register_free_functions(HashTable *hash_table, HashTableKeyFreeFunc key_free_func,
-                                   HashTableValueFreeFunc value_free_func)
+/* Put an entry into a free slot */
+
+static void
+hash_table_slots_put(HashTableSlots *slots, HashTableEntry *entry)
 {
-    hash_table->key_free_func   = key_free_func;
-    hash_table->value_free_func = value_free_func;
+    unsigned int index;
+
+    index = hash_table_slots_find_free(slots, entry->hash);
+
+    if (slots->ctrl[index] == HASH_TABLE_CTRL_EMPTY) {
+        ++slots->used;
+    }
+
+    slots->ctrl[index]    = entry->hash & 0x7F;
+    slots->entries[index] = *entry;
 }
 
-static int
-hash_table_enlarge(HashTable *hash_table)
+/* Free the key and value of an entry, calling the free functions if
+ * there are any registered */
+
+static void
+hash_table_free_entry(HashTable *hash_table, HashTableEntry *entry)
 {
-    HashTableEntry **old_table;
-    unsigned int     old_table_size;
-    unsigned int     old_prime_index;
-    HashTableEntry * rover;
-    HashTablePair *  pair;
-    HashTableEntry * next;
-    unsigned int     index;
-    unsigned int     i;
+    /* Inline keys are not owned by the caller */
+    if (!hash_table->int_keys && hash_table->key_free_func != NULL) {
+        hash_table->key_free_func(entry->key);
+    }
 
-    /* Store a copy of the old table */
-    old_table       = hash_table->table;
-    old_table_size  = hash_table->table_size;
-    old_prime_index = hash_table->prime_index;
+    if (hash_table->value_free_func != NULL) {
+        hash_table->value_free_func(entry->value);
+    }
+}
 
-    /* Allocate a new, larger table */
+/* Move up to num_slots old slots to the new slots, the old slots are
+ * freed once all are moved */
 
-    ++hash_table->prime_index;
+static void
+hash_table_migrate(HashTable *hash_table, unsigned int num_slots)
+{
+    HashTableSlots *old_slots = &hash_table->old_slots;
+    unsigned int    i;
 
-    if (!hash_table_allocate_table(hash_table)) {
+    if (old_slots->size == 0) {
+        return;
+    }
 
-        /* Failed to allocate the new table */
-        hash_table->table       = old_table;
-        hash_table->table_size  = old_table_size;
-        hash_table->prime_index = old_prime_index;
+    for (i = 0; i < num_slots && hash_table->migrate_pos < old_slots->size; ++i) {
+        if ((old_slots->ctrl[hash_table->migrate_pos] & 0x80) == 0) {
+            hash_table_slots_put(&hash_table->slots, &old_slots->entries[hash_table->migrate_pos]);
 
-        return 0;
+            /* Moved slots become deleted, so that probes for other keys
+             * in the old slots do not stop early */
+            old_slots->ctrl[hash_table->migrate_pos] = HASH_TABLE_CTRL_DELETED;
+        }
+        ++hash_table->migrate_pos;
     }
 
-    /* Link all entries from all chains into the new table */
-    for (i = 0; i < old_table_size; ++i) {
-        rover = old_table[i];
+    if (hash_table->migrate_pos == old_slots->size) {
+        hash_table_slots_free(old_slots);
+        hash_table->migrate_pos = 0;
+    }
+}
 
-        while (rover != NULL) {
-            next = rover->next;
+/* Start moving the entries to new slots, twice the size if the table
+ * is more than half full, otherwise the same size to clear deleted
+ * slots.  The previous move is finished first */
 
-            /* Fetch rover HashTablePair */
-            pair = &(rover->pair);
+static int
+hash_table_enlarge(HashTable *hash_table)
+{
+    HashTableSlots new_slots;
+    unsigned int   new_size;
 
-            /* Find the index into the new table */
-            index = hash_table->hash_func(pair->key) % hash_table->table_size;
+    hash_table_migrate(hash_table, hash_table->old_slots.size);
 
-            /* Link this entry into the chain */
-            rover->next              = hash_table->table[index];
-            hash_table->table[index] = rover;
+    new_size = hash_table->slots.size;
+    if (hash_table->entries >= new_size / 2) {
+        new_size *= 2;
+    }
 
-            /* Advance to next in the chain */
-            rover = next;
-        }
+    if (!hash_table_slots_allocate(&new_slots, new_size)) {
+        return 0;
     }
 
-    /* Free the old table */
-    free(old_table);
+    hash_table->old_slots   = hash_table->slots;
+    hash_table->slots       = new_slots;
+    hash_table->migrate_pos = 0;
 
     return 1;
 }
 
-int
-hash_table_insert(HashTable *hash_table, HashTableKey key, HashTableValue value)
+static HashTable *
+hash_table_new_common(HashTableHashFunc hash_func, HashTableEqualFunc equal_func, int int_keys)
 {
-    HashTableEntry *rover;
-    HashTablePair * pair;
-    HashTableEntry *newentry;
-    unsigned int    index;
+    HashTable *hash_table;
 
-    /* If there are too many items in the table with respect to the table
-     * size, the number of hash collisions increases and performance
-     * decreases. Enlarge the table size to prevent this happening */
-    if ((hash_table->entries * 3) / hash_table->table_size > 0) {
+    /* Allocate a new hash table structure */
+    hash_table = (HashTable *)malloc(sizeof(HashTable));
 
-        /* Table is more than 1/3 full */
-        if (!hash_table_enlarge(hash_table)) {
-            /* Failed to enlarge the table */
-            return 0;
-        }
+    if (hash_table == NULL) {
+        return NULL;
     }
 
-    /* Generate the hash of the key and hence the index into the table */
-    index = hash_table->hash_func(key) % hash_table->table_size;
+    memset(hash_table, 0, sizeof(HashTable));
+    hash_table->hash_func  = hash_func;
+    hash_table->equal_func = equal_func;
+    hash_table->int_keys   = int_keys;
 
-    /* Traverse the chain at this location and look for an existing
-     * entry with the same key */
-    rover = hash_table->table[index];
-
-    while (rover != NULL) {
-        /* Fetch rover's HashTablePair entry */
-        pair = &(rover->pair);
+    /* Allocate the table */
+    if (!hash_table_slots_allocate(&hash_table->slots, HASH_TABLE_MIN_SIZE)) {
+        free(hash_table);
 
-        if (hash_table->equal_func(pair->key, key) != 0) {
+        return NULL;
+    }
 
-            /* Same key: overwrite this entry with new data */
+    return hash_table;
+}
 
-            /* If there is a value free function, free the old data
-             * before adding in the new data */
-            if (hash_table->value_free_func != NULL) {
-                hash_table->value_free_func(pair->value);
-            }
+HashTable *
+hash_table_new(HashTableHashFunc hash_func, HashTableEqualFunc equal_func)
+{
+    return hash_table_new_common(hash_func, equal_func, 0);
+}
 
-            /* Same with the key: use the new key value and free
-             * the old one */
-            if (hash_table->key_free_func != NULL) {
-                hash_table->key_free_func(pair->key);
-            }
+HashTable *
+hash_table_new_uint32(void)
+{
+    return hash_table_new_common(NULL, NULL, 1);
+}
 
-            pair->key   = key;
-            pair->value = value;
+static void
+hash_table_slots_free_entries(HashTable *hash_table, HashTableSlots *slots)
+{
+    unsigned int i;
 
-            /* Finished */
-            return 1;
+    for (i = 0; i < slots->size; ++i) {
+        if ((slots->ctrl[i] & 0x80) == 0) {
+            hash_table_free_entry(hash_table, &slots->entries[i]);
         }
+    }
+}
+
+void
+hash_table_free(HashTable *hash_table)
+{
+    /* Free all entries of both the new and the old slots */
+    hash_table_slots_free_entries(hash_table, &hash_table->slots);
+    hash_table_slots_free_entries(hash_table, &hash_table->old_slots);
 
-        rover = rover->next;
+    hash_table_slots_free(&hash_table->slots);
+    hash_table_slots_free(&hash_table->old_slots);
+
+    /* Free the hash table structure */
+    free(hash_table);
+}
+
+void
+hash_table_register_free_functions(HashTable *hash_table, HashTableKeyFreeFunc key_free_func,
+                                   HashTableValueFreeFunc value_free_func)
+{
+    hash_table->key_free_func   = key_free_func;
+    hash_table->value_free_func = value_free_func;
+}
+
+int
+hash_table_insert(HashTable *hash_table, HashTableKey key, HashTableValue value)
+{
+    HashTableSlots *slots;
+    HashTableEntry *entry;
+    HashTableEntry  newentry;
+    unsigned int    hash;
+    int             index;
+
+    hash = hash_table_hash(hash_table, key);
+
+    /* A key is in either the new or the old slots, look in both for an
+     * existing entry with the same key */
+    slots = &hash_table->slots;
+    index = hash_table_slots_find(hash_table, slots, hash, key);
+    if (index < 0) {
+        slots = &hash_table->old_slots;
+        index = hash_table_slots_find(hash_table, slots, hash, key);
     }
 
-    /* Not in the hash table yet.  Create a new entry */
-    newentry = (HashTableEntry *)malloc(sizeof(HashTableEntry));
+    if (index >= 0) {
 
-    if (newentry == NULL) {
-        return 0;
+        /* Same key: overwrite this entry with new data, freeing the
+         * old data and key */
+        entry = &slots->entries[index];
+        hash_table_free_entry(hash_table, entry);
+
+        entry->key   = key;
+        entry->value = value;
+
+        return 1;
     }
-    newentry->pair.key   = key;
-    newentry->pair.value = value;
 
-    /* Link into the list */
-    newentry->next = hash_table->table[index];
-#ifdef ENABLE_MULTITHREAD
-    hg_thread_mutex_lock(&hash_table_new_mutex_g);
-#endif
-    hash_table->table[index] = newentry;
+    /* Keep the slots under 7/8 full, counting deleted slots, so that
+     * probes stay short and always find an empty slot */
+    if ((hash_table->slots.used + 1) * 8 > hash_table->slots.size * 7) {
+        if (!hash_table_enlarge(hash_table)) {
+            /* Failed to enlarge the table */
+            return 0;
+        }
+    }
+
+    newentry.key     = key;
+    newentry.value   = value;
+    newentry.hash    = hash;
+    newentry.int_key = hash_table->int_keys ? *(uint32_t *)key : 0;
+    hash_table_slots_put(&hash_table->slots, &newentry);
 
     /* Maintain the count of the number of entries */
     ++hash_table->entries;
 
-    /* Added successfully */
-#ifdef ENABLE_MULTITHREAD
-    hg_thread_mutex_unlock(&hash_table_new_mutex_g);
-#endif
+    /* Move some of the old slots along */
+    hash_table_migrate(hash_table, HASH_TABLE_MIGRATE_STEP);
 
     return 1;
 }
@@ -315,27 +497,19 @@ hash_table_insert(HashTable *hash_table, HashTableKey key, HashTableValue value)
 HashTableValue
 hash_table_lookup(HashTable *hash_table, HashTableKey key)
 {
-    HashTableEntry *rover;
-    HashTablePair * pair;
-    unsigned int    index;
+    unsigned int hash;
+    int          index;
 
-    /* Generate the hash of the key and hence the index into the table */
-    index = hash_table->hash_func(key) % hash_table->table_size;
+    hash = hash_table_hash(hash_table, key);
 
-    /* Walk the chain at this index until the corresponding entry is
-     * found */
-
-    rover = hash_table->table[index];
-
-    while (rover != NULL) {
-        pair = &(rover->pair);
-        if (hash_table->equal_func(key, pair->key) != 0) {
-
-            /* Found the entry.  Return the data. */
-            return pair->value;
-        }
+    index = hash_table_slots_find(hash_table, &hash_table->slots, hash, key);
+    if (index >= 0) {
+        return hash_table->slots.entries[index].value;
+    }
 
-        rover = rover->next;
+    index = hash_table_slots_find(hash_table, &hash_table->old_slots, hash, key);
+    if (index >= 0) {
+        return hash_table->old_slots.entries[index].value;
     }
 
     /* Not found */
@@ -345,132 +519,106 @@ hash_table_lookup(HashTable *hash_table, HashTableKey key)
 int
 hash_table_remove(HashTable *hash_table, HashTableKey key)
 {
-    HashTableEntry **rover;
-    HashTableEntry * entry;
-    HashTablePair *  pair;
-    unsigned int     index;
-    int              result;
-
-    /* Generate the hash of the key and hence the index into the table */
-
-    index = hash_table->hash_func(key) % hash_table->table_size;
-
-    /* Rover points at the pointer which points at the current entry
-     * in the chain being inspected.  ie. the entry in the table, or
-     * the "next" pointer of the previous entry in the chain.  This
-     * allows us to unlink the entry when we find it. */
-
-    result = 0;
-    rover  = &hash_table->table[index];
-
-    while (*rover != NULL) {
+    HashTableSlots *slots;
+    HashTableEntry  entry;
+    unsigned int    hash;
+    int             index;
+
+    hash = hash_table_hash(hash_table, key);
+
+    slots = &hash_table->slots;
+    index = hash_table_slots_find(hash_table, slots, hash, key);
+    if (index < 0) {
+        slots = &hash_table->old_slots;
+        index = hash_table_slots_find(hash_table, slots, hash, key);
+    }
 
-        pair = &((*rover)->pair);
+    if (index < 0) {
+        return 0;
+    }
 
-        if (hash_table->equal_func(key, pair->key) != 0) {
+    /* The slot becomes deleted rather than empty, other keys may have
+     * probed past it.  No entry moves, so removing the current entry
+     * while iterating is safe.  The key may be the one stored in the
+     * entry, so free it last */
+    entry              = slots->entries[index];
+    slots->ctrl[index] = HASH_TABLE_CTRL_DELETED;
+    --hash_table->entries;
 
-            /* This is the entry to remove */
-            entry = *rover;
+    hash_table_free_entry(hash_table, &entry);
 
-            /* Unlink from the list */
-            *rover = entry->next;
+    return 1;
+}
 
-            /* Destroy the entry structure */
-            hash_table_free_entry(hash_table, entry);
+unsigned int
+hash_table_num_entries(HashTable *hash_table)
+{
+    return hash_table->entries;
+}
 
-            /* Track count of entries */
-            --hash_table->entries;
+/* Slots are numbered across the new and the old slots, the old slots
+ * follow the new slots while the table is being enlarged.  Returns the
+ * first full slot from this number on */
 
-            result = 1;
+static unsigned int
+hash_table_iter_skip(HashTable *hash_table, unsigned int slot)
+{
+    unsigned int size = hash_table->slots.size;
 
-            break;
+    for (; slot < size; ++slot) {
+        if ((hash_table->slots.ctrl[slot] & 0x80) == 0) {
+            return slot;
         }
-
-        /* Advance to the next entry */
-        rover = &((*rover)->next);
     }
 
-    return result;
-}
+    for (; slot < size + hash_table->old_slots.size; ++slot) {
+        if ((hash_table->old_slots.ctrl[slot - size] & 0x80) == 0) {
+            return slot;
+        }
+    }
 
-unsigned int
-hash_table_num_entries(HashTable *hash_table)
-{
-    return hash_table->entries;
+    return slot;
 }
 
 void
 hash_table_iterate(HashTable *hash_table, HashTableIterator *iterator)
 {
-    unsigned int chain;
-
     iterator->hash_table = hash_table;
-
-    /* Default value of next if no entries are found. */
-    iterator->next_entry = NULL;
-
-    /* Find the first entry */
-    for (chain = 0; chain < hash_table->table_size; ++chain) {
-
-        if (hash_table->table[chain] != NULL) {
-            iterator->next_entry = hash_table->table[chain];
-            iterator->next_chain = chain;
-            break;
-        }
-    }
+    iterator->next_slot  = hash_table_iter_skip(hash_table, 0);
 }
 
 int
 hash_table_iter_has_more(HashTableIterator *iterator)
 {
-    return iterator->next_entry != NULL;
+    HashTable *hash_table = iterator->hash_table;
+
+    return iterator->next_slot < hash_table->slots.size + hash_table->old_slots.size;
 }
 
 HashTablePair
 hash_table_iter_next(HashTableIterator *iterator)
 {
-    HashTableEntry *current_entry;
-    HashTable *     hash_table;
+    HashTable *     hash_table = iterator->hash_table;
+    HashTableEntry *entry;
     HashTablePair   pair = {NULL, NULL};
-    unsigned int    chain;
-
-    hash_table = iterator->hash_table;
 
-    if (iterator->next_entry == NULL) {
+    if (!hash_table_iter_has_more(iterator)) {
         return pair;
     }
 
-    /* Result is immediately available */
-    current_entry = iterator->next_entry;
-    pair          = current_entry->pair;
-
-    /* Find the next entry */
-    if (current_entry->next != NULL) {
-
-        /* Next entry in current chain */
-        iterator->next_entry = current_entry->next;
+    if (iterator->next_slot < hash_table->slots.size) {
+        entry = &hash_table->slots.entries[iterator->next_slot];
     }
     else {
-        /* None left in this chain, so advance to the next chain */
-        chain = iterator->next_chain + 1;
-
-        /* Default value if no next chain found */
-        iterator->next_entry = NULL;
-
-        while (chain < hash_table->table_size) {
-
-            /* Is there anything in this chain? */
-            if (hash_table->table[chain] != NULL) {
-                iterator->next_entry = hash_table->table[chain];
-                break;
-            }
+        entry = &hash_table->old_slots.entries[iterator->next_slot - hash_table->slots.size];
+    }
 
-            /* Try the next chain */
-            ++chain;
-        }
+    /* Inline keys are returned as a pointer into the table */
+    pair.key   = hash_table->int_keys ? (HashTableKey)&entry->int_key : entry->key;
+    pair.value = entry->value;
 
-        iterator->next_chain = chain;
-    }
+    /* Find the next entry */
+    iterator->next_slot = hash_table_iter_skip(hash_table, iterator->next_slot + 1);
 
     return pair;
 }
@@ -94,9 +94,8 @@ typedef struct _HashTablePair {
  */
 
 struct _HashTableIterator {
-    HashTable *     hash_table;
-    HashTableEntry *next_entry;
-    unsigned int    next_chain;
+    HashTable *  hash_table;
+    unsigned int next_slot;
 };
 
 /**
@@ -152,6 +151,19 @@ typedef void (*HashTableValueFreeFunc)(HashTableValue value);
 
 HashTable *hash_table_new(HashTableHashFunc hash_func, HashTableEqualFunc equal_func);
 
+/**
+ * Create a new hash table with uint32_t keys stored in the table.
+ * Keys are passed as pointers to a uint32_t, the value is copied on
+ * insert so the pointer need not stay valid, and no key free function
+ * is called.  Iterated keys point into the table.
+ *
+ * @return                     A new hash table structure, or NULL if it
+ *                             was not possible to allocate the new hash
+ *                             table.
+ */
+
+HashTable *hash_table_new_uint32(void);
+
 /**
  * Destroy a hash table.
  *
@@ -174,7 +186,8 @@ void hash_table_register_free_functions(HashTable *hash_table, HashTableKeyFreeF
 
 /**
  * Insert a value into a hash table, overwriting any existing entry
- * using the same key.
+ * using the same key.  When the table grows, its entries are moved to
+ * the larger table a few slots per insert rather than all at once.
  *
  * @param hash_table           The hash table.
  * @param key                  The key for the new value.
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <time.h>
 #include <sys/time.h>
 #include <unistd.h>
@@ -53,9 +54,11 @@
 #include "pdc_analysis_pkg.h"
 #include "pdc_client_server_common.h"
 #include "pdc_transforms_common.h"
+#include "pdc_placement.h"
 #include "pdc_server.h"
 #include "pdc_server_metadata.h"
 #include "pdc_server_data.h"
+#include "pdc_server_tier.h"
 #include "pdc_timing.h"
 
 #ifdef PDC_HAS_CRAY_DRC
@@ -64,6 +67,9 @@
 
 #define PDC_CHECKPOINT_INTERVAL         200
 #define PDC_CHECKPOINT_MIN_INTERVAL_SEC 300
+#define PDC_METADATA_LOG_COMPACT_MB     64
+#define PDC_RESTART_MAX_NTHREAD         8
+#define PDC_RESTART_MIN_OBJ_PER_THREAD  4096
 
 // Global debug variable to control debug printfs
 int is_debug_g       = 0;
@@ -102,6 +108,7 @@ hg_id_t server_checkpoint_rpc_register_id_g;
 hg_id_t send_shm_register_id_g;
 hg_id_t send_client_storage_meta_rpc_register_id_g;
 hg_id_t send_read_sel_obj_id_rpc_register_id_g;
+hg_id_t query_cache_invalidate_rpc_register_id_g;
 hg_id_t send_nhits_register_id_g;
 hg_id_t send_bulk_rpc_register_id_g;
 
@@ -128,10 +135,19 @@ double            fwrite_total_MB              = 0;
 int               n_read_from_bb_g             = 0;
 int               read_from_bb_size_g          = 0;
 int               gen_hist_g                   = 0;
+int               gen_sketch_g                 = 0;
 int               gen_fastbit_idx_g            = 0;
 int               use_fastbit_idx_g            = 0;
+int               query_plan_report_g          = 0;
+int               disable_query_cache_g        = 0;
+int               disable_metadata_log_g       = 0;
+int               disable_name_bloom_g         = 0;
+uint64_t          name_bloom_capacity_g        = PDC_NAME_BLOOM_CAPACITY;
+uint32_t          metadata_lease_ms_g          = PDC_METADATA_LEASE_MS;
+uint64_t          metadata_log_compact_size_g  = PDC_METADATA_LOG_COMPACT_MB * 1048576ULL;
 char *            gBinningOption               = NULL;
 
+
 double server_write_time_g                  = 0.0;
 double server_read_time_g                   = 0.0;
 double server_get_storage_info_time_g       = 0.0;
@@ -683,6 +699,13 @@ PDC_Server_init(int port, hg_class_t **hg_class, hg_context_t **hg_context)
     // set server id start
     pdc_id_seq_g = pdc_id_seq_g * (pdc_server_rank_g + 1);
 
+    // Route names to servers the same way as the clients do
+    if (PDC_placement_init_env(pdc_server_size_g) != SUCCEED) {
+        printf("==PDC_SERVER[%d]: Error setting up server placement\n", pdc_server_rank_g);
+        ret_value = FAIL;
+        goto done;
+    }
+
     // Create server tmp dir
     PDC_mkdir(pdc_server_tmp_dir_g);
 
@@ -798,9 +821,7 @@ drc_access_again:
     hg_thread_pool_init(1, &hg_test_thread_pool_fs_g);
     if (pdc_server_rank_g == 0)
         printf("\n==PDC_SERVER[%d]: Starting server with %d threads...\n", pdc_server_rank_g, n_thread);
-    hg_thread_mutex_init(&hash_table_new_mutex_g);
     hg_thread_mutex_init(&pdc_client_info_mutex_g);
-    hg_thread_mutex_init(&pdc_metadata_hash_table_mutex_g);
     hg_thread_mutex_init(&pdc_container_hash_table_mutex_g);
     hg_thread_mutex_init(&pdc_client_addr_mutex_g);
     hg_thread_mutex_init(&pdc_time_mutex_g);
@@ -810,6 +831,8 @@ drc_access_again:
     hg_thread_mutex_init(&total_mem_usage_mutex_g);
     hg_thread_mutex_init(&data_read_list_mutex_g);
     hg_thread_mutex_init(&data_write_list_mutex_g);
+    hg_thread_mutex_init(&query_cache_mutex_g);
+    hg_thread_mutex_init(&metadata_log_mutex_g);
     hg_thread_mutex_init(&pdc_server_task_mutex_g);
     hg_thread_mutex_init(&region_struct_mutex_g);
     hg_thread_mutex_init(&data_buf_map_mutex_g);
@@ -818,7 +841,6 @@ drc_access_again:
     hg_thread_mutex_init(&data_obj_map_mutex_g);
     hg_thread_mutex_init(&meta_obj_map_mutex_g);
     hg_thread_mutex_init(&lock_list_mutex_g);
-    hg_thread_mutex_init(&insert_hash_table_mutex_g);
     hg_thread_mutex_init(&lock_request_mutex_g);
     hg_thread_mutex_init(&addr_valid_mutex_g);
     hg_thread_mutex_init(&update_remote_server_addr_mutex_g);
@@ -838,7 +860,11 @@ drc_access_again:
         snprintf(checkpoint_file, ADDR_MAX + sizeof(int), "%s%s%d", pdc_server_tmp_dir_g,
                  "metadata_checkpoint.", pdc_server_rank_g);
 
-        ret_value = PDC_Server_restart(checkpoint_file);
+        // Without any checkpoint, all metadata of the previous run is in the metadata log
+        if (disable_metadata_log_g != 1 && access(checkpoint_file, F_OK) != 0)
+            ret_value = PDC_Server_init_hash_table();
+        else
+            ret_value = PDC_Server_restart(checkpoint_file);
         if (ret_value != SUCCEED) {
             printf("==PDC_SERVER[%d]: error with PDC_Server_restart\n", pdc_server_rank_g);
             goto done;
@@ -856,6 +882,12 @@ drc_access_again:
         }
     }
 
+    ret_value = PDC_Server_metadata_log_init();
+    if (ret_value != SUCCEED) {
+        printf("==PDC_SERVER[%d]: error with PDC_Server_metadata_log_init\n", pdc_server_rank_g);
+        goto done;
+    }
+
     // Data server related init
     pdc_data_server_read_list_head_g    = NULL;
     pdc_data_server_write_list_head_g   = NULL;
@@ -863,6 +895,12 @@ drc_access_again:
     pdc_buffered_bulk_update_total_g    = 0;
     pdc_nbuffered_bulk_update_g         = 0;
 
+    ret_value = PDC_Server_tier_init();
+    if (ret_value != SUCCEED) {
+        printf("==PDC_SERVER[%d]: error with PDC_Server_tier_init\n", pdc_server_rank_g);
+        goto done;
+    }
+
     // Initalize atomic variable to finalize server
     hg_atomic_set32(&close_server_g, 0);
 
@@ -949,8 +987,8 @@ PDC_Server_finalize()
     }
 
     // Free hash table
-    if (metadata_hash_table_g != NULL)
-        hash_table_free(metadata_hash_table_g);
+    PDC_Server_metadata_table_free();
+    PDC_Server_name_bloom_finalize();
 
     ret_value = PDC_Server_destroy_client_info(pdc_client_info_g);
     if (ret_value != SUCCEED) {
@@ -965,6 +1003,8 @@ PDC_Server_finalize()
     }
 
     PDC_Close_cache_file();
+    PDC_placement_finalize();
+    PDC_Server_buf_shm_finalize();
 
 #ifdef ENABLE_TIMING
 
@@ -1006,10 +1046,8 @@ PDC_Server_finalize()
     // Destory pool
     hg_thread_pool_destroy(hg_test_thread_pool_fs_g);
 
-    hg_thread_mutex_destroy(&hash_table_new_mutex_g);
     hg_thread_mutex_destroy(&pdc_client_info_mutex_g);
     hg_thread_mutex_destroy(&pdc_time_mutex_g);
-    hg_thread_mutex_destroy(&pdc_metadata_hash_table_mutex_g);
     hg_thread_mutex_destroy(&pdc_container_hash_table_mutex_g);
     hg_thread_mutex_destroy(&pdc_client_addr_mutex_g);
     hg_thread_mutex_destroy(&pdc_bloom_time_mutex_g);
@@ -1018,6 +1056,8 @@ PDC_Server_finalize()
     hg_thread_mutex_destroy(&total_mem_usage_mutex_g);
     hg_thread_mutex_destroy(&data_read_list_mutex_g);
     hg_thread_mutex_destroy(&data_write_list_mutex_g);
+    hg_thread_mutex_destroy(&query_cache_mutex_g);
+    hg_thread_mutex_destroy(&metadata_log_mutex_g);
     hg_thread_mutex_destroy(&pdc_server_task_mutex_g);
     hg_thread_mutex_destroy(&region_struct_mutex_g);
     hg_thread_mutex_destroy(&data_buf_map_mutex_g);
@@ -1025,7 +1065,6 @@ PDC_Server_finalize()
     hg_thread_mutex_destroy(&meta_buf_map_mutex_g);
     hg_thread_mutex_destroy(&data_obj_map_mutex_g);
     hg_thread_mutex_destroy(&meta_obj_map_mutex_g);
-    hg_thread_mutex_destroy(&insert_hash_table_mutex_g);
     hg_thread_mutex_destroy(&lock_list_mutex_g);
     hg_thread_mutex_destroy(&lock_request_mutex_g);
     hg_thread_mutex_destroy(&addr_valid_mutex_g);
@@ -1085,485 +1124,1302 @@ PDC_Server_checkpoint_cb()
     return HG_SUCCESS;
 }
 
+// Checkpoint record being encoded
+typedef struct pdc_checkpoint_buf_t {
+    char * buf;
+    size_t size;
+    size_t alloc;
+    int    err;
+} pdc_checkpoint_buf_t;
+
+// Thread writing a checkpoint that covers the log segments before metadata_log_compact_gen_g
+static hg_thread_t          metadata_log_compact_thread_g;
+static int                  metadata_log_compact_running_g = 0;
+static int                  metadata_log_compact_gen_g     = 0;
+static hg_atomic_int32_t    metadata_log_compact_ret_g;
+static pdc_checkpoint_buf_t metadata_log_compact_image_g;
+static char                 metadata_log_compact_file_g[ADDR_MAX + 64];
+
 /*
- * Checkpoint in-memory metadata to persistant storage, each server writes to one file
+ * Append bytes to a checkpoint record
  *
- * \param  filename[IN]     Checkpoint file name
- *
- * \return Non-negative on success/Negative on failure
+ * \param  rec[IN/OUT]      Checkpoint record
+ * \param  data[IN]         Bytes to append, NULL to append zeros
+ * \param  size[IN]         Number of bytes
  */
-perr_t
-PDC_Server_checkpoint()
+static void
+PDC_Server_checkpoint_append(pdc_checkpoint_buf_t *rec, const void *data, size_t size)
 {
-    perr_t                       ret_value = SUCCEED;
-    pdc_metadata_t *             elt;
-    region_list_t *              region_elt;
-    pdc_kvtag_list_t *           kvlist_elt;
-    pdc_hash_table_entry_head *  head;
-    pdc_cont_hash_table_entry_t *cont_head;
-    int      n_entry, metadata_size = 0, region_count = 0, n_region, n_write_region = 0, n_kvtag, key_len;
-    uint32_t hash_key;
-    HashTablePair     pair;
-    char              checkpoint_file[ADDR_MAX];
-    HashTableIterator hash_table_iter;
+    char * tmp;
+    size_t alloc;
 
     FUNC_ENTER(NULL);
 
-#ifdef ENABLE_TIMING
-    // Timing
-    struct timeval pdc_timer_start;
-    struct timeval pdc_timer_end;
-    double         checkpoint_time;
-    gettimeofday(&pdc_timer_start, 0);
-#endif
-
-    // TODO: instead of checkpoint at app finalize time, try checkpoint with a time countdown or # of objects
-    snprintf(checkpoint_file, ADDR_MAX, "%s%s%d", pdc_server_tmp_dir_g, "metadata_checkpoint.",
-             pdc_server_rank_g);
-    if (pdc_server_rank_g == 0) {
-        printf("\n\n==PDC_SERVER[%d]: Checkpoint file [%s]\n", pdc_server_rank_g, checkpoint_file);
-        fflush(stdout);
-    }
-
-    FILE *file = fopen(checkpoint_file, "w+");
-    if (file == NULL) {
-        printf("==PDC_SERVER[%d]: %s - Checkpoint file open error", pdc_server_rank_g, __func__);
-        ret_value = FAIL;
-        goto done;
+    if (rec->size + size > rec->alloc) {
+        alloc = rec->alloc == 0 ? 4096 : rec->alloc;
+        while (alloc < rec->size + size)
+            alloc *= 2;
+        tmp = (char *)realloc(rec->buf, alloc);
+        if (tmp == NULL) {
+            rec->err = 1;
+            goto done;
+        }
+        rec->buf   = tmp;
+        rec->alloc = alloc;
     }
+    if (data == NULL)
+        memset(rec->buf + rec->size, 0, size);
+    else
+        memcpy(rec->buf + rec->size, data, size);
+    rec->size += size;
 
-    // Checkpoint containers
-    n_entry = hash_table_num_entries(container_hash_table_g);
-    fwrite(&n_entry, sizeof(int), 1, file);
-
-    hash_table_iterate(container_hash_table_g, &hash_table_iter);
-    while (n_entry != 0 && hash_table_iter_has_more(&hash_table_iter)) {
-        pair      = hash_table_iter_next(&hash_table_iter);
-        cont_head = pair.value;
+done:
+    FUNC_LEAVE_VOID;
+}
 
-        hash_key = PDC_get_hash_by_name(cont_head->cont_name);
-        fwrite(&hash_key, sizeof(uint32_t), 1, file);
-        fwrite(cont_head, sizeof(pdc_cont_hash_table_entry_t), 1, file);
-    }
+/*
+ * Append a string to a checkpoint record, prefixed by its length including the '\0'
+ *
+ * \param  rec[IN/OUT]      Checkpoint record
+ * \param  str[IN]          String to append, NULL is taken as an empty string
+ */
+static void
+PDC_Server_checkpoint_append_str(pdc_checkpoint_buf_t *rec, const char *str)
+{
+    uint32_t len;
 
-    // DHT
-    n_entry = hash_table_num_entries(metadata_hash_table_g);
-    fwrite(&n_entry, sizeof(int), 1, file);
+    FUNC_ENTER(NULL);
 
-    hash_table_iterate(metadata_hash_table_g, &hash_table_iter);
+    if (str == NULL)
+        str = "";
+    len = strlen(str) + 1;
+    PDC_Server_checkpoint_append(rec, &len, sizeof(uint32_t));
+    PDC_Server_checkpoint_append(rec, str, len);
 
-    while (n_entry != 0 && hash_table_iter_has_more(&hash_table_iter)) {
-        pair = hash_table_iter_next(&hash_table_iter);
-        head = pair.value;
+    FUNC_LEAVE_VOID;
+}
 
-        fwrite(&head->n_obj, sizeof(int), 1, file);
-        hash_key = PDC_get_hash_by_name(head->metadata->obj_name);
-        fwrite(&hash_key, sizeof(uint32_t), 1, file);
+/*
+ * Append a list of kvtags to a checkpoint record
+ *
+ * \param  rec[IN/OUT]      Checkpoint record
+ * \param  head[IN]         Head of the kvtag list
+ */
+static void
+PDC_Server_checkpoint_append_kvtags(pdc_checkpoint_buf_t *rec, pdc_kvtag_list_t *head)
+{
+    pdc_kvtag_list_t *kvlist_elt;
 
-        // Iterate every metadata structure in current entry
-        DL_FOREACH(head->metadata, elt)
-        {
-            // Write entire metadata structure
-            fwrite(elt, sizeof(pdc_metadata_t), 1, file);
+    FUNC_ENTER(NULL);
 
-            // Write kv tags
-            DL_COUNT(elt->kvtag_list_head, kvlist_elt, n_kvtag);
-            fwrite(&n_kvtag, sizeof(int), 1, file);
-            DL_FOREACH(elt->kvtag_list_head, kvlist_elt)
-            {
-                key_len = strlen(kvlist_elt->kvtag->name) + 1;
-                fwrite(&key_len, sizeof(int), 1, file);
-                fwrite(kvlist_elt->kvtag->name, key_len, 1, file);
-                fwrite(&kvlist_elt->kvtag->size, sizeof(uint32_t), 1, file);
-                fwrite(kvlist_elt->kvtag->value, kvlist_elt->kvtag->size, 1, file);
-            }
+    DL_FOREACH(head, kvlist_elt)
+    {
+        PDC_Server_checkpoint_append_str(rec, kvlist_elt->kvtag->name);
+        PDC_Server_checkpoint_append(rec, &kvlist_elt->kvtag->size, sizeof(uint32_t));
+        PDC_Server_checkpoint_append(rec, kvlist_elt->kvtag->value, kvlist_elt->kvtag->size);
+    }
 
-            // Write region info
-            DL_COUNT(elt->storage_region_list_head, region_elt, n_region);
-            fwrite(&n_region, sizeof(int), 1, file);
-            n_write_region = 0;
-            DL_FOREACH(elt->storage_region_list_head, region_elt)
-            {
-                fwrite(region_elt, sizeof(region_list_t), 1, file);
-                n_write_region++;
-                int has_hist = 0;
-                if (region_elt->region_hist != NULL)
-                    has_hist = 1;
-                fwrite(&has_hist, sizeof(int), 1, file);
-                if (has_hist == 1) {
-                    fwrite(&region_elt->region_hist->dtype, sizeof(int), 1, file);
-                    fwrite(&region_elt->region_hist->nbin, sizeof(int), 1, file);
-                    fwrite(region_elt->region_hist->range, sizeof(double), region_elt->region_hist->nbin * 2,
-                           file);
-                    fwrite(region_elt->region_hist->bin, sizeof(uint64_t), region_elt->region_hist->nbin,
-                           file);
-                    fwrite(&region_elt->region_hist->incr, sizeof(double), 1, file);
-                }
-            }
+    FUNC_LEAVE_VOID;
+}
 
-            region_count += n_region;
-            if (n_write_region != n_region) {
-                printf("==PDC_SERVER[%d]: %s - ERROR with number of regions", pdc_server_rank_g, __func__);
-                ret_value = FAIL;
-                goto done;
-            }
+/*
+ * Append a storage region, its histogram and its sketch to a checkpoint record
+ *
+ * \param  rec[IN/OUT]      Checkpoint record
+ * \param  region[IN]       Storage region
+ */
+static void
+PDC_Server_checkpoint_append_region(pdc_checkpoint_buf_t *rec, region_list_t *region)
+{
+    pdc_checkpoint_region_t ckpt;
+    size_t                  i;
+    void *                  sketch_buf = NULL;
 
-            // Write storage region info
-            data_server_region_t *region = NULL;
-            region                       = PDC_Server_get_obj_region(elt->obj_id);
-            if (region) {
-                DL_COUNT(region->region_storage_head, region_elt, n_region);
-                fwrite(&n_region, sizeof(int), 1, file);
-                DL_FOREACH(region->region_storage_head, region_elt)
-                {
-                    fwrite(region_elt, sizeof(region_list_t), 1, file);
-                }
-            }
-            else {
-                fwrite(&n_region, sizeof(int), 1, file);
-            }
+    FUNC_ENTER(NULL);
 
-            metadata_size++;
-            region_count += n_region;
-        }
+    memset(&ckpt, 0, sizeof(ckpt));
+    ckpt.ndim = region->ndim;
+    for (i = 0; i < region->ndim && i < DIM_MAX; i++) {
+        ckpt.start[i] = region->start[i];
+        ckpt.count[i] = region->count[i];
     }
-
-    fclose(file);
-    file = NULL;
-
-    int all_metadata_size, all_region_count;
-#ifdef ENABLE_MPI
-    MPI_Reduce(&metadata_size, &all_metadata_size, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-    MPI_Reduce(&region_count, &all_region_count, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-#else
-    all_metadata_size = metadata_size;
-    all_region_count  = region_count;
-#endif
-    if (pdc_server_rank_g == 0) {
-        printf("==PDC_SERVER: checkpointed %d objects, with %d regions \n", all_metadata_size,
-               all_region_count);
+    ckpt.offset        = region->offset;
+    ckpt.data_size     = region->data_size;
+    ckpt.storage_size  = region->storage_size;
+    ckpt.unit_size     = region->unit_size;
+    ckpt.quant_step    = region->quant_step;
+    ckpt.data_loc_type = region->data_loc_type;
+    ckpt.compress      = region->compress;
+    if (region->region_hist != NULL) {
+        ckpt.hist_dtype = region->region_hist->dtype;
+        ckpt.hist_nbin  = region->region_hist->nbin;
+        ckpt.hist_incr  = region->region_hist->incr;
+    }
+    if (region->region_sketch != NULL) {
+        ckpt.sketch_size = PDC_sketch_serialize_size(region->region_sketch);
+        sketch_buf       = malloc(ckpt.sketch_size);
+        if (sketch_buf == NULL || PDC_sketch_serialize(region->region_sketch, sketch_buf) != SUCCEED)
+            ckpt.sketch_size = 0;
     }
 
-#ifdef ENABLE_TIMING
-    // Timing
-    gettimeofday(&pdc_timer_end, 0);
-    checkpoint_time = PDC_get_elapsed_time_double(&pdc_timer_start, &pdc_timer_end);
-    if (pdc_server_rank_g == 0) {
-        printf("==PDC_SERVER: total checkpoint time = %.6f\n", checkpoint_time);
+    PDC_Server_checkpoint_append(rec, &ckpt, sizeof(ckpt));
+    PDC_Server_checkpoint_append_str(rec, region->storage_location);
+    if (ckpt.hist_nbin > 0) {
+        PDC_Server_checkpoint_append(rec, region->region_hist->range, sizeof(double) * ckpt.hist_nbin * 2);
+        PDC_Server_checkpoint_append(rec, region->region_hist->bin, sizeof(uint64_t) * ckpt.hist_nbin);
     }
-#endif
+    if (ckpt.sketch_size > 0)
+        PDC_Server_checkpoint_append(rec, sketch_buf, ckpt.sketch_size);
+    free(sketch_buf);
 
-done:
-    FUNC_LEAVE(ret_value);
+    FUNC_LEAVE_VOID;
 }
 
-int
-region_cmp(region_list_t *a, region_list_t *b)
+/*
+ * Append a container to a checkpoint record
+ *
+ * \param  rec[IN/OUT]      Checkpoint record
+ * \param  cont[IN]         Container
+ */
+static void
+PDC_Server_checkpoint_append_cont(pdc_checkpoint_buf_t *rec, pdc_cont_hash_table_entry_t *cont)
 {
-    int unit_size = a->ndim * sizeof(uint64_t);
-    return memcmp(a->start, b->start, unit_size);
+    pdc_checkpoint_cont_t ckpt;
+    pdc_kvtag_list_t *    kvlist_elt;
+    int                   n_kvtag;
+
+    FUNC_ENTER(NULL);
+
+    memset(&ckpt, 0, sizeof(ckpt));
+    DL_COUNT(cont->kvtag_list_head, kvlist_elt, n_kvtag);
+    ckpt.cont_id   = cont->cont_id;
+    ckpt.n_obj     = cont->n_obj;
+    ckpt.n_deleted = cont->n_deleted;
+    ckpt.n_kvtag   = n_kvtag;
+
+    PDC_Server_checkpoint_append(rec, &ckpt, sizeof(ckpt));
+    PDC_Server_checkpoint_append_str(rec, cont->cont_name);
+    PDC_Server_checkpoint_append_str(rec, cont->tags);
+    PDC_Server_checkpoint_append_kvtags(rec, cont->kvtag_list_head);
+    if (cont->n_obj > 0)
+        PDC_Server_checkpoint_append(rec, cont->obj_ids, sizeof(uint64_t) * cont->n_obj);
+
+    FUNC_LEAVE_VOID;
 }
 
 /*
- * Load metadata from checkpoint file in persistant storage
- *
- * \param  filename[IN]     Checkpoint file name
+ * Append an object with its kvtags and regions to a checkpoint record
  *
- * \return Non-negative on success/Negative on failure
+ * \param  rec[IN/OUT]      Checkpoint record
+ * \param  meta[IN]         Object metadata
+ * \param  n_region[OUT]    Number of regions appended
  */
-perr_t
-PDC_Server_restart(char *filename)
+static void
+PDC_Server_checkpoint_append_obj(pdc_checkpoint_buf_t *rec, pdc_metadata_t *meta, int *n_region)
 {
-    perr_t ret_value = SUCCEED;
-    int    n_entry, count, i, j, nobj = 0, all_nobj = 0, all_n_region, n_region, total_region = 0, n_kvtag,
-                              key_len;
-    int                          n_cont, all_cont;
-    pdc_metadata_t *             metadata, *elt;
-    region_list_t *              region_list;
-    pdc_hash_table_entry_head *  entry;
-    pdc_cont_hash_table_entry_t *cont_entry;
-    uint32_t *                   hash_key;
-    unsigned                     idx;
+    pdc_checkpoint_obj_t  ckpt;
+    data_server_region_t *data_region;
+    region_list_t *       region_elt;
+    pdc_kvtag_list_t *    kvlist_elt;
+    int                   i, count;
 
     FUNC_ENTER(NULL);
 
-    // init hash table
-    ret_value = PDC_Server_init_hash_table();
-    if (ret_value != SUCCEED) {
-        printf("==PDC_SERVER[%d]: %s - PDC_Server_init_hash_table FAILED!", pdc_server_rank_g, __func__);
-        ret_value = FAIL;
-        goto done;
-    }
-
-    FILE *file = fopen(filename, "r");
-    if (file == NULL) {
-        printf("==PDC_SERVER[%d]: %s -  Checkpoint file open FAILED [%s]!", pdc_server_rank_g, __func__,
-               filename);
-        ret_value = FAIL;
-        goto done;
+    memset(&ckpt, 0, sizeof(ckpt));
+    ckpt.obj_id             = meta->obj_id;
+    ckpt.cont_id            = meta->cont_id;
+    ckpt.create_time        = meta->create_time;
+    ckpt.last_modified_time = meta->last_modified_time;
+    ckpt.user_id            = meta->user_id;
+    ckpt.time_step          = meta->time_step;
+    ckpt.data_type          = meta->data_type;
+    ckpt.ndim               = meta->ndim;
+    ckpt.transform_state    = meta->transform_state;
+    ckpt.t_storage_order    = meta->current_state.storage_order;
+    ckpt.t_dtype            = meta->current_state.dtype;
+    ckpt.t_ndim             = meta->current_state.ndim;
+    ckpt.t_meta_index       = meta->current_state.meta_index;
+    ckpt.stripe_size        = meta->stripe_size;
+    ckpt.stripe_count       = meta->stripe_count;
+    ckpt.compress           = meta->compress;
+    ckpt.compress_level     = meta->compress_level;
+    ckpt.error_bound_mode   = meta->error_bound_mode;
+    ckpt.error_bound        = meta->error_bound;
+    for (i = 0; i < DIM_MAX; i++) {
+        ckpt.dims[i]   = meta->dims[i];
+        ckpt.t_dims[i] = meta->current_state.dims[i];
     }
-
-    char *slurm_jobid = getenv("SLURM_JOB_ID");
-    if (slurm_jobid == NULL) {
-        printf("Error getting slurm job id from SLURM_JOB_ID!\n");
+    DL_COUNT(meta->kvtag_list_head, kvlist_elt, count);
+    ckpt.n_kvtag = count;
+    DL_COUNT(meta->storage_region_list_head, region_elt, count);
+    ckpt.n_region = count;
+    *n_region     = count;
+
+    ckpt.n_data_region = -1;
+    data_region        = PDC_Server_get_obj_region(meta->obj_id);
+    if (data_region != NULL) {
+        DL_COUNT(data_region->region_storage_head, region_elt, count);
+        ckpt.n_data_region = count;
+        *n_region += count;
     }
 
-    // init hash table
-    PDC_Server_init_hash_table();
-
-    if (fread(&n_cont, sizeof(int), 1, file) != 1) {
-        printf("Read failed for n_count\n");
+    PDC_Server_checkpoint_append(rec, &ckpt, sizeof(ckpt));
+    PDC_Server_checkpoint_append_str(rec, meta->obj_name);
+    PDC_Server_checkpoint_append_str(rec, meta->app_name);
+    PDC_Server_checkpoint_append_str(rec, meta->tags);
+    PDC_Server_checkpoint_append_str(rec, meta->data_location);
+    PDC_Server_checkpoint_append_kvtags(rec, meta->kvtag_list_head);
+    DL_FOREACH(meta->storage_region_list_head, region_elt)
+    {
+        PDC_Server_checkpoint_append_region(rec, region_elt);
     }
-    all_cont = n_cont;
-    while (n_cont > 0) {
-        hash_key = (uint32_t *)malloc(sizeof(uint32_t));
-        if (fread(hash_key, sizeof(uint32_t), 1, file) != 1) {
-            printf("Read failed for hash_key\n");
-        }
-        total_mem_usage_g += sizeof(uint32_t);
-
-        // Reconstruct hash table
-        cont_entry = (pdc_cont_hash_table_entry_t *)malloc(sizeof(pdc_cont_hash_table_entry_t));
-        total_mem_usage_g += sizeof(pdc_cont_hash_table_entry_t);
-        if (fread(cont_entry, sizeof(pdc_cont_hash_table_entry_t), 1, file) != 1) {
-            printf("Read failed for cont_entry\n");
-        }
 
-#ifdef ENABLE_MULTITHREAD
-        hg_thread_mutex_lock(&pdc_container_hash_table_mutex_g);
-#endif
-        if (hash_table_insert(container_hash_table_g, hash_key, cont_entry) != 1) {
-            printf("==PDC_SERVER[%d]: %s - hash table insert failed\n", pdc_server_rank_g, __func__);
-            ret_value = FAIL;
+    if (data_region != NULL) {
+        PDC_Server_checkpoint_append_str(rec, data_region->storage_location);
+        DL_FOREACH(data_region->region_storage_head, region_elt)
+        {
+            PDC_Server_checkpoint_append_region(rec, region_elt);
         }
-#ifdef ENABLE_MULTITHREAD
-        hg_thread_mutex_unlock(&pdc_container_hash_table_mutex_g);
-#endif
-
-        n_cont--;
-    } // End while
-
-    if (fread(&n_entry, sizeof(int), 1, file) != 1) {
-        printf("Read failed for n_entry\n");
     }
-    while (n_entry > 0) {
-        if (fread(&count, sizeof(int), 1, file) != 1) {
-            printf("Read failed for count\n");
-        }
 
-        hash_key = (uint32_t *)malloc(sizeof(uint32_t));
-        if (fread(hash_key, sizeof(uint32_t), 1, file) != 1) {
-            printf("Read failed for hash_key\n");
-        }
-        total_mem_usage_g += sizeof(uint32_t);
-
-        // Reconstruct hash table
-        entry           = (pdc_hash_table_entry_head *)malloc(sizeof(pdc_hash_table_entry_head));
-        entry->n_obj    = 0;
-        entry->bloom    = NULL;
-        entry->metadata = NULL;
-        // Init hash table metadata (w/ bloom) with first obj
-        PDC_Server_hash_table_list_init(entry, hash_key);
-
-        metadata = (pdc_metadata_t *)calloc(sizeof(pdc_metadata_t), count);
-        for (i = 0; i < count; i++) {
-            if (fread(metadata + i, sizeof(pdc_metadata_t), 1, file) != 1) {
-                printf("Read failed for metadata\n");
-            }
+    FUNC_LEAVE_VOID;
+}
 
-            (metadata + i)->storage_region_list_head       = NULL;
-            (metadata + i)->region_lock_head               = NULL;
-            (metadata + i)->region_map_head                = NULL;
-            (metadata + i)->region_buf_map_head            = NULL;
-            (metadata + i)->bloom                          = NULL;
-            (metadata + i)->prev                           = NULL;
-            (metadata + i)->next                           = NULL;
-            (metadata + i)->kvtag_list_head                = NULL;
-            (metadata + i)->all_storage_region_distributed = 0;
-
-            // Read kv tags
-            if (fread(&n_kvtag, sizeof(int), 1, file) != 1) {
-                printf("Read failed for n_kvtag\n");
-            }
-            for (j = 0; j < n_kvtag; j++) {
-                pdc_kvtag_list_t *kvtag_list = (pdc_kvtag_list_t *)calloc(1, sizeof(pdc_kvtag_list_t));
-                kvtag_list->kvtag            = (pdc_kvtag_t *)malloc(sizeof(pdc_kvtag_t));
-                if (fread(&key_len, sizeof(int), 1, file) != 1) {
-                    printf("Read failed for key_len\n");
-                }
-                kvtag_list->kvtag->name = malloc(key_len);
-                if (fread((void *)(kvtag_list->kvtag->name), key_len, 1, file) != 1) {
-                    printf("Read failed for kvtag_list->kvtag->name\n");
-                }
-                if (fread(&kvtag_list->kvtag->size, sizeof(uint32_t), 1, file) != 1) {
-                    printf("Read failed for kvtag_list->kvtag->size\n");
-                }
-                kvtag_list->kvtag->value = malloc(kvtag_list->kvtag->size);
-                if (fread(kvtag_list->kvtag->value, kvtag_list->kvtag->size, 1, file) != 1) {
-                    printf("Read failed for kvtag_list->kvtag->value\n");
-                }
-                DL_APPEND((metadata + i)->kvtag_list_head, kvtag_list);
-            }
+/*
+ * Encode in-memory metadata into the image of a checkpoint file
+ *
+ * \param  image[OUT]           Checkpoint file image, its buffer is allocated here
+ * \param  n_obj[OUT]           Number of checkpointed objects
+ * \param  n_region_out[OUT]    Number of checkpointed regions
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_checkpoint_snapshot(pdc_checkpoint_buf_t *image, int *n_obj, int *n_region_out)
+{
+    perr_t                     ret_value = SUCCEED;
+    pdc_metadata_t *           elt;
+    pdc_hash_table_entry_head *head;
+    pdc_checkpoint_header_t    header;
+    pdc_checkpoint_index_t *   index = NULL, *tmp_index;
+    uint64_t                   offset, n_index_alloc = 0;
+    int                        n_region, region_count = 0;
+    uint32_t                   hash_key;
+    HashTablePair              pair;
+    HashTableIterator          hash_table_iter;
+    pdc_metadata_table_iter_t  meta_table_iter;
 
-            if (fread(&n_region, sizeof(int), 1, file) != 1) {
-                printf("Read failed for n_region\n");
-            }
-            if (n_region < 0) {
-                printf("==PDC_SERVER[%d]: %s -  Checkpoint file region number ERROR!", pdc_server_rank_g,
-                       __func__);
-                ret_value = FAIL;
-                goto done;
-            }
+    FUNC_ENTER(NULL);
 
-            /* if (n_region == 0) */
-            /*     continue; */
+    memset(image, 0, sizeof(pdc_checkpoint_buf_t));
 
-            total_region += n_region;
+    // The header is filled in last, when the offsets and checksums of the sections are known
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PDC_CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version     = PDC_CHECKPOINT_VERSION;
+    header.cont_offset = sizeof(header);
+    PDC_Server_checkpoint_append(image, NULL, sizeof(header));
 
-            for (j = 0; j < n_region; j++) {
-                region_list = (region_list_t *)malloc(sizeof(region_list_t));
-                if (fread(region_list, sizeof(region_list_t), 1, file) != 1) {
-                    printf("Read failed for region_list\n");
+    // Checkpoint containers
+    if (hash_table_num_entries(container_hash_table_g) != 0) {
+        hash_table_iterate(container_hash_table_g, &hash_table_iter);
+        while (hash_table_iter_has_more(&hash_table_iter)) {
+            pair = hash_table_iter_next(&hash_table_iter);
+            PDC_Server_checkpoint_append_cont(image, (pdc_cont_hash_table_entry_t *)pair.value);
+            header.n_cont++;
+        }
+    }
+    PDC_Server_checkpoint_append(image, NULL, (8 - image->size % 8) % 8);
+    if (image->err != 0) {
+        ret_value = FAIL;
+        goto done;
+    }
+    header.cont_crc =
+        PDC_checksum_crc32(0, image->buf + header.cont_offset, image->size - header.cont_offset);
+    header.obj_offset = image->size;
+
+    // Checkpoint objects bucket by bucket, restart rebuilds the buckets from the index in the same order
+    if (PDC_Server_metadata_table_num_entries() != 0) {
+        PDC_Server_metadata_table_iterate(&meta_table_iter);
+        while (PDC_Server_metadata_table_iter_has_more(&meta_table_iter)) {
+            pair = PDC_Server_metadata_table_iter_next(&meta_table_iter);
+            head = pair.value;
+            if (head->metadata == NULL)
+                continue;
+            hash_key = PDC_get_hash_by_name(head->metadata->obj_name);
+
+            DL_FOREACH(head->metadata, elt)
+            {
+                if (header.n_obj == n_index_alloc) {
+                    n_index_alloc = n_index_alloc == 0 ? 1024 : n_index_alloc * 2;
+                    tmp_index     = (pdc_checkpoint_index_t *)realloc(index, n_index_alloc * sizeof(*index));
+                    if (tmp_index == NULL) {
+                        ret_value = FAIL;
+                        goto done;
+                    }
+                    index = tmp_index;
                 }
 
-                int has_hist = 0;
-                if (fread(&has_hist, sizeof(int), 1, file) != 1) {
-                    printf("Read failed for has_list\n");
+                offset = image->size;
+                PDC_Server_checkpoint_append_obj(image, elt, &n_region);
+                if (image->err != 0) {
+                    ret_value = FAIL;
+                    goto done;
                 }
-                if (has_hist == 1) {
-                    region_list->region_hist = (pdc_histogram_t *)malloc(sizeof(pdc_histogram_t));
-                    if (fread(&region_list->region_hist->dtype, sizeof(int), 1, file) != 1) {
-                        printf("Read failed for region_list->region_hist->dtype\n");
-                    }
-                    if (fread(&region_list->region_hist->nbin, sizeof(int), 1, file) != 1) {
-                        printf("Read failed for region_list->region_hist->nbin\n");
-                    }
-                    if (region_list->region_hist->nbin == 0) {
-                        printf("==PDC_SERVER[%d]: %s -  Checkpoint file histogram size is 0!",
-                               pdc_server_rank_g, __func__);
-                    }
 
-                    region_list->region_hist->range =
-                        (double *)malloc(sizeof(double) * region_list->region_hist->nbin * 2);
-                    region_list->region_hist->bin =
-                        (uint64_t *)malloc(sizeof(uint64_t) * region_list->region_hist->nbin);
-
-                    if (fread(region_list->region_hist->range, sizeof(double),
-                              region_list->region_hist->nbin * 2, file) != 1) {
-                        printf("Read failed for region_list->region_hist->range\n");
-                    }
-                    if (fread(region_list->region_hist->bin, sizeof(uint64_t), region_list->region_hist->nbin,
-                              file) != 1) {
-                        printf("Read failed for region_list->region_hist->bin\n");
-                    }
-                    if (fread(&region_list->region_hist->incr, sizeof(double), 1, file) != 1) {
-                        printf("Read failed for region_list->region_hist->incr\n");
-                    }
-                }
+                index[header.n_obj].obj_id   = elt->obj_id;
+                index[header.n_obj].offset   = offset;
+                index[header.n_obj].size     = image->size - offset;
+                index[header.n_obj].crc =
+                    PDC_checksum_crc32(0, image->buf + offset, index[header.n_obj].size);
+                index[header.n_obj].hash_key = hash_key;
+                index[header.n_obj].reserved = 0;
+                header.n_obj++;
+                region_count += n_region;
+            }
+        }
+    }
 
-                region_list->buf       = NULL;
-                region_list->data_size = 1;
-                for (idx = 0; idx < region_list->ndim; idx++)
-                    region_list->data_size *= region_list->count[idx];
-                region_list->is_data_ready            = 0;
-                region_list->shm_fd                   = 0;
-                region_list->meta                     = (metadata + i);
-                region_list->prev                     = NULL;
-                region_list->next                     = NULL;
-                region_list->overlap_storage_regions  = NULL;
-                region_list->n_overlap_storage_region = 0;
-                hg_atomic_init32(&(region_list->buf_map_refcount), 0);
-                region_list->reg_dirty_from_buf = 0;
-                region_list->access_type        = PDC_NA;
-                region_list->bulk_handle        = NULL;
-                region_list->lock_handle        = NULL;
-                region_list->addr               = NULL;
-                region_list->obj_id             = (metadata + i)->obj_id;
-                region_list->reg_id             = 0;
-                region_list->from_obj_id        = 0;
-                region_list->client_id          = 0;
-                region_list->is_io_done         = 0;
-                region_list->is_shm_closed      = 0;
-                region_list->seq_id             = 0;
-                region_list->sent_to_server     = 0;
-                region_list->io_cache_region    = NULL;
-
-                memset(region_list->shm_addr, 0, ADDR_MAX);
-                memset(region_list->client_ids, 0, PDC_SERVER_MAX_PROC_PER_NODE * sizeof(uint32_t));
-
-                if (strstr(region_list->storage_location, "/global/cscratch") != NULL) {
-                    region_list->data_loc_type = PDC_LUSTRE;
-                }
+    // Index
+    PDC_Server_checkpoint_append(image, NULL, (8 - image->size % 8) % 8);
+    header.index_offset = image->size;
+    header.index_crc    = PDC_checksum_crc32(0, index, sizeof(pdc_checkpoint_index_t) * header.n_obj);
+    if (header.n_obj > 0)
+        PDC_Server_checkpoint_append(image, index, sizeof(pdc_checkpoint_index_t) * header.n_obj);
+    if (image->err != 0) {
+        ret_value = FAIL;
+        goto done;
+    }
 
-                DL_APPEND((metadata + i)->storage_region_list_head, region_list);
-            } // For j
+    header.crc = PDC_checksum_crc32(0, &header, offsetof(pdc_checkpoint_header_t, crc));
+    memcpy(image->buf, &header, sizeof(header));
 
-            // read storage region info
-            if (fread(&n_region, sizeof(int), 1, file) != 1) {
-                printf("Read failed for n_region\n");
-            }
-            data_server_region_t *new_obj_reg =
-                (data_server_region_t *)calloc(1, sizeof(struct data_server_region_t));
-            DL_APPEND(dataserver_region_g, new_obj_reg);
-            new_obj_reg->obj_id = (metadata + i)->obj_id;
-            for (j = 0; j < n_region; j++) {
-                region_list_t *new_region_list = (region_list_t *)malloc(sizeof(region_list_t));
-                if (fread(new_region_list, sizeof(region_list_t), 1, file) != 1) {
-                    printf("Read failed for new_region_list\n");
-                }
-                DL_APPEND(new_obj_reg->region_storage_head, new_region_list);
-            }
+    *n_obj        = header.n_obj;
+    *n_region_out = region_count;
 
-            total_region += n_region;
+done:
+    if (ret_value != SUCCEED) {
+        printf("==PDC_SERVER[%d]: %s - Checkpoint encoding error\n", pdc_server_rank_g, __func__);
+        free(image->buf);
+        memset(image, 0, sizeof(pdc_checkpoint_buf_t));
+    }
+    free(index);
 
-            DL_SORT((metadata + i)->storage_region_list_head, region_cmp);
-        } // For i
+    FUNC_LEAVE(ret_value);
+}
 
-        nobj += count;
-        total_mem_usage_g += sizeof(pdc_hash_table_entry_head);
-        total_mem_usage_g += (sizeof(pdc_metadata_t) * count);
+/*
+ * Write a checkpoint file image, through a temporary file that replaces the checkpoint file when complete
+ *
+ * \param  checkpoint_file[IN]  Checkpoint file name
+ * \param  image[IN]            Checkpoint file image
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_checkpoint_write_file(const char *checkpoint_file, const pdc_checkpoint_buf_t *image)
+{
+    perr_t ret_value = SUCCEED;
+    char   tmp_file[ADDR_MAX + 64];
+    FILE * file;
 
-        entry->metadata = NULL;
+    FUNC_ENTER(NULL);
 
-        // Insert the previously read metadata to the linked list (hash table entry)
-        for (i = 0; i < count; i++) {
-            elt = metadata + i;
-            // Add to hash list and bloom filter
-            ret_value = PDC_Server_hash_table_list_insert(entry, elt);
-            if (ret_value != SUCCEED) {
-                printf("==PDC_SERVER: error with hash table recovering from checkpoint file\n");
-                goto done;
-            }
-        }
-        n_entry--;
+    snprintf(tmp_file, sizeof(tmp_file), "%s.tmp", checkpoint_file);
+    file = fopen(tmp_file, "w");
+    if (file == NULL) {
+        printf("==PDC_SERVER[%d]: %s - Checkpoint file open error", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
     }
 
+    if (fwrite(image->buf, image->size, 1, file) != 1 || fflush(file) != 0 || fsync(fileno(file)) != 0) {
+        ret_value = FAIL;
+        goto done;
+    }
     fclose(file);
     file = NULL;
 
-#ifdef ENABLE_MPI
-    MPI_Reduce(&nobj, &all_nobj, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-    MPI_Reduce(&total_region, &all_n_region, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
-#else
-    all_nobj          = nobj;
-    all_n_region      = total_region;
-#endif
-
-    if (pdc_server_rank_g == 0) {
-        printf("==PDC_SERVER[0]: Server restarted from saved session, "
-               "successfully loaded %d containers, %d objects, %d regions...\n",
-               all_cont, all_nobj, all_n_region);
+    if (rename(tmp_file, checkpoint_file) != 0) {
+        printf("==PDC_SERVER[%d]: %s - Checkpoint file rename error\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
     }
 
 done:
-    fflush(stdout);
+    if (file != NULL) {
+        printf("==PDC_SERVER[%d]: %s - Checkpoint file write error\n", pdc_server_rank_g, __func__);
+        fclose(file);
+        unlink(tmp_file);
+    }
 
     FUNC_LEAVE(ret_value);
 }
 
-#ifdef ENABLE_MULTITHREAD
 /*
- * Multi-thread Mercury progess
+ * Write in-memory metadata to a checkpoint file
+ *
+ * \param  checkpoint_file[IN]  Checkpoint file name
+ * \param  n_obj[OUT]           Number of checkpointed objects
+ * \param  n_region_out[OUT]    Number of checkpointed regions
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_checkpoint_write(const char *checkpoint_file, int *n_obj, int *n_region_out)
+{
+    perr_t               ret_value;
+    pdc_checkpoint_buf_t image;
+
+    FUNC_ENTER(NULL);
+
+    ret_value = PDC_Server_checkpoint_snapshot(&image, n_obj, n_region_out);
+    if (ret_value == SUCCEED)
+        ret_value = PDC_Server_checkpoint_write_file(checkpoint_file, &image);
+    free(image.buf);
+
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Write the checkpoint image of a compaction of the metadata log, run by the compaction thread
+ *
+ * \param  arg[IN]          Unused
+ */
+static HG_THREAD_RETURN_TYPE
+PDC_Server_metadata_log_compact_thread(void *arg)
+{
+    HG_THREAD_RETURN_TYPE tret = (HG_THREAD_RETURN_TYPE)0;
+    perr_t                ret;
+
+    FUNC_ENTER(NULL);
+
+    ret = PDC_Server_checkpoint_write_file(metadata_log_compact_file_g, &metadata_log_compact_image_g);
+    hg_atomic_set32(&metadata_log_compact_ret_g, ret == SUCCEED ? 1 : -1);
+
+    FUNC_LEAVE(tret);
+}
+
+/*
+ * Wait for the compaction thread of the metadata log, and remove the log segments covered by its checkpoint
+ *
+ * \param  block[IN]            Whether to block until the compaction finishes
+ *
+ * \return 1 if the compaction is still running/0 otherwise
+ */
+static int
+PDC_Server_metadata_log_compact_wait(int block)
+{
+    int ret_value = 0;
+
+    FUNC_ENTER(NULL);
+
+    if (metadata_log_compact_running_g == 0)
+        goto done;
+
+    if (block != 1 && hg_atomic_get32(&metadata_log_compact_ret_g) == 0) {
+        ret_value = 1;
+        goto done;
+    }
+    hg_thread_join(metadata_log_compact_thread_g);
+
+    if (hg_atomic_get32(&metadata_log_compact_ret_g) == 1)
+        PDC_Server_metadata_log_remove(metadata_log_compact_gen_g);
+    else
+        printf("==PDC_SERVER[%d]: %s - metadata log compaction FAILED, keeping the log\n", pdc_server_rank_g,
+               __func__);
+    free(metadata_log_compact_image_g.buf);
+    memset(&metadata_log_compact_image_g, 0, sizeof(pdc_checkpoint_buf_t));
+    metadata_log_compact_running_g = 0;
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Compact the metadata log into a new checkpoint once the current log segment is large enough.
+ * The metadata is encoded in memory while all shards are locked, then a thread writes the image to the
+ * checkpoint file, so the server keeps serving requests, which go to a new log segment.
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_metadata_log_compact()
+{
+    perr_t ret_value = SUCCEED;
+    int    gen, n_obj, n_region;
+
+    FUNC_ENTER(NULL);
+
+    if (disable_metadata_log_g == 1 || PDC_Server_metadata_log_compact_wait(0) == 1)
+        goto done;
+
+    if (PDC_Server_metadata_log_size() < metadata_log_compact_size_g)
+        goto done;
+
+    snprintf(metadata_log_compact_file_g, sizeof(metadata_log_compact_file_g), "%s%s%d",
+             pdc_server_tmp_dir_g, "metadata_checkpoint.", pdc_server_rank_g);
+
+    // The checkpoint covers all segments before the new one, the image is a consistent copy of all shards
+    PDC_Server_metadata_table_lock(PDC_METADATA_SHARD_ALL);
+    gen       = PDC_Server_metadata_log_rotate();
+    ret_value = PDC_Server_checkpoint_snapshot(&metadata_log_compact_image_g, &n_obj, &n_region);
+    PDC_Server_metadata_table_unlock(PDC_METADATA_SHARD_ALL);
+    if (ret_value != SUCCEED)
+        goto done;
+
+    metadata_log_compact_gen_g = gen;
+    hg_atomic_set32(&metadata_log_compact_ret_g, 0);
+    if (hg_thread_create(&metadata_log_compact_thread_g, PDC_Server_metadata_log_compact_thread, NULL) ==
+        HG_UTIL_SUCCESS) {
+        metadata_log_compact_running_g = 1;
+        goto done;
+    }
+
+    printf("==PDC_SERVER[%d]: %s - thread creation FAILED, compacting metadata log in place\n",
+           pdc_server_rank_g, __func__);
+    ret_value = PDC_Server_checkpoint_write_file(metadata_log_compact_file_g, &metadata_log_compact_image_g);
+    if (ret_value == SUCCEED)
+        PDC_Server_metadata_log_remove(gen);
+    free(metadata_log_compact_image_g.buf);
+    memset(&metadata_log_compact_image_g, 0, sizeof(pdc_checkpoint_buf_t));
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Checkpoint in-memory metadata to persistant storage, each server writes to one file
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t
+PDC_Server_checkpoint()
+{
+    perr_t ret_value = SUCCEED;
+    char   checkpoint_file[ADDR_MAX + 64];
+    int    metadata_size = 0, region_count = 0, gen;
+
+    FUNC_ENTER(NULL);
+
+#ifdef ENABLE_TIMING
+    // Timing
+    struct timeval pdc_timer_start;
+    struct timeval pdc_timer_end;
+    double         checkpoint_time;
+    gettimeofday(&pdc_timer_start, 0);
+#endif
+
+    // TODO: instead of checkpoint at app finalize time, try checkpoint with a time countdown or # of objects
+    snprintf(checkpoint_file, sizeof(checkpoint_file), "%s%s%d", pdc_server_tmp_dir_g,
+             "metadata_checkpoint.", pdc_server_rank_g);
+    if (pdc_server_rank_g == 0) {
+        printf("\n\n==PDC_SERVER[%d]: Checkpoint file [%s]\n", pdc_server_rank_g, checkpoint_file);
+        fflush(stdout);
+    }
+
+    // A running compaction must not replace this checkpoint with an older one
+    PDC_Server_metadata_log_compact_wait(1);
+
+    // The log segments before the new one are covered once the checkpoint is written
+    gen       = PDC_Server_metadata_log_rotate();
+    ret_value = PDC_Server_checkpoint_write(checkpoint_file, &metadata_size, &region_count);
+    if (ret_value != SUCCEED)
+        goto done;
+    if (gen >= 0)
+        PDC_Server_metadata_log_remove(gen);
+
+    int all_metadata_size, all_region_count;
+#ifdef ENABLE_MPI
+    MPI_Reduce(&metadata_size, &all_metadata_size, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&region_count, &all_region_count, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+#else
+    all_metadata_size = metadata_size;
+    all_region_count  = region_count;
+#endif
+    if (pdc_server_rank_g == 0) {
+        printf("==PDC_SERVER: checkpointed %d objects, with %d regions \n", all_metadata_size,
+               all_region_count);
+    }
+
+#ifdef ENABLE_TIMING
+    // Timing
+    gettimeofday(&pdc_timer_end, 0);
+    checkpoint_time = PDC_get_elapsed_time_double(&pdc_timer_start, &pdc_timer_end);
+    if (pdc_server_rank_g == 0) {
+        printf("==PDC_SERVER: total checkpoint time = %.6f\n", checkpoint_time);
+    }
+#endif
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+int
+region_cmp(region_list_t *a, region_list_t *b)
+{
+    int unit_size = a->ndim * sizeof(uint64_t);
+    return memcmp(a->start, b->start, unit_size);
+}
+
+// Cursor over a checkpoint record being decoded
+typedef struct pdc_restart_cursor_t {
+    const char *ptr;
+    const char *end;
+} pdc_restart_cursor_t;
+
+// Range of the checkpoint index decoded by one restart thread
+typedef struct pdc_restart_thread_args_t {
+    const char *                  map;
+    uint64_t                      map_size;
+    const pdc_checkpoint_index_t *index;
+    uint64_t                      start;
+    uint64_t                      end;
+    pdc_metadata_t *              metadata;
+    const char **                 strs;
+    data_server_region_t **       data_regions;
+    int                           n_region;
+    int                           is_thread;
+    hg_thread_t                   thread;
+    perr_t                        ret;
+} pdc_restart_thread_args_t;
+
+/*
+ * Copy bytes out of a checkpoint record
+ *
+ * \param  cur[IN/OUT]      Record cursor
+ * \param  data[OUT]        Destination
+ * \param  size[IN]         Number of bytes
+ *
+ * \return Non-negative on success/Negative if the record is too short
+ */
+static perr_t
+PDC_Server_restart_get(pdc_restart_cursor_t *cur, void *data, size_t size)
+{
+    perr_t ret_value = SUCCEED;
+
+    FUNC_ENTER(NULL);
+
+    if ((size_t)(cur->end - cur->ptr) < size) {
+        ret_value = FAIL;
+        goto done;
+    }
+    memcpy(data, cur->ptr, size);
+    cur->ptr += size;
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Get a length-prefixed string of a checkpoint record, in place
+ *
+ * \param  cur[IN/OUT]      Record cursor
+ *
+ * \return Pointer to the string in the record on success/NULL on failure
+ */
+static const char *
+PDC_Server_restart_get_str(pdc_restart_cursor_t *cur)
+{
+    const char *ret_value = NULL;
+    uint32_t    len;
+
+    FUNC_ENTER(NULL);
+
+    if (PDC_Server_restart_get(cur, &len, sizeof(uint32_t)) != SUCCEED || len == 0 ||
+        (size_t)(cur->end - cur->ptr) < len || cur->ptr[len - 1] != '\0')
+        goto done;
+    ret_value = cur->ptr;
+    cur->ptr += len;
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Decode the kvtags of a checkpoint record
+ *
+ * \param  cur[IN/OUT]      Record cursor
+ * \param  n_kvtag[IN]      Number of kvtags
+ * \param  head[OUT]        Head of the kvtag list to append to
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_restart_get_kvtags(pdc_restart_cursor_t *cur, uint32_t n_kvtag, pdc_kvtag_list_t **head)
+{
+    perr_t            ret_value = SUCCEED;
+    pdc_kvtag_list_t *kvtag_list;
+    const char *      name;
+    uint32_t          i, size;
+
+    FUNC_ENTER(NULL);
+
+    for (i = 0; i < n_kvtag; i++) {
+        name = PDC_Server_restart_get_str(cur);
+        if (name == NULL || PDC_Server_restart_get(cur, &size, sizeof(uint32_t)) != SUCCEED ||
+            (size_t)(cur->end - cur->ptr) < size) {
+            ret_value = FAIL;
+            goto done;
+        }
+
+        kvtag_list = (pdc_kvtag_list_t *)calloc(1, sizeof(pdc_kvtag_list_t));
+        if (kvtag_list == NULL || (kvtag_list->kvtag = (pdc_kvtag_t *)malloc(sizeof(pdc_kvtag_t))) == NULL) {
+            free(kvtag_list);
+            ret_value = FAIL;
+            goto done;
+        }
+        kvtag_list->kvtag->name  = strdup(name);
+        kvtag_list->kvtag->size  = size;
+        kvtag_list->kvtag->value = malloc(size);
+        if (size > 0)
+            memcpy(kvtag_list->kvtag->value, cur->ptr, size);
+        cur->ptr += size;
+        DL_APPEND(*head, kvtag_list);
+    }
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Decode a storage region, its histogram and its sketch from a checkpoint record
+ *
+ * \param  cur[IN/OUT]      Record cursor
+ * \param  obj_id[IN]       Object ID of the region
+ *
+ * \return Pointer to the new region on success/NULL on failure
+ */
+static region_list_t *
+PDC_Server_restart_get_region(pdc_restart_cursor_t *cur, uint64_t obj_id)
+{
+    region_list_t *         ret_value = NULL;
+    region_list_t *         region;
+    pdc_histogram_t *       hist;
+    pdc_checkpoint_region_t ckpt;
+    const char *            location;
+    int                     i;
+
+    FUNC_ENTER(NULL);
+
+    if (PDC_Server_restart_get(cur, &ckpt, sizeof(ckpt)) != SUCCEED || ckpt.ndim < 0 || ckpt.ndim > DIM_MAX ||
+        ckpt.hist_nbin < 0 || (location = PDC_Server_restart_get_str(cur)) == NULL ||
+        strlen(location) >= ADDR_MAX)
+        goto done;
+
+    region = (region_list_t *)malloc(sizeof(region_list_t));
+    if (region == NULL)
+        goto done;
+    PDC_init_region_list(region);
+    region->ndim = ckpt.ndim;
+    for (i = 0; i < ckpt.ndim; i++) {
+        region->start[i] = ckpt.start[i];
+        region->count[i] = ckpt.count[i];
+    }
+    region->offset        = ckpt.offset;
+    region->data_size     = ckpt.data_size;
+    region->storage_size  = ckpt.storage_size;
+    region->unit_size     = ckpt.unit_size;
+    region->quant_step    = ckpt.quant_step;
+    region->data_loc_type = (_pdc_data_loc_t)ckpt.data_loc_type;
+    region->compress      = ckpt.compress;
+    region->obj_id        = obj_id;
+    strcpy(region->storage_location, location);
+
+    if (ckpt.hist_nbin > 0) {
+        hist = (pdc_histogram_t *)malloc(sizeof(pdc_histogram_t));
+        if (hist == NULL) {
+            free(region);
+            goto done;
+        }
+        hist->dtype = (pdc_var_type_t)ckpt.hist_dtype;
+        hist->nbin  = ckpt.hist_nbin;
+        hist->incr  = ckpt.hist_incr;
+        hist->range = (double *)malloc(sizeof(double) * hist->nbin * 2);
+        hist->bin   = (uint64_t *)malloc(sizeof(uint64_t) * hist->nbin);
+        if (hist->range == NULL || hist->bin == NULL ||
+            PDC_Server_restart_get(cur, hist->range, sizeof(double) * hist->nbin * 2) != SUCCEED ||
+            PDC_Server_restart_get(cur, hist->bin, sizeof(uint64_t) * hist->nbin) != SUCCEED) {
+            free(hist->range);
+            free(hist->bin);
+            free(hist);
+            free(region);
+            goto done;
+        }
+        region->region_hist = hist;
+    }
+
+    if (ckpt.sketch_size > 0) {
+        if ((size_t)(cur->end - cur->ptr) < ckpt.sketch_size ||
+            (region->region_sketch = PDC_sketch_deserialize(cur->ptr, ckpt.sketch_size)) == NULL) {
+            if (region->region_hist != NULL) {
+                free(region->region_hist->range);
+                free(region->region_hist->bin);
+                free(region->region_hist);
+            }
+            free(region);
+            goto done;
+        }
+        cur->ptr += ckpt.sketch_size;
+    }
+
+    ret_value = region;
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Decode an object record of the checkpoint file, its name strings are left in the record to be interned
+ *
+ * \param  cur[IN/OUT]      Record cursor
+ * \param  meta[OUT]        Zeroed metadata to fill
+ * \param  strs[OUT]        Object name, app name, tags and data location in the record
+ * \param  data_region[OUT] Data server regions of the object, NULL if it has none
+ * \param  n_region[OUT]    Number of decoded regions
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_restart_decode_obj(pdc_restart_cursor_t *cur, pdc_metadata_t *meta, const char **strs,
+                              data_server_region_t **data_region, int *n_region)
+{
+    perr_t               ret_value = SUCCEED;
+    pdc_checkpoint_obj_t ckpt;
+    region_list_t *      region;
+    const char *         location;
+    int                  i;
+    uint32_t             j;
+
+    FUNC_ENTER(NULL);
+
+    if (PDC_Server_restart_get(cur, &ckpt, sizeof(ckpt)) != SUCCEED) {
+        ret_value = FAIL;
+        goto done;
+    }
+
+    meta->obj_id                      = ckpt.obj_id;
+    meta->cont_id                     = ckpt.cont_id;
+    meta->create_time                 = ckpt.create_time;
+    meta->last_modified_time          = ckpt.last_modified_time;
+    meta->user_id                     = ckpt.user_id;
+    meta->time_step                   = ckpt.time_step;
+    meta->data_type                   = (pdc_var_type_t)ckpt.data_type;
+    meta->ndim                        = ckpt.ndim;
+    meta->transform_state             = ckpt.transform_state;
+    meta->current_state.storage_order = (_pdc_major_type_t)ckpt.t_storage_order;
+    meta->current_state.dtype         = (pdc_var_type_t)ckpt.t_dtype;
+    meta->current_state.ndim          = ckpt.t_ndim;
+    meta->current_state.meta_index    = ckpt.t_meta_index;
+    meta->stripe_size                 = ckpt.stripe_size;
+    meta->stripe_count                = ckpt.stripe_count;
+    meta->compress                    = ckpt.compress;
+    meta->compress_level              = ckpt.compress_level;
+    meta->error_bound_mode            = ckpt.error_bound_mode;
+    meta->error_bound                 = ckpt.error_bound;
+    for (i = 0; i < DIM_MAX; i++) {
+        meta->dims[i]               = ckpt.dims[i];
+        meta->current_state.dims[i] = ckpt.t_dims[i];
+    }
+
+    for (i = 0; i < 4; i++) {
+        strs[i] = PDC_Server_restart_get_str(cur);
+        if (strs[i] == NULL) {
+            ret_value = FAIL;
+            goto done;
+        }
+    }
+
+    ret_value = PDC_Server_restart_get_kvtags(cur, ckpt.n_kvtag, &meta->kvtag_list_head);
+    if (ret_value != SUCCEED)
+        goto done;
+
+    for (j = 0; j < ckpt.n_region; j++) {
+        region = PDC_Server_restart_get_region(cur, meta->obj_id);
+        if (region == NULL) {
+            ret_value = FAIL;
+            goto done;
+        }
+        region->meta = meta;
+        DL_APPEND(meta->storage_region_list_head, region);
+    }
+    DL_SORT(meta->storage_region_list_head, region_cmp);
+    *n_region = ckpt.n_region;
+
+    // The data file of the object is opened when it is first accessed
+    if (ckpt.n_data_region >= 0) {
+        location = PDC_Server_restart_get_str(cur);
+        if (location == NULL) {
+            ret_value = FAIL;
+            goto done;
+        }
+        *data_region = (data_server_region_t *)calloc(1, sizeof(data_server_region_t));
+        if (*data_region == NULL) {
+            ret_value = FAIL;
+            goto done;
+        }
+        (*data_region)->obj_id = meta->obj_id;
+        (*data_region)->fd     = -1;
+        if (location[0] != '\0')
+            (*data_region)->storage_location = strdup(location);
+        for (i = 0; i < ckpt.n_data_region; i++) {
+            region = PDC_Server_restart_get_region(cur, meta->obj_id);
+            if (region == NULL) {
+                ret_value = FAIL;
+                goto done;
+            }
+            DL_APPEND((*data_region)->region_storage_head, region);
+        }
+        *n_region += ckpt.n_data_region;
+    }
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Decode a range of the object records of the checkpoint file, run by each restart thread
+ *
+ * \param  arg[IN/OUT]      Range to decode, a pdc_restart_thread_args_t
+ */
+static HG_THREAD_RETURN_TYPE
+PDC_Server_restart_thread(void *arg)
+{
+    pdc_restart_thread_args_t *   args = (pdc_restart_thread_args_t *)arg;
+    HG_THREAD_RETURN_TYPE         tret = (HG_THREAD_RETURN_TYPE)0;
+    const pdc_checkpoint_index_t *entry;
+    pdc_restart_cursor_t          cur;
+    uint64_t                      i;
+    int                           n_region;
+
+    FUNC_ENTER(NULL);
+
+    for (i = args->start; i < args->end; i++) {
+        entry = &args->index[i];
+        if (entry->offset > args->map_size || entry->size > args->map_size - entry->offset ||
+            PDC_checksum_crc32(0, args->map + entry->offset, entry->size) != entry->crc) {
+            printf("==PDC_SERVER[%d]: %s - checksum mismatch of object %" PRIu64 "\n", pdc_server_rank_g,
+                   __func__, entry->obj_id);
+            args->ret = FAIL;
+            break;
+        }
+
+        cur.ptr = args->map + entry->offset;
+        cur.end = cur.ptr + entry->size;
+        if (PDC_Server_restart_decode_obj(&cur, &args->metadata[i], &args->strs[i * 4],
+                                          &args->data_regions[i], &n_region) != SUCCEED ||
+            args->metadata[i].obj_id != entry->obj_id) {
+            printf("==PDC_SERVER[%d]: %s - error decoding object %" PRIu64 "\n", pdc_server_rank_g, __func__,
+                   entry->obj_id);
+            args->ret = FAIL;
+            break;
+        }
+        args->n_region += n_region;
+    }
+
+    return tret;
+}
+
+/*
+ * Restore a container from its checkpoint record
+ *
+ * \param  cur[IN/OUT]      Cursor over the container section
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_restart_cont(pdc_restart_cursor_t *cur)
+{
+    perr_t                       ret_value = SUCCEED;
+    pdc_checkpoint_cont_t        ckpt;
+    pdc_cont_hash_table_entry_t *cont_entry;
+    const char *                 name, *tags;
+    uint32_t                     hash_key;
+
+    FUNC_ENTER(NULL);
+
+    if (PDC_Server_restart_get(cur, &ckpt, sizeof(ckpt)) != SUCCEED || ckpt.n_obj < 0 ||
+        (name = PDC_Server_restart_get_str(cur)) == NULL || strlen(name) >= ADDR_MAX ||
+        (tags = PDC_Server_restart_get_str(cur)) == NULL || strlen(tags) >= TAG_LEN_MAX) {
+        ret_value = FAIL;
+        goto done;
+    }
+
+    cont_entry = (pdc_cont_hash_table_entry_t *)calloc(1, sizeof(pdc_cont_hash_table_entry_t));
+    if (cont_entry == NULL) {
+        ret_value = FAIL;
+        goto done;
+    }
+    cont_entry->cont_id   = ckpt.cont_id;
+    cont_entry->n_obj     = ckpt.n_obj;
+    cont_entry->n_deleted = ckpt.n_deleted;
+    strcpy(cont_entry->cont_name, name);
+    strcpy(cont_entry->tags, tags);
+    ret_value = PDC_Server_restart_get_kvtags(cur, ckpt.n_kvtag, &cont_entry->kvtag_list_head);
+    if (ret_value != SUCCEED)
+        goto done;
+    if (ckpt.n_obj > 0) {
+        cont_entry->n_allocated = ckpt.n_obj;
+        cont_entry->obj_ids     = (uint64_t *)malloc(sizeof(uint64_t) * ckpt.n_obj);
+        if (cont_entry->obj_ids == NULL ||
+            PDC_Server_restart_get(cur, cont_entry->obj_ids, sizeof(uint64_t) * ckpt.n_obj) != SUCCEED) {
+            ret_value = FAIL;
+            goto done;
+        }
+    }
+    total_mem_usage_g += sizeof(pdc_cont_hash_table_entry_t);
+    total_mem_usage_g += sizeof(uint64_t) * cont_entry->n_allocated;
+
+    // Do not hand out the ids of restored containers and objects again
+    if (cont_entry->cont_id >= pdc_id_seq_g)
+        pdc_id_seq_g = cont_entry->cont_id + 1;
+
+    hash_key = PDC_get_hash_by_name(cont_entry->cont_name);
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&pdc_container_hash_table_mutex_g);
+#endif
+    if (hash_table_insert(container_hash_table_g, &hash_key, cont_entry) != 1) {
+        printf("==PDC_SERVER[%d]: %s - hash table insert failed\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+    }
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&pdc_container_hash_table_mutex_g);
+#endif
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Load metadata from checkpoint file in persistant storage
+ *
+ * The file is mapped and its object records are decoded by PDC_RESTART_NTHREAD threads (default one per
+ * core, up to PDC_RESTART_MAX_NTHREAD), then inserted into the hash table in file order.
+ *
+ * \param  filename[IN]     Checkpoint file name
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t
+PDC_Server_restart(char *filename)
+{
+    perr_t                        ret_value = SUCCEED;
+    int                           fd = -1, nthread, t, nobj, all_nobj = 0, n_cont, all_cont = 0;
+    int                           total_region = 0, all_n_region = 0;
+    char *                        map = NULL, *env_str;
+    struct stat                   st;
+    pdc_checkpoint_header_t       header;
+    const pdc_checkpoint_index_t *index;
+    pdc_restart_cursor_t          cur;
+    pdc_restart_thread_args_t *   args         = NULL;
+    pdc_metadata_t *              metadata     = NULL, *elt;
+    const char **                 strs         = NULL;
+    data_server_region_t **       data_regions = NULL;
+    pdc_hash_table_entry_head *   entry;
+    uint32_t                      key;
+    uint64_t                      i, n_per_thread;
+
+    FUNC_ENTER(NULL);
+
+    // init hash table
+    ret_value = PDC_Server_init_hash_table();
+    if (ret_value != SUCCEED) {
+        printf("==PDC_SERVER[%d]: %s - PDC_Server_init_hash_table FAILED!", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
+
+    fd = open(filename, O_RDONLY);
+    if (fd == -1 || fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(header)) {
+        printf("==PDC_SERVER[%d]: %s -  Checkpoint file open FAILED [%s]!", pdc_server_rank_g, __func__,
+               filename);
+        ret_value = FAIL;
+        goto done;
+    }
+    map = (char *)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        map = NULL;
+        printf("==PDC_SERVER[%d]: %s - mmap FAILED [%s]!", pdc_server_rank_g, __func__, filename);
+        ret_value = FAIL;
+        goto done;
+    }
+
+    // Validate the header, the container section and the index before using any offset in them
+    memcpy(&header, map, sizeof(header));
+    if (memcmp(header.magic, PDC_CHECKPOINT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != PDC_CHECKPOINT_VERSION ||
+        header.crc != PDC_checksum_crc32(0, &header, offsetof(pdc_checkpoint_header_t, crc))) {
+        printf("==PDC_SERVER[%d]: %s - [%s] is not a version %d checkpoint file!\n", pdc_server_rank_g,
+               __func__, filename, PDC_CHECKPOINT_VERSION);
+        ret_value = FAIL;
+        goto done;
+    }
+    if (header.cont_offset < sizeof(header) || header.cont_offset > header.obj_offset ||
+        header.obj_offset > header.index_offset || header.index_offset > (uint64_t)st.st_size ||
+        header.index_offset % 8 != 0 ||
+        header.n_obj > ((uint64_t)st.st_size - header.index_offset) / sizeof(pdc_checkpoint_index_t) ||
+        PDC_checksum_crc32(0, map + header.cont_offset, header.obj_offset - header.cont_offset) !=
+            header.cont_crc ||
+        PDC_checksum_crc32(0, map + header.index_offset, sizeof(pdc_checkpoint_index_t) * header.n_obj) !=
+            header.index_crc) {
+        printf("==PDC_SERVER[%d]: %s - checkpoint file [%s] is corrupted!\n", pdc_server_rank_g, __func__,
+               filename);
+        ret_value = FAIL;
+        goto done;
+    }
+    index = (const pdc_checkpoint_index_t *)(map + header.index_offset);
+
+    cur.ptr = map + header.cont_offset;
+    cur.end = map + header.obj_offset;
+    for (i = 0; i < header.n_cont; i++) {
+        ret_value = PDC_Server_restart_cont(&cur);
+        if (ret_value != SUCCEED) {
+            printf("==PDC_SERVER[%d]: %s - error restoring container %" PRIu64 "\n", pdc_server_rank_g,
+                   __func__, i);
+            goto done;
+        }
+    }
+    n_cont = header.n_cont;
+    nobj   = header.n_obj;
+
+    if (header.n_obj > 0) {
+        metadata     = (pdc_metadata_t *)calloc(header.n_obj, sizeof(pdc_metadata_t));
+        strs         = (const char **)calloc(header.n_obj * 4, sizeof(char *));
+        data_regions = (data_server_region_t **)calloc(header.n_obj, sizeof(data_server_region_t *));
+        if (metadata == NULL || strs == NULL || data_regions == NULL) {
+            printf("==PDC_SERVER[%d]: %s - ERROR allocating %" PRIu64 " objects\n", pdc_server_rank_g,
+                   __func__, header.n_obj);
+            free(metadata);
+            ret_value = FAIL;
+            goto done;
+        }
+        total_mem_usage_g += sizeof(pdc_metadata_t) * header.n_obj;
+
+        // Decode the object records in parallel, each thread takes a contiguous range of the index
+        env_str = getenv("PDC_RESTART_NTHREAD");
+        if (env_str != NULL)
+            nthread = atoi(env_str);
+        else {
+            nthread = sysconf(_SC_NPROCESSORS_ONLN);
+            if (nthread > PDC_RESTART_MAX_NTHREAD)
+                nthread = PDC_RESTART_MAX_NTHREAD;
+        }
+        if ((uint64_t)nthread > header.n_obj / PDC_RESTART_MIN_OBJ_PER_THREAD)
+            nthread = header.n_obj / PDC_RESTART_MIN_OBJ_PER_THREAD;
+        if (nthread < 1)
+            nthread = 1;
+
+        args = (pdc_restart_thread_args_t *)calloc(nthread, sizeof(pdc_restart_thread_args_t));
+        if (args == NULL) {
+            ret_value = FAIL;
+            goto done;
+        }
+        n_per_thread = (header.n_obj + nthread - 1) / nthread;
+        for (t = 0; t < nthread; t++) {
+            args[t].map          = map;
+            args[t].map_size     = st.st_size;
+            args[t].index        = index;
+            args[t].start        = t * n_per_thread;
+            args[t].end          = (t + 1) * n_per_thread;
+            if (args[t].end > header.n_obj)
+                args[t].end = header.n_obj;
+            args[t].metadata     = metadata;
+            args[t].strs         = strs;
+            args[t].data_regions = data_regions;
+            args[t].ret          = SUCCEED;
+            // The last range is decoded by this thread, and so is any range a thread cannot be created for
+            if (t < nthread - 1 &&
+                hg_thread_create(&args[t].thread, PDC_Server_restart_thread, &args[t]) == HG_UTIL_SUCCESS)
+                args[t].is_thread = 1;
+            else
+                PDC_Server_restart_thread(&args[t]);
+        }
+        for (t = 0; t < nthread; t++) {
+            if (args[t].is_thread == 1)
+                hg_thread_join(args[t].thread);
+            if (args[t].ret != SUCCEED)
+                ret_value = FAIL;
+            total_region += args[t].n_region;
+        }
+        if (ret_value != SUCCEED)
+            goto done;
+
+        // Interning and the hash table are not thread safe, finish the objects here in file order
+        for (i = 0; i < header.n_obj; i++) {
+            elt                = metadata + i;
+            elt->obj_name      = PDC_metadata_intern_str(strs[i * 4]);
+            elt->app_name      = PDC_metadata_intern_str(strs[i * 4 + 1]);
+            elt->tags          = PDC_metadata_intern_str(strs[i * 4 + 2]);
+            elt->data_location = PDC_metadata_intern_str(strs[i * 4 + 3]);
+            if (elt->obj_name == NULL || elt->app_name == NULL || elt->tags == NULL ||
+                elt->data_location == NULL) {
+                printf("==PDC_SERVER[%d]: %s -  Checkpoint file metadata string ERROR!", pdc_server_rank_g,
+                       __func__);
+                ret_value = FAIL;
+                goto done;
+            }
+            if (elt->obj_id >= pdc_id_seq_g)
+                pdc_id_seq_g = elt->obj_id + 1;
+
+            key   = index[i].hash_key;
+            entry = PDC_Server_metadata_table_lookup(&key);
+            if (entry == NULL) {
+                entry = (pdc_hash_table_entry_head *)malloc(sizeof(pdc_hash_table_entry_head));
+                if (entry == NULL) {
+                    ret_value = FAIL;
+                    goto done;
+                }
+                entry->n_obj    = 0;
+                entry->metadata = NULL;
+                ret_value       = PDC_Server_hash_table_list_init(entry, &key);
+                if (ret_value != SUCCEED)
+                    goto done;
+                total_mem_usage_g += sizeof(pdc_hash_table_entry_head);
+            }
+
+            // Add to hash list and bloom filter
+            ret_value = PDC_Server_hash_table_list_insert(entry, elt);
+            if (ret_value != SUCCEED) {
+                printf("==PDC_SERVER: error with hash table recovering from checkpoint file\n");
+                goto done;
+            }
+            if (data_regions[i] != NULL)
+                DL_APPEND(dataserver_region_g, data_regions[i]);
+        }
+    }
+
+#ifdef ENABLE_MPI
+    MPI_Reduce(&n_cont, &all_cont, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&nobj, &all_nobj, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&total_region, &all_n_region, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+#else
+    all_cont          = n_cont;
+    all_nobj          = nobj;
+    all_n_region      = total_region;
+#endif
+
+    if (pdc_server_rank_g == 0) {
+        printf("==PDC_SERVER[0]: Server restarted from saved session, "
+               "successfully loaded %d containers, %d objects, %d regions...\n",
+               all_cont, all_nobj, all_n_region);
+    }
+
+done:
+    free(args);
+    free(strs);
+    free(data_regions);
+    if (map != NULL)
+        munmap(map, st.st_size);
+    if (fd != -1)
+        close(fd);
+    fflush(stdout);
+
+    FUNC_LEAVE(ret_value);
+}
+
+#ifdef ENABLE_MULTITHREAD
+/*
+ * Multi-thread Mercury progess
  *
  * \return Non-negative on success/Negative on failure
  */
@@ -1612,6 +2468,13 @@ PDC_Server_multithread_loop(hg_context_t *context)
             break;
 
         ret = HG_Trigger(context, 0, 1, NULL);
+
+        // No more completed callbacks, commit the metadata changes made so far as a group
+        if (ret == HG_TIMEOUT) {
+            PDC_Server_metadata_log_sync();
+            PDC_Server_metadata_log_compact();
+            PDC_Server_tier_progress();
+        }
     } while (ret == HG_SUCCESS || ret == HG_TIMEOUT);
 
     hg_thread_join(progress_thread);
@@ -1644,8 +2507,9 @@ PDC_Server_loop(hg_context_t *hg_context)
     /* Poke progress engine and check for events */
     do {
 #ifndef DISABLE_CHECKPOINT
+        // Without the metadata log, periodically checkpoint the full metadata
         checkpoint_interval++;
-        if (checkpoint_interval % PDC_CHECKPOINT_INTERVAL == 0) {
+        if (disable_metadata_log_g == 1 && checkpoint_interval % PDC_CHECKPOINT_INTERVAL == 0) {
             cur_time            = clock();
             double elapsed_time = ((double)(cur_time - last_checkpoint_time)) / CLOCKS_PER_SEC;
             // Do not checkpoint too often, has a min time interval between checkpoints
@@ -1662,6 +2526,11 @@ PDC_Server_loop(hg_context_t *hg_context)
             hg_ret = HG_Trigger(hg_context, 0 /* timeout */, 1 /* max count */, &actual_count);
         } while ((hg_ret == HG_SUCCESS) && actual_count);
 
+        // Commit the metadata changes of all triggered callbacks as a group
+        PDC_Server_metadata_log_sync();
+        PDC_Server_metadata_log_compact();
+        PDC_Server_tier_progress();
+
         /* Do not try to make progress anymore if we're done */
         if (hg_atomic_cas32(&close_server_g, 1, 1))
             break;
@@ -1778,6 +2647,7 @@ PDC_Server_mercury_register()
     // Register RPC, metadata related
     PDC_client_test_connect_register(hg_class_g);
     PDC_gen_obj_id_register(hg_class_g);
+    PDC_metadata_bulk_create_register(hg_class_g);
     PDC_close_server_register(hg_class_g);
     PDC_metadata_query_register(hg_class_g);
     PDC_container_query_register(hg_class_g);
@@ -1790,6 +2660,7 @@ PDC_Server_mercury_register()
     PDC_gen_cont_id_register(hg_class_g);
     PDC_metadata_add_kvtag_register(hg_class_g);
     PDC_metadata_get_kvtag_register(hg_class_g);
+    PDC_obj_get_stats_register(hg_class_g);
     PDC_metadata_del_kvtag_register(hg_class_g);
 
     // bulk
@@ -1813,6 +2684,7 @@ PDC_Server_mercury_register()
 
     PDC_send_data_query_rpc_register(hg_class_g);
     PDC_get_sel_data_rpc_register(hg_class_g);
+    PDC_query_cursor_rpc_register(hg_class_g);
 
     // Analysis and Transforms
     PDC_set_execution_locus(SERVER_MEMORY);
@@ -1847,6 +2719,7 @@ PDC_Server_mercury_register()
     send_shm_register_id_g                     = PDC_send_shm_register(hg_class_g);
     send_client_storage_meta_rpc_register_id_g = PDC_send_client_storage_meta_rpc_register(hg_class_g);
     send_read_sel_obj_id_rpc_register_id_g     = PDC_send_read_sel_obj_id_rpc_register(hg_class_g);
+    query_cache_invalidate_rpc_register_id_g   = PDC_query_cache_invalidate_rpc_register(hg_class_g);
 }
 
 static void
@@ -1909,6 +2782,10 @@ PDC_Server_get_env()
     if (tmp_env_char != NULL)
         gen_hist_g = 1;
 
+    tmp_env_char = getenv("PDC_GEN_SKETCH");
+    if (tmp_env_char != NULL)
+        gen_sketch_g = 1;
+
     tmp_env_char = getenv("PDC_GEN_FASTBIT_IDX");
     if (tmp_env_char != NULL)
         gen_fastbit_idx_g = 1;
@@ -1917,6 +2794,38 @@ PDC_Server_get_env()
     if (tmp_env_char != NULL)
         use_fastbit_idx_g = 1;
 
+    tmp_env_char = getenv("PDC_QUERY_PLAN_REPORT");
+    if (tmp_env_char != NULL)
+        query_plan_report_g = 1;
+
+    tmp_env_char = getenv("PDC_DISABLE_QUERY_CACHE");
+    if (tmp_env_char != NULL && strcmp(tmp_env_char, "TRUE") == 0)
+        disable_query_cache_g = 1;
+
+#ifdef DISABLE_CHECKPOINT
+    disable_metadata_log_g = 1;
+#endif
+    tmp_env_char = getenv("PDC_DISABLE_METADATA_LOG");
+    if (tmp_env_char != NULL && strcmp(tmp_env_char, "TRUE") == 0)
+        disable_metadata_log_g = 1;
+
+    tmp_env_char = getenv("PDC_METADATA_LOG_COMPACT_MB");
+    if (tmp_env_char != NULL && atoi(tmp_env_char) > 0)
+        metadata_log_compact_size_g = atoi(tmp_env_char) * 1048576ULL;
+
+    tmp_env_char = getenv("PDC_DISABLE_NAME_BLOOM");
+    if (tmp_env_char != NULL && strcmp(tmp_env_char, "TRUE") == 0)
+        disable_name_bloom_g = 1;
+
+    tmp_env_char = getenv("PDC_NAME_BLOOM_CAPACITY");
+    if (tmp_env_char != NULL && atoll(tmp_env_char) > 0)
+        name_bloom_capacity_g = atoll(tmp_env_char);
+
+    // 0 disables client metadata caching
+    tmp_env_char = getenv("PDC_METADATA_LEASE_MS");
+    if (tmp_env_char != NULL && atoi(tmp_env_char) >= 0)
+        metadata_lease_ms_g = atoi(tmp_env_char);
+
     if (pdc_server_rank_g == 0) {
         printf("\n==PDC_SERVER[%d]: using [%s] as tmp dir. %d OSTs per data file, %d%% to BB\n",
                pdc_server_rank_g, pdc_server_tmp_dir_g, pdc_nost_per_file_g, write_to_bb_percentage_g);
@@ -2059,6 +2968,9 @@ main(int argc, char *argv[])
 #endif
 
     // Exit from the loop, start finalize process
+    // Drain the fast tier first, so the checkpoint has the capacity tier locations
+    PDC_Server_tier_finalize();
+
 #ifndef DISABLE_CHECKPOINT
     char *tmp_env_char = getenv("PDC_DISABLE_CHECKPOINT");
     if (tmp_env_char != NULL && strcmp(tmp_env_char, "TRUE") == 0) {
@@ -2069,6 +2981,10 @@ main(int argc, char *argv[])
         PDC_Server_checkpoint();
 #endif
 
+    // Wait for a running compaction before closing the metadata log
+    PDC_Server_metadata_log_compact_wait(1);
+    PDC_Server_metadata_log_close();
+
 #ifdef ENABLE_TIMING
     PDC_print_IO_stats();
 #endif
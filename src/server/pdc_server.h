@@ -59,9 +59,7 @@
 /*****************************/
 /* Library-private Variables */
 /*****************************/
-hg_thread_mutex_t hash_table_new_mutex_g;
 hg_thread_mutex_t pdc_client_addr_mutex_g;
-hg_thread_mutex_t pdc_metadata_hash_table_mutex_g;
 hg_thread_mutex_t pdc_container_hash_table_mutex_g;
 hg_thread_mutex_t pdc_time_mutex_g;
 hg_thread_mutex_t pdc_bloom_time_mutex_g;
@@ -70,11 +68,12 @@ hg_thread_mutex_t gen_obj_id_mutex_g;
 hg_thread_mutex_t total_mem_usage_mutex_g;
 hg_thread_mutex_t data_read_list_mutex_g;
 hg_thread_mutex_t data_write_list_mutex_g;
+hg_thread_mutex_t query_cache_mutex_g;
+hg_thread_mutex_t metadata_log_mutex_g;
 hg_thread_mutex_t region_struct_mutex_g;
 hg_thread_mutex_t data_buf_map_mutex_g;
 hg_thread_mutex_t data_buf_unmap_mutex_g;
 hg_thread_mutex_t data_obj_map_mutex_g;
-hg_thread_mutex_t insert_hash_table_mutex_g;
 hg_thread_mutex_t lock_request_mutex_g;
 hg_thread_mutex_t addr_valid_mutex_g;
 hg_thread_mutex_t update_remote_server_addr_mutex_g;
@@ -86,6 +85,7 @@ hg_thread_mutex_t pdc_server_task_mutex_g;
 
 extern int      n_bloom_total_g;
 extern int      n_bloom_maybe_g;
+extern int      n_bloom_false_pos_g;
 extern double   server_bloom_check_time_g;
 extern double   server_bloom_insert_time_g;
 extern double   server_insert_time_g;
@@ -40,6 +40,7 @@
 
 #include "mercury.h"
 #include "mercury_macros.h"
+#include "mercury_thread.h"
 
 // Mercury hash table and list
 #include "mercury_hash_table.h"
@@ -74,6 +75,20 @@
 hg_thread_mutex_t insert_iterator_mutex_g = HG_THREAD_MUTEX_INITIALIZER;
 #endif
 
+#define PDC_ANALYSIS_MIN_ELEM_PER_THREAD 65536 // Smaller inputs are analyzed by the calling thread
+#define PDC_ANALYSIS_MAX_NTHREAD         16
+
+// Part of the blocks of an analysis run by one thread
+typedef struct pdc_analysis_part_t {
+    int (*ftn)(pdcid_t, pdcid_t, struct _pdc_iterator_cbs_t *);
+    struct _pdc_iterator_cbs_t *cbs;
+    pdcid_t                     iter_in;
+    pdcid_t                     iter_out;
+    int                         result;
+    hg_thread_t                 thread;
+    int                         is_thread;
+} pdc_analysis_part_t;
+
 /*
  * Insert an iterator received from client into a collection
  *
@@ -203,18 +218,11 @@ PDC_Server_get_region_data_ptr(pdcid_t object_id)
 void *
 PDC_Server_get_ftn_reference(char *ftn)
 {
-    static void *appHandle = NULL;
-    void *       ftnHandle = NULL;
-    if (appHandle == NULL) {
-        /* We need the in_process address of the function */
-        if ((appHandle = dlopen(0, RTLD_NOW)) == NULL) {
-            char *this_error = dlerror();
-            fprintf(stderr, "dlopen failed: %s\n", this_error);
-            fflush(stderr);
-            return NULL;
-        }
-    }
-    ftnHandle = dlsym(appHandle, ftn);
+    void *ftnHandle = NULL;
+
+    /* We need the in_process address of the function */
+    if (PDC_get_ftnPtr_(ftn, NULL, &ftnHandle) < 0)
+        return NULL;
     return ftnHandle;
 }
 
@@ -230,15 +238,121 @@ PDCobj_data_getSliceCount(pdcid_t iter)
      */
     if ((PDC_Block_iterator_cache != NULL) && (iter > 0)) {
         thisIter = &PDC_Block_iterator_cache[iter];
+        /* A part of a split iterator only returns its own blocks */
+        if (thisIter->partOf != 0)
+            return thisIter->partBlocks;
         return thisIter->sliceCount;
     }
     return 0;
 }
 
+/*
+ * Point an iterator at the data of its object on the first use
+ *
+ * \param  thisIter[IN/OUT] Iterator
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_iter_init_src(struct _pdc_iterator_info *thisIter)
+{
+    if (thisIter->srcStart == NULL) {
+        if (execution_locus == SERVER_MEMORY) {
+            if ((thisIter->srcNext = PDC_Server_get_region_data_ptr(thisIter->objectId)) == NULL)
+                thisIter->srcNext = malloc(thisIter->totalElements * thisIter->element_size);
+            if ((thisIter->srcStart = thisIter->srcNext) == NULL) {
+                printf("==PDC_ANALYSIS_SERVER: Unable to allocate iterator storage\n");
+                return FAIL;
+            }
+            thisIter->srcNext += thisIter->startOffset + thisIter->skipCount;
+        }
+    }
+    return SUCCEED;
+}
+
+/*
+ * Return the next block of an iterator and advance it
+ *
+ * \param  thisIter[IN/OUT] Iterator
+ * \param  nextBlock[OUT]   Start of the block, may be NULL
+ * \param  dims[OUT]        Dimensions of the block, may be NULL
+ *
+ * \return Number of elements of the block, 0 when there are no more blocks
+ */
+static size_t
+PDC_iter_next_block(struct _pdc_iterator_info *thisIter, void **nextBlock, size_t *dims)
+{
+    if (PDC_iter_init_src(thisIter) != SUCCEED)
+        return 0;
+
+    if (thisIter->partOf != 0) {
+        if (thisIter->partNext == thisIter->partBlocks)
+            goto done;
+        thisIter->partNext++;
+    }
+
+    if (thisIter->srcNext != NULL) {
+        if (thisIter->sliceNext == thisIter->sliceCount) {
+            /* May need to adjust the elements in this last
+             * block...
+             */
+            size_t current_total = thisIter->sliceCount * thisIter->elementsPerBlock;
+            size_t remaining     = 0;
+
+            if (current_total == thisIter->totalElements) {
+                if (nextBlock)
+                    *nextBlock = NULL;
+                thisIter->sliceNext = 0;
+                thisIter->srcNext   = NULL;
+                goto done;
+            }
+            if (nextBlock)
+                *nextBlock = thisIter->srcNext;
+            thisIter->srcNext = NULL;
+            remaining         = thisIter->totalElements - current_total;
+            if (dims) {
+                if (thisIter->storage_order == ROW_major)
+                    dims[0] = remaining / thisIter->elementsPerSlice;
+                else
+                    dims[1] = remaining / thisIter->elementsPerSlice;
+            }
+            return remaining;
+        }
+        else if (thisIter->sliceNext && (thisIter->sliceNext % thisIter->sliceResetCount) == 0) {
+            size_t offset     = ++thisIter->srcBlockCount * thisIter->elementsPerBlock;
+            thisIter->srcNext = thisIter->srcStart + offset + thisIter->skipCount;
+            if (nextBlock)
+                *nextBlock = thisIter->srcNext;
+        }
+        else {
+            if (nextBlock)
+                *nextBlock = thisIter->srcNext;
+            thisIter->srcNext += thisIter->contigBlockSize;
+        }
+        thisIter->sliceNext += 1;
+        if (dims != NULL) {
+            dims[0] = thisIter->dims[0];
+            if (thisIter->ndim > 1)
+                dims[1] = thisIter->dims[1];
+            if (thisIter->ndim > 2)
+                dims[2] = thisIter->dims[2];
+            if (thisIter->ndim > 3)
+                dims[2] = thisIter->dims[3];
+        }
+        return thisIter->elementsPerBlock;
+    }
+
+done:
+    if (dims)
+        dims[0] = dims[1] = 0;
+    if (nextBlock)
+        *nextBlock = NULL;
+    return 0;
+}
+
 size_t
 PDCobj_data_getNextBlock(pdcid_t iter, void **nextBlock, size_t *dims)
 {
-    struct _pdc_iterator_info *thisIter = NULL;
     /* Special case to handle a NULL iterator */
     if (iter == 0) {
         if (nextBlock != NULL)
@@ -248,71 +362,9 @@ PDCobj_data_getNextBlock(pdcid_t iter, void **nextBlock, size_t *dims)
         return 0;
     }
 
-    if ((PDC_Block_iterator_cache != NULL) && (iter > 0)) {
-        thisIter = &PDC_Block_iterator_cache[iter];
-        if (thisIter->srcStart == NULL) {
-            if (execution_locus == SERVER_MEMORY) {
-                if ((thisIter->srcNext = PDC_Server_get_region_data_ptr(thisIter->objectId)) == NULL)
-                    thisIter->srcNext = malloc(thisIter->totalElements * thisIter->element_size);
-                if ((thisIter->srcStart = thisIter->srcNext) == NULL) {
-                    printf("==PDC_ANALYSIS_SERVER: Unable to allocate iterator storage\n");
-                    return 0;
-                }
-                thisIter->srcNext += thisIter->startOffset + thisIter->skipCount;
-            }
-        }
-        if (thisIter->srcNext != NULL) {
-            if (thisIter->sliceNext == thisIter->sliceCount) {
-                /* May need to adjust the elements in this last
-                 * block...
-                 */
-                size_t current_total = thisIter->sliceCount * thisIter->elementsPerBlock;
-                size_t remaining     = 0;
-
-                if (current_total == thisIter->totalElements) {
-                    if (nextBlock)
-                        *nextBlock = NULL;
-                    thisIter->sliceNext = 0;
-                    thisIter->srcNext   = NULL;
-                    goto done;
-                }
-                if (nextBlock)
-                    *nextBlock = thisIter->srcNext;
-                thisIter->srcNext = NULL;
-                remaining         = thisIter->totalElements - current_total;
-                if (dims) {
-                    if (thisIter->storage_order == ROW_major)
-                        dims[0] = remaining / thisIter->elementsPerSlice;
-                    else
-                        dims[1] = remaining / thisIter->elementsPerSlice;
-                }
-                return remaining;
-            }
-            else if (thisIter->sliceNext && (thisIter->sliceNext % thisIter->sliceResetCount) == 0) {
-                size_t offset     = ++thisIter->srcBlockCount * thisIter->elementsPerBlock;
-                thisIter->srcNext = thisIter->srcStart + offset + thisIter->skipCount;
-                if (nextBlock)
-                    *nextBlock = thisIter->srcNext;
-            }
-            else {
-                *nextBlock = thisIter->srcNext;
-                thisIter->srcNext += thisIter->contigBlockSize;
-            }
-            thisIter->sliceNext += 1;
-            if (dims != NULL) {
-                dims[0] = thisIter->dims[0];
-                if (thisIter->ndim > 1)
-                    dims[1] = thisIter->dims[1];
-                if (thisIter->ndim > 2)
-                    dims[2] = thisIter->dims[2];
-                if (thisIter->ndim > 3)
-                    dims[2] = thisIter->dims[3];
-            }
-            return thisIter->elementsPerBlock;
-        }
-    }
+    if ((PDC_Block_iterator_cache != NULL) && (iter > 0))
+        return PDC_iter_next_block(&PDC_Block_iterator_cache[iter], nextBlock, dims);
 
-done:
     if (dims)
         dims[0] = dims[1] = 0;
     if (nextBlock)
@@ -320,6 +372,235 @@ done:
     return 0;
 }
 
+/*
+ * Count the blocks an iterator has left, without moving it
+ *
+ * \param  iter[IN]         Iterator id, its data pointer must be set
+ *
+ * \return Number of blocks
+ */
+static size_t
+PDC_iter_count_blocks(pdcid_t iter)
+{
+    struct _pdc_iterator_info copy = PDC_Block_iterator_cache[iter];
+    size_t                    nblock = 0;
+
+    // A serial run returns at most one more block than the slices, the last partial one
+    while (nblock <= copy.sliceCount && PDC_iter_next_block(&copy, NULL, NULL) > 0)
+        nblock++;
+
+    return nblock;
+}
+
+/*
+ * Move an iterator to the end of its blocks, where a serial run of an analysis leaves it
+ *
+ * \param  iter[IN]         Iterator id
+ */
+static void
+PDC_iter_exhaust(pdcid_t iter)
+{
+    size_t nblock = PDC_iter_count_blocks(iter), i;
+
+    // The call after the last block resets the iterator, as it does for a serial run
+    for (i = 0; i <= nblock; i++)
+        PDC_iter_next_block(&PDC_Block_iterator_cache[iter], NULL, NULL);
+}
+
+/*
+ * Create a part of a split iterator that returns blocks [begin, begin + nblock) of it
+ *
+ * \param  iter[IN]         Iterator id to split, its data pointer must be set
+ * \param  begin[IN]        First block of the part
+ * \param  nblock[IN]       Number of blocks of the part
+ *
+ * \return Id of the part on success/0 on failure
+ */
+static pdcid_t
+PDC_iter_create_part(pdcid_t iter, size_t begin, size_t nblock)
+{
+    struct _pdc_iterator_info *part;
+    int                        partId;
+    size_t                     i;
+
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&insert_iterator_mutex_g);
+#endif
+    partId = PDCiter_get_nextId();
+    if (partId > 0)
+        PDC_Block_iterator_cache[partId] = PDC_Block_iterator_cache[iter];
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&insert_iterator_mutex_g);
+#endif
+    if (partId <= 0)
+        return 0;
+
+    /* Replay the blocks before the part, so that it starts from the same state a serial run would */
+    part = &PDC_Block_iterator_cache[partId];
+    for (i = 0; i < begin; i++)
+        PDC_iter_next_block(part, NULL, NULL);
+    part->local_id   = partId;
+    part->partOf     = iter;
+    part->partBlocks = nblock;
+    part->partNext   = 0;
+
+    return partId;
+}
+
+/*
+ * Release the part iterators of a split iterator
+ *
+ * \param  parts[IN]        Part iterator ids, 0 ids are skipped
+ * \param  nparts[IN]       Number of parts
+ */
+static void
+PDC_iter_free_parts(pdcid_t *parts, int nparts)
+{
+    int i;
+
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&insert_iterator_mutex_g);
+#endif
+    for (i = 0; i < nparts; i++) {
+        if (parts[i] != 0)
+            PDCiter_release_id((int)parts[i]);
+    }
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&insert_iterator_mutex_g);
+#endif
+}
+
+/*
+ * Number of threads to run an analysis with, PDC_ANALYSIS_NTHREAD or the online cores up to
+ * PDC_ANALYSIS_MAX_NTHREAD, with at least PDC_ANALYSIS_MIN_ELEM_PER_THREAD elements per thread
+ *
+ * \param  n[IN]            Number of elements of the input iterator
+ *
+ * \return Number of threads, at least 1
+ */
+static int
+PDC_analysis_nthread(size_t n)
+{
+    int   nthread;
+    char *env_str;
+
+    env_str = getenv("PDC_ANALYSIS_NTHREAD");
+    if (env_str != NULL)
+        nthread = atoi(env_str);
+    else {
+        nthread = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        if (nthread > PDC_ANALYSIS_MAX_NTHREAD)
+            nthread = PDC_ANALYSIS_MAX_NTHREAD;
+    }
+    if ((size_t)nthread > n / PDC_ANALYSIS_MIN_ELEM_PER_THREAD)
+        nthread = (int)(n / PDC_ANALYSIS_MIN_ELEM_PER_THREAD);
+
+    return nthread < 1 ? 1 : nthread;
+}
+
+/*
+ * Run an analysis function on the part iterators of one thread
+ *
+ * \param  arg[IN/OUT]      Part to analyze, a pdc_analysis_part_t
+ */
+static HG_THREAD_RETURN_TYPE
+PDC_analysis_part_thread(void *arg)
+{
+    pdc_analysis_part_t * part = (pdc_analysis_part_t *)arg;
+    HG_THREAD_RETURN_TYPE tret = (HG_THREAD_RETURN_TYPE)0;
+
+    part->result = part->ftn(part->iter_in, part->iter_out, part->cbs);
+
+    return tret;
+}
+
+int
+PDC_Server_run_analysis(int (*ftn)(), pdcid_t iter_in, pdcid_t iter_out, struct _pdc_iterator_cbs_t *cbs,
+                        int flags)
+{
+    int                  ret_value = 0;
+    pdc_analysis_part_t *parts     = NULL;
+    pdcid_t *            part_ids  = NULL;
+    size_t               nblock, begin, end;
+    int                  nthread = 1, t;
+
+    FUNC_ENTER(NULL);
+
+    // Only a function that depends on nothing but its blocks can run on parts of the iterators
+    if ((flags & PDC_ANALYSIS_PARALLEL) && iter_in != 0 && PDC_Block_iterator_cache != NULL) {
+        if (PDC_iter_init_src(&PDC_Block_iterator_cache[iter_in]) != SUCCEED ||
+            (iter_out != 0 && PDC_iter_init_src(&PDC_Block_iterator_cache[iter_out]) != SUCCEED))
+            PGOTO_DONE(-1);
+        nblock  = PDC_iter_count_blocks(iter_in);
+        nthread = PDC_analysis_nthread(PDC_Block_iterator_cache[iter_in].totalElements);
+        if ((size_t)nthread > nblock)
+            nthread = (int)nblock;
+        // The output can only be split along with the input if it has one block for each input block
+        if (nthread > 1 && iter_out != 0 && PDC_iter_count_blocks(iter_out) != nblock)
+            nthread = 1;
+    }
+
+    if (nthread <= 1) {
+        ret_value = ftn(iter_in, iter_out, cbs);
+        PGOTO_DONE(ret_value);
+    }
+
+    parts    = (pdc_analysis_part_t *)calloc(nthread, sizeof(pdc_analysis_part_t));
+    part_ids = (pdcid_t *)calloc(nthread * 2, sizeof(pdcid_t));
+    if (parts == NULL || part_ids == NULL) {
+        ret_value = ftn(iter_in, iter_out, cbs);
+        PGOTO_DONE(ret_value);
+    }
+
+    for (t = 0; t < nthread; t++) {
+        begin             = nblock * t / nthread;
+        end               = nblock * (t + 1) / nthread;
+        parts[t].ftn      = (int (*)(pdcid_t, pdcid_t, struct _pdc_iterator_cbs_t *))ftn;
+        parts[t].cbs      = cbs;
+        parts[t].iter_in  = part_ids[t * 2] = PDC_iter_create_part(iter_in, begin, end - begin);
+        parts[t].iter_out = 0;
+        if (iter_out != 0)
+            parts[t].iter_out = part_ids[t * 2 + 1] = PDC_iter_create_part(iter_out, begin, end - begin);
+        if (parts[t].iter_in == 0 || (iter_out != 0 && parts[t].iter_out == 0)) {
+            // Nothing has run yet, fall back to a serial run on the whole iterators
+            PDC_iter_free_parts(part_ids, nthread * 2);
+            ret_value = ftn(iter_in, iter_out, cbs);
+            PGOTO_DONE(ret_value);
+        }
+    }
+
+    // The last part, and any part a thread cannot be created for, is run by the calling thread
+    for (t = 0; t < nthread - 1; t++)
+        parts[t].is_thread =
+            hg_thread_create(&parts[t].thread, PDC_analysis_part_thread, &parts[t]) == HG_UTIL_SUCCESS;
+    for (t = 0; t < nthread; t++) {
+        if (!parts[t].is_thread)
+            PDC_analysis_part_thread(&parts[t]);
+    }
+    for (t = 0; t < nthread - 1; t++) {
+        if (parts[t].is_thread)
+            hg_thread_join(parts[t].thread);
+    }
+
+    // The first failing part gives the result, and the iterators end where a serial run leaves them
+    for (t = 0; t < nthread; t++) {
+        if (parts[t].result != 0) {
+            ret_value = parts[t].result;
+            break;
+        }
+    }
+    PDC_iter_free_parts(part_ids, nthread * 2);
+    PDC_iter_exhaust(iter_in);
+    if (iter_out != 0)
+        PDC_iter_exhaust(iter_out);
+
+done:
+    free(parts);
+    free(part_ids);
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
+
 int
 PDC_get_analysis_registry(struct _pdc_region_analysis_ftn_info ***registry)
 {
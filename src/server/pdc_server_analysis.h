@@ -32,4 +32,19 @@ perr_t PDC_Server_instantiate_data_iterator(obj_data_iterator_in_t *in, obj_data
 
 int PDC_get_analysis_registry(struct _pdc_region_analysis_ftn_info ***registry);
 
+/**
+ * Run an analysis function, on several threads if it is registered with PDC_ANALYSIS_PARALLEL and its input
+ * iterator holds enough blocks, see PDC_ANALYSIS_NTHREAD
+ *
+ * \param ftn [IN]              Analysis function, called with the iterators and cbs
+ * \param iter_in [IN]          Input iterator id, may be a NULL iterator
+ * \param iter_out [IN]         Output iterator id, may be a NULL iterator
+ * \param cbs [IN]              Iterator callbacks passed to the function
+ * \param flags [IN]            Flags the function is registered with
+ *
+ * \return Result of the function, the first non-zero result of its threads
+ */
+int PDC_Server_run_analysis(int (*ftn)(), pdcid_t iter_in, pdcid_t iter_out, struct _pdc_iterator_cbs_t *cbs,
+                            int flags);
+
 #endif
@@ -0,0 +1,805 @@
+/*
+ * Copyright Notice for
+ * Proactive Data Containers (PDC) Software Library and Utilities
+ * -----------------------------------------------------------------------------
+
+ *** Copyright Notice ***
+
+ * Proactive Data Containers (PDC) Copyright (c) 2017, The Regents of the
+ * University of California, through Lawrence Berkeley National Laboratory,
+ * UChicago Argonne, LLC, operator of Argonne National Laboratory, and The HDF
+ * Group (subject to receipt of any required approvals from the U.S. Dept. of
+ * Energy).  All rights reserved.
+
+ * If you have questions about your rights to use or distribute this software,
+ * please contact Berkeley Lab's Innovation & Partnerships Office at  IPO@lbl.gov.
+
+ * NOTICE.  This Software was developed under funding from the U.S. Department of
+ * Energy and the U.S. Government consequently retains certain rights. As such, the
+ * U.S. Government has been granted for itself and others acting on its behalf a
+ * paid-up, nonexclusive, irrevocable, worldwide license in the Software to
+ * reproduce, distribute copies to the public, prepare derivative works, and
+ * perform publicly and display publicly, and to permit other to do so.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <float.h>
+#include <math.h>
+
+#include "pdc_config.h"
+#include "pdc_client_server_common.h"
+#include "pdc_server_compress.h"
+
+#ifdef ENABLE_LZ4
+#include <lz4.h>
+#endif
+#ifdef ENABLE_ZSTD
+#include <zstd.h>
+#endif
+
+static int compress_warned_g = 0;
+
+/*
+ * Group the bytes of the elements by their position in the element, so that the slowly changing high
+ * bytes of smooth data are next to each other
+ *
+ * \param  src[IN]          Data
+ * \param  dst[OUT]         Shuffled data
+ * \param  size[IN]         Bytes of data, trailing bytes of a partial element are copied as is
+ * \param  unit[IN]         Size of the elements
+ */
+static void
+PDC_compress_shuffle(const char *src, char *dst, uint64_t size, size_t unit)
+{
+    uint64_t i, n = size / unit;
+    size_t   b;
+
+    for (i = 0; i < n; i++) {
+        for (b = 0; b < unit; b++)
+            dst[b * n + i] = src[i * unit + b];
+    }
+    memcpy(dst + n * unit, src + n * unit, size - n * unit);
+}
+
+/*
+ * Undo PDC_compress_shuffle
+ *
+ * \param  src[IN]          Shuffled data
+ * \param  dst[OUT]         Data
+ * \param  size[IN]         Bytes of data
+ * \param  unit[IN]         Size of the elements
+ */
+static void
+PDC_compress_unshuffle(const char *src, char *dst, uint64_t size, size_t unit)
+{
+    uint64_t i, n = size / unit;
+    size_t   b;
+
+    for (i = 0; i < n; i++) {
+        for (b = 0; b < unit; b++)
+            dst[i * unit + b] = src[b * n + i];
+    }
+    memcpy(dst + n * unit, src + n * unit, size - n * unit);
+}
+
+/*
+ * Compress data with a codec
+ *
+ * \param  codec[IN]        PDC_COMPRESS_LZ4 or PDC_COMPRESS_ZSTD
+ * \param  level[IN]        Zstandard level
+ * \param  src[IN]          Data
+ * \param  size[IN]         Bytes of data
+ * \param  dst[OUT]         Compressed data
+ * \param  dst_size[IN]     Bytes available at dst
+ *
+ * \return Bytes of compressed data/0 if the codec is not available or the result does not fit in dst
+ */
+static uint64_t
+PDC_compress_codec(pdc_compress_t codec, int level, const char *src, uint64_t size, char *dst,
+                   uint64_t dst_size)
+{
+#ifdef ENABLE_LZ4
+    int lz4_size;
+#endif
+#ifdef ENABLE_ZSTD
+    size_t zstd_size;
+#endif
+
+#ifdef ENABLE_LZ4
+    if (codec == PDC_COMPRESS_LZ4) {
+        if (size > LZ4_MAX_INPUT_SIZE)
+            return 0;
+        lz4_size = LZ4_compress_default(src, dst, (int)size, dst_size > INT_MAX ? INT_MAX : (int)dst_size);
+        return lz4_size > 0 ? (uint64_t)lz4_size : 0;
+    }
+#endif
+#ifdef ENABLE_ZSTD
+    if (codec == PDC_COMPRESS_ZSTD) {
+        zstd_size = ZSTD_compress(dst, dst_size, src, size, level > 0 ? level : PDC_COMPRESS_ZSTD_LEVEL);
+        return ZSTD_isError(zstd_size) ? 0 : zstd_size;
+    }
+#endif
+    (void)level;
+    (void)src;
+    (void)size;
+    (void)dst;
+    (void)dst_size;
+
+    return 0;
+}
+
+/*
+ * Decompress data compressed with a codec
+ *
+ * \param  codec[IN]        PDC_COMPRESS_LZ4 or PDC_COMPRESS_ZSTD
+ * \param  src[IN]          Compressed data
+ * \param  src_size[IN]     Bytes of compressed data
+ * \param  dst[OUT]         Data
+ * \param  dst_size[IN]     Bytes of data
+ *
+ * \return dst_size on success/0 if the codec is not available or the data is not valid
+ */
+static uint64_t
+PDC_decompress_codec(pdc_compress_t codec, const char *src, uint64_t src_size, char *dst, uint64_t dst_size)
+{
+#ifdef ENABLE_LZ4
+    if (codec == PDC_COMPRESS_LZ4 && src_size <= INT_MAX && dst_size <= INT_MAX)
+        return LZ4_decompress_safe(src, dst, (int)src_size, (int)dst_size) == (int)dst_size ? dst_size : 0;
+#endif
+#ifdef ENABLE_ZSTD
+    if (codec == PDC_COMPRESS_ZSTD)
+        return ZSTD_decompress(dst, dst_size, src, src_size) == dst_size ? dst_size : 0;
+#endif
+    (void)codec;
+    (void)src;
+    (void)src_size;
+    (void)dst;
+    (void)dst_size;
+
+    return 0;
+}
+
+/*
+ * Get the Huffman code lengths of bytes, no longer than PDC_LOSSY_HUFFMAN_BITS. The counts are flattened
+ * until the longest code fits.
+ *
+ * \param  count[IN]        Number of occurrences of each byte
+ * \param  len[OUT]         Code length of each byte, 0 for the bytes that do not occur
+ */
+static void
+PDC_huffman_lengths(const uint64_t *count, uint8_t *len)
+{
+    uint64_t weight[512];
+    int      parent[512], alive[512];
+    int      n_node, n_leaf, i, a, b, depth, max_len, node;
+
+    for (i = 0; i < 256; i++)
+        weight[i] = count[i];
+    for (;;) {
+        memset(len, 0, 256);
+        n_leaf = 0;
+        for (i = 0; i < 256; i++) {
+            parent[i] = -1;
+            alive[i]  = weight[i] > 0;
+            n_leaf += alive[i];
+        }
+        if (n_leaf == 1) {
+            for (i = 0; i < 256; i++)
+                len[i] = alive[i];
+            return;
+        }
+        if (n_leaf == 0)
+            return;
+
+        // Merge the two lightest nodes until one is left, 256 symbols at most so a scan is enough
+        for (n_node = 256; n_node < 256 + n_leaf - 1; n_node++) {
+            a = b = -1;
+            for (i = 0; i < n_node; i++) {
+                if (!alive[i])
+                    continue;
+                if (a < 0 || weight[i] < weight[a]) {
+                    b = a;
+                    a = i;
+                }
+                else if (b < 0 || weight[i] < weight[b])
+                    b = i;
+            }
+            weight[n_node] = weight[a] + weight[b];
+            alive[n_node]  = 1;
+            parent[n_node] = -1;
+            alive[a] = alive[b] = 0;
+            parent[a] = parent[b] = n_node;
+        }
+
+        max_len = 0;
+        for (i = 0; i < 256; i++) {
+            if (count[i] == 0)
+                continue;
+            for (depth = 0, node = i; parent[node] >= 0; node = parent[node])
+                depth++;
+            len[i]  = (uint8_t)depth;
+            max_len = depth > max_len ? depth : max_len;
+        }
+        if (max_len <= PDC_LOSSY_HUFFMAN_BITS)
+            return;
+        for (i = 0; i < 256; i++)
+            weight[i] = weight[i] > 0 ? (weight[i] >> 1) | 1 : 0;
+    }
+}
+
+/*
+ * Assign canonical Huffman codes from code lengths, shorter codes first and then by byte value
+ *
+ * \param  len[IN]          Code length of each byte
+ * \param  code[OUT]        Code of each byte
+ */
+static void
+PDC_huffman_codes(const uint8_t *len, uint32_t *code)
+{
+    uint32_t next = 0;
+    int      l, i;
+
+    for (l = 1; l <= PDC_LOSSY_HUFFMAN_BITS; l++) {
+        for (i = 0; i < 256; i++) {
+            if (len[i] == l)
+                code[i] = next++;
+        }
+        next <<= 1;
+    }
+}
+
+/*
+ * Huffman code bytes
+ *
+ * \param  src[IN]          Bytes
+ * \param  size[IN]         Number of bytes
+ * \param  dst[OUT]         Code lengths of the 256 byte values followed by the bit stream
+ * \param  dst_size[IN]     Bytes available at dst
+ *
+ * \return Bytes of coded data/0 if it does not fit in dst
+ */
+static uint64_t
+PDC_huffman_encode(const uint8_t *src, uint64_t size, uint8_t *dst, uint64_t dst_size)
+{
+    uint64_t count[256] = {0}, i, pos = 256, acc = 0;
+    uint32_t code[256];
+    uint8_t  len[256];
+    int      n_bit = 0;
+
+    if (dst_size <= 256)
+        return 0;
+    for (i = 0; i < size; i++)
+        count[src[i]]++;
+    PDC_huffman_lengths(count, len);
+    PDC_huffman_codes(len, code);
+    memcpy(dst, len, 256);
+
+    for (i = 0; i < size; i++) {
+        acc = (acc << len[src[i]]) | code[src[i]];
+        n_bit += len[src[i]];
+        while (n_bit >= 8) {
+            if (pos >= dst_size)
+                return 0;
+            n_bit -= 8;
+            dst[pos++] = (uint8_t)(acc >> n_bit);
+        }
+    }
+    if (n_bit > 0) {
+        if (pos >= dst_size)
+            return 0;
+        dst[pos++] = (uint8_t)(acc << (8 - n_bit));
+    }
+
+    return pos;
+}
+
+/*
+ * Decode Huffman coded bytes with a table of the next PDC_LOSSY_HUFFMAN_BITS bits
+ *
+ * \param  src[IN]          Data from PDC_huffman_encode
+ * \param  src_size[IN]     Bytes of data
+ * \param  dst[OUT]         Bytes
+ * \param  size[IN]         Number of bytes
+ *
+ * \return Non-negative on success/Negative if the data is not valid
+ */
+static perr_t
+PDC_huffman_decode(const uint8_t *src, uint64_t src_size, uint8_t *dst, uint64_t size)
+{
+    uint16_t *table;
+    uint32_t  code[256];
+    uint64_t  i, pos = 256, acc = 0;
+    uint32_t  j, first, n_fill;
+    int       n_bit = 0, s, l;
+
+    if (src_size < 256)
+        return FAIL;
+    for (s = 0; s < 256; s++) {
+        if (src[s] > PDC_LOSSY_HUFFMAN_BITS)
+            return FAIL;
+    }
+    table = (uint16_t *)calloc(1 << PDC_LOSSY_HUFFMAN_BITS, sizeof(uint16_t));
+    if (table == NULL)
+        return FAIL;
+
+    // Each entry has the byte in the low bits and the length of its code in the high bits
+    PDC_huffman_codes(src, code);
+    for (s = 0; s < 256; s++) {
+        l = src[s];
+        if (l == 0)
+            continue;
+        first  = code[s] << (PDC_LOSSY_HUFFMAN_BITS - l);
+        n_fill = 1 << (PDC_LOSSY_HUFFMAN_BITS - l);
+        if (first + n_fill > (1 << PDC_LOSSY_HUFFMAN_BITS))
+            goto fail;
+        for (j = 0; j < n_fill; j++)
+            table[first + j] = (uint16_t)(s | (l << 8));
+    }
+
+    for (i = 0; i < size; i++) {
+        while (n_bit < PDC_LOSSY_HUFFMAN_BITS) {
+            acc = (acc << 8) | (pos < src_size ? src[pos] : 0);
+            pos++;
+            n_bit += 8;
+        }
+        j = table[(acc >> (n_bit - PDC_LOSSY_HUFFMAN_BITS)) & ((1 << PDC_LOSSY_HUFFMAN_BITS) - 1)];
+        if ((j >> 8) == 0)
+            goto fail;
+        dst[i] = (uint8_t)j;
+        n_bit -= j >> 8;
+    }
+    if (pos > src_size + 2)
+        goto fail;
+
+    free(table);
+    return SUCCEED;
+
+fail:
+    free(table);
+    return FAIL;
+}
+
+/*
+ * Get the range of the finite values of a region
+ *
+ * \param  buf[IN]          Values
+ * \param  n[IN]            Number of values
+ * \param  unit[IN]         4 for float, 8 for double
+ * \param  lo[OUT]          Smallest finite value
+ * \param  hi[OUT]          Largest finite value, smaller than lo if there is none
+ */
+static void
+PDC_lossy_range(const void *buf, uint64_t n, size_t unit, double *lo, double *hi)
+{
+    const float * fsrc = (const float *)buf;
+    const double *dsrc = (const double *)buf;
+    double        min = DBL_MAX, max = -DBL_MAX, v;
+    uint64_t      i;
+
+    if (unit == sizeof(float)) {
+        for (i = 0; i < n; i++) {
+            v   = fsrc[i];
+            min = (v < min && fabs(v) <= DBL_MAX) ? v : min;
+            max = (v > max && fabs(v) <= DBL_MAX) ? v : max;
+        }
+    }
+    else {
+        for (i = 0; i < n; i++) {
+            v   = dsrc[i];
+            min = (v < min && fabs(v) <= DBL_MAX) ? v : min;
+            max = (v > max && fabs(v) <= DBL_MAX) ? v : max;
+        }
+    }
+    *lo = min;
+    *hi = max;
+}
+
+/*
+ * Quantize float values to multiples of step. The loop has no branches or calls, and the quantized
+ * values are kept as doubles, so that it is vectorized.
+ *
+ * \param  src[IN]          Values
+ * \param  n[IN]            Number of values
+ * \param  step[IN]         Quantization step
+ * \param  quant[OUT]       Quantized values, not valid for the outliers
+ * \param  outlier[OUT]     1 for the values whose quantized value is not within step / 2 of them
+ */
+static void
+PDC_lossy_quantize_float(const float *restrict src, uint64_t n, double step, double *restrict quant,
+                         uint8_t *restrict outlier)
+{
+    double   inv = 1.0 / step, eb = step / 2, q;
+    uint64_t i;
+
+    for (i = 0; i < n; i++) {
+        q          = (src[i] * inv + PDC_LOSSY_ROUND) - PDC_LOSSY_ROUND;
+        quant[i]   = q;
+        outlier[i] = !((fabs(q) < PDC_LOSSY_MAX_QUANT) & (fabs((double)(float)(q * step) - src[i]) <= eb));
+    }
+}
+
+/*
+ * Quantize double values to multiples of step, see PDC_lossy_quantize_float
+ */
+static void
+PDC_lossy_quantize_double(const double *restrict src, uint64_t n, double step, double *restrict quant,
+                          uint8_t *restrict outlier)
+{
+    double   inv = 1.0 / step, eb = step / 2, q;
+    uint64_t i;
+
+    for (i = 0; i < n; i++) {
+        q          = (src[i] * inv + PDC_LOSSY_ROUND) - PDC_LOSSY_ROUND;
+        quant[i]   = q;
+        outlier[i] = !((fabs(q) < PDC_LOSSY_MAX_QUANT) & (fabs(q * step - src[i]) <= eb));
+    }
+}
+
+/*
+ * Compress float or double values with an error bound, see pdc_lossy_header_t
+ *
+ * \param  mode[IN]         Whether error_bound is absolute or relative to the value range
+ * \param  error_bound[IN]  Error bound
+ * \param  unit[IN]         4 for float, 8 for double
+ * \param  buf[IN]          Values
+ * \param  size[IN]         Bytes of values
+ * \param  quant_step[IN/OUT] Quantization step to use if positive, set to the step used
+ * \param  out[OUT]         Header and compressed data, to be freed by the caller
+ * \param  out_size[OUT]    Bytes of header and compressed data
+ *
+ * \return PDC_COMPRESS_LOSSY/PDC_COMPRESS_NONE if the values cannot be compressed with the bound
+ */
+static pdc_compress_t
+PDC_compress_lossy(pdc_error_bound_t mode, double error_bound, size_t unit, void *buf, uint64_t size,
+                   double *quant_step, void **out, uint64_t *out_size)
+{
+    pdc_compress_t         ret_value = PDC_COMPRESS_NONE;
+    pdc_compress_header_t *header;
+    pdc_lossy_header_t     lossy;
+    double *               quant   = NULL, prev;
+    int64_t                diff;
+    uint8_t *              outlier = NULL, *code = NULL;
+    char *                 dst     = NULL, *pos;
+    uint64_t               n, i, k, limit, fixed, zz;
+    double                 step, lo, hi;
+
+    n = size / unit;
+    if ((unit != sizeof(float) && unit != sizeof(double)) || size % unit != 0 || size < PDC_COMPRESS_MIN_SIZE)
+        goto done;
+
+    // A region that was quantized before keeps its step, so its values do not move again
+    step = *quant_step;
+    if (!(step > 0)) {
+        step = 2 * error_bound;
+        if (mode == PDC_ERROR_BOUND_REL) {
+            PDC_lossy_range(buf, n, unit, &lo, &hi);
+            step = hi >= lo ? 2 * error_bound * (hi - lo) : 0;
+        }
+    }
+    // Constant regions are left to the lossless codecs
+    if (!(step > 0) || step > DBL_MAX)
+        goto done;
+
+    limit   = size - size / 8;
+    quant   = (double *)malloc(n * sizeof(double));
+    outlier = (uint8_t *)malloc(n);
+    code    = (uint8_t *)malloc(limit + 10);
+    dst     = (char *)malloc(sizeof(pdc_compress_header_t) + limit);
+    if (quant == NULL || outlier == NULL || code == NULL || dst == NULL)
+        goto done;
+
+    if (unit == sizeof(float))
+        PDC_lossy_quantize_float((float *)buf, n, step, quant, outlier);
+    else
+        PDC_lossy_quantize_double((double *)buf, n, step, quant, outlier);
+
+    memset(&lossy, 0, sizeof(lossy));
+    for (i = 0; i < n; i++)
+        lossy.n_outlier += outlier[i];
+    fixed = sizeof(pdc_compress_header_t) + sizeof(pdc_lossy_header_t) + lossy.n_outlier * (8 + unit);
+    if (fixed >= limit)
+        goto done;
+
+    // Outliers are stored as is, and take the quantized value before them to keep the prediction
+    pos = dst + sizeof(pdc_compress_header_t) + sizeof(pdc_lossy_header_t);
+    for (i = 0, k = 0; i < n && k < lossy.n_outlier; i++) {
+        if (outlier[i] == 0)
+            continue;
+        quant[i] = i > 0 ? quant[i - 1] : 0;
+        memcpy(pos + k * 8, &i, 8);
+        memcpy(pos + lossy.n_outlier * 8 + k * unit, (char *)buf + i * unit, unit);
+        k++;
+    }
+    pos += lossy.n_outlier * (8 + unit);
+
+    // Code the difference to the previous value, small differences take a single byte. The quantized values
+    // are integers below 2^52, so their differences are exact.
+    prev = 0;
+    for (i = 0; i < n; i++) {
+        diff = (int64_t)(quant[i] - prev);
+        prev = quant[i];
+        zz   = ((uint64_t)diff << 1) ^ (uint64_t)(diff >> 63);
+        while (zz >= 0x80) {
+            code[lossy.n_code++] = (uint8_t)(zz | 0x80);
+            zz >>= 7;
+        }
+        code[lossy.n_code++] = (uint8_t)zz;
+        if (fixed + lossy.n_code > limit)
+            goto done;
+    }
+
+    // Entropy code the codes, with Zstandard if it is built in
+    lossy.codec     = PDC_COMPRESS_ZSTD;
+    lossy.code_size =
+        PDC_compress_codec(PDC_COMPRESS_ZSTD, 0, (char *)code, lossy.n_code, pos, lossy.n_code - 1);
+    if (lossy.code_size == 0) {
+        lossy.codec     = PDC_LOSSY_HUFFMAN;
+        lossy.code_size = PDC_huffman_encode(code, lossy.n_code, (uint8_t *)pos, lossy.n_code - 1);
+    }
+    if (lossy.code_size == 0) {
+        lossy.codec     = PDC_COMPRESS_NONE;
+        lossy.code_size = lossy.n_code;
+        memcpy(pos, code, lossy.n_code);
+    }
+
+    lossy.step   = step;
+    lossy.n_elem = n;
+    lossy.unit   = unit;
+    memcpy(dst + sizeof(pdc_compress_header_t), &lossy, sizeof(lossy));
+
+    header          = (pdc_compress_header_t *)dst;
+    header->codec   = PDC_COMPRESS_LOSSY;
+    header->shuffle = 0;
+    header->size    = fixed - sizeof(pdc_compress_header_t) + lossy.code_size;
+    *out            = dst;
+    *out_size       = fixed + lossy.code_size;
+    *quant_step     = step;
+    dst             = NULL;
+    ret_value       = PDC_COMPRESS_LOSSY;
+
+done:
+    free(quant);
+    free(outlier);
+    free(code);
+    free(dst);
+    return ret_value;
+}
+
+/*
+ * Decompress values compressed by PDC_compress_lossy
+ *
+ * \param  in[IN]           Payload, after the pdc_compress_header_t
+ * \param  in_size[IN]      Bytes of payload
+ * \param  buf[OUT]         Values
+ * \param  size[IN]         Bytes of values
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_decompress_lossy(const char *in, uint64_t in_size, void *buf, uint64_t size)
+{
+    perr_t             ret_value = FAIL;
+    pdc_lossy_header_t lossy;
+    const char *       outlier_idx, *outlier_val;
+    const uint8_t *    code;
+    uint8_t *          stage = NULL, b;
+    double *           quant = NULL, prev = 0;
+    uint64_t           i, j, k, zz, fixed;
+    unsigned           shift;
+    float *            fdst = (float *)buf;
+    double *           ddst = (double *)buf;
+
+    if (in_size < sizeof(lossy))
+        goto done;
+    memcpy(&lossy, in, sizeof(lossy));
+    fixed = sizeof(lossy) + lossy.n_outlier * (8 + (uint64_t)lossy.unit);
+    if ((lossy.unit != sizeof(float) && lossy.unit != sizeof(double)) || lossy.n_elem * lossy.unit != size ||
+        lossy.n_outlier > lossy.n_elem || fixed > in_size || lossy.code_size > in_size - fixed)
+        goto done;
+    outlier_idx = in + sizeof(lossy);
+    outlier_val = outlier_idx + lossy.n_outlier * 8;
+    code        = (const uint8_t *)(in + fixed);
+
+    if (lossy.codec == PDC_LOSSY_HUFFMAN) {
+        stage = (uint8_t *)malloc(lossy.n_code);
+        if (stage == NULL || PDC_huffman_decode(code, lossy.code_size, stage, lossy.n_code) != SUCCEED)
+            goto done;
+        code = stage;
+    }
+    else if (lossy.codec != PDC_COMPRESS_NONE) {
+        stage = (uint8_t *)malloc(lossy.n_code);
+        if (stage == NULL || PDC_decompress_codec((pdc_compress_t)lossy.codec, (const char *)code,
+                                                  lossy.code_size, (char *)stage, lossy.n_code) == 0)
+            goto done;
+        code = stage;
+    }
+    else if (lossy.code_size != lossy.n_code)
+        goto done;
+
+    quant = (double *)malloc(lossy.n_elem * sizeof(double));
+    if (quant == NULL)
+        goto done;
+    for (i = 0, j = 0; i < lossy.n_elem; i++) {
+        zz    = 0;
+        shift = 0;
+        do {
+            if (j >= lossy.n_code || shift > 63)
+                goto done;
+            b = code[j++];
+            zz |= (uint64_t)(b & 0x7f) << shift;
+            shift += 7;
+        } while (b & 0x80);
+        prev += (double)((int64_t)(zz >> 1) ^ -(int64_t)(zz & 1));
+        quant[i] = prev;
+    }
+
+    // Same conversion as the quantization checked the error of
+    if (lossy.unit == sizeof(float)) {
+        for (i = 0; i < lossy.n_elem; i++)
+            fdst[i] = (float)(quant[i] * lossy.step);
+    }
+    else {
+        for (i = 0; i < lossy.n_elem; i++)
+            ddst[i] = quant[i] * lossy.step;
+    }
+
+    for (k = 0; k < lossy.n_outlier; k++) {
+        memcpy(&i, outlier_idx + k * 8, 8);
+        if (i >= lossy.n_elem)
+            goto done;
+        memcpy((char *)buf + i * lossy.unit, outlier_val + k * lossy.unit, lossy.unit);
+    }
+    ret_value = SUCCEED;
+
+done:
+    free(stage);
+    free(quant);
+    return ret_value;
+}
+
+pdc_compress_t
+PDC_Server_compress(pdc_compress_t compress, int level, pdc_error_bound_t mode, double error_bound,
+                    size_t unit, void *buf, uint64_t size, double *quant_step, void **out, uint64_t *out_size)
+{
+    pdc_compress_t         ret_value = PDC_COMPRESS_NONE;
+    pdc_compress_t         codecs[2];
+    pdc_compress_header_t *header;
+    char *                 shuffled = NULL, *dst = NULL, *src;
+    uint64_t               sample, limit, best_size = 0, cur_size;
+    int                    n_codec = 0, i, s, best_shuffle = 0;
+
+    FUNC_ENTER(NULL);
+
+    // Data that cannot be compressed within the error bound is compressed losslessly
+    if (compress == PDC_COMPRESS_LOSSY) {
+        ret_value = PDC_compress_lossy(mode, error_bound, unit, buf, size, quant_step, out, out_size);
+        if (ret_value != PDC_COMPRESS_NONE)
+            goto done;
+        compress = PDC_COMPRESS_AUTO;
+    }
+
+    // LZ4 first, Zstandard is only chosen over it if it is clearly smaller
+#ifdef ENABLE_LZ4
+    if (compress == PDC_COMPRESS_AUTO || compress == PDC_COMPRESS_LZ4)
+        codecs[n_codec++] = PDC_COMPRESS_LZ4;
+#endif
+#ifdef ENABLE_ZSTD
+    if (compress == PDC_COMPRESS_AUTO || compress == PDC_COMPRESS_ZSTD)
+        codecs[n_codec++] = PDC_COMPRESS_ZSTD;
+#endif
+    if (n_codec == 0) {
+        if (compress != PDC_COMPRESS_NONE && compress_warned_g == 0) {
+            printf("==PDC_SERVER[%d]: codec %d is not built in, object data is stored uncompressed\n",
+                   pdc_server_rank_g, compress);
+            compress_warned_g = 1;
+        }
+        goto done;
+    }
+    if (size < PDC_COMPRESS_MIN_SIZE || unit == 0)
+        goto done;
+
+    shuffled = (char *)malloc(size);
+    dst      = (char *)malloc(sizeof(pdc_compress_header_t) + size);
+    if (shuffled == NULL || dst == NULL)
+        goto done;
+
+    // Choose the codec and shuffle on a sample of whole elements
+    sample = size < PDC_COMPRESS_SAMPLE_SIZE ? size : PDC_COMPRESS_SAMPLE_SIZE;
+    sample -= sample % unit;
+    limit = sample - sample / 8;
+    for (s = (unit > 1 ? 1 : 0); s >= 0; s--) {
+        src = (char *)buf;
+        if (s == 1) {
+            PDC_compress_shuffle((char *)buf, shuffled, sample, unit);
+            src = shuffled;
+        }
+        for (i = 0; i < n_codec; i++) {
+            cur_size = PDC_compress_codec(codecs[i], level, src, sample, dst, limit);
+            if (cur_size == 0)
+                continue;
+            ret_value    = codecs[i];
+            best_shuffle = s;
+            best_size    = cur_size;
+            limit        = best_size - best_size / 10;
+        }
+    }
+    if (ret_value == PDC_COMPRESS_NONE)
+        goto done;
+
+    // Compress the region, which still has to shrink by an eighth
+    src = (char *)buf;
+    if (best_shuffle == 1) {
+        PDC_compress_shuffle((char *)buf, shuffled, size, unit);
+        src = shuffled;
+    }
+    best_size = PDC_compress_codec(ret_value, level, src, size, dst + sizeof(pdc_compress_header_t),
+                                   size - size / 8);
+    if (best_size == 0) {
+        ret_value = PDC_COMPRESS_NONE;
+        goto done;
+    }
+
+    header          = (pdc_compress_header_t *)dst;
+    header->codec   = ret_value;
+    header->shuffle = best_shuffle == 1 ? unit : 0;
+    header->size    = best_size;
+    *out            = dst;
+    *out_size       = sizeof(pdc_compress_header_t) + best_size;
+    dst             = NULL;
+
+done:
+    free(shuffled);
+    free(dst);
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDC_Server_decompress(void *in, uint64_t in_size, void *buf, uint64_t size)
+{
+    perr_t                 ret_value = FAIL;
+    pdc_compress_header_t *header    = (pdc_compress_header_t *)in;
+    uint64_t               dst_size  = 0;
+    char *                 src, *dst, *shuffled = NULL;
+
+    FUNC_ENTER(NULL);
+
+    if (in_size < sizeof(pdc_compress_header_t) || header->size > in_size - sizeof(pdc_compress_header_t))
+        goto done;
+    src = (char *)in + sizeof(pdc_compress_header_t);
+
+    if (header->codec == PDC_COMPRESS_LOSSY) {
+        ret_value = PDC_decompress_lossy(src, header->size, buf, size);
+        if (ret_value != SUCCEED)
+            printf("==PDC_SERVER[%d]: unable to decompress %" PRIu64 " bytes of lossy data\n",
+                   pdc_server_rank_g, header->size);
+        goto done;
+    }
+
+    dst = (char *)buf;
+    if (header->shuffle > 1) {
+        shuffled = (char *)malloc(size);
+        if (shuffled == NULL)
+            goto done;
+        dst = shuffled;
+    }
+
+    dst_size = PDC_decompress_codec((pdc_compress_t)header->codec, src, header->size, dst, size);
+    if (dst_size != size) {
+        printf("==PDC_SERVER[%d]: unable to decompress %" PRIu64 " bytes with codec %u\n", pdc_server_rank_g,
+               header->size, header->codec);
+        goto done;
+    }
+
+    if (header->shuffle > 1)
+        PDC_compress_unshuffle(shuffled, (char *)buf, size, header->shuffle);
+    ret_value = SUCCEED;
+
+done:
+    free(shuffled);
+    FUNC_LEAVE(ret_value);
+}
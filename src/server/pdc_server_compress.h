@@ -0,0 +1,109 @@
+/*
+ * Copyright Notice for
+ * Proactive Data Containers (PDC) Software Library and Utilities
+ * -----------------------------------------------------------------------------
+
+ *** Copyright Notice ***
+
+ * Proactive Data Containers (PDC) Copyright (c) 2017, The Regents of the
+ * University of California, through Lawrence Berkeley National Laboratory,
+ * UChicago Argonne, LLC, operator of Argonne National Laboratory, and The HDF
+ * Group (subject to receipt of any required approvals from the U.S. Dept. of
+ * Energy).  All rights reserved.
+
+ * If you have questions about your rights to use or distribute this software,
+ * please contact Berkeley Lab's Innovation & Partnerships Office at  IPO@lbl.gov.
+
+ * NOTICE.  This Software was developed under funding from the U.S. Department of
+ * Energy and the U.S. Government consequently retains certain rights. As such, the
+ * U.S. Government has been granted for itself and others acting on its behalf a
+ * paid-up, nonexclusive, irrevocable, worldwide license in the Software to
+ * reproduce, distribute copies to the public, prepare derivative works, and
+ * perform publicly and display publicly, and to permit other to do so.
+ */
+
+
+#ifndef PDC_SERVER_COMPRESS_H
+#define PDC_SERVER_COMPRESS_H
+
+#include "pdc_client_server_common.h"
+
+#define PDC_COMPRESS_SAMPLE_SIZE 65536 // bytes of a region compressed to choose its codec and shuffle
+#define PDC_COMPRESS_MIN_SIZE    4096  // smaller regions are stored raw
+#define PDC_COMPRESS_ZSTD_LEVEL  1     // default Zstandard level
+
+// Adding and subtracting 1.5 * 2^52 rounds a double below 2^51 to an integer, larger quantized values
+// are stored as outliers
+#define PDC_LOSSY_ROUND     6755399441055744.0
+#define PDC_LOSSY_MAX_QUANT 2251799813685248.0
+// Codec of lossy codes coded by the built-in Huffman coder, and its longest code
+#define PDC_LOSSY_HUFFMAN      255
+#define PDC_LOSSY_HUFFMAN_BITS 12
+
+/*
+ * Compression of the storage regions of the data server. A compressed region is stored as a
+ * pdc_compress_header_t followed by the compressed bytes, its storage_size is the space it has in the
+ * object file, which can be larger than the header and payload after it is overwritten. LZ4 and
+ * Zstandard are available if the server is built with PDC_ENABLE_LZ4 and PDC_ENABLE_ZSTD.
+ */
+typedef struct pdc_compress_header_t {
+    uint32_t codec;   // pdc_compress_t of the payload
+    uint32_t shuffle; // element size the bytes were shuffled with, 0 if not shuffled
+    uint64_t size;    // bytes of the payload
+} pdc_compress_header_t;
+
+/*
+ * Payload of a PDC_COMPRESS_LOSSY region. The values are quantized to multiples of step, which bounds the
+ * error by step / 2, and each multiple is predicted by the previous one. The differences are zigzag and
+ * varint coded, and the codes entropy coded by Zstandard if it is built in, or by a byte Huffman coder
+ * whose 256 code lengths are stored before the bit stream. Values that cannot be quantized within the
+ * bound, like NaN and infinities, are stored as is. The header is followed by the n_outlier uint64_t
+ * indices and values of the outliers, and by code_size bytes of codes.
+ */
+typedef struct pdc_lossy_header_t {
+    double   step;      // quantization step, twice the absolute error bound
+    uint64_t n_elem;    // number of values
+    uint64_t n_outlier; // number of values stored as is
+    uint64_t n_code;    // bytes of the varint codes
+    uint64_t code_size; // bytes of the codes as stored, after the lossless stage
+    uint32_t unit;      // 4 for float, 8 for double
+    uint32_t codec;     // PDC_COMPRESS_ZSTD, PDC_LOSSY_HUFFMAN or PDC_COMPRESS_NONE if the codes are raw
+} pdc_lossy_header_t;
+
+/**
+ * Compress the data of a storage region. The codec and the byte shuffle are chosen by compressing a
+ * sample of the region, and the region is stored raw if it does not shrink by at least an eighth.
+ *
+ * \param compress [IN]         pdc_compress_t of the object, PDC_COMPRESS_AUTO to choose the codec
+ * \param level [IN]            Zstandard level, 0 for PDC_COMPRESS_ZSTD_LEVEL
+ * \param mode [IN]             Whether error_bound is absolute or relative to the value range
+ * \param error_bound [IN]      Error bound of PDC_COMPRESS_LOSSY
+ * \param unit [IN]             Size of the elements of the data, 4 for float or 8 for double with
+ *                              PDC_COMPRESS_LOSSY
+ * \param buf [IN]              Data of the region
+ * \param size [IN]             Bytes of data
+ * \param quant_step [IN/OUT]   Quantization step of PDC_COMPRESS_LOSSY, if positive it is used instead of
+ *                              the one from the error bound so data that was quantized before stays the
+ *                              same, and it is set to the step used
+ * \param out [OUT]             Header and compressed data, to be freed by the caller
+ * \param out_size [OUT]        Bytes of header and compressed data
+ *
+ * \return Codec used/PDC_COMPRESS_NONE if the region is to be stored raw, out is not set then
+ */
+pdc_compress_t PDC_Server_compress(pdc_compress_t compress, int level, pdc_error_bound_t mode,
+                                   double error_bound, size_t unit, void *buf, uint64_t size,
+                                   double *quant_step, void **out, uint64_t *out_size);
+
+/**
+ * Decompress the data of a storage region
+ *
+ * \param in [IN]               Header and compressed data, as stored
+ * \param in_size [IN]          Bytes read at in
+ * \param buf [OUT]             Data of the region
+ * \param size [IN]             Bytes of data of the region
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_Server_decompress(void *in, uint64_t in_size, void *buf, uint64_t size);
+
+#endif /* PDC_SERVER_COMPRESS_H */
@@ -56,7 +56,10 @@
 #include "pdc_server_data.h"
 #include "pdc_server_metadata.h"
 #include "pdc_server.h"
+#include "pdc_server_tier.h"
+#include "pdc_server_compress.h"
 #include "pdc_hist_pkg.h"
+#include "pdc_buf_shm.h"
 
 #ifdef ENABLE_RADOS
 // Global Variables for Ceph
@@ -88,6 +91,19 @@ char     pdc_cache_file_path_g[ADDR_MAX];
 
 query_task_t *          query_task_list_head_g      = NULL;
 cache_storage_region_t *cache_storage_region_head_g = NULL;
+query_cache_entry_t *   query_cache_head_g          = NULL;
+int                     query_cache_nentry_g        = 0;
+
+// Shared memory arenas of the clients on this node, mapped while a buf map of the client uses them
+typedef struct pdc_buf_shm_attached_t {
+    char                           name[ADDR_MAX];
+    void *                         base;
+    uint64_t                       size;
+    int                            refcount; // Buf maps that use the arena
+    struct pdc_buf_shm_attached_t *next;
+} pdc_buf_shm_attached_t;
+
+static pdc_buf_shm_attached_t *buf_shm_attached_g = NULL;
 
 perr_t
 PDC_Server_set_lustre_stripe(const char *path, int stripe_count, int stripe_size_MB)
@@ -327,6 +343,10 @@ PDC_Data_Server_region_lock(region_lock_in_t *in, region_lock_out_t *out, hg_han
         new_obj_reg->region_buf_map_head      = NULL;
         new_obj_reg->region_lock_request_head = NULL;
         new_obj_reg->region_storage_head      = NULL;
+        new_obj_reg->compress                 = PDC_COMPRESS_NONE;
+        new_obj_reg->compress_level           = 0;
+        new_obj_reg->error_bound_mode         = PDC_ERROR_BOUND_ABS;
+        new_obj_reg->error_bound              = 0;
         DL_APPEND(dataserver_region_g, new_obj_reg);
     }
 #ifdef ENABLE_MULTITHREAD
@@ -593,6 +613,163 @@ region_list_cmp_by_client_id(region_list_t *a, region_list_t *b)
     return (a->client_ids[0] - b->client_ids[0]);
 }
 
+/*
+ * Unmap the shared memory of the clients that are gone, a client removes its shared memory when it
+ * finalizes. The buf maps it did not unmap stop using the shared memory. Called with the buf map lock held.
+ */
+static void
+PDC_Server_buf_shm_sweep()
+{
+    pdc_buf_shm_attached_t **pp, *arena;
+    data_server_region_t *   obj_reg;
+    region_buf_map_t *       buf_map;
+
+    FUNC_ENTER(NULL);
+
+    pp = &buf_shm_attached_g;
+    while ((arena = *pp) != NULL) {
+        if (PDC_buf_shm_exists(arena->name) == 1) {
+            pp = &arena->next;
+            continue;
+        }
+        DL_FOREACH(dataserver_region_g, obj_reg)
+        {
+            DL_FOREACH(obj_reg->region_buf_map_head, buf_map)
+            {
+                if (buf_map->local_shm_buf != NULL && buf_map->local_shm_arena == arena) {
+                    buf_map->local_shm_buf   = NULL;
+                    buf_map->local_shm_size  = 0;
+                    buf_map->local_shm_arena = NULL;
+                }
+            }
+        }
+        *pp = arena->next;
+        PDC_buf_shm_detach(arena->base, arena->size);
+        free(arena);
+    }
+
+    FUNC_LEAVE_VOID;
+}
+
+/*
+ * Get the server address of a buf map extent in the shared memory of a client, mapping the shared memory
+ * of the client the first time it is used. Each buf map holds a reference to the mapping, which is
+ * released with PDC_Server_buf_shm_put.
+ *
+ * \param  in[IN]               Buf map request of the client
+ * \param  buf_map[IN/OUT]      Buf map of the request, its shared memory fields are set
+ *
+ * \return Address of the data in the extent on success/NULL if the client is not on this node or sent no
+ *         extent
+ */
+static void *
+PDC_Server_buf_shm_get(buf_map_in_t *in, region_buf_map_t *buf_map)
+{
+    void *                  ret_value = NULL;
+    pdc_buf_shm_attached_t *arena;
+    void *                  base;
+    uint64_t                size;
+
+    FUNC_ENTER(NULL);
+
+    buf_map->local_shm_buf   = NULL;
+    buf_map->local_shm_size  = 0;
+    buf_map->local_shm_arena = NULL;
+
+    if (in->shm_addr == NULL || in->shm_addr[0] == 0 || in->shm_size == 0)
+        PGOTO_DONE(NULL);
+
+    // The name of a segment is unique to one run of a client, a new client never finds an old mapping
+    for (arena = buf_shm_attached_g; arena != NULL; arena = arena->next) {
+        if (strcmp(arena->name, in->shm_addr) == 0)
+            break;
+    }
+    if (arena == NULL) {
+        // A client on another node fails here every time, it stops sending its segment once told so
+        base = PDC_buf_shm_attach(in->shm_addr, &size);
+        if (base == NULL)
+            PGOTO_DONE(NULL);
+        if (in->shm_offset >= size || size - in->shm_offset < PDC_BUF_SHM_HDR_SIZE + in->shm_size) {
+            PDC_buf_shm_detach(base, size);
+            PGOTO_DONE(NULL);
+        }
+        PDC_Server_buf_shm_sweep();
+
+        arena = (pdc_buf_shm_attached_t *)calloc(1, sizeof(pdc_buf_shm_attached_t));
+        if (arena == NULL) {
+            PDC_buf_shm_detach(base, size);
+            PGOTO_ERROR(NULL, "==PDC_SERVER[%d]: cannot allocate buf shm arena", pdc_server_rank_g);
+        }
+        snprintf(arena->name, ADDR_MAX, "%s", in->shm_addr);
+        arena->base        = base;
+        arena->size        = size;
+        arena->next        = buf_shm_attached_g;
+        buf_shm_attached_g = arena;
+    }
+
+    // The data follows the header of the extent
+    if (in->shm_offset < arena->size && arena->size - in->shm_offset >= PDC_BUF_SHM_HDR_SIZE + in->shm_size) {
+        ret_value                = (char *)arena->base + in->shm_offset + PDC_BUF_SHM_HDR_SIZE;
+        buf_map->local_shm_buf   = ret_value;
+        buf_map->local_shm_size  = in->shm_size;
+        buf_map->local_shm_arena = arena;
+        arena->refcount++;
+    }
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Release the reference of a buf map to the shared memory of a client, the shared memory is unmapped
+ * once no buf map of the client uses it. Called with the buf map lock held.
+ *
+ * \param  buf_map[IN]          Buf map being unmapped
+ */
+static void
+PDC_Server_buf_shm_put(region_buf_map_t *buf_map)
+{
+    pdc_buf_shm_attached_t **pp, *arena = (pdc_buf_shm_attached_t *)buf_map->local_shm_arena;
+
+    FUNC_ENTER(NULL);
+
+    buf_map->local_shm_buf   = NULL;
+    buf_map->local_shm_size  = 0;
+    buf_map->local_shm_arena = NULL;
+    if (arena == NULL || --arena->refcount > 0)
+        PGOTO_DONE_VOID;
+
+    for (pp = &buf_shm_attached_g; *pp != NULL; pp = &(*pp)->next) {
+        if (*pp == arena) {
+            *pp = arena->next;
+            break;
+        }
+    }
+    PDC_buf_shm_detach(arena->base, arena->size);
+    free(arena);
+
+done:
+    FUNC_LEAVE_VOID;
+}
+
+perr_t
+PDC_Server_buf_shm_finalize()
+{
+    perr_t                  ret_value = SUCCEED;
+    pdc_buf_shm_attached_t *arena, *next;
+
+    FUNC_ENTER(NULL);
+
+    for (arena = buf_shm_attached_g; arena != NULL; arena = next) {
+        next = arena->next;
+        PDC_buf_shm_detach(arena->base, arena->size);
+        free(arena);
+    }
+    buf_shm_attached_g = NULL;
+
+    FUNC_LEAVE(ret_value);
+}
+
 perr_t
 PDC_Data_Server_buf_unmap(const struct hg_info *info, buf_unmap_in_t *in)
 {
@@ -640,6 +817,7 @@ PDC_Data_Server_buf_unmap(const struct hg_info *info, buf_unmap_in_t *in)
                 }
                 HG_Addr_free(info->hg_class, elt->local_addr);
                 HG_Bulk_free(elt->local_bulk_handle);
+                PDC_Server_buf_shm_put(elt);
 #ifdef ENABLE_MULTITHREAD
                 hg_thread_mutex_destroy(&(elt->bulk_args->work_mutex));
                 hg_thread_cond_destroy(&(elt->bulk_args->work_cond));
@@ -728,6 +906,7 @@ PDC_Data_Server_check_unmap()
                     }
                     HG_Addr_free(elt1->info->hg_class, elt->local_addr);
                     HG_Bulk_free(elt->local_bulk_handle);
+                    PDC_Server_buf_shm_put(elt);
                     hg_thread_mutex_destroy(&(elt->bulk_args->work_mutex));
                     hg_thread_cond_destroy(&(elt->bulk_args->work_cond));
                     free(elt->bulk_args);
@@ -1057,6 +1236,10 @@ PDC_Data_Server_buf_map(const struct hg_info *info, buf_map_in_t *in, region_lis
         new_obj_reg->region_buf_map_head      = NULL;
         new_obj_reg->region_lock_request_head = NULL;
         new_obj_reg->region_storage_head      = NULL;
+        new_obj_reg->compress                 = PDC_COMPRESS_NONE;
+        new_obj_reg->compress_level           = 0;
+        new_obj_reg->error_bound_mode         = PDC_ERROR_BOUND_ABS;
+        new_obj_reg->error_bound              = 0;
 
         new_obj_reg->fd = server_open_storage(storage_location, in->remote_obj_id);
         // Generate a location for data storage for data server to write
@@ -1093,6 +1276,14 @@ PDC_Data_Server_buf_map(const struct hg_info *info, buf_map_in_t *in, region_lis
         new_obj_reg->storage_location = strdup(storage_location);
         DL_APPEND(dataserver_region_g, new_obj_reg);
     }
+    // The regions written through this map are compressed as the object asks, only floating point data
+    // is compressed lossily
+    new_obj_reg->compress         = in->compress;
+    new_obj_reg->compress_level   = in->compress_level;
+    new_obj_reg->error_bound_mode = in->error_bound_mode;
+    new_obj_reg->error_bound      = in->error_bound;
+    if (in->compress == PDC_COMPRESS_LOSSY && in->remote_type != PDC_FLOAT && in->remote_type != PDC_DOUBLE)
+        new_obj_reg->compress = PDC_COMPRESS_AUTO;
 #ifdef ENABLE_MULTITHREAD
     hg_thread_mutex_unlock(&region_struct_mutex_g);
 #endif
@@ -1152,6 +1343,7 @@ PDC_Data_Server_buf_map(const struct hg_info *info, buf_map_in_t *in, region_lis
         HG_Addr_dup(info->hg_class, info->addr, &(buf_map_ptr->local_addr));
         HG_Bulk_ref_incr(in->local_bulk_handle);
         buf_map_ptr->local_bulk_handle = in->local_bulk_handle;
+        PDC_Server_buf_shm_get(in, buf_map_ptr);
 
         buf_map_ptr->remote_obj_id        = in->remote_obj_id;
         buf_map_ptr->remote_ndim          = in->ndim;
@@ -1263,6 +1455,9 @@ PDC_Server_maybe_allocate_region_buf_ptr(pdcid_t obj_id, region_info_transfer_t
         buf_map_ptr->remote_obj_id        = obj_id;
         buf_map_ptr->remote_ndim          = region.ndim;
         buf_map_ptr->remote_data_ptr      = ret_value;
+        buf_map_ptr->local_shm_buf        = NULL;
+        buf_map_ptr->local_shm_size       = 0;
+        buf_map_ptr->local_shm_arena      = NULL;
         buf_map_ptr->remote_region_unit   = region;
         buf_map_ptr->remote_region_nounit = region;
         buf_map_ptr->remote_region_nounit.count_0 /= type_size;
@@ -2251,6 +2446,7 @@ PDC_Server_read_check(data_server_read_check_in_t *in, server_read_check_out_t *
     }
 
 done:
+    PDC_metadata_release_strs(&meta);
     fflush(stdout);
     FUNC_LEAVE(ret_value);
 }
@@ -2322,6 +2518,7 @@ PDC_Server_write_check(data_server_write_check_in_t *in, data_server_write_check
     }
 
 done:
+    PDC_metadata_release_strs(&meta);
     fflush(stdout);
     FUNC_LEAVE(ret_value);
 }
@@ -3145,6 +3342,8 @@ PDC_Server_data_io_via_shm(const struct hg_cb_info *callback_info)
 #endif
 
 done:
+    // The queued regions only use the IDs and dims of the metadata of the request, not its strings
+    PDC_metadata_release_strs(&io_info->meta);
     fflush(stdout);
     FUNC_LEAVE(ret_value);
 }
@@ -3185,9 +3384,16 @@ PDC_Server_update_local_region_storage_loc(region_list_t *region, uint64_t obj_i
             }
             else if (type == PDC_UPDATE_STORAGE) {
                 memcpy(region_elt->storage_location, region->storage_location, sizeof(char) * ADDR_MAX);
-                region_elt->offset = region->offset;
+                region_elt->offset       = region->offset;
+                region_elt->compress     = region->compress;
+                region_elt->storage_size = region->storage_size;
                 if (region->region_hist != NULL)
                     region_elt->region_hist = region->region_hist;
+                // The metadata keeps its own copy of the sketch and frees the one it replaces
+                if (region->region_sketch != NULL && region->region_sketch != region_elt->region_sketch) {
+                    PDC_sketch_free(region_elt->region_sketch);
+                    region_elt->region_sketch = PDC_sketch_copy(region->region_sketch);
+                }
             }
             else {
                 printf("==PDC_SERVER[%d]: %s - error with update type %d!\n", pdc_server_rank_g, __func__,
@@ -3215,19 +3421,83 @@ PDC_Server_update_local_region_storage_loc(region_list_t *region, uint64_t obj_i
             goto done;
         }
 
-        new_region->meta        = target_meta;
-        new_region->region_hist = region->region_hist;
+        new_region->meta          = target_meta;
+        new_region->region_hist   = region->region_hist;
+        new_region->region_sketch =
+            region->region_sketch == NULL ? NULL : PDC_sketch_copy(region->region_sketch);
         if (new_region->data_size == 0)
             new_region->data_size = PDC_get_region_size(new_region);
         DL_APPEND(target_meta->storage_region_list_head, new_region);
     }
 
+    PDC_Server_metadata_log_region(obj_id, region, type);
+
+    // Queries on this server see the new storage regions from now on, results cached before are stale
+    if (type == PDC_UPDATE_STORAGE)
+        PDC_Server_query_cache_invalidate(obj_id);
+
 done:
     fflush(stdout);
 
     FUNC_LEAVE(ret_value);
 }
 
+perr_t
+PDC_Server_get_obj_stats(obj_get_stats_in_t *in, obj_get_stats_out_t *out)
+{
+    perr_t          ret_value = SUCCEED;
+    pdc_metadata_t *meta;
+    region_list_t * region_elt;
+    pdc_sketch_t *  stats = NULL;
+
+    FUNC_ENTER(NULL);
+
+    out->ret         = -1;
+    out->sketch_size = 0;
+    out->sketch      = NULL;
+
+    meta = find_metadata_by_id(in->obj_id);
+    if (meta == NULL) {
+        printf("==PDC_SERVER[%d]: %s - cannot find metadata of object %" PRIu64 "\n", pdc_server_rank_g,
+               __func__, in->obj_id);
+        ret_value = FAIL;
+        goto done;
+    }
+
+    DL_FOREACH(meta->storage_region_list_head, region_elt)
+    {
+        if (region_elt->region_sketch == NULL)
+            continue;
+        if (stats == NULL && (stats = PDC_sketch_create(region_elt->region_sketch->dtype)) == NULL) {
+            ret_value = FAIL;
+            goto done;
+        }
+        if (PDC_sketch_merge(stats, region_elt->region_sketch) != SUCCEED) {
+            ret_value = FAIL;
+            goto done;
+        }
+    }
+
+    // An object without sketches has no statistics, that is not an error
+    if (stats != NULL) {
+        out->sketch_size = PDC_sketch_serialize_size(stats);
+        out->sketch      = malloc(out->sketch_size);
+        if (out->sketch == NULL || PDC_sketch_serialize(stats, out->sketch) != SUCCEED) {
+            free(out->sketch);
+            out->sketch      = NULL;
+            out->sketch_size = 0;
+            ret_value        = FAIL;
+            goto done;
+        }
+    }
+    out->ret = 1;
+
+done:
+    PDC_sketch_free(stats);
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
+
 /*
  * Callback function for the region location info update
  *
@@ -3268,13 +3538,7 @@ done:
 perr_t
 PDC_Server_update_region_storagelocation_offset(region_list_t *region, int type)
 {
-    hg_return_t            hg_ret;
-    perr_t                 ret_value   = SUCCEED;
-    uint32_t               server_id   = 0;
-    pdc_metadata_t *       region_meta = NULL;
-    hg_handle_t            update_region_loc_handle;
-    update_region_loc_in_t in;
-    server_lookup_args_t   lookup_args;
+    perr_t ret_value = SUCCEED;
 
     FUNC_ENTER(NULL);
 
@@ -3284,24 +3548,41 @@ PDC_Server_update_region_storagelocation_offset(region_list_t *region, int type)
         goto done;
     }
 
-    if (region->storage_location[0] == 0) {
-        printf("==PDC_SERVER[%d]: %s - NULL input!\n", pdc_server_rank_g, __func__);
+    if (region->meta == NULL) {
+        printf("==PDC_SERVER[%d]: %s - region meta is NULL!\n", pdc_server_rank_g, __func__);
         ret_value = FAIL;
         goto done;
     }
 
-    region_meta = region->meta;
-    if (region_meta == NULL) {
-        printf("==PDC_SERVER[%d]: %s - region meta is NULL!\n", pdc_server_rank_g, __func__);
+    ret_value = PDC_Server_update_obj_region_storage_loc(region, region->meta->obj_id, type);
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDC_Server_update_obj_region_storage_loc(region_list_t *region, uint64_t obj_id, int type)
+{
+    hg_return_t            hg_ret;
+    perr_t                 ret_value = SUCCEED;
+    uint32_t               server_id = 0;
+    hg_handle_t            update_region_loc_handle;
+    update_region_loc_in_t in;
+    server_lookup_args_t   lookup_args;
+
+    FUNC_ENTER(NULL);
+
+    if (region == NULL || region->storage_location[0] == 0) {
+        printf("==PDC_SERVER[%d]: %s - NULL input!\n", pdc_server_rank_g, __func__);
         ret_value = FAIL;
         goto done;
     }
 
-    server_id = PDC_get_server_by_obj_id(region_meta->obj_id, pdc_server_size_g);
+    server_id = PDC_get_server_by_obj_id(obj_id, pdc_server_size_g);
 
     if (server_id == (uint32_t)pdc_server_rank_g) {
         // Metadata object is local, no need to send update RPC
-        ret_value = PDC_Server_update_local_region_storage_loc(region, region_meta->obj_id, type);
+        ret_value = PDC_Server_update_local_region_storage_loc(region, obj_id, type);
         update_local_region_count_g++;
         if (ret_value != SUCCEED) {
             printf("==PDC_SERVER[%d]: %s - update_local_region_storage FAILED!\n", pdc_server_rank_g,
@@ -3332,8 +3613,10 @@ PDC_Server_update_region_storagelocation_offset(region_list_t *region, int type)
             fflush(stdout);
         }
 
-        in.obj_id           = region->meta->obj_id;
+        in.obj_id           = obj_id;
         in.offset           = region->offset;
+        in.compress         = region->compress;
+        in.storage_size     = region->storage_size;
         in.storage_location = region->storage_location;
         in.type             = type;
         in.has_hist         = 0;
@@ -3350,8 +3633,17 @@ PDC_Server_update_region_storagelocation_offset(region_list_t *region, int type)
                    __func__, server_id);
         }
 
+        in.sketch_size = 0;
+        in.sketch      = NULL;
+        if (region->region_sketch != NULL) {
+            in.sketch = malloc(PDC_sketch_serialize_size(region->region_sketch));
+            if (in.sketch != NULL && PDC_sketch_serialize(region->region_sketch, in.sketch) == SUCCEED)
+                in.sketch_size = PDC_sketch_serialize_size(region->region_sketch);
+        }
+
         lookup_args.rpc_handle = update_region_loc_handle;
         hg_ret = HG_Forward(update_region_loc_handle, PDC_Server_update_region_loc_cb, &lookup_args, &in);
+        free(in.sketch);
         if (hg_ret != HG_SUCCESS) {
             printf("==PDC_SERVER[%d]: %s - HG_Forward() to server %d FAILED\n", pdc_server_rank_g, __func__,
                    server_id);
@@ -3469,7 +3761,7 @@ PDC_Server_update_region_storage_meta_bulk_local(update_region_storage_meta_bulk
     region_list_t *                    region_elt = NULL, *new_region = NULL;
     update_region_storage_meta_bulk_t *bulk_ptr;
     int                                update_success = 0, express_insert = 0;
-    uint64_t                           obj_id;
+    uint64_t                           obj_id         = 0;
 
     FUNC_ENTER(NULL);
 
@@ -3503,6 +3795,7 @@ PDC_Server_update_region_storage_meta_bulk_local(update_region_storage_meta_bulk
 
         new_region->meta   = target_meta;
         new_region->obj_id = target_meta->obj_id;
+        PDC_Server_metadata_log_region(obj_id, new_region, PDC_UPDATE_STORAGE);
 
         // Check if we can insert without duplicate check
         if (i == 1 && target_meta->storage_region_list_head == NULL)
@@ -3533,6 +3826,9 @@ PDC_Server_update_region_storage_meta_bulk_local(update_region_storage_meta_bulk
     }
 
 done:
+    // Queries on this server see the new storage regions from now on, results cached before are stale
+    if (obj_id != 0)
+        PDC_Server_query_cache_invalidate(obj_id);
     FUNC_LEAVE(ret_value);
 }
 
@@ -4399,6 +4695,14 @@ PDC_Server_posix_one_file_io(region_list_t *region_list_head)
                 region_elt->region_hist = PDC_gen_hist(region_elt->meta->data_type, nelem, region_elt->buf);
             }
 
+            // Summarize the values for the statistics of the object and the query planner
+            if (gen_sketch_g == 1) {
+                uint64_t nelem = region_elt->data_size / PDC_get_var_type_size(region_elt->meta->data_type);
+                PDC_sketch_free(region_elt->region_sketch);
+                region_elt->region_sketch =
+                    PDC_gen_sketch(region_elt->meta->data_type, nelem, region_elt->buf);
+            }
+
             if (is_debug_g == 1) {
                 printf("Write data offset: %" PRIu64 ", size %" PRIu64 ", to [%s]\n", offset,
                        region_elt->data_size, region_elt->storage_location);
@@ -4544,6 +4848,147 @@ PDC_Server_posix_write(int fd, void *buf, uint64_t write_size)
 done:
     FUNC_LEAVE(ret_value);
 }
+
+/*
+ * Write a new storage region of an object. The region is compressed if the object asks for it and its
+ * data compresses well, otherwise it is written through the tier manager or appended to the object file.
+ *
+ * \param  obj[IN]          Data server object
+ * \param  region[IN/OUT]   Storage region with data_size and unit_size set, its offset and compression
+ *                          are set
+ * \param  buf[IN]          Data of the region
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_region_append(data_server_region_t *obj, region_list_t *region, void *buf)
+{
+    perr_t   ret_value = SUCCEED;
+    void *   cbuf      = NULL;
+    uint64_t csize     = 0;
+
+    FUNC_ENTER(NULL);
+
+    region->compress   = PDC_COMPRESS_NONE;
+    region->quant_step = 0;
+    if (obj->compress != PDC_COMPRESS_NONE)
+        region->compress = PDC_Server_compress(
+            (pdc_compress_t)obj->compress, obj->compress_level, (pdc_error_bound_t)obj->error_bound_mode,
+            obj->error_bound, region->unit_size, buf, region->data_size, &region->quant_step, &cbuf, &csize);
+
+    if (region->compress != PDC_COMPRESS_NONE) {
+        region->storage_size = csize;
+        region->offset       = PDC_Server_tier_alloc(obj, csize);
+        if (pwrite(obj->fd, cbuf, csize, region->offset) != (ssize_t)csize) {
+            printf("==PDC_SERVER[%d]: Failed to write enough bytes\n", pdc_server_rank_g);
+            ret_value = FAIL;
+        }
+        free(cbuf);
+    }
+    else if (PDC_Server_tier_enabled())
+        ret_value = PDC_Server_tier_write(obj, region, buf);
+    else {
+        region->offset = lseek(obj->fd, 0, SEEK_END);
+        ret_value      = PDC_Server_posix_write(obj->fd, buf, region->data_size);
+    }
+
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Read all the data of a storage region, decompressing it if the region is compressed
+ *
+ * \param  fd[IN]           File of the region, from PDC_Server_tier_fd
+ * \param  region[IN]       Storage region
+ * \param  buf[OUT]         Buffer of data_size bytes
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_region_read_all(int fd, region_list_t *region, void *buf)
+{
+    perr_t ret_value = SUCCEED;
+    void * cbuf      = NULL;
+
+    FUNC_ENTER(NULL);
+
+    if (region->compress == PDC_COMPRESS_NONE) {
+        if (pread(fd, buf, region->data_size, region->offset) != (ssize_t)region->data_size) {
+            printf("==PDC_SERVER[%d]: pread failed to read enough bytes\n", pdc_server_rank_g);
+            ret_value = FAIL;
+        }
+        goto done;
+    }
+
+    cbuf = malloc(region->storage_size);
+    if (cbuf == NULL ||
+        pread(fd, cbuf, region->storage_size, region->offset) != (ssize_t)region->storage_size) {
+        printf("==PDC_SERVER[%d]: pread failed to read enough bytes\n", pdc_server_rank_g);
+        ret_value = FAIL;
+        goto done;
+    }
+    ret_value = PDC_Server_decompress(cbuf, region->storage_size, buf, region->data_size);
+
+done:
+    free(cbuf);
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Write all the data of a storage region in place. A compressed region is compressed again, and moved to
+ * the end of the object file if it no longer fits in its storage space.
+ *
+ * \param  obj[IN]          Data server object
+ * \param  fd[IN]           File of the region, from PDC_Server_tier_fd
+ * \param  region[IN/OUT]   Storage region
+ * \param  buf[IN]          Buffer of data_size bytes
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_region_write_all(data_server_region_t *obj, int fd, region_list_t *region, void *buf)
+{
+    perr_t         ret_value = SUCCEED;
+    pdc_compress_t codec;
+    void *         cbuf  = NULL;
+    uint64_t       csize = 0;
+
+    FUNC_ENTER(NULL);
+
+    if (region->compress == PDC_COMPRESS_NONE) {
+        if (pwrite(fd, buf, region->data_size, region->offset) != (ssize_t)region->data_size) {
+            printf("==PDC_SERVER[%d]: Failed to write enough bytes\n", pdc_server_rank_g);
+            ret_value = FAIL;
+        }
+        goto done;
+    }
+
+    // Keep the codec of the region if the object no longer asks for one
+    codec = (pdc_compress_t)(obj->compress != PDC_COMPRESS_NONE ? obj->compress : region->compress);
+    codec = PDC_Server_compress(codec, obj->compress_level, (pdc_error_bound_t)obj->error_bound_mode,
+                                obj->error_bound, region->unit_size, buf, region->data_size,
+                                &region->quant_step, &cbuf, &csize);
+    if (codec == PDC_COMPRESS_NONE) {
+        csize = region->data_size;
+        cbuf  = NULL;
+    }
+    if (csize > region->storage_size) {
+        // The old space of the region is left unused
+        region->offset       = PDC_Server_tier_alloc(obj, csize);
+        region->storage_size = csize;
+        fd                   = obj->fd;
+    }
+    if (pwrite(fd, cbuf == NULL ? buf : cbuf, csize, region->offset) != (ssize_t)csize) {
+        printf("==PDC_SERVER[%d]: Failed to write enough bytes\n", pdc_server_rank_g);
+        ret_value = FAIL;
+    }
+    region->compress = codec;
+
+done:
+    free(cbuf);
+    FUNC_LEAVE(ret_value);
+}
+
 #ifdef PDC_SERVER_CACHE
 
 /*
@@ -4952,7 +5397,9 @@ PDC_Server_data_write_out2(uint64_t obj_id, struct pdc_region_info *region_info,
     perr_t                ret_value      = SUCCEED;
     data_server_region_t *region         = NULL;
     region_list_t *       overlap_region = NULL;
+    region_list_t *       pinned_region  = NULL;
     int                   is_overlap     = 0;
+    int                   fd;
     uint64_t              i, j, pos, overlap_start[DIM_MAX] = {0}, overlap_count[DIM_MAX] = {0},
                         overlap_start_local[DIM_MAX] = {0};
 
@@ -4999,6 +5446,8 @@ PDC_Server_data_write_out2(uint64_t obj_id, struct pdc_region_info *region_info,
         if (PDC_is_contiguous_region_overlap(elt, request_region) == 1) {
             is_overlap++;
             overlap_region = elt;
+            fd             = PDC_Server_tier_fd(region, overlap_region);
+            pinned_region  = overlap_region;
 
             // Get the actual start and count of region in storage
             if (PDC_get_overlap_start_count(region_info->ndim, request_region->start, request_region->count,
@@ -5023,8 +5472,20 @@ PDC_Server_data_write_out2(uint64_t obj_id, struct pdc_region_info *region_info,
                     goto done;
                 }
 
-                lseek(region->fd, overlap_region->offset + overlap_start_local[0] * unit, SEEK_SET);
-                ret_value = PDC_Server_posix_write(region->fd, buf + pos, write_size);
+                if (overlap_region->compress != PDC_COMPRESS_NONE) {
+                    // A compressed region is compressed again as a whole
+                    void *tmp_buf = malloc(overlap_region->data_size);
+                    ret_value     = PDC_Server_region_read_all(fd, overlap_region, tmp_buf);
+                    if (ret_value == SUCCEED) {
+                        memcpy(tmp_buf + overlap_start_local[0] * unit, buf + pos, overlap_count[0] * unit);
+                        ret_value = PDC_Server_region_write_all(region, fd, overlap_region, tmp_buf);
+                    }
+                    free(tmp_buf);
+                }
+                else {
+                    lseek(fd, overlap_region->offset + overlap_start_local[0] * unit, SEEK_SET);
+                    ret_value = PDC_Server_posix_write(fd, buf + pos, write_size);
+                }
                 if (ret_value != SUCCEED) {
                     printf("==PDC_SERVER[%d]: PDC_Server_posix_write FAILED!\n", pdc_server_rank_g);
                     ret_value = FAIL;
@@ -5037,9 +5498,10 @@ PDC_Server_data_write_out2(uint64_t obj_id, struct pdc_region_info *region_info,
                 // and write back to avoid fragmented writes.
                 void *tmp_buf = malloc(overlap_region->data_size);
 
-                if (pread(region->fd, tmp_buf, overlap_region->data_size, overlap_region->offset) !=
-                    (ssize_t)overlap_region->data_size) {
-                    printf("==PDC_SERVER[%d]: pread failed to read enough bytes\n", pdc_server_rank_g);
+                if (PDC_Server_region_read_all(fd, overlap_region, tmp_buf) != SUCCEED) {
+                    free(tmp_buf);
+                    ret_value = FAIL;
+                    goto done;
                 }
 
                 // Overlap start position
@@ -5064,19 +5526,18 @@ PDC_Server_data_write_out2(uint64_t obj_id, struct pdc_region_info *region_info,
                         goto done;
                     }
                 }
-                if (pwrite(region->fd, tmp_buf, overlap_region->data_size, overlap_region->offset) !=
-                    (ssize_t)overlap_region->data_size) {
-                    printf("==PDC_SERVER[%d]: Failed to write enough bytes\n", pdc_server_rank_g);
-                }
+                if (PDC_Server_region_write_all(region, fd, overlap_region, tmp_buf) != SUCCEED)
+                    ret_value = FAIL;
                 free(tmp_buf);
                 // No need to update metadata
             } // End 2D
             else if (region_info->ndim == 3) {
                 void *tmp_buf = malloc(overlap_region->data_size);
                 // Read entire region
-                if (pread(region->fd, tmp_buf, overlap_region->data_size, overlap_region->offset) !=
-                    (ssize_t)overlap_region->data_size) {
-                    printf("==PDC_SERVER[%d]: pread failed to read enough bytes\n", pdc_server_rank_g);
+                if (PDC_Server_region_read_all(fd, overlap_region, tmp_buf) != SUCCEED) {
+                    free(tmp_buf);
+                    ret_value = FAIL;
+                    goto done;
                 }
 
                 pos = ((overlap_start[0] - region_info->offset[0]) * overlap_region->count[1] *
@@ -5111,21 +5572,20 @@ PDC_Server_data_write_out2(uint64_t obj_id, struct pdc_region_info *region_info,
                         }
                     }
                 }
-                if (pwrite(region->fd, tmp_buf, overlap_region->data_size, overlap_region->offset) !=
-                    (ssize_t)overlap_region->data_size) {
-                    printf("==PDC_SERVER[%d]: Failed to write enough bytes\n", pdc_server_rank_g);
-                }
+                if (PDC_Server_region_write_all(region, fd, overlap_region, tmp_buf) != SUCCEED)
+                    ret_value = FAIL;
                 free(tmp_buf);
                 // No need to update metadata
             } // End 3D
+            PDC_Server_tier_access(region, overlap_region, PDC_WRITE);
+            pinned_region = NULL;
         }     // End is overlap
 
     } // End DL_FOREACH storage region list
 
     if (is_overlap == 0) {
-        request_region->offset = lseek(region->fd, 0, SEEK_END);
-
-        ret_value = PDC_Server_posix_write(region->fd, buf, write_size);
+        request_region->data_size = write_size;
+        ret_value                 = PDC_Server_region_append(region, request_region, buf);
         if (ret_value != SUCCEED) {
             printf("==PDC_SERVER[%d]: PDC_Server_posix_write FAILED!\n", pdc_server_rank_g);
             ret_value = FAIL;
@@ -5133,7 +5593,6 @@ PDC_Server_data_write_out2(uint64_t obj_id, struct pdc_region_info *region_info,
         }
 
         // Store storage information
-        request_region->data_size = write_size;
         DL_APPEND(region->region_storage_head, request_region);
     }
     else
@@ -5149,6 +5608,8 @@ PDC_Server_data_write_out2(uint64_t obj_id, struct pdc_region_info *region_info,
 
     /* printf("==PDC_SERVER[%d]: write region %llu bytes\n", pdc_server_rank_g, request_region->data_size); */
 done:
+    if (pinned_region != NULL)
+        PDC_Server_tier_unpin(region, pinned_region);
     fflush(stdout);
     FUNC_LEAVE(ret_value);
 }
@@ -5209,6 +5670,9 @@ PDC_Server_data_write_out(uint64_t obj_id, struct pdc_region_info *region_info,
     }
     // PDC_Server_data_write_out2(obj_id, region_info, buf, unit);
 
+    // The new data is visible to reads now, cached query results on the object are stale
+    PDC_Server_query_cache_invalidate_all(obj_id);
+
     // done:
     fflush(stdout);
     FUNC_LEAVE(ret_value);
@@ -5221,6 +5685,8 @@ PDC_Server_data_read_from2(uint64_t obj_id, struct pdc_region_info *region_info,
     ssize_t /*read_bytes = 0, */ total_read_bytes = 0, request_bytes = unit, my_read_bytes = 0;
     data_server_region_t *       region = NULL;
     region_list_t *              elt;
+    region_list_t *              pinned_region = NULL;
+    int                          fd;
     // int flag = 0;
     uint64_t i, j, pos, overlap_start[DIM_MAX] = {0}, overlap_count[DIM_MAX] = {0},
                         overlap_start_local[DIM_MAX] = {0};
@@ -5260,6 +5726,8 @@ PDC_Server_data_read_from2(uint64_t obj_id, struct pdc_region_info *region_info,
 
         if (PDC_is_contiguous_region_overlap(elt, &request_region) == 1) {
             storage_region = elt;
+            fd             = PDC_Server_tier_fd(region, storage_region);
+            pinned_region  = storage_region;
             // flag = 1;
 
             // Get the actual start and count of region in storage
@@ -5285,9 +5753,20 @@ PDC_Server_data_read_from2(uint64_t obj_id, struct pdc_region_info *region_info,
                 }
                 // read_bytes = pread(region->fd, buf + pos, overlap_count[0] * unit,
                 //                   storage_region->offset + overlap_start_local[0] * unit);
-                if (pread(region->fd, buf + pos, overlap_count[0] * unit,
-                          storage_region->offset + overlap_start_local[0] * unit) !=
-                    (ssize_t)(overlap_count[0] * unit)) {
+                if (storage_region->compress != PDC_COMPRESS_NONE) {
+                    // A compressed region is decompressed as a whole
+                    void *tmp_buf = malloc(storage_region->data_size);
+                    if (PDC_Server_region_read_all(fd, storage_region, tmp_buf) != SUCCEED) {
+                        free(tmp_buf);
+                        ret_value = FAIL;
+                        goto done;
+                    }
+                    memcpy(buf + pos, tmp_buf + overlap_start_local[0] * unit, overlap_count[0] * unit);
+                    free(tmp_buf);
+                }
+                else if (pread(fd, buf + pos, overlap_count[0] * unit,
+                               storage_region->offset + overlap_start_local[0] * unit) !=
+                         (ssize_t)(overlap_count[0] * unit)) {
                     printf("==PDC_SERVER[%d]: pread failed to read enough bytes\n", pdc_server_rank_g);
                 }
                 my_read_bytes = overlap_count[0] * unit;
@@ -5299,9 +5778,10 @@ PDC_Server_data_read_from2(uint64_t obj_id, struct pdc_region_info *region_info,
                 void *tmp_buf = malloc(storage_region->data_size);
                 // Read entire region
                 // read_bytes = pread(region->fd, tmp_buf, storage_region->data_size, storage_region->offset);
-                if (pread(region->fd, tmp_buf, storage_region->data_size, storage_region->offset) !=
-                    (ssize_t)storage_region->data_size) {
-                    printf("==PDC_SERVER[%d]: pread failed to read enough bytes\n", pdc_server_rank_g);
+                if (PDC_Server_region_read_all(fd, storage_region, tmp_buf) != SUCCEED) {
+                    free(tmp_buf);
+                    ret_value = FAIL;
+                    goto done;
                 }
                 // Extract requested data
                 pos = ((overlap_start[0] - region_info->offset[0]) * storage_region->count[1] +
@@ -5333,9 +5813,10 @@ PDC_Server_data_read_from2(uint64_t obj_id, struct pdc_region_info *region_info,
                 void *tmp_buf = malloc(storage_region->data_size);
                 // Read entire region
                 // read_bytes = pread(region->fd, tmp_buf, storage_region->data_size, storage_region->offset);
-                if (pread(region->fd, tmp_buf, storage_region->data_size, storage_region->offset) !=
-                    (ssize_t)storage_region->data_size) {
-                    printf("==PDC_SERVER[%d]: pread failed to read enough bytes\n", pdc_server_rank_g);
+                if (PDC_Server_region_read_all(fd, storage_region, tmp_buf) != SUCCEED) {
+                    free(tmp_buf);
+                    ret_value = FAIL;
+                    goto done;
                 }
                 // Extract requested data
                 pos = ((overlap_start[0] - region_info->offset[0]) * storage_region->count[1] *
@@ -5387,6 +5868,8 @@ PDC_Server_data_read_from2(uint64_t obj_id, struct pdc_region_info *region_info,
                         }
             */
             total_read_bytes += my_read_bytes;
+            PDC_Server_tier_access(region, storage_region, PDC_READ);
+            pinned_region = NULL;
 
         } // End is overlap
 
@@ -5408,6 +5891,8 @@ PDC_Server_data_read_from2(uint64_t obj_id, struct pdc_region_info *region_info,
 #endif
 
 done:
+    if (pinned_region != NULL)
+        PDC_Server_tier_unpin(region, pinned_region);
     fflush(stdout);
     FUNC_LEAVE(ret_value);
 }
@@ -5711,11 +6196,14 @@ PDC_Server_data_write_out(uint64_t obj_id, struct pdc_region_info *region_info,
     perr_t ret_value = SUCCEED;
     data_server_region_t *region = NULL;
     region_list_t *overlap_region = NULL;
+    region_list_t *pinned_region = NULL;
     int is_overlap = 0;
+    int fd;
     uint64_t i, j, pos, overlap_start[DIM_MAX] = {0}, overlap_count[DIM_MAX] = {0},
                         overlap_start_local[DIM_MAX] = {0};
 
     FUNC_ENTER(NULL);
+
     uint64_t write_size;
     if (region_info->ndim >= 1)
         write_size = unit * region_info->size[0];
@@ -5757,6 +6245,8 @@ PDC_Server_data_write_out(uint64_t obj_id, struct pdc_region_info *region_info,
         if (PDC_is_contiguous_region_overlap(elt, request_region) == 1) {
             is_overlap++;
             overlap_region = elt;
+            fd             = PDC_Server_tier_fd(region, overlap_region);
+            pinned_region  = overlap_region;
 
             // Get the actual start and count of region in storage
             if (PDC_get_overlap_start_count(region_info->ndim, request_region->start, request_region->count,
@@ -5810,10 +6300,20 @@ PDC_Server_data_write_out(uint64_t obj_id, struct pdc_region_info *region_info,
 
 #else
                 // Posix calls here
-
-                lseek(region->fd, overlap_region->offset + overlap_start_local[0] * unit, SEEK_SET);
-
-                ret_value = PDC_Server_posix_write(region->fd, buf + pos, write_size);
+                if (overlap_region->compress != PDC_COMPRESS_NONE) {
+                    // A compressed region is compressed again as a whole
+                    void *tmp_buf = malloc(overlap_region->data_size);
+                    ret_value     = PDC_Server_region_read_all(fd, overlap_region, tmp_buf);
+                    if (ret_value == SUCCEED) {
+                        memcpy(tmp_buf + overlap_start_local[0] * unit, buf + pos, overlap_count[0] * unit);
+                        ret_value = PDC_Server_region_write_all(region, fd, overlap_region, tmp_buf);
+                    }
+                    free(tmp_buf);
+                }
+                else {
+                    lseek(fd, overlap_region->offset + overlap_start_local[0] * unit, SEEK_SET);
+                    ret_value = PDC_Server_posix_write(fd, buf + pos, write_size);
+                }
                 if (ret_value != SUCCEED) {
                     printf("==PDC_SERVER[%d]: PDC_Server_posix_write FAILED!\n", pdc_server_rank_g);
                     ret_value = FAIL;
@@ -5838,9 +6338,10 @@ PDC_Server_data_write_out(uint64_t obj_id, struct pdc_region_info *region_info,
                 }
 #else
                 // Posix Call here
-                if (pread(region->fd, tmp_buf, overlap_region->data_size, overlap_region->offset) !=
-                    (ssize_t)overlap_region->data_size) {
-                    printf("==PDC_SERVER[%d]: pread failed to read enough bytes\n", pdc_server_rank_g);
+                if (PDC_Server_region_read_all(fd, overlap_region, tmp_buf) != SUCCEED) {
+                    free(tmp_buf);
+                    ret_value = FAIL;
+                    goto done;
                 }
 #endif
 
@@ -5878,10 +6379,8 @@ PDC_Server_data_write_out(uint64_t obj_id, struct pdc_region_info *region_info,
                 }
 #else
                 // Posix calls here
-                if (pwrite(region->fd, tmp_buf, overlap_region->data_size, overlap_region->offset) !=
-                    (ssize_t)overlap_region->data_size) {
-                    printf("==PDC_SERVER[%d]: Failed to write enough bytes\n", pdc_server_rank_g);
-                }
+                if (PDC_Server_region_write_all(region, fd, overlap_region, tmp_buf) != SUCCEED)
+                    ret_value = FAIL;
 #endif
 
                 free(tmp_buf);
@@ -5889,11 +6388,6 @@ PDC_Server_data_write_out(uint64_t obj_id, struct pdc_region_info *region_info,
             } // End 2D
             else if (region_info->ndim == 3) {
                 void *tmp_buf = malloc(overlap_region->data_size);
-                // Read entire region
-                if (pread(region->fd, tmp_buf, overlap_region->data_size, overlap_region->offset) !=
-                    (ssize_t)overlap_region->data_size) {
-                    printf("==PDC_SERVER[%d]: pread failed to read enough bytes\n", pdc_server_rank_g);
-                }
 
 #ifdef ENABLE_RADOS
                 retu = PDC_Server_rados_read(obj_id, tmp_buf);
@@ -5907,9 +6401,10 @@ PDC_Server_data_write_out(uint64_t obj_id, struct pdc_region_info *region_info,
 #else
                 // Posix calls here
                 // Read entire region
-                if (pread(region->fd, tmp_buf, overlap_region->data_size, overlap_region->offset) !=
-                    (ssize_t)overlap_region->data_size) {
-                    printf("==PDC_SERVER[%d]: pread failed to read enough bytes\n", pdc_server_rank_g);
+                if (PDC_Server_region_read_all(fd, overlap_region, tmp_buf) != SUCCEED) {
+                    free(tmp_buf);
+                    ret_value = FAIL;
+                    goto done;
                 }
 #endif
 
@@ -5955,15 +6450,15 @@ PDC_Server_data_write_out(uint64_t obj_id, struct pdc_region_info *region_info,
                     printf("Rados_written finished with overlapping condition for ndim =3\n");
                 }
 #else
-                if (pwrite(region->fd, tmp_buf, overlap_region->data_size, overlap_region->offset) !=
-                    (ssize_t)overlap_region->data_size) {
-                    printf("==PDC_SERVER[%d]: Failed to write enough bytes\n", pdc_server_rank_g);
-                }
+                if (PDC_Server_region_write_all(region, fd, overlap_region, tmp_buf) != SUCCEED)
+                    ret_value = FAIL;
 #endif
 
                 free(tmp_buf);
                 // No need to update metadata
             } // End 3D
+            PDC_Server_tier_access(region, overlap_region, PDC_WRITE);
+            pinned_region = NULL;
         }     // End is overlap
 
     } // End DL_FOREACH storage region list
@@ -5981,9 +6476,8 @@ PDC_Server_data_write_out(uint64_t obj_id, struct pdc_region_info *region_info,
 
 #else
         // Posix Calls here
-        request_region->offset = lseek(region->fd, 0, SEEK_END);
-
-        ret_value = PDC_Server_posix_write(region->fd, buf, write_size);
+        request_region->data_size = write_size;
+        ret_value                 = PDC_Server_region_append(region, request_region, buf);
         if (ret_value != SUCCEED) {
             printf("==PDC_SERVER[%d]: PDC_Server_posix_write FAILED!\n", pdc_server_rank_g);
             ret_value = FAIL;
@@ -6009,6 +6503,10 @@ PDC_Server_data_write_out(uint64_t obj_id, struct pdc_region_info *region_info,
 
     /* printf("==PDC_SERVER[%d]: write region %llu bytes\n", pdc_server_rank_g, request_region->data_size); */
 done:
+    if (pinned_region != NULL)
+        PDC_Server_tier_unpin(region, pinned_region);
+    // Even a failed write may have changed part of the region, cached query results on it are stale
+    PDC_Server_query_cache_invalidate_all(obj_id);
     fflush(stdout);
     FUNC_LEAVE(ret_value);
 } // End PDC_Server_data_write_out
@@ -6023,6 +6521,8 @@ PDC_Server_data_read_from(uint64_t obj_id, struct pdc_region_info *region_info,
     ssize_t /*read_bytes = 0, */ total_read_bytes = 0, request_bytes = unit, my_read_bytes = 0;
     data_server_region_t *region = NULL;
     region_list_t *elt;
+    region_list_t *pinned_region = NULL;
+    int fd;
     // int flag = 0;
     uint64_t i, j, pos, overlap_start[DIM_MAX] = {0}, overlap_count[DIM_MAX] = {0},
                         overlap_start_local[DIM_MAX] = {0};
@@ -6062,6 +6562,8 @@ PDC_Server_data_read_from(uint64_t obj_id, struct pdc_region_info *region_info,
 
         if (PDC_is_contiguous_region_overlap(elt, &request_region) == 1) {
             storage_region = elt;
+            fd             = PDC_Server_tier_fd(region, storage_region);
+            pinned_region  = storage_region;
             // flag = 1;
 
             // Get the actual start and count of region in storage
@@ -6104,17 +6606,24 @@ PDC_Server_data_read_from(uint64_t obj_id, struct pdc_region_info *region_info,
                     printf("Rados_read_operation finished for ndim = 1 inside read function \n");
                 }
 
+                memcpy(buf + pos, tmp_buf + overlap_start_local[0] * unit, overlap_count[0] * unit);
 #else
                 // Posix Call here
-                if (pread(region->fd, buf + pos, overlap_count[0] * unit,
-                          storage_region->offset + overlap_start_local[0] * unit) !=
-                    (ssize_t)(overlap_count[0] * unit)) {
-                    printf("==PDC_SERVER[%d]: pread failed to read enough bytes\n", pdc_server_rank_g);
+                if (storage_region->compress != PDC_COMPRESS_NONE) {
+                    // A compressed region is decompressed as a whole
+                    if (PDC_Server_region_read_all(fd, storage_region, tmp_buf) != SUCCEED) {
+                        free(tmp_buf);
+                        ret_value = FAIL;
+                        goto done;
+                    }
+                    memcpy(buf + pos, tmp_buf + overlap_start_local[0] * unit, overlap_count[0] * unit);
+                }
+                else if (pread(fd, buf + pos, overlap_count[0] * unit,
+                               storage_region->offset + overlap_start_local[0] * unit) !=
+                         (ssize_t)(overlap_count[0] * unit)) {
+                    printf("==PDC_SERVER[%d]: pread failed to read enough bytes\n", pdc_server_rank_g);
                 }
-
 #endif
-
-                memcpy(buf + pos, tmp_buf + overlap_start_local[0] * unit, overlap_count[0] * unit);
                 my_read_bytes = overlap_count[0] * unit;
                 free(tmp_buf);
                 printf("Final values in pdc_read\n");
@@ -6138,9 +6647,10 @@ PDC_Server_data_read_from(uint64_t obj_id, struct pdc_region_info *region_info,
                 }
 
 #else
-                if (pread(region->fd, tmp_buf, storage_region->data_size, storage_region->offset) !=
-                    (ssize_t)storage_region->data_size) {
-                    printf("==PDC_SERVER[%d]: pread failed to read enough bytes\n", pdc_server_rank_g);
+                if (PDC_Server_region_read_all(fd, storage_region, tmp_buf) != SUCCEED) {
+                    free(tmp_buf);
+                    ret_value = FAIL;
+                    goto done;
                 }
 #endif
 
@@ -6186,9 +6696,10 @@ PDC_Server_data_read_from(uint64_t obj_id, struct pdc_region_info *region_info,
 
 #else
                 // Posix call here
-                if (pread(region->fd, tmp_buf, storage_region->data_size, storage_region->offset) !=
-                    (ssize_t)storage_region->data_size) {
-                    printf("==PDC_SERVER[%d]: pread failed to read enough bytes\n", pdc_server_rank_g);
+                if (PDC_Server_region_read_all(fd, storage_region, tmp_buf) != SUCCEED) {
+                    free(tmp_buf);
+                    ret_value = FAIL;
+                    goto done;
                 }
 
 #endif
@@ -6243,6 +6754,8 @@ PDC_Server_data_read_from(uint64_t obj_id, struct pdc_region_info *region_info,
                         }
             */
             total_read_bytes += my_read_bytes;
+            PDC_Server_tier_access(region, storage_region, PDC_READ);
+            pinned_region = NULL;
 
         } // End is overlap
 
@@ -6264,6 +6777,8 @@ PDC_Server_data_read_from(uint64_t obj_id, struct pdc_region_info *region_info,
 #endif
 
 done:
+    if (pinned_region != NULL)
+        PDC_Server_tier_unpin(region, pinned_region);
     fflush(stdout);
     FUNC_LEAVE(ret_value);
 }
@@ -6858,6 +7373,12 @@ PDC_Server_free_query_task(query_task_t *task)
         free(task->data_arr);
     if (task->n_hits_from_server)
         free(task->n_hits_from_server);
+    if (task->cursor_buf)
+        free(task->cursor_buf);
+    if (task->plan)
+        free(task->plan);
+    if (task->cache_key)
+        free(task->cache_key);
 
     free(task);
 }
@@ -6879,40 +7400,34 @@ PDC_query_visit_leaf_with_cb(pdc_query_t *query, perr_t (*func)(pdc_query_t *arg
 static perr_t
 PDC_Server_data_read_to_buf_1_region(region_list_t *region)
 {
-    perr_t   ret_value = SUCCEED;
-    uint64_t offset, read_bytes;
-    FILE *   fp_read = NULL;
+    perr_t ret_value = SUCCEED;
+    int    fd        = -1;
 
     if (region->is_data_ready == 1)
         return SUCCEED;
 
-    fp_read = fopen(region->storage_location, "rb");
-    if (NULL == fp_read) {
-        printf("==PDC_SERVER[%d]: fopen failed [%s]\n", pdc_server_rank_g, region->storage_location);
+    if (region->data_size == 0) {
+        printf("==PDC_SERVER[%d]: %s - region data_size is 0\n", pdc_server_rank_g, __func__);
         ret_value = FAIL;
         goto done;
     }
-    n_fopen_g++;
-
-    offset = ftell(fp_read);
-    if (offset < region->offset)
-        fseek(fp_read, region->offset - offset, SEEK_CUR);
-    else
-        fseek(fp_read, region->offset, SEEK_SET);
 
-    if (region->data_size == 0) {
-        printf("==PDC_SERVER[%d]: %s - region data_size is 0\n", pdc_server_rank_g, __func__);
+    fd = open(region->storage_location, O_RDONLY);
+    if (fd < 0) {
+        printf("==PDC_SERVER[%d]: open failed [%s]\n", pdc_server_rank_g, region->storage_location);
         ret_value = FAIL;
         goto done;
     }
+    n_fopen_g++;
 
+    // A compressed region is decompressed into the buffer
     region->buf = malloc(region->data_size);
-
-    read_bytes = fread(region->buf, 1, region->data_size, fp_read);
-    if (read_bytes != region->data_size) {
-        printf("==PDC_SERVER[%d]: %s - read size %" PRIu64 " is not expected %" PRIu64 "\n",
-               pdc_server_rank_g, __func__, read_bytes, region->data_size);
-        ret_value = FAIL;
+    if (region->buf == NULL || PDC_Server_region_read_all(fd, region, region->buf) != SUCCEED) {
+        printf("==PDC_SERVER[%d]: %s - failed to read region from [%s]\n", pdc_server_rank_g, __func__,
+               region->storage_location);
+        free(region->buf);
+        region->buf = NULL;
+        ret_value   = FAIL;
         goto done;
     }
 
@@ -6920,8 +7435,8 @@ PDC_Server_data_read_to_buf_1_region(region_list_t *region)
     region->is_io_done    = 1;
 
 done:
-    if (fp_read)
-        fclose(fp_read);
+    if (fd >= 0)
+        close(fd);
     return ret_value;
 }
 
@@ -6930,9 +7445,8 @@ PDC_Server_data_read_to_buf(region_list_t *region_list_head)
 {
     perr_t         ret_value = SUCCEED;
     region_list_t *region_elt;
-    char *         prev_path = NULL;
-    uint64_t       offset, read_bytes;
-    FILE *         fp_read    = NULL;
+    char *         prev_path  = NULL;
+    int            fd         = -1;
     int            read_count = 0;
 
 #ifdef ENABLE_TIMING
@@ -6947,33 +7461,31 @@ PDC_Server_data_read_to_buf(region_list_t *region_list_head)
             continue;
 
         if (prev_path == NULL || strcmp(region_elt->storage_location, prev_path) != 0) {
-            if (fp_read != NULL)
-                fclose(fp_read);
-            fp_read = fopen(region_elt->storage_location, "rb");
-            if (NULL == fp_read) {
-                printf("==PDC_SERVER[%d]: fopen failed [%s]\n", pdc_server_rank_g,
+            if (fd >= 0)
+                close(fd);
+            prev_path = region_elt->storage_location;
+            fd        = open(region_elt->storage_location, O_RDONLY);
+            if (fd < 0) {
+                printf("==PDC_SERVER[%d]: open failed [%s]\n", pdc_server_rank_g,
                        region_elt->storage_location);
+                continue;
             }
             n_fopen_g++;
         }
 
-        offset = ftell(fp_read);
-        if (offset < region_elt->offset)
-            fseek(fp_read, region_elt->offset - offset, SEEK_CUR);
-        else
-            fseek(fp_read, region_elt->offset, SEEK_SET);
-
         if (region_elt->data_size == 0) {
             printf("==PDC_SERVER[%d]: %s - region data_size is 0\n", pdc_server_rank_g, __func__);
             continue;
         }
 
+        // A compressed region is decompressed into the buffer
         region_elt->buf = malloc(region_elt->data_size);
-
-        read_bytes = fread(region_elt->buf, 1, region_elt->data_size, fp_read);
-        if (read_bytes != region_elt->data_size) {
-            printf("==PDC_SERVER[%d]: %s - read size %" PRIu64 " is not expected %" PRIu64 "\n",
-                   pdc_server_rank_g, __func__, read_bytes, region_elt->data_size);
+        if (region_elt->buf == NULL || fd < 0 ||
+            PDC_Server_region_read_all(fd, region_elt, region_elt->buf) != SUCCEED) {
+            printf("==PDC_SERVER[%d]: %s - failed to read region from [%s]\n", pdc_server_rank_g, __func__,
+                   region_elt->storage_location);
+            free(region_elt->buf);
+            region_elt->buf = NULL;
             continue;
         }
         read_count++;
@@ -6982,8 +7494,8 @@ PDC_Server_data_read_to_buf(region_list_t *region_list_head)
         region_elt->is_io_done    = 1;
     }
 
-    if (fp_read)
-        fclose(fp_read);
+    if (fd >= 0)
+        close(fd);
 
 #ifdef ENABLE_TIMING
     gettimeofday(&pdc_timer_end1, 0);
@@ -7001,76 +7513,64 @@ PDC_Server_data_read_to_buf(region_list_t *region_list_head)
     return ret_value;
 }
 
-static int
-PDC_region_has_hits_from_hist(pdc_query_constraint_t *constraint, pdc_histogram_t *region_hist)
+/*
+ * Decode the bounds of a constraint, PDCquery_create copies the raw bytes of a value of the constraint type
+ * into value and value2
+ *
+ * \param  constraint[IN]       Query constraint
+ * \param  value[OUT]           First bound
+ * \param  value2[OUT]          Second bound of a range
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_constraint_get_bounds(pdc_query_constraint_t *constraint, double *value, double *value2)
 {
-    pdc_query_op_t lop;
-    double         value, value2;
-
-    if (constraint == NULL || region_hist == NULL) {
-        printf("==PDC_SERVER[%d]: %s -  NULL input!\n", pdc_server_rank_g, __func__);
-        return -1;
-    }
-    /*
-        switch (constraint->type) {
-            case PDC_FLOAT:
-                value  = (double)(*((float *)&constraint->value));
-                value2 = (double)(*((float *)&constraint->value2));
-                break;
-            case PDC_DOUBLE:
-                value  = (double)(*((double *)&constraint->value));
-                value2 = (double)(*((double *)&constraint->value2));
-                break;
-            case PDC_INT:
-                value  = (double)(*((int *)&constraint->value));
-                value2 = (double)(*((int *)&constraint->value2));
-                break;
-            case PDC_UINT:
-                value  = (double)(*((uint32_t *)&constraint->value));
-                value2 = (double)(*((uint32_t *)&constraint->value2));
-                break;
-            case PDC_INT64:
-                value  = (double)(*((int64_t *)&constraint->value));
-                value2 = (double)(*((int64_t *)&constraint->value2));
-                break;
-            case PDC_UINT64:
-                value  = (double)(*((uint64_t *)&constraint->value));
-                value2 = (double)(*((uint64_t *)&constraint->value2));
-                break;
-            default:
-                printf("==PDC_SERVER[%d]: %s - error with operator type!\n", pdc_server_rank_g, __func__);
-                return -1;
-        }
-    */
     switch (constraint->type) {
         case PDC_FLOAT:
-            value  = (double)constraint->value;
-            value2 = (double)constraint->value2;
+            *value  = (double)(*((float *)&constraint->value));
+            *value2 = (double)(*((float *)&constraint->value2));
             break;
         case PDC_DOUBLE:
-            value  = (double)constraint->value;
-            value2 = (double)constraint->value2;
+            *value  = *((double *)&constraint->value);
+            *value2 = *((double *)&constraint->value2);
             break;
         case PDC_INT:
-            value  = (double)constraint->value;
-            value2 = (double)constraint->value2;
+            *value  = (double)(*((int *)&constraint->value));
+            *value2 = (double)(*((int *)&constraint->value2));
             break;
         case PDC_UINT:
-            value  = (double)constraint->value;
-            value2 = (double)constraint->value2;
+            *value  = (double)(*((uint32_t *)&constraint->value));
+            *value2 = (double)(*((uint32_t *)&constraint->value2));
             break;
         case PDC_INT64:
-            value  = (double)constraint->value;
-            value2 = (double)constraint->value2;
+            *value  = (double)(*((int64_t *)&constraint->value));
+            *value2 = (double)(*((int64_t *)&constraint->value2));
             break;
         case PDC_UINT64:
-            value  = (double)constraint->value;
-            value2 = (double)constraint->value2;
+            *value  = (double)(*((uint64_t *)&constraint->value));
+            *value2 = (double)(*((uint64_t *)&constraint->value2));
             break;
         default:
             printf("==PDC_SERVER[%d]: %s - error with operator type!\n", pdc_server_rank_g, __func__);
-            return -1;
+            return FAIL;
+    }
+
+    return SUCCEED;
+}
+
+static int
+PDC_region_has_hits_from_hist(pdc_query_constraint_t *constraint, pdc_histogram_t *region_hist)
+{
+    pdc_query_op_t lop;
+    double         value, value2;
+
+    if (constraint == NULL || region_hist == NULL) {
+        printf("==PDC_SERVER[%d]: %s -  NULL input!\n", pdc_server_rank_g, __func__);
+        return -1;
     }
+    if (PDC_constraint_get_bounds(constraint, &value, &value2) != SUCCEED)
+        return -1;
 
     lop = constraint->op;
 
@@ -7094,113 +7594,441 @@ PDC_region_has_hits_from_hist(pdc_query_constraint_t *constraint, pdc_histogram_
     return 1;
 }
 
-/*
+// Estimate the number of hits of a constraint in a region with its sketch. The exact min and max bound the
+// hits to 0 when the queried range misses them, otherwise the quantile sketch estimates the ranks of the
+// bounds of the range
 static perr_t
-PDC_constraint_get_nhits_from_hist(pdc_query_constraint_t *constraint, pdc_histogram_t *region_hist,
-                                  uint64_t *min_hits, uint64_t *max_hits)
+PDC_constraint_get_nhits_from_sketch(pdc_query_constraint_t *constraint, pdc_sketch_t *sketch,
+                                     uint64_t *est_hits, uint64_t *max_hits)
 {
-    perr_t ret_value = SUCCEED;
+    perr_t         ret_value = SUCCEED;
     pdc_query_op_t lop;
-    double value, value2;
-    int    i, lidx, ridx;
+    double         value, value2, lo, hi;
+    int            lo_incl, hi_incl;
+    uint64_t       below_lo, below_hi;
 
-    if (constraint == NULL || region_hist == NULL || min_hits == NULL || max_hits == NULL) {
+    if (constraint == NULL || sketch == NULL || est_hits == NULL || max_hits == NULL) {
         printf("==PDC_SERVER[%d]: %s -  NULL input!\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
 
+    if (PDC_constraint_get_bounds(constraint, &value, &value2) != SUCCEED) {
+        ret_value = FAIL;
         goto done;
     }
 
-    switch(constraint->type) {
-        case PDC_FLOAT :
-            value  = (double)(*((float*)&constraint->value));
-            value2 = (double)(*((float*)&constraint->value2));
-            break;
-        case PDC_DOUBLE:
-            value  = (double)(*((double*)&constraint->value));
-            value2 = (double)(*((double*)&constraint->value2));
-            break;
-        case PDC_INT:
-            value  = (double)(*((int*)&constraint->value));
-            value2 = (double)(*((int*)&constraint->value2));
-            break;
-        case PDC_UINT:
-            value  = (double)(*((uint32_t*)&constraint->value));
-            value2 = (double)(*((uint32_t*)&constraint->value2));
-            break;
-        case PDC_INT64:
-            value  = (double)(*((int64_t*)&constraint->value));
-            value2 = (double)(*((int64_t*)&constraint->value2));
+    lop = constraint->op;
+    if (constraint->is_range == 1) {
+        lo      = value;
+        lo_incl = lop == PDC_GTE;
+        hi      = value2;
+        hi_incl = constraint->op2 == PDC_LTE;
+    }
+    else if (lop == PDC_LT || lop == PDC_LTE) {
+        lo      = -DBL_MAX;
+        lo_incl = 1;
+        hi      = value;
+        hi_incl = lop == PDC_LTE;
+    }
+    else if (lop == PDC_GT || lop == PDC_GTE) {
+        lo      = value;
+        lo_incl = lop == PDC_GTE;
+        hi      = DBL_MAX;
+        hi_incl = 1;
+    }
+    else if (lop == PDC_EQ) {
+        lo = hi = value;
+        lo_incl = hi_incl = 1;
+    }
+    else {
+        printf("==PDC_SERVER[%d]: %s - error with query operator!\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
 
-            break;
-        case PDC_UINT64:
-            value  = (double)(*((uint64_t*)&constraint->value));
-            value2 = (double)(*((uint64_t*)&constraint->value2));
-            break;
-        default:
-            printf("==PDC_SERVER[%d]: %s - error with operator type!\n", pdc_server_rank_g, __func__);
-            ret_value = FAIL;
-            goto done;
+    if (sketch->n == 0 || hi < sketch->min || (hi == sketch->min && !hi_incl) || lo > sketch->max ||
+        (lo == sketch->max && !lo_incl)) {
+        *est_hits = *max_hits = 0;
+        goto done;
     }
 
-    lop = constraint->op;
+    below_hi  = PDC_sketch_rank(sketch, hi, hi_incl);
+    below_lo  = PDC_sketch_rank(sketch, lo, !lo_incl);
+    *est_hits = below_hi > below_lo ? below_hi - below_lo : 0;
+    *max_hits = sketch->n;
+
+done:
+    return ret_value;
+}
+
+// Tell from the histogram and the sketch of a region if a constraint may have hits in it
+static int
+PDC_region_has_hits(pdc_query_constraint_t *constraint, region_list_t *region)
+{
+    uint64_t est_hits, max_hits;
+
+    if (gen_hist_g == 1 && PDC_region_has_hits_from_hist(constraint, region->region_hist) == 0)
+        return 0;
+
+    if (region->region_sketch != NULL &&
+        PDC_constraint_get_nhits_from_sketch(constraint, region->region_sketch, &est_hits, &max_hits) ==
+            SUCCEED &&
+        max_hits == 0)
+        return 0;
+
+    return 1;
+}
+
+// Bound the number of hits of a constraint in a region with its histogram, bins that are fully inside the
+// queried range count toward min_hits, bins that overlap it count toward max_hits
+static perr_t
+PDC_constraint_get_nhits_from_hist(pdc_query_constraint_t *constraint, pdc_histogram_t *region_hist,
+                                   uint64_t *min_hits, uint64_t *max_hits)
+{
+    perr_t         ret_value = SUCCEED;
+    pdc_query_op_t lop;
+    double         value, value2, lo, hi;
+    int            i;
+
+    if (constraint == NULL || region_hist == NULL || min_hits == NULL || max_hits == NULL) {
+        printf("==PDC_SERVER[%d]: %s -  NULL input!\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
+
+    if (PDC_constraint_get_bounds(constraint, &value, &value2) != SUCCEED) {
+        ret_value = FAIL;
+        goto done;
+    }
+
+    lop       = constraint->op;
     *min_hits = *max_hits = 0;
-    lidx = 0;
-    ridx = region_hist->nbin*2 - 1;
 
     if (constraint->is_range == 1) {
-        // No overlap at all
-        if (value > region_hist->range[region_hist->nbin*2-1] || value2 < region_hist->range[0]) {
-            goto done;
-        }
+        lo = value;
+        hi = value2;
+    }
+    else if (lop == PDC_LT || lop == PDC_LTE) {
+        lo = -DBL_MAX;
+        hi = value;
+    }
+    else if (lop == PDC_GT || lop == PDC_GTE) {
+        lo = value;
+        hi = DBL_MAX;
+    }
+    else if (lop == PDC_EQ) {
+        lo = value;
+        hi = value;
+    }
+    else {
+        printf("==PDC_SERVER[%d]: %s - error with query operator!\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
 
-        // Find the value range in hist that includes the queried range
-        i = 0;
-        while (i < region_hist->nbin*2 && region_hist->range[i] < value) {
-            lidx = i;
-            i += 2;
-        }
+    for (i = 0; i < region_hist->nbin; i++) {
+        // No overlap with the bin
+        if (region_hist->range[i * 2 + 1] < lo || region_hist->range[i * 2] > hi)
+            continue;
 
-        i = region_hist->nbin*2 - 1;
-        while (i > 0 && region_hist->range[i] > value2) {
-            ridx = i;
-            i -= 2;
-        }
+        (*max_hits) += region_hist->bin[i];
+        if (region_hist->range[i * 2] >= lo && region_hist->range[i * 2 + 1] <= hi)
+            (*min_hits) += region_hist->bin[i];
     }
-    else {
-        // one sided
-        if (lop == PDC_LT || lop == PDC_LTE) {
-            i = region_hist->nbin*2 - 1;
-            while (i > 0 && region_hist->range[i] > value) {
-                ridx = i;
-                i -= 2;
-            }
-            lidx = 0;
-            value2 = value;
-            value = -DBL_MAX;
+
+done:
+    return ret_value;
+}
+
+// Estimate the number of hits of a leaf from the histograms of its storage regions, regions without a
+// histogram are assumed to be all hits
+static void
+PDC_Server_plan_estimate_leaf(pdc_query_t *leaf, query_plan_leaf_t *plan)
+{
+    region_list_t *region_elt, *region_list_head;
+    uint64_t       nelem, min_hits, max_hits, est_hits, sketch_hits, sketch_max_hits;
+    size_t         unit_size;
+
+    plan->leaf       = leaf;
+    region_list_head = (region_list_t *)leaf->constraint->storage_region_list_head;
+    unit_size        = PDC_get_var_type_size(leaf->constraint->type);
+    if (unit_size == 0)
+        unit_size = 1;
+
+    DL_FOREACH(region_list_head, region_elt)
+    {
+        nelem = region_elt->data_size / unit_size;
+        plan->total_elem += nelem;
+
+        if (gen_hist_g == 1 && region_elt->region_hist != NULL && region_elt->region_hist->nbin > 0 &&
+            PDC_constraint_get_nhits_from_hist(leaf->constraint, region_elt->region_hist, &min_hits,
+                                               &max_hits) == SUCCEED) {
+            est_hits = (min_hits + max_hits) / 2;
         }
-        else if (lop == PDC_GT || lop == PDC_GTE) {
-            i = 0;
-            while (i < region_hist->nbin*2 && region_hist->range[i] < value) {
-                lidx = i;
-                i += 2;
-            }
-            ridx = region_hist->nbin*2 - 1;
-            value2 = DBL_MAX;
+        else
+            min_hits = max_hits = est_hits = nelem;
+
+        // The exact min and max of the sketch can rule the region out, and its ranks estimate the hits
+        // within the bounds of the histogram
+        if (region_elt->region_sketch != NULL &&
+            PDC_constraint_get_nhits_from_sketch(leaf->constraint, region_elt->region_sketch, &sketch_hits,
+                                                 &sketch_max_hits) == SUCCEED) {
+            max_hits = PDC_MIN(max_hits, sketch_max_hits);
+            min_hits = PDC_MIN(min_hits, max_hits);
+            est_hits = PDC_MAX(min_hits, PDC_MIN(sketch_hits, max_hits));
         }
+
+        plan->est_min_hits += min_hits;
+        plan->est_max_hits += max_hits;
+        plan->est_hits += est_hits;
     }
 
-    for (i = lidx/2; i <= ridx/2; i++) {
-        (*max_hits) += region_hist->bin[i];
-        if (region_hist->range[i*2] >= value && region_hist->range[i*2+1] <= value2) {
+    if (plan->total_elem > 0)
+        plan->selectivity = (double)plan->est_hits / (double)plan->total_elem;
+    else
+        plan->selectivity = 1.0;
 
-            (*min_hits) += region_hist->bin[i];
+    // A full scan reads every element anyway, the index only pays off when few elements are selected
+    plan->use_index = use_fastbit_idx_g == 1 && plan->selectivity <= PDC_QUERY_INDEX_MAX_SEL ? 1 : 0;
+}
+
+static int
+PDC_query_is_leaf(pdc_query_t *query)
+{
+    return query != NULL && query->left == NULL && query->right == NULL;
+}
+
+static int
+PDC_Server_plan_count_leaf(pdc_query_t *query)
+{
+    if (query == NULL)
+        return 0;
+    if (PDC_query_is_leaf(query))
+        return 1;
+
+    return PDC_Server_plan_count_leaf(query->left) + PDC_Server_plan_count_leaf(query->right);
+}
+
+static void
+PDC_Server_plan_add_leaf(query_task_t *task, pdc_query_t *query)
+{
+    if (query == NULL)
+        return;
+
+    if (PDC_query_is_leaf(query)) {
+        if (query->constraint != NULL) {
+            PDC_Server_plan_estimate_leaf(query, &task->plan[task->nplan]);
+            task->plan[task->nplan].order = task->nplan;
+            task->nplan++;
         }
+        return;
+    }
+
+    PDC_Server_plan_add_leaf(task, query->left);
+    PDC_Server_plan_add_leaf(task, query->right);
+}
+
+static query_plan_leaf_t *
+PDC_Server_plan_get_leaf(query_task_t *task, pdc_query_t *leaf)
+{
+    int i;
+
+    for (i = 0; i < task->nplan; i++) {
+        if (task->plan[i].leaf == leaf)
+            return &task->plan[i];
+    }
+
+    return NULL;
+}
+
+// Upper bound of the number of hits of a (sub)query
+static uint64_t
+PDC_Server_plan_max_hits(query_task_t *task, pdc_query_t *query)
+{
+    query_plan_leaf_t *plan;
+    uint64_t           lhits, rhits;
+
+    if (query == NULL)
+        return 0;
+
+    if (PDC_query_is_leaf(query)) {
+        plan = PDC_Server_plan_get_leaf(task, query);
+        return plan == NULL ? UINT64_MAX : plan->est_max_hits;
+    }
+
+    lhits = PDC_Server_plan_max_hits(task, query->left);
+    rhits = PDC_Server_plan_max_hits(task, query->right);
+    if (query->combine_op == PDC_QUERY_AND)
+        return PDC_MIN(lhits, rhits);
+
+    return lhits > UINT64_MAX - rhits ? UINT64_MAX : lhits + rhits;
+}
+
+static int
+compare_plan_leaf_selectivity(const void *a, const void *b)
+{
+    const query_plan_leaf_t *pa = *(query_plan_leaf_t *const *)a;
+    const query_plan_leaf_t *pb = *(query_plan_leaf_t *const *)b;
+
+    if (pa->selectivity < pb->selectivity)
+        return -1;
+    if (pa->selectivity > pb->selectivity)
+        return 1;
+
+    // Keep the user's order for ties
+    return pa->order - pb->order;
+}
+
+// Reorder the leaves of a left-deep AND chain so the most selective leaf is evaluated first. The leaves
+// are merged into one selection in visiting order, so only the leaves of the chain that is evaluated first
+// are permuted, other subtrees keep their position
+static void
+PDC_Server_plan_reorder(query_task_t *task, pdc_query_t *query)
+{
+    pdc_query_t **       slot = NULL, ***slots = NULL, *node;
+    query_plan_leaf_t ** chain = NULL;
+    int                  i, n;
+
+    if (query == NULL || PDC_query_is_leaf(query))
+        return;
+
+    if (query->combine_op != PDC_QUERY_AND || !PDC_query_is_leaf(query->right)) {
+        PDC_Server_plan_reorder(task, query->left);
+        return;
+    }
+
+    n     = PDC_Server_plan_count_leaf(query);
+    slots = (pdc_query_t ***)calloc(n, sizeof(pdc_query_t **));
+    chain = (query_plan_leaf_t **)calloc(n, sizeof(query_plan_leaf_t *));
+
+    // Collect the leaf slots of the chain from the top, the last one is evaluated first
+    n    = 0;
+    node = query;
+    while (!PDC_query_is_leaf(node) && node->combine_op == PDC_QUERY_AND && PDC_query_is_leaf(node->right)) {
+        slots[n++] = &node->right;
+        slot       = &node->left;
+        node       = node->left;
+    }
+    if (PDC_query_is_leaf(node))
+        slots[n++] = slot;
+    else
+        PDC_Server_plan_reorder(task, node);
+
+    for (i = 0; i < n; i++) {
+        chain[i] = PDC_Server_plan_get_leaf(task, *slots[i]);
+        if (chain[i] == NULL)
+            goto done;
+        chain[i]->order = n - 1 - i;
+    }
+
+    qsort(chain, n, sizeof(query_plan_leaf_t *), compare_plan_leaf_selectivity);
+
+    for (i = 0; i < n; i++)
+        *slots[n - 1 - i] = chain[i]->leaf;
+
+done:
+    free(slots);
+    free(chain);
+}
+
+// Number the leaves in the order PDC_query_visit evaluates them
+static void
+PDC_Server_plan_set_order(query_task_t *task, pdc_query_t *query, int *order)
+{
+    query_plan_leaf_t *plan;
+
+    if (query == NULL)
+        return;
+
+    if (PDC_query_is_leaf(query)) {
+        plan = PDC_Server_plan_get_leaf(task, query);
+        if (plan)
+            plan->order = (*order)++;
+        return;
+    }
+
+    PDC_Server_plan_set_order(task, query->left, order);
+    PDC_Server_plan_set_order(task, query->right, order);
+}
+
+static void
+PDC_Server_plan_report(query_task_t *task)
+{
+    query_plan_leaf_t *plan;
+    int                i;
+
+    printf("==PDC_SERVER[%d]: query %d plan, %d leaves%s\n", pdc_server_rank_g, task->query_id, task->nplan,
+           task->plan_is_empty == 1 ? ", no hits from region statistics, skip evaluation" : "");
+    for (i = 0; i < task->nplan; i++) {
+        plan = &task->plan[i];
+        printf("==PDC_SERVER[%d]:   [%d] obj %" PRIu64 " %s, est. hits [%" PRIu64 ", %" PRIu64 "] of %" PRIu64
+               ", selectivity %.4f, %s\n",
+               pdc_server_rank_g, plan->order, plan->leaf->constraint->obj_id,
+               pdcquery_op_char_g[plan->leaf->constraint->op], plan->est_min_hits, plan->est_max_hits,
+               plan->total_elem, plan->selectivity, plan->use_index == 1 ? "index" : "scan");
+    }
+    fflush(stdout);
+}
+
+// Build the plan of a query before evaluation: estimate the selectivity of each leaf, pick index or scan,
+// and move the most selective AND leaves to the front
+static perr_t
+PDC_Server_plan_query(query_task_t *task)
+{
+    perr_t         ret_value = SUCCEED;
+    region_list_t *region_head;
+    int            nleaf, order;
+
+    if (task == NULL || task->query == NULL)
+        goto done;
+
+    nleaf = PDC_Server_plan_count_leaf(task->query);
+    if (nleaf == 0)
+        goto done;
+
+    if (task->plan)
+        free(task->plan);
+    task->plan = (query_plan_leaf_t *)calloc(nleaf, sizeof(query_plan_leaf_t));
+    if (NULL == task->plan) {
+        printf("==PDC_SERVER[%d]: %s - error allocating query plan!\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
+    task->nplan = 0;
+    PDC_Server_plan_add_leaf(task, task->query);
+
+    PDC_Server_plan_reorder(task, task->query);
+    order = 0;
+    PDC_Server_plan_set_order(task, task->query, &order);
+
+    // Short circuit, the histograms and sketches bound the result to no hits so nothing needs to be read
+    if ((gen_hist_g == 1 || gen_sketch_g == 1) && task->nplan > 0 &&
+        PDC_Server_plan_max_hits(task, task->query) == 0) {
+        task->plan_is_empty = 1;
+        region_head         = (region_list_t *)task->plan[0].leaf->constraint->storage_region_list_head;
+        if ((task->ndim <= 0 || task->ndim > 3) && region_head != NULL)
+            task->ndim = region_head->ndim;
     }
 
+    if (query_plan_report_g == 1)
+        PDC_Server_plan_report(task);
+
 done:
     return ret_value;
 }
-*/
+
+// Whether a leaf is evaluated with its index, falls back to the global setting when there is no plan
+static int
+PDC_Server_plan_use_index(query_task_t *task, pdc_query_t *leaf)
+{
+    query_plan_leaf_t *plan = PDC_Server_plan_get_leaf(task, leaf);
+
+    if (plan == NULL)
+        return use_fastbit_idx_g;
+
+    return plan->use_index;
+}
 
 static perr_t
 PDC_Server_load_query_data(query_task_t *task, pdc_query_t *query, pdc_query_combine_op_t combine_op)
@@ -7289,15 +8117,15 @@ PDC_Server_load_query_data(query_task_t *task, pdc_query_t *query, pdc_query_com
                 continue;
         }
 
-        // use histogram to see if we need to read this region
-        if (gen_hist_g == 1) {
+        // use histogram and sketch to see if we need to read this region
+        if (gen_hist_g == 1 || gen_sketch_g == 1) {
 
-            if (req_region->region_hist->nbin == 0) {
+            if (gen_hist_g == 1 && req_region->region_hist->nbin == 0) {
                 printf("==PDC_SERVER[%d]: %s -  ERROR histogram is empty!\n", pdc_server_rank_g, __func__);
                 fflush(stdout);
             }
 
-            if (PDC_region_has_hits_from_hist(constraint, req_region->region_hist) == 0) {
+            if (PDC_region_has_hits(constraint, req_region) == 0) {
                 /* printf("==PDC_SERVER[%d]: Region [%" PRIu64 ", %" PRIu64 "], skipped by histogram\n", */
                 /*         pdc_server_rank_g, req_region->start[0], req_region->count[0]); */
 
@@ -7327,6 +8155,13 @@ PDC_Server_load_query_data(query_task_t *task, pdc_query_t *query, pdc_query_com
                 break;
         }
 
+        // Region was dropped after a write, read it again from its current location
+        if (1 == is_same_region && region_tmp->is_data_ready != 1) {
+            strcpy(region_tmp->storage_location, req_region->storage_location);
+            region_tmp->offset          = req_region->offset;
+            req_region->io_cache_region = region_tmp;
+        }
+
         if (1 != is_same_region) {
             // append current request region to the io list
             region_list_t *new_region = (region_list_t *)calloc(1, sizeof(region_list_t));
@@ -8334,7 +9169,7 @@ PDC_Server_query_evaluate_merge_opt(pdc_query_t *query, query_task_t *task, pdc_
     }
 
     DL_COUNT(region_list_head, region_elt, count);
-    if (use_fastbit_idx_g == 1) {
+    if (PDC_Server_plan_use_index(task, query) == 1) {
 #ifdef ENABLE_FASTBIT
         region_iter = -1;
         DL_FOREACH(region_list_head, region_elt)
@@ -8360,9 +9195,9 @@ PDC_Server_query_evaluate_merge_opt(pdc_query_t *query, query_task_t *task, pdc_
                     continue;
             }
 
-            // Skip region based on histogram
-            if (gen_hist_g == 1) {
-                if (PDC_region_has_hits_from_hist(query->constraint, region_elt->region_hist) == 0) {
+            // Skip region based on histogram and sketch
+            if (gen_hist_g == 1 || gen_sketch_g == 1) {
+                if (PDC_region_has_hits(query->constraint, region_elt) == 0) {
                     if (task->invalid_region_ids == NULL)
                         task->invalid_region_ids = (int *)calloc(count, sizeof(int));
 
@@ -8459,9 +9294,9 @@ PDC_Server_query_evaluate_merge_opt(pdc_query_t *query, query_task_t *task, pdc_
             if (cache_region->is_data_ready != 1)
                 continue;
 
-            // Skip region based on histogram
-            if (gen_hist_g == 1) {
-                if (PDC_region_has_hits_from_hist(query->constraint, region_elt->region_hist) == 0) {
+            // Skip region based on histogram and sketch
+            if (gen_hist_g == 1 || gen_sketch_g == 1) {
+                if (PDC_region_has_hits(query->constraint, region_elt) == 0) {
                     if (task->invalid_region_ids == NULL)
                         task->invalid_region_ids = (int *)calloc(count, sizeof(int));
 
@@ -8781,6 +9616,9 @@ PDC_Server_send_nhits_to_server(query_task_t *task)
 
     in.query_id = task->query_id;
     in.nhits    = task->query->sel->nhits;
+    in.sum      = task->agg_sum;
+    in.min      = task->agg_min;
+    in.max      = task->agg_max;
 
     hg_ret = HG_Forward(handle, PDC_check_int_ret_cb, NULL, &in);
     if (hg_ret != HG_SUCCESS) {
@@ -8839,6 +9677,9 @@ PDC_Server_send_nhits_to_client(query_task_t *task)
     // Fill input structure
     in.nhits    = task->nhits;
     in.query_id = task->query_id;
+    in.sum      = task->agg_sum;
+    in.min      = task->agg_min;
+    in.max      = task->agg_max;
 
     printf("==PDC_SERVER[%d]: %s - sending %" PRIu64 " nhits to client!\n", pdc_server_rank_g, __func__,
            in.nhits);
@@ -8868,6 +9709,14 @@ PDC_recv_nhits(const struct hg_cb_info *callback_info)
     DL_FOREACH(query_task_list_head_g, task_elt)
     {
         if (task_elt->query_id == in->query_id) {
+            // Combine the partial aggregates of the servers that have hits
+            if (in->nhits > 0) {
+                if (task_elt->nhits == 0 || in->min < task_elt->agg_min)
+                    task_elt->agg_min = in->min;
+                if (task_elt->nhits == 0 || in->max > task_elt->agg_max)
+                    task_elt->agg_max = in->max;
+                task_elt->agg_sum += in->sum;
+            }
             task_elt->nhits += in->nhits;
             task_elt->n_recv++;
             break;
@@ -9062,7 +9911,7 @@ PDC_Server_get_constraint_from_query(pdc_query_t *query, uint64_t obj_id)
     if (constraint != NULL)
         return constraint;
 
-    constraint = PDC_Server_get_constraint_from_query(query->left, obj_id);
+    constraint = PDC_Server_get_constraint_from_query(query->right, obj_id);
     if (constraint != NULL)
         return constraint;
 
@@ -9105,7 +9954,7 @@ is_coord_in_region(int ndim, uint64_t *coord, size_t unit_size, region_list_t *r
 
     for (i = 0; i < ndim; i++) {
         if (coord[i] * unit_size < region->start[i] ||
-            coord[i] * unit_size > region->start[i] + region->count[i]) {
+            coord[i] * unit_size >= region->start[i] + region->count[i]) {
             return -1;
         }
     }
@@ -9187,6 +10036,126 @@ done:
     FUNC_LEAVE(ret_value);
 }
 
+// Read the data of each coord from the storage regions of an object. Coords that are consecutive along the
+// fastest dimension of one region are copied as a single run, and regions larger than
+// PDC_READ_COORDS_LOAD_MAX that are not in memory yet are read one run at a time instead of being loaded
+static void
+PDC_Server_read_coords_data(region_list_t *storage_region_head, size_t ndim, size_t unit_size,
+                            uint64_t *coords, uint64_t ncoords, void *buf)
+{
+    region_list_t *region_elt = NULL, *elt, *cache_region;
+    uint64_t       i, j, run, *coord, *next, buf_off, data_off, region_end;
+    ssize_t        read_bytes;
+    size_t         d;
+    char *         fd_path = NULL;
+    int            fd      = -1;
+
+    data_off = 0;
+    i        = 0;
+    while (i < ncoords) {
+        coord = &(coords[i * ndim]);
+
+        // Coords usually come in order, check the region of the previous run first
+        if (region_elt == NULL || is_coord_in_region(ndim, coord, unit_size, region_elt) != 1) {
+            region_elt = NULL;
+            DL_FOREACH(storage_region_head, elt)
+            {
+                if (is_coord_in_region(ndim, coord, unit_size, elt) == 1) {
+                    region_elt = elt;
+                    break;
+                }
+            }
+        }
+
+        if (region_elt == NULL) {
+            printf("==PDC_SERVER[%d]: %s - coord %" PRIu64 " is not in any storage region!\n",
+                   pdc_server_rank_g, __func__, coord[0]);
+            memset(buf + data_off, 0, unit_size);
+            data_off += unit_size;
+            i++;
+            continue;
+        }
+
+        // Extend the run while the next coord is the next element of the same row of this region
+        region_end = (region_elt->start[0] + region_elt->count[0]) / unit_size;
+        for (run = 1; i + run < ncoords; run++) {
+            next = &(coords[(i + run) * ndim]);
+            if (next[0] != coord[0] + run || next[0] >= region_end)
+                break;
+            for (d = 1; d < ndim; d++) {
+                if (next[d] != coord[d])
+                    break;
+            }
+            if (d < ndim)
+                break;
+        }
+
+        buf_off      = coord_to_offset(ndim, coord, region_elt->start, region_elt->count, unit_size);
+        cache_region = region_elt;
+        if (region_elt->io_cache_region != NULL)
+            cache_region = region_elt->io_cache_region;
+
+        // A compressed region can only be read as a whole
+        if (cache_region->is_io_done != 1 && (cache_region->data_size <= PDC_READ_COORDS_LOAD_MAX ||
+                                              cache_region->compress != PDC_COMPRESS_NONE))
+            PDC_Server_data_read_to_buf_1_region(cache_region);
+
+        if (cache_region->is_io_done == 1) {
+            memcpy(buf + data_off, cache_region->buf + buf_off, run * unit_size);
+        }
+        else {
+            // Large region not in memory, read only this run
+            if (fd_path == NULL || strcmp(fd_path, cache_region->storage_location) != 0) {
+                if (fd >= 0)
+                    close(fd);
+                fd_path = cache_region->storage_location;
+                fd      = open(fd_path, O_RDONLY);
+                n_fopen_g++;
+            }
+            read_bytes = -1;
+            if (fd >= 0 && cache_region->compress == PDC_COMPRESS_NONE)
+                read_bytes = pread(fd, buf + data_off, run * unit_size, cache_region->offset + buf_off);
+            if (read_bytes != (ssize_t)(run * unit_size)) {
+                printf("==PDC_SERVER[%d]: %s - error reading %" PRIu64 " elements from [%s]!\n",
+                       pdc_server_rank_g, __func__, run, cache_region->storage_location);
+                for (j = read_bytes > 0 ? read_bytes : 0; j < run * unit_size; j++)
+                    ((char *)buf)[data_off + j] = 0;
+            }
+            n_fread_g++;
+        }
+
+        data_off += run * unit_size;
+        i += run;
+    } // End while
+
+    if (fd >= 0)
+        close(fd);
+}
+
+// Find the storage regions of an object, either attached to the query or cached by a previous read
+static region_list_t *
+PDC_Server_get_query_obj_storage_region(query_task_t *task, uint64_t obj_id, pdc_var_type_t *data_type)
+{
+    pdc_query_constraint_t *constraint;
+    cache_storage_region_t *cache_region_elt;
+
+    constraint = PDC_Server_get_constraint_from_query(task->query, obj_id);
+    if (NULL != constraint && NULL != constraint->storage_region_list_head) {
+        *data_type = constraint->type;
+        return (region_list_t *)constraint->storage_region_list_head;
+    }
+
+    DL_FOREACH(cache_storage_region_head_g, cache_region_elt)
+    {
+        if (cache_region_elt->obj_id == obj_id) {
+            *data_type = cache_region_elt->data_type;
+            return cache_region_elt->storage_region_head;
+        }
+    }
+
+    return NULL;
+}
+
 // Receive coords from other servers
 hg_return_t
 PDC_Server_read_coords(const struct hg_cb_info *callback_info)
@@ -9194,9 +10163,9 @@ PDC_Server_read_coords(const struct hg_cb_info *callback_info)
     hg_return_t             ret  = HG_SUCCESS;
     query_task_t *          task = (query_task_t *)callback_info->arg;
     pdc_query_constraint_t *constraint;
-    region_list_t *         storage_region_head, *region_elt, *cache_region;
+    region_list_t *         storage_region_head;
     size_t                  ndim, unit_size;
-    uint64_t                i, *coord, data_off, buf_off, my_size;
+    uint64_t                my_size;
 
     // We will read task->my_read_coords, from task->my_read_obj_id
     constraint = PDC_Server_get_constraint_from_query(task->query, task->my_read_obj_id);
@@ -9213,27 +10182,8 @@ PDC_Server_read_coords(const struct hg_cb_info *callback_info)
             goto done;
         }
 
-        data_off = 0;
-        for (i = 0; i < task->my_nread_coords; i++) {
-            coord = &(task->my_read_coords[i * ndim]);
-            DL_FOREACH(storage_region_head, region_elt)
-            {
-                if (is_coord_in_region(ndim, coord, unit_size, region_elt) == 1) {
-                    buf_off = coord_to_offset(ndim, coord, region_elt->start, region_elt->count, unit_size);
-                    cache_region = region_elt;
-                    if (region_elt->io_cache_region != NULL)
-                        cache_region = region_elt->io_cache_region;
-
-                    if (cache_region->is_io_done != 1) {
-                        PDC_Server_data_read_to_buf_1_region(cache_region);
-                    }
-                    /* float *tmp = cache_region->buf + buf_off; */
-                    memcpy(task->my_data + data_off, cache_region->buf + buf_off, unit_size);
-                    data_off += unit_size;
-                    break;
-                }
-            }
-        } // End for
+        PDC_Server_read_coords_data(storage_region_head, ndim, unit_size, task->my_read_coords,
+                                    task->my_nread_coords, task->my_data);
 
         PDC_send_data_to_client(task->client_id, task->my_data, ndim, unit_size, task->my_nread_coords,
                                 task->query_id, task->client_seq_id);
@@ -9444,81 +10394,526 @@ done:
         }
     }
 
-    ret = HG_Respond(bulk_args->handle, NULL, NULL, &out);
-    if (ret != HG_SUCCESS)
-        fprintf(stderr, "Could not respond\n");
+    ret = HG_Respond(bulk_args->handle, NULL, NULL, &out);
+    if (ret != HG_SUCCESS)
+        fprintf(stderr, "Could not respond\n");
+
+    ret = HG_Destroy(bulk_args->handle);
+    if (ret != HG_SUCCESS)
+        fprintf(stderr, "Could not destroy handle\n");
+
+    free(bulk_args);
+
+    return ret;
+}
+
+static perr_t
+PDC_Server_send_query_result_to_client(query_task_t *task)
+{
+    perr_t ret_value = SUCCEED;
+
+    if (task->get_op == PDC_QUERY_GET_NHITS) {
+        ret_value = PDC_Server_send_nhits_to_client(task);
+    }
+    else if (task->get_op == PDC_QUERY_GET_SEL) {
+        ret_value = PDC_Server_send_coords_to_client(task);
+    }
+    else if (task->get_op == PDC_QUERY_GET_CURSOR || task->get_op == PDC_QUERY_GET_AGG) {
+        // Only report the number of hits (and aggregates), the selection stays here
+        task->nhits = task->query->sel->nhits;
+        ret_value   = PDC_Server_send_nhits_to_client(task);
+    }
+    else if (task->get_op == PDC_QUERY_GET_DATA) {
+    }
+    else {
+        printf("==PDC_SERVER[%d]: %s - Invalid get_op type!\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
+
+    if (ret_value != SUCCEED) {
+        printf("==PDC_SERVER[%d]: %s - error sending query result to client!\n", pdc_server_rank_g, __func__);
+        goto done;
+    }
+
+done:
+    return ret_value;
+}
+
+static perr_t
+PDC_Server_send_query_result_to_manager(query_task_t *task)
+{
+    perr_t ret_value = SUCCEED;
+
+    if (task->get_op == PDC_QUERY_GET_NHITS || task->get_op == PDC_QUERY_GET_CURSOR ||
+        task->get_op == PDC_QUERY_GET_AGG) {
+        ret_value = PDC_Server_send_nhits_to_server(task);
+        if (ret_value != SUCCEED) {
+            printf("==PDC_SERVER[%d]: %s - error with PDC_Server_send_nhits_to_server!\n", pdc_server_rank_g,
+                   __func__);
+            goto done;
+        }
+    }
+    else if (task->get_op == PDC_QUERY_GET_SEL) {
+        ret_value = PDC_Server_send_coords_to_server(task);
+        if (ret_value != SUCCEED) {
+            printf("==PDC_SERVER[%d]: %s - error with PDC_Server_send_coords_to_server!\n", pdc_server_rank_g,
+                   __func__);
+            goto done;
+        }
+    }
+    else {
+        printf("==PDC_SERVER[%d]: %s - Invalid get_op type!\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
+
+    // TODO: free the task_list at close time
+
+    printf("==PDC_SERVER[%d]: sent query results to manager %d!\n", pdc_server_rank_g, task->manager);
+done:
+    fflush(stdout);
+
+    return ret_value;
+}
+
+#define MACRO_QUERY_AGGREGATE(TYPE, _n, _data, _sum, _min, _max)                                             \
+    ({                                                                                                       \
+        uint64_t iii;                                                                                        \
+        double   vvv;                                                                                        \
+        TYPE *   edata = (TYPE *)(_data);                                                                    \
+        for (iii = 0; iii < (_n); iii++) {                                                                   \
+            vvv = (double)edata[iii];                                                                        \
+            (_sum) += vvv;                                                                                   \
+            if (vvv < (_min))                                                                                \
+                (_min) = vvv;                                                                                \
+            if (vvv > (_max))                                                                                \
+                (_max) = vvv;                                                                                \
+        }                                                                                                    \
+    })
+
+// Aggregate the values of task->agg_obj_id at the selected coords, the data comes from the regions that
+// were loaded for the query evaluation, so no extra I/O is done for the queried objects
+static perr_t
+PDC_Server_query_aggregate(query_task_t *task)
+{
+    perr_t           ret_value = SUCCEED;
+    region_list_t *  storage_region_head;
+    pdc_var_type_t   data_type;
+    pdc_selection_t *sel;
+    size_t           ndim, unit_size;
+    uint64_t         i, n;
+    void *           buf = NULL;
+
+    task->agg_sum = 0;
+    task->agg_min = DBL_MAX;
+    task->agg_max = -DBL_MAX;
+
+    sel = task->query->sel;
+    if (NULL == sel || sel->nhits == 0) {
+        task->agg_min = task->agg_max = 0;
+        goto done;
+    }
+
+    storage_region_head = PDC_Server_get_query_obj_storage_region(task, task->agg_obj_id, &data_type);
+    if (NULL == storage_region_head) {
+        printf("==PDC_SERVER[%d]: %s - cannot find storage region of obj %" PRIu64 "\n", pdc_server_rank_g,
+               __func__, task->agg_obj_id);
+        ret_value = FAIL;
+        goto done;
+    }
+
+    ndim      = task->ndim;
+    unit_size = PDC_get_var_type_size(data_type);
+
+    // Gather the selected values in bounded chunks so the memory does not grow with the number of hits
+    buf = malloc(PDC_QUERY_AGG_CHUNK * unit_size);
+    for (i = 0; i < sel->nhits; i += n) {
+        n = sel->nhits - i;
+        if (n > PDC_QUERY_AGG_CHUNK)
+            n = PDC_QUERY_AGG_CHUNK;
+
+        PDC_Server_read_coords_data(storage_region_head, ndim, unit_size, &(sel->coords[i * ndim]), n, buf);
+
+        switch (data_type) {
+            case PDC_FLOAT:
+                MACRO_QUERY_AGGREGATE(float, n, buf, task->agg_sum, task->agg_min, task->agg_max);
+                break;
+            case PDC_DOUBLE:
+                MACRO_QUERY_AGGREGATE(double, n, buf, task->agg_sum, task->agg_min, task->agg_max);
+                break;
+            case PDC_INT:
+                MACRO_QUERY_AGGREGATE(int, n, buf, task->agg_sum, task->agg_min, task->agg_max);
+                break;
+            case PDC_UINT:
+                MACRO_QUERY_AGGREGATE(uint32_t, n, buf, task->agg_sum, task->agg_min, task->agg_max);
+                break;
+            case PDC_INT64:
+                MACRO_QUERY_AGGREGATE(int64_t, n, buf, task->agg_sum, task->agg_min, task->agg_max);
+                break;
+            case PDC_UINT64:
+                MACRO_QUERY_AGGREGATE(uint64_t, n, buf, task->agg_sum, task->agg_min, task->agg_max);
+                break;
+            default:
+                printf("==PDC_SERVER[%d]: %s - error with data type!\n", pdc_server_rank_g, __func__);
+                ret_value = FAIL;
+                goto done;
+        } // End switch
+    }
+
+done:
+    if (buf)
+        free(buf);
+
+    return ret_value;
+}
+
+// Fields of a constraint that change the query result, in a fixed layout without padding
+typedef struct query_cache_constraint_key_t {
+    uint64_t obj_id;
+    double   value;
+    double   value2;
+    int32_t  op;
+    int32_t  type;
+    int32_t  is_range;
+    int32_t  op2;
+} query_cache_constraint_key_t;
+
+static uint64_t
+PDC_Server_query_cache_hash(const void *key, size_t key_size)
+{
+    const unsigned char *ptr  = (const unsigned char *)key;
+    uint64_t             hash = 14695981039346656037ULL;
+    size_t               i;
+
+    // FNV-1a
+    for (i = 0; i < key_size; i++) {
+        hash ^= ptr[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+// Build the canonical form of a query for the result cache, the query/client ids and the get_op are left
+// out so the same query issued by any client for any result type maps to the same key
+static void *
+PDC_Server_query_cache_key(pdc_query_xfer_t *query_xfer, size_t *key_size)
+{
+    query_cache_constraint_key_t ckey;
+    pdc_query_constraint_t *     constraint;
+    char *                       key, *ptr;
+    int32_t                      n;
+    int                          i;
+
+    *key_size = 2 * sizeof(int32_t) + query_xfer->n_combine_ops * sizeof(int32_t) +
+                query_xfer->n_constraints * sizeof(query_cache_constraint_key_t) +
+                sizeof(region_info_transfer_t);
+    key = (char *)calloc(1, *key_size);
+    if (NULL == key)
+        return NULL;
+
+    ptr = key;
+    n   = query_xfer->n_combine_ops;
+    memcpy(ptr, &n, sizeof(int32_t));
+    ptr += sizeof(int32_t);
+    for (i = 0; i < query_xfer->n_combine_ops; i++) {
+        n = query_xfer->combine_ops[i];
+        memcpy(ptr, &n, sizeof(int32_t));
+        ptr += sizeof(int32_t);
+    }
+
+    n = query_xfer->n_constraints;
+    memcpy(ptr, &n, sizeof(int32_t));
+    ptr += sizeof(int32_t);
+    for (i = 0; i < query_xfer->n_constraints; i++) {
+        constraint = &query_xfer->constraints[i];
+        memset(&ckey, 0, sizeof(query_cache_constraint_key_t));
+        ckey.obj_id   = constraint->obj_id;
+        ckey.value    = constraint->value;
+        ckey.value2   = constraint->value2;
+        ckey.op       = constraint->op;
+        ckey.type     = constraint->type;
+        ckey.is_range = constraint->is_range;
+        ckey.op2      = constraint->op2;
+        memcpy(ptr, &ckey, sizeof(query_cache_constraint_key_t));
+        ptr += sizeof(query_cache_constraint_key_t);
+    }
+
+    memcpy(ptr, &query_xfer->region, sizeof(region_info_transfer_t));
+
+    return key;
+}
+
+static void
+PDC_Server_query_cache_free_entry(query_cache_entry_t *entry)
+{
+    if (entry->key)
+        free(entry->key);
+    if (entry->obj_ids)
+        free(entry->obj_ids);
+    if (entry->coords)
+        free(entry->coords);
+    free(entry);
+}
+
+static void
+PDC_Server_query_cache_add_obj(pdc_query_t *query, void *arg)
+{
+    query_cache_entry_t *entry = (query_cache_entry_t *)arg;
+    int                  i;
+
+    if (query == NULL || query->constraint == NULL)
+        return;
+
+    for (i = 0; i < entry->nobj; i++) {
+        if (entry->obj_ids[i] == query->constraint->obj_id)
+            return;
+    }
+    entry->obj_ids[entry->nobj++] = query->constraint->obj_id;
+}
+
+// Fill the task selection from the cache, returns 1 on a hit
+static int
+PDC_Server_query_cache_get(query_task_t *task)
+{
+    query_cache_entry_t *entry;
+    pdc_selection_t *    sel;
+    int                  is_hit = 0;
+
+    if (disable_query_cache_g == 1 || task->cache_key == NULL)
+        return 0;
+
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&query_cache_mutex_g);
+#endif
+
+    DL_FOREACH(query_cache_head_g, entry)
+    {
+        if (entry->hash == task->cache_hash && entry->key_size == task->cache_key_size &&
+            memcmp(entry->key, task->cache_key, entry->key_size) == 0)
+            break;
+    }
+
+    // A count only entry cannot serve requests that need the selection
+    if (entry == NULL || (entry->coords == NULL && entry->nhits > 0 && task->get_op != PDC_QUERY_GET_NHITS))
+        goto done;
+
+    sel = task->query->sel;
+    if (entry->nhits > 0 && entry->coords != NULL) {
+        if (sel->coords_alloc < entry->nhits * entry->ndim) {
+            sel->coords_alloc = entry->nhits * entry->ndim;
+            sel->coords       = (uint64_t *)realloc(sel->coords, sel->coords_alloc * sizeof(uint64_t));
+            if (NULL == sel->coords) {
+                sel->coords_alloc = 0;
+                goto done;
+            }
+        }
+        memcpy(sel->coords, entry->coords, entry->nhits * entry->ndim * sizeof(uint64_t));
+    }
+    sel->nhits       = entry->nhits;
+    task->ndim       = entry->ndim;
+    task->total_elem = entry->total_elem;
+    is_hit           = 1;
+
+    // Most recently used entries stay at the front
+    DL_DELETE(query_cache_head_g, entry);
+    DL_PREPEND(query_cache_head_g, entry);
 
-    ret = HG_Destroy(bulk_args->handle);
-    if (ret != HG_SUCCESS)
-        fprintf(stderr, "Could not destroy handle\n");
+    if (is_debug_g == 1) {
+        printf("==PDC_SERVER[%d]: %s - query %d served from cache, %" PRIu64 " hits\n", pdc_server_rank_g,
+               __func__, task->query_id, entry->nhits);
+    }
 
-    free(bulk_args);
+done:
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&query_cache_mutex_g);
+#endif
 
-    return ret;
+    return is_hit;
 }
 
+// Keep the result of an evaluated query, evicting the least recently used entry when full
 static perr_t
-PDC_Server_send_query_result_to_client(query_task_t *task)
+PDC_Server_query_cache_put(query_task_t *task)
 {
-    perr_t ret_value = SUCCEED;
+    perr_t               ret_value = SUCCEED;
+    query_cache_entry_t *entry = NULL, *elt;
+    pdc_selection_t *    sel;
+    int                  nleaf;
 
-    if (task->get_op == PDC_QUERY_GET_NHITS) {
-        ret_value = PDC_Server_send_nhits_to_client(task);
+    if (disable_query_cache_g == 1 || task->cache_key == NULL || task->query == NULL)
+        goto done;
+
+    sel = task->query->sel;
+
+    entry = (query_cache_entry_t *)calloc(1, sizeof(query_cache_entry_t));
+    if (NULL == entry) {
+        ret_value = FAIL;
+        goto done;
     }
-    else if (task->get_op == PDC_QUERY_GET_SEL) {
-        ret_value = PDC_Server_send_coords_to_client(task);
+    entry->key = malloc(task->cache_key_size);
+    if (NULL == entry->key) {
+        ret_value = FAIL;
+        goto done;
     }
-    else if (task->get_op == PDC_QUERY_GET_DATA) {
+    memcpy(entry->key, task->cache_key, task->cache_key_size);
+    entry->key_size   = task->cache_key_size;
+    entry->hash       = task->cache_hash;
+    entry->ndim       = task->ndim;
+    entry->total_elem = task->total_elem;
+    entry->nhits      = sel->nhits;
+
+    if (sel->nhits > 0 && sel->coords != NULL && sel->nhits * task->ndim <= PDC_QUERY_CACHE_MAX_COORDS) {
+        entry->coords = (uint64_t *)malloc(sel->nhits * task->ndim * sizeof(uint64_t));
+        if (entry->coords)
+            memcpy(entry->coords, sel->coords, sel->nhits * task->ndim * sizeof(uint64_t));
     }
-    else {
-        printf("==PDC_SERVER[%d]: %s - Invalid get_op type!\n", pdc_server_rank_g, __func__);
+
+    nleaf          = PDC_Server_plan_count_leaf(task->query);
+    entry->obj_ids = (uint64_t *)calloc(nleaf > 0 ? nleaf : 1, sizeof(uint64_t));
+    if (NULL == entry->obj_ids) {
         ret_value = FAIL;
         goto done;
     }
+    PDC_query_visit_leaf_with_cb_arg(task->query, PDC_Server_query_cache_add_obj, entry);
 
-    if (ret_value != SUCCEED) {
-        printf("==PDC_SERVER[%d]: %s - error sending query result to client!\n", pdc_server_rank_g, __func__);
-        goto done;
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&query_cache_mutex_g);
+#endif
+
+    // Replace an older result of the same query
+    DL_FOREACH(query_cache_head_g, elt)
+    {
+        if (elt->hash == entry->hash && elt->key_size == entry->key_size &&
+            memcmp(elt->key, entry->key, elt->key_size) == 0) {
+            DL_DELETE(query_cache_head_g, elt);
+            PDC_Server_query_cache_free_entry(elt);
+            query_cache_nentry_g--;
+            break;
+        }
+    }
+
+    if (query_cache_nentry_g >= PDC_QUERY_CACHE_MAX_ENTRY && query_cache_head_g != NULL) {
+        elt = query_cache_head_g->prev;
+        DL_DELETE(query_cache_head_g, elt);
+        PDC_Server_query_cache_free_entry(elt);
+        query_cache_nentry_g--;
     }
 
+    DL_PREPEND(query_cache_head_g, entry);
+    query_cache_nentry_g++;
+    entry = NULL;
+
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&query_cache_mutex_g);
+#endif
+
 done:
+    if (entry)
+        PDC_Server_query_cache_free_entry(entry);
+
     return ret_value;
 }
 
-static perr_t
-PDC_Server_send_query_result_to_manager(query_task_t *task)
+perr_t
+PDC_Server_query_cache_invalidate(uint64_t obj_id)
 {
-    perr_t ret_value = SUCCEED;
+    query_cache_entry_t *      entry, *tmp;
+    pdc_data_server_io_list_t *io_list_elt;
+    region_list_t *            region_elt;
+    int                        i;
 
-    if (task->get_op == PDC_QUERY_GET_NHITS) {
-        ret_value = PDC_Server_send_nhits_to_server(task);
-        if (ret_value != SUCCEED) {
-            printf("==PDC_SERVER[%d]: %s - error with PDC_Server_send_nhits_to_server!\n", pdc_server_rank_g,
-                   __func__);
-            goto done;
+    // Drop the region data loaded by previous queries, it is read again by the next query
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&data_read_list_mutex_g);
+#endif
+    DL_FOREACH(pdc_data_server_read_list_head_g, io_list_elt)
+    {
+        if (io_list_elt->obj_id != obj_id)
+            continue;
+        DL_FOREACH(io_list_elt->region_list_head, region_elt)
+        {
+            // Only the regions read by queries, client reads are served from shared memory
+            if (region_elt->access_type != PDC_READ || region_elt->is_data_ready != 1 ||
+                region_elt->shm_addr[0] != 0)
+                continue;
+            if (region_elt->buf) {
+                free(region_elt->buf);
+                region_elt->buf = NULL;
+            }
+            region_elt->is_data_ready = 0;
+            region_elt->is_io_done    = 0;
         }
     }
-    else if (task->get_op == PDC_QUERY_GET_SEL) {
-        ret_value = PDC_Server_send_coords_to_server(task);
-        if (ret_value != SUCCEED) {
-            printf("==PDC_SERVER[%d]: %s - error with PDC_Server_send_coords_to_server!\n", pdc_server_rank_g,
-                   __func__);
-            goto done;
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&data_read_list_mutex_g);
+#endif
+
+    if (query_cache_head_g == NULL)
+        return SUCCEED;
+
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&query_cache_mutex_g);
+#endif
+
+    DL_FOREACH_SAFE(query_cache_head_g, entry, tmp)
+    {
+        for (i = 0; i < entry->nobj; i++) {
+            if (entry->obj_ids[i] == obj_id) {
+                DL_DELETE(query_cache_head_g, entry);
+                PDC_Server_query_cache_free_entry(entry);
+                query_cache_nentry_g--;
+                break;
+            }
         }
     }
-    else {
-        printf("==PDC_SERVER[%d]: %s - Invalid get_op type!\n", pdc_server_rank_g, __func__);
-        ret_value = FAIL;
-        goto done;
-    }
 
-    // TODO: free the task_list at close time
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&query_cache_mutex_g);
+#endif
 
-    printf("==PDC_SERVER[%d]: sent query results to manager %d!\n", pdc_server_rank_g, task->manager);
-done:
-    fflush(stdout);
+    return SUCCEED;
+}
 
-    return ret_value;
+perr_t
+PDC_Server_query_cache_invalidate_all(uint64_t obj_id)
+{
+    hg_return_t                 hg_ret;
+    perr_t                      ret_value = SUCCEED;
+    int                         i;
+    query_cache_invalidate_in_t in;
+    hg_handle_t                 handle;
+
+    FUNC_ENTER(NULL);
+
+    PDC_Server_query_cache_invalidate(obj_id);
+
+    // Every server may have cached results or region data of the object from a previous query
+    in.obj_id = obj_id;
+    in.origin = pdc_server_rank_g;
+    for (i = 0; i < pdc_server_size_g; i++) {
+        if (i == pdc_server_rank_g || pdc_remote_server_info_g == NULL ||
+            pdc_remote_server_info_g[i].addr_valid != 1)
+            continue;
+
+        hg_ret = HG_Create(hg_context_g, pdc_remote_server_info_g[i].addr,
+                           query_cache_invalidate_rpc_register_id_g, &handle);
+        if (hg_ret != HG_SUCCESS) {
+            ret_value = FAIL;
+            continue;
+        }
+
+        hg_ret = HG_Forward(handle, NULL, NULL, &in);
+        if (hg_ret != HG_SUCCESS) {
+            fprintf(stderr, "==PDC_SERVER[%d]: %s - HG_Forward failed!\n", pdc_server_rank_g, __func__);
+            ret_value = FAIL;
+        }
+
+        HG_Destroy(handle);
+    }
+
+    FUNC_LEAVE(ret_value);
 }
 
 perr_t
@@ -9535,11 +10930,22 @@ PDC_Server_do_query(query_task_t *task)
     gettimeofday(&pdc_timer_start, 0);
 #endif
 
-    // Evaluate query
-    PDC_query_visit(task->query, PDC_Server_query_evaluate_merge_opt, task, NULL, PDC_QUERY_NONE);
+    // Reuse the result of an identical query if none of its objects has been written since
+    if (PDC_Server_query_cache_get(task) != 1) {
+        PDC_Server_plan_query(task);
 
-    // No need to store the coords for nhits
-    if (task->get_op == PDC_QUERY_GET_NHITS) {
+        // Evaluate query
+        if (task->plan_is_empty != 1)
+            PDC_query_visit(task->query, PDC_Server_query_evaluate_merge_opt, task, NULL, PDC_QUERY_NONE);
+
+        PDC_Server_query_cache_put(task);
+    }
+
+    if (task->get_op == PDC_QUERY_GET_AGG)
+        ret_value = PDC_Server_query_aggregate(task);
+
+    // No need to store the coords for nhits and aggregates
+    if (task->get_op == PDC_QUERY_GET_NHITS || task->get_op == PDC_QUERY_GET_AGG) {
         if (task->query && task->query->sel && task->query->sel->coords_alloc > 0 &&
             task->query->sel->coords) {
             free(task->query->sel->coords);
@@ -9566,6 +10972,7 @@ add_storage_region_to_buf(void **in_buf, uint64_t *buf_alloc, uint64_t *buf_off,
     perr_t   ret_value = SUCCEED;
     void *   buf       = *in_buf;
     uint64_t my_size, tmp_size;
+    uint32_t sketch_size;
 
     if (in_buf == NULL || *in_buf == NULL || region == NULL || buf_alloc == NULL || buf_off == NULL ||
         region->storage_location[0] == '\0') {
@@ -9577,10 +10984,15 @@ add_storage_region_to_buf(void **in_buf, uint64_t *buf_alloc, uint64_t *buf_off,
     if (region->region_hist != NULL) {
         my_size += (8 * (region->region_hist->nbin) * 3);
     }
+    sketch_size = region->region_sketch == NULL ? 0 : PDC_sketch_serialize_size(region->region_sketch);
+    my_size += sizeof(uint32_t) + sketch_size + sizeof(int32_t) + sizeof(uint64_t);
 
+    // A sketch can be larger than the initial buffer
     if (*buf_off + my_size + 1024 > *buf_alloc) {
-        (*buf_alloc) *= 2;
-        buf = realloc(buf, *buf_alloc);
+        while (*buf_off + my_size + 1024 > *buf_alloc)
+            (*buf_alloc) *= 2;
+        buf     = realloc(buf, *buf_alloc);
+        *in_buf = buf;
     }
 
     int *loc_len = (int *)(buf + *buf_off);
@@ -9613,6 +11025,12 @@ add_storage_region_to_buf(void **in_buf, uint64_t *buf_alloc, uint64_t *buf_off,
     *size          = region->data_size;
     (*buf_off) += sizeof(uint64_t);
 
+    // A compressed region is read and decompressed as a whole
+    memcpy(buf + *buf_off, &region->compress, sizeof(int32_t));
+    (*buf_off) += sizeof(int32_t);
+    memcpy(buf + *buf_off, &region->storage_size, sizeof(uint64_t));
+    (*buf_off) += sizeof(uint64_t);
+
     int *has_hist = (int *)(buf + *buf_off);
     if (region->region_hist != NULL) {
         *has_hist = 1;
@@ -9639,6 +11057,13 @@ add_storage_region_to_buf(void **in_buf, uint64_t *buf_alloc, uint64_t *buf_off,
         (*buf_off) += sizeof(int);
     }
 
+    memcpy(buf + *buf_off, &sketch_size, sizeof(uint32_t));
+    (*buf_off) += sizeof(uint32_t);
+    if (sketch_size > 0) {
+        PDC_sketch_serialize(region->region_sketch, buf + *buf_off);
+        (*buf_off) += sketch_size;
+    }
+
 done:
     return ret_value;
 }
@@ -9910,6 +11335,7 @@ PDC_recv_query_metadata_bulk(const struct hg_cb_info *callback_info)
     region_list_t *         regions = NULL;
     int                     i, nregion, *loc_len_ptr, *has_hist_ptr, found_task;
     uint64_t                buf_off, *offset_ptr = NULL, *size_ptr = NULL;
+    uint32_t                sketch_size;
     char *                  loc_ptr         = NULL;
     region_info_transfer_t *region_info_ptr = NULL;
     pdc_histogram_t *       hist_ptr        = NULL;
@@ -9968,6 +11394,11 @@ PDC_recv_query_metadata_bulk(const struct hg_cb_info *callback_info)
             regions[i].data_size = *size_ptr;
             buf_off += sizeof(uint64_t);
 
+            memcpy(&regions[i].compress, buf + buf_off, sizeof(int32_t));
+            buf_off += sizeof(int32_t);
+            memcpy(&regions[i].storage_size, buf + buf_off, sizeof(uint64_t));
+            buf_off += sizeof(uint64_t);
+
             has_hist_ptr = (int *)(buf + buf_off);
             buf_off += sizeof(int);
 
@@ -9993,6 +11424,13 @@ PDC_recv_query_metadata_bulk(const struct hg_cb_info *callback_info)
                 }
             }
 
+            memcpy(&sketch_size, buf + buf_off, sizeof(uint32_t));
+            buf_off += sizeof(uint32_t);
+            if (sketch_size > 0) {
+                regions[i].region_sketch = PDC_sketch_deserialize(buf + buf_off, sketch_size);
+                buf_off += sketch_size;
+            }
+
             if (buf_off > bulk_args->nbytes) {
                 printf("==PDC_SERVER[%d]: %s - ERROR! buf overflow %d! 3\n", pdc_server_rank_g, __func__, i);
                 fflush(stdout);
@@ -10133,6 +11571,13 @@ PDC_Server_recv_data_query(const struct hg_cb_info *callback_info)
     new_task->region_constraint = (region_list_t *)query->region_constraint;
     new_task->next_server_id    = query_xfer->next_server_id;
     new_task->prev_server_id    = query_xfer->prev_server_id;
+    new_task->agg_obj_id        = query_xfer->agg_obj_id;
+
+    if (disable_query_cache_g != 1 && new_task->cache_key == NULL) {
+        new_task->cache_key = PDC_Server_query_cache_key(query_xfer, &new_task->cache_key_size);
+        if (new_task->cache_key)
+            new_task->cache_hash = PDC_Server_query_cache_hash(new_task->cache_key, new_task->cache_key_size);
+    }
 
     if (is_debug_g == 1) {
         printf("==PDC_SERVER[%d]: %s - appended new query task %d to list head\n", pdc_server_rank_g,
@@ -10309,10 +11754,10 @@ PDC_Server_recv_read_sel_obj_data(const struct hg_cb_info *callback_info)
     hg_return_t             ret = HG_SUCCESS;
     get_sel_data_rpc_in_t * in  = (get_sel_data_rpc_in_t *)callback_info->arg;
     query_task_t *          task_elt, *task = NULL;
-    uint64_t                nhits, *coord, *coords = NULL, obj_id, buf_off, my_size, data_off, i;
+    uint64_t                nhits, *coords = NULL, obj_id, my_size;
     size_t                  ndim, unit_size;
     cache_storage_region_t *cache_region_elt;
-    region_list_t *         storage_region_head = NULL, *cache_region, *region_elt;
+    region_list_t *         storage_region_head = NULL;
     pdc_var_type_t          data_type;
 
     // find task
@@ -10366,25 +11811,7 @@ PDC_Server_recv_read_sel_obj_data(const struct hg_cb_info *callback_info)
     }
 
     // We will read task->coords, from obj_id
-    data_off = 0;
-    for (i = 0; i < nhits; i++) {
-        coord = &(coords[i * ndim]);
-        DL_FOREACH(storage_region_head, region_elt)
-        {
-            if (is_coord_in_region(ndim, coord, unit_size, region_elt) == 1) {
-                buf_off      = coord_to_offset(ndim, coord, region_elt->start, region_elt->count, unit_size);
-                cache_region = region_elt;
-                if (region_elt->io_cache_region != NULL)
-                    cache_region = region_elt->io_cache_region;
-                if (cache_region->is_io_done != 1) {
-                    PDC_Server_data_read_to_buf_1_region(cache_region);
-                }
-                memcpy(task->my_data + data_off, cache_region->buf + buf_off, unit_size);
-                data_off += unit_size;
-                break;
-            }
-        }
-    } // End for
+    PDC_Server_read_coords_data(storage_region_head, ndim, unit_size, coords, nhits, task->my_data);
 
     // Send read data back to client
     PDC_send_data_to_client(task->client_id, task->my_data, ndim, unit_size, nhits, task->query_id,
@@ -10456,3 +11883,158 @@ done:
         free(in);
     return ret;
 }
+
+static perr_t
+PDC_Server_send_cursor_batch_to_client(int client_id, int query_id, void *buf, uint64_t nbytes, uint64_t cnt,
+                                       uint32_t ndim, int data_type)
+{
+    perr_t        ret_value = SUCCEED;
+    hg_return_t   hg_ret;
+    hg_handle_t   handle;
+    hg_bulk_t     bulk_handle = NULL;
+    bulk_rpc_in_t in;
+    hg_size_t     buf_sizes;
+
+    FUNC_ENTER(NULL);
+
+    if (client_id >= pdc_client_num_g) {
+        printf("==PDC_SERVER[%d]: %s - client_id %d invalid!\n", pdc_server_rank_g, __func__, client_id);
+        ret_value = FAIL;
+        goto done;
+    }
+
+    if (pdc_client_info_g == NULL) {
+        fprintf(stderr, "==PDC_SERVER[%d]: %s - pdc_client_info_g is NULL\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
+
+    if (pdc_client_info_g[client_id].addr_valid == 0) {
+        ret_value = PDC_Server_lookup_client(client_id);
+        if (ret_value != SUCCEED) {
+            fprintf(stderr, "==PDC_SERVER[%d]: %s - PDC_Server_lookup_client failed!\n", pdc_server_rank_g,
+                    __func__);
+            ret_value = FAIL;
+            goto done;
+        }
+    }
+
+    if (cnt > 0) {
+        buf_sizes = nbytes;
+        hg_ret    = HG_Bulk_create(hg_class_g, 1, &buf, &buf_sizes, HG_BULK_READ_ONLY, &bulk_handle);
+        if (hg_ret != HG_SUCCESS) {
+            fprintf(stderr, "Could not create bulk data handle\n");
+            ret_value = FAIL;
+            goto done;
+        }
+    }
+
+    // An empty batch tells the client to move on to the next server
+    in.ndim        = ndim;
+    in.cnt         = cnt;
+    in.total       = nbytes;
+    in.seq_id      = query_id;
+    in.seq_id2     = 0;
+    in.obj_id      = 0;
+    in.data_type   = data_type;
+    in.origin      = pdc_server_rank_g;
+    in.op_id       = PDC_BULK_QUERY_CURSOR;
+    in.bulk_handle = bulk_handle;
+
+    hg_ret = HG_Create(hg_context_g, pdc_client_info_g[client_id].addr, send_bulk_rpc_register_id_g, &handle);
+    if (hg_ret != HG_SUCCESS) {
+        ret_value = FAIL;
+        goto done;
+    }
+
+    hg_ret = HG_Forward(handle, PDC_check_int_ret_cb, NULL, &in);
+    if (hg_ret != HG_SUCCESS) {
+        fprintf(stderr, "==PDC_SERVER[%d]: %s - HG_Forward failed!\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+    }
+    HG_Destroy(handle);
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+hg_return_t
+PDC_Server_recv_query_cursor(const struct hg_cb_info *callback_info)
+{
+    hg_return_t            ret = HG_SUCCESS;
+    query_cursor_rpc_in_t *in  = (query_cursor_rpc_in_t *)callback_info->arg;
+    query_task_t *         task_elt, *task = NULL;
+    region_list_t *        storage_region_head = NULL;
+    pdc_var_type_t         data_type           = PDC_UNKNOWN;
+    uint64_t               nhits = 0, cnt = 0, *coords = NULL, coords_size = 0, data_size = 0;
+    size_t                 ndim = 0, unit_size = 0;
+
+    DL_FOREACH(query_task_list_head_g, task_elt)
+    {
+        if (task_elt->query_id == in->query_id) {
+            task = task_elt;
+            break;
+        }
+    }
+
+    if (in->op == PDC_QUERY_CURSOR_CLOSE) {
+        if (NULL != task) {
+            DL_DELETE(query_task_list_head_g, task);
+            PDC_Server_free_query_task(task);
+        }
+        goto done;
+    }
+
+    // Servers that have no (more) local hits reply with an empty batch
+    if (NULL != task && NULL != task->query && NULL != task->query->sel) {
+        nhits = task->query->sel->nhits;
+        ndim  = task->ndim;
+    }
+    if (in->offset < nhits) {
+        cnt = nhits - in->offset;
+        if (cnt > in->count)
+            cnt = in->count;
+    }
+
+    if (cnt > 0) {
+        coords      = &(task->query->sel->coords[in->offset * ndim]);
+        coords_size = cnt * ndim * sizeof(uint64_t);
+
+        if (in->obj_id != 0) {
+            storage_region_head = PDC_Server_get_query_obj_storage_region(task, in->obj_id, &data_type);
+            if (NULL == storage_region_head)
+                printf("==PDC_SERVER[%d]: %s - cannot find storage region query_id=%d, obj_id=%" PRIu64 "\n",
+                       pdc_server_rank_g, __func__, in->query_id, in->obj_id);
+            else {
+                unit_size = PDC_get_var_type_size(data_type);
+                data_size = cnt * unit_size;
+            }
+        }
+
+        // The client has pulled the previous batch before asking for this one
+        if (task->cursor_buf)
+            free(task->cursor_buf);
+        task->cursor_buf = malloc(coords_size + data_size);
+        if (NULL == task->cursor_buf) {
+            printf("==PDC_SERVER[%d]: %s - error allocating %" PRIu64 " bytes for cursor batch!\n",
+                   pdc_server_rank_g, __func__, coords_size + data_size);
+            cnt = 0;
+        }
+        else {
+            memcpy(task->cursor_buf, coords, coords_size);
+            if (data_size > 0)
+                PDC_Server_read_coords_data(storage_region_head, ndim, unit_size, coords, cnt,
+                                            task->cursor_buf + coords_size);
+        }
+    }
+
+    PDC_Server_send_cursor_batch_to_client(in->origin, in->query_id, cnt > 0 ? task->cursor_buf : NULL,
+                                           coords_size + data_size, cnt, ndim, data_type);
+
+done:
+    fflush(stdout);
+    if (in)
+        free(in);
+
+    return ret;
+}
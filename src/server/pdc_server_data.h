@@ -37,6 +37,12 @@
 
 #define PDC_MAX_OVERLAP_REGION_NUM 8 // max number of regions for PDC_Server_get_storage_location_of_region()
 #define PDC_BULK_XFER_INIT_NALLOC  128
+#define PDC_QUERY_AGG_CHUNK        8192 // number of hits read at a time when aggregating a query result
+#define PDC_QUERY_INDEX_MAX_SEL    0.1  // use the index of a leaf only below this estimated selectivity
+
+#define PDC_QUERY_CACHE_MAX_ENTRY  64       // max number of query results kept by a server
+#define PDC_QUERY_CACHE_MAX_COORDS 1048576  // larger selections only have their number of hits cached
+#define PDC_READ_COORDS_LOAD_MAX   67108864 // regions up to this size are loaded whole to read selected coords
 
 /***************************/
 /* Library Private Structs */
@@ -188,6 +194,35 @@ typedef struct server_read_check_out_t {
     char *         shm_addr;
 } server_read_check_out_t;
 
+// Plan of one query leaf, estimated from the region histograms before evaluation
+typedef struct query_plan_leaf_t {
+    pdc_query_t *leaf;
+    uint64_t     total_elem;
+    uint64_t     est_min_hits;
+    uint64_t     est_max_hits;
+    uint64_t     est_hits; // from the sketches, or halfway between the bounds
+    double       selectivity;
+    int          use_index;
+    int          order; // evaluation order, 0 is evaluated first
+} query_plan_leaf_t;
+
+// Result of a data query evaluated by this server, reused by identical queries until one of the queried
+// objects is written
+typedef struct query_cache_entry_t {
+    uint64_t  hash;
+    void *    key; // canonical form of the query, see PDC_Server_query_cache_key()
+    size_t    key_size;
+    uint64_t *obj_ids;
+    int       nobj;
+    int       ndim;
+    uint64_t  total_elem;
+    uint64_t  nhits;
+    uint64_t *coords; // NULL when only the number of hits is cached
+
+    struct query_cache_entry_t *prev;
+    struct query_cache_entry_t *next;
+} query_cache_entry_t;
+
 // Data query
 typedef struct query_task_t {
     pdc_query_t *      query;
@@ -224,6 +259,25 @@ typedef struct query_task_t {
     void *    my_data;
     int       client_seq_id;
 
+    // Cursor, buffer of the last batch sent to the client
+    void *cursor_buf;
+
+    // Aggregation, partial result of this server or combined result on the manager
+    uint64_t agg_obj_id;
+    double   agg_sum;
+    double   agg_min;
+    double   agg_max;
+
+    // Plan, one entry per leaf of the query
+    query_plan_leaf_t *plan;
+    int                nplan;
+    int                plan_is_empty; // the histograms show that the query has no hits
+
+    // Result cache key
+    void *   cache_key;
+    size_t   cache_key_size;
+    uint64_t cache_hash;
+
     struct query_task_t *prev;
     struct query_task_t *next;
 } query_task_t;
@@ -280,6 +334,7 @@ extern int                       is_debug_g;
 extern int                       n_read_from_bb_g;
 extern int                       read_from_bb_size_g;
 extern int                       gen_hist_g;
+extern int                       gen_sketch_g;
 
 extern pdc_data_server_io_list_t * pdc_data_server_read_list_head_g;
 extern pdc_data_server_io_list_t * pdc_data_server_write_list_head_g;
@@ -304,11 +359,14 @@ extern hg_id_t get_storage_meta_name_query_bulk_result_rpc_register_id_g;
 extern hg_id_t notify_client_multi_io_complete_rpc_register_id_g;
 extern hg_id_t send_data_query_region_register_id_g;
 extern hg_id_t send_read_sel_obj_id_rpc_register_id_g;
+extern hg_id_t query_cache_invalidate_rpc_register_id_g;
 extern hg_id_t send_nhits_register_id_g;
 extern hg_id_t send_bulk_rpc_register_id_g;
 extern char *  gBinningOption;
 extern int     gen_fastbit_idx_g;
 extern int     use_fastbit_idx_g;
+extern int     query_plan_report_g;
+extern int     disable_query_cache_g;
 
 //#define PDC_SERVER_CACHE
 #undef PDC_SERVER_CACHE
@@ -373,6 +431,13 @@ region_buf_map_t *PDC_Data_Server_buf_map(const struct hg_info *info, buf_map_in
  */
 perr_t PDC_Data_Server_buf_unmap(const struct hg_info *info, buf_unmap_in_t *in);
 
+/**
+ * Unmap the shared memory of the clients on this node used by buf map
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_Server_buf_shm_finalize();
+
 /**
  * Server checks if unmap is done
  *
@@ -492,6 +557,25 @@ hg_return_t PDC_Server_count_write_check_update_storage_meta_cb(const struct hg_
 perr_t PDC_Server_data_write_out(uint64_t obj_id, struct pdc_region_info *region_info, void *buf,
                                  size_t unit);
 
+/**
+ * Drop the cached query results of this server that involve an object
+ *
+ * \param obj_id [IN]           Object ID
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_Server_query_cache_invalidate(uint64_t obj_id);
+
+/**
+ * Drop the cached query results that involve an object on this and all other servers, called once
+ * the write of the object has completed
+ *
+ * \param obj_id [IN]           Object ID
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_Server_query_cache_invalidate_all(uint64_t obj_id);
+
 /**
  * Read data from desired storage
  *
@@ -579,6 +663,16 @@ perr_t PDC_Server_write_check(data_server_write_check_in_t *in, data_server_writ
  */
 perr_t PDC_Server_update_local_region_storage_loc(region_list_t *region, uint64_t obj_id, int type);
 
+/**
+ * Merge the sketches of the storage regions of an object into the statistics of the object
+ *
+ * \param in [IN]               Input structure received from client, contains the object ID
+ * \param out [OUT]             Output structure with the serialized sketch, freed by the caller
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_Server_get_obj_stats(obj_get_stats_in_t *in, obj_get_stats_out_t *out);
+
 /**
  * Get metadata of the object ID received from client from local metadata hash table
  *
@@ -840,6 +934,18 @@ void PDC_print_hist(pdc_histogram_t *hist);
  */
 perr_t PDC_Server_update_region_storagelocation_offset(region_list_t *region, int type);
 
+/**
+ * Update the storage location information of a region of an object, for regions without the metadata
+ * of their object
+ *
+ * \param region [IN]           Region to update
+ * \param obj_id [IN]           ID of the object of the region
+ * \param type [IN]             PDC_UPDATE_STORAGE or PDC_UPDATE_CACHE
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_Server_update_obj_region_storage_loc(region_list_t *region, uint64_t obj_id, int type);
+
 /**
  * ********
  *
@@ -912,6 +1018,16 @@ hg_return_t PDC_recv_read_coords(const struct hg_cb_info *callback_info);
  */
 hg_return_t PDC_Server_recv_read_sel_obj_data(const struct hg_cb_info *callback_info);
 
+/**
+ * Serve a query cursor request from a client, either send the next batch of the local selection
+ * (and its data) or release the query result
+ *
+ * \param callback_info [IN]    Mercury callback info
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+hg_return_t PDC_Server_recv_query_cursor(const struct hg_cb_info *callback_info);
+
 #ifdef ENABLE_FASTBIT
 /**
  * *******
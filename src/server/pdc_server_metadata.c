@@ -34,6 +34,8 @@
 #include <fcntl.h>
 #include <inttypes.h>
 #include <math.h>
+#include <errno.h>
+#include <dirent.h>
 
 #ifdef ENABLE_RADOS
 #include <rados/librados.h>
@@ -47,19 +49,12 @@
 
 #include "pdc_utlist.h"
 #include "pdc_hash-table.h"
-#include "pdc_dablooms.h"
+#include "pdc_bloom.h"
 #include "pdc_interface.h"
 #include "pdc_client_server_common.h"
 #include "pdc_server_metadata.h"
 #include "pdc_server.h"
 
-#define BLOOM_TYPE_T counting_bloom_t
-#define BLOOM_NEW    new_counting_bloom
-#define BLOOM_CHECK  counting_bloom_check
-#define BLOOM_ADD    counting_bloom_add
-#define BLOOM_REMOVE counting_bloom_remove
-#define BLOOM_FREE   free_counting_bloom
-
 #ifdef ENABLE_RADOS
 // Global Variables for Ceph
 rados_t       cluster;
@@ -67,13 +62,16 @@ rados_ioctx_t io;
 const char *  poolname;
 #endif
 
-// Global hash table for storing metadata
-HashTable *metadata_hash_table_g  = NULL;
+// Global hash table for storing containers
 HashTable *container_hash_table_g = NULL;
 
+// Metadata hash table shards, each with its own lock and name bloom filter
+static pdc_metadata_shard_t metadata_shard_g[PDC_METADATA_N_SHARD];
+
 // Debug statistics var
 int      n_bloom_total_g            = 0;
 int      n_bloom_maybe_g            = 0;
+int      n_bloom_false_pos_g        = 0;
 double   server_bloom_check_time_g  = 0.0;
 double   server_bloom_insert_time_g = 0.0;
 double   server_insert_time_g       = 0.0;
@@ -83,6 +81,20 @@ double   server_hash_insert_time_g  = 0.0;
 double   server_bloom_init_time_g   = 0.0;
 uint32_t n_metadata_g               = 0;
 
+// Metadata write-ahead log, records are buffered and written out by PDC_Server_metadata_log_sync()
+static int      metadata_log_fd_g        = -1;
+static int      metadata_log_first_gen_g = 0;
+static int      metadata_log_gen_g       = 0;
+static int      metadata_log_replay_g    = 0;
+static int      metadata_log_dirty_g     = 0;
+static char *   metadata_log_buf_g       = NULL;
+static size_t   metadata_log_buf_size_g  = 0;
+static size_t   metadata_log_buf_alloc_g = 0;
+static uint64_t metadata_log_file_size_g = 0;
+// Responses waiting for the next sync of the log
+static pdc_metadata_log_ack_t *metadata_log_ack_head_g = NULL;
+static pdc_metadata_log_ack_t *metadata_log_ack_tail_g = NULL;
+
 pbool_t
 PDC_region_is_identical(region_info_transfer_t reg1, region_info_transfer_t reg2)
 {
@@ -113,46 +125,6 @@ done:
     FUNC_LEAVE(ret_value);
 }
 
-/*
- * Check if two hash keys are equal
- *
- * \param vlocation1 [IN]       Hash table key
- * \param vlocation2 [IN]       Hash table key
- *
- * \return 1 if two keys are equal, 0 otherwise
- */
-static int
-PDC_Server_metadata_int_equal(void *vlocation1, void *vlocation2)
-{
-    return *((uint32_t *)vlocation1) == *((uint32_t *)vlocation2);
-}
-
-/*
- * Get hash key's location in hash table
- *
- * \param vlocation [IN]        Hash table key
- *
- * \return the location of hash key in the table
- */
-static unsigned int
-PDC_Server_metadata_int_hash(void *vlocation)
-{
-    return *((uint32_t *)vlocation);
-}
-
-/*
- * Free the hash key
- *
- * \param  key [IN]        Hash table key
- *
- * \return void
- */
-static void
-PDC_Server_metadata_int_hash_key_free(void *key)
-{
-    free((uint32_t *)key);
-}
-
 /*
  * Free metadata hash value
  *
@@ -170,11 +142,6 @@ PDC_Server_metadata_hash_value_free(void *value)
 
     head = (pdc_hash_table_entry_head *)value;
 
-    // Free bloom filter
-    if (head->bloom != NULL) {
-        BLOOM_FREE(head->bloom);
-    }
-
     // Free metadata list
     if (is_restart_g == 0) {
         DL_FOREACH_SAFE(head->metadata, elt, tmp)
@@ -213,10 +180,10 @@ PDC_Server_metadata_init(pdc_metadata_t *a)
 
     FUNC_ENTER(NULL);
 
-    a->user_id     = 0;
-    a->time_step   = 0;
-    a->app_name[0] = 0;
-    a->obj_name[0] = 0;
+    a->user_id   = 0;
+    a->time_step = 0;
+    a->app_name  = "";
+    a->obj_name  = "";
 
     a->obj_id  = 0;
     a->cont_id = 0;
@@ -226,8 +193,8 @@ PDC_Server_metadata_init(pdc_metadata_t *a)
 
     a->create_time        = 0;
     a->last_modified_time = 0;
-    a->tags[0]            = 0;
-    a->data_location[0]   = 0;
+    a->tags               = "";
+    a->data_location      = "";
 
     a->region_lock_head    = NULL;
     a->region_map_head     = NULL;
@@ -254,6 +221,20 @@ combine_obj_info_to_string(pdc_metadata_t *metadata, char *output)
     snprintf(output, TAG_LEN_MAX, "%s%d", metadata->obj_name, metadata->time_step);
 }
 
+/*
+ * Check if the name bloom filter can answer for a metadata, PDC_metadata_cmp() matches any name when it is
+ * empty and any time step when it is negative, which the filter keys cannot express
+ *
+ * \param  metadata [IN]        PDC metadata structure pointer
+ *
+ * \return 1 if the filter can be used/0 otherwise
+ */
+static inline int
+PDC_Server_name_bloom_usable(pdc_metadata_t *metadata)
+{
+    return metadata->obj_name != NULL && metadata->obj_name[0] != '\0' && metadata->time_step >= 0;
+}
+
 /*
  * Get the metadata with obj ID from the metadata list
  *
@@ -293,20 +274,20 @@ find_metadata_by_id(uint64_t obj_id)
     pdc_metadata_t *           ret_value = NULL;
     pdc_hash_table_entry_head *head;
     pdc_metadata_t *           elt;
-    HashTableIterator          hash_table_iter;
+    pdc_metadata_table_iter_t  hash_table_iter;
     HashTablePair              pair;
     int                        n_entry;
 
     FUNC_ENTER(NULL);
 
-    if (metadata_hash_table_g != NULL) {
+    if (is_hash_table_init_g == 1) {
         // Since we only have the obj id, need to iterate the entire hash table
-        n_entry = hash_table_num_entries(metadata_hash_table_g);
-        hash_table_iterate(metadata_hash_table_g, &hash_table_iter);
+        n_entry = PDC_Server_metadata_table_num_entries();
+        PDC_Server_metadata_table_iterate(&hash_table_iter);
 
-        while (n_entry != 0 && hash_table_iter_has_more(&hash_table_iter)) {
+        while (n_entry != 0 && PDC_Server_metadata_table_iter_has_more(&hash_table_iter)) {
 
-            pair = hash_table_iter_next(&hash_table_iter);
+            pair = PDC_Server_metadata_table_iter_next(&hash_table_iter);
             head = pair.value;
             // Now iterate the list under this entry
             DL_FOREACH(head->metadata, elt)
@@ -316,9 +297,9 @@ find_metadata_by_id(uint64_t obj_id)
                 }
             }
         }
-    } // if (metadata_hash_table_g != NULL)
+    } // if (is_hash_table_init_g == 1)
     else {
-        printf("==PDC_SERVER: metadata_hash_table_g not initialized!\n");
+        printf("==PDC_SERVER: metadata hash table not initialized!\n");
         goto done;
     }
 
@@ -348,6 +329,7 @@ PDC_Server_has_metadata(pdcid_t obj_id)
 
 /*
  * Find if there is identical metadata exist in hash table
+ * Called with the mutex of the shard of the entry held
  *
  * \param  entry[IN]        Hash table entry of metadata
  * \param  a[IN]            Pointer to metadata to be checked against
@@ -357,73 +339,57 @@ PDC_Server_has_metadata(pdcid_t obj_id)
 static pdc_metadata_t *
 find_identical_metadata(pdc_hash_table_entry_head *entry, pdc_metadata_t *a)
 {
-    pdc_metadata_t *ret_value = NULL;
-    BLOOM_TYPE_T *  bloom;
-    int             bloom_check;
-    char            combined_string[TAG_LEN_MAX];
-    pdc_metadata_t *elt;
+    pdc_metadata_t *      ret_value   = NULL;
+    int                   bloom_check = -1;
+    char                  combined_string[TAG_LEN_MAX];
+    pdc_metadata_t *      elt;
+    pdc_metadata_shard_t *shard = entry->shard;
 
     FUNC_ENTER(NULL);
 
-    // Use bloom filter to quick check if current metadata is in the list
-    if (entry->bloom != NULL && a->user_id != 0 && a->app_name[0] != 0) {
-        bloom = entry->bloom;
-        combine_obj_info_to_string(a, combined_string);
-
 #ifdef ENABLE_TIMING
-        struct timeval pdc_timer_start;
-        struct timeval pdc_timer_end;
-        double         ht_total_sec;
+    struct timeval pdc_timer_start;
+    struct timeval pdc_timer_end;
+    double         ht_total_sec;
 
-        gettimeofday(&pdc_timer_start, 0);
+    gettimeofday(&pdc_timer_start, 0);
 #endif
 
-        bloom_check = BLOOM_CHECK(bloom, combined_string, strlen(combined_string));
+    // Use bloom filter to quick check if current metadata is in the list
+    if (shard->name_bloom != NULL && PDC_Server_name_bloom_usable(a)) {
+        combine_obj_info_to_string(a, combined_string);
+        bloom_check = PDC_bloom_check(shard->name_bloom, combined_string, strlen(combined_string));
+        shard->n_bloom_total++;
+        if (bloom_check != 0)
+            shard->n_bloom_maybe++;
+    }
 
 #ifdef ENABLE_TIMING
-        gettimeofday(&pdc_timer_end, 0);
-        ht_total_sec = PDC_get_elapsed_time_double(&pdc_timer_start, &pdc_timer_end);
+    gettimeofday(&pdc_timer_end, 0);
+    ht_total_sec = PDC_get_elapsed_time_double(&pdc_timer_start, &pdc_timer_end);
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&pdc_bloom_time_mutex_g);
 #endif
-
+    server_bloom_check_time_g += ht_total_sec;
 #ifdef ENABLE_MULTITHREAD
-        hg_thread_mutex_lock(&pdc_bloom_time_mutex_g);
+    hg_thread_mutex_unlock(&pdc_bloom_time_mutex_g);
 #endif
-
-#ifdef ENABLE_TIMING
-        server_bloom_check_time_g += ht_total_sec;
 #endif
 
-#ifdef ENABLE_MULTITHREAD
-        hg_thread_mutex_unlock(&pdc_bloom_time_mutex_g);
-#endif
+    if (bloom_check == 0)
+        goto done;
 
-        n_bloom_total_g++;
-        if (bloom_check == 0) {
-            ret_value = NULL;
+    // bloom filter says maybe or has not been checked, so need to check entire list
+    DL_FOREACH(entry->metadata, elt)
+    {
+        if (PDC_metadata_cmp(elt, a) == 0) {
+            ret_value = elt;
             goto done;
         }
-        else {
-            // bloom filter says maybe, so need to check entire list
-            n_bloom_maybe_g++;
-            DL_FOREACH(entry->metadata, elt)
-            {
-                if (PDC_metadata_cmp(elt, a) == 0) {
-                    ret_value = elt;
-                    goto done;
-                }
-            }
-        }
     }
-    else {
-        // Bloom has not been created
-        DL_FOREACH(entry->metadata, elt)
-        {
-            if (PDC_metadata_cmp(elt, a) == 0) {
-                ret_value = elt;
-                goto done;
-            }
-        }
-    } // if bloom==NULL
+
+    if (bloom_check == 1)
+        shard->n_bloom_false_pos++;
 
 done:
     FUNC_LEAVE(ret_value);
@@ -454,30 +420,80 @@ PDC_Server_gen_obj_id()
     FUNC_LEAVE(ret_value);
 }
 
+/*
+ * Allocate a range of consecutive object IDs
+ *
+ * \param  n[IN]            Number of IDs
+ *
+ * \return 64-bit integer of the first object ID of the range
+ */
+static uint64_t
+PDC_Server_gen_obj_id_range(uint32_t n)
+{
+    uint64_t ret_value;
+
+    FUNC_ENTER(NULL);
+
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&gen_obj_id_mutex_g);
+#endif
+
+    ret_value = pdc_id_seq_g;
+    pdc_id_seq_g += n;
+
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&gen_obj_id_mutex_g);
+#endif
+
+    FUNC_LEAVE(ret_value);
+}
+
 perr_t
 PDC_Server_init_hash_table()
 {
-    perr_t ret_value = SUCCEED;
+    perr_t                ret_value = SUCCEED;
+    pdc_metadata_shard_t *shard;
+    uint64_t              bloom_capacity;
+    int                   i;
 
     FUNC_ENTER(NULL);
 
-    // Metadata hash table
-    metadata_hash_table_g = hash_table_new(PDC_Server_metadata_int_hash, PDC_Server_metadata_int_equal);
-    if (metadata_hash_table_g == NULL) {
-        printf("==PDC_SERVER: metadata_hash_table_g init error! Exit...\n");
-        goto done;
+    // Each shard gets an equal part of the name bloom filter capacity, it grows with the number of objects
+    bloom_capacity = name_bloom_capacity_g / PDC_METADATA_N_SHARD;
+    if (bloom_capacity < 1024)
+        bloom_capacity = 1024;
+
+    // Metadata hash table shards
+    for (i = 0; i < PDC_METADATA_N_SHARD; i++) {
+        shard = &metadata_shard_g[i];
+        memset(shard, 0, sizeof(pdc_metadata_shard_t));
+        shard->table = hash_table_new_uint32();
+        if (shard->table == NULL) {
+            printf("==PDC_SERVER: metadata hash table init error! Exit...\n");
+            ret_value = FAIL;
+            goto done;
+        }
+        hash_table_register_free_functions(shard->table, NULL, PDC_Server_metadata_hash_value_free);
+#ifdef ENABLE_MULTITHREAD
+        hg_thread_mutex_init(&shard->mutex);
+#endif
+
+        // Name bloom filter
+        if (disable_name_bloom_g != 1) {
+            shard->name_bloom = PDC_bloom_new(bloom_capacity);
+            if (shard->name_bloom == NULL)
+                printf("==PDC_SERVER[%d]: name bloom filter init error, lookups walk the hash chains\n",
+                       pdc_server_rank_g);
+        }
     }
-    hash_table_register_free_functions(metadata_hash_table_g, PDC_Server_metadata_int_hash_key_free,
-                                       PDC_Server_metadata_hash_value_free);
 
     // Container hash table
-    container_hash_table_g = hash_table_new(PDC_Server_metadata_int_hash, PDC_Server_metadata_int_equal);
+    container_hash_table_g = hash_table_new_uint32();
     if (container_hash_table_g == NULL) {
         printf("==PDC_SERVER: container_hash_table_g init error! Exit...\n");
         goto done;
     }
-    hash_table_register_free_functions(container_hash_table_g, PDC_Server_metadata_int_hash_key_free,
-                                       PDC_Server_container_hash_value_free);
+    hash_table_register_free_functions(container_hash_table_g, NULL, PDC_Server_container_hash_value_free);
 
     is_hash_table_init_g = 1;
 
@@ -485,92 +501,191 @@ done:
     FUNC_LEAVE(ret_value);
 }
 
+int
+PDC_Server_metadata_shard_index(uint32_t hash_key)
+{
+    // The chain of an entry comes from the low bits of the hash value, the shard from the high bits of its
+    // product with a large odd constant, so entries of a shard still spread over the chains of the shard
+    return (int)((hash_key * 2654435761U) >> (32 - PDC_METADATA_SHARD_BITS));
+}
+
+pdc_metadata_shard_t *
+PDC_Server_metadata_shard(uint32_t hash_key)
+{
+    return &metadata_shard_g[PDC_Server_metadata_shard_index(hash_key)];
+}
+
+void
+PDC_Server_metadata_table_lock(uint32_t shard_mask)
+{
+#ifdef ENABLE_MULTITHREAD
+    int i;
+
+    // Shards are always locked in the same order, so two threads locking several shards cannot deadlock
+    for (i = 0; i < PDC_METADATA_N_SHARD; i++) {
+        if (shard_mask & (1U << i))
+            hg_thread_mutex_lock(&metadata_shard_g[i].mutex);
+    }
+#else
+    (void)shard_mask;
+#endif
+}
+
+void
+PDC_Server_metadata_table_unlock(uint32_t shard_mask)
+{
+#ifdef ENABLE_MULTITHREAD
+    int i;
+
+    for (i = PDC_METADATA_N_SHARD - 1; i >= 0; i--) {
+        if (shard_mask & (1U << i))
+            hg_thread_mutex_unlock(&metadata_shard_g[i].mutex);
+    }
+#else
+    (void)shard_mask;
+#endif
+}
+
+pdc_hash_table_entry_head *
+PDC_Server_metadata_table_lookup(uint32_t *hash_key)
+{
+    return hash_table_lookup(PDC_Server_metadata_shard(*hash_key)->table, hash_key);
+}
+
+int
+PDC_Server_metadata_table_remove(uint32_t *hash_key)
+{
+    return hash_table_remove(PDC_Server_metadata_shard(*hash_key)->table, hash_key);
+}
+
+unsigned int
+PDC_Server_metadata_table_num_entries()
+{
+    unsigned int ret_value = 0;
+    int          i;
+
+    for (i = 0; i < PDC_METADATA_N_SHARD; i++) {
+        if (metadata_shard_g[i].table != NULL)
+            ret_value += hash_table_num_entries(metadata_shard_g[i].table);
+    }
+
+    return ret_value;
+}
+
 /*
- * Remove a metadata from bloom filter
+ * Move a metadata hash table iteration to the next shard that has entries left
  *
- * \param  metadata[IN]     Metadata pointer of the remove target
- * \param  bloom[IN]        Bloom filter's pointer
+ * \param  iter[IN]         Pointer to the iterator
  *
- * \return Non-negative on success/Negative on failure
+ * \return void
  */
-static perr_t
-PDC_Server_remove_from_bloom(pdc_metadata_t *metadata, BLOOM_TYPE_T *bloom)
+static void
+PDC_Server_metadata_table_iter_skip(pdc_metadata_table_iter_t *iter)
 {
-    perr_t ret_value = SUCCEED;
+    while (!hash_table_iter_has_more(&iter->iter) && iter->shard < PDC_METADATA_N_SHARD - 1) {
+        iter->shard++;
+        hash_table_iterate(metadata_shard_g[iter->shard].table, &iter->iter);
+    }
+}
 
-    FUNC_ENTER(NULL);
+void
+PDC_Server_metadata_table_iterate(pdc_metadata_table_iter_t *iter)
+{
+    iter->shard = 0;
+    hash_table_iterate(metadata_shard_g[0].table, &iter->iter);
+    PDC_Server_metadata_table_iter_skip(iter);
+}
 
-    if (bloom == NULL) {
-        printf("==PDC_SERVER: PDC_Server_remove_from_bloom(): bloom pointer is NULL\n");
-        ret_value = FAIL;
-        goto done;
-    }
+int
+PDC_Server_metadata_table_iter_has_more(pdc_metadata_table_iter_t *iter)
+{
+    return hash_table_iter_has_more(&iter->iter);
+}
 
-    char combined_string[TAG_LEN_MAX];
-    combine_obj_info_to_string(metadata, combined_string);
+HashTablePair
+PDC_Server_metadata_table_iter_next(pdc_metadata_table_iter_t *iter)
+{
+    HashTablePair pair;
 
-    ret_value = BLOOM_REMOVE(bloom, combined_string, strlen(combined_string));
-    if (ret_value != SUCCEED) {
-        printf("==PDC_SERVER[%d]: PDC_Server_remove_from_bloom() - error\n", pdc_server_rank_g);
-        goto done;
-    }
+    pair = hash_table_iter_next(&iter->iter);
+    PDC_Server_metadata_table_iter_skip(iter);
 
-done:
-    FUNC_LEAVE(ret_value);
+    return pair;
+}
+
+void
+PDC_Server_metadata_table_free()
+{
+    int i;
+
+    for (i = 0; i < PDC_METADATA_N_SHARD; i++) {
+        if (metadata_shard_g[i].table == NULL)
+            continue;
+        hash_table_free(metadata_shard_g[i].table);
+        metadata_shard_g[i].table = NULL;
+#ifdef ENABLE_MULTITHREAD
+        hg_thread_mutex_destroy(&metadata_shard_g[i].mutex);
+#endif
+    }
 }
 
 /*
- * Add a metadata to bloom filter
+ * Add the name and time step of a metadata to the name bloom filter of a shard
+ * Called with the mutex of the shard held
  *
+ * \param  shard[IN]        Shard of the metadata
  * \param  metadata[IN]     Metadata pointer of the target
- * \param  bloom[IN]        Bloom filter's pointer
  *
- * \return Non-negative on success/Negative on failure
+ * \return void
  */
-static perr_t
-PDC_Server_add_to_bloom(pdc_metadata_t *metadata, BLOOM_TYPE_T *bloom)
+static void
+PDC_Server_name_bloom_add(pdc_metadata_shard_t *shard, pdc_metadata_t *metadata)
 {
-    perr_t ret_value = SUCCEED;
-    char   combined_string[TAG_LEN_MAX];
+    char combined_string[TAG_LEN_MAX];
 
     FUNC_ENTER(NULL);
 
-    if (bloom == NULL) {
+    if (shard->name_bloom == NULL)
         goto done;
-    }
 
-    combine_obj_info_to_string(metadata, combined_string);
-
-    ret_value = BLOOM_ADD(bloom, combined_string, strlen(combined_string));
-    if (ret_value != SUCCEED) {
-        printf("==PDC_SERVER[%d]: PDC_Server_add_to_bloom() - error \n", pdc_server_rank_g);
+    if (!PDC_Server_name_bloom_usable(metadata)) {
+        // Lookups could match this object without its key, so the filter cannot rule out any name
+        printf("==PDC_SERVER[%d]: %s - object %" PRIu64 " has no name or time step, "
+               "disable name bloom filter\n",
+               pdc_server_rank_g, __func__, metadata->obj_id);
+        PDC_bloom_free(shard->name_bloom);
+        shard->name_bloom = NULL;
         goto done;
     }
 
+    combine_obj_info_to_string(metadata, combined_string);
+    PDC_bloom_add(shard->name_bloom, combined_string, strlen(combined_string));
+
 done:
-    FUNC_LEAVE(ret_value);
+    FUNC_LEAVE_VOID;
 }
 
 /*
- * Init a bloom filter
+ * Rebuild the name bloom filter of a shard from the hash table of the shard
+ * Called with the mutex of the shard held
  *
- * \param  entry[IN]     Entry of the metadata hash table
+ * \param  shard[IN]        Shard to rebuild the filter of
+ * \param  capacity[IN]     Number of names the new filter is sized for
  *
  * \return Non-negative on success/Negative on failure
  */
 static perr_t
-PDC_Server_bloom_init(pdc_hash_table_entry_head *entry)
+PDC_Server_name_bloom_rebuild(pdc_metadata_shard_t *shard, uint64_t capacity)
 {
-    perr_t ret_value  = 0;
-    int    capacity   = 500000;
-    double error_rate = 0.05;
+    perr_t                     ret_value = SUCCEED;
+    pdc_bloom_t *              old_bloom;
+    HashTableIterator          hash_table_iter;
+    HashTablePair              pair;
+    pdc_hash_table_entry_head *head;
+    pdc_metadata_t *           elt;
 
     FUNC_ENTER(NULL);
 
-    // Init bloom filter
-    n_bloom_maybe_g = 0;
-    n_bloom_total_g = 0;
-
 #ifdef ENABLE_TIMING
     // Timing
     struct timeval pdc_timer_start;
@@ -580,73 +695,178 @@ PDC_Server_bloom_init(pdc_hash_table_entry_head *entry)
     gettimeofday(&pdc_timer_start, 0);
 #endif
 
-    entry->bloom = (BLOOM_TYPE_T *)BLOOM_NEW(capacity, error_rate);
-    if (!entry->bloom) {
-        fprintf(stderr, "ERROR: Could not create bloom filter\n");
-        ret_value = -1;
+    old_bloom         = shard->name_bloom;
+    shard->name_bloom = PDC_bloom_new(capacity);
+    if (shard->name_bloom == NULL) {
+        printf("==PDC_SERVER[%d]: %s - cannot create bloom filter of %" PRIu64 " names\n", pdc_server_rank_g,
+               __func__, capacity);
+        shard->name_bloom = old_bloom;
+        ret_value         = FAIL;
         goto done;
     }
+    PDC_bloom_free(old_bloom);
+
+    if (hash_table_num_entries(shard->table) != 0) {
+        hash_table_iterate(shard->table, &hash_table_iter);
+        while (shard->name_bloom != NULL && hash_table_iter_has_more(&hash_table_iter)) {
+            pair = hash_table_iter_next(&hash_table_iter);
+            head = pair.value;
+            DL_FOREACH(head->metadata, elt)
+            {
+                PDC_Server_name_bloom_add(shard, elt);
+            }
+        }
+    }
+    shard->name_bloom_n_del = 0;
+    shard->name_bloom_n_rebuild++;
 
 #ifdef ENABLE_TIMING
     // Timing
     gettimeofday(&pdc_timer_end, 0);
     ht_total_sec = PDC_get_elapsed_time_double(&pdc_timer_start, &pdc_timer_end);
 
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&pdc_bloom_time_mutex_g);
+#endif
     server_bloom_init_time_g += ht_total_sec;
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&pdc_bloom_time_mutex_g);
+#endif
 #endif
 
 done:
     FUNC_LEAVE(ret_value);
 }
 
-perr_t
-PDC_Server_hash_table_list_insert(pdc_hash_table_entry_head *head, pdc_metadata_t *new)
+/*
+ * Account for a metadata removed from the hash table, its key stays in the name bloom filter until the
+ * next rebuild
+ * Called with the mutex of the shard held
+ *
+ * \param  head[IN]         Hash table entry of the remove target
+ * \param  metadata[IN]     Metadata pointer of the remove target
+ *
+ * \return void
+ */
+static void
+PDC_Server_name_bloom_remove(pdc_hash_table_entry_head *head, pdc_metadata_t *metadata)
 {
-    perr_t          ret_value = SUCCEED;
-    pdc_metadata_t *elt;
-
     FUNC_ENTER(NULL);
 
-    // add to bloom filter
-    if (head->n_obj == CREATE_BLOOM_THRESHOLD) {
-        PDC_Server_bloom_init(head);
-        DL_FOREACH(head->metadata, elt)
-        {
-            PDC_Server_add_to_bloom(elt, head->bloom);
-        }
-        ret_value = PDC_Server_add_to_bloom(new, head->bloom);
-        if (ret_value != SUCCEED) {
-            printf("==PDC_SERVER[%d]: PDC_Server_hash_table_list_insert() - error add to bloom\n",
-                   pdc_server_rank_g);
-            goto done;
-        }
-    }
-    else if (head->n_obj >= CREATE_BLOOM_THRESHOLD || head->bloom != NULL) {
-        ret_value = PDC_Server_add_to_bloom(new, head->bloom);
-        if (ret_value != SUCCEED) {
-            printf("==PDC_SERVER[%d]: PDC_Server_hash_table_list_insert() - error add to bloom\n",
-                   pdc_server_rank_g);
-            goto done;
-        }
-    }
+    if (head->shard->name_bloom != NULL && PDC_Server_name_bloom_usable(metadata))
+        head->shard->name_bloom_n_del++;
 
-#ifdef ENABLE_MULTITHREAD
-    hg_thread_mutex_lock(&insert_hash_table_mutex_g);
-#endif
-    // Currently $metadata is unique, insert to linked list
-    DL_APPEND(head->metadata, new);
-    head->n_obj++;
+    FUNC_LEAVE_VOID;
+}
 
-#ifdef ENABLE_MULTITHREAD
-    hg_thread_mutex_unlock(&insert_hash_table_mutex_g);
-#endif
+/*
+ * Add the key of a metadata whose time step changed to the name bloom filter
+ * Called with the mutex of the shard held
+ *
+ * \param  head[IN]         Hash table entry of the target
+ * \param  metadata[IN]     Metadata pointer of the target
+ *
+ * \return void
+ */
+static void
+PDC_Server_name_bloom_update(pdc_hash_table_entry_head *head, pdc_metadata_t *metadata)
+{
+    FUNC_ENTER(NULL);
 
-done:
+    PDC_Server_name_bloom_add(head->shard, metadata);
 
-    FUNC_LEAVE(ret_value);
+    FUNC_LEAVE_VOID;
 }
 
-perr_t
+/*
+ * Sum the name bloom filter lookup statistics of all shards
+ *
+ * \return void
+ */
+static void
+PDC_Server_name_bloom_sum_stats()
+{
+    int i;
+
+    n_bloom_total_g     = 0;
+    n_bloom_maybe_g     = 0;
+    n_bloom_false_pos_g = 0;
+    for (i = 0; i < PDC_METADATA_N_SHARD; i++) {
+        n_bloom_total_g += metadata_shard_g[i].n_bloom_total;
+        n_bloom_maybe_g += metadata_shard_g[i].n_bloom_maybe;
+        n_bloom_false_pos_g += metadata_shard_g[i].n_bloom_false_pos;
+    }
+}
+
+perr_t
+PDC_Server_name_bloom_finalize()
+{
+    perr_t ret_value = SUCCEED;
+    int    n_stat[4], all_stat[4];
+    int    i;
+
+    FUNC_ENTER(NULL);
+
+    PDC_Server_name_bloom_sum_stats();
+    n_stat[0] = n_bloom_total_g;
+    n_stat[1] = n_bloom_total_g - n_bloom_maybe_g;
+    n_stat[2] = n_bloom_false_pos_g;
+    n_stat[3] = 0;
+    for (i = 0; i < PDC_METADATA_N_SHARD; i++)
+        n_stat[3] += metadata_shard_g[i].name_bloom_n_rebuild;
+#ifdef ENABLE_MPI
+    MPI_Reduce(n_stat, all_stat, 4, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+#else
+    memcpy(all_stat, n_stat, sizeof(n_stat));
+#endif
+
+    if (pdc_server_rank_g == 0 && all_stat[0] > 0) {
+        printf("==PDC_SERVER[0]: Name bloom filter checked %d lookups, %d skipped the hash chains, "
+               "%d false positives, %d rebuilds\n",
+               all_stat[0], all_stat[1], all_stat[2], all_stat[3]);
+    }
+
+    for (i = 0; i < PDC_METADATA_N_SHARD; i++) {
+        PDC_bloom_free(metadata_shard_g[i].name_bloom);
+        metadata_shard_g[i].name_bloom = NULL;
+    }
+
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDC_Server_hash_table_list_insert(pdc_hash_table_entry_head *head, pdc_metadata_t *new)
+{
+    perr_t                ret_value = SUCCEED;
+    pdc_metadata_shard_t *shard     = head->shard;
+
+    FUNC_ENTER(NULL);
+
+    // Currently $metadata is unique, insert to linked list, the caller holds the mutex of the shard
+    DL_APPEND(head->metadata, new);
+    head->n_obj++;
+
+    // add to bloom filter, rebuild it with more room once full or once half of its names are deleted
+    if (shard->name_bloom != NULL) {
+        if (shard->name_bloom->n_item >= shard->name_bloom->capacity)
+            ret_value = PDC_Server_name_bloom_rebuild(shard, shard->name_bloom->capacity * 2);
+        else if (shard->name_bloom_n_del > shard->name_bloom->capacity / 2)
+            ret_value = PDC_Server_name_bloom_rebuild(shard, shard->name_bloom->capacity);
+        else
+            PDC_Server_name_bloom_add(shard, new);
+        if (ret_value != SUCCEED) {
+            // The old filter is kept, it still needs the new name
+            printf("==PDC_SERVER[%d]: PDC_Server_hash_table_list_insert() - error rebuild bloom\n",
+                   pdc_server_rank_g);
+            PDC_Server_name_bloom_add(shard, new);
+            ret_value = SUCCEED;
+        }
+    }
+
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
 PDC_Server_hash_table_list_init(pdc_hash_table_entry_head *entry, uint32_t *hash_key)
 {
 
@@ -664,8 +884,9 @@ PDC_Server_hash_table_list_init(pdc_hash_table_entry_head *entry, uint32_t *hash
     gettimeofday(&pdc_timer_start, 0);
 #endif
 
-    // Insert to hash table
-    ret = hash_table_insert(metadata_hash_table_g, hash_key, entry);
+    // Insert to the hash table of the shard of the key
+    entry->shard = PDC_Server_metadata_shard(*hash_key);
+    ret          = hash_table_insert(entry->shard->table, hash_key, entry);
     if (ret != 1) {
         fprintf(stderr, "PDC_Server_hash_table_list_init(): Error with hash table insert!\n");
         ret_value = FAIL;
@@ -684,6 +905,363 @@ done:
     FUNC_LEAVE(ret_value);
 }
 
+/*
+ * Append a tag to the tags of a metadata, separated by ','
+ * The tags are interned, so the joined string is interned as a new string and the old one is released
+ *
+ * \param  meta [IN/OUT]       PDC metadata structure
+ * \param  tag [IN]            Tag to append
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_metadata_append_tag(pdc_metadata_t *meta, const char *tag)
+{
+    perr_t ret_value = SUCCEED;
+    char * tags, *interned;
+    size_t len;
+
+    FUNC_ENTER(NULL);
+
+    len  = strlen(meta->tags) + strlen(tag) + 2;
+    tags = (char *)malloc(len);
+    if (tags == NULL) {
+        printf("==PDC_SERVER[%d]: %s - cannot allocate tags\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
+    snprintf(tags, len, "%s,%s", meta->tags, tag);
+
+    interned = PDC_metadata_intern_str(tags);
+    free(tags);
+    if (interned == NULL) {
+        printf("==PDC_SERVER[%d]: %s - cannot intern tags\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
+    PDC_metadata_intern_release(meta->tags);
+    meta->tags = interned;
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Write the pending metadata log records to the current log segment, caller holds the log lock
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_metadata_log_write_out()
+{
+    perr_t  ret_value = SUCCEED;
+    size_t  off       = 0;
+    ssize_t n;
+
+    FUNC_ENTER(NULL);
+
+    while (off < metadata_log_buf_size_g) {
+        n = write(metadata_log_fd_g, metadata_log_buf_g + off, metadata_log_buf_size_g - off);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            printf("==PDC_SERVER[%d]: %s - ERROR writing metadata log, %s\n", pdc_server_rank_g, __func__,
+                   strerror(errno));
+            // Drop the partial write, the whole buffer is written again by the next attempt
+            if (ftruncate(metadata_log_fd_g, (off_t)metadata_log_file_size_g) != 0 ||
+                lseek(metadata_log_fd_g, (off_t)metadata_log_file_size_g, SEEK_SET) < 0)
+                printf("==PDC_SERVER[%d]: %s - ERROR resetting metadata log, %s\n", pdc_server_rank_g,
+                       __func__, strerror(errno));
+            ret_value = FAIL;
+            goto done;
+        }
+        off += n;
+    }
+    metadata_log_file_size_g += metadata_log_buf_size_g;
+    metadata_log_buf_size_g = 0;
+    metadata_log_dirty_g    = 1;
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Append a record to the metadata log, it reaches storage with the next PDC_Server_metadata_log_sync()
+ *
+ * \param  op [IN]              Record type
+ * \param  payload [IN]         Record payload
+ * \param  size [IN]            Size of the payload
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_metadata_log_append(uint32_t op, const void *payload, uint32_t size)
+{
+    perr_t                 ret_value = SUCCEED;
+    pdc_metadata_log_rec_t rec;
+    size_t                 need, alloc;
+    char *                 buf;
+
+    FUNC_ENTER(NULL);
+
+    // Nothing to log when disabled, or when the records come from the log itself
+    if (metadata_log_replay_g == 1)
+        goto done;
+
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&metadata_log_mutex_g);
+#endif
+    if (metadata_log_fd_g >= 0) {
+        need = metadata_log_buf_size_g + sizeof(pdc_metadata_log_rec_t) + size;
+        if (need > metadata_log_buf_alloc_g) {
+            alloc = metadata_log_buf_alloc_g == 0 ? PDC_METADATA_LOG_BUF_SIZE : metadata_log_buf_alloc_g;
+            while (alloc < need)
+                alloc *= 2;
+            buf = (char *)realloc(metadata_log_buf_g, alloc);
+            if (buf == NULL) {
+                printf("==PDC_SERVER[%d]: %s - cannot allocate log buffer\n", pdc_server_rank_g, __func__);
+                ret_value = FAIL;
+            }
+            else {
+                metadata_log_buf_g       = buf;
+                metadata_log_buf_alloc_g = alloc;
+            }
+        }
+
+        if (ret_value == SUCCEED) {
+            rec.op   = op;
+            rec.size = size;
+            memcpy(metadata_log_buf_g + metadata_log_buf_size_g, &rec, sizeof(pdc_metadata_log_rec_t));
+            metadata_log_buf_size_g += sizeof(pdc_metadata_log_rec_t);
+            memcpy(metadata_log_buf_g + metadata_log_buf_size_g, payload, size);
+            metadata_log_buf_size_g += size;
+
+            if (metadata_log_buf_size_g >= PDC_METADATA_LOG_BUF_SIZE)
+                ret_value = PDC_Server_metadata_log_write_out();
+        }
+    }
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&metadata_log_mutex_g);
+#endif
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Log the current state of a metadata, used for object creation and all updates of its fields
+ *
+ * \param  meta [IN]            PDC metadata structure
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_metadata_log_put(pdc_metadata_t *meta)
+{
+    perr_t ret_value = SUCCEED;
+    size_t size;
+    void * buf;
+
+    FUNC_ENTER(NULL);
+
+    if (metadata_log_fd_g < 0 || metadata_log_replay_g == 1)
+        goto done;
+
+    size = PDC_metadata_serialize_size(meta);
+    buf  = malloc(size);
+    if (buf == NULL) {
+        printf("==PDC_SERVER[%d]: %s - cannot allocate log record\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
+    PDC_metadata_serialize(meta, buf);
+    ret_value = PDC_Server_metadata_log_append(PDC_METADATA_LOG_PUT, buf, size);
+    free(buf);
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Log the deletion of an object or a container
+ *
+ * \param  obj_id [IN]          Object or container ID
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_metadata_log_delete(uint64_t obj_id)
+{
+    perr_t ret_value;
+
+    FUNC_ENTER(NULL);
+
+    ret_value = PDC_Server_metadata_log_append(PDC_METADATA_LOG_DELETE, &obj_id, sizeof(uint64_t));
+
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Log the current state of a container, used for container creation and all updates of its objects and
+ * tags. Its kvtags are logged separately.
+ *
+ * \param  cont [IN]            Container
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_metadata_log_cont(pdc_cont_hash_table_entry_t *cont)
+{
+    perr_t                   ret_value = SUCCEED;
+    pdc_metadata_log_cont_t *rec;
+    size_t                   size;
+    char *                   ptr;
+
+    FUNC_ENTER(NULL);
+
+    if (metadata_log_fd_g < 0 || metadata_log_replay_g == 1)
+        goto done;
+
+    size = sizeof(pdc_metadata_log_cont_t) + strlen(cont->cont_name) + 1 + strlen(cont->tags) + 1 +
+           sizeof(uint64_t) * cont->n_obj;
+    rec = (pdc_metadata_log_cont_t *)malloc(size);
+    if (rec == NULL) {
+        printf("==PDC_SERVER[%d]: %s - cannot allocate log record\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
+    rec->cont_id   = cont->cont_id;
+    rec->n_obj     = cont->n_obj;
+    rec->n_deleted = cont->n_deleted;
+    rec->name_len  = strlen(cont->cont_name) + 1;
+    rec->tags_len  = strlen(cont->tags) + 1;
+    ptr            = (char *)(rec + 1);
+    memcpy(ptr, cont->cont_name, rec->name_len);
+    ptr += rec->name_len;
+    memcpy(ptr, cont->tags, rec->tags_len);
+    ptr += rec->tags_len;
+    if (cont->n_obj > 0)
+        memcpy(ptr, cont->obj_ids, sizeof(uint64_t) * cont->n_obj);
+
+    ret_value = PDC_Server_metadata_log_append(PDC_METADATA_LOG_CONT, rec, size);
+    free(rec);
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Log the addition or deletion of a kvtag
+ *
+ * \param  op [IN]              PDC_METADATA_LOG_KVTAG_ADD or PDC_METADATA_LOG_KVTAG_DEL
+ * \param  obj_id [IN]          Object ID
+ * \param  hash_value [IN]      Hash value of the object name
+ * \param  name [IN]            Tag name
+ * \param  value [IN]           Tag value, NULL for deletion
+ * \param  value_size [IN]      Size of the tag value
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_metadata_log_kvtag(uint32_t op, uint64_t obj_id, uint32_t hash_value, const char *name,
+                              const void *value, uint32_t value_size)
+{
+    perr_t                    ret_value = SUCCEED;
+    pdc_metadata_log_kvtag_t *rec;
+    size_t                    size;
+
+    FUNC_ENTER(NULL);
+
+    if (metadata_log_fd_g < 0 || metadata_log_replay_g == 1)
+        goto done;
+
+    size = sizeof(pdc_metadata_log_kvtag_t) + strlen(name) + 1 + value_size;
+    rec  = (pdc_metadata_log_kvtag_t *)malloc(size);
+    if (rec == NULL) {
+        printf("==PDC_SERVER[%d]: %s - cannot allocate log record\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
+    rec->obj_id     = obj_id;
+    rec->hash_value = hash_value;
+    rec->name_len   = strlen(name) + 1;
+    rec->value_size = value_size;
+    memcpy(rec + 1, name, rec->name_len);
+    if (value_size > 0)
+        memcpy((char *)(rec + 1) + rec->name_len, value, value_size);
+
+    ret_value = PDC_Server_metadata_log_append(op, rec, size);
+    free(rec);
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDC_Server_metadata_log_region(uint64_t obj_id, region_list_t *region, int type)
+{
+    perr_t                     ret_value = SUCCEED;
+    pdc_metadata_log_region_t *rec;
+    pdc_histogram_t *          hist;
+    pdc_sketch_t *             sketch;
+    size_t                     size, sketch_size = 0;
+    char *                     ptr;
+    int                        i;
+
+    FUNC_ENTER(NULL);
+
+    if (metadata_log_fd_g < 0 || metadata_log_replay_g == 1)
+        goto done;
+
+    hist   = type == PDC_UPDATE_STORAGE ? region->region_hist : NULL;
+    sketch = type == PDC_UPDATE_STORAGE ? region->region_sketch : NULL;
+    size   = sizeof(pdc_metadata_log_region_t) + strlen(region->storage_location) + 1;
+    if (hist != NULL)
+        size += hist->nbin * (2 * sizeof(double) + sizeof(uint64_t));
+    if (sketch != NULL) {
+        sketch_size = PDC_sketch_serialize_size(sketch);
+        size += sketch_size;
+    }
+
+    rec = (pdc_metadata_log_region_t *)calloc(1, size);
+    if (rec == NULL) {
+        printf("==PDC_SERVER[%d]: %s - cannot allocate log record\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
+    rec->obj_id = obj_id;
+    rec->type   = type;
+    rec->ndim   = region->ndim;
+    for (i = 0; i < (int)region->ndim; i++) {
+        rec->start[i] = region->start[i];
+        rec->count[i] = region->count[i];
+    }
+    rec->offset       = region->offset;
+    rec->compress     = region->compress;
+    rec->storage_size = region->storage_size;
+    rec->loc_len      = strlen(region->storage_location) + 1;
+    ptr          = (char *)(rec + 1);
+    memcpy(ptr, region->storage_location, rec->loc_len);
+    ptr += rec->loc_len;
+    if (hist != NULL) {
+        rec->nbin  = hist->nbin;
+        rec->dtype = hist->dtype;
+        rec->incr  = hist->incr;
+        memcpy(ptr, hist->range, hist->nbin * 2 * sizeof(double));
+        ptr += hist->nbin * 2 * sizeof(double);
+        memcpy(ptr, hist->bin, hist->nbin * sizeof(uint64_t));
+        ptr += hist->nbin * sizeof(uint64_t);
+    }
+    if (sketch != NULL && PDC_sketch_serialize(sketch, ptr) == SUCCEED)
+        rec->sketch_size = sketch_size;
+
+    ret_value = PDC_Server_metadata_log_append(PDC_METADATA_LOG_REGION, rec, size);
+    free(rec);
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
 perr_t
 PDC_Server_add_tag_metadata(metadata_add_tag_in_t *in, metadata_add_tag_out_t *out)
 {
@@ -705,13 +1283,7 @@ PDC_Server_add_tag_metadata(metadata_add_tag_in_t *in, metadata_add_tag_out_t *o
     gettimeofday(&pdc_timer_start, 0);
 #endif
 
-    hash_key = (uint32_t *)malloc(sizeof(uint32_t));
-    if (hash_key == NULL) {
-        printf("==PDC_SERVER: Cannot allocate hash_key!\n");
-        goto done;
-    }
-    total_mem_usage_g += sizeof(uint32_t);
-    *hash_key       = in->hash_value;
+    hash_key        = &in->hash_value;
     uint64_t obj_id = in->obj_id;
 
     pdc_hash_table_entry_head *lookup_value;
@@ -719,12 +1291,12 @@ PDC_Server_add_tag_metadata(metadata_add_tag_in_t *in, metadata_add_tag_out_t *o
 #ifdef ENABLE_MULTITHREAD
     // Obtain lock for hash table
     unlocked = 0;
-    hg_thread_mutex_lock(&pdc_metadata_hash_table_mutex_g);
+    hg_thread_mutex_lock(&PDC_Server_metadata_shard(*hash_key)->mutex);
 #endif
 
-    if (metadata_hash_table_g != NULL) {
+    if (is_hash_table_init_g == 1) {
         // lookup
-        lookup_value = hash_table_lookup(metadata_hash_table_g, hash_key);
+        lookup_value = PDC_Server_metadata_table_lookup(hash_key);
 
         // Is this hash value exist in the Hash table?
         if (lookup_value != NULL) {
@@ -737,11 +1309,12 @@ PDC_Server_add_tag_metadata(metadata_add_tag_in_t *in, metadata_add_tag_out_t *o
                 // obj_name change is done through client with delete and add operation.
                 if (in->new_tag != NULL && in->new_tag[0] != 0 &&
                     !(in->new_tag[0] == ' ' && in->new_tag[1] == 0)) {
-                    // add a ',' to separate different tags
-                    target->tags[strlen(target->tags) + 1] = 0;
-                    target->tags[strlen(target->tags)]     = ',';
-                    strcat(target->tags, in->new_tag);
-                    out->ret = 1;
+                    if (PDC_Server_metadata_append_tag(target, in->new_tag) == SUCCEED) {
+                        PDC_Server_metadata_log_put(target);
+                        out->ret = 1;
+                    }
+                    else
+                        out->ret = -1;
                 }
                 else
                     out->ret = -1;
@@ -758,9 +1331,9 @@ PDC_Server_add_tag_metadata(metadata_add_tag_in_t *in, metadata_add_tag_out_t *o
             out->ret = -1;
         }
 
-    } // if (metadata_hash_table_g != NULL)
+    } // if (is_hash_table_init_g == 1)
     else {
-        printf("==PDC_SERVER: metadata_hash_table_g not initilized!\n");
+        printf("==PDC_SERVER: metadata hash table not initialized!\n");
         ret_value = FAIL;
         out->ret  = -1;
         goto done;
@@ -773,7 +1346,7 @@ PDC_Server_add_tag_metadata(metadata_add_tag_in_t *in, metadata_add_tag_out_t *o
 
 #ifdef ENABLE_MULTITHREAD
     // ^ Release hash table lock
-    hg_thread_mutex_unlock(&pdc_metadata_hash_table_mutex_g);
+    hg_thread_mutex_unlock(&PDC_Server_metadata_shard(*hash_key)->mutex);
     unlocked = 1;
 #endif
 
@@ -797,8 +1370,8 @@ PDC_Server_add_tag_metadata(metadata_add_tag_in_t *in, metadata_add_tag_out_t *o
 
 done:
 #ifdef ENABLE_MULTITHREAD
-    if (unlocked == 0)
-        hg_thread_mutex_unlock(&pdc_metadata_hash_table_mutex_g);
+    if (hash_key != NULL && unlocked == 0)
+        hg_thread_mutex_unlock(&PDC_Server_metadata_shard(*hash_key)->mutex);
 #endif
     fflush(stdout);
 
@@ -813,6 +1386,7 @@ PDC_Server_update_metadata(metadata_update_in_t *in, metadata_update_out_t *out)
     pdc_hash_table_entry_head *lookup_value;
     uint32_t *                 hash_key = NULL;
     pdc_metadata_t *           target;
+    char *                     interned;
 
     FUNC_ENTER(NULL);
 
@@ -825,24 +1399,18 @@ PDC_Server_update_metadata(metadata_update_in_t *in, metadata_update_out_t *out)
     gettimeofday(&pdc_timer_start, 0);
 #endif
 
-    hash_key = (uint32_t *)malloc(sizeof(uint32_t));
-    if (hash_key == NULL) {
-        printf("==PDC_SERVER: Cannot allocate hash_key!\n");
-        goto done;
-    }
-    total_mem_usage_g += sizeof(uint32_t);
-    *hash_key = in->hash_value;
+    hash_key = &in->hash_value;
     obj_id    = in->obj_id;
 
 #ifdef ENABLE_MULTITHREAD
     int unlocked = 0;
     // Obtain lock for hash table
-    hg_thread_mutex_lock(&pdc_metadata_hash_table_mutex_g);
+    hg_thread_mutex_lock(&PDC_Server_metadata_shard(*hash_key)->mutex);
 #endif
 
-    if (metadata_hash_table_g != NULL) {
+    if (is_hash_table_init_g == 1) {
         // lookup
-        lookup_value = hash_table_lookup(metadata_hash_table_g, hash_key);
+        lookup_value = PDC_Server_metadata_table_lookup(hash_key);
 
         // Is this hash value exist in the Hash table?
         if (lookup_value != NULL) {
@@ -852,21 +1420,27 @@ PDC_Server_update_metadata(metadata_update_in_t *in, metadata_update_out_t *out)
                 // Check and find valid update fields
                 // Currently user_id, obj_name are not supported to be updated in this way
                 // obj_name change is done through client with delete and add operation.
-                if (in->new_metadata.time_step != -1)
+                if (in->new_metadata.time_step != -1 && in->new_metadata.time_step != target->time_step) {
+                    // The filter is keyed by time step as well, the old key goes stale
+                    PDC_Server_name_bloom_remove(lookup_value, target);
                     target->time_step = in->new_metadata.time_step;
+                    PDC_Server_name_bloom_update(lookup_value, target);
+                }
                 if (in->new_metadata.app_name[0] != 0 &&
-                    !(in->new_metadata.app_name[0] == ' ' && in->new_metadata.app_name[1] == 0))
-                    strcpy(target->app_name, in->new_metadata.app_name);
+                    !(in->new_metadata.app_name[0] == ' ' && in->new_metadata.app_name[1] == 0) &&
+                    (interned = PDC_metadata_intern_str(in->new_metadata.app_name)) != NULL) {
+                    PDC_metadata_intern_release(target->app_name);
+                    target->app_name = interned;
+                }
                 if (in->new_metadata.data_location[0] != 0 &&
-                    !(in->new_metadata.data_location[0] == ' ' && in->new_metadata.data_location[1] == 0))
-                    strcpy(target->data_location, in->new_metadata.data_location);
-                if (in->new_metadata.tags[0] != 0 &&
-                    !(in->new_metadata.tags[0] == ' ' && in->new_metadata.tags[1] == 0)) {
-                    // add a ',' to separate different tags
-                    target->tags[strlen(target->tags) + 1] = 0;
-                    target->tags[strlen(target->tags)]     = ',';
-                    strcat(target->tags, in->new_metadata.tags);
+                    !(in->new_metadata.data_location[0] == ' ' && in->new_metadata.data_location[1] == 0) &&
+                    (interned = PDC_metadata_intern_str(in->new_metadata.data_location)) != NULL) {
+                    PDC_metadata_intern_release(target->data_location);
+                    target->data_location = interned;
                 }
+                if (in->new_metadata.tags[0] != 0 &&
+                    !(in->new_metadata.tags[0] == ' ' && in->new_metadata.tags[1] == 0))
+                    PDC_Server_metadata_append_tag(target, in->new_metadata.tags);
                 if (in->new_metadata.current_state != 0) {
                     target->transform_state          = in->new_metadata.current_state;
                     target->current_state.dtype      = in->new_metadata.t_dtype;
@@ -877,6 +1451,7 @@ PDC_Server_update_metadata(metadata_update_in_t *in, metadata_update_out_t *out)
                     target->current_state.dims[3]    = in->new_metadata.t_dims3;
                     target->current_state.meta_index = in->new_metadata.t_meta_index;
                 }
+                PDC_Server_metadata_log_put(target);
                 out->ret = 1;
             } // if (lookup_value != NULL)
             else {
@@ -891,9 +1466,9 @@ PDC_Server_update_metadata(metadata_update_in_t *in, metadata_update_out_t *out)
             out->ret  = -1;
         }
 
-    } // if (metadata_hash_table_g != NULL)
+    } // if (is_hash_table_init_g == 1)
     else {
-        printf("==PDC_SERVER: metadata_hash_table_g not initialized!\n");
+        printf("==PDC_SERVER: metadata hash table not initialized!\n");
         ret_value = -1;
         out->ret  = -1;
         goto done;
@@ -901,7 +1476,7 @@ PDC_Server_update_metadata(metadata_update_in_t *in, metadata_update_out_t *out)
 
 #ifdef ENABLE_MULTITHREAD
     // ^ Release hash table lock
-    hg_thread_mutex_unlock(&pdc_metadata_hash_table_mutex_g);
+    hg_thread_mutex_unlock(&PDC_Server_metadata_shard(*hash_key)->mutex);
     unlocked = 1;
 #endif
 
@@ -925,8 +1500,8 @@ PDC_Server_update_metadata(metadata_update_in_t *in, metadata_update_out_t *out)
 
 done:
 #ifdef ENABLE_MULTITHREAD
-    if (unlocked == 0)
-        hg_thread_mutex_unlock(&pdc_metadata_hash_table_mutex_g);
+    if (hash_key != NULL && unlocked == 0)
+        hg_thread_mutex_unlock(&PDC_Server_metadata_shard(*hash_key)->mutex);
 #endif
     fflush(stdout);
     FUNC_LEAVE(ret_value);
@@ -935,12 +1510,13 @@ done:
 perr_t
 PDC_Server_delete_metadata_by_id(metadata_delete_by_id_in_t *in, metadata_delete_by_id_out_t *out)
 {
-    perr_t            ret_value = FAIL;
-    pdc_metadata_t *  elt;
-    HashTableIterator hash_table_iter;
-    HashTablePair     pair;
-    uint64_t          target_obj_id;
-    int               n_entry;
+    perr_t                ret_value = FAIL;
+    pdc_metadata_t *      elt;
+    HashTableIterator     hash_table_iter;
+    HashTablePair         pair;
+    uint64_t              target_obj_id;
+    int                   n_entry, i;
+    pdc_metadata_shard_t *shard;
 
     FUNC_ENTER(NULL);
 
@@ -957,15 +1533,12 @@ PDC_Server_delete_metadata_by_id(metadata_delete_by_id_in_t *in, metadata_delete
 
     target_obj_id = in->obj_id;
 
-#ifdef ENABLE_MULTITHREAD
-    // Obtain lock for hash table
-    int unlocked = 0;
-    hg_thread_mutex_lock(&pdc_metadata_hash_table_mutex_g);
-#endif
-
     if (container_hash_table_g != NULL) {
         pdc_cont_hash_table_entry_t *cont_entry;
 
+#ifdef ENABLE_MULTITHREAD
+        hg_thread_mutex_lock(&pdc_container_hash_table_mutex_g);
+#endif
         // Since we only have the obj id, need to iterate the entire hash table
         n_entry = hash_table_num_entries(container_hash_table_g);
         hash_table_iterate(container_hash_table_g, &hash_table_iter);
@@ -977,66 +1550,74 @@ PDC_Server_delete_metadata_by_id(metadata_delete_by_id_in_t *in, metadata_delete
                 continue;
 
             if (cont_entry->cont_id == target_obj_id) {
-                hash_table_remove(container_hash_table_g, &pair.key);
+                hash_table_remove(container_hash_table_g, pair.key);
                 out->ret  = 1;
                 ret_value = SUCCEED;
-                goto done;
+                break;
             }
         }
+#ifdef ENABLE_MULTITHREAD
+        hg_thread_mutex_unlock(&pdc_container_hash_table_mutex_g);
+#endif
+        if (out->ret == 1)
+            goto done;
     }
-    if (out->ret == -1 && metadata_hash_table_g != NULL) {
+    if (is_hash_table_init_g == 1) {
 
-        // Since we only have the obj id, need to iterate the entire hash table
+        // Since we only have the obj id, need to iterate the entire hash table, one shard at a time
         pdc_hash_table_entry_head *head;
 
-        n_entry = hash_table_num_entries(metadata_hash_table_g);
-        hash_table_iterate(metadata_hash_table_g, &hash_table_iter);
-
-        while (n_entry != 0 && hash_table_iter_has_more(&hash_table_iter)) {
+        for (i = 0; i < PDC_METADATA_N_SHARD && out->ret == -1; i++) {
+            shard = &metadata_shard_g[i];
+#ifdef ENABLE_MULTITHREAD
+            hg_thread_mutex_lock(&shard->mutex);
+#endif
+            n_entry = hash_table_num_entries(shard->table);
+            hash_table_iterate(shard->table, &hash_table_iter);
 
-            pair = hash_table_iter_next(&hash_table_iter);
-            head = pair.value;
-            // Now iterate the list under this entry
-            DL_FOREACH(head->metadata, elt)
-            {
+            while (n_entry != 0 && hash_table_iter_has_more(&hash_table_iter)) {
 
-                if (elt->obj_id == target_obj_id) {
-                    // We found the delete target
-                    // Check if there are more objects in this list
-                    if (head->n_obj > 1) {
-                        // Remove from bloom filter
-                        if (head->bloom != NULL) {
-                            PDC_Server_remove_from_bloom(elt, head->bloom);
-                        }
+                pair = hash_table_iter_next(&hash_table_iter);
+                head = pair.value;
+                // Now iterate the list under this entry
+                DL_FOREACH(head->metadata, elt)
+                {
 
-                        // Remove from linked list
-                        DL_DELETE(head->metadata, elt);
-                        head->n_obj--;
-                    }
-                    else {
-                        // This is the last item under the current entry, remove the hash entry
+                    if (elt->obj_id == target_obj_id) {
+                        // We found the delete target
+                        // Check if there are more objects in this list
                         uint32_t hash_key = PDC_get_hash_by_name(elt->obj_name);
-                        hash_table_remove(metadata_hash_table_g, &hash_key);
+                        PDC_Server_name_bloom_remove(head, elt);
+                        PDC_metadata_release_strs(elt);
+                        if (head->n_obj > 1) {
+                            // Remove from linked list
+                            DL_DELETE(head->metadata, elt);
+                            head->n_obj--;
+                        }
+                        else {
+                            // This is the last item under the current entry, remove the hash entry
+                            hash_table_remove(shard->table, &hash_key);
+                        }
+                        out->ret  = 1;
+                        ret_value = SUCCEED;
                     }
-                    out->ret  = 1;
-                    ret_value = SUCCEED;
-                }
-            } // DL_FOREACH
-        }     // while
-    }         // if (metadata_hash_table_g != NULL)
-    else {
-        printf("==PDC_SERVER: metadata_hash_table_g not initialized!\n");
+                } // DL_FOREACH
+            }     // while
+#ifdef ENABLE_MULTITHREAD
+            hg_thread_mutex_unlock(&shard->mutex);
+#endif
+        } // for each shard
+    }     // if (is_hash_table_init_g == 1)
+    else {
+        printf("==PDC_SERVER: metadata hash table not initialized!\n");
         ret_value = FAIL;
         out->ret  = -1;
         goto done;
     }
 
 done:
-#ifdef ENABLE_MULTITHREAD
-    // ^ Release hash table lock
-    hg_thread_mutex_unlock(&pdc_metadata_hash_table_mutex_g);
-    unlocked = 1;
-#endif
+    if (out->ret == 1)
+        PDC_Server_metadata_log_delete(target_obj_id);
 
 #ifdef ENABLE_TIMING
     // Timing
@@ -1065,11 +1646,6 @@ done:
     hg_thread_mutex_unlock(&n_metadata_mutex_g);
 #endif
 
-#ifdef ENABLE_MULTITHREAD
-    if (unlocked == 0)
-        hg_thread_mutex_unlock(&pdc_metadata_hash_table_mutex_g);
-#endif
-
     FUNC_LEAVE(ret_value);
 }
 
@@ -1091,50 +1667,42 @@ PDC_delete_metadata_from_hash_table(metadata_delete_in_t *in, metadata_delete_ou
     gettimeofday(&pdc_timer_start, 0);
 #endif
 
-    hash_key = (uint32_t *)malloc(sizeof(uint32_t));
-    if (hash_key == NULL) {
-        printf("==PDC_SERVER: Cannot allocate hash_key!\n");
-        goto done;
-    }
-    total_mem_usage_g += sizeof(uint32_t);
-    *hash_key = in->hash_value;
+    hash_key = &in->hash_value;
 
     pdc_hash_table_entry_head *lookup_value;
     pdc_metadata_t             metadata;
-    strcpy(metadata.obj_name, in->obj_name);
-    metadata.time_step   = in->time_step;
-    metadata.app_name[0] = 0;
-    metadata.user_id     = -1;
-    metadata.obj_id      = 0;
+    metadata.obj_name  = (char *)in->obj_name;
+    metadata.time_step = in->time_step;
+    metadata.app_name  = "";
+    metadata.user_id   = -1;
+    metadata.obj_id    = 0;
 
 #ifdef ENABLE_MULTITHREAD
     // Obtain lock for hash table
     int unlocked = 0;
-    hg_thread_mutex_lock(&pdc_metadata_hash_table_mutex_g);
+    hg_thread_mutex_lock(&PDC_Server_metadata_shard(*hash_key)->mutex);
 #endif
 
-    if (metadata_hash_table_g != NULL) {
+    if (is_hash_table_init_g == 1) {
         // lookup
-        lookup_value = hash_table_lookup(metadata_hash_table_g, hash_key);
+        lookup_value = PDC_Server_metadata_table_lookup(hash_key);
 
         // Is this hash value exist in the Hash table?
         if (lookup_value != NULL) {
             // Check if there exist metadata identical to current one
             target = find_identical_metadata(lookup_value, &metadata);
             if (target != NULL) {
+                PDC_Server_metadata_log_delete(target->obj_id);
+                PDC_Server_name_bloom_remove(lookup_value, target);
+                PDC_metadata_release_strs(target);
                 if (lookup_value->n_obj > 1) {
-                    // Remove from bloom filter
-                    if (lookup_value->bloom != NULL) {
-                        PDC_Server_remove_from_bloom(target, lookup_value->bloom);
-                    }
-
                     // Remove from linked list
                     DL_DELETE(lookup_value->metadata, target);
                     lookup_value->n_obj--;
                 }
                 else {
                     // Remove from hash
-                    hash_table_remove(metadata_hash_table_g, hash_key);
+                    PDC_Server_metadata_table_remove(hash_key);
                 }
                 out->ret = 1;
 
@@ -1153,9 +1721,9 @@ PDC_delete_metadata_from_hash_table(metadata_delete_in_t *in, metadata_delete_ou
             out->ret  = -1;
         }
 
-    } // if (metadata_hash_table_g != NULL)
+    } // if (is_hash_table_init_g == 1)
     else {
-        printf("==PDC_SERVER: metadata_hash_table_g not initialized!\n");
+        printf("==PDC_SERVER: metadata hash table not initialized!\n");
         ret_value = -1;
         out->ret  = -1;
         goto done;
@@ -1163,7 +1731,7 @@ PDC_delete_metadata_from_hash_table(metadata_delete_in_t *in, metadata_delete_ou
 
 #ifdef ENABLE_MULTITHREAD
     // ^ Release hash table lock
-    hg_thread_mutex_unlock(&pdc_metadata_hash_table_mutex_g);
+    hg_thread_mutex_unlock(&PDC_Server_metadata_shard(*hash_key)->mutex);
     unlocked = 1;
 #endif
 
@@ -1195,8 +1763,8 @@ PDC_delete_metadata_from_hash_table(metadata_delete_in_t *in, metadata_delete_ou
 
 done:
 #ifdef ENABLE_MULTITHREAD
-    if (unlocked == 0)
-        hg_thread_mutex_unlock(&pdc_metadata_hash_table_mutex_g);
+    if (hash_key != NULL && unlocked == 0)
+        hg_thread_mutex_unlock(&PDC_Server_metadata_shard(*hash_key)->mutex);
 #endif
 
     FUNC_LEAVE(ret_value);
@@ -1207,11 +1775,9 @@ PDC_insert_metadata_to_hash_table(gen_obj_id_in_t *in, gen_obj_id_out_t *out)
 {
     perr_t          ret_value = SUCCEED;
     pdc_metadata_t *metadata;
-    uint32_t *      hash_key, i;
+    uint32_t *      hash_key = NULL, i;
 #ifdef ENABLE_MULTITHREAD
-    // Obtain lock for hash table
     int unlocked = 0;
-    hg_thread_mutex_lock(&pdc_metadata_hash_table_mutex_g);
 #endif
     // DEBUG
     int debug_flag = 0;
@@ -1253,19 +1819,26 @@ PDC_insert_metadata_to_hash_table(gen_obj_id_in_t *in, gen_obj_id_out_t *out)
     metadata->dims[3]   = in->data.dims3;
     for (i = metadata->ndim; i < DIM_MAX; i++)
         metadata->dims[i] = 0;
-
-    strcpy(metadata->obj_name, in->data.obj_name);
-    strcpy(metadata->app_name, in->data.app_name);
-    strcpy(metadata->tags, in->data.tags);
-    strcpy(metadata->data_location, in->data.data_location);
-
-    hash_key = (uint32_t *)malloc(sizeof(uint32_t));
-    if (hash_key == NULL) {
-        printf("Cannot allocate hash_key!\n");
+    metadata->stripe_size      = in->data.stripe_size;
+    metadata->stripe_count     = in->data.stripe_count;
+    metadata->compress         = in->data.compress;
+    metadata->compress_level   = in->data.compress_level;
+    metadata->error_bound_mode = in->data.error_bound_mode;
+    metadata->error_bound      = in->data.error_bound;
+
+    metadata->obj_name      = PDC_metadata_intern_str(in->data.obj_name);
+    metadata->app_name      = PDC_metadata_intern_str(in->data.app_name);
+    metadata->tags          = PDC_metadata_intern_str(in->data.tags);
+    metadata->data_location = PDC_metadata_intern_str(in->data.data_location);
+    if (metadata->obj_name == NULL || metadata->app_name == NULL || metadata->tags == NULL ||
+        metadata->data_location == NULL) {
+        printf("Cannot intern metadata strings!\n");
+        PDC_metadata_release_strs(metadata);
+        free(metadata);
         goto done;
     }
-    total_mem_usage_g += sizeof(uint32_t);
-    *hash_key = in->hash_value;
+
+    hash_key = &in->hash_value;
 
     pdc_hash_table_entry_head *lookup_value;
     pdc_metadata_t *           found_identical;
@@ -1273,15 +1846,15 @@ PDC_insert_metadata_to_hash_table(gen_obj_id_in_t *in, gen_obj_id_out_t *out)
 #ifdef ENABLE_MULTITHREAD
     // Obtain lock for hash table
     unlocked = 0;
-    hg_thread_mutex_lock(&pdc_metadata_hash_table_mutex_g);
+    hg_thread_mutex_lock(&PDC_Server_metadata_shard(*hash_key)->mutex);
 #endif
 
     if (debug_flag == 1)
         printf("checking hash table with key=%d\n", *hash_key);
 
-    if (metadata_hash_table_g != NULL) {
+    if (is_hash_table_init_g == 1) {
         // lookup
-        lookup_value = hash_table_lookup(metadata_hash_table_g, hash_key);
+        lookup_value = PDC_Server_metadata_table_lookup(hash_key);
 
         // Is this hash value exist in the Hash table?
         if (lookup_value != NULL) {
@@ -1293,6 +1866,7 @@ PDC_insert_metadata_to_hash_table(gen_obj_id_in_t *in, gen_obj_id_out_t *out)
                 printf("==PDC_SERVER[%d]: Found identical metadata with name %s!\n", pdc_server_rank_g,
                        metadata->obj_name);
                 out->obj_id = 0;
+                PDC_metadata_release_strs(metadata);
                 free(metadata);
                 goto done;
             }
@@ -1309,7 +1883,6 @@ PDC_insert_metadata_to_hash_table(gen_obj_id_in_t *in, gen_obj_id_out_t *out)
 
             pdc_hash_table_entry_head *entry =
                 (pdc_hash_table_entry_head *)malloc(sizeof(pdc_hash_table_entry_head));
-            entry->bloom    = NULL;
             entry->metadata = NULL;
             entry->n_obj    = 0;
             total_mem_usage_g += sizeof(pdc_hash_table_entry_head);
@@ -1319,16 +1892,17 @@ PDC_insert_metadata_to_hash_table(gen_obj_id_in_t *in, gen_obj_id_out_t *out)
         }
     }
     else {
-        printf("metadata_hash_table_g not initialized!\n");
+        printf("metadata hash table not initialized!\n");
         goto done;
     }
 
     // Generate object id (uint64_t)
     metadata->obj_id = PDC_Server_gen_obj_id();
+    PDC_Server_metadata_log_put(metadata);
 
 #ifdef ENABLE_MULTITHREAD
     // ^ Release hash table lock
-    hg_thread_mutex_unlock(&pdc_metadata_hash_table_mutex_g);
+    hg_thread_mutex_unlock(&PDC_Server_metadata_shard(*hash_key)->mutex);
     unlocked = 1;
 #endif
 
@@ -1363,10 +1937,243 @@ PDC_insert_metadata_to_hash_table(gen_obj_id_in_t *in, gen_obj_id_out_t *out)
 
 done:
 #ifdef ENABLE_MULTITHREAD
-    if (unlocked == 0)
-        hg_thread_mutex_unlock(&pdc_metadata_hash_table_mutex_g);
+    if (hash_key != NULL && unlocked == 0)
+        hg_thread_mutex_unlock(&PDC_Server_metadata_shard(*hash_key)->mutex);
+#endif
+
+    FUNC_LEAVE(ret_value);
+}
+
+static int
+PDC_Server_name_ptr_cmp(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+perr_t
+PDC_Server_create_metadata_batch(metadata_bulk_create_in_t *in, void *buf, uint64_t buf_size,
+                                 metadata_bulk_create_out_t *out)
+{
+    perr_t                     ret_value = SUCCEED;
+    pdc_metadata_t             shared, query, *metadata, **created = NULL;
+    pdc_hash_table_entry_head *lookup_value;
+    uint32_t *                 hash_values, i, j;
+    char **                    names = NULL, **sorted = NULL, *ptr, *end;
+    uint64_t                   obj_id_start;
+    uint32_t                   shard_mask = 0;
+
+    FUNC_ENTER(NULL);
+
+#ifdef ENABLE_TIMING
+    // Timing
+    struct timeval pdc_timer_start;
+    struct timeval pdc_timer_end;
+    double         ht_total_sec;
+
+    gettimeofday(&pdc_timer_start, 0);
 #endif
 
+    PDC_metadata_init(&shared);
+    out->obj_id_start = 0;
+    out->n_created    = 0;
+    if (in->n_obj == 0)
+        goto done;
+
+    if (is_hash_table_init_g != 1) {
+        printf("==PDC_SERVER[%d]: %s - metadata hash table not initialized!\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
+
+    // The name hash values come first, then the names one after another
+    names   = (char **)malloc(sizeof(char *) * in->n_obj * 2);
+    sorted  = names + in->n_obj;
+    created = (pdc_metadata_t **)malloc(sizeof(pdc_metadata_t *) * in->n_obj);
+    if (names == NULL || created == NULL || buf_size < sizeof(uint32_t) * in->n_obj) {
+        printf("==PDC_SERVER[%d]: %s - invalid batch of %u objects\n", pdc_server_rank_g, __func__,
+               in->n_obj);
+        ret_value = FAIL;
+        goto done;
+    }
+    hash_values = (uint32_t *)buf;
+    ptr         = (char *)buf + sizeof(uint32_t) * in->n_obj;
+    end         = (char *)buf + buf_size;
+    for (i = 0; i < in->n_obj; i++) {
+        names[i] = ptr;
+        while (ptr < end && *ptr != '\0')
+            ptr++;
+        if (ptr == end || names[i][0] == '\0') {
+            printf("==PDC_SERVER[%d]: %s - invalid name %u of the batch\n", pdc_server_rank_g, __func__, i);
+            ret_value = FAIL;
+            goto done;
+        }
+        ptr++;
+        // The shard and the bucket of a name come from the name, not from the hash value of the client
+        if (hash_values[i] != PDC_get_hash_by_name(names[i])) {
+            printf("==PDC_SERVER[%d]: %s - hash value of name %s does not match\n", pdc_server_rank_g,
+                   __func__, names[i]);
+            ret_value = FAIL;
+            goto done;
+        }
+    }
+
+    // The objects share the time step, so no name can repeat
+    memcpy(sorted, names, sizeof(char *) * in->n_obj);
+    qsort(sorted, in->n_obj, sizeof(char *), PDC_Server_name_ptr_cmp);
+    for (i = 1; i < in->n_obj; i++) {
+        if (strcmp(sorted[i - 1], sorted[i]) == 0) {
+            printf("==PDC_SERVER[%d]: %s - name %s repeats in the batch\n", pdc_server_rank_g, __func__,
+                   sorted[i]);
+            ret_value = FAIL;
+            goto done;
+        }
+    }
+
+    // Properties shared by all objects, strings are interned once for the batch
+    shared.cont_id   = in->data.cont_id;
+    shared.data_type = in->data_type;
+    shared.user_id   = in->data.user_id;
+    shared.time_step = in->data.time_step;
+    shared.ndim      = in->data.ndim;
+    shared.dims[0]   = in->data.dims0;
+    shared.dims[1]   = in->data.dims1;
+    shared.dims[2]   = in->data.dims2;
+    shared.dims[3]   = in->data.dims3;
+    for (i = shared.ndim; i < DIM_MAX; i++)
+        shared.dims[i] = 0;
+    shared.stripe_size      = in->data.stripe_size;
+    shared.stripe_count     = in->data.stripe_count;
+    shared.compress         = in->data.compress;
+    shared.compress_level   = in->data.compress_level;
+    shared.error_bound_mode = in->data.error_bound_mode;
+    shared.error_bound      = in->data.error_bound;
+    shared.app_name         = PDC_metadata_intern_str(in->data.app_name);
+    shared.tags             = PDC_metadata_intern_str(in->data.tags);
+    shared.data_location    = PDC_metadata_intern_str(in->data.data_location);
+    if (shared.app_name == NULL || shared.tags == NULL || shared.data_location == NULL) {
+        printf("==PDC_SERVER[%d]: %s - cannot intern metadata strings\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
+
+    // Hold all shards the names fall in, the batch is checked and inserted as a whole
+    for (i = 0; i < in->n_obj; i++)
+        shard_mask |= 1U << PDC_Server_metadata_shard_index(hash_values[i]);
+    PDC_Server_metadata_table_lock(shard_mask);
+
+    // Check all names first, so that the batch is created entirely or not at all
+    query = shared;
+    for (i = 0; i < in->n_obj; i++) {
+        lookup_value = PDC_Server_metadata_table_lookup(&hash_values[i]);
+        if (lookup_value == NULL)
+            continue;
+        query.obj_name = names[i];
+        if (find_identical_metadata(lookup_value, &query) != NULL) {
+            printf("==PDC_SERVER[%d]: Found identical metadata with name %s!\n", pdc_server_rank_g, names[i]);
+            ret_value = FAIL;
+            goto done;
+        }
+    }
+
+    obj_id_start = PDC_Server_gen_obj_id_range(in->n_obj);
+    for (i = 0; i < in->n_obj; i++) {
+        metadata = (pdc_metadata_t *)malloc(sizeof(pdc_metadata_t));
+        if (metadata == NULL) {
+            printf("==PDC_SERVER[%d]: %s - cannot allocate pdc_metadata_t\n", pdc_server_rank_g, __func__);
+            ret_value = FAIL;
+            break;
+        }
+        *metadata          = shared;
+        metadata->obj_id   = obj_id_start + i;
+        metadata->obj_name = PDC_metadata_intern_str(names[i]);
+        if (metadata->obj_name == NULL) {
+            printf("==PDC_SERVER[%d]: %s - cannot intern metadata strings\n", pdc_server_rank_g, __func__);
+            free(metadata);
+            ret_value = FAIL;
+            break;
+        }
+        // Each object owns a reference to the shared strings
+        metadata->app_name      = PDC_metadata_intern_ref(shared.app_name);
+        metadata->tags          = PDC_metadata_intern_ref(shared.tags);
+        metadata->data_location = PDC_metadata_intern_ref(shared.data_location);
+
+        lookup_value = PDC_Server_metadata_table_lookup(&hash_values[i]);
+        if (lookup_value == NULL) {
+            lookup_value = (pdc_hash_table_entry_head *)malloc(sizeof(pdc_hash_table_entry_head));
+            if (lookup_value == NULL) {
+                printf("==PDC_SERVER[%d]: %s - cannot allocate hash entry\n", pdc_server_rank_g, __func__);
+                PDC_metadata_release_strs(metadata);
+                free(metadata);
+                ret_value = FAIL;
+                break;
+            }
+            lookup_value->metadata = NULL;
+            lookup_value->n_obj    = 0;
+            total_mem_usage_g += sizeof(pdc_hash_table_entry_head);
+            PDC_Server_hash_table_list_init(lookup_value, &hash_values[i]);
+        }
+        PDC_Server_hash_table_list_insert(lookup_value, metadata);
+        created[i] = metadata;
+    }
+
+    if (i < in->n_obj) {
+        // Take the inserted objects out again, the batch is created entirely or not at all
+        for (j = 0; j < i; j++) {
+            lookup_value = PDC_Server_metadata_table_lookup(&hash_values[j]);
+            PDC_Server_name_bloom_remove(lookup_value, created[j]);
+            DL_DELETE(lookup_value->metadata, created[j]);
+            lookup_value->n_obj--;
+            if (lookup_value->n_obj == 0)
+                PDC_Server_metadata_table_remove(&hash_values[j]);
+            PDC_metadata_release_strs(created[j]);
+            free(created[j]);
+        }
+        goto done;
+    }
+    total_mem_usage_g += sizeof(pdc_metadata_t) * i;
+
+    // Only the complete batch is logged
+    for (j = 0; j < i; j++)
+        PDC_Server_metadata_log_put(created[j]);
+
+    // Objects are created in the order of the names with consecutive IDs
+    out->obj_id_start = obj_id_start;
+    out->n_created    = i;
+
+    PDC_Server_metadata_table_unlock(shard_mask);
+    shard_mask = 0;
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&n_metadata_mutex_g);
+#endif
+    n_metadata_g += i;
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&n_metadata_mutex_g);
+#endif
+
+#ifdef ENABLE_TIMING
+    // Timing
+    gettimeofday(&pdc_timer_end, 0);
+    ht_total_sec = PDC_get_elapsed_time_double(&pdc_timer_start, &pdc_timer_end);
+#endif
+
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&pdc_time_mutex_g);
+#endif
+
+#ifdef ENABLE_TIMING
+    server_insert_time_g += ht_total_sec;
+#endif
+
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&pdc_time_mutex_g);
+#endif
+
+done:
+    PDC_Server_metadata_table_unlock(shard_mask);
+    PDC_metadata_release_strs(&shared);
+    free(names);
+    free(created);
+
     FUNC_LEAVE(ret_value);
 }
 
@@ -1374,16 +2181,16 @@ perr_t
 PDC_Server_print_all_metadata()
 {
     perr_t                     ret_value = SUCCEED;
-    HashTableIterator          hash_table_iter;
+    pdc_metadata_table_iter_t  hash_table_iter;
     pdc_metadata_t *           elt;
     pdc_hash_table_entry_head *head;
     HashTablePair              pair;
 
     FUNC_ENTER(NULL);
 
-    hash_table_iterate(metadata_hash_table_g, &hash_table_iter);
-    while (hash_table_iter_has_more(&hash_table_iter)) {
-        pair = hash_table_iter_next(&hash_table_iter);
+    PDC_Server_metadata_table_iterate(&hash_table_iter);
+    while (PDC_Server_metadata_table_iter_has_more(&hash_table_iter)) {
+        pair = PDC_Server_metadata_table_iter_next(&hash_table_iter);
         head = pair.value;
         DL_FOREACH(head->metadata, elt)
         {
@@ -1424,7 +2231,7 @@ perr_t
 PDC_Server_metadata_duplicate_check()
 {
     perr_t                     ret_value = SUCCEED;
-    HashTableIterator          hash_table_iter;
+    pdc_metadata_table_iter_t  hash_table_iter;
     HashTablePair              pair;
     int                        n_entry, count = 0;
     int                        all_maybe, all_total, all_entry;
@@ -1435,7 +2242,8 @@ PDC_Server_metadata_duplicate_check()
 
     FUNC_ENTER(NULL);
 
-    n_entry = hash_table_num_entries(metadata_hash_table_g);
+    n_entry = PDC_Server_metadata_table_num_entries();
+    PDC_Server_name_bloom_sum_stats();
 
 #ifdef ENABLE_MPI
     MPI_Reduce(&n_bloom_maybe_g, &all_maybe, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
@@ -1454,10 +2262,10 @@ PDC_Server_metadata_duplicate_check()
 
     fflush(stdout);
 
-    hash_table_iterate(metadata_hash_table_g, &hash_table_iter);
+    PDC_Server_metadata_table_iterate(&hash_table_iter);
 
-    while (n_entry != 0 && hash_table_iter_has_more(&hash_table_iter)) {
-        pair = hash_table_iter_next(&hash_table_iter);
+    while (n_entry != 0 && PDC_Server_metadata_table_iter_has_more(&hash_table_iter)) {
+        pair = PDC_Server_metadata_table_iter_next(&hash_table_iter);
         head = pair.value;
         DL_SORT(head->metadata, PDC_metadata_cmp);
         // With sorted list, just compare each one with its next
@@ -1550,7 +2358,7 @@ PDC_Server_get_partial_query_result(metadata_query_transfer_in_t *in, uint32_t *
     uint32_t                   n_buf, iter = 0;
     pdc_hash_table_entry_head *head;
     pdc_metadata_t *           elt;
-    HashTableIterator          hash_table_iter;
+    pdc_metadata_table_iter_t  hash_table_iter;
     int                        n_entry;
     HashTablePair              pair;
 
@@ -1563,13 +2371,13 @@ PDC_Server_get_partial_query_result(metadata_query_transfer_in_t *in, uint32_t *
         (*buf_ptrs)[i] = (void *)calloc(1, sizeof(void *));
     }
     // TODO: free buf_ptrs
-    if (metadata_hash_table_g != NULL) {
+    if (is_hash_table_init_g == 1) {
 
-        n_entry = hash_table_num_entries(metadata_hash_table_g);
-        hash_table_iterate(metadata_hash_table_g, &hash_table_iter);
+        n_entry = PDC_Server_metadata_table_num_entries();
+        PDC_Server_metadata_table_iterate(&hash_table_iter);
 
-        while (n_entry != 0 && hash_table_iter_has_more(&hash_table_iter)) {
-            pair = hash_table_iter_next(&hash_table_iter);
+        while (n_entry != 0 && PDC_Server_metadata_table_iter_has_more(&hash_table_iter)) {
+            pair = PDC_Server_metadata_table_iter_next(&hash_table_iter);
             head = pair.value;
             DL_FOREACH(head->metadata, elt)
             {
@@ -1584,9 +2392,9 @@ PDC_Server_get_partial_query_result(metadata_query_transfer_in_t *in, uint32_t *
             }
         }
         *n_meta = iter;
-    } // if (metadata_hash_table_g != NULL)
+    } // if (is_hash_table_init_g == 1)
     else {
-        printf("==PDC_SERVER: metadata_hash_table_g not initialized!\n");
+        printf("==PDC_SERVER: metadata hash table not initialized!\n");
         ret_value = FAIL;
         goto done;
     }
@@ -1605,7 +2413,7 @@ PDC_Server_get_kvtag_query_result(pdc_kvtag_t *in, uint32_t *n_meta, uint64_t **
     pdc_hash_table_entry_head *head;
     pdc_metadata_t *           elt;
     pdc_kvtag_list_t *         kvtag_list_elt;
-    HashTableIterator          hash_table_iter;
+    pdc_metadata_table_iter_t  hash_table_iter;
     int                        n_entry, is_name_match, is_value_match;
     HashTablePair              pair;
     uint32_t                   alloc_size = 100;
@@ -1616,13 +2424,13 @@ PDC_Server_get_kvtag_query_result(pdc_kvtag_t *in, uint32_t *n_meta, uint64_t **
     // TODO: free obj_ids
     *obj_ids = (void *)calloc(alloc_size, sizeof(uint64_t));
 
-    if (metadata_hash_table_g != NULL) {
+    if (is_hash_table_init_g == 1) {
 
-        n_entry = hash_table_num_entries(metadata_hash_table_g);
-        hash_table_iterate(metadata_hash_table_g, &hash_table_iter);
+        n_entry = PDC_Server_metadata_table_num_entries();
+        PDC_Server_metadata_table_iterate(&hash_table_iter);
 
-        while (n_entry != 0 && hash_table_iter_has_more(&hash_table_iter)) {
-            pair = hash_table_iter_next(&hash_table_iter);
+        while (n_entry != 0 && PDC_Server_metadata_table_iter_has_more(&hash_table_iter)) {
+            pair = PDC_Server_metadata_table_iter_next(&hash_table_iter);
             head = pair.value;
             DL_FOREACH(head->metadata, elt)
             {
@@ -1661,9 +2469,9 @@ PDC_Server_get_kvtag_query_result(pdc_kvtag_t *in, uint32_t *n_meta, uint64_t **
             }     // End for each metadata
         }         // End while
         *n_meta = iter;
-    } // if (metadata_hash_table_g != NULL)
+    } // if (is_hash_table_init_g == 1)
     else {
-        printf("==PDC_SERVER: metadata_hash_table_g not initialized!\n");
+        printf("==PDC_SERVER: metadata hash table not initialized!\n");
         ret_value = FAIL;
         goto done;
     }
@@ -1674,6 +2482,20 @@ done:
     FUNC_LEAVE(ret_value);
 }
 
+uint32_t
+PDC_Server_get_metadata_lease(pdc_metadata_t *meta)
+{
+    uint32_t ret_value = 0;
+
+    FUNC_ENTER(NULL);
+
+    // The transform state of an object changes as its regions are written, such objects are not leased
+    if (meta != NULL && meta->transform_state == 0)
+        ret_value = metadata_lease_ms_g;
+
+    FUNC_LEAVE(ret_value);
+}
+
 perr_t
 PDC_Server_search_with_name_timestep(const char *obj_name, uint32_t hash_key, uint32_t ts,
                                      pdc_metadata_t **out)
@@ -1692,17 +2514,24 @@ PDC_Server_search_with_name_timestep(const char *obj_name, uint32_t hash_key, ui
 
     name = obj_name;
 
-    strcpy(metadata.obj_name, name);
+    metadata.obj_name  = (char *)name;
     metadata.time_step = ts;
 
-    if (metadata_hash_table_g != NULL) {
+    if (is_hash_table_init_g == 1) {
         // lookup
-        lookup_value = hash_table_lookup(metadata_hash_table_g, &hash_key);
+#ifdef ENABLE_MULTITHREAD
+        hg_thread_mutex_lock(&PDC_Server_metadata_shard(hash_key)->mutex);
+#endif
+        lookup_value = PDC_Server_metadata_table_lookup(&hash_key);
 
         // Is this hash value exist in the Hash table?
-        if (lookup_value != NULL) {
+        if (lookup_value != NULL)
             *out = find_identical_metadata(lookup_value, &metadata);
+#ifdef ENABLE_MULTITHREAD
+        hg_thread_mutex_unlock(&PDC_Server_metadata_shard(hash_key)->mutex);
+#endif
 
+        if (lookup_value != NULL) {
             if (*out == NULL) {
                 ret_value = FAIL;
                 goto done;
@@ -1713,7 +2542,7 @@ PDC_Server_search_with_name_timestep(const char *obj_name, uint32_t hash_key, ui
         }
     }
     else {
-        printf("metadata_hash_table_g not initialized!\n");
+        printf("metadata hash table not initialized!\n");
         ret_value = -1;
         goto done;
     }
@@ -1743,18 +2572,25 @@ PDC_Server_search_with_name_hash(const char *obj_name, uint32_t hash_key, pdc_me
 
     name = obj_name;
 
-    strcpy(metadata.obj_name, name);
+    metadata.obj_name = (char *)name;
     // TODO: currently PDC_Client_query_metadata_name_timestep is not taking timestep for querying
     metadata.time_step = 0;
 
-    if (metadata_hash_table_g != NULL) {
+    if (is_hash_table_init_g == 1) {
         // lookup
-        lookup_value = hash_table_lookup(metadata_hash_table_g, &hash_key);
+#ifdef ENABLE_MULTITHREAD
+        hg_thread_mutex_lock(&PDC_Server_metadata_shard(hash_key)->mutex);
+#endif
+        lookup_value = PDC_Server_metadata_table_lookup(&hash_key);
 
         // Is this hash value exist in the Hash table?
-        if (lookup_value != NULL) {
+        if (lookup_value != NULL)
             *out = find_identical_metadata(lookup_value, &metadata);
+#ifdef ENABLE_MULTITHREAD
+        hg_thread_mutex_unlock(&PDC_Server_metadata_shard(hash_key)->mutex);
+#endif
 
+        if (lookup_value != NULL) {
             if (*out == NULL) {
                 ret_value = FAIL;
                 goto done;
@@ -1765,7 +2601,7 @@ PDC_Server_search_with_name_hash(const char *obj_name, uint32_t hash_key, pdc_me
         }
     }
     else {
-        printf("metadata_hash_table_g not initialized!\n");
+        printf("metadata hash table not initialized!\n");
         ret_value = -1;
         goto done;
     }
@@ -1785,7 +2621,7 @@ PDC_Server_get_local_metadata_by_id(uint64_t obj_id, pdc_metadata_t **res_meta_p
 
     pdc_hash_table_entry_head *head;
     pdc_metadata_t *           elt;
-    HashTableIterator          hash_table_iter;
+    pdc_metadata_table_iter_t  hash_table_iter;
     int                        n_entry;
     HashTablePair              pair;
 
@@ -1793,13 +2629,13 @@ PDC_Server_get_local_metadata_by_id(uint64_t obj_id, pdc_metadata_t **res_meta_p
 
     *res_meta_ptr = NULL;
 
-    if (metadata_hash_table_g != NULL) {
+    if (is_hash_table_init_g == 1) {
         // Since we only have the obj id, need to iterate the entire hash table
-        n_entry = hash_table_num_entries(metadata_hash_table_g);
-        hash_table_iterate(metadata_hash_table_g, &hash_table_iter);
+        n_entry = PDC_Server_metadata_table_num_entries();
+        PDC_Server_metadata_table_iterate(&hash_table_iter);
 
-        while (n_entry != 0 && hash_table_iter_has_more(&hash_table_iter)) {
-            pair = hash_table_iter_next(&hash_table_iter);
+        while (n_entry != 0 && PDC_Server_metadata_table_iter_has_more(&hash_table_iter)) {
+            pair = PDC_Server_metadata_table_iter_next(&hash_table_iter);
             head = pair.value;
             // Now iterate the list under this entry
             DL_FOREACH(head->metadata, elt)
@@ -1812,7 +2648,7 @@ PDC_Server_get_local_metadata_by_id(uint64_t obj_id, pdc_metadata_t **res_meta_p
         }
     }
     else {
-        printf("==PDC_SERVER: metadata_hash_table_g not initialized!\n");
+        printf("==PDC_SERVER: metadata hash table not initialized!\n");
         ret_value     = FAIL;
         *res_meta_ptr = NULL;
         goto done;
@@ -1853,6 +2689,7 @@ PDC_Server_get_metadata_by_id_cb(const struct hg_cb_info *callback_info)
     if (output.res_meta.obj_id != 0) {
         // TODO free metdata
         meta = (pdc_metadata_t *)malloc(sizeof(pdc_metadata_t));
+        PDC_metadata_init(meta);
         PDC_transfer_t_to_metadata_t(&output.res_meta, meta);
     }
     else {
@@ -1940,8 +2777,7 @@ done:
 perr_t
 PDC_Server_create_container(gen_cont_id_in_t *in, gen_cont_id_out_t *out)
 {
-    perr_t    ret_value = SUCCEED;
-    uint32_t *hash_key;
+    perr_t ret_value = SUCCEED;
 
     FUNC_ENTER(NULL);
 
@@ -1956,14 +2792,6 @@ PDC_Server_create_container(gen_cont_id_in_t *in, gen_cont_id_out_t *out)
     gettimeofday(&pdc_timer_start, 0);
 #endif
 
-#ifdef ENABLE_MULTITHREAD
-    hg_thread_mutex_lock(&total_mem_usage_mutex_g);
-#endif
-    total_mem_usage_g += sizeof(uint32_t);
-#ifdef ENABLE_MULTITHREAD
-    hg_thread_mutex_unlock(&total_mem_usage_mutex_g);
-#endif
-
     pdc_cont_hash_table_entry_t *lookup_value;
 
 #ifdef ENABLE_MULTITHREAD
@@ -1980,14 +2808,6 @@ PDC_Server_create_container(gen_cont_id_in_t *in, gen_cont_id_out_t *out)
             out->cont_id = lookup_value->cont_id;
         }
         else {
-            hash_key = (uint32_t *)malloc(sizeof(uint32_t));
-            if (hash_key == NULL) {
-                printf("Cannot allocate hash_key!\n");
-                ret_value = FAIL;
-                goto done;
-            }
-            *hash_key = in->hash_value;
-
             pdc_cont_hash_table_entry_t *entry =
                 (pdc_cont_hash_table_entry_t *)calloc(1, sizeof(pdc_cont_hash_table_entry_t));
             strcpy(entry->cont_name, in->cont_name);
@@ -2003,12 +2823,14 @@ PDC_Server_create_container(gen_cont_id_in_t *in, gen_cont_id_out_t *out)
             hg_thread_mutex_unlock(&total_mem_usage_mutex_g);
 #endif
             // Insert to hash table
-            if (hash_table_insert(container_hash_table_g, hash_key, entry) != 1) {
+            if (hash_table_insert(container_hash_table_g, &in->hash_value, entry) != 1) {
                 printf("==PDC_SERVER[%d]: %s - hash table insert failed\n", pdc_server_rank_g, __func__);
                 ret_value = FAIL;
             }
-            else
+            else {
+                PDC_Server_metadata_log_cont(entry);
                 out->cont_id = entry->cont_id;
+            }
         }
     }
     else {
@@ -2235,6 +3057,7 @@ PDC_Server_container_add_objs(int n_obj, uint64_t *obj_ids, uint64_t cont_id)
         // Append the new ids
         memcpy(cont_entry->obj_ids + cont_entry->n_obj, obj_ids, n_obj * sizeof(uint64_t));
         cont_entry->n_obj += n_obj;
+        PDC_Server_metadata_log_cont(cont_entry);
 
         // Debug prints
         if (is_debug_g == 1) {
@@ -2278,6 +3101,8 @@ PDC_Server_container_del_objs(int n_obj, uint64_t *obj_ids, uint64_t cont_id)
                 }
             }
         }
+        if (n_deletes > 0)
+            PDC_Server_metadata_log_cont(cont_entry);
         // Debug print
         printf("==PDC_SERVER[%d]: successfully deleted %d objects!\n", pdc_server_rank_g, n_deletes);
 
@@ -2312,6 +3137,7 @@ PDC_Server_container_add_tags(uint64_t cont_id, char *tags)
 
         if (tags != NULL) {
             strcat(cont_entry->tags, tags);
+            PDC_Server_metadata_log_cont(cont_entry);
         }
     }
     else {
@@ -2567,15 +3393,17 @@ PDC_Server_add_kvtag(metadata_add_kvtag_in_t *in, metadata_add_tag_out_t *out)
 #ifdef ENABLE_MULTITHREAD
     // Obtain lock for hash table
     unlocked = 0;
-    hg_thread_mutex_lock(&pdc_metadata_hash_table_mutex_g);
+    hg_thread_mutex_lock(&PDC_Server_metadata_shard(hash_key)->mutex);
 #endif
 
-    lookup_value = hash_table_lookup(metadata_hash_table_g, &hash_key);
+    lookup_value = PDC_Server_metadata_table_lookup(&hash_key);
     if (lookup_value != NULL) {
         pdc_metadata_t *target;
         target = find_metadata_by_id_from_list(lookup_value->metadata, obj_id);
         if (target != NULL) {
             PDC_add_kvtag_to_list(&target->kvtag_list_head, &in->kvtag);
+            PDC_Server_metadata_log_kvtag(PDC_METADATA_LOG_KVTAG_ADD, obj_id, hash_key, in->kvtag.name,
+                                          in->kvtag.value, in->kvtag.size);
             out->ret = 1;
         } // if (lookup_value != NULL)
         else {
@@ -2589,6 +3417,8 @@ PDC_Server_add_kvtag(metadata_add_kvtag_in_t *in, metadata_add_tag_out_t *out)
         cont_lookup_value = hash_table_lookup(container_hash_table_g, &hash_key);
         if (cont_lookup_value != NULL) {
             PDC_add_kvtag_to_list(&cont_lookup_value->kvtag_list_head, &in->kvtag);
+            PDC_Server_metadata_log_kvtag(PDC_METADATA_LOG_KVTAG_ADD, obj_id, hash_key, in->kvtag.name,
+                                          in->kvtag.value, in->kvtag.size);
             out->ret = 1;
         }
         else {
@@ -2629,7 +3459,7 @@ PDC_Server_add_kvtag(metadata_add_kvtag_in_t *in, metadata_add_tag_out_t *out)
 
 #ifdef ENABLE_MULTITHREAD
     // ^ Release hash table lock
-    hg_thread_mutex_unlock(&pdc_metadata_hash_table_mutex_g);
+    hg_thread_mutex_unlock(&PDC_Server_metadata_shard(hash_key)->mutex);
     unlocked = 1;
 #endif
 
@@ -2653,7 +3483,7 @@ PDC_Server_add_kvtag(metadata_add_kvtag_in_t *in, metadata_add_tag_out_t *out)
 
 #ifdef ENABLE_MULTITHREAD
     if (unlocked == 0)
-        hg_thread_mutex_unlock(&pdc_metadata_hash_table_mutex_g);
+        hg_thread_mutex_unlock(&PDC_Server_metadata_shard(hash_key)->mutex);
 #endif
     fflush(stdout);
 
@@ -2758,10 +3588,10 @@ PDC_Server_get_kvtag(metadata_get_kvtag_in_t *in, metadata_get_kvtag_out_t *out)
 #ifdef ENABLE_MULTITHREAD
     // Obtain lock for hash table
     unlocked = 0;
-    hg_thread_mutex_lock(&pdc_metadata_hash_table_mutex_g);
+    hg_thread_mutex_lock(&PDC_Server_metadata_shard(hash_key)->mutex);
 #endif
 
-    lookup_value = hash_table_lookup(metadata_hash_table_g, &hash_key);
+    lookup_value = PDC_Server_metadata_table_lookup(&hash_key);
     if (lookup_value != NULL) {
         pdc_metadata_t *target;
         target = find_metadata_by_id_from_list(lookup_value->metadata, obj_id);
@@ -2794,7 +3624,7 @@ PDC_Server_get_kvtag(metadata_get_kvtag_in_t *in, metadata_get_kvtag_out_t *out)
 
 #ifdef ENABLE_MULTITHREAD
     // ^ Release hash table lock
-    hg_thread_mutex_unlock(&pdc_metadata_hash_table_mutex_g);
+    hg_thread_mutex_unlock(&PDC_Server_metadata_shard(hash_key)->mutex);
     unlocked = 1;
 #endif
 
@@ -2819,7 +3649,7 @@ PDC_Server_get_kvtag(metadata_get_kvtag_in_t *in, metadata_get_kvtag_out_t *out)
 done:
 #ifdef ENABLE_MULTITHREAD
     if (unlocked == 0)
-        hg_thread_mutex_unlock(&pdc_metadata_hash_table_mutex_g);
+        hg_thread_mutex_unlock(&PDC_Server_metadata_shard(hash_key)->mutex);
 #endif
     fflush(stdout);
 
@@ -2878,15 +3708,16 @@ PDC_Server_del_kvtag(metadata_get_kvtag_in_t *in, metadata_add_tag_out_t *out)
 #ifdef ENABLE_MULTITHREAD
     // Obtain lock for hash table
     unlocked = 0;
-    hg_thread_mutex_lock(&pdc_metadata_hash_table_mutex_g);
+    hg_thread_mutex_lock(&PDC_Server_metadata_shard(hash_key)->mutex);
 #endif
 
-    lookup_value = hash_table_lookup(metadata_hash_table_g, &hash_key);
+    lookup_value = PDC_Server_metadata_table_lookup(&hash_key);
     if (lookup_value != NULL) {
         pdc_metadata_t *target;
         target = find_metadata_by_id_from_list(lookup_value->metadata, obj_id);
         if (target != NULL) {
             PDC_del_kvtag_value_from_list(&target->kvtag_list_head, in->key);
+            PDC_Server_metadata_log_kvtag(PDC_METADATA_LOG_KVTAG_DEL, obj_id, hash_key, in->key, NULL, 0);
             out->ret = 1;
         }
         else {
@@ -2906,7 +3737,7 @@ PDC_Server_del_kvtag(metadata_get_kvtag_in_t *in, metadata_add_tag_out_t *out)
 
 #ifdef ENABLE_MULTITHREAD
     // ^ Release hash table lock
-    hg_thread_mutex_unlock(&pdc_metadata_hash_table_mutex_g);
+    hg_thread_mutex_unlock(&PDC_Server_metadata_shard(hash_key)->mutex);
     unlocked = 1;
 #endif
 
@@ -2931,8 +3762,713 @@ PDC_Server_del_kvtag(metadata_get_kvtag_in_t *in, metadata_add_tag_out_t *out)
 done:
 #ifdef ENABLE_MULTITHREAD
     if (unlocked == 0)
-        hg_thread_mutex_unlock(&pdc_metadata_hash_table_mutex_g);
+        hg_thread_mutex_unlock(&PDC_Server_metadata_shard(hash_key)->mutex);
+#endif
+    fflush(stdout);
+
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Get the file name of a metadata log segment
+ *
+ * \param  gen [IN]             Generation of the segment
+ * \param  name [OUT]           File name
+ * \param  len [IN]             Size of the file name buffer
+ *
+ * \return void
+ */
+static void
+PDC_Server_metadata_log_name(int gen, char *name, size_t len)
+{
+    snprintf(name, len, "%smetadata_log.%d.%d", pdc_server_tmp_dir_g, pdc_server_rank_g, gen);
+}
+
+/*
+ * Create a new log segment and make it the current one, caller holds the log lock
+ *
+ * \param  gen [IN]             Generation of the segment
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_metadata_log_open(int gen)
+{
+    perr_t ret_value = SUCCEED;
+    char   name[ADDR_MAX + 64];
+
+    FUNC_ENTER(NULL);
+
+    PDC_Server_metadata_log_name(gen, name, sizeof(name));
+    metadata_log_fd_g = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (metadata_log_fd_g < 0) {
+        printf("==PDC_SERVER[%d]: %s - ERROR opening metadata log [%s], %s\n", pdc_server_rank_g, __func__,
+               name, strerror(errno));
+        ret_value = FAIL;
+        goto done;
+    }
+    metadata_log_gen_g       = gen;
+    metadata_log_file_size_g = 0;
+    metadata_log_dirty_g     = 0;
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDC_Server_metadata_log_sync()
+{
+    perr_t                  ret_value = SUCCEED;
+    pdc_metadata_log_ack_t *ack, *next;
+
+    FUNC_ENTER(NULL);
+
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&metadata_log_mutex_g);
+#endif
+    if (metadata_log_fd_g >= 0) {
+        // All records appended since the last sync are committed together
+        if (metadata_log_buf_size_g > 0)
+            ret_value = PDC_Server_metadata_log_write_out();
+        if (ret_value == SUCCEED && metadata_log_dirty_g == 1) {
+            if (fdatasync(metadata_log_fd_g) != 0) {
+                printf("==PDC_SERVER[%d]: %s - ERROR syncing metadata log, %s\n", pdc_server_rank_g,
+                       __func__, strerror(errno));
+                ret_value = FAIL;
+            }
+            else
+                metadata_log_dirty_g = 0;
+        }
+    }
+    // The changes of the waiting responses are committed now, otherwise they wait for the next retry
+    ack = NULL;
+    if (ret_value == SUCCEED) {
+        ack                     = metadata_log_ack_head_g;
+        metadata_log_ack_head_g = NULL;
+        metadata_log_ack_tail_g = NULL;
+    }
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&metadata_log_mutex_g);
+#endif
+
+    while (ack != NULL) {
+        next = ack->next;
+        HG_Respond(ack->handle, NULL, NULL, ack->out);
+        HG_Destroy(ack->handle);
+        free(ack);
+        ack = next;
+    }
+
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDC_Server_metadata_log_respond(hg_handle_t handle, void *out, size_t out_size)
+{
+    perr_t                  ret_value = SUCCEED;
+    pdc_metadata_log_ack_t *ack       = NULL;
+
+    FUNC_ENTER(NULL);
+
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&metadata_log_mutex_g);
+#endif
+    // Wait for the next sync while any record is not on storage, otherwise respond now
+    if (metadata_log_fd_g >= 0 && (metadata_log_buf_size_g > 0 || metadata_log_dirty_g == 1)) {
+        ack = (pdc_metadata_log_ack_t *)malloc(sizeof(pdc_metadata_log_ack_t) + out_size);
+        if (ack != NULL) {
+            ack->handle = handle;
+            ack->out    = (char *)ack + sizeof(pdc_metadata_log_ack_t);
+            ack->next   = NULL;
+            memcpy(ack->out, out, out_size);
+            HG_Ref_incr(handle);
+            if (metadata_log_ack_tail_g == NULL)
+                metadata_log_ack_head_g = ack;
+            else
+                metadata_log_ack_tail_g->next = ack;
+            metadata_log_ack_tail_g = ack;
+        }
+    }
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&metadata_log_mutex_g);
+#endif
+
+    if (ack == NULL && HG_Respond(handle, NULL, NULL, out) != HG_SUCCESS)
+        ret_value = FAIL;
+
+    FUNC_LEAVE(ret_value);
+}
+
+uint64_t
+PDC_Server_metadata_log_size()
+{
+    uint64_t ret_value;
+
+    FUNC_ENTER(NULL);
+
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&metadata_log_mutex_g);
+#endif
+    ret_value = metadata_log_file_size_g + metadata_log_buf_size_g;
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&metadata_log_mutex_g);
+#endif
+
+    FUNC_LEAVE(ret_value);
+}
+
+int
+PDC_Server_metadata_log_rotate()
+{
+    int ret_value = -1;
+
+    FUNC_ENTER(NULL);
+
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&metadata_log_mutex_g);
+#endif
+    if (metadata_log_fd_g >= 0) {
+        // Keep the segment if its records can not be committed, they are retried by the next sync
+        if (metadata_log_buf_size_g > 0 && PDC_Server_metadata_log_write_out() != SUCCEED)
+            goto unlock;
+        if (fdatasync(metadata_log_fd_g) != 0) {
+            printf("==PDC_SERVER[%d]: %s - ERROR syncing metadata log, %s\n", pdc_server_rank_g, __func__,
+                   strerror(errno));
+            goto unlock;
+        }
+        close(metadata_log_fd_g);
+        metadata_log_fd_g = -1;
+
+        if (PDC_Server_metadata_log_open(metadata_log_gen_g + 1) == SUCCEED)
+            ret_value = metadata_log_gen_g;
+    }
+unlock:
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&metadata_log_mutex_g);
+#endif
+
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDC_Server_metadata_log_remove(int gen)
+{
+    perr_t ret_value = SUCCEED;
+    char   name[ADDR_MAX + 64];
+    int    i;
+
+    FUNC_ENTER(NULL);
+
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&metadata_log_mutex_g);
+#endif
+    for (i = metadata_log_first_gen_g; i < gen && i < metadata_log_gen_g; i++) {
+        PDC_Server_metadata_log_name(i, name, sizeof(name));
+        if (unlink(name) != 0 && errno != ENOENT) {
+            printf("==PDC_SERVER[%d]: %s - ERROR removing metadata log [%s], %s\n", pdc_server_rank_g,
+                   __func__, name, strerror(errno));
+            ret_value = FAIL;
+            break;
+        }
+        metadata_log_first_gen_g = i + 1;
+    }
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&metadata_log_mutex_g);
 #endif
+
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDC_Server_metadata_log_close()
+{
+    perr_t                  ret_value = SUCCEED;
+    pdc_metadata_log_ack_t *ack, *next;
+
+    FUNC_ENTER(NULL);
+
+    ret_value = PDC_Server_metadata_log_sync();
+
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_lock(&metadata_log_mutex_g);
+#endif
+    if (metadata_log_fd_g >= 0) {
+        close(metadata_log_fd_g);
+        metadata_log_fd_g = -1;
+    }
+    // The changes of the responses still waiting could not be committed, they are never answered
+    for (ack = metadata_log_ack_head_g; ack != NULL; ack = next) {
+        next = ack->next;
+        HG_Destroy(ack->handle);
+        free(ack);
+    }
+    metadata_log_ack_head_g = NULL;
+    metadata_log_ack_tail_g = NULL;
+    free(metadata_log_buf_g);
+    metadata_log_buf_g       = NULL;
+    metadata_log_buf_size_g  = 0;
+    metadata_log_buf_alloc_g = 0;
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_unlock(&metadata_log_mutex_g);
+#endif
+
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Replay a metadata record, updating the existing object or inserting it to the hash table
+ *
+ * \param  buf [IN]             Serialized metadata
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_metadata_log_replay_put(void *buf)
+{
+    perr_t                     ret_value = SUCCEED;
+    pdc_metadata_t             meta, *target = NULL;
+    pdc_hash_table_entry_head *lookup_value;
+    uint32_t                   hash_key;
+
+    FUNC_ENTER(NULL);
+
+    PDC_metadata_deserialize(buf, &meta);
+    if (meta.obj_name == NULL || meta.app_name == NULL || meta.tags == NULL || meta.data_location == NULL) {
+        printf("==PDC_SERVER[%d]: %s - cannot intern metadata strings\n", pdc_server_rank_g, __func__);
+        PDC_metadata_release_strs(&meta);
+        ret_value = FAIL;
+        goto done;
+    }
+
+    hash_key     = PDC_get_hash_by_name(meta.obj_name);
+    lookup_value = PDC_Server_metadata_table_lookup(&hash_key);
+    if (lookup_value != NULL)
+        target = find_metadata_by_id_from_list(lookup_value->metadata, meta.obj_id);
+
+    if (target != NULL) {
+        // Later state of an existing object, its kvtags and regions are logged separately
+        if (target->time_step != meta.time_step) {
+            PDC_Server_name_bloom_remove(lookup_value, target);
+            target->time_step = meta.time_step;
+            PDC_Server_name_bloom_update(lookup_value, target);
+        }
+        // The record keeps its name, the other strings of the later state replace its own
+        PDC_metadata_intern_release(meta.obj_name);
+        PDC_metadata_intern_release(target->app_name);
+        PDC_metadata_intern_release(target->tags);
+        PDC_metadata_intern_release(target->data_location);
+        target->user_id            = meta.user_id;
+        target->app_name           = meta.app_name;
+        target->data_type          = meta.data_type;
+        target->cont_id            = meta.cont_id;
+        target->create_time        = meta.create_time;
+        target->last_modified_time = meta.last_modified_time;
+        target->tags               = meta.tags;
+        target->data_location      = meta.data_location;
+        target->ndim               = meta.ndim;
+        memcpy(target->dims, meta.dims, sizeof(uint64_t) * DIM_MAX);
+        target->stripe_size      = meta.stripe_size;
+        target->stripe_count     = meta.stripe_count;
+        target->compress         = meta.compress;
+        target->compress_level   = meta.compress_level;
+        target->error_bound_mode = meta.error_bound_mode;
+        target->error_bound      = meta.error_bound;
+        target->transform_state  = meta.transform_state;
+        target->current_state    = meta.current_state;
+    }
+    else {
+        target = (pdc_metadata_t *)malloc(sizeof(pdc_metadata_t));
+        if (target == NULL) {
+            printf("==PDC_SERVER[%d]: %s - cannot allocate metadata\n", pdc_server_rank_g, __func__);
+            PDC_metadata_release_strs(&meta);
+            ret_value = FAIL;
+            goto done;
+        }
+        *target                                = meta;
+        target->prev                           = NULL;
+        target->next                           = NULL;
+        target->bloom                          = NULL;
+        target->kvtag_list_head                = NULL;
+        target->storage_region_list_head       = NULL;
+        target->all_storage_region_distributed = 0;
+        target->region_lock_head               = NULL;
+        target->region_map_head                = NULL;
+        target->region_buf_map_head            = NULL;
+        target->obj_hist                       = NULL;
+        total_mem_usage_g += sizeof(pdc_metadata_t);
+
+        if (lookup_value == NULL) {
+            lookup_value = (pdc_hash_table_entry_head *)malloc(sizeof(pdc_hash_table_entry_head));
+            lookup_value->metadata = NULL;
+            lookup_value->n_obj    = 0;
+            total_mem_usage_g += sizeof(pdc_hash_table_entry_head);
+            PDC_Server_hash_table_list_init(lookup_value, &hash_key);
+        }
+
+        ret_value = PDC_Server_hash_table_list_insert(lookup_value, target);
+        n_metadata_g++;
+    }
+
+    // Do not hand out the ids of replayed objects again
+    if (meta.obj_id >= pdc_id_seq_g)
+        pdc_id_seq_g = meta.obj_id + 1;
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Replay a container record, updating the existing container or inserting it to the hash table
+ *
+ * \param  rec [IN]             Container record
+ * \param  size [IN]            Size of the record
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_metadata_log_replay_cont(pdc_metadata_log_cont_t *rec, uint32_t size)
+{
+    perr_t                       ret_value = SUCCEED;
+    pdc_cont_hash_table_entry_t *cont_entry;
+    uint64_t *                   obj_ids = NULL;
+    const char *                 name, *tags;
+    uint32_t                     hash_key;
+
+    FUNC_ENTER(NULL);
+
+    name = (const char *)(rec + 1);
+    tags = name + rec->name_len;
+    if (size < sizeof(pdc_metadata_log_cont_t) || rec->name_len == 0 || rec->name_len > ADDR_MAX ||
+        rec->tags_len == 0 || rec->tags_len > TAG_LEN_MAX || rec->n_obj < 0 ||
+        size != sizeof(pdc_metadata_log_cont_t) + rec->name_len + rec->tags_len +
+                    sizeof(uint64_t) * rec->n_obj ||
+        name[rec->name_len - 1] != '\0' || tags[rec->tags_len - 1] != '\0') {
+        printf("==PDC_SERVER[%d]: %s - invalid container record\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
+    if (rec->n_obj > 0) {
+        obj_ids = (uint64_t *)malloc(sizeof(uint64_t) * rec->n_obj);
+        if (obj_ids == NULL) {
+            printf("==PDC_SERVER[%d]: %s - cannot allocate object IDs\n", pdc_server_rank_g, __func__);
+            ret_value = FAIL;
+            goto done;
+        }
+        memcpy(obj_ids, tags + rec->tags_len, sizeof(uint64_t) * rec->n_obj);
+    }
+
+    hash_key   = PDC_get_hash_by_name(name);
+    cont_entry = hash_table_lookup(container_hash_table_g, &hash_key);
+    if (cont_entry == NULL) {
+        cont_entry = (pdc_cont_hash_table_entry_t *)calloc(1, sizeof(pdc_cont_hash_table_entry_t));
+        if (cont_entry == NULL || hash_table_insert(container_hash_table_g, &hash_key, cont_entry) != 1) {
+            printf("==PDC_SERVER[%d]: %s - cannot insert container\n", pdc_server_rank_g, __func__);
+            free(cont_entry);
+            ret_value = FAIL;
+            goto done;
+        }
+        total_mem_usage_g += sizeof(pdc_cont_hash_table_entry_t);
+    }
+
+    // Later state of the container, its kvtags are logged separately
+    cont_entry->cont_id = rec->cont_id;
+    strcpy(cont_entry->cont_name, name);
+    strcpy(cont_entry->tags, tags);
+    free(cont_entry->obj_ids);
+    cont_entry->obj_ids     = obj_ids;
+    cont_entry->n_obj       = rec->n_obj;
+    cont_entry->n_allocated = rec->n_obj;
+    cont_entry->n_deleted   = rec->n_deleted;
+    obj_ids                 = NULL;
+
+    // Do not hand out the ids of replayed containers again
+    if (rec->cont_id >= pdc_id_seq_g)
+        pdc_id_seq_g = rec->cont_id + 1;
+
+done:
+    free(obj_ids);
+
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Replay a kvtag record, on an object or on a container
+ *
+ * \param  op [IN]              PDC_METADATA_LOG_KVTAG_ADD or PDC_METADATA_LOG_KVTAG_DEL
+ * \param  rec [IN]             Kvtag record
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_metadata_log_replay_kvtag(uint32_t op, pdc_metadata_log_kvtag_t *rec)
+{
+    perr_t                       ret_value = SUCCEED;
+    pdc_hash_table_entry_head *  lookup_value;
+    pdc_cont_hash_table_entry_t *cont_lookup_value;
+    pdc_metadata_t *             target    = NULL;
+    pdc_kvtag_list_t **          list_head = NULL;
+    pdc_kvtag_t                  kvtag;
+    uint32_t                     hash_key;
+
+    FUNC_ENTER(NULL);
+
+    hash_key     = rec->hash_value;
+    lookup_value = PDC_Server_metadata_table_lookup(&hash_key);
+    if (lookup_value != NULL) {
+        target = find_metadata_by_id_from_list(lookup_value->metadata, rec->obj_id);
+        if (target != NULL)
+            list_head = &target->kvtag_list_head;
+    }
+    else {
+        cont_lookup_value = hash_table_lookup(container_hash_table_g, &hash_key);
+        if (cont_lookup_value != NULL)
+            list_head = &cont_lookup_value->kvtag_list_head;
+    }
+
+    if (list_head == NULL) {
+        printf("==PDC_SERVER[%d]: %s - kvtag target %" PRIu64 " not found\n", pdc_server_rank_g, __func__,
+               rec->obj_id);
+        ret_value = FAIL;
+        goto done;
+    }
+
+    // A replayed tag replaces any tag with the same name, so replaying twice gives the same result
+    kvtag.name  = (char *)(rec + 1);
+    kvtag.size  = rec->value_size;
+    kvtag.value = kvtag.name + rec->name_len;
+    PDC_del_kvtag_value_from_list(list_head, kvtag.name);
+    if (op == PDC_METADATA_LOG_KVTAG_ADD)
+        PDC_add_kvtag_to_list(list_head, &kvtag);
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Replay a region storage update record
+ *
+ * \param  rec [IN]             Region record
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_metadata_log_replay_region(pdc_metadata_log_region_t *rec)
+{
+    perr_t           ret_value = SUCCEED;
+    region_list_t *  region;
+    pdc_histogram_t *hist = NULL;
+    char *           ptr;
+    int              i;
+
+    FUNC_ENTER(NULL);
+
+    region = (region_list_t *)malloc(sizeof(region_list_t));
+    if (region == NULL) {
+        printf("==PDC_SERVER[%d]: %s - cannot allocate region\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
+    PDC_init_region_list(region);
+    region->ndim = rec->ndim;
+    for (i = 0; i < rec->ndim; i++) {
+        region->start[i] = rec->start[i];
+        region->count[i] = rec->count[i];
+    }
+    region->offset       = rec->offset;
+    region->compress     = rec->compress;
+    region->storage_size = rec->storage_size;
+    ptr            = (char *)(rec + 1);
+    strncpy(region->storage_location, ptr, ADDR_MAX - 1);
+    ptr += rec->loc_len;
+
+    if (rec->nbin > 0) {
+        hist        = (pdc_histogram_t *)malloc(sizeof(pdc_histogram_t));
+        hist->dtype = rec->dtype;
+        hist->nbin  = rec->nbin;
+        hist->incr  = rec->incr;
+        hist->range = (double *)malloc(sizeof(double) * rec->nbin * 2);
+        hist->bin   = (uint64_t *)malloc(sizeof(uint64_t) * rec->nbin);
+        memcpy(hist->range, ptr, sizeof(double) * rec->nbin * 2);
+        ptr += sizeof(double) * rec->nbin * 2;
+        memcpy(hist->bin, ptr, sizeof(uint64_t) * rec->nbin);
+        ptr += sizeof(uint64_t) * rec->nbin;
+        region->region_hist = hist;
+    }
+    if (rec->sketch_size > 0)
+        region->region_sketch = PDC_sketch_deserialize(ptr, rec->sketch_size);
+
+    // The metadata takes the histogram and copies the sketch, the region itself is copied
+    ret_value = PDC_Server_update_local_region_storage_loc(region, rec->obj_id, rec->type);
+    if (ret_value != SUCCEED && hist != NULL)
+        PDC_free_hist(hist);
+    PDC_sketch_free(region->region_sketch);
+    free(region);
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+/*
+ * Replay all records of a metadata log segment, an incomplete record at the end is ignored
+ *
+ * \param  name [IN]            File name of the segment
+ * \param  n_op [OUT]           Number of replayed records
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_metadata_log_replay_file(const char *name, int *n_op)
+{
+    perr_t                      ret_value = SUCCEED;
+    pdc_metadata_log_rec_t      rec;
+    metadata_delete_by_id_in_t  del_in;
+    metadata_delete_by_id_out_t del_out;
+    FILE *                      file;
+    void *                      payload;
+
+    FUNC_ENTER(NULL);
+
+    file = fopen(name, "r");
+    if (file == NULL) {
+        printf("==PDC_SERVER[%d]: %s - ERROR opening metadata log [%s]\n", pdc_server_rank_g, __func__, name);
+        ret_value = FAIL;
+        goto done;
+    }
+
+    metadata_log_replay_g = 1;
+    while (fread(&rec, sizeof(pdc_metadata_log_rec_t), 1, file) == 1) {
+        payload = malloc(rec.size);
+        if (payload == NULL || fread(payload, rec.size, 1, file) != 1) {
+            printf("==PDC_SERVER[%d]: %s - ignoring incomplete record at the end of [%s]\n",
+                   pdc_server_rank_g, __func__, name);
+            free(payload);
+            break;
+        }
+
+        switch (rec.op) {
+            case PDC_METADATA_LOG_PUT:
+                PDC_Server_metadata_log_replay_put(payload);
+                break;
+            case PDC_METADATA_LOG_DELETE:
+                del_in.obj_id = *(uint64_t *)payload;
+                PDC_Server_delete_metadata_by_id(&del_in, &del_out);
+                break;
+            case PDC_METADATA_LOG_KVTAG_ADD:
+            case PDC_METADATA_LOG_KVTAG_DEL:
+                PDC_Server_metadata_log_replay_kvtag(rec.op, (pdc_metadata_log_kvtag_t *)payload);
+                break;
+            case PDC_METADATA_LOG_REGION:
+                PDC_Server_metadata_log_replay_region((pdc_metadata_log_region_t *)payload);
+                break;
+            case PDC_METADATA_LOG_CONT:
+                PDC_Server_metadata_log_replay_cont((pdc_metadata_log_cont_t *)payload, rec.size);
+                break;
+            default:
+                printf("==PDC_SERVER[%d]: %s - unknown record type %u in [%s]\n", pdc_server_rank_g, __func__,
+                       rec.op, name);
+                break;
+        }
+        free(payload);
+        (*n_op)++;
+    }
+    metadata_log_replay_g = 0;
+
+    fclose(file);
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+static int
+PDC_Server_metadata_log_gen_cmp(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+/*
+ * Find the generations of the log segments of this server in the tmp dir
+ *
+ * \param  gens [OUT]           Sorted generations, to be freed by the caller
+ *
+ * \return Number of segments
+ */
+static int
+PDC_Server_metadata_log_scan(int **gens)
+{
+    int            ret_value = 0, n_alloc = 0, rank, gen, len;
+    int *          tmp;
+    DIR *          dir;
+    struct dirent *ent;
+
+    FUNC_ENTER(NULL);
+
+    *gens = NULL;
+    dir   = opendir(pdc_server_tmp_dir_g);
+    if (dir == NULL)
+        goto done;
+
+    while ((ent = readdir(dir)) != NULL) {
+        len = 0;
+        if (sscanf(ent->d_name, "metadata_log.%d.%d%n", &rank, &gen, &len) != 2 || ent->d_name[len] != 0 ||
+            rank != pdc_server_rank_g)
+            continue;
+        if (ret_value == n_alloc) {
+            n_alloc = n_alloc == 0 ? 16 : n_alloc * 2;
+            tmp     = (int *)realloc(*gens, sizeof(int) * n_alloc);
+            if (tmp == NULL)
+                break;
+            *gens = tmp;
+        }
+        (*gens)[ret_value++] = gen;
+    }
+    closedir(dir);
+
+    if (ret_value > 1)
+        qsort(*gens, ret_value, sizeof(int), PDC_Server_metadata_log_gen_cmp);
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDC_Server_metadata_log_init()
+{
+    perr_t ret_value = SUCCEED;
+    char   name[ADDR_MAX + 64];
+    int *  gens = NULL;
+    int    n_gen, i, n_op = 0, gen = 0;
+
+    FUNC_ENTER(NULL);
+
+    if (disable_metadata_log_g == 1)
+        goto done;
+
+    n_gen = PDC_Server_metadata_log_scan(&gens);
+    for (i = 0; i < n_gen; i++) {
+        PDC_Server_metadata_log_name(gens[i], name, sizeof(name));
+        // Changes since the checkpoint are replayed on restart, a new run starts without them
+        if (is_restart_g == 1) {
+            if (PDC_Server_metadata_log_replay_file(name, &n_op) != SUCCEED) {
+                ret_value = FAIL;
+                goto done;
+            }
+        }
+        else
+            unlink(name);
+    }
+    if (n_gen > 0 && is_restart_g == 1) {
+        metadata_log_first_gen_g = gens[0];
+        gen                      = gens[n_gen - 1] + 1;
+        printf("==PDC_SERVER[%d]: replayed %d metadata log records from %d segments\n", pdc_server_rank_g,
+               n_op, n_gen);
+    }
+    else
+        metadata_log_first_gen_g = 0;
+
+    ret_value = PDC_Server_metadata_log_open(gen);
+
+done:
+    free(gens);
     fflush(stdout);
 
     FUNC_LEAVE(ret_value);
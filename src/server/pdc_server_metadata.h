@@ -31,13 +31,36 @@
 #include "mercury_macros.h"
 #include "mercury_proc_string.h"
 #include "mercury_atomic.h"
+#ifdef ENABLE_MULTITHREAD
+#include "mercury_thread_mutex.h"
+#endif
 
 #include "pdc_hash-table.h"
+#include "pdc_bloom.h"
 
 #include "pdc_server_common.h"
 #include "pdc_client_server_common.h"
 
-#define CREATE_BLOOM_THRESHOLD 64
+// Initial number of names of the name bloom filter, it is rebuilt with twice the capacity once full
+#define PDC_NAME_BLOOM_CAPACITY 65536
+
+// The metadata hash table is split into 2^PDC_METADATA_SHARD_BITS shards by name hash, at most 32
+#define PDC_METADATA_SHARD_BITS 4
+#define PDC_METADATA_N_SHARD    (1 << PDC_METADATA_SHARD_BITS)
+#define PDC_METADATA_SHARD_ALL  0xFFFFFFFFU
+
+// Time a client may use the metadata of a query result without asking the server again
+#define PDC_METADATA_LEASE_MS 1000
+
+// Record types of the metadata write-ahead log
+#define PDC_METADATA_LOG_PUT       1
+#define PDC_METADATA_LOG_DELETE    2
+#define PDC_METADATA_LOG_KVTAG_ADD 3
+#define PDC_METADATA_LOG_KVTAG_DEL 4
+#define PDC_METADATA_LOG_REGION    5
+#define PDC_METADATA_LOG_CONT      6
+// Pending log records are written out once they reach this size, even before the next sync
+#define PDC_METADATA_LOG_BUF_SIZE 1048576
 
 /*****************************/
 /* Library-private Variables */
@@ -46,7 +69,6 @@ extern int           pdc_server_rank_g;
 extern int           pdc_server_size_g;
 extern char          pdc_server_tmp_dir_g[ADDR_MAX];
 extern uint32_t      n_metadata_g;
-extern HashTable *   metadata_hash_table_g;
 extern HashTable *   container_hash_table_g;
 extern hg_class_t *  hg_class_g;
 extern hg_context_t *hg_context_g;
@@ -59,16 +81,40 @@ extern pdc_remote_server_info_t *pdc_remote_server_info_g;
 extern double                    total_mem_usage_g;
 extern int                       is_hash_table_init_g;
 extern int                       is_restart_g;
+extern int                       disable_metadata_log_g;
+extern int                       disable_name_bloom_g;
+extern uint64_t                  name_bloom_capacity_g;
+extern uint32_t                  metadata_lease_ms_g;
 
 /****************************/
 /* Library Private Typedefs */
 /****************************/
+// One shard of the metadata hash table, with the name bloom filter of its objects
+typedef struct pdc_metadata_shard_t {
+    HashTable *  table;
+    pdc_bloom_t *name_bloom;
+    uint64_t     name_bloom_n_del;
+    int          name_bloom_n_rebuild;
+    int          n_bloom_total;
+    int          n_bloom_maybe;
+    int          n_bloom_false_pos;
+#ifdef ENABLE_MULTITHREAD
+    hg_thread_mutex_t mutex;
+#endif
+} pdc_metadata_shard_t;
+
 typedef struct pdc_hash_table_entry_head {
-    int             n_obj;
-    void *          bloom;
-    pdc_metadata_t *metadata;
+    int                   n_obj;
+    pdc_metadata_t *      metadata;
+    pdc_metadata_shard_t *shard;
 } pdc_hash_table_entry_head;
 
+// Iterator over the entries of all shards of the metadata hash table
+typedef struct pdc_metadata_table_iter_t {
+    int               shard;
+    HashTableIterator iter;
+} pdc_metadata_table_iter_t;
+
 typedef struct pdc_cont_hash_table_entry_t {
     uint64_t          cont_id;
     char              cont_name[ADDR_MAX];
@@ -80,6 +126,54 @@ typedef struct pdc_cont_hash_table_entry_t {
     pdc_kvtag_list_t *kvtag_list_head;
 } pdc_cont_hash_table_entry_t;
 
+// Header of a metadata log record, followed by size bytes of payload
+typedef struct pdc_metadata_log_rec_t {
+    uint32_t op;
+    uint32_t size;
+} pdc_metadata_log_rec_t;
+
+// Payload of a kvtag log record, followed by the tag name and the tag value
+typedef struct pdc_metadata_log_kvtag_t {
+    uint64_t obj_id;
+    uint32_t hash_value;
+    uint32_t name_len;
+    uint32_t value_size;
+} pdc_metadata_log_kvtag_t;
+
+// Payload of a region log record, followed by the storage location, the histogram range and bins and the
+// serialized sketch
+typedef struct pdc_metadata_log_region_t {
+    uint64_t obj_id;
+    int32_t  type;
+    int32_t  ndim;
+    uint64_t start[DIM_MAX];
+    uint64_t count[DIM_MAX];
+    uint64_t offset;
+    uint64_t storage_size;
+    int32_t  compress;
+    int32_t  loc_len;
+    int32_t  nbin;
+    int32_t  dtype;
+    uint32_t sketch_size;
+    double   incr;
+} pdc_metadata_log_region_t;
+
+// Payload of a container log record, followed by the container name, its tags and its object IDs
+typedef struct pdc_metadata_log_cont_t {
+    uint64_t cont_id;
+    int32_t  n_obj;
+    int32_t  n_deleted;
+    uint32_t name_len;
+    uint32_t tags_len;
+} pdc_metadata_log_cont_t;
+
+// Response of a metadata change, sent once the log records of the change are synced
+typedef struct pdc_metadata_log_ack_t {
+    hg_handle_t                    handle;
+    void *                         out;
+    struct pdc_metadata_log_ack_t *next;
+} pdc_metadata_log_ack_t;
+
 /***************************************/
 /* Library-private Function Prototypes */
 /***************************************/
@@ -93,6 +187,19 @@ typedef struct pdc_cont_hash_table_entry_t {
  */
 perr_t PDC_insert_metadata_to_hash_table(gen_obj_id_in_t *in, gen_obj_id_out_t *out);
 
+/**
+ * Create a batch of objects with shared properties, either all of them or none
+ *
+ * \param in [IN]               Input structure received from client, contains the shared properties
+ * \param buf [IN]              Name hash values followed by the '\0' terminated names
+ * \param buf_size [IN]         Size of buf in bytes
+ * \param out [OUT]             First object ID and number of objects created
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_Server_create_metadata_batch(metadata_bulk_create_in_t *in, void *buf, uint64_t buf_size,
+                                        metadata_bulk_create_out_t *out);
+
 /**
  * Metadata server process buffer map
  *
@@ -158,6 +265,16 @@ perr_t PDC_Server_search_with_name_hash(const char *obj_name, uint32_t hash_key,
 perr_t PDC_Server_search_with_name_timestep(const char *obj_name, uint32_t hash_key, uint32_t ts,
                                             pdc_metadata_t **out);
 
+/**
+ * Get the lease granted to a client with the metadata of an object, the client does not ask the server
+ * for the object again until the lease expires
+ *
+ * \param meta [IN]             Pointer to the metadata of the object
+ *
+ * \return Lease in milliseconds, 0 if the client must not cache the metadata
+ */
+uint32_t PDC_Server_get_metadata_lease(pdc_metadata_t *meta);
+
 /**
  * Get the metadata that satisfies the query constraint
  *
@@ -291,6 +408,13 @@ perr_t PDC_Server_metadata_duplicate_check();
  */
 perr_t PDC_Server_init_hash_table();
 
+/**
+ * Report the lookups gated by the name bloom filter over all servers and free the filter
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_Server_name_bloom_finalize();
+
 /**
  * Init a metadata list (doubly linked) under the given hash table entry
  *
@@ -311,6 +435,94 @@ perr_t PDC_Server_hash_table_list_init(pdc_hash_table_entry_head *entry, uint32_
  */
 perr_t PDC_Server_hash_table_list_insert(pdc_hash_table_entry_head *head, pdc_metadata_t *new);
 
+/**
+ * Get the index of the metadata hash table shard of a name hash value
+ *
+ * \param hash_key [IN]         Hash value of the object name
+ *
+ * \return Index of the shard
+ */
+int PDC_Server_metadata_shard_index(uint32_t hash_key);
+
+/**
+ * Get the metadata hash table shard of a name hash value, operations on the entry of the hash value
+ * must hold the mutex of this shard
+ *
+ * \param hash_key [IN]         Hash value of the object name
+ *
+ * \return Pointer to the shard
+ */
+pdc_metadata_shard_t *PDC_Server_metadata_shard(uint32_t hash_key);
+
+/**
+ * Lock a set of metadata hash table shards, always in shard order
+ *
+ * \param shard_mask [IN]       Bit i set to lock shard i, PDC_METADATA_SHARD_ALL for all shards
+ */
+void PDC_Server_metadata_table_lock(uint32_t shard_mask);
+
+/**
+ * Unlock a set of metadata hash table shards
+ *
+ * \param shard_mask [IN]       Bit i set to unlock shard i, PDC_METADATA_SHARD_ALL for all shards
+ */
+void PDC_Server_metadata_table_unlock(uint32_t shard_mask);
+
+/**
+ * Look up the metadata hash table entry of a name hash value
+ *
+ * \param hash_key [IN]         Pointer to the hash value of the object name
+ *
+ * \return Pointer to the entry on success/NULL if there is no entry
+ */
+pdc_hash_table_entry_head *PDC_Server_metadata_table_lookup(uint32_t *hash_key);
+
+/**
+ * Remove the metadata hash table entry of a name hash value
+ *
+ * \param hash_key [IN]         Pointer to the hash value of the object name
+ *
+ * \return Non-zero if an entry was removed/zero otherwise
+ */
+int PDC_Server_metadata_table_remove(uint32_t *hash_key);
+
+/**
+ * Get the number of entries of all shards of the metadata hash table
+ *
+ * \return Number of entries
+ */
+unsigned int PDC_Server_metadata_table_num_entries();
+
+/**
+ * Start an iteration over the entries of all shards of the metadata hash table
+ *
+ * \param iter [IN]             Pointer to the iterator to initialize
+ */
+void PDC_Server_metadata_table_iterate(pdc_metadata_table_iter_t *iter);
+
+/**
+ * Check if an iteration over the metadata hash table has more entries
+ *
+ * \param iter [IN]             Pointer to the iterator
+ *
+ * \return Non-zero if there are more entries/zero otherwise
+ */
+int PDC_Server_metadata_table_iter_has_more(pdc_metadata_table_iter_t *iter);
+
+/**
+ * Get the next entry of an iteration over the metadata hash table
+ *
+ * \param iter [IN]             Pointer to the iterator
+ *
+ * \return The next key and value pair
+ */
+HashTablePair PDC_Server_metadata_table_iter_next(pdc_metadata_table_iter_t *iter);
+
+/**
+ * Free all shards of the metadata hash table
+ */
+void PDC_Server_metadata_table_free();
+
 /**
  * Get the metadata with the specified object ID by iteration of all metadata in the hash table
  *
@@ -377,4 +589,72 @@ perr_t PDC_free_cont_hash_table();
  */
 perr_t PDC_Server_add_kvtag(metadata_add_kvtag_in_t *in, metadata_add_tag_out_t *out);
 
+/**
+ * Start the metadata log of this server, replaying the existing log segments on restart
+ * and removing them otherwise
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_Server_metadata_log_init();
+
+/**
+ * Write out the pending metadata log records, sync the log segment to storage and send the responses
+ * waiting for them, on failure the records and responses are kept for the next call
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_Server_metadata_log_sync();
+
+/**
+ * Respond to an RPC that changed metadata, after the log records of the change reach storage
+ *
+ * \param handle [IN]           RPC handle, the caller may destroy it
+ * \param out [IN]              Flat output struct of the RPC, copied
+ * \param out_size [IN]         Size of the output struct
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_Server_metadata_log_respond(hg_handle_t handle, void *out, size_t out_size);
+
+/**
+ * Sync and close the current log segment and start a new one
+ *
+ * \return Generation of the new segment/-1 if the log is not enabled
+ */
+int PDC_Server_metadata_log_rotate();
+
+/**
+ * Remove the log segments older than a generation, they are covered by a checkpoint
+ *
+ * \param gen [IN]              Generation of the oldest segment to keep
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_Server_metadata_log_remove(int gen);
+
+/**
+ * Get the size of the current log segment, including the records not written out yet
+ *
+ * \return Number of bytes in the current segment
+ */
+uint64_t PDC_Server_metadata_log_size();
+
+/**
+ * Sync and close the metadata log
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_Server_metadata_log_close();
+
+/**
+ * Append a region storage update to the metadata log
+ *
+ * \param obj_id [IN]           Object ID
+ * \param region [IN]           Region with its storage location and offset
+ * \param type [IN]             PDC_UPDATE_STORAGE or PDC_UPDATE_CACHE
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_Server_metadata_log_region(uint64_t obj_id, region_list_t *region, int type);
+
 #endif /* PDC_SERVER_METADATA_H */
@@ -0,0 +1,899 @@
+/*
+ * Copyright Notice for
+ * Proactive Data Containers (PDC) Software Library and Utilities
+ * -----------------------------------------------------------------------------
+
+ *** Copyright Notice ***
+
+ * Proactive Data Containers (PDC) Copyright (c) 2017, The Regents of the
+ * University of California, through Lawrence Berkeley National Laboratory,
+ * UChicago Argonne, LLC, operator of Argonne National Laboratory, and The HDF
+ * Group (subject to receipt of any required approvals from the U.S. Dept. of
+ * Energy).  All rights reserved.
+
+ * If you have questions about your rights to use or distribute this software,
+ * please contact Berkeley Lab's Innovation & Partnerships Office at  IPO@lbl.gov.
+
+ * NOTICE.  This Software was developed under funding from the U.S. Department of
+ * Energy and the U.S. Government consequently retains certain rights. As such, the
+ * U.S. Government has been granted for itself and others acting on its behalf a
+ * paid-up, nonexclusive, irrevocable, worldwide license in the Software to
+ * reproduce, distribute copies to the public, prepare derivative works, and
+ * perform publicly and display publicly, and to permit other to do so.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <sys/time.h>
+#include <sys/stat.h>
+
+#include "mercury_thread.h"
+#include "mercury_thread_mutex.h"
+#include "mercury_thread_condition.h"
+
+#include "pdc_config.h"
+#include "pdc_utlist.h"
+#include "pdc_client_server_common.h"
+#include "pdc_server_data.h"
+#include "pdc_server_tier.h"
+
+#define PDC_TIER_NO_OFFSET UINT64_MAX
+
+typedef enum { PDC_TIER_IDLE = 0, PDC_TIER_DRAIN = 1, PDC_TIER_PROMOTE = 2 } pdc_tier_state_t;
+
+// Fast tier file and object file of an object
+typedef struct pdc_tier_obj_t {
+    uint64_t obj_id;
+    int      fd; // fast tier file of the server thread
+    char     path[ADDR_MAX];
+    char     cap_path[ADDR_MAX];
+    uint64_t end;      // end of the fast tier file
+    uint64_t cap_end;  // end of the object file
+    int      n_region; // number of regions with space in the fast tier file
+
+    struct pdc_tier_obj_t *prev;
+    struct pdc_tier_obj_t *next;
+} pdc_tier_obj_t;
+
+// Tier state of a storage region
+typedef struct pdc_tier_region_t {
+    pdc_tier_obj_t * obj;
+    region_list_t *  region;
+    pdc_tier_state_t state;
+    int              copying;  // taken by the drain thread, until the copy is moved to its new tier
+    perr_t           copy_ret; // set by the drain thread
+    int              dirty;    // source of the copy was overwritten after the copy started
+    int              has_fast; // has space in the fast tier file
+    int              clean;    // in the fast tier with the same data in the object file
+    int              n_pin;    // I/O on the file from PDC_Server_tier_fd, the region is not moved meanwhile
+    uint64_t         fast_offset;
+    uint64_t         cap_offset;
+    uint64_t         n_read;
+    uint64_t         last_access;
+
+    struct pdc_tier_region_t *prev;
+    struct pdc_tier_region_t *next;
+    struct pdc_tier_region_t *qprev; // copy queue or copied list
+    struct pdc_tier_region_t *qnext;
+} pdc_tier_region_t;
+
+// Storage location of a moved region, to be sent to the metadata server of its object
+typedef struct pdc_tier_update_t {
+    uint64_t       obj_id;
+    region_list_t *src; // region it is copied from, later moves replace the update
+    region_list_t  region;
+
+    struct pdc_tier_update_t *prev;
+    struct pdc_tier_update_t *next;
+} pdc_tier_update_t;
+
+extern data_server_region_t *dataserver_region_g;
+
+static int                tier_enabled_g = 0;
+static char               tier_loc_g[ADDR_MAX];
+static uint64_t           tier_size_g          = 0; // capacity of the fast tier in bytes
+static uint64_t           tier_used_g          = 0; // fast tier space of regions in bytes
+static double             tier_drain_mbps_g    = 0; // 0 for unlimited drain bandwidth
+static int                tier_promote_reads_g = 0;
+static uint64_t           tier_clock_g         = 0;
+static int                tier_close_g         = 0;
+static int                tier_n_copy_g        = 0; // regions being copied by the drain thread
+static pdc_tier_obj_t *   tier_obj_head_g      = NULL;
+static pdc_tier_region_t *tier_region_head_g   = NULL;
+static pdc_tier_region_t *tier_queue_head_g    = NULL;
+static pdc_tier_region_t *tier_copied_head_g   = NULL;
+static pdc_tier_update_t *tier_update_head_g   = NULL;
+static hg_thread_t        tier_thread_g;
+static hg_thread_mutex_t  tier_mutex_g;
+static hg_thread_cond_t   tier_cond_g;
+
+/*
+ * Write a buffer to a file at an offset
+ *
+ * \param  fd[IN]           File descriptor
+ * \param  buf[IN]          Data to write
+ * \param  size[IN]         Size of the data
+ * \param  offset[IN]       Offset in the file
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_tier_pwrite(int fd, const char *buf, uint64_t size, uint64_t offset)
+{
+    ssize_t n;
+
+    while (size > 0) {
+        n = pwrite(fd, buf, size, offset);
+        if (n <= 0)
+            return FAIL;
+        buf += n;
+        size -= n;
+        offset += n;
+    }
+
+    return SUCCEED;
+}
+
+/*
+ * Copy data between the tiers, at most tier_drain_mbps_g MB/s. Run by the drain thread, with its own
+ * file descriptors.
+ *
+ * \param  src_path[IN]     Source file
+ * \param  src_offset[IN]   Offset in the source file
+ * \param  dst_path[IN]     Destination file
+ * \param  dst_offset[IN]   Offset in the destination file
+ * \param  size[IN]         Size of the data
+ * \param  buf[IN]          Copy buffer of PDC_TIER_COPY_SIZE bytes
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+static perr_t
+PDC_Server_tier_copy(const char *src_path, uint64_t src_offset, const char *dst_path, uint64_t dst_offset,
+                     uint64_t size, char *buf)
+{
+    perr_t         ret_value = SUCCEED;
+    int            src_fd = -1, dst_fd = -1;
+    uint64_t       copied, n;
+    double         elapsed, expected;
+    struct timeval start, now;
+
+    src_fd = open(src_path, O_RDONLY);
+    dst_fd = open(dst_path, O_WRONLY | O_CREAT, 0666);
+    if (src_fd == -1 || dst_fd == -1) {
+        printf("==PDC_SERVER[%d]: %s - unable to open [%s] or [%s]\n", pdc_server_rank_g, __func__, src_path,
+               dst_path);
+        ret_value = FAIL;
+        goto done;
+    }
+
+    gettimeofday(&start, 0);
+    for (copied = 0; copied < size; copied += n) {
+        n = size - copied < PDC_TIER_COPY_SIZE ? size - copied : PDC_TIER_COPY_SIZE;
+        if (pread(src_fd, buf, n, src_offset + copied) != (ssize_t)n ||
+            PDC_Server_tier_pwrite(dst_fd, buf, n, dst_offset + copied) != SUCCEED) {
+            printf("==PDC_SERVER[%d]: %s - error copying [%s] to [%s]\n", pdc_server_rank_g, __func__,
+                   src_path, dst_path);
+            ret_value = FAIL;
+            goto done;
+        }
+
+        // Throttle so the drain does not take the bandwidth of the clients' I/O
+        if (tier_drain_mbps_g > 0) {
+            gettimeofday(&now, 0);
+            elapsed  = PDC_get_elapsed_time_double(&start, &now);
+            expected = (copied + n) / (tier_drain_mbps_g * 1048576.0);
+            if (expected > elapsed)
+                usleep((useconds_t)((expected - elapsed) * 1000000.0));
+        }
+    }
+
+    // The fast tier space is released once the copy is in place
+    if (fsync(dst_fd) != 0)
+        ret_value = FAIL;
+
+done:
+    if (src_fd != -1)
+        close(src_fd);
+    if (dst_fd != -1)
+        close(dst_fd);
+
+    return ret_value;
+}
+
+/*
+ * Drain thread, copies the queued regions between the tiers
+ *
+ * \param  arg[IN]          Unused
+ */
+static HG_THREAD_RETURN_TYPE
+PDC_Server_tier_thread(void *arg)
+{
+    HG_THREAD_RETURN_TYPE tret = (HG_THREAD_RETURN_TYPE)0;
+    pdc_tier_region_t *   t;
+    const char *          src_path, *dst_path;
+    uint64_t              src_offset, dst_offset, size;
+    perr_t                ret;
+    char *                buf;
+
+    buf = (char *)malloc(PDC_TIER_COPY_SIZE);
+
+    hg_thread_mutex_lock(&tier_mutex_g);
+    while (1) {
+        while (tier_queue_head_g == NULL && tier_close_g == 0)
+            hg_thread_cond_wait(&tier_cond_g, &tier_mutex_g);
+        if (tier_queue_head_g == NULL)
+            break;
+
+        t = tier_queue_head_g;
+        DL_DELETE2(tier_queue_head_g, t, qprev, qnext);
+        t->copying = 1;
+        tier_n_copy_g++;
+        if (t->state == PDC_TIER_DRAIN) {
+            src_path   = t->obj->path;
+            src_offset = t->fast_offset;
+            dst_path   = t->obj->cap_path;
+            dst_offset = t->cap_offset;
+        }
+        else {
+            src_path   = t->obj->cap_path;
+            src_offset = t->cap_offset;
+            dst_path   = t->obj->path;
+            dst_offset = t->fast_offset;
+        }
+        size = t->region->data_size;
+        hg_thread_mutex_unlock(&tier_mutex_g);
+
+        if (buf == NULL)
+            ret = FAIL;
+        else
+            ret = PDC_Server_tier_copy(src_path, src_offset, dst_path, dst_offset, size, buf);
+
+        hg_thread_mutex_lock(&tier_mutex_g);
+        t->copy_ret = ret;
+        tier_n_copy_g--;
+        DL_APPEND2(tier_copied_head_g, t, qprev, qnext);
+        hg_thread_cond_broadcast(&tier_cond_g);
+    }
+    hg_thread_mutex_unlock(&tier_mutex_g);
+
+    free(buf);
+
+    return tret;
+}
+
+/*
+ * Get the tier files of an object, called with tier_mutex_g held
+ *
+ * \param  obj[IN]          Data server object
+ * \param  create[IN]       Whether to create the tier files of the object if not found
+ *
+ * \return Tier files of the object/NULL if not found
+ */
+static pdc_tier_obj_t *
+PDC_Server_tier_get_obj(data_server_region_t *obj, int create)
+{
+    pdc_tier_obj_t *o;
+    struct stat     st;
+
+    DL_FOREACH(tier_obj_head_g, o)
+    {
+        if (o->obj_id == obj->obj_id)
+            return o;
+    }
+
+    if (create == 0 || obj->storage_location == NULL)
+        return NULL;
+
+    o = (pdc_tier_obj_t *)calloc(1, sizeof(pdc_tier_obj_t));
+    if (o == NULL)
+        return NULL;
+    o->obj_id = obj->obj_id;
+    o->fd     = -1;
+    // Same layout as the object files in PDC_DATA_LOC
+    snprintf(o->path, ADDR_MAX, "%.200s/pdc_data/%" PRIu64 "/server%d/s%04d.bin", tier_loc_g, obj->obj_id,
+             pdc_server_rank_g, pdc_server_rank_g);
+    snprintf(o->cap_path, ADDR_MAX, "%s", obj->storage_location);
+    if (stat(o->cap_path, &st) == 0)
+        o->cap_end = st.st_size;
+    DL_APPEND(tier_obj_head_g, o);
+
+    return o;
+}
+
+/*
+ * Get the tier state of a storage region, called with tier_mutex_g held
+ *
+ * \param  o[IN]            Tier files of the object
+ * \param  region[IN]       Storage region
+ * \param  create[IN]       Whether to create the tier state if not found
+ *
+ * \return Tier state of the region/NULL if not found
+ */
+static pdc_tier_region_t *
+PDC_Server_tier_get_region(pdc_tier_obj_t *o, region_list_t *region, int create)
+{
+    pdc_tier_region_t *t;
+
+    DL_FOREACH(tier_region_head_g, t)
+    {
+        if (t->region == region)
+            return t;
+    }
+
+    if (create == 0)
+        return NULL;
+
+    t = (pdc_tier_region_t *)calloc(1, sizeof(pdc_tier_region_t));
+    if (t == NULL)
+        return NULL;
+    t->obj        = o;
+    t->region     = region;
+    t->cap_offset = PDC_TIER_NO_OFFSET;
+    if (region->data_loc_type != PDC_BB)
+        t->cap_offset = region->offset;
+    DL_APPEND(tier_region_head_g, t);
+
+    return t;
+}
+
+/*
+ * Point a storage region to its data in a tier, called with tier_mutex_g held
+ *
+ * \param  t[IN]            Tier state of the region
+ * \param  loc[IN]          PDC_BB or PDC_LUSTRE
+ */
+static void
+PDC_Server_tier_set_loc(pdc_tier_region_t *t, _pdc_data_loc_t loc)
+{
+    pdc_tier_update_t *u;
+
+    t->region->data_loc_type = loc;
+    if (loc == PDC_BB) {
+        strcpy(t->region->storage_location, t->obj->path);
+        t->region->offset = t->fast_offset;
+    }
+    else {
+        strcpy(t->region->storage_location, t->obj->cap_path);
+        t->region->offset = t->cap_offset;
+    }
+
+    // The metadata server is updated by PDC_Server_tier_send_updates, without tier_mutex_g held
+    DL_FOREACH(tier_update_head_g, u)
+    {
+        if (u->src == t->region)
+            break;
+    }
+    if (u == NULL) {
+        u = (pdc_tier_update_t *)calloc(1, sizeof(pdc_tier_update_t));
+        if (u == NULL) {
+            printf("==PDC_SERVER[%d]: %s - unable to queue the storage update of [%s]\n", pdc_server_rank_g,
+                   __func__, t->region->storage_location);
+            return;
+        }
+        u->obj_id = t->obj->obj_id;
+        u->src    = t->region;
+        DL_APPEND(tier_update_head_g, u);
+    }
+    u->region.ndim = t->region->ndim;
+    memcpy(u->region.start, t->region->start, sizeof(u->region.start));
+    memcpy(u->region.count, t->region->count, sizeof(u->region.count));
+    u->region.offset       = t->region->offset;
+    u->region.data_size    = t->region->data_size;
+    u->region.compress     = t->region->compress;
+    u->region.storage_size = t->region->storage_size;
+    strcpy(u->region.storage_location, t->region->storage_location);
+}
+
+/*
+ * Send the storage locations of the moved regions to the metadata servers of their objects
+ */
+static void
+PDC_Server_tier_send_updates()
+{
+    pdc_tier_update_t *head, *u, *tmp;
+
+    hg_thread_mutex_lock(&tier_mutex_g);
+    head               = tier_update_head_g;
+    tier_update_head_g = NULL;
+    hg_thread_mutex_unlock(&tier_mutex_g);
+
+    DL_FOREACH_SAFE(head, u, tmp)
+    {
+        if (PDC_Server_update_obj_region_storage_loc(&u->region, u->obj_id, PDC_UPDATE_STORAGE) != SUCCEED)
+            printf("==PDC_SERVER[%d]: %s - unable to update the storage location of [%s]\n",
+                   pdc_server_rank_g, __func__, u->region.storage_location);
+        DL_DELETE(head, u);
+        free(u);
+    }
+}
+
+/*
+ * Unpin a region after the I/O on the file from PDC_Server_tier_fd, called with tier_mutex_g held
+ *
+ * \param  t[IN]            Tier state of the region
+ */
+static void
+PDC_Server_tier_unpin_region(pdc_tier_region_t *t)
+{
+    if (t->n_pin > 0)
+        t->n_pin--;
+}
+
+/*
+ * Release the fast tier space of a region, called with tier_mutex_g held
+ *
+ * \param  t[IN]            Tier state of the region
+ */
+static void
+PDC_Server_tier_release(pdc_tier_region_t *t)
+{
+    pdc_tier_obj_t *o = t->obj;
+
+    if (t->has_fast == 0)
+        return;
+
+    t->has_fast = 0;
+    t->clean    = 0;
+    tier_used_g -= t->region->data_size;
+    o->n_region--;
+    if (o->n_region == 0) {
+        // Nothing left in the file, new regions start from its beginning
+        if (o->fd != -1 && ftruncate(o->fd, 0) != 0)
+            printf("==PDC_SERVER[%d]: %s - unable to truncate [%s]\n", pdc_server_rank_g, __func__, o->path);
+        o->end = 0;
+    }
+    else if (o->fd != -1)
+        fallocate(o->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, t->fast_offset, t->region->data_size);
+}
+
+/*
+ * Reserve fast tier space for a region, moving the least recently used clean regions back to the
+ * capacity tier if needed, called with tier_mutex_g held
+ *
+ * \param  t[IN]            Tier state of the region
+ *
+ * \return Non-negative on success/Negative if the fast tier is full
+ */
+static perr_t
+PDC_Server_tier_reserve(pdc_tier_region_t *t)
+{
+    pdc_tier_obj_t *   o    = t->obj;
+    uint64_t           size = t->region->data_size;
+    pdc_tier_region_t *elt, *lru;
+
+    if (size > tier_size_g)
+        return FAIL;
+
+    while (tier_used_g + size > tier_size_g) {
+        lru = NULL;
+        DL_FOREACH(tier_region_head_g, elt)
+        {
+            if (elt->clean == 1 && elt->state == PDC_TIER_IDLE && elt->n_pin == 0 &&
+                (lru == NULL || elt->last_access < lru->last_access))
+                lru = elt;
+        }
+        if (lru == NULL)
+            return FAIL;
+        PDC_Server_tier_set_loc(lru, PDC_LUSTRE);
+        PDC_Server_tier_release(lru);
+    }
+
+    if (o->fd == -1) {
+        PDC_mkdir(o->path);
+        o->fd = open(o->path, O_RDWR | O_CREAT, 0666);
+        if (o->fd == -1) {
+            printf("==PDC_SERVER[%d]: %s - unable to open [%s]\n", pdc_server_rank_g, __func__, o->path);
+            return FAIL;
+        }
+    }
+
+    t->fast_offset = o->end;
+    t->has_fast    = 1;
+    o->end += size;
+    o->n_region++;
+    tier_used_g += size;
+
+    return SUCCEED;
+}
+
+/*
+ * Queue a region for the drain thread, called with tier_mutex_g held
+ *
+ * \param  t[IN]            Tier state of the region
+ * \param  state[IN]        PDC_TIER_DRAIN or PDC_TIER_PROMOTE
+ */
+static void
+PDC_Server_tier_enqueue(pdc_tier_region_t *t, pdc_tier_state_t state)
+{
+    // The object file space of a region is allocated once, and reused by later drains
+    if (t->cap_offset == PDC_TIER_NO_OFFSET) {
+        t->cap_offset = t->obj->cap_end;
+        t->obj->cap_end += t->region->data_size;
+    }
+
+    t->state = state;
+    DL_APPEND2(tier_queue_head_g, t, qprev, qnext);
+    hg_thread_cond_broadcast(&tier_cond_g);
+}
+
+/*
+ * Move the copied regions to their new tier, called with tier_mutex_g held. A pinned region is moved
+ * by a later call, once the I/O on its current tier is done.
+ */
+static void
+PDC_Server_tier_commit()
+{
+    pdc_tier_region_t *t, *tmp;
+    pdc_tier_state_t   state;
+
+    DL_FOREACH_SAFE2(tier_copied_head_g, t, tmp, qnext)
+    {
+        if (t->n_pin > 0)
+            continue;
+        DL_DELETE2(tier_copied_head_g, t, qprev, qnext);
+        state      = t->state;
+        t->state   = PDC_TIER_IDLE;
+        t->copying = 0;
+
+        if (t->copy_ret != SUCCEED) {
+            // A region that failed to drain stays in the fast tier
+            if (state == PDC_TIER_PROMOTE)
+                PDC_Server_tier_release(t);
+            t->dirty = 0;
+            continue;
+        }
+
+        if (state == PDC_TIER_DRAIN) {
+            if (t->dirty == 1) {
+                t->dirty = 0;
+                PDC_Server_tier_enqueue(t, PDC_TIER_DRAIN);
+                continue;
+            }
+            PDC_Server_tier_set_loc(t, PDC_LUSTRE);
+            PDC_Server_tier_release(t);
+        }
+        else {
+            if (t->dirty == 1) {
+                // The object file was written during the copy, the fast tier copy is stale
+                t->dirty = 0;
+                PDC_Server_tier_release(t);
+                continue;
+            }
+            PDC_Server_tier_set_loc(t, PDC_BB);
+            t->clean = 1;
+        }
+    }
+}
+
+perr_t
+PDC_Server_tier_init()
+{
+    perr_t                ret_value = SUCCEED;
+    char *                env;
+    data_server_region_t *obj;
+    region_list_t *       region;
+    pdc_tier_obj_t *      o;
+    pdc_tier_region_t *   t;
+
+    FUNC_ENTER(NULL);
+
+    env = getenv("PDC_BB_TIER_LOC");
+    if (env == NULL)
+        goto done;
+    snprintf(tier_loc_g, ADDR_MAX, "%s", env);
+
+    env         = getenv("PDC_BB_TIER_SIZE_MB");
+    tier_size_g = (env == NULL ? PDC_TIER_SIZE_MB : strtoull(env, NULL, 10)) * 1048576;
+
+    env               = getenv("PDC_BB_TIER_DRAIN_MBPS");
+    tier_drain_mbps_g = env == NULL ? 0 : atof(env);
+
+    env                  = getenv("PDC_BB_TIER_PROMOTE_READS");
+    tier_promote_reads_g = env == NULL ? PDC_TIER_PROMOTE_READS : atoi(env);
+
+    hg_thread_mutex_init(&tier_mutex_g);
+    hg_thread_cond_init(&tier_cond_g);
+
+    // Regions a restarted server had in the fast tier are drained first
+    DL_FOREACH(dataserver_region_g, obj)
+    {
+        DL_FOREACH(obj->region_storage_head, region)
+        {
+            if (region->data_loc_type != PDC_BB)
+                continue;
+            o = PDC_Server_tier_get_obj(obj, 1);
+            t = o == NULL ? NULL : PDC_Server_tier_get_region(o, region, 1);
+            if (t == NULL) {
+                printf("==PDC_SERVER[%d]: %s - unable to restore fast tier region of [%s]\n",
+                       pdc_server_rank_g, __func__, region->storage_location);
+                continue;
+            }
+            t->fast_offset = region->offset;
+            t->has_fast    = 1;
+            o->n_region++;
+            if (o->end < region->offset + region->data_size)
+                o->end = region->offset + region->data_size;
+            tier_used_g += region->data_size;
+            PDC_Server_tier_enqueue(t, PDC_TIER_DRAIN);
+        }
+    }
+
+    if (hg_thread_create(&tier_thread_g, PDC_Server_tier_thread, NULL) != HG_UTIL_SUCCESS) {
+        printf("==PDC_SERVER[%d]: %s - unable to create drain thread\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
+    tier_enabled_g = 1;
+
+    if (pdc_server_rank_g == 0)
+        printf("==PDC_SERVER[0]: fast tier [%s] %" PRIu64 " MB, drain %.1f MB/s, promote after %d reads\n",
+               tier_loc_g, tier_size_g / 1048576, tier_drain_mbps_g, tier_promote_reads_g);
+
+done:
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
+
+perr_t
+PDC_Server_tier_finalize()
+{
+    perr_t             ret_value = SUCCEED;
+    pdc_tier_region_t *t, *tmp;
+    pdc_tier_obj_t *   o, *otmp;
+
+    FUNC_ENTER(NULL);
+
+    if (tier_enabled_g == 0)
+        goto done;
+
+    hg_thread_mutex_lock(&tier_mutex_g);
+    PDC_Server_tier_commit();
+    DL_FOREACH(tier_region_head_g, t)
+    {
+        if (t->region->data_loc_type != PDC_BB || t->state != PDC_TIER_IDLE)
+            continue;
+        if (t->clean == 1) {
+            PDC_Server_tier_set_loc(t, PDC_LUSTRE);
+            PDC_Server_tier_release(t);
+        }
+        else
+            PDC_Server_tier_enqueue(t, PDC_TIER_DRAIN);
+    }
+    while (tier_queue_head_g != NULL || tier_n_copy_g > 0 || tier_copied_head_g != NULL) {
+        if (tier_copied_head_g == NULL)
+            hg_thread_cond_wait(&tier_cond_g, &tier_mutex_g);
+        PDC_Server_tier_commit();
+    }
+    tier_close_g = 1;
+    hg_thread_cond_broadcast(&tier_cond_g);
+    hg_thread_mutex_unlock(&tier_mutex_g);
+
+    hg_thread_join(tier_thread_g);
+    PDC_Server_tier_send_updates();
+
+    DL_FOREACH_SAFE(tier_region_head_g, t, tmp)
+    {
+        if (t->has_fast == 1) {
+            printf("==PDC_SERVER[%d]: %s - region at %" PRIu64 " of [%s] is left in the fast tier\n",
+                   pdc_server_rank_g, __func__, t->region->offset, t->region->storage_location);
+            ret_value = FAIL;
+        }
+        DL_DELETE(tier_region_head_g, t);
+        free(t);
+    }
+    DL_FOREACH_SAFE(tier_obj_head_g, o, otmp)
+    {
+        if (o->fd != -1)
+            close(o->fd);
+        DL_DELETE(tier_obj_head_g, o);
+        free(o);
+    }
+
+    hg_thread_mutex_destroy(&tier_mutex_g);
+    hg_thread_cond_destroy(&tier_cond_g);
+    tier_enabled_g = 0;
+
+done:
+    fflush(stdout);
+    FUNC_LEAVE(ret_value);
+}
+
+int
+PDC_Server_tier_enabled()
+{
+    return tier_enabled_g;
+}
+
+perr_t
+PDC_Server_tier_write(data_server_region_t *obj, region_list_t *region, void *buf)
+{
+    perr_t             ret_value = SUCCEED;
+    pdc_tier_obj_t *   o;
+    pdc_tier_region_t *t = NULL;
+    int                fd;
+
+    FUNC_ENTER(NULL);
+
+    hg_thread_mutex_lock(&tier_mutex_g);
+    o = PDC_Server_tier_get_obj(obj, 1);
+    if (o != NULL)
+        t = PDC_Server_tier_get_region(o, region, 1);
+    if (t == NULL) {
+        hg_thread_mutex_unlock(&tier_mutex_g);
+        printf("==PDC_SERVER[%d]: %s - unable to allocate tier state\n", pdc_server_rank_g, __func__);
+        ret_value = FAIL;
+        goto done;
+    }
+    t->last_access = ++tier_clock_g;
+    t->cap_offset  = PDC_TIER_NO_OFFSET;
+
+    // Absorb the write in the fast tier, or append it to the object file when the fast tier is full
+    if (PDC_Server_tier_reserve(t) == SUCCEED) {
+        fd = o->fd;
+        PDC_Server_tier_set_loc(t, PDC_BB);
+    }
+    else {
+        fd            = obj->fd;
+        t->cap_offset = o->cap_end;
+        o->cap_end += region->data_size;
+        PDC_Server_tier_set_loc(t, PDC_LUSTRE);
+    }
+    hg_thread_mutex_unlock(&tier_mutex_g);
+
+    // The region is not queued yet, so the drain thread does not access it during the write
+    ret_value = PDC_Server_tier_pwrite(fd, buf, region->data_size, region->offset);
+    if (ret_value != SUCCEED) {
+        printf("==PDC_SERVER[%d]: %s - write to [%s] FAILED\n", pdc_server_rank_g, __func__,
+               region->storage_location);
+        goto done;
+    }
+
+    if (region->data_loc_type == PDC_BB) {
+        hg_thread_mutex_lock(&tier_mutex_g);
+        PDC_Server_tier_enqueue(t, PDC_TIER_DRAIN);
+        hg_thread_mutex_unlock(&tier_mutex_g);
+    }
+
+done:
+    FUNC_LEAVE(ret_value);
+}
+
+uint64_t
+PDC_Server_tier_alloc(data_server_region_t *obj, uint64_t size)
+{
+    uint64_t        ret_value;
+    pdc_tier_obj_t *o;
+
+    if (tier_enabled_g == 0)
+        return lseek(obj->fd, 0, SEEK_END);
+
+    hg_thread_mutex_lock(&tier_mutex_g);
+    o = PDC_Server_tier_get_obj(obj, 1);
+    if (o != NULL) {
+        ret_value = o->cap_end;
+        o->cap_end += size;
+    }
+    else
+        ret_value = lseek(obj->fd, 0, SEEK_END);
+    hg_thread_mutex_unlock(&tier_mutex_g);
+
+    return ret_value;
+}
+
+int
+PDC_Server_tier_fd(data_server_region_t *obj, region_list_t *region)
+{
+    int                ret_value = obj->fd;
+    pdc_tier_obj_t *   o;
+    pdc_tier_region_t *t = NULL;
+
+    if (tier_enabled_g == 0)
+        return ret_value;
+
+    // The tier of the region is checked with the lock held, and stays the same until it is unpinned
+    hg_thread_mutex_lock(&tier_mutex_g);
+    o = PDC_Server_tier_get_obj(obj, 1);
+    if (o != NULL)
+        t = PDC_Server_tier_get_region(o, region, 1);
+    if (t != NULL)
+        t->n_pin++;
+    if (region->data_loc_type == PDC_BB) {
+        if (t != NULL && o->fd == -1)
+            o->fd = open(o->path, O_RDWR, 0666);
+        ret_value = t == NULL ? -1 : o->fd;
+    }
+    hg_thread_mutex_unlock(&tier_mutex_g);
+
+    return ret_value;
+}
+
+void
+PDC_Server_tier_unpin(data_server_region_t *obj, region_list_t *region)
+{
+    pdc_tier_obj_t *   o;
+    pdc_tier_region_t *t = NULL;
+
+    if (tier_enabled_g == 0)
+        return;
+
+    hg_thread_mutex_lock(&tier_mutex_g);
+    o = PDC_Server_tier_get_obj(obj, 0);
+    if (o != NULL)
+        t = PDC_Server_tier_get_region(o, region, 0);
+    if (t != NULL)
+        PDC_Server_tier_unpin_region(t);
+    hg_thread_mutex_unlock(&tier_mutex_g);
+}
+
+void
+PDC_Server_tier_access(data_server_region_t *obj, region_list_t *region, pdc_access_t access_type)
+{
+    pdc_tier_obj_t *   o;
+    pdc_tier_region_t *t = NULL;
+
+    if (tier_enabled_g == 0)
+        return;
+
+    hg_thread_mutex_lock(&tier_mutex_g);
+    o = PDC_Server_tier_get_obj(obj, access_type == PDC_READ);
+    if (o != NULL)
+        t = PDC_Server_tier_get_region(o, region, access_type == PDC_READ && region->data_loc_type != PDC_BB);
+    if (t == NULL)
+        goto done;
+    PDC_Server_tier_unpin_region(t);
+
+    // Compressed regions stay in the object file
+    if (region->compress != PDC_COMPRESS_NONE)
+        goto done;
+    t->last_access = ++tier_clock_g;
+
+    if (access_type == PDC_WRITE) {
+        if (t->state == PDC_TIER_DRAIN) {
+            // A queued drain copies the new data, a started one has to be done again
+            if (t->copying == 1)
+                t->dirty = 1;
+        }
+        else if (t->state == PDC_TIER_PROMOTE) {
+            // The object file was written, the fast tier copy is stale
+            if (t->copying == 1)
+                t->dirty = 1;
+            else {
+                DL_DELETE2(tier_queue_head_g, t, qprev, qnext);
+                t->state = PDC_TIER_IDLE;
+                PDC_Server_tier_release(t);
+            }
+        }
+        else if (region->data_loc_type == PDC_BB) {
+            t->clean = 0;
+            PDC_Server_tier_enqueue(t, PDC_TIER_DRAIN);
+        }
+    }
+    else if (region->data_loc_type != PDC_BB && t->state == PDC_TIER_IDLE && tier_promote_reads_g > 0) {
+        t->n_read++;
+        if (t->n_read >= (uint64_t)tier_promote_reads_g && PDC_Server_tier_reserve(t) == SUCCEED) {
+            t->n_read = 0;
+            PDC_Server_tier_enqueue(t, PDC_TIER_PROMOTE);
+        }
+    }
+
+done:
+    hg_thread_mutex_unlock(&tier_mutex_g);
+}
+
+void
+PDC_Server_tier_progress()
+{
+    if (tier_enabled_g == 0)
+        return;
+
+    hg_thread_mutex_lock(&tier_mutex_g);
+    PDC_Server_tier_commit();
+    hg_thread_mutex_unlock(&tier_mutex_g);
+
+    PDC_Server_tier_send_updates();
+}
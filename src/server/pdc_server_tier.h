@@ -0,0 +1,126 @@
+/*
+ * Copyright Notice for
+ * Proactive Data Containers (PDC) Software Library and Utilities
+ * -----------------------------------------------------------------------------
+
+ *** Copyright Notice ***
+
+ * Proactive Data Containers (PDC) Copyright (c) 2017, The Regents of the
+ * University of California, through Lawrence Berkeley National Laboratory,
+ * UChicago Argonne, LLC, operator of Argonne National Laboratory, and The HDF
+ * Group (subject to receipt of any required approvals from the U.S. Dept. of
+ * Energy).  All rights reserved.
+
+ * If you have questions about your rights to use or distribute this software,
+ * please contact Berkeley Lab's Innovation & Partnerships Office at  IPO@lbl.gov.
+
+ * NOTICE.  This Software was developed under funding from the U.S. Department of
+ * Energy and the U.S. Government consequently retains certain rights. As such, the
+ * U.S. Government has been granted for itself and others acting on its behalf a
+ * paid-up, nonexclusive, irrevocable, worldwide license in the Software to
+ * reproduce, distribute copies to the public, prepare derivative works, and
+ * perform publicly and display publicly, and to permit other to do so.
+ */
+
+
+#ifndef PDC_SERVER_TIER_H
+#define PDC_SERVER_TIER_H
+
+#include "pdc_client_server_common.h"
+
+#define PDC_TIER_SIZE_MB       10240 // default capacity of the fast tier
+#define PDC_TIER_PROMOTE_READS 2     // default number of reads of a region before it is promoted
+#define PDC_TIER_COPY_SIZE     16777216
+
+/*
+ * Storage tier manager of the data server. With PDC_BB_TIER_LOC set to a node-local directory, new
+ * storage regions are written to the fast tier there and drained in the background to the object file
+ * in PDC_DATA_LOC, at most PDC_BB_TIER_DRAIN_MBPS MB/s. Regions read PDC_BB_TIER_PROMOTE_READS times
+ * from the capacity tier are copied back to the fast tier, which holds at most PDC_BB_TIER_SIZE_MB.
+ * The tier of a storage region is its data_loc_type, PDC_BB or PDC_LUSTRE, and its storage_location
+ * and offset are those of the tier it is in.
+ */
+
+/**
+ * Read the tier configuration and start the drain thread, the fast tier regions of a restarted
+ * server are queued for draining
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_Server_tier_init();
+
+/**
+ * Drain all regions to the capacity tier and stop the drain thread
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_Server_tier_finalize();
+
+/**
+ * Check if the tier manager is enabled
+ *
+ * \return 1 if enabled/0 otherwise
+ */
+int PDC_Server_tier_enabled();
+
+/**
+ * Write a new storage region of an object, to the fast tier if it has room, otherwise appended to the
+ * object file. Sets the storage location, offset and tier of the region.
+ *
+ * \param obj [IN]              Data server object
+ * \param region [IN/OUT]       Storage region, with data_size set
+ * \param buf [IN]              Data of the region
+ *
+ * \return Non-negative on success/Negative on failure
+ */
+perr_t PDC_Server_tier_write(data_server_region_t *obj, region_list_t *region, void *buf);
+
+/**
+ * Allocate space at the end of the object file for a region that bypasses the fast tier, after the space
+ * of the regions waiting to be drained
+ *
+ * \param obj [IN]              Data server object
+ * \param size [IN]             Bytes to allocate
+ *
+ * \return Offset of the space in the object file
+ */
+uint64_t PDC_Server_tier_alloc(data_server_region_t *obj, uint64_t size);
+
+/**
+ * Get the file descriptor to access the data of a storage region at its offset, and pin the region so
+ * its tier, location and offset stay the same until PDC_Server_tier_access or PDC_Server_tier_unpin
+ *
+ * \param obj [IN]              Data server object
+ * \param region [IN]           Storage region
+ *
+ * \return File descriptor, the object file descriptor when the region is not in the fast tier
+ */
+int PDC_Server_tier_fd(data_server_region_t *obj, region_list_t *region);
+
+/**
+ * Unpin a storage region pinned by PDC_Server_tier_fd, when the access fails before
+ * PDC_Server_tier_access
+ *
+ * \param obj [IN]              Data server object
+ * \param region [IN]           Storage region
+ */
+void PDC_Server_tier_unpin(data_server_region_t *obj, region_list_t *region);
+
+/**
+ * Record an access to the data of a storage region after the I/O on the file from PDC_Server_tier_fd,
+ * and unpin the region. An overwritten region is drained again and a region read often enough is
+ * promoted. Compressed regions are left in the object file.
+ *
+ * \param obj [IN]              Data server object
+ * \param region [IN]           Storage region
+ * \param access_type [IN]      PDC_READ or PDC_WRITE
+ */
+void PDC_Server_tier_access(data_server_region_t *obj, region_list_t *region, pdc_access_t access_type);
+
+/**
+ * Move the regions copied by the drain thread to their new tier and send the new storage locations to
+ * the metadata servers, called from the server loop
+ */
+void PDC_Server_tier_progress();
+
+#endif /* PDC_SERVER_TIER_H */
@@ -0,0 +1,210 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "pdc_client_server_common.h"
+#include "pdc_analysis_pkg.h"
+#include "pdc_analysis.h"
+#include "pdc_transforms_pkg.h"
+#include "pdc_server_data.h"
+#include "pdc_server_analysis.h"
+
+// The analysis code of the server is linked without the rest of the server, the objects are arrays here
+#define N_OBJ 4
+
+static data_server_region_t regions_g[N_OBJ];
+static int                  n_call_g;
+
+data_server_region_t *
+PDC_Server_get_obj_region(pdcid_t obj_id)
+{
+    return obj_id < N_OBJ ? &regions_g[obj_id] : NULL;
+}
+
+uint32_t
+PDC_get_hash_by_name(const char *name)
+{
+    uint32_t hash = 0;
+
+    while (*name)
+        hash = hash * 31 + (uint8_t)*name++;
+    return hash;
+}
+
+void
+PDC_transform_pipeline_free(struct _pdc_transform_pipeline *pipeline)
+{
+    (void)pipeline;
+}
+
+void
+print_usage()
+{
+    printf("Usage: ./analysis_split n_row n_col, with at least 131072 elements to split\n");
+}
+
+// Each output row only depends on its input row, the function can run on parts of the iterators
+static int
+scale_rows(pdcid_t iter_in, pdcid_t iter_out, struct _pdc_iterator_cbs_t *cbs)
+{
+    int *  in, *out;
+    size_t n, i;
+
+    __sync_fetch_and_add(&n_call_g, 1);
+    while ((n = cbs->getNextBlock(iter_in, (void **)&in, NULL)) > 0) {
+        if (cbs->getNextBlock(iter_out, (void **)&out, NULL) != n)
+            return -1;
+        for (i = 0; i < n; i++)
+            out[i] = in[i] * 2 + 1;
+    }
+
+    return 0;
+}
+
+// Each output row is the running sum of the input rows, which needs the rows in order on one thread
+static int
+sum_rows(pdcid_t iter_in, pdcid_t iter_out, struct _pdc_iterator_cbs_t *cbs)
+{
+    int *  in, *out;
+    int    total = 0;
+    size_t n, i;
+
+    __sync_fetch_and_add(&n_call_g, 1);
+    while ((n = cbs->getNextBlock(iter_in, (void **)&in, NULL)) > 0) {
+        if (cbs->getNextBlock(iter_out, (void **)&out, NULL) != n)
+            return -1;
+        for (i = 0; i < n; i++) {
+            total += in[i];
+            out[i] = total;
+        }
+    }
+
+    return 0;
+}
+
+// Iterator over the rows of an object, as a client creates it for the whole object
+static pdcid_t
+create_row_iter(pdcid_t obj_id, int *data, size_t n_row, size_t n_col)
+{
+    obj_data_iterator_in_t  in;
+    obj_data_iterator_out_t out;
+
+    regions_g[obj_id].obj_id       = obj_id;
+    regions_g[obj_id].obj_data_ptr = data;
+
+    memset(&in, 0, sizeof(in));
+    in.object_id        = obj_id;
+    in.sliceCount       = n_row;
+    in.sliceResetCount  = n_row + 1;
+    in.elementsPerSlice = n_col;
+    in.slicePerBlock    = 1;
+    in.elementsPerBlock = n_col;
+    in.element_size     = sizeof(int);
+    in.contigBlockSize  = n_col * sizeof(int);
+    in.totalElements    = n_row * n_col;
+    in.storageinfo      = PDC_INT;
+    if (PDC_Server_instantiate_data_iterator(&in, &out) != SUCCEED)
+        return 0;
+
+    return out.server_iter_id;
+}
+
+// Run a function serially and with its parts, the outputs must be the same
+static int
+check_run(const char *name, int (*ftn)(), int *input, size_t n_row, size_t n_col, int expect_split)
+{
+    struct _pdc_iterator_cbs_t cbs = {PDCobj_data_getSliceCount, PDCobj_data_getNextBlock};
+    size_t                     n   = n_row * n_col, i;
+    int *                      serial, *split;
+    int                        n_serial_call, n_split_call, ret_value = 0;
+
+    serial = (int *)calloc(n, sizeof(int));
+    split  = (int *)calloc(n, sizeof(int));
+
+    n_call_g = 0;
+    if (PDC_Server_run_analysis(ftn, create_row_iter(0, input, n_row, n_col),
+                                create_row_iter(1, serial, n_row, n_col), &cbs, 0) != 0) {
+        printf("%s fails serially @ line  %d!\n", name, __LINE__);
+        ret_value = 1;
+    }
+    n_serial_call = n_call_g;
+
+    // The function is split only if it is registered for it
+    n_call_g = 0;
+    if (PDC_Server_run_analysis(ftn, create_row_iter(2, input, n_row, n_col),
+                                create_row_iter(3, split, n_row, n_col), &cbs,
+                                expect_split ? PDC_ANALYSIS_PARALLEL : 0) != 0) {
+        printf("%s fails with parts @ line  %d!\n", name, __LINE__);
+        ret_value = 1;
+    }
+    n_split_call = n_call_g;
+
+    printf("%s: %d serial call(s), %d call(s) with parts\n", name, n_serial_call, n_split_call);
+    if (n_serial_call != 1 || (expect_split && n_split_call < 2) || (!expect_split && n_split_call != 1)) {
+        printf("%s is not run as registered @ line  %d!\n", name, __LINE__);
+        ret_value = 1;
+    }
+    for (i = 0; i < n; i++) {
+        if (serial[i] != split[i]) {
+            printf("%s differs at %zu: %d serially, %d with parts!\n", name, i, serial[i], split[i]);
+            ret_value = 1;
+            break;
+        }
+    }
+
+    free(serial);
+    free(split);
+
+    return ret_value;
+}
+
+int
+main(int argc, char **argv)
+{
+    size_t n_row = 1024, n_col = 512, i, total = 0;
+    int *  input, *output;
+    int    ret_value = 0;
+
+    if (argc > 2) {
+        n_row = atoll(argv[1]);
+        n_col = atoll(argv[2]);
+    }
+    if (n_row < 2 || n_row * n_col < 131072) {
+        print_usage();
+        return 1;
+    }
+
+    // Split into 4 parts whatever the number of cores
+    setenv("PDC_ANALYSIS_NTHREAD", "4", 1);
+    execution_locus = SERVER_MEMORY;
+
+    input = (int *)malloc(n_row * n_col * sizeof(int));
+    for (i = 0; i < n_row * n_col; i++)
+        input[i] = (int)(i % 7) - 3;
+
+    ret_value |= check_run("scale_rows", scale_rows, input, n_row, n_col, 1);
+    ret_value |= check_run("sum_rows", sum_rows, input, n_row, n_col, 0);
+
+    // The serial running sum is not restarted at any row
+    output = (int *)calloc(n_row * n_col, sizeof(int));
+    n_call_g = 0;
+    {
+        struct _pdc_iterator_cbs_t cbs = {PDCobj_data_getSliceCount, PDCobj_data_getNextBlock};
+        PDC_Server_run_analysis(sum_rows, create_row_iter(0, input, n_row, n_col),
+                                create_row_iter(1, output, n_row, n_col), &cbs, 0);
+    }
+    for (i = 0; i < n_row * n_col; i++) {
+        total += input[i];
+        if (output[i] != (int)total) {
+            printf("Running sum is %d at %zu instead of %d!\n", output[i], i, (int)total);
+            ret_value = 1;
+            break;
+        }
+    }
+
+    free(input);
+    free(output);
+
+    return ret_value;
+}
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include "pdc.h"
+
+#define REGION_LEN 65536
+
+void
+print_usage()
+{
+    printf("Usage: ./bb_tier n_region n_read\n");
+}
+
+// Write or read one region of the object through a buffer map
+static int
+transfer_region(pdcid_t obj, int *buf, uint64_t region_idx, pdc_access_t access_type)
+{
+    pdcid_t  local_reg, global_reg;
+    uint64_t offset = region_idx * REGION_LEN, local_offset = 0, len = REGION_LEN;
+    int      ret_value = 0;
+
+    local_reg  = PDCregion_create(1, &local_offset, &len);
+    global_reg = PDCregion_create(1, &offset, &len);
+    if (PDCbuf_obj_map(buf, PDC_INT, local_reg, obj, global_reg) != SUCCEED ||
+        PDCreg_obtain_lock(obj, global_reg, access_type, PDC_BLOCK) != SUCCEED ||
+        PDCreg_release_lock(obj, global_reg, access_type) != SUCCEED ||
+        PDCbuf_obj_unmap(obj, global_reg) != SUCCEED) {
+        printf("Fail to transfer region %" PRIu64 " @ line  %d!\n", region_idx, __LINE__);
+        ret_value = 1;
+    }
+    PDCregion_close(local_reg);
+    PDCregion_close(global_reg);
+
+    return ret_value;
+}
+
+int
+main(int argc, char **argv)
+{
+    int      n_region = 8, n_read = 3, i, j, k;
+    pdcid_t  pdc, cont_prop, cont, obj_prop, obj;
+    uint64_t dims[1];
+    int *    data;
+    int      ret_value = 0;
+
+    if (argc > 1)
+        n_region = atoi(argv[1]);
+    if (argc > 2)
+        n_read = atoi(argv[2]);
+    if (n_region <= 0 || n_read <= 0) {
+        print_usage();
+        return 1;
+    }
+
+    pdc       = PDCinit("pdc");
+    cont_prop = PDCprop_create(PDC_CONT_CREATE, pdc);
+    cont      = PDCcont_create("c_bb_tier", cont_prop);
+    obj_prop  = PDCprop_create(PDC_OBJ_CREATE, pdc);
+    if (cont_prop <= 0 || cont <= 0 || obj_prop <= 0) {
+        printf("Fail to create container @ line  %d!\n", __LINE__);
+        return 1;
+    }
+    dims[0] = (uint64_t)n_region * REGION_LEN;
+    PDCprop_set_obj_type(obj_prop, PDC_INT);
+    PDCprop_set_obj_dims(obj_prop, 1, dims);
+    PDCprop_set_obj_user_id(obj_prop, getuid());
+    PDCprop_set_obj_time_step(obj_prop, 0);
+    PDCprop_set_obj_app_name(obj_prop, "BBTierTest");
+    PDCprop_set_obj_tags(obj_prop, "tag0=1");
+    obj = PDCobj_create(cont, "o_bb_tier", obj_prop);
+    if (obj <= 0) {
+        printf("Fail to create object @ line  %d!\n", __LINE__);
+        return 1;
+    }
+
+    data = (int *)malloc(sizeof(int) * REGION_LEN);
+
+    // With PDC_BB_TIER_LOC set for the server, the regions are absorbed by the fast tier and drained
+    for (i = 0; i < n_region; i++) {
+        for (k = 0; k < REGION_LEN; k++)
+            data[k] = i * REGION_LEN + k;
+        ret_value |= transfer_region(obj, data, i, PDC_WRITE);
+    }
+
+    // Overwrite the first region, which may be being drained
+    for (k = 0; k < REGION_LEN; k++)
+        data[k] = -k;
+    ret_value |= transfer_region(obj, data, 0, PDC_WRITE);
+
+    // Repeated reads promote the regions back to the fast tier, the data must be the same in any tier
+    for (j = 0; j < n_read; j++) {
+        for (i = 0; i < n_region; i++) {
+            memset(data, 0, sizeof(int) * REGION_LEN);
+            ret_value |= transfer_region(obj, data, i, PDC_READ);
+            for (k = 0; k < REGION_LEN; k++) {
+                if (data[k] != (i == 0 ? -k : i * REGION_LEN + k)) {
+                    printf("Read %d of region %d has %d at %d!\n", j, i, data[k], k);
+                    ret_value = 1;
+                    break;
+                }
+            }
+        }
+        sleep(1);
+    }
+
+    free(data);
+
+    if (PDCobj_close(obj) < 0) {
+        printf("fail to close object\n");
+        ret_value = 1;
+    }
+    if (PDCprop_close(obj_prop) < 0) {
+        printf("Fail to close property @ line %d\n", __LINE__);
+        ret_value = 1;
+    }
+    if (PDCcont_close(cont) < 0) {
+        printf("fail to close container\n");
+        ret_value = 1;
+    }
+    if (PDCprop_close(cont_prop) < 0) {
+        printf("Fail to close property @ line %d\n", __LINE__);
+        ret_value = 1;
+    }
+    if (PDCclose(pdc) < 0) {
+        printf("fail to close PDC\n");
+        ret_value = 1;
+    }
+
+    return ret_value;
+}
@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "pdc.h"
+#include "pdc_dt_conv.h"
+
+void
+print_usage()
+{
+    printf("Usage: ./buf_map_conv n_elem\n");
+}
+
+// Write or read the object through a buffer map with the given type of the buffer
+static int
+transfer_obj(pdcid_t obj, void *buf, pdc_var_type_t type, uint64_t n_elem, pdc_access_t access_type)
+{
+    pdcid_t  local_reg, global_reg;
+    uint64_t offset    = 0;
+    int      ret_value = 0;
+
+    local_reg  = PDCregion_create(1, &offset, &n_elem);
+    global_reg = PDCregion_create(1, &offset, &n_elem);
+    if (PDCbuf_obj_map(buf, type, local_reg, obj, global_reg) != SUCCEED ||
+        PDCreg_obtain_lock(obj, global_reg, access_type, PDC_BLOCK) != SUCCEED ||
+        PDCreg_release_lock(obj, global_reg, access_type) != SUCCEED ||
+        PDCbuf_obj_unmap(obj, global_reg) != SUCCEED) {
+        printf("Fail to transfer the object with type %d @ line  %d!\n", type, __LINE__);
+        ret_value = 1;
+    }
+    PDCregion_close(local_reg);
+    PDCregion_close(global_reg);
+
+    return ret_value;
+}
+
+// Saturation, rounding and strides of the conversion functions
+static int
+check_conv()
+{
+    double src[6]       = {-1e10, -2.5, -0.4, 2.5, 126.7, 1e10};
+    int    ints[6]      = {-70000, -129, -5, 5, 300, 70000};
+    int8_t exp_round[6] = {-128, -2, 0, 2, 127, 127};
+    int8_t exp_trunc[6] = {-128, -2, 0, 2, 126, 127};
+    int8_t exp_clamp[6] = {-128, -128, -5, 5, 127, 127};
+    int8_t i8[6];
+    int    i32[3];
+    int    ret_value = 0, i;
+
+    pdc_type_conv(PDC_DOUBLE, PDC_INT8, src, i8, 6, 1, 1, PDC_CONV_ROUND);
+    ret_value |= memcmp(i8, exp_round, sizeof(i8)) != 0;
+    pdc_type_conv(PDC_DOUBLE, PDC_INT8, src, i8, 6, 1, 1, 0);
+    ret_value |= memcmp(i8, exp_trunc, sizeof(i8)) != 0;
+    pdc_type_conv(PDC_INT, PDC_INT8, ints, i8, 6, 1, 1, PDC_CONV_CLAMP);
+    ret_value |= memcmp(i8, exp_clamp, sizeof(i8)) != 0;
+
+    // Every other element of the source
+    pdc_type_conv(PDC_DOUBLE, PDC_INT, src + 1, i32, 3, 2, 1, PDC_CONV_CLAMP | PDC_CONV_ROUND);
+    for (i = 0; i < 3; i++)
+        ret_value |= i32[i] != (i == 0 ? -2 : i == 1 ? 2 : 2147483647);
+
+    if (pdc_find_conv_func(PDC_COMPOUND, PDC_INT) != NULL)
+        ret_value = 1;
+    if (ret_value != 0)
+        printf("Wrong conversion result @ line  %d!\n", __LINE__);
+
+    return ret_value;
+}
+
+int
+main(int argc, char **argv)
+{
+    uint64_t n_elem = 1048576, k;
+    pdcid_t  pdc, cont_prop, cont, obj_prop, obj;
+    double * data, *data_read;
+    int *    data_int;
+    float    value;
+    int      ret_value = 0;
+
+    if (argc > 1)
+        n_elem = atoll(argv[1]);
+    if (n_elem == 0) {
+        print_usage();
+        return 1;
+    }
+
+    ret_value |= check_conv();
+
+    pdc       = PDCinit("pdc");
+    cont_prop = PDCprop_create(PDC_CONT_CREATE, pdc);
+    cont      = PDCcont_create("c_buf_map_conv", cont_prop);
+    obj_prop  = PDCprop_create(PDC_OBJ_CREATE, pdc);
+    if (cont_prop <= 0 || cont <= 0 || obj_prop <= 0) {
+        printf("Fail to create container @ line  %d!\n", __LINE__);
+        return 1;
+    }
+    PDCprop_set_obj_type(obj_prop, PDC_FLOAT);
+    PDCprop_set_obj_dims(obj_prop, 1, &n_elem);
+    PDCprop_set_obj_user_id(obj_prop, getuid());
+    PDCprop_set_obj_time_step(obj_prop, 0);
+    PDCprop_set_obj_app_name(obj_prop, "BufMapConvTest");
+    PDCprop_set_obj_tags(obj_prop, "tag0=1");
+    obj = PDCobj_create(cont, "o_buf_map_conv", obj_prop);
+    if (obj <= 0) {
+        printf("Fail to create object @ line  %d!\n", __LINE__);
+        return 1;
+    }
+
+    data      = (double *)malloc(sizeof(double) * n_elem);
+    data_read = (double *)malloc(sizeof(double) * n_elem);
+    data_int  = (int *)malloc(sizeof(int) * n_elem);
+
+    // Double values are stored as float, then read back as double and as int rounded to the nearest
+    for (k = 0; k < n_elem; k++)
+        data[k] = k * 0.25 + 0.1;
+    ret_value |= transfer_obj(obj, data, PDC_DOUBLE, n_elem, PDC_WRITE);
+    ret_value |= transfer_obj(obj, data_read, PDC_DOUBLE, n_elem, PDC_READ);
+    ret_value |= transfer_obj(obj, data_int, PDC_INT, n_elem, PDC_READ);
+    for (k = 0; k < n_elem; k++) {
+        value = (float)data[k];
+        if (data_read[k] != (double)value || data_int[k] != (int)(value + 0.5)) {
+            printf("Element %llu is %f and %d, expected %f!\n", (unsigned long long)k, data_read[k],
+                   data_int[k], (double)value);
+            ret_value = 1;
+            break;
+        }
+    }
+
+    free(data);
+    free(data_read);
+    free(data_int);
+
+    if (PDCobj_close(obj) < 0) {
+        printf("fail to close object\n");
+        ret_value = 1;
+    }
+    if (PDCprop_close(obj_prop) < 0) {
+        printf("Fail to close property @ line %d\n", __LINE__);
+        ret_value = 1;
+    }
+    if (PDCcont_close(cont) < 0) {
+        printf("fail to close container\n");
+        ret_value = 1;
+    }
+    if (PDCprop_close(cont_prop) < 0) {
+        printf("Fail to close property @ line %d\n", __LINE__);
+        ret_value = 1;
+    }
+    if (PDCclose(pdc) < 0) {
+        printf("fail to close PDC\n");
+        ret_value = 1;
+    }
+
+    return ret_value;
+}
@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "pdc.h"
+#include "pdc_client_connect.h"
+
+void
+print_usage()
+{
+    printf("Usage: ./buf_map_shm n_elem n_round\n");
+}
+
+// Write or read a part of the object through a buffer map, the server is on this node so the data goes
+// through the shared memory of the client
+static int
+transfer_obj(pdcid_t obj, int *buf, uint64_t offset, uint64_t n_elem, pdc_access_t access_type)
+{
+    pdcid_t  local_reg, global_reg;
+    uint64_t local_offset = 0;
+    int      ret_value    = 0;
+
+    local_reg  = PDCregion_create(1, &local_offset, &n_elem);
+    global_reg = PDCregion_create(1, &offset, &n_elem);
+    if (PDCbuf_obj_map(buf, PDC_INT, local_reg, obj, global_reg) != SUCCEED ||
+        PDCreg_obtain_lock(obj, global_reg, access_type, PDC_BLOCK) != SUCCEED ||
+        PDCreg_release_lock(obj, global_reg, access_type) != SUCCEED ||
+        PDCbuf_obj_unmap(obj, global_reg) != SUCCEED) {
+        printf("Fail to transfer the object @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    PDCregion_close(local_reg);
+    PDCregion_close(global_reg);
+
+    return ret_value;
+}
+
+int
+main(int argc, char **argv)
+{
+    uint64_t n_elem = 1048576, half, k;
+    pdcid_t  pdc, cont_prop, cont, obj_prop, obj;
+    int *    data, *data_read;
+    int      n_round = 4, round, i, ret_value = 0;
+
+    if (argc > 1)
+        n_elem = atoll(argv[1]);
+    if (argc > 2)
+        n_round = atoi(argv[2]);
+    if (n_elem < 2 || n_round <= 0) {
+        print_usage();
+        return 1;
+    }
+    half = n_elem / 2;
+
+    pdc       = PDCinit("pdc");
+    cont_prop = PDCprop_create(PDC_CONT_CREATE, pdc);
+    cont      = PDCcont_create("c_buf_map_shm", cont_prop);
+    obj_prop  = PDCprop_create(PDC_OBJ_CREATE, pdc);
+    if (cont_prop <= 0 || cont <= 0 || obj_prop <= 0) {
+        printf("Fail to create container @ line  %d!\n", __LINE__);
+        return 1;
+    }
+    PDCprop_set_obj_type(obj_prop, PDC_INT);
+    PDCprop_set_obj_dims(obj_prop, 1, &n_elem);
+    PDCprop_set_obj_user_id(obj_prop, getuid());
+    PDCprop_set_obj_time_step(obj_prop, 0);
+    PDCprop_set_obj_app_name(obj_prop, "BufMapShmTest");
+    PDCprop_set_obj_tags(obj_prop, "tag0=1");
+    obj = PDCobj_create(cont, "o_buf_map_shm", obj_prop);
+    if (obj <= 0) {
+        printf("Fail to create object @ line  %d!\n", __LINE__);
+        return 1;
+    }
+
+    data      = (int *)malloc(sizeof(int) * n_elem);
+    data_read = (int *)malloc(sizeof(int) * n_elem);
+
+    // Each round maps and unmaps all regions, so the server maps the shared memory again every round
+    for (round = 0; round < n_round && ret_value == 0; round++) {
+        for (k = 0; k < n_elem; k++)
+            data[k] = (int)(k * 7 + round);
+        memset(data_read, 0, sizeof(int) * n_elem);
+
+        ret_value |= transfer_obj(obj, data, 0, half, PDC_WRITE);
+        ret_value |= transfer_obj(obj, data + half, half, n_elem - half, PDC_WRITE);
+        ret_value |= transfer_obj(obj, data_read, 0, n_elem, PDC_READ);
+        for (k = 0; k < n_elem; k++) {
+            if (data_read[k] != data[k]) {
+                printf("Round %d element %llu is %d, expected %d!\n", round, (unsigned long long)k,
+                       data_read[k], data[k]);
+                ret_value = 1;
+                break;
+            }
+        }
+    }
+
+    // The servers run on this node, none of them may have fallen back to bulk transfers
+    for (i = 0; i < pdc_server_num_g; i++) {
+        if (pdc_server_info_g[i].buf_shm_remote != 0) {
+            printf("Server %d does not use the shared memory @ line  %d!\n", i, __LINE__);
+            ret_value = 1;
+        }
+    }
+    if (ret_value == 0)
+        printf("%d rounds of %llu elements through shared memory\n", n_round, (unsigned long long)n_elem);
+
+    free(data);
+    free(data_read);
+
+    if (PDCobj_close(obj) < 0) {
+        printf("fail to close object\n");
+        ret_value = 1;
+    }
+    if (PDCprop_close(obj_prop) < 0) {
+        printf("Fail to close property @ line %d\n", __LINE__);
+        ret_value = 1;
+    }
+    if (PDCcont_close(cont) < 0) {
+        printf("fail to close container\n");
+        ret_value = 1;
+    }
+    if (PDCprop_close(cont_prop) < 0) {
+        printf("Fail to close property @ line %d\n", __LINE__);
+        ret_value = 1;
+    }
+    if (PDCclose(pdc) < 0) {
+        printf("fail to close PDC\n");
+        ret_value = 1;
+    }
+
+    return ret_value;
+}
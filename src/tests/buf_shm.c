@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include "pdc.h"
+#include "pdc_buf_shm.h"
+
+void
+print_usage()
+{
+    printf("Usage: ./buf_shm n_extent extent_KB\n");
+}
+
+int
+main(int argc, char **argv)
+{
+    int            n_extent = 64, extent_kb = 64, i, j;
+    uint64_t       extent_size, arena_size, attach_size, extra_offset, *offset;
+    char           name[128];
+    pdc_buf_shm_t *arena;
+    char **        buf, *base;
+    int            ret_value = 0;
+
+    if (argc > 1)
+        n_extent = atoi(argv[1]);
+    if (argc > 2)
+        extent_kb = atoi(argv[2]);
+    if (n_extent <= 1 || extent_kb <= 0) {
+        print_usage();
+        return 1;
+    }
+    extent_size = (uint64_t)extent_kb * 1024;
+    arena_size  = (uint64_t)n_extent * (extent_size + 4096);
+
+    snprintf(name, sizeof(name), "/pdc_buf_test_%d", (int)getpid());
+    arena = PDC_buf_shm_create(name, arena_size);
+    if (arena == NULL) {
+        printf("Fail to create shared memory %s @ line  %d!\n", name, __LINE__);
+        return 1;
+    }
+
+    offset = (uint64_t *)malloc(sizeof(uint64_t) * n_extent);
+    buf    = (char **)malloc(sizeof(char *) * n_extent);
+
+    // Fill every extent with its own pattern, extents must not overlap
+    for (i = 0; i < n_extent; i++) {
+        buf[i] = (char *)PDC_buf_shm_alloc(arena, extent_size, &offset[i]);
+        if (buf[i] == NULL) {
+            printf("Fail to allocate extent %d of %" PRIu64 " bytes @ line  %d!\n", i, extent_size, __LINE__);
+            ret_value = 1;
+            goto done;
+        }
+        memset(buf[i], i & 0xff, extent_size);
+    }
+
+    // An arena only fits what it was sized for
+    if (PDC_buf_shm_alloc(arena, arena_size, &extra_offset) != NULL) {
+        printf("Allocated more than the arena size @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+
+    // The server side view of the same memory
+    base = (char *)PDC_buf_shm_attach(PDC_buf_shm_name(arena), &attach_size);
+    if (base == NULL || attach_size != arena_size) {
+        printf("Fail to attach shared memory %s @ line  %d!\n", name, __LINE__);
+        ret_value = 1;
+        goto done;
+    }
+    for (i = 0; i < n_extent; i++) {
+        for (j = 0; j < (int)extent_size; j++) {
+            if (base[offset[i] + j] != (char)(i & 0xff)) {
+                printf("Extent %d byte %d is %d in the attached view @ line  %d!\n", i, j,
+                       base[offset[i] + j], __LINE__);
+                ret_value = 1;
+                break;
+            }
+        }
+    }
+
+    // A freed extent is reused, and the data written by the client side is seen by the server side
+    PDC_buf_shm_free(arena, offset[1]);
+    buf[1] = (char *)PDC_buf_shm_alloc(arena, extent_size, &attach_size);
+    if (buf[1] == NULL || attach_size != offset[1]) {
+        printf("Freed extent is not reused @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    else {
+        strcpy(buf[1], "pdc");
+        if (strcmp(base + offset[1], "pdc") != 0) {
+            printf("Attached view does not see new data @ line  %d!\n", __LINE__);
+            ret_value = 1;
+        }
+    }
+
+    PDC_buf_shm_detach(base, arena_size);
+    if (PDC_buf_shm_exists(name) != 1) {
+        printf("Shared memory %s is not found @ line  %d!\n", name, __LINE__);
+        ret_value = 1;
+    }
+    if (ret_value == 0)
+        printf("%d extents of %d KB in shared memory %s\n", n_extent, extent_kb, name);
+
+done:
+    PDC_buf_shm_destroy(arena);
+    free(offset);
+    free(buf);
+
+    // The name is gone once the client destroyed its arena
+    if (PDC_buf_shm_attach(name, &attach_size) != NULL || PDC_buf_shm_exists(name) != 0) {
+        printf("Shared memory %s still exists after destroy @ line  %d!\n", name, __LINE__);
+        ret_value = 1;
+    }
+
+    return ret_value;
+}
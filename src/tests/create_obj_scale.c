@@ -52,19 +52,23 @@ rand_string(char *str, size_t size)
 void
 print_usage()
 {
-    printf("Usage: srun -n ./creat_obj -r num_of_obj_per_rank\n");
+    printf("Usage: srun -n ./creat_obj -r num_of_obj_per_rank [-b batch_size]\n");
 }
 
 int
 main(int argc, char **argv)
 {
-    int      rank = 0, size = 1;
-    int      count = -1;
-    int      i;
-    pdcid_t  pdc, cont_prop, cont, obj_prop;
-    uint64_t dims[3]  = {100, 200, 700};
-    pdcid_t  test_obj = -1;
-    int      use_name = -1;
+    int             rank = 0, size = 1;
+    int             count = -1;
+    int             i;
+    pdcid_t         pdc, cont_prop, cont, obj_prop;
+    uint64_t        dims[3]  = {100, 200, 700};
+    pdcid_t         test_obj = -1;
+    int             use_name = -1;
+    int             batch    = 1, n_batch = 0, j, ret_value = 0;
+    char **         batch_names = NULL;
+    pdcid_t *       batch_objs  = NULL;
+    pdc_metadata_t *meta;
 
     struct timeval ht_total_start;
     struct timeval ht_total_end;
@@ -84,13 +88,16 @@ main(int argc, char **argv)
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 #endif
 
-    while ((i = getopt(argc, argv, "r:")) != EOF)
+    while ((i = getopt(argc, argv, "r:b:")) != EOF)
         switch (i) {
             case 'r':
                 count = atoi(optarg);
                 break;
+            case 'b':
+                batch = atoi(optarg);
+                break;
             case '?':
-                if (optopt == 'r')
+                if (optopt == 'r' || optopt == 'b')
                     fprintf(stderr, "Option -%c requires an argument.\n", i);
                 else if (isprint(i))
                     fprintf(stderr, "Unknown option `-%c'.\n", i);
@@ -154,6 +161,18 @@ main(int argc, char **argv)
         printf("Using %s\n", name_mode[use_name + 1]);
     }
 
+    // Only random names share one object property, the other modes set a time step for each object
+    if (batch < 1 || use_name != -1)
+        batch = 1;
+    if (batch > 1) {
+        if (rank == 0)
+            printf("Creating objects in batches of %d\n", batch);
+        batch_names = (char **)malloc(sizeof(char *) * batch);
+        batch_objs  = (pdcid_t *)malloc(sizeof(pdcid_t) * batch);
+        for (j = 0; j < batch; j++)
+            batch_names[j] = (char *)malloc(17);
+    }
+
     srand(rank + 1);
 
 #ifdef ENABLE_MPI
@@ -165,7 +184,8 @@ main(int argc, char **argv)
     for (i = 0; i < count; i++) {
 
         if (use_name == -1) {
-            sprintf(obj_name, "%s", rand_string(tmp_str, 16));
+            if (batch == 1)
+                sprintf(obj_name, "%s", rand_string(tmp_str, 16));
             PDCprop_set_obj_time_step(obj_prop, rank);
         }
         else if (use_name == 1) {
@@ -184,13 +204,29 @@ main(int argc, char **argv)
         PDCprop_set_obj_app_name(obj_prop, "test_app");
         PDCprop_set_obj_tags(obj_prop, "tag0=1");
 
-        if (count < 20) {
-            printf("[%d] create obj with name %s\n", rank, obj_name);
+        if (batch > 1) {
+            // Only the last batch is kept to be looked up
+            for (j = 0; j < n_batch; j++)
+                PDCobj_close(batch_objs[j]);
+            n_batch = count - i < batch ? count - i : batch;
+            for (j = 0; j < n_batch; j++)
+                rand_string(batch_names[j], 17);
+            if (PDCobj_create_batch(cont, n_batch, (const char **)batch_names, obj_prop, batch_objs) < 0) {
+                printf("Error getting the object ids of a batch of %d from server, exit...\n", n_batch);
+                exit(-1);
+            }
+            // Continue after the last object of the batch
+            i += n_batch - 1;
         }
-        test_obj = PDCobj_create(cont, obj_name, obj_prop);
-        if (test_obj == 0) {
-            printf("Error getting an object id of %s from server, exit...\n", obj_name);
-            exit(-1);
+        else {
+            if (count < 20) {
+                printf("[%d] create obj with name %s\n", rank, obj_name);
+            }
+            test_obj = PDCobj_create(cont, obj_name, obj_prop);
+            if (test_obj == 0) {
+                printf("Error getting an object id of %s from server, exit...\n", obj_name);
+                exit(-1);
+            }
         }
 
         // Print progress
@@ -219,10 +255,31 @@ main(int argc, char **argv)
     ht_total_sec = ht_total_elapsed / 1000000.0;
     if (rank == 0) {
         printf("Time to create %d obj/rank with %d ranks: %.6f\n", count, size, ht_total_sec);
+        printf("Throughput: %.2f obj/s per rank, %.2f obj/s in total\n", count / ht_total_sec,
+               count * size / ht_total_sec);
         fflush(stdout);
     }
 
+    // The server finds the objects of the last batch by name, with the IDs the batch returned
+    for (j = 0; j < n_batch; j++) {
+        meta = NULL;
+        if (PDC_Client_query_metadata_name_timestep(batch_names[j], rank, &meta) != SUCCEED ||
+            meta == NULL || meta->obj_id != PDCobj_get_info(batch_objs[j])->meta_id) {
+            printf("Object %s of the batch is not found by name @ line %d\n", batch_names[j], __LINE__);
+            ret_value = 1;
+        }
+        free(meta);
+        PDCobj_close(batch_objs[j]);
+    }
+
 done:
+    if (batch_names != NULL) {
+        for (j = 0; j < batch; j++)
+            free(batch_names[j]);
+        free(batch_names);
+    }
+    free(batch_objs);
+
     // close a container
     if (PDCcont_close(cont) < 0)
         printf("fail to close container c1\n");
@@ -238,5 +295,5 @@ done:
     MPI_Finalize();
 #endif
 
-    return 0;
+    return ret_value;
 }
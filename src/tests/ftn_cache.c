@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "pdc.h"
+#include "pdc_transforms_pkg.h"
+#include "pdc_analysis_pkg.h"
+
+void
+print_usage()
+{
+    printf("Usage: ./ftn_cache n_lookup n_register\n");
+}
+
+static double
+now_sec()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// Functions of the program and of a library are resolved, then found in the cache
+static int
+check_resolve(int n_lookup)
+{
+    size_t (*len_ftn)(const char *) = NULL;
+    double (*cos_ftn)(double)       = NULL;
+    void * first, *handle;
+    double start;
+    int    i, ret_value = 0;
+
+    if (PDC_get_ftnPtr_("strlen", NULL, &first) < 0 || (len_ftn = first) == NULL || len_ftn("pdc") != 3) {
+        printf("Fail to resolve strlen @ line  %d!\n", __LINE__);
+        return 1;
+    }
+    // A second library is opened on its own, not looked up in the first one
+    if (PDC_get_ftnPtr_("cos", "libm.so.6", &handle) < 0 || (cos_ftn = handle) == NULL ||
+        cos_ftn(0.0) != 1.0) {
+        printf("Fail to resolve cos in libm @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    if (PDC_get_ftnPtr_("pdc_no_such_function", NULL, &handle) >= 0 ||
+        PDC_get_ftnPtr_("cos", "libpdc_no_such_library.so", &handle) >= 0) {
+        printf("Missing function is resolved @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+
+    start = now_sec();
+    for (i = 0; i < n_lookup; i++) {
+        if (PDC_get_ftnPtr_("strlen", NULL, &handle) < 0 || handle != first) {
+            printf("Cached lookup %d differs @ line  %d!\n", i, __LINE__);
+            ret_value = 1;
+            break;
+        }
+    }
+    printf("%d cached lookups in %.3f s\n", n_lookup, now_sec() - start);
+
+    return ret_value;
+}
+
+// Registration of the same function and object finds the earlier entry, also after the registry grows
+static int
+check_registry(int n_register)
+{
+    struct _pdc_region_transform_ftn_info *thisFtn;
+    size_t (*ftns[2])() = {(size_t(*)())strlen, (size_t(*)())strnlen};
+    int     i, index, ret_value = 0;
+    double  start;
+
+    start = now_sec();
+    for (i = 0; i < n_register; i++) {
+        thisFtn            = (struct _pdc_region_transform_ftn_info *)calloc(1, sizeof(*thisFtn));
+        thisFtn->ftnPtr    = ftns[i % 2];
+        thisFtn->object_id = i / 2;
+        if (PDC_add_transform_ptr_to_registry_(thisFtn) != i) {
+            printf("Registration %d is not a new entry @ line  %d!\n", i, __LINE__);
+            return 1;
+        }
+    }
+    for (i = 0; i < n_register; i++) {
+        thisFtn            = (struct _pdc_region_transform_ftn_info *)calloc(1, sizeof(*thisFtn));
+        thisFtn->ftnPtr    = ftns[i % 2];
+        thisFtn->object_id = i / 2;
+        if ((index = PDC_add_transform_ptr_to_registry_(thisFtn)) != i) {
+            printf("Registration %d found entry %d @ line  %d!\n", i, index, __LINE__);
+            ret_value = 1;
+        }
+        free(thisFtn);
+        if (ret_value != 0)
+            break;
+    }
+    printf("%d transforms registered twice in %.3f s\n", n_register, now_sec() - start);
+
+    return ret_value;
+}
+
+int
+main(int argc, char **argv)
+{
+    int n_lookup = 1000000, n_register = 100000, ret_value = 0;
+
+    if (argc > 2) {
+        n_lookup   = atoi(argv[1]);
+        n_register = atoi(argv[2]);
+    }
+    if (n_lookup <= 0 || n_register <= 0) {
+        print_usage();
+        return 1;
+    }
+
+    ret_value |= check_resolve(n_lookup);
+    ret_value |= check_registry(n_register);
+    PDC_free_transform_registry();
+
+    return ret_value;
+}
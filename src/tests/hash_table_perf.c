@@ -0,0 +1,204 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/time.h>
+
+#include "mercury_hash_table.h"
+#include "pdc_hash-table.h"
+
+#define KEY_MULT 2654435761U
+
+void
+print_usage()
+{
+    printf("Usage: ./hash_table_perf n_key\n");
+}
+
+static int
+int_equal(void *vlocation1, void *vlocation2)
+{
+    return *((uint32_t *)vlocation1) == *((uint32_t *)vlocation2);
+}
+
+// Same hash as the server used for the name hash keys
+static unsigned int
+int_hash(void *vlocation)
+{
+    return *((uint32_t *)vlocation);
+}
+
+static void
+int_hash_key_free(void *key)
+{
+    free((uint32_t *)key);
+}
+
+static double
+elapsed_ns(struct timeval *start, struct timeval *end, int n)
+{
+    return ((end->tv_sec - start->tv_sec) * 1000000.0 + (end->tv_usec - start->tv_usec)) * 1000.0 / n;
+}
+
+// Chained table with a key allocation per entry, as the server tables were
+static int
+bench_chained(int n_key, int *order, double *insert_ns, double *hit_ns, double *miss_ns)
+{
+    hg_hash_table_t *table;
+    uint32_t *       key, lookup_key;
+    struct timeval   start, end;
+    int              i, j, n_err = 0;
+
+    table = hg_hash_table_new(int_hash, int_equal);
+    hg_hash_table_register_free_functions(table, int_hash_key_free, NULL);
+
+    gettimeofday(&start, 0);
+    for (i = 0; i < n_key; i++) {
+        key  = (uint32_t *)malloc(sizeof(uint32_t));
+        *key = i * KEY_MULT;
+        hg_hash_table_insert(table, key, (void *)(intptr_t)(i + 1));
+    }
+    gettimeofday(&end, 0);
+    *insert_ns = elapsed_ns(&start, &end, n_key);
+
+    gettimeofday(&start, 0);
+    for (i = 0; i < n_key; i++) {
+        j          = order[i];
+        lookup_key = j * KEY_MULT;
+        if (hg_hash_table_lookup(table, &lookup_key) != (void *)(intptr_t)(j + 1))
+            n_err++;
+    }
+    gettimeofday(&end, 0);
+    *hit_ns = elapsed_ns(&start, &end, n_key);
+
+    gettimeofday(&start, 0);
+    for (i = 0; i < n_key; i++) {
+        lookup_key = (n_key + order[i]) * KEY_MULT;
+        if (hg_hash_table_lookup(table, &lookup_key) != HG_HASH_TABLE_NULL)
+            n_err++;
+    }
+    gettimeofday(&end, 0);
+    *miss_ns = elapsed_ns(&start, &end, n_key);
+
+    hg_hash_table_free(table);
+
+    return n_err;
+}
+
+// Open addressing table, with allocated keys or with uint32 keys stored in the table
+static int
+bench_open(int n_key, int *order, int int_keys, double *insert_ns, double *hit_ns, double *miss_ns)
+{
+    HashTable *    table;
+    uint32_t *     key, lookup_key;
+    struct timeval start, end;
+    int            i, j, n_err = 0;
+
+    if (int_keys)
+        table = hash_table_new_uint32();
+    else {
+        table = hash_table_new(int_hash, int_equal);
+        hash_table_register_free_functions(table, int_hash_key_free, NULL);
+    }
+
+    gettimeofday(&start, 0);
+    for (i = 0; i < n_key; i++) {
+        if (int_keys) {
+            lookup_key = i * KEY_MULT;
+            key        = &lookup_key;
+        }
+        else {
+            key  = (uint32_t *)malloc(sizeof(uint32_t));
+            *key = i * KEY_MULT;
+        }
+        hash_table_insert(table, key, (void *)(intptr_t)(i + 1));
+    }
+    gettimeofday(&end, 0);
+    *insert_ns = elapsed_ns(&start, &end, n_key);
+
+    gettimeofday(&start, 0);
+    for (i = 0; i < n_key; i++) {
+        j          = order[i];
+        lookup_key = j * KEY_MULT;
+        if (hash_table_lookup(table, &lookup_key) != (void *)(intptr_t)(j + 1))
+            n_err++;
+    }
+    gettimeofday(&end, 0);
+    *hit_ns = elapsed_ns(&start, &end, n_key);
+
+    gettimeofday(&start, 0);
+    for (i = 0; i < n_key; i++) {
+        lookup_key = (n_key + order[i]) * KEY_MULT;
+        if (hash_table_lookup(table, &lookup_key) != HASH_TABLE_NULL)
+            n_err++;
+    }
+    gettimeofday(&end, 0);
+    *miss_ns = elapsed_ns(&start, &end, n_key);
+
+    // Removing every other key must leave the rest in place
+    for (i = 0; i < n_key; i += 2) {
+        lookup_key = i * KEY_MULT;
+        if (hash_table_remove(table, &lookup_key) != 1)
+            n_err++;
+    }
+    for (i = 0; i < n_key; i++) {
+        lookup_key = i * KEY_MULT;
+        if (hash_table_lookup(table, &lookup_key) != (i % 2 ? (void *)(intptr_t)(i + 1) : HASH_TABLE_NULL))
+            n_err++;
+    }
+    if (hash_table_num_entries(table) != (unsigned int)(n_key / 2))
+        n_err++;
+
+    hash_table_free(table);
+
+    return n_err;
+}
+
+int
+main(int argc, char **argv)
+{
+    int    n_key = 1000000, n_err, i, j, tmp;
+    int *  order;
+    double insert_ns[3], hit_ns[3], miss_ns[3];
+    int    ret_value = 0;
+
+    if (argc > 1)
+        n_key = atoi(argv[1]);
+    if (n_key <= 0) {
+        print_usage();
+        return 1;
+    }
+
+    // Keys are looked up in random order, not in the order the entries were allocated
+    order = (int *)malloc(sizeof(int) * n_key);
+    if (order == NULL) {
+        printf("Fail to allocate %d keys @ line  %d!\n", n_key, __LINE__);
+        return 1;
+    }
+    for (i = 0; i < n_key; i++)
+        order[i] = i;
+    srand(1);
+    for (i = n_key - 1; i > 0; i--) {
+        j        = rand() % (i + 1);
+        tmp      = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+
+    n_err = bench_chained(n_key, order, &insert_ns[0], &hit_ns[0], &miss_ns[0]);
+    n_err += bench_open(n_key, order, 0, &insert_ns[1], &hit_ns[1], &miss_ns[1]);
+    n_err += bench_open(n_key, order, 1, &insert_ns[2], &hit_ns[2], &miss_ns[2]);
+    if (n_err != 0) {
+        printf("%d wrong lookup results!\n", n_err);
+        ret_value = 1;
+    }
+
+    printf("%d keys, ns per operation      insert  lookup hit  lookup miss\n", n_key);
+    printf("Chained                       %8.1f    %8.1f     %8.1f\n", insert_ns[0], hit_ns[0], miss_ns[0]);
+    printf("Open addressing               %8.1f    %8.1f     %8.1f\n", insert_ns[1], hit_ns[1], miss_ns[1]);
+    printf("Open addressing, uint32 keys  %8.1f    %8.1f     %8.1f\n", insert_ns[2], hit_ns[2], miss_ns[2]);
+
+    free(order);
+
+    return ret_value;
+}
@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include "pdc.h"
+#include "pdc_hist_pkg.h"
+
+void
+print_usage()
+{
+    printf("Usage: ./hist_perf n_elem n_thread\n");
+}
+
+static double
+elapsed_s(struct timeval *start, struct timeval *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_usec - start->tv_usec) / 1000000.0;
+}
+
+// Empty copy of a histogram, with the same bins
+static pdc_histogram_t *
+empty_hist(pdc_histogram_t *hist)
+{
+    pdc_histogram_t *res = PDC_dup_hist(hist);
+
+    memset(res->bin, 0, sizeof(uint64_t) * res->nbin);
+    res->range[0]                 = res->range[1];
+    res->range[res->nbin * 2 - 1] = res->range[res->nbin * 2 - 2];
+
+    return res;
+}
+
+// One element at a time with a branch per bin class, as the histograms were built before
+#define SCALAR_HIST(TYPE, hist, n, data)                                                                     \
+    ({                                                                                                       \
+        TYPE *   ldata = (TYPE *)(data);                                                                     \
+        uint64_t e, k;                                                                                       \
+        for (e = 0; e < (n); e++) {                                                                          \
+            if (ldata[e] < (hist)->range[1]) {                                                               \
+                (hist)->bin[0]++;                                                                            \
+                if (ldata[e] < (hist)->range[0])                                                             \
+                    (hist)->range[0] = ldata[e];                                                             \
+            }                                                                                                \
+            else if (ldata[e] >= (hist)->range[(hist)->nbin * 2 - 2]) {                                      \
+                (hist)->bin[(hist)->nbin - 1]++;                                                             \
+                if (ldata[e] > (hist)->range[(hist)->nbin * 2 - 1])                                          \
+                    (hist)->range[(hist)->nbin * 2 - 1] = ldata[e];                                          \
+            }                                                                                                \
+            else {                                                                                           \
+                k = (uint64_t)((ldata[e] - (hist)->range[1]) / (hist)->incr + 1);                            \
+                (hist)->bin[k < (uint64_t)(hist)->nbin - 1 ? k : (uint64_t)(hist)->nbin - 1]++;              \
+            }                                                                                                \
+        }                                                                                                    \
+    })
+
+// Build the histogram of the data with the scalar loop and with 1 and n_thread threads
+static int
+bench_type(pdc_var_type_t dtype, const char *name, size_t elem_size, uint64_t n, void *data, int n_thread)
+{
+    pdc_histogram_t *tmpl, *ref, *hist;
+    struct timeval   start, end;
+    double           elapsed[3], gb = (double)n * elem_size / 1e9;
+    int              i, t, n_err = 0;
+
+    tmpl = PDC_gen_hist(dtype, n, data);
+    if (tmpl == NULL) {
+        printf("Fail to generate %s histogram @ line  %d!\n", name, __LINE__);
+        return 1;
+    }
+
+    ref = empty_hist(tmpl);
+    gettimeofday(&start, 0);
+    if (dtype == PDC_DOUBLE)
+        SCALAR_HIST(double, ref, n, data);
+    else
+        SCALAR_HIST(int, ref, n, data);
+    gettimeofday(&end, 0);
+    elapsed[0] = elapsed_s(&start, &end);
+
+    // The bins and the extended first and last bin must be the same whatever the number of threads
+    for (t = 0; t < 2; t++) {
+        hist = empty_hist(tmpl);
+        gettimeofday(&start, 0);
+        PDC_hist_incr_all_nthread(hist, dtype, n, data, t == 0 ? 1 : n_thread);
+        gettimeofday(&end, 0);
+        elapsed[t + 1] = elapsed_s(&start, &end);
+
+        for (i = 0; i < hist->nbin; i++) {
+            if (hist->bin[i] != ref->bin[i])
+                n_err++;
+        }
+        if (hist->range[0] != ref->range[0] ||
+            hist->range[hist->nbin * 2 - 1] != ref->range[ref->nbin * 2 - 1])
+            n_err++;
+        if (memcmp(hist->bin, tmpl->bin, sizeof(uint64_t) * hist->nbin) != 0)
+            n_err++;
+        PDC_free_hist(hist);
+    }
+    if (n_err != 0)
+        printf("%s histogram differs from the scalar loop in %d bins!\n", name, n_err);
+
+    printf("%-6s %3d bins  scalar %6.2f GB/s  1 thread %6.2f GB/s  %d threads %6.2f GB/s (%.2f per core)\n",
+           name, tmpl->nbin, gb / elapsed[0], gb / elapsed[1], n_thread, gb / elapsed[2],
+           gb / elapsed[2] / n_thread);
+
+    PDC_free_hist(ref);
+    PDC_free_hist(tmpl);
+
+    return n_err != 0;
+}
+
+int
+main(int argc, char **argv)
+{
+    uint64_t n = 16777216, i, seed = 1;
+    int      n_thread, ret_value = 0;
+    double * dbl;
+    int *    ints;
+
+    n_thread = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (argc > 1)
+        n = strtoull(argv[1], NULL, 10);
+    if (argc > 2)
+        n_thread = atoi(argv[2]);
+    if (n == 0 || n_thread <= 0) {
+        print_usage();
+        return 1;
+    }
+
+    dbl  = (double *)malloc(sizeof(double) * n);
+    ints = (int *)malloc(sizeof(int) * n);
+    if (dbl == NULL || ints == NULL) {
+        printf("Fail to allocate %" PRIu64 " elements @ line  %d!\n", n, __LINE__);
+        return 1;
+    }
+
+    // Sum of uniform values, most elements fall in the middle bins and a few in the open ended ones
+    for (i = 0; i < n; i++) {
+        seed    = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        dbl[i]  = ((seed >> 40) & 0xffff) / 65536.0 + ((seed >> 20) & 0xffff) / 65536.0 - 1.0;
+        ints[i] = (int)(dbl[i] * 100000);
+    }
+
+    printf("%" PRIu64 " elements\n", n);
+    ret_value |= bench_type(PDC_DOUBLE, "double", sizeof(double), n, dbl, n_thread);
+    ret_value |= bench_type(PDC_INT, "int", sizeof(int), n, ints, n_thread);
+
+    free(dbl);
+    free(ints);
+
+    return ret_value;
+}
@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <inttypes.h>
+#include "pdc.h"
+#include "pdc_meta_cache.h"
+
+void
+print_usage()
+{
+    printf("Usage: ./meta_cache n_obj\n");
+}
+
+static void
+make_metadata(pdc_metadata_t *meta, int i, uint64_t obj_id)
+{
+    char obj_name[ADDR_MAX];
+
+    sprintf(obj_name, "obj_%d", i);
+    PDC_metadata_init(meta);
+    meta->obj_id    = obj_id;
+    meta->time_step = i % 4;
+    meta->obj_name  = PDC_metadata_intern_str(obj_name);
+    meta->ndim      = 1;
+    meta->dims[0]   = i;
+}
+
+int
+main(int argc, char **argv)
+{
+    int               n_obj = 10000, i, n_found;
+    pdc_meta_cache_t *cache;
+    pdc_metadata_t    meta, out;
+    uint64_t          n_hit, n_miss;
+    struct timeval    start, end;
+    double            elapsed;
+    int               ret_value = 0;
+
+    if (argc > 1)
+        n_obj = atoi(argv[1]);
+    if (n_obj < 2) {
+        print_usage();
+        return 1;
+    }
+
+    cache = PDC_meta_cache_new(n_obj);
+    if (cache == NULL) {
+        printf("Fail to create metadata cache @ line  %d!\n", __LINE__);
+        return 1;
+    }
+
+    for (i = 0; i < n_obj; i++) {
+        make_metadata(&meta, i, 1000000 + i);
+        PDC_meta_cache_put(cache, &meta, 60000);
+    }
+
+    // Every object is found under both keys with the same record
+    gettimeofday(&start, 0);
+    for (i = 0; i < n_obj; i++) {
+        make_metadata(&meta, i, 1000000 + i);
+        if (PDC_meta_cache_get_by_name(cache, meta.obj_name, meta.time_step, &out) != 1 ||
+            out.obj_id != meta.obj_id || out.dims[0] != meta.dims[0]) {
+            printf("Object %d is not found by name!\n", i);
+            ret_value = 1;
+            goto done;
+        }
+        if (PDC_meta_cache_get_by_id(cache, meta.obj_id, &out) != 1 || out.obj_name != meta.obj_name) {
+            printf("Object %d is not found by ID!\n", i);
+            ret_value = 1;
+            goto done;
+        }
+    }
+    gettimeofday(&end, 0);
+    elapsed = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0;
+    printf("%d objects, %.1f ns per lookup\n", n_obj, elapsed * 1e9 / (2.0 * n_obj));
+
+    // A different time step is a different object
+    make_metadata(&meta, 0, 1000000);
+    if (PDC_meta_cache_get_by_name(cache, meta.obj_name, meta.time_step + 1, &out) != 0) {
+        printf("Object 0 is found at another time step!\n");
+        ret_value = 1;
+    }
+
+    // Deleting by ID drops the name key too, and the other way around
+    PDC_meta_cache_invalidate_id(cache, 1000000);
+    if (PDC_meta_cache_get_by_name(cache, meta.obj_name, meta.time_step, &out) != 0) {
+        printf("Object 0 is found by name after invalidating its ID!\n");
+        ret_value = 1;
+    }
+    make_metadata(&meta, 1, 1000001);
+    PDC_meta_cache_invalidate_name(cache, meta.obj_name, meta.time_step);
+    if (PDC_meta_cache_get_by_id(cache, 1000001, &out) != 0) {
+        printf("Object 1 is found by ID after invalidating its name!\n");
+        ret_value = 1;
+    }
+
+    // Recreating an object replaces its entry with the new ID
+    make_metadata(&meta, 2, 2000002);
+    PDC_meta_cache_put(cache, &meta, 60000);
+    if (PDC_meta_cache_get_by_id(cache, 1000002, &out) != 0 ||
+        PDC_meta_cache_get_by_name(cache, meta.obj_name, meta.time_step, &out) != 1 ||
+        out.obj_id != 2000002) {
+        printf("Object 2 is not replaced!\n");
+        ret_value = 1;
+    }
+
+    // The least recently used objects are evicted once the cache is full
+    for (i = 0; i < n_obj / 2; i++) {
+        make_metadata(&meta, n_obj + i, 3000000 + i);
+        PDC_meta_cache_put(cache, &meta, 60000);
+    }
+    if (PDC_meta_cache_get_by_id(cache, 2000002, &out) != 1) {
+        printf("Recently used object 2 is evicted!\n");
+        ret_value = 1;
+    }
+    for (i = 3, n_found = 0; i < n_obj; i++)
+        n_found += PDC_meta_cache_get_by_id(cache, 1000000 + i, &out);
+    if (n_found > n_obj / 2) {
+        printf("%d objects are still cached, not more than %d expected!\n", n_found, n_obj / 2);
+        ret_value = 1;
+    }
+
+    // No lease, no entry, and entries are not used after their lease expires
+    make_metadata(&meta, 0, 4000000);
+    PDC_meta_cache_put(cache, &meta, 0);
+    if (PDC_meta_cache_get_by_id(cache, 4000000, &out) != 0) {
+        printf("Object without a lease is cached!\n");
+        ret_value = 1;
+    }
+    PDC_meta_cache_put(cache, &meta, 50);
+    if (PDC_meta_cache_get_by_id(cache, 4000000, &out) != 1) {
+        printf("Object with a lease is not cached!\n");
+        ret_value = 1;
+    }
+    usleep(100000);
+    if (PDC_meta_cache_get_by_name(cache, meta.obj_name, meta.time_step, &out) != 0) {
+        printf("Object is used after its lease expired!\n");
+        ret_value = 1;
+    }
+
+    PDC_meta_cache_stats(cache, &n_hit, &n_miss);
+    printf("%" PRIu64 " hits, %" PRIu64 " misses\n", n_hit, n_miss);
+
+done:
+    PDC_meta_cache_free(cache);
+
+    return ret_value;
+}
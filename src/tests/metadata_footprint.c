@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <inttypes.h>
+#include "pdc.h"
+#include "pdc_client_server_common.h"
+
+void
+print_usage()
+{
+    printf("Usage: ./metadata_footprint n_obj n_app\n");
+}
+
+int
+main(int argc, char **argv)
+{
+    int             n_obj = 100000, n_app = 4, i;
+    pdc_metadata_t *metadata, tmp;
+    char            obj_name[ADDR_MAX], app_name[ADDR_MAX], tags[TAG_LEN_MAX], data_location[ADDR_MAX];
+    char *          buf, *interned;
+    uint64_t        nstr_start, nbytes_start, nstr_end, nbytes_end, nstr, nbytes;
+    double          legacy_size, compact_size, elapsed;
+    struct timeval  start, end;
+    int             ret_value = 0;
+
+    if (argc > 1)
+        n_obj = atoi(argv[1]);
+    if (argc > 2)
+        n_app = atoi(argv[2]);
+    if (n_obj <= 0 || n_app <= 0) {
+        print_usage();
+        return 1;
+    }
+
+    metadata = (pdc_metadata_t *)calloc(n_obj, sizeof(pdc_metadata_t));
+    if (metadata == NULL) {
+        printf("Fail to allocate %d metadata @ line  %d!\n", n_obj, __LINE__);
+        return 1;
+    }
+
+    PDC_metadata_intern_stats(&nstr_start, &nbytes_start);
+
+    // Same record contents as the server builds from an object create request
+    gettimeofday(&start, 0);
+    for (i = 0; i < n_obj; i++) {
+        sprintf(obj_name, "obj_%d", i);
+        sprintf(app_name, "app_%d", i % n_app);
+        sprintf(tags, "tag0=%d", i % 16);
+        sprintf(data_location, "/scratch/pdc/app_%d", i % n_app);
+
+        PDC_metadata_init(&metadata[i]);
+        metadata[i].obj_id        = 1000000 + i;
+        metadata[i].time_step     = 0;
+        metadata[i].obj_name      = PDC_metadata_intern_str(obj_name);
+        metadata[i].app_name      = PDC_metadata_intern_str(app_name);
+        metadata[i].tags          = PDC_metadata_intern_str(tags);
+        metadata[i].data_location = PDC_metadata_intern_str(data_location);
+        if (metadata[i].obj_name == NULL || metadata[i].app_name == NULL || metadata[i].tags == NULL ||
+            metadata[i].data_location == NULL) {
+            printf("Fail to intern metadata strings of object %d @ line  %d!\n", i, __LINE__);
+            ret_value = 1;
+            goto done;
+        }
+    }
+    gettimeofday(&end, 0);
+    elapsed = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0;
+
+    PDC_metadata_intern_stats(&nstr_end, &nbytes_end);
+
+    // Records with the same app name must share a single copy of the string
+    if (n_obj > n_app && metadata[0].app_name != metadata[n_app].app_name) {
+        printf("App name of object 0 and %d is not shared!\n", n_app);
+        ret_value = 1;
+    }
+
+    // Serialized records must come back with the same interned strings
+    buf = (char *)malloc(PDC_metadata_serialize_size(&metadata[n_obj - 1]));
+    PDC_metadata_serialize(&metadata[n_obj - 1], buf);
+    PDC_metadata_deserialize(buf, &tmp);
+    if (tmp.obj_id != metadata[n_obj - 1].obj_id || tmp.obj_name != metadata[n_obj - 1].obj_name ||
+        tmp.app_name != metadata[n_obj - 1].app_name || tmp.tags != metadata[n_obj - 1].tags ||
+        tmp.data_location != metadata[n_obj - 1].data_location) {
+        printf("Deserialized metadata differs from [%s]!\n", metadata[n_obj - 1].obj_name);
+        ret_value = 1;
+    }
+    PDC_metadata_release_strs(&tmp);
+    free(buf);
+
+    // The previous layout embedded app_name, obj_name and data_location[ADDR_MAX] and tags[TAG_LEN_MAX]
+    legacy_size  = sizeof(pdc_metadata_t) - 4 * sizeof(char *) + 3 * ADDR_MAX + TAG_LEN_MAX;
+    compact_size = sizeof(pdc_metadata_t) + (double)(nbytes_end - nbytes_start) / n_obj;
+
+    printf("%d objects, %d app names, %" PRIu64 " interned strings, %.2f s to build\n", n_obj, n_app,
+           nstr_end - nstr_start, elapsed);
+    printf("Embedded string layout: %.1f bytes per object\n", legacy_size);
+    printf("Compact layout        : %.1f bytes per object (%zu record + %.1f strings)\n", compact_size,
+           sizeof(pdc_metadata_t), compact_size - sizeof(pdc_metadata_t));
+
+    if (compact_size >= legacy_size) {
+        printf("Compact layout is not smaller!\n");
+        ret_value = 1;
+    }
+
+    // Tags replaced again and again keep a single copy, the old ones are freed
+    for (i = 0; i < 10000; i++) {
+        sprintf(tags, "tag0=%d,tag1=%d", i % 16, i);
+        interned = PDC_metadata_intern_str(tags);
+        PDC_metadata_intern_release(metadata[0].tags);
+        metadata[0].tags = interned;
+    }
+    PDC_metadata_intern_stats(&nstr, &nbytes);
+    if (nstr > nstr_end + 1) {
+        printf("%" PRIu64 " interned strings after replacing tags, %" PRIu64 " before!\n", nstr, nstr_end);
+        ret_value = 1;
+    }
+
+    // Releasing all records frees all their strings
+    for (i = 0; i < n_obj; i++)
+        PDC_metadata_release_strs(&metadata[i]);
+    PDC_metadata_intern_stats(&nstr, &nbytes);
+    if (nstr != nstr_start) {
+        printf("%" PRIu64 " interned strings after releasing all records, %" PRIu64 " before!\n", nstr,
+               nstr_start);
+        ret_value = 1;
+    }
+
+    // Records released without ever being set, as on the error paths of the server, leave nothing behind
+    for (i = 0; i < 1000; i++) {
+        PDC_metadata_init(&tmp);
+        PDC_metadata_release_strs(&tmp);
+    }
+    PDC_metadata_intern_stats(&nstr, &nbytes);
+    if (nstr != nstr_start) {
+        printf("%" PRIu64 " interned strings after releasing empty records, %" PRIu64 " before!\n", nstr,
+               nstr_start);
+        ret_value = 1;
+    }
+
+done:
+    free(metadata);
+
+    return ret_value;
+}
@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include "pdc.h"
+#include "pdc_client_connect.h"
+#include "pdc_client_server_common.h"
+
+// Run with run_restart_test.sh, "write" before the server is killed and "verify" after it restarts
+void
+print_usage()
+{
+    printf("Usage: ./metadata_log write|verify n_obj\n");
+}
+
+int
+main(int argc, char **argv)
+{
+    int             n_obj, i, is_write, value, *get_value;
+    pdcid_t         pdc, cont_prop, cont, obj_prop, obj;
+    psize_t         value_size;
+    pdc_metadata_t *metadata;
+    uint64_t        max_obj_id = 0;
+    char            obj_name[128];
+    int             ret_value = 0;
+
+    if (argc < 3 || (strcmp(argv[1], "write") != 0 && strcmp(argv[1], "verify") != 0)) {
+        print_usage();
+        return 1;
+    }
+    is_write = strcmp(argv[1], "write") == 0;
+    n_obj    = atoi(argv[2]);
+
+    // create a pdc
+    pdc = PDCinit("pdc");
+
+    // create a container property
+    cont_prop = PDCprop_create(PDC_CONT_CREATE, pdc);
+    if (cont_prop <= 0) {
+        printf("Fail to create container property @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    // create a container
+    cont = PDCcont_create("c1", cont_prop);
+    if (cont <= 0) {
+        printf("Fail to create container @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    // create an object property
+    obj_prop = PDCprop_create(PDC_OBJ_CREATE, pdc);
+    if (obj_prop <= 0) {
+        printf("Fail to create object property @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    PDCprop_set_obj_user_id(obj_prop, getuid());
+    PDCprop_set_obj_time_step(obj_prop, 0);
+    PDCprop_set_obj_app_name(obj_prop, "MetadataLogTest");
+    PDCprop_set_obj_tags(obj_prop, "tag0=1");
+
+    for (i = 0; i < n_obj; i++) {
+        sprintf(obj_name, "log_obj_%d", i);
+
+        if (is_write) {
+            // Every object gets a tag, every 4th object replaces it, and every 4th + 1 object is deleted
+            obj = PDCobj_create(cont, obj_name, obj_prop);
+            if (obj <= 0) {
+                printf("Fail to create object %s @ line  %d!\n", obj_name, __LINE__);
+                ret_value = 1;
+                break;
+            }
+            value = i;
+            if (PDCobj_put_tag(obj, "log_tag", &value, sizeof(int)) < 0) {
+                printf("Fail to put tag of %s @ line  %d!\n", obj_name, __LINE__);
+                ret_value = 1;
+            }
+            if (i % 4 == 0) {
+                value = i + n_obj;
+                if (PDCtag_delete(obj, "log_tag") < 0 ||
+                    PDCobj_put_tag(obj, "log_tag", &value, sizeof(int)) < 0) {
+                    printf("Fail to replace tag of %s @ line  %d!\n", obj_name, __LINE__);
+                    ret_value = 1;
+                }
+            }
+            PDCobj_close(obj);
+
+            if (i % 4 == 1) {
+                PDC_Client_query_metadata_name_timestep(obj_name, 0, &metadata);
+                if (metadata == NULL || PDC_Client_delete_metadata_by_id(metadata->obj_id) != SUCCEED) {
+                    printf("Fail to delete %s @ line  %d!\n", obj_name, __LINE__);
+                    ret_value = 1;
+                }
+            }
+        }
+        else {
+            // The restarted server must have replayed all of the above from its metadata log
+            PDC_Client_query_metadata_name_timestep(obj_name, 0, &metadata);
+            if (i % 4 == 1) {
+                if (metadata != NULL) {
+                    printf("Deleted object %s is back after restart!\n", obj_name);
+                    ret_value = 1;
+                }
+                continue;
+            }
+            if (metadata == NULL) {
+                printf("Object %s is lost after restart!\n", obj_name);
+                ret_value = 1;
+                continue;
+            }
+            if (metadata->obj_id > max_obj_id)
+                max_obj_id = metadata->obj_id;
+
+            obj = PDCobj_open(obj_name, pdc);
+            if (PDCobj_get_tag(obj, "log_tag", (void **)&get_value, &value_size) < 0) {
+                printf("Fail to get tag of %s @ line  %d!\n", obj_name, __LINE__);
+                ret_value = 1;
+            }
+            else if (*get_value != (i % 4 == 0 ? i + n_obj : i)) {
+                printf("Tag of %s is %d after restart!\n", obj_name, *get_value);
+                ret_value = 1;
+            }
+            PDCobj_close(obj);
+        }
+    }
+
+    // Objects created after restart must not reuse the replayed ids
+    if (!is_write && ret_value == 0) {
+        obj = PDCobj_create(cont, "log_obj_new", obj_prop);
+        PDC_Client_query_metadata_name_timestep("log_obj_new", 0, &metadata);
+        if (obj <= 0 || metadata == NULL || metadata->obj_id <= max_obj_id) {
+            printf("New object id is not after the replayed ids!\n");
+            ret_value = 1;
+        }
+        else
+            printf("Restored %d objects from the metadata log\n", n_obj - (n_obj + 2) / 4);
+    }
+
+    // close a container
+    if (PDCcont_close(cont) < 0) {
+        printf("fail to close container c1\n");
+        ret_value = 1;
+    }
+    // close a container property
+    if (PDCprop_close(cont_prop) < 0) {
+        printf("Fail to close property @ line %d\n", __LINE__);
+        ret_value = 1;
+    }
+    if (PDCclose(pdc) < 0) {
+        printf("fail to close PDC\n");
+        ret_value = 1;
+    }
+
+    return ret_value;
+}
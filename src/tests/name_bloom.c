@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <inttypes.h>
+#include "pdc.h"
+#include "pdc_bloom.h"
+
+// The false positive rate of PDC_BLOOM_BITS_PER_ITEM bits per name is well below this
+#define MAX_FALSE_POS_RATE 0.01
+
+void
+print_usage()
+{
+    printf("Usage: ./name_bloom n_obj\n");
+}
+
+int
+main(int argc, char **argv)
+{
+    int            n_obj = 100000, i, len, ret_value = 0;
+    uint64_t       n_false_pos = 0;
+    pdc_bloom_t *  bloom;
+    char           key[64];
+    double         elapsed, rate;
+    struct timeval start, end;
+
+    if (argc > 1)
+        n_obj = atoi(argv[1]);
+    if (n_obj <= 0) {
+        print_usage();
+        return 1;
+    }
+
+    bloom = PDC_bloom_new(n_obj);
+    if (bloom == NULL) {
+        printf("Fail to create bloom filter @ line  %d!\n", __LINE__);
+        return 1;
+    }
+
+    // Same keys as the server, object name followed by the time step
+    for (i = 0; i < n_obj; i++) {
+        len = sprintf(key, "obj_%d%d", i, 0);
+        PDC_bloom_add(bloom, key, len);
+    }
+
+    // Every added name must be found
+    for (i = 0; i < n_obj; i++) {
+        len = sprintf(key, "obj_%d%d", i, 0);
+        if (PDC_bloom_check(bloom, key, len) == 0) {
+            printf("Added name [%s] is not in the bloom filter!\n", key);
+            ret_value = 1;
+            goto done;
+        }
+    }
+
+    // Names that were never added, the lookups of create-if-absent
+    gettimeofday(&start, 0);
+    for (i = 0; i < n_obj; i++) {
+        len = sprintf(key, "new_obj_%d%d", i, 0);
+        n_false_pos += PDC_bloom_check(bloom, key, len);
+    }
+    gettimeofday(&end, 0);
+    elapsed = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0;
+    rate    = (double)n_false_pos / n_obj;
+
+    printf("%d names in %" PRIu64 " blocks, %" PRIu64 " false positives of %d absent names (%.4f), "
+           "%.1f ns per check\n",
+           n_obj, bloom->n_block, n_false_pos, n_obj, rate, elapsed * 1e9 / n_obj);
+
+    if (rate > MAX_FALSE_POS_RATE) {
+        printf("False positive rate %.4f is higher than %.4f!\n", rate, MAX_FALSE_POS_RATE);
+        ret_value = 1;
+    }
+
+    PDC_bloom_clear(bloom);
+    len = sprintf(key, "obj_%d%d", 0, 0);
+    if (PDC_bloom_check(bloom, key, len) != 0 || bloom->n_item != 0) {
+        printf("Bloom filter is not empty after clear!\n");
+        ret_value = 1;
+    }
+
+done:
+    PDC_bloom_free(bloom);
+
+    return ret_value;
+}
@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+#include "pdc.h"
+
+void
+print_usage()
+{
+    printf("Usage: ./obj_compress n_elem n_region has_codec\n");
+}
+
+// Write or read a range of the object through a buffer map
+static int
+transfer_range(pdcid_t obj, float *buf, uint64_t offset, uint64_t len, pdc_access_t access_type)
+{
+    pdcid_t  local_reg, global_reg;
+    uint64_t local_offset = 0;
+    int      ret_value    = 0;
+
+    local_reg  = PDCregion_create(1, &local_offset, &len);
+    global_reg = PDCregion_create(1, &offset, &len);
+    if (PDCbuf_obj_map(buf, PDC_FLOAT, local_reg, obj, global_reg) != SUCCEED ||
+        PDCreg_obtain_lock(obj, global_reg, access_type, PDC_BLOCK) != SUCCEED ||
+        PDCreg_release_lock(obj, global_reg, access_type) != SUCCEED ||
+        PDCbuf_obj_unmap(obj, global_reg) != SUCCEED) {
+        printf("Fail to transfer [%" PRIu64 ", %" PRIu64 ") @ line  %d!\n", offset, offset + len, __LINE__);
+        ret_value = 1;
+    }
+    PDCregion_close(local_reg);
+    PDCregion_close(global_reg);
+
+    return ret_value;
+}
+
+static float
+field(uint64_t i)
+{
+    return (float)(sin(i * 0.001) * 100.0);
+}
+
+// Path of the file the server stores the object in, see server_open_storage
+static void
+storage_path(pdcid_t obj, char *path, size_t size)
+{
+    const char *data_path = getenv("PDC_DATA_LOC");
+
+    if (data_path == NULL)
+        data_path = getenv("SCRATCH");
+    if (data_path == NULL)
+        data_path = ".";
+    snprintf(path, size, "%s/pdc_data/%" PRIu64 "/server0/s0000.bin", data_path,
+             (uint64_t)PDCobj_get_info(obj)->meta_id);
+}
+
+int
+main(int argc, char **argv)
+{
+    int         n_region = 4, has_codec = 0, ret_value = 0, i;
+    uint64_t    n_elem = 262144, k, dims[1], patch_off, patch_len;
+    pdcid_t     pdc, cont_prop, cont, obj_prop, obj;
+    float *     data, expect;
+    char        path[1024];
+    struct stat st;
+
+    if (argc > 1)
+        n_elem = atoll(argv[1]);
+    if (argc > 2)
+        n_region = atoi(argv[2]);
+    if (argc > 3)
+        has_codec = atoi(argv[3]);
+    if (n_elem == 0 || n_region <= 0) {
+        print_usage();
+        return 1;
+    }
+
+    pdc       = PDCinit("pdc");
+    cont_prop = PDCprop_create(PDC_CONT_CREATE, pdc);
+    cont      = PDCcont_create("c_obj_compress", cont_prop);
+    obj_prop  = PDCprop_create(PDC_OBJ_CREATE, pdc);
+    if (cont_prop <= 0 || cont <= 0 || obj_prop <= 0) {
+        printf("Fail to create container @ line  %d!\n", __LINE__);
+        return 1;
+    }
+    dims[0] = n_elem * n_region;
+    PDCprop_set_obj_type(obj_prop, PDC_FLOAT);
+    PDCprop_set_obj_dims(obj_prop, 1, dims);
+    PDCprop_set_obj_user_id(obj_prop, getuid());
+    PDCprop_set_obj_time_step(obj_prop, 0);
+    PDCprop_set_obj_app_name(obj_prop, "CompressTest");
+    PDCprop_set_obj_tags(obj_prop, "tag0=1");
+    if (PDCprop_set_obj_compress(obj_prop, PDC_COMPRESS_AUTO, 0) != SUCCEED) {
+        printf("Fail to set compression @ line  %d!\n", __LINE__);
+        return 1;
+    }
+    obj = PDCobj_create(cont, "o_obj_compress", obj_prop);
+    if (obj <= 0) {
+        printf("Fail to create object @ line  %d!\n", __LINE__);
+        return 1;
+    }
+
+    data = (float *)malloc(sizeof(float) * n_elem);
+
+    // The server creates the file at the first write, a file of an earlier run is not counted
+    storage_path(obj, path, sizeof(path));
+    unlink(path);
+
+    // A smooth field compresses well, each region is stored compressed by the server
+    for (i = 0; i < n_region; i++) {
+        for (k = 0; k < n_elem; k++)
+            data[k] = field(i * n_elem + k);
+        ret_value |= transfer_range(obj, data, i * n_elem, n_elem, PDC_WRITE);
+    }
+
+    // The read is served after the writes. A compressed region takes at most 7/8 of its size, so the
+    // file is smaller than the data if the regions were stored with a codec.
+    ret_value |= transfer_range(obj, data, 0, n_elem, PDC_READ);
+    if (has_codec == 0)
+        printf("No codec is built, the storage size is not checked\n");
+    else if (stat(path, &st) != 0 || (uint64_t)st.st_size >= sizeof(float) * n_elem * n_region) {
+        printf("Object is stored in %" PRIu64 " bytes, not compressed from %" PRIu64 " bytes @ line  %d!\n",
+               (uint64_t)st.st_size, (uint64_t)(sizeof(float) * n_elem * n_region), __LINE__);
+        ret_value = 1;
+    }
+
+    // Overwrite the middle of the first region with noise, which no longer fits in place
+    patch_off = n_elem / 4;
+    patch_len = n_elem / 2;
+    srand(1);
+    for (k = 0; k < patch_len; k++)
+        data[k] = (float)rand();
+    ret_value |= transfer_range(obj, data, patch_off, patch_len, PDC_WRITE);
+
+    // The data read back must be the same as written, whatever the codec
+    for (i = 0; i < n_region; i++) {
+        memset(data, 0, sizeof(float) * n_elem);
+        ret_value |= transfer_range(obj, data, i * n_elem, n_elem, PDC_READ);
+        srand(1);
+        for (k = 0; k < n_elem; k++) {
+            if (i == 0 && k >= patch_off && k < patch_off + patch_len)
+                expect = (float)rand();
+            else
+                expect = field(i * n_elem + k);
+            if (data[k] != expect) {
+                printf("Region %d has %f at %" PRIu64 ", expected %f!\n", i, data[k], k, expect);
+                ret_value = 1;
+                break;
+            }
+        }
+    }
+
+    free(data);
+
+    if (PDCobj_close(obj) < 0) {
+        printf("fail to close object\n");
+        ret_value = 1;
+    }
+    if (PDCprop_close(obj_prop) < 0) {
+        printf("Fail to close property @ line %d\n", __LINE__);
+        ret_value = 1;
+    }
+    if (PDCcont_close(cont) < 0) {
+        printf("fail to close container\n");
+        ret_value = 1;
+    }
+    if (PDCprop_close(cont_prop) < 0) {
+        printf("Fail to close property @ line %d\n", __LINE__);
+        ret_value = 1;
+    }
+    if (PDCclose(pdc) < 0) {
+        printf("fail to close PDC\n");
+        ret_value = 1;
+    }
+
+    return ret_value;
+}
@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <inttypes.h>
+#include "pdc.h"
+
+void
+print_usage()
+{
+    printf("Usage: ./obj_lossy n_elem rel_bound abs_bound\n");
+}
+
+// Write or read the whole object through a buffer map
+static int
+transfer_obj(pdcid_t obj, void *buf, pdc_var_type_t type, uint64_t n_elem, pdc_access_t access_type)
+{
+    pdcid_t  local_reg, global_reg;
+    uint64_t offset = 0;
+    int      ret_value = 0;
+
+    local_reg  = PDCregion_create(1, &offset, &n_elem);
+    global_reg = PDCregion_create(1, &offset, &n_elem);
+    if (PDCbuf_obj_map(buf, type, local_reg, obj, global_reg) != SUCCEED ||
+        PDCreg_obtain_lock(obj, global_reg, access_type, PDC_BLOCK) != SUCCEED ||
+        PDCreg_release_lock(obj, global_reg, access_type) != SUCCEED ||
+        PDCbuf_obj_unmap(obj, global_reg) != SUCCEED) {
+        printf("Fail to transfer %" PRIu64 " elements @ line  %d!\n", n_elem, __LINE__);
+        ret_value = 1;
+    }
+    PDCregion_close(local_reg);
+    PDCregion_close(global_reg);
+
+    return ret_value;
+}
+
+static pdcid_t
+create_obj(pdcid_t pdc, pdcid_t cont, const char *name, pdc_var_type_t type, uint64_t n_elem,
+           pdc_error_bound_t mode, double bound)
+{
+    pdcid_t obj_prop, obj = 0;
+
+    obj_prop = PDCprop_create(PDC_OBJ_CREATE, pdc);
+    PDCprop_set_obj_type(obj_prop, type);
+    PDCprop_set_obj_dims(obj_prop, 1, &n_elem);
+    PDCprop_set_obj_user_id(obj_prop, getuid());
+    PDCprop_set_obj_time_step(obj_prop, 0);
+    PDCprop_set_obj_app_name(obj_prop, "LossyTest");
+    PDCprop_set_obj_tags(obj_prop, "tag0=1");
+    if (PDCprop_set_obj_error_bound(obj_prop, mode, bound) != SUCCEED)
+        printf("Fail to set error bound of %s @ line  %d!\n", name, __LINE__);
+    else
+        obj = PDCobj_create(cont, name, obj_prop);
+    PDCprop_close(obj_prop);
+
+    return obj;
+}
+
+int
+main(int argc, char **argv)
+{
+    uint64_t n_elem = 1048576, i, n_bad = 0;
+    double   rel_bound = 1e-4, abs_bound = 1e-3, lo, hi, bound, err, max_err = 0;
+    pdcid_t  pdc, cont_prop, cont, fobj, dobj;
+    float *  fdata, *fread;
+    double * ddata, *dread;
+    int      ret_value = 0;
+
+    if (argc > 1)
+        n_elem = atoll(argv[1]);
+    if (argc > 2)
+        rel_bound = atof(argv[2]);
+    if (argc > 3)
+        abs_bound = atof(argv[3]);
+    if (n_elem == 0 || rel_bound <= 0 || abs_bound <= 0) {
+        print_usage();
+        return 1;
+    }
+
+    pdc       = PDCinit("pdc");
+    cont_prop = PDCprop_create(PDC_CONT_CREATE, pdc);
+    cont      = PDCcont_create("c_obj_lossy", cont_prop);
+    if (cont_prop <= 0 || cont <= 0) {
+        printf("Fail to create container @ line  %d!\n", __LINE__);
+        return 1;
+    }
+    fobj = create_obj(pdc, cont, "o_obj_lossy_float", PDC_FLOAT, n_elem, PDC_ERROR_BOUND_REL, rel_bound);
+    dobj = create_obj(pdc, cont, "o_obj_lossy_double", PDC_DOUBLE, n_elem, PDC_ERROR_BOUND_ABS, abs_bound);
+    if (fobj <= 0 || dobj <= 0) {
+        printf("Fail to create objects @ line  %d!\n", __LINE__);
+        return 1;
+    }
+
+    // Smooth fields with some noise, as mesh variables of a checkpoint
+    fdata = (float *)malloc(sizeof(float) * n_elem);
+    fread = (float *)malloc(sizeof(float) * n_elem);
+    ddata = (double *)malloc(sizeof(double) * n_elem);
+    dread = (double *)malloc(sizeof(double) * n_elem);
+    srand(1);
+    lo = hi = 0;
+    for (i = 0; i < n_elem; i++) {
+        fdata[i] = (float)(sin(i * 0.0005) * 300.0 + (rand() % 1000) * 0.001);
+        ddata[i] = cos(i * 0.0001) * 1e4 + (rand() % 1000) * 1e-6;
+        lo       = (i == 0 || fdata[i] < lo) ? fdata[i] : lo;
+        hi       = (i == 0 || fdata[i] > hi) ? fdata[i] : hi;
+    }
+
+    ret_value |= transfer_obj(fobj, fdata, PDC_FLOAT, n_elem, PDC_WRITE);
+    ret_value |= transfer_obj(dobj, ddata, PDC_DOUBLE, n_elem, PDC_WRITE);
+    ret_value |= transfer_obj(fobj, fread, PDC_FLOAT, n_elem, PDC_READ);
+    ret_value |= transfer_obj(dobj, dread, PDC_DOUBLE, n_elem, PDC_READ);
+
+    // The relative bound is relative to the value range of the region written
+    bound = rel_bound * (hi - lo);
+    for (i = 0; i < n_elem; i++) {
+        err     = fabs((double)fread[i] - fdata[i]);
+        max_err = err > max_err ? err : max_err;
+        if (!(err <= bound) && n_bad++ < 10)
+            printf("Float value %" PRIu64 " is %f, written %f, bound %g!\n", i, fread[i], fdata[i], bound);
+    }
+    printf("Float object: max error %g, bound %g\n", max_err, bound);
+
+    max_err = 0;
+    for (i = 0; i < n_elem; i++) {
+        err     = fabs(dread[i] - ddata[i]);
+        max_err = err > max_err ? err : max_err;
+        if (!(err <= abs_bound) && n_bad++ < 10)
+            printf("Double value %" PRIu64 " is %f, written %f, bound %g!\n", i, dread[i], ddata[i],
+                   abs_bound);
+    }
+    printf("Double object: max error %g, bound %g\n", max_err, abs_bound);
+
+    if (n_bad > 0) {
+        printf("%" PRIu64 " values are not within the error bound!\n", n_bad);
+        ret_value = 1;
+    }
+
+    free(fdata);
+    free(fread);
+    free(ddata);
+    free(dread);
+
+    if (PDCobj_close(fobj) < 0 || PDCobj_close(dobj) < 0) {
+        printf("fail to close object\n");
+        ret_value = 1;
+    }
+    if (PDCcont_close(cont) < 0) {
+        printf("fail to close container\n");
+        ret_value = 1;
+    }
+    if (PDCprop_close(cont_prop) < 0) {
+        printf("Fail to close property @ line %d\n", __LINE__);
+        ret_value = 1;
+    }
+    if (PDCclose(pdc) < 0) {
+        printf("fail to close PDC\n");
+        ret_value = 1;
+    }
+
+    return ret_value;
+}
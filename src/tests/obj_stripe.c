@@ -0,0 +1,243 @@
+/*
+ * Copyright Notice for
+ * Proactive Data Containers (PDC) Software Library and Utilities
+ * -----------------------------------------------------------------------------
+
+ *** Copyright Notice ***
+
+ * Proactive Data Containers (PDC) Copyright (c) 2017, The Regents of the
+ * University of California, through Lawrence Berkeley National Laboratory,
+ * UChicago Argonne, LLC, operator of Argonne National Laboratory, and The HDF
+ * Group (subject to receipt of any required approvals from the U.S. Dept. of
+ * Energy).  All rights reserved.
+
+ * If you have questions about your rights to use or distribute this software,
+ * please contact Berkeley Lab's Innovation & Partnerships Office at  IPO@lbl.gov.
+
+ * NOTICE.  This Software was developed under funding from the U.S. Department of
+ * Energy and the U.S. Government consequently retains certain rights. As such, the
+ * U.S. Government has been granted for itself and others acting on its behalf a
+ * paid-up, nonexclusive, irrevocable, worldwide license in the Software to
+ * reproduce, distribute copies to the public, prepare derivative works, and
+ * perform publicly and display publicly, and to permit other to do so.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include "pdc.h"
+#include "pdc_client_connect.h"
+#include "pdc_client_server_common.h"
+
+#define ROW_LEN 1024
+
+void
+print_usage()
+{
+    printf("Usage: srun -n ./obj_stripe obj_name n_row_per_client stripe_KB\n");
+}
+
+/*
+ * Write or read rows of a 2D object, the local buffer is mapped as a 2D or 1D region
+ */
+static int
+transfer_rows(pdcid_t obj, int *buf, uint64_t row_offset, uint64_t n_row, int local_ndim, pdc_access_t access)
+{
+    pdcid_t  local_reg, remote_reg;
+    uint64_t local_offset[2] = {0, 0}, local_size[2], offset[2], size[2];
+    int      ret_value       = 0;
+
+    offset[0] = row_offset;
+    offset[1] = 0;
+    size[0]   = n_row;
+    size[1]   = ROW_LEN;
+    if (local_ndim == 2) {
+        local_size[0] = n_row;
+        local_size[1] = ROW_LEN;
+    }
+    else
+        local_size[0] = n_row * ROW_LEN;
+
+    local_reg  = PDCregion_create(local_ndim, local_offset, local_size);
+    remote_reg = PDCregion_create(2, offset, size);
+
+    if (PDCbuf_obj_map(buf, PDC_INT, local_reg, obj, remote_reg) != SUCCEED) {
+        printf("PDCbuf_obj_map failed @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    if (PDCreg_obtain_lock(obj, remote_reg, access, PDC_BLOCK) != SUCCEED) {
+        printf("PDCreg_obtain_lock failed @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    if (PDCreg_release_lock(obj, remote_reg, access) != SUCCEED) {
+        printf("PDCreg_release_lock failed @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    if (PDCbuf_obj_unmap(obj, remote_reg) != SUCCEED) {
+        printf("PDCbuf_obj_unmap failed @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+
+    PDCregion_close(local_reg);
+    PDCregion_close(remote_reg);
+
+    return ret_value;
+}
+
+int
+main(int argc, char **argv)
+{
+    int      rank = 0, size = 1, read_rank;
+    pdcid_t  pdc, cont_prop, cont = 0, obj_prop, obj = 0, obj_read = 0;
+    uint64_t dims[2], n_row, stripe_size, i;
+    char *   obj_name;
+    int *    data = NULL, *data_read = NULL;
+    int      ret_value = 0;
+
+#ifdef ENABLE_MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+#endif
+
+    if (argc < 4) {
+        print_usage();
+#ifdef ENABLE_MPI
+        MPI_Finalize();
+#endif
+        return 1;
+    }
+
+    obj_name    = argv[1];
+    n_row       = atoi(argv[2]);
+    stripe_size = atoi(argv[3]) * 1024;
+    dims[0]     = n_row * size;
+    dims[1]     = ROW_LEN;
+
+    if (rank == 0)
+        printf("Striping a %" PRIu64 " x %d int object [%s] in %" PRIu64 " KB stripes with %d clients\n",
+               dims[0], ROW_LEN, obj_name, stripe_size / 1024, size);
+
+    // create a pdc
+    pdc = PDCinit("pdc");
+
+    // create a container property
+    cont_prop = PDCprop_create(PDC_CONT_CREATE, pdc);
+    if (cont_prop <= 0) {
+        printf("Fail to create container property @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    // create a container
+    cont = PDCcont_create("c1", cont_prop);
+    if (cont <= 0) {
+        printf("Fail to create container @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    // create an object property, striped over all the servers
+    obj_prop = PDCprop_create(PDC_OBJ_CREATE, pdc);
+    if (obj_prop <= 0) {
+        printf("Fail to create object property @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    PDCprop_set_obj_dims(obj_prop, 2, dims);
+    PDCprop_set_obj_type(obj_prop, PDC_INT);
+    PDCprop_set_obj_user_id(obj_prop, getuid());
+    PDCprop_set_obj_time_step(obj_prop, 0);
+    PDCprop_set_obj_app_name(obj_prop, "StripeTest");
+    if (PDCprop_set_obj_stripe(obj_prop, stripe_size, 64) != SUCCEED) {
+        printf("Fail to set object stripe @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+
+    // Create the object with only rank 0, the other clients get the layout by opening it
+    if (rank == 0) {
+        obj = PDCobj_create(cont, obj_name, obj_prop);
+        if (obj <= 0) {
+            printf("Fail to create object @ line  %d!\n", __LINE__);
+            ret_value = 1;
+        }
+    }
+#ifdef ENABLE_MPI
+    MPI_Barrier(MPI_COMM_WORLD);
+#endif
+    if (rank != 0) {
+        obj = PDCobj_open(obj_name, pdc);
+        if (obj <= 0) {
+            printf("Fail to open object @ line  %d!\n", __LINE__);
+            ret_value = 1;
+        }
+    }
+    if (ret_value != 0)
+        goto done;
+
+    // Each client writes its rows, which start and end in the middle of stripes
+    data      = (int *)malloc(n_row * ROW_LEN * sizeof(int));
+    data_read = (int *)malloc(n_row * ROW_LEN * sizeof(int));
+    for (i = 0; i < n_row * ROW_LEN; i++)
+        data[i] = (int)(rank * n_row * ROW_LEN + i);
+    ret_value |= transfer_rows(obj, data, rank * n_row, n_row, 2, PDC_WRITE);
+
+#ifdef ENABLE_MPI
+    MPI_Barrier(MPI_COMM_WORLD);
+#endif
+
+    // Read the rows of another client through a newly opened object, into a 1D buffer
+    obj_read = PDCobj_open(obj_name, pdc);
+    if (obj_read <= 0) {
+        printf("Fail to open object @ line  %d!\n", __LINE__);
+        ret_value = 1;
+        goto done;
+    }
+    read_rank = (rank + 1) % size;
+    memset(data_read, 0, n_row * ROW_LEN * sizeof(int));
+    ret_value |= transfer_rows(obj_read, data_read, read_rank * n_row, n_row, 1, PDC_READ);
+
+    for (i = 0; i < n_row * ROW_LEN; i++) {
+        if (data_read[i] != (int)(read_rank * n_row * ROW_LEN + i)) {
+            printf("Element %" PRIu64 " of rank %d is %d, expected %d!\n", i, read_rank, data_read[i],
+                   (int)(read_rank * n_row * ROW_LEN + i));
+            ret_value = 1;
+            break;
+        }
+    }
+    if (ret_value == 0 && rank == 0)
+        printf("Read back %" PRIu64 " striped rows correctly\n", n_row);
+
+done:
+    free(data);
+    free(data_read);
+    if (obj_read > 0 && PDCobj_close(obj_read) < 0) {
+        printf("fail to close object @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    if (obj > 0 && PDCobj_close(obj) < 0) {
+        printf("fail to close object @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    // close a container
+    if (PDCcont_close(cont) < 0) {
+        printf("fail to close container c1\n");
+        ret_value = 1;
+    }
+    // close an object property
+    if (PDCprop_close(obj_prop) < 0) {
+        printf("Fail to close property @ line %d\n", __LINE__);
+        ret_value = 1;
+    }
+    // close a container property
+    if (PDCprop_close(cont_prop) < 0) {
+        printf("Fail to close property @ line %d\n", __LINE__);
+        ret_value = 1;
+    }
+    if (PDCclose(pdc) < 0) {
+        printf("fail to close PDC\n");
+        ret_value = 1;
+    }
+#ifdef ENABLE_MPI
+    MPI_Finalize();
+#endif
+
+    return ret_value;
+}
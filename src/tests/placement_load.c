@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "pdc.h"
+#include "pdc_client_server_common.h"
+#include "pdc_placement.h"
+
+void
+print_usage()
+{
+    printf("Usage: ./placement_load n_server n_obj [n_vnode]\n");
+}
+
+/*
+ * Place objects by name the way a client routes their creation, and report the load of each server
+ *
+ * \return Fraction of the objects placed on a different server than in prev, if given
+ */
+static double
+place_objects(int n_server, int n_obj, uint32_t *placed, const uint32_t *prev, double *max_ratio,
+              double *min_ratio)
+{
+    char     obj_name[64];
+    uint64_t moved = 0;
+    double   mean;
+    int *    load, i, max = 0, min = n_obj;
+
+    load = (int *)calloc(n_server, sizeof(int));
+    for (i = 0; i < n_obj; i++) {
+        sprintf(obj_name, "obj_%d", i);
+        placed[i] = PDC_placement_get_server(PDC_get_hash_by_name(obj_name), n_server);
+        load[placed[i]]++;
+        if (prev != NULL && prev[i] != placed[i])
+            moved++;
+    }
+
+    mean = (double)n_obj / n_server;
+    for (i = 0; i < n_server; i++) {
+        if (load[i] > max)
+            max = load[i];
+        if (load[i] < min)
+            min = load[i];
+    }
+    *max_ratio = max / mean;
+    *min_ratio = min / mean;
+    free(load);
+
+    return (double)moved / n_obj;
+}
+
+int
+main(int argc, char **argv)
+{
+    int       n_server, n_obj, n_vnode = PDC_PLACEMENT_DEFAULT_VNODES, i, ret_value = 0;
+    uint32_t *placed, *placed_more;
+    double    max_ratio, min_ratio, moved, *weights;
+    char      obj_name[64];
+    int *     load;
+
+    if (argc < 3) {
+        print_usage();
+        return 1;
+    }
+    n_server = atoi(argv[1]);
+    n_obj    = atoi(argv[2]);
+    if (argc > 3)
+        n_vnode = atoi(argv[3]);
+    if (n_server <= 0 || n_obj <= 0 || n_vnode <= 0) {
+        print_usage();
+        return 1;
+    }
+
+    placed      = (uint32_t *)malloc(sizeof(uint32_t) * n_obj);
+    placed_more = (uint32_t *)malloc(sizeof(uint32_t) * n_obj);
+    weights     = (double *)malloc(sizeof(double) * n_server);
+    load        = (int *)calloc(n_server, sizeof(int));
+
+    printf("Placing %d objects on %d servers, %d vnodes per server\n\n", n_obj, n_server, n_vnode);
+    printf("%-10s %10s %10s %28s\n", "Method", "Max/mean", "Min/mean", "Moved when adding a server");
+
+    // Modulo placement moves almost every object when a server is added
+    PDC_placement_init(n_server, PDC_PLACEMENT_MODULO, n_vnode, NULL);
+    place_objects(n_server, n_obj, placed, NULL, &max_ratio, &min_ratio);
+    PDC_placement_init(n_server + 1, PDC_PLACEMENT_MODULO, n_vnode, NULL);
+    moved = place_objects(n_server + 1, n_obj, placed_more, placed, &max_ratio, &min_ratio);
+    PDC_placement_init(n_server, PDC_PLACEMENT_MODULO, n_vnode, NULL);
+    place_objects(n_server, n_obj, placed, NULL, &max_ratio, &min_ratio);
+    printf("%-10s %10.3f %10.3f %27.1f%%\n", "modulo", max_ratio, min_ratio, moved * 100);
+
+    // Consistent hashing only moves the objects taken over by the new server
+    PDC_placement_init(n_server + 1, PDC_PLACEMENT_CHASH, n_vnode, NULL);
+    place_objects(n_server + 1, n_obj, placed_more, NULL, &max_ratio, &min_ratio);
+    PDC_placement_init(n_server, PDC_PLACEMENT_CHASH, n_vnode, NULL);
+    moved = place_objects(n_server, n_obj, placed, placed_more, &max_ratio, &min_ratio);
+    printf("%-10s %10.3f %10.3f %27.1f%%\n", "chash", max_ratio, min_ratio, moved * 100);
+
+    if (moved > 2.0 / (n_server + 1)) {
+        printf("Consistent hashing moved %.1f%% of the objects, more than %.1f%%!\n", moved * 100,
+               200.0 / (n_server + 1));
+        ret_value = 1;
+    }
+    if (n_obj >= 100 * n_server && max_ratio > 1.5) {
+        printf("Consistent hashing placed %.2f times the mean load on a server!\n", max_ratio);
+        ret_value = 1;
+    }
+
+    // Server 0 with twice the capacity of the others should get about twice their load
+    for (i = 0; i < n_server; i++)
+        weights[i] = i == 0 ? 2.0 : 1.0;
+    PDC_placement_init(n_server, PDC_PLACEMENT_CHASH, n_vnode, weights);
+    for (i = 0; i < n_obj; i++) {
+        sprintf(obj_name, "obj_%d", i);
+        load[PDC_placement_get_server(PDC_get_hash_by_name(obj_name), n_server)]++;
+    }
+
+    printf("\n%-8s %8s %10s %10s\n", "Server", "Weight", "Share", "Objects");
+    for (i = 0; i < n_server; i++)
+        printf("%-8d %8.1f %9.2f%% %10d\n", i, weights[i], PDC_placement_get_share(i) * 100, load[i]);
+
+    if (n_server > 1 && n_obj >= 100 * n_server && load[0] < 1.5 * n_obj / (n_server + 1)) {
+        printf("Server 0 with weight 2 only has %d objects!\n", load[0]);
+        ret_value = 1;
+    }
+
+    PDC_placement_finalize();
+    free(placed);
+    free(placed_more);
+    free(weights);
+    free(load);
+
+    return ret_value;
+}
@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <sys/time.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include "pdc.h"
+#include "pdc_client_connect.h"
+#include "pdc_client_server_common.h"
+
+void
+print_usage()
+{
+    printf("Usage: srun -n ./query_aggregate obj_name size_MB\n");
+}
+
+int
+main(int argc, char **argv)
+{
+    int                    rank = 0, size = 1;
+    uint64_t               size_MB;
+    pdcid_t                obj_id = -1;
+    struct pdc_region_info region;
+    uint64_t               i, dims[1], nhits = 0, exp_count = 0;
+    double                 exp_sum = 0, exp_min = 0, exp_max = 0;
+    char *                 obj_name;
+    uint64_t               my_data_count;
+    pdc_metadata_t *       metadata;
+    pdcid_t                pdc, cont_prop, cont, obj_prop;
+    int                    ndim = 1;
+    int *                  mydata;
+    int                    hi = 5000;
+    pdc_query_t *          q;
+    pdc_query_agg_t        agg;
+    int                    ret_value = 0;
+
+#ifdef ENABLE_MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+#endif
+
+    if (argc < 3) {
+        print_usage();
+#ifdef ENABLE_MPI
+        MPI_Finalize();
+#endif
+        return 1;
+    }
+
+    obj_name = argv[1];
+    size_MB  = atoi(argv[2]);
+
+    if (rank == 0) {
+        printf("Writing a %" PRIu64 " MB object [%s] with %d clients.\n", size_MB, obj_name, size);
+    }
+    size_MB *= 1048576;
+
+    // create a pdc
+    pdc = PDCinit("pdc");
+
+    // create a container property
+    cont_prop = PDCprop_create(PDC_CONT_CREATE, pdc);
+    if (cont_prop <= 0) {
+        printf("Fail to create container property @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    // create a container
+    cont = PDCcont_create("c1", cont_prop);
+    if (cont <= 0) {
+        printf("Fail to create container @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    // create an object property
+    obj_prop = PDCprop_create(PDC_OBJ_CREATE, pdc);
+    if (obj_prop <= 0) {
+        printf("Fail to create object property @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    my_data_count = size_MB / size / sizeof(int);
+    dims[0]       = my_data_count * size;
+    PDCprop_set_obj_dims(obj_prop, 1, dims);
+    PDCprop_set_obj_user_id(obj_prop, getuid());
+    PDCprop_set_obj_time_step(obj_prop, 0);
+    PDCprop_set_obj_app_name(obj_prop, "DataServerTest");
+    PDCprop_set_obj_tags(obj_prop, "tag0=1");
+    PDCprop_set_obj_type(obj_prop, PDC_INT);
+
+    // Create a object with only rank 0
+    if (rank == 0) {
+        printf("Creating an object with name [%s]\n", obj_name);
+        fflush(stdout);
+        obj_id = PDCobj_create(cont, obj_name, obj_prop);
+        if (obj_id <= 0) {
+            printf("Error getting an object id of %s from server, exit...\n", obj_name);
+            ret_value = 1;
+        }
+    }
+
+#ifdef ENABLE_MPI
+    MPI_Barrier(MPI_COMM_WORLD);
+#endif
+
+    // Query the created object
+    PDC_Client_query_metadata_name_timestep(obj_name, 0, &metadata);
+    if (metadata == NULL || metadata->obj_id == 0) {
+        printf("Error with metadata!\n");
+        ret_value = 1;
+        goto done;
+    }
+
+    region.ndim      = ndim;
+    region.offset    = (uint64_t *)malloc(sizeof(uint64_t) * ndim);
+    region.size      = (uint64_t *)malloc(sizeof(uint64_t) * ndim);
+    region.offset[0] = rank * my_data_count * sizeof(int);
+    region.size[0]   = my_data_count * sizeof(int);
+
+    mydata = (int *)malloc(my_data_count * sizeof(int));
+    for (i = 0; i < my_data_count; i++)
+        mydata[i] = i % 10000 + rank * 1000;
+
+    PDC_Client_write(metadata, &region, mydata);
+
+#ifdef ENABLE_MPI
+    MPI_Barrier(MPI_COMM_WORLD);
+#endif
+
+    q = PDCquery_create(metadata->obj_id, PDC_LT, PDC_INT, &hi);
+
+    if (PDCquery_get_nhits(q, &nhits) < 0) {
+        printf("Fail to get nhits @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+
+    if (PDCquery_get_aggregate(q, metadata->obj_id, &agg) < 0) {
+        printf("Fail to get aggregate @ line  %d!\n", __LINE__);
+        ret_value = 1;
+        goto done;
+    }
+
+    // Compute the expected aggregate of the hits locally, every rank wrote the same pattern shifted by rank
+    for (int r = 0; r < size; r++) {
+        for (i = 0; i < my_data_count; i++) {
+            int v = i % 10000 + r * 1000;
+            if (v >= hi)
+                continue;
+            if (exp_count == 0 || v < exp_min)
+                exp_min = v;
+            if (exp_count == 0 || v > exp_max)
+                exp_max = v;
+            exp_sum += v;
+            exp_count++;
+        }
+    }
+
+    if (agg.count != nhits || agg.count != exp_count) {
+        printf("Aggregate count %" PRIu64 ", nhits %" PRIu64 ", expected %" PRIu64 "!\n", agg.count, nhits,
+               exp_count);
+        ret_value = 1;
+    }
+    if (agg.min != exp_min || agg.max != exp_max) {
+        printf("Aggregate min/max %.1f/%.1f, expected %.1f/%.1f!\n", agg.min, agg.max, exp_min, exp_max);
+        ret_value = 1;
+    }
+    if (agg.sum - exp_sum > 1e-9 * exp_sum || exp_sum - agg.sum > 1e-9 * exp_sum) {
+        printf("Aggregate sum %.1f, expected %.1f!\n", agg.sum, exp_sum);
+        ret_value = 1;
+    }
+    if (ret_value == 0 && rank == 0)
+        printf("Aggregate of %" PRIu64 " hits: sum %.1f, min %.1f, max %.1f, mean %.3f\n", agg.count, agg.sum,
+               agg.min, agg.max, agg.mean);
+
+    free(mydata);
+    PDCquery_free_all(q);
+    PDCregion_free(&region);
+
+done:
+    // close a container
+    if (PDCcont_close(cont) < 0) {
+        printf("fail to close container c1\n");
+        ret_value = 1;
+    }
+    // close a container property
+    if (PDCprop_close(cont_prop) < 0) {
+        printf("Fail to close property @ line %d\n", __LINE__);
+        ret_value = 1;
+    }
+    if (PDCclose(pdc) < 0) {
+        printf("fail to close PDC\n");
+        ret_value = 1;
+    }
+#ifdef ENABLE_MPI
+    MPI_Finalize();
+#endif
+
+    return ret_value;
+}
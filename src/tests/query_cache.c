@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <sys/time.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include "pdc.h"
+#include "pdc_client_connect.h"
+#include "pdc_client_server_common.h"
+
+void
+print_usage()
+{
+    printf("Usage: srun -n ./query_cache obj_name size_MB\n");
+}
+
+int
+main(int argc, char **argv)
+{
+    int                    rank = 0, size = 1;
+    uint64_t               size_MB;
+    pdcid_t                obj_id = -1;
+    struct pdc_region_info region;
+    uint64_t               i, dims[1], nhits = 0, nhits2 = 0, exp_nhits;
+    int                    iter;
+    char *                 obj_name;
+    uint64_t               my_data_count;
+    pdc_metadata_t *       metadata;
+    pdcid_t                pdc, cont_prop, cont, obj_prop;
+    int                    ndim = 1;
+    int *                  mydata;
+    int                    hi = 5000;
+    pdc_query_t *          q;
+    int                    ret_value = 0;
+
+#ifdef ENABLE_MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+#endif
+
+    if (argc < 3) {
+        print_usage();
+#ifdef ENABLE_MPI
+        MPI_Finalize();
+#endif
+        return 1;
+    }
+
+    obj_name = argv[1];
+    size_MB  = atoi(argv[2]);
+
+    if (rank == 0) {
+        printf("Writing a %" PRIu64 " MB object [%s] with %d clients.\n", size_MB, obj_name, size);
+    }
+    size_MB *= 1048576;
+
+    // create a pdc
+    pdc = PDCinit("pdc");
+
+    // create a container property
+    cont_prop = PDCprop_create(PDC_CONT_CREATE, pdc);
+    if (cont_prop <= 0) {
+        printf("Fail to create container property @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    // create a container
+    cont = PDCcont_create("c1", cont_prop);
+    if (cont <= 0) {
+        printf("Fail to create container @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    // create an object property
+    obj_prop = PDCprop_create(PDC_OBJ_CREATE, pdc);
+    if (obj_prop <= 0) {
+        printf("Fail to create object property @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    my_data_count = size_MB / size / sizeof(int);
+    dims[0]       = my_data_count * size;
+    PDCprop_set_obj_dims(obj_prop, 1, dims);
+    PDCprop_set_obj_user_id(obj_prop, getuid());
+    PDCprop_set_obj_time_step(obj_prop, 0);
+    PDCprop_set_obj_app_name(obj_prop, "DataServerTest");
+    PDCprop_set_obj_tags(obj_prop, "tag0=1");
+    PDCprop_set_obj_type(obj_prop, PDC_INT);
+
+    // Create a object with only rank 0
+    if (rank == 0) {
+        printf("Creating an object with name [%s]\n", obj_name);
+        fflush(stdout);
+        obj_id = PDCobj_create(cont, obj_name, obj_prop);
+        if (obj_id <= 0) {
+            printf("Error getting an object id of %s from server, exit...\n", obj_name);
+            ret_value = 1;
+        }
+    }
+
+#ifdef ENABLE_MPI
+    MPI_Barrier(MPI_COMM_WORLD);
+#endif
+
+    // Query the created object
+    PDC_Client_query_metadata_name_timestep(obj_name, 0, &metadata);
+    if (metadata == NULL || metadata->obj_id == 0) {
+        printf("Error with metadata!\n");
+        ret_value = 1;
+        goto done;
+    }
+
+    region.ndim      = ndim;
+    region.offset    = (uint64_t *)malloc(sizeof(uint64_t) * ndim);
+    region.size      = (uint64_t *)malloc(sizeof(uint64_t) * ndim);
+    region.offset[0] = rank * my_data_count * sizeof(int);
+    region.size[0]   = my_data_count * sizeof(int);
+
+    mydata = (int *)malloc(my_data_count * sizeof(int));
+    q      = NULL;
+
+    // Write, query twice (the second one is served by the server cache), then overwrite with data that
+    // has a different number of hits and check the cached result is not returned
+    for (iter = 0; iter < 2; iter++) {
+        for (i = 0; i < my_data_count; i++)
+            mydata[i] = iter == 0 ? i % 10000 : i % 20000;
+
+        PDC_Client_write(metadata, &region, mydata);
+
+#ifdef ENABLE_MPI
+        MPI_Barrier(MPI_COMM_WORLD);
+#endif
+
+        exp_nhits = 0;
+        for (i = 0; i < my_data_count; i++) {
+            if (mydata[i] < hi)
+                exp_nhits++;
+        }
+        exp_nhits *= size;
+
+        if (q == NULL)
+            q = PDCquery_create(metadata->obj_id, PDC_LT, PDC_INT, &hi);
+
+        if (PDCquery_get_nhits(q, &nhits) < 0 || PDCquery_get_nhits(q, &nhits2) < 0) {
+            printf("Fail to get nhits @ line  %d!\n", __LINE__);
+            ret_value = 1;
+            break;
+        }
+
+        if (nhits != exp_nhits || nhits2 != exp_nhits) {
+            printf("Round %d: query has %" PRIu64 " then %" PRIu64 " hits, expected %" PRIu64 "!\n", iter,
+                   nhits, nhits2, exp_nhits);
+            ret_value = 1;
+        }
+        else if (rank == 0)
+            printf("Round %d: query has %" PRIu64 " hits\n", iter, nhits);
+
+#ifdef ENABLE_MPI
+        MPI_Barrier(MPI_COMM_WORLD);
+#endif
+    }
+
+    free(mydata);
+    PDCquery_free_all(q);
+    PDCregion_free(&region);
+
+done:
+    // close a container
+    if (PDCcont_close(cont) < 0) {
+        printf("fail to close container c1\n");
+        ret_value = 1;
+    }
+    // close a container property
+    if (PDCprop_close(cont_prop) < 0) {
+        printf("Fail to close property @ line %d\n", __LINE__);
+        ret_value = 1;
+    }
+    if (PDCclose(pdc) < 0) {
+        printf("fail to close PDC\n");
+        ret_value = 1;
+    }
+#ifdef ENABLE_MPI
+    MPI_Finalize();
+#endif
+
+    return ret_value;
+}
@@ -0,0 +1,227 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <sys/time.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include "pdc.h"
+#include "pdc_client_connect.h"
+#include "pdc_client_server_common.h"
+
+void
+print_usage()
+{
+    printf("Usage: srun -n ./query_plan obj_name size_MB\n");
+}
+
+int
+main(int argc, char **argv)
+{
+    int                    rank = 0, size = 1;
+    uint64_t               size_MB;
+    pdcid_t                obj_id = -1, obj_id2 = -1, obj_id3 = -1, obj_id4 = -1;
+    struct pdc_region_info region;
+    uint64_t               i, dims[1], nhits = 0, exp_nhits = 0, exp_zhits = 0, exp_fhits = 0;
+    char *                 obj_name, obj_name2[128], obj_name3[128], obj_name4[128];
+    uint64_t               my_data_count;
+    pdc_metadata_t *       metadata, *metadata2, *metadata3, *metadata4;
+    pdcid_t                pdc, cont_prop, cont, obj_prop, obj_prop_f;
+    int                    ndim = 1;
+    int *                  xdata, *ydata, *zdata;
+    float *                fdata;
+    int                    xlo = 100, xhi = 9000, yval = 7, zhi = 250;
+    float                  fhi = 100.0;
+    pdc_query_t *          qxlo, *qxhi, *qy, *q, *qz, *qf;
+    int                    ret_value = 0;
+
+#ifdef ENABLE_MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+#endif
+
+    if (argc < 3) {
+        print_usage();
+#ifdef ENABLE_MPI
+        MPI_Finalize();
+#endif
+        return 1;
+    }
+
+    obj_name = argv[1];
+    size_MB  = atoi(argv[2]);
+    sprintf(obj_name2, "%s_y", obj_name);
+    sprintf(obj_name3, "%s_z", obj_name);
+    sprintf(obj_name4, "%s_f", obj_name);
+
+    if (rank == 0) {
+        printf("Writing two %" PRIu64 " MB objects [%s] [%s] with %d clients.\n", size_MB, obj_name,
+               obj_name2, size);
+    }
+    size_MB *= 1048576;
+
+    // create a pdc
+    pdc = PDCinit("pdc");
+
+    // create a container property
+    cont_prop = PDCprop_create(PDC_CONT_CREATE, pdc);
+    if (cont_prop <= 0) {
+        printf("Fail to create container property @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    // create a container
+    cont = PDCcont_create("c1", cont_prop);
+    if (cont <= 0) {
+        printf("Fail to create container @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    // create an object property
+    obj_prop = PDCprop_create(PDC_OBJ_CREATE, pdc);
+    if (obj_prop <= 0) {
+        printf("Fail to create object property @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    my_data_count = size_MB / size / sizeof(int);
+    dims[0]       = my_data_count * size;
+    PDCprop_set_obj_dims(obj_prop, 1, dims);
+    PDCprop_set_obj_user_id(obj_prop, getuid());
+    PDCprop_set_obj_time_step(obj_prop, 0);
+    PDCprop_set_obj_app_name(obj_prop, "DataServerTest");
+    PDCprop_set_obj_tags(obj_prop, "tag0=1");
+    PDCprop_set_obj_type(obj_prop, PDC_INT);
+    obj_prop_f = PDCprop_obj_dup(obj_prop);
+    PDCprop_set_obj_type(obj_prop_f, PDC_FLOAT);
+
+    // Create the objects with only rank 0
+    if (rank == 0) {
+        obj_id  = PDCobj_create(cont, obj_name, obj_prop);
+        obj_id2 = PDCobj_create(cont, obj_name2, obj_prop);
+        obj_id3 = PDCobj_create(cont, obj_name3, obj_prop);
+        obj_id4 = PDCobj_create(cont, obj_name4, obj_prop_f);
+        if (obj_id <= 0 || obj_id2 <= 0 || obj_id3 <= 0 || obj_id4 <= 0) {
+            printf("Error getting an object id of %s/%s from server, exit...\n", obj_name, obj_name2);
+            ret_value = 1;
+        }
+    }
+
+#ifdef ENABLE_MPI
+    MPI_Barrier(MPI_COMM_WORLD);
+#endif
+
+    // Query the created objects
+    PDC_Client_query_metadata_name_timestep(obj_name, 0, &metadata);
+    PDC_Client_query_metadata_name_timestep(obj_name2, 0, &metadata2);
+    PDC_Client_query_metadata_name_timestep(obj_name3, 0, &metadata3);
+    PDC_Client_query_metadata_name_timestep(obj_name4, 0, &metadata4);
+    if (metadata == NULL || metadata->obj_id == 0 || metadata2 == NULL || metadata2->obj_id == 0 ||
+        metadata3 == NULL || metadata3->obj_id == 0 || metadata4 == NULL || metadata4->obj_id == 0) {
+        printf("Error with metadata!\n");
+        ret_value = 1;
+        goto done;
+    }
+
+    region.ndim      = ndim;
+    region.offset    = (uint64_t *)malloc(sizeof(uint64_t) * ndim);
+    region.size      = (uint64_t *)malloc(sizeof(uint64_t) * ndim);
+    region.offset[0] = rank * my_data_count * sizeof(int);
+    region.size[0]   = my_data_count * sizeof(int);
+
+    xdata = (int *)malloc(my_data_count * sizeof(int));
+    ydata = (int *)malloc(my_data_count * sizeof(int));
+    zdata = (int *)malloc(my_data_count * sizeof(int));
+    fdata = (float *)malloc(my_data_count * sizeof(float));
+    for (i = 0; i < my_data_count; i++) {
+        xdata[i] = i % 10000 + rank * 1000;
+        ydata[i] = i % 100;
+        // No zero values, so the statistics of a region rule it out if a bound is decoded wrong
+        zdata[i] = i % 1000 + 1;
+        fdata[i] = 1.0 + (i % 1000) * 0.5;
+        if (zdata[i] <= zhi)
+            exp_zhits++;
+        if (fdata[i] < fhi)
+            exp_fhits++;
+    }
+    exp_zhits *= size;
+    exp_fhits *= size;
+
+    PDC_Client_write(metadata, &region, xdata);
+    PDC_Client_write(metadata2, &region, ydata);
+    PDC_Client_write(metadata3, &region, zdata);
+    PDC_Client_write(metadata4, &region, fdata);
+
+#ifdef ENABLE_MPI
+    MPI_Barrier(MPI_COMM_WORLD);
+#endif
+
+    // The most selective constraint is in the middle, the server plan should evaluate it first
+    qxlo = PDCquery_create(metadata->obj_id, PDC_GT, PDC_INT, &xlo);
+    qy   = PDCquery_create(metadata2->obj_id, PDC_EQ, PDC_INT, &yval);
+    qxhi = PDCquery_create(metadata->obj_id, PDC_LT, PDC_INT, &xhi);
+    q    = PDCquery_and(PDCquery_and(qxlo, qy), qxhi);
+
+    if (PDCquery_get_nhits(q, &nhits) < 0) {
+        printf("Fail to get nhits @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+
+    // Every rank wrote the same pattern, x shifted by rank
+    for (int r = 0; r < size; r++) {
+        for (i = 0; i < my_data_count; i++) {
+            int x = i % 10000 + r * 1000;
+            int y = i % 100;
+            if (x > xlo && x < xhi && y == yval)
+                exp_nhits++;
+        }
+    }
+
+    if (nhits != exp_nhits) {
+        printf("Query has %" PRIu64 " hits, expected %" PRIu64 "!\n", nhits, exp_nhits);
+        ret_value = 1;
+    }
+    else if (rank == 0)
+        printf("Query has %" PRIu64 " hits\n", nhits);
+
+    // One-sided int and float constraints, pruned with the histograms or sketches of the regions if the
+    // server generates them
+    qz = PDCquery_create(metadata3->obj_id, PDC_LTE, PDC_INT, &zhi);
+    qf = PDCquery_create(metadata4->obj_id, PDC_LT, PDC_FLOAT, &fhi);
+    if (PDCquery_get_nhits(qz, &nhits) < 0 || nhits != exp_zhits) {
+        printf("Int query has %" PRIu64 " hits, expected %" PRIu64 "!\n", nhits, exp_zhits);
+        ret_value = 1;
+    }
+    if (PDCquery_get_nhits(qf, &nhits) < 0 || nhits != exp_fhits) {
+        printf("Float query has %" PRIu64 " hits, expected %" PRIu64 "!\n", nhits, exp_fhits);
+        ret_value = 1;
+    }
+
+    free(xdata);
+    free(ydata);
+    free(zdata);
+    free(fdata);
+    PDCquery_free_all(qz);
+    PDCquery_free_all(qf);
+    PDCquery_free_all(q);
+    PDCregion_free(&region);
+
+done:
+    // close a container
+    if (PDCcont_close(cont) < 0) {
+        printf("fail to close container c1\n");
+        ret_value = 1;
+    }
+    // close a container property
+    if (PDCprop_close(cont_prop) < 0) {
+        printf("Fail to close property @ line %d\n", __LINE__);
+        ret_value = 1;
+    }
+    if (PDCclose(pdc) < 0) {
+        printf("fail to close PDC\n");
+        ret_value = 1;
+    }
+#ifdef ENABLE_MPI
+    MPI_Finalize();
+#endif
+
+    return ret_value;
+}
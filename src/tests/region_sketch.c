@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <inttypes.h>
+#include "pdc.h"
+#include "pdc_sketch.h"
+
+// Rank error of the quantile sketch and relative error of the distinct count that are accepted
+#define MAX_RANK_ERR     0.02
+#define MAX_DISTINCT_ERR 0.1
+#define N_REGION         8
+
+void
+print_usage()
+{
+    printf("Usage: ./region_sketch n_elem\n");
+}
+
+static int
+compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+// Compare the quantiles and the distinct count of a sketch with the exact ones of the sorted values
+static int
+check_sketch(const char *name, pdc_sketch_t *sketch, uint64_t n, double *sorted, uint64_t n_distinct)
+{
+    double   q, value, max_err = 0, err;
+    uint64_t rank, est;
+    int      i, n_err = 0;
+
+    if (sketch->n != n || sketch->min != sorted[0] || sketch->max != sorted[n - 1]) {
+        printf("%s: count/min/max %" PRIu64 "/%g/%g instead of %" PRIu64 "/%g/%g!\n", name, sketch->n,
+               sketch->min, sketch->max, n, sorted[0], sorted[n - 1]);
+        n_err++;
+    }
+
+    for (i = 1; i < 100; i++) {
+        q     = i / 100.0;
+        value = PDC_sketch_quantile(sketch, q);
+        // Rank of the estimated value among the exact values
+        rank = 0;
+        while (rank < n && sorted[rank] < value)
+            rank++;
+        err = fabs((double)rank / n - q);
+        if (err > max_err)
+            max_err = err;
+
+        // The estimated rank of an exact value
+        est = PDC_sketch_rank(sketch, sorted[(uint64_t)(q * n)], 0);
+        err = fabs((double)est / n - q);
+        if (err > max_err)
+            max_err = err;
+    }
+    if (max_err > MAX_RANK_ERR) {
+        printf("%s: rank error %.4f is higher than %.4f!\n", name, max_err, MAX_RANK_ERR);
+        n_err++;
+    }
+
+    est = PDC_sketch_ndistinct(sketch);
+    err = fabs((double)est - n_distinct) / n_distinct;
+    if (err > MAX_DISTINCT_ERR) {
+        printf("%s: %" PRIu64 " distinct values estimated instead of %" PRIu64 "!\n", name, est, n_distinct);
+        n_err++;
+    }
+
+    printf("%-12s %" PRIu64 " values, max rank error %.4f, %" PRIu64 " distinct of %" PRIu64 "\n", name,
+           sketch->n, max_err, est, n_distinct);
+
+    return n_err;
+}
+
+int
+main(int argc, char **argv)
+{
+    uint64_t      n = 1000000, i, seed = 1, value, n_distinct, per_region;
+    int           r, n_err = 0;
+    int *         data;
+    double *      sorted;
+    pdc_sketch_t *whole, *merged, *region, *copy;
+    void *        buf;
+    size_t        size;
+
+    if (argc > 1)
+        n = strtoull(argv[1], NULL, 10);
+    if (n < 100) {
+        print_usage();
+        return 1;
+    }
+
+    data   = (int *)malloc(sizeof(int) * n);
+    sorted = (double *)malloc(sizeof(double) * n);
+
+    // Skewed values with many repeats, sum of two uniform values squared
+    for (i = 0; i < n; i++) {
+        seed      = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        value     = (((seed >> 40) & 0xffff) + ((seed >> 20) & 0xffff)) / 2;
+        data[i]   = (int)(value * value / 1000);
+        sorted[i] = data[i];
+    }
+    qsort(sorted, n, sizeof(double), compare_double);
+    n_distinct = 1;
+    for (i = 1; i < n; i++) {
+        if (sorted[i] != sorted[i - 1])
+            n_distinct++;
+    }
+
+    // Sketch of all the values at once
+    whole = PDC_gen_sketch(PDC_INT, n, data);
+    if (whole == NULL) {
+        printf("Fail to generate sketch @ line  %d!\n", __LINE__);
+        return 1;
+    }
+    n_err += check_sketch("whole", whole, n, sorted, n_distinct);
+
+    // Sketches of the regions as written by the servers, merged as for the object statistics
+    merged     = PDC_sketch_create(PDC_INT);
+    per_region = n / N_REGION;
+    for (r = 0; r < N_REGION; r++) {
+        region = PDC_gen_sketch(PDC_INT, r == N_REGION - 1 ? n - r * per_region : per_region,
+                                data + r * per_region);
+        PDC_sketch_merge(merged, region);
+        PDC_sketch_free(region);
+    }
+    n_err += check_sketch("merged", merged, n, sorted, n_distinct);
+
+    // A serialized sketch must give the same answers
+    size = PDC_sketch_serialize_size(merged);
+    buf  = malloc(size);
+    PDC_sketch_serialize(merged, buf);
+    copy = PDC_sketch_deserialize(buf, size);
+    if (copy == NULL || PDC_sketch_quantile(copy, 0.5) != PDC_sketch_quantile(merged, 0.5) ||
+        PDC_sketch_ndistinct(copy) != PDC_sketch_ndistinct(merged) || copy->n != merged->n) {
+        printf("Deserialized sketch differs from the original!\n");
+        n_err++;
+    }
+    if (PDC_sketch_deserialize(buf, size - 1) != NULL) {
+        printf("Truncated sketch is not rejected!\n");
+        n_err++;
+    }
+    printf("serialized   %zu bytes for %" PRIu64 " values\n", size, n);
+
+    free(buf);
+    PDC_sketch_free(copy);
+    PDC_sketch_free(merged);
+    PDC_sketch_free(whole);
+    free(data);
+    free(sorted);
+
+    return n_err != 0;
+}
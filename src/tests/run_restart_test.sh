@@ -0,0 +1,43 @@
+#!/bin/bash
+# Run a test against a server that is killed and restarted in between, the server
+# has no chance to checkpoint, so what the second command sees comes from the metadata log.
+# With a third argument "checkpoint" the server is closed instead, and restarts from its checkpoint.
+
+# Cori CI needs srun even for serial tests
+run_cmd=""
+if [[ "$HOSTNAME" == "cori"* || "$HOSTNAME" == "nid"* ]]; then
+    run_cmd="srun -n 1 --mem=25600 --cpu_bind=cores --gres=craynetwork:1 --overlap "
+fi
+
+if [ $# -lt 2 ]; then echo "missing test commands" && exit -1 ; fi
+# the commands to run before and after the restart, each with its arguments
+before_cmd="$1"
+after_cmd="$2"
+stop_mode="$3"
+rm -rf pdc_tmp
+# START the server (in the background)
+$run_cmd ./pdc_server.exe &
+server_pid=$!
+# WAIT a bit...
+sleep 1
+echo "$run_cmd $before_cmd"
+$run_cmd $before_cmd
+ret="$?"
+# WAIT for the log to be committed, then crash or close the server
+sleep 1
+if [ "$stop_mode" == "checkpoint" ]; then
+    $run_cmd ./close_server
+else
+    kill -9 $server_pid
+fi
+wait $server_pid 2>/dev/null
+if [ $ret -ne 0 ]; then exit $ret; fi
+# RESTART the server from its tmp dir
+$run_cmd ./pdc_server.exe restart &
+sleep 1
+echo "$run_cmd $after_cmd"
+$run_cmd $after_cmd
+ret="$?"
+# and shutdown the SERVER before exiting
+$run_cmd ./close_server
+exit $ret
@@ -73,11 +73,13 @@ main(int argc, char **argv)
     char **        obj_names;
     int *          obj_ts;
     char *         tmp_dir;
-    int            n_entry;
     int            use_name = -1;
-    pdc_metadata_t entry;
-    uint32_t *     hash_key;
-    int            j, read_count = 0, tmp_count;
+    int            j, read_count = 0;
+
+    pdc_checkpoint_header_t header;
+    pdc_checkpoint_index_t  index;
+    pdc_checkpoint_obj_t    entry;
+    uint32_t                name_len;
 
 #ifdef ENABLE_MPI
     MPI_Init(&argc, &argv);
@@ -164,30 +166,23 @@ main(int argc, char **argv)
         return -1;
     }
 
-    fread(&n_entry, sizeof(int), 1, file);
-    /* printf("%d entries\n", n_entry); */
-
-    while (n_entry > 0) {
-        fread(&tmp_count, sizeof(int), 1, file);
-        /* printf("Count:%d\n", tmp_count); */
-
-        hash_key = (uint32_t *)malloc(sizeof(uint32_t));
-        fread(hash_key, sizeof(uint32_t), 1, file);
-        /* printf("Hash key is %u\n", *hash_key); */
+    // The index at the end of the checkpoint locates each object record, which starts with its obj_name
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, PDC_CHECKPOINT_MAGIC, sizeof(header.magic)) != 0) {
+        printf("read failed\n");
+        header.n_obj = 0;
+    }
 
-        // read each metadata
-        for (j = 0; j < tmp_count; j++) {
-            if (read_count >= count) {
-                n_entry = 0;
-                break;
-            }
-            fread(&entry, sizeof(pdc_metadata_t), 1, file);
-            sprintf(obj_names[read_count], "%s", entry.obj_name);
-            obj_ts[i] = entry.time_step;
-            /* printf("Read name %s\n", obj_names[read_count]); */
-            read_count++;
+    for (j = 0; j < (int)header.n_obj && read_count < count; j++) {
+        if (fseek(file, header.index_offset + j * sizeof(pdc_checkpoint_index_t), SEEK_SET) != 0 ||
+            fread(&index, sizeof(index), 1, file) != 1 || fseek(file, index.offset, SEEK_SET) != 0 ||
+            fread(&entry, sizeof(entry), 1, file) != 1 || fread(&name_len, sizeof(uint32_t), 1, file) != 1 ||
+            name_len > 128 || fread(obj_names[read_count], name_len, 1, file) != 1) {
+            printf("read failed\n");
+            break;
         }
-        n_entry--;
+        obj_ts[read_count] = entry.time_step;
+        read_count++;
     }
 
     fclose(file);
@@ -58,14 +58,16 @@ main(int argc, char **argv)
     char            name_mode[6][32] = {"Random Obj Names", "INVALID!", "One Obj Name",
                              "INVALID!",         "INVALID!", "Four Obj Names"};
     char            filename[1024], pdc_server_tmp_dir_g[128];
-    int             n_entry;
     char *          tmp_dir;
-    pdc_metadata_t  entry;
-    uint32_t *      hash_key;
-    int             j, read_count = 0, tmp_count;
+    int             j, read_count = 0;
     int             progress_factor;
     pdc_metadata_t *res;
 
+    pdc_checkpoint_header_t header;
+    pdc_checkpoint_index_t  index;
+    pdc_checkpoint_obj_t    entry;
+    uint32_t                name_len;
+
 #ifdef ENABLE_MPI
     MPI_Init(&argc, &argv);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
@@ -149,34 +151,23 @@ main(int argc, char **argv)
         return -1;
     }
 
-    if (fread(&n_entry, sizeof(int), 1, file) == 0) {
+    // The index at the end of the checkpoint locates each object record, which starts with its obj_name
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, PDC_CHECKPOINT_MAGIC, sizeof(header.magic)) != 0) {
         printf("read failed\n");
+        header.n_obj = 0;
     }
 
-    while (n_entry > 0) {
-        if (fread(&tmp_count, sizeof(int), 1, file)) {
+    for (j = 0; j < (int)header.n_obj && read_count < count; j++) {
+        if (fseek(file, header.index_offset + j * sizeof(pdc_checkpoint_index_t), SEEK_SET) != 0 ||
+            fread(&index, sizeof(index), 1, file) != 1 || fseek(file, index.offset, SEEK_SET) != 0 ||
+            fread(&entry, sizeof(entry), 1, file) != 1 || fread(&name_len, sizeof(uint32_t), 1, file) != 1 ||
+            name_len > 128 || fread(obj_names[read_count], name_len, 1, file) != 1) {
             printf("read failed\n");
+            break;
         }
-
-        hash_key = (uint32_t *)malloc(sizeof(uint32_t));
-        if (fread(hash_key, sizeof(uint32_t), 1, file) == 0) {
-            printf("read failed\n");
-        }
-
-        // read each metadata
-        for (j = 0; j < tmp_count; j++) {
-            if (read_count >= count) {
-                n_entry = 0;
-                break;
-            }
-            if (fread(&entry, sizeof(pdc_metadata_t), 1, file) == 0) {
-                printf("read failed\n");
-            }
-            sprintf(obj_names[read_count], "%s", entry.obj_name);
-            obj_ts[read_count] = entry.time_step;
-            read_count++;
-        }
-        n_entry--;
+        obj_ts[read_count] = entry.time_step;
+        read_count++;
     }
 
     fclose(file);
@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "pdc.h"
+#include "pdc_transforms_pkg.h"
+
+void
+print_usage()
+{
+    printf("Usage: ./transform_pipeline n_elem\n");
+}
+
+// Run length encoding of the bytes as (count, byte) pairs, its chunks are framed
+static size_t
+rle_encode(const void *in, size_t in_size, pdc_var_type_t in_type, void *out, size_t out_capacity,
+           pdc_var_type_t *out_type, const char *arg)
+{
+    const uint8_t *src = (const uint8_t *)in;
+    uint8_t *      dst = (uint8_t *)out;
+    size_t         i, run, n = 0;
+
+    (void)in_type;
+    (void)arg;
+    if (in == NULL)
+        return 0;
+
+    for (i = 0; i < in_size; i += run) {
+        run = 1;
+        while (i + run < in_size && run < 255 && src[i + run] == src[i])
+            run++;
+        if (n + 2 <= out_capacity) {
+            dst[n]     = (uint8_t)run;
+            dst[n + 1] = src[i];
+        }
+        n += 2;
+    }
+    *out_type = PDC_INT8;
+
+    return n;
+}
+
+static size_t
+rle_decode(const void *in, size_t in_size, pdc_var_type_t in_type, void *out, size_t out_capacity,
+           pdc_var_type_t *out_type, const char *arg)
+{
+    const uint8_t *src = (const uint8_t *)in;
+    size_t         i, n = 0;
+
+    (void)in_type;
+    (void)arg;
+    if (in == NULL)
+        return PDC_STAGE_FRAMED_INPUT | PDC_STAGE_CONCAT;
+    if (in_size % 2 != 0)
+        return 0;
+
+    for (i = 0; i < in_size; i += 2)
+        n += src[i];
+    if (n > out_capacity)
+        return n;
+    for (i = 0, n = 0; i < in_size; i += 2) {
+        memset((uint8_t *)out + n, src[i + 1], src[i]);
+        n += src[i];
+    }
+    *out_type = PDC_INT8;
+
+    return n;
+}
+
+// Pipelines that cannot be created
+static int
+check_invalid()
+{
+    const char *specs[] = {"", "nosuch", "rle|unrle", "convert=nosuch", "convert=double|:nolib"};
+    int         i, ret_value = 0;
+
+    for (i = 0; i < (int)(sizeof(specs) / sizeof(specs[0])); i++) {
+        if (PDC_transform_pipeline_create(specs[i]) != NULL) {
+            printf("Invalid pipeline \"%s\" is accepted!\n", specs[i]);
+            ret_value = 1;
+        }
+    }
+    if (PDC_transform_stage_register("a|b", rle_encode) == SUCCEED) {
+        printf("Invalid stage name is accepted!\n");
+        ret_value = 1;
+    }
+
+    return ret_value;
+}
+
+int
+main(int argc, char **argv)
+{
+    uint64_t                        n_elem = 1048576, k;
+    struct _pdc_transform_pipeline *encode = NULL, *decode = NULL, *narrow = NULL;
+    int *                           data;
+    double *                        expected;
+    float *                         values;
+    void *                          framed = NULL, *decoded = NULL, *out;
+    size_t                          framed_size, decoded_size, out_size;
+    pdc_var_type_t                  type;
+    int                             ret_value = 0;
+
+    if (argc > 1)
+        n_elem = atoll(argv[1]);
+    if (n_elem == 0) {
+        print_usage();
+        return 1;
+    }
+
+    if (PDC_transform_stage_register("rle", rle_encode) != SUCCEED ||
+        PDC_transform_stage_register("unrle", rle_decode) != SUCCEED) {
+        printf("Fail to register stages @ line  %d!\n", __LINE__);
+        return 1;
+    }
+    ret_value |= check_invalid();
+
+    data     = (int *)malloc(sizeof(int) * n_elem);
+    expected = (double *)malloc(sizeof(double) * n_elem);
+    values   = (float *)malloc(sizeof(float) * n_elem);
+    for (k = 0; k < n_elem; k++) {
+        data[k]     = (int)(k / 64) - 1000;
+        expected[k] = data[k];
+    }
+
+    // Values are converted and encoded in one pass over the chunks, then decoded from the frames
+    encode = PDC_transform_pipeline_create("convert=double|rle");
+    decode = PDC_transform_pipeline_create("unrle");
+    if (encode == NULL || decode == NULL || !encode->framed_out || !decode->framed_in || decode->framed_out) {
+        printf("Fail to create pipelines @ line  %d!\n", __LINE__);
+        return 1;
+    }
+    if (PDC_transform_pipeline_run(encode, data, sizeof(int) * n_elem, PDC_INT, &framed, &framed_size,
+                                   &type) != SUCCEED ||
+        type != PDC_INT8) {
+        printf("Fail to run the encoding pipeline @ line  %d!\n", __LINE__);
+        return 1;
+    }
+    if (PDC_transform_pipeline_run(decode, framed, framed_size, PDC_INT8, &decoded, &decoded_size, &type) !=
+            SUCCEED ||
+        decoded_size != sizeof(double) * n_elem || memcmp(decoded, expected, decoded_size) != 0) {
+        printf("Decoded data differs from the converted input @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    printf("%llu int values encoded to %zu bytes, decoded to %zu bytes\n", (unsigned long long)n_elem,
+           framed_size, decoded_size);
+
+    // A truncated frame is rejected
+    if (framed_size > 1 && PDC_transform_pipeline_run(decode, framed, framed_size - 1, PDC_INT8, &decoded,
+                                                      &decoded_size, &type) == SUCCEED) {
+        printf("Truncated frame is accepted @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+
+    // Conversions into a given buffer saturate at each stage, a buffer that is too small fails
+    narrow   = PDC_transform_pipeline_create("convert=int8|convert=float");
+    out      = values;
+    out_size = sizeof(float) * n_elem;
+    if (narrow == NULL || PDC_transform_pipeline_run(narrow, data, sizeof(int) * n_elem, PDC_INT, &out,
+                                                     &out_size, &type) != SUCCEED ||
+        out != values || out_size != sizeof(float) * n_elem || type != PDC_FLOAT) {
+        printf("Fail to run the conversion pipeline @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    else {
+        for (k = 0; k < n_elem; k++) {
+            if (values[k] != (float)(data[k] < -128 ? -128 : data[k] > 127 ? 127 : data[k])) {
+                printf("Element %llu is %f instead of %d!\n", (unsigned long long)k, values[k], data[k]);
+                ret_value = 1;
+                break;
+            }
+        }
+        out_size = sizeof(float) * n_elem - 1;
+        if (PDC_transform_pipeline_run(narrow, data, sizeof(int) * n_elem, PDC_INT, &out, &out_size, &type) ==
+            SUCCEED) {
+            printf("Output larger than the buffer is accepted @ line  %d!\n", __LINE__);
+            ret_value = 1;
+        }
+    }
+
+    PDC_transform_pipeline_free(encode);
+    PDC_transform_pipeline_free(decode);
+    PDC_transform_pipeline_free(narrow);
+    free(framed);
+    free(decoded);
+    free(data);
+    free(expected);
+    free(values);
+
+    return ret_value;
+}
@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "pdc.h"
+#include "pdc_transforms_pkg.h"
+#include "pdc_analysis_pkg.h"
+
+void
+print_usage()
+{
+    printf("Usage: ./transform_pipeline_server n_elem\n");
+}
+
+// A stage of this process only, the data server does not have it
+static size_t
+copy_stage(const void *in, size_t in_size, pdc_var_type_t in_type, void *out, size_t out_capacity,
+           pdc_var_type_t *out_type, const char *arg)
+{
+    (void)arg;
+    if (in == NULL)
+        return PDC_STAGE_CONCAT;
+    if (in_size > out_capacity)
+        return in_size;
+    memcpy(out, in, in_size);
+    *out_type = in_type;
+
+    return in_size;
+}
+
+// Index of the last transform the client registered for an object, -1 if there is none
+static int
+last_transform(pdcid_t obj)
+{
+    struct _pdc_region_transform_ftn_info **registry = NULL;
+    int                                     i, n = PDC_get_transforms(&registry);
+
+    for (i = n - 1; i >= 0; i--) {
+        if (registry[i] != NULL && registry[i]->object_id == obj)
+            return i;
+    }
+    return -1;
+}
+
+int
+main(int argc, char **argv)
+{
+    uint64_t                                n_elem = 1048576, dims[1];
+    pdcid_t                                 pdc, cont_prop, cont, obj_prop, obj;
+    struct _pdc_region_transform_ftn_info **registry = NULL;
+    int                                     index, ret_value = 0;
+
+    if (argc > 1)
+        n_elem = atoll(argv[1]);
+    if (n_elem == 0) {
+        print_usage();
+        return 1;
+    }
+
+    pdc       = PDCinit("pdc");
+    cont_prop = PDCprop_create(PDC_CONT_CREATE, pdc);
+    cont      = PDCcont_create("c_transform_pipeline_server", cont_prop);
+    obj_prop  = PDCprop_create(PDC_OBJ_CREATE, pdc);
+    if (cont_prop <= 0 || cont <= 0 || obj_prop <= 0) {
+        printf("Fail to create container @ line  %d!\n", __LINE__);
+        return 1;
+    }
+    dims[0] = n_elem;
+    PDCprop_set_obj_type(obj_prop, PDC_INT);
+    PDCprop_set_obj_dims(obj_prop, 1, dims);
+    PDCprop_set_obj_user_id(obj_prop, getuid());
+    PDCprop_set_obj_time_step(obj_prop, 0);
+    PDCprop_set_obj_app_name(obj_prop, "TransformPipelineServer");
+    PDCprop_set_obj_tags(obj_prop, "tag0=1");
+    obj = PDCobj_create(cont, "o_transform_pipeline_server", obj_prop);
+    if (obj <= 0) {
+        printf("Fail to create object @ line  %d!\n", __LINE__);
+        return 1;
+    }
+    if (PDC_transform_stage_register("copy", copy_stage) != SUCCEED) {
+        printf("Fail to register a stage @ line  %d!\n", __LINE__);
+        return 1;
+    }
+
+    // The pipelines are created by the data server, which returns its index of each of them
+    PDC_set_execution_locus(SERVER_MEMORY);
+    if (PDCobj_transform_pipeline_register("convert=float", obj, 0, INCR_STATE, DATA_IN) != SUCCEED) {
+        printf("Fail to register a pipeline on the server @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    else if ((index = last_transform(obj)) < 0 || PDC_get_transforms(&registry) <= index ||
+             registry[index]->pipeline != NULL || registry[index]->meta_index < 0) {
+        printf("Server index of the pipeline is not returned @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+
+    // A stage the server cannot create fails the registration
+    if (PDCobj_transform_pipeline_register("convert=nosuch", obj, 0, INCR_STATE, DATA_IN) == SUCCEED) {
+        printf("Pipeline the server cannot create is accepted @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+    // A stage registered by the client is only known to the client
+    if (PDCobj_transform_pipeline_register("convert=float|copy", obj, 0, INCR_STATE, DATA_IN) == SUCCEED) {
+        printf("Pipeline with a stage of the client is sent to the server @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+
+    // The same pipeline on the client uses the stage of the client
+    PDC_set_execution_locus(CLIENT_MEMORY);
+    if (PDCobj_transform_pipeline_register("convert=float|copy", obj, 0, INCR_STATE, DATA_OUT) != SUCCEED ||
+        (index = last_transform(obj)) < 0 || PDC_get_transforms(&registry) <= index ||
+        registry[index]->pipeline == NULL) {
+        printf("Fail to register a pipeline on the client @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+
+    if (PDCobj_close(obj) < 0 || PDCcont_close(cont) < 0 || PDCprop_close(obj_prop) < 0 ||
+        PDCprop_close(cont_prop) < 0 || PDCclose(pdc) < 0) {
+        printf("Fail to close @ line  %d!\n", __LINE__);
+        ret_value = 1;
+    }
+
+    return ret_value;
+}